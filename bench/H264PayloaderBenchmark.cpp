@@ -0,0 +1,88 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define H264_BENCHMARK_MAX_NALU_SIZE  (64 * 1024)
+#define H264_BENCHMARK_SLICE_NALU_MIN 512
+
+class H264PayloaderBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    // Builds an Annex-B access unit: SPS, PPS, then slices of random size with random payload until the frame is full
+    static std::vector<BYTE> createAnnexBFrame(UINT32 frameSize)
+    {
+        std::vector<BYTE> frame;
+        UINT32 naluSize, i;
+        BYTE value;
+        BYTE parameterSets[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0xc0, 0x1f, 0xda, 0x01, 0x40, 0x16,
+                                0xe8, 0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x3c, 0x80};
+
+        srand(frameSize);
+        frame.reserve(frameSize);
+        frame.insert(frame.end(), parameterSets, parameterSets + SIZEOF(parameterSets));
+
+        while (frame.size() + 4 < frameSize) {
+            naluSize = MIN(frameSize - (UINT32) frame.size() - 4, H264_BENCHMARK_SLICE_NALU_MIN + (UINT32) (RAND() % H264_BENCHMARK_MAX_NALU_SIZE));
+            frame.push_back(0x00);
+            frame.push_back(0x00);
+            frame.push_back(0x01);
+            frame.push_back(0x65);
+            for (i = 1; i < naluSize; i++) {
+                // Emulation prevention guarantees no 00 00 0x sequence inside a NALU, keep zero runs short
+                value = (BYTE) (RAND() % 256);
+                if (value == 0x00 && frame.back() == 0x00) {
+                    value = 0x03;
+                }
+                frame.push_back(value);
+            }
+        }
+
+        return frame;
+    }
+};
+
+static VOID scanAnnexBFrame(benchmark::State& state, UINT32 (*scannerFn)(PBYTE, UINT32))
+{
+    std::vector<BYTE> frame = H264PayloaderBenchmark::createAnnexBFrame((UINT32) state.range(0));
+    PBYTE pCur;
+    UINT32 remaining, offset, startCodes;
+
+    for (auto _ : state) {
+        pCur = frame.data();
+        remaining = (UINT32) frame.size();
+        startCodes = 0;
+        while (remaining != 0) {
+            offset = scannerFn(pCur, remaining);
+            if (offset < remaining) {
+                startCodes++;
+                offset += 3;
+            }
+            pCur += offset;
+            remaining -= offset;
+        }
+        benchmark::DoNotOptimize(startCodes);
+    }
+    state.SetBytesProcessed((INT64) state.iterations() * (INT64) frame.size());
+}
+
+BENCHMARK_DEFINE_F(H264PayloaderBenchmark, BM_StartCodeScanScalar)(benchmark::State& state)
+{
+    scanAnnexBFrame(state, findAnnexBStartCodeScalar);
+}
+
+BENCHMARK_DEFINE_F(H264PayloaderBenchmark, BM_StartCodeScan)(benchmark::State& state)
+{
+    scanAnnexBFrame(state, findAnnexBStartCode);
+}
+
+BENCHMARK_REGISTER_F(H264PayloaderBenchmark, BM_StartCodeScanScalar)->Arg(10 << 10)->Arg(100 << 10)->Arg(500 << 10)->Arg(2 << 20);
+BENCHMARK_REGISTER_F(H264PayloaderBenchmark, BM_StartCodeScan)->Arg(10 << 10)->Arg(100 << 10)->Arg(500 << 10)->Arg(2 << 20);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,553 @@
+#include "WebRTCClientBenchmarkFixture.h"
+#include <algorithm>
+#include <condition_variable>
+#include <ctime>
+#include <random>
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define LOOPBACK_BENCHMARK_VIDEO_FRAME_DURATION (40 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define LOOPBACK_BENCHMARK_AUDIO_FRAME_DURATION (20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define LOOPBACK_BENCHMARK_VIDEO_FRAME_SIZE     5000
+#define LOOPBACK_BENCHMARK_AUDIO_FRAME_SIZE     160
+#define LOOPBACK_BENCHMARK_KEY_FRAME_INTERVAL   50
+#define LOOPBACK_BENCHMARK_KEY_FRAME_FACTOR     8
+#define LOOPBACK_BENCHMARK_SEND_TIME_LEN        16
+#define LOOPBACK_BENCHMARK_MAX_FRAMES_IN_FLIGHT 8
+#define LOOPBACK_BENCHMARK_REORDER_DELAY        (10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define LOOPBACK_BENCHMARK_MAX_QUEUE_DELAY      (200 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define LOOPBACK_BENCHMARK_DRAIN_DURATION       (2 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+#define LOOPBACK_BENCHMARK_AWAIT_DURATION       (10 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+#define LOOPBACK_BENCHMARK_STALL_DURATION       (5 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+#define LOOPBACK_BENCHMARK_RANDOM_SEED          0x4b5653
+
+// Impairments of one direction of the virtual network, applied in the order netem applies them
+struct VirtualLinkParams {
+    UINT32 lossPermille;
+    UINT64 delay;
+    UINT64 jitter; // Uniform in [0, jitter], packets overtake each other when it is larger than their spacing
+    UINT32 reorderPermille;
+    UINT32 bandwidthKbps; // No cap if 0, the queue in front of the cap drops its tail past LOOPBACK_BENCHMARK_MAX_QUEUE_DELAY
+};
+
+// One direction of the virtual network. The sending ICE agent hands its packets over in place of the socket and the
+// delivery thread stands in for the ICE receive thread of the other end, handing them over once they are due.
+class VirtualLink {
+  public:
+    VOID start(PRtcPeerConnection pReceiver)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        this->pReceiver = pReceiver;
+        packets.clear();
+        random.seed(LOOPBACK_BENCHMARK_RANDOM_SEED);
+        MEMSET(&params, 0x00, SIZEOF(VirtualLinkParams));
+        busyUntil = 0;
+        nextSequence = 0;
+        packetsDropped = 0;
+        stopped = false;
+        deliveryThread = std::thread([this]() { deliver(); });
+    }
+
+    VOID stop()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopped = true;
+        }
+        cvar.notify_one();
+        if (deliveryThread.joinable()) {
+            deliveryThread.join();
+        }
+    }
+
+    // The handshake goes through unimpaired, impairments only apply to the media
+    VOID impair(const VirtualLinkParams& params)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        this->params = params;
+    }
+
+    static STATUS onOutboundPacket(UINT64 customData, PBYTE pData, UINT32 dataLen);
+
+    std::atomic<UINT64> packetsDropped{0};
+
+  private:
+    struct Packet {
+        UINT64 deliveryTime;
+        UINT64 sequence;
+        std::vector<BYTE> data;
+    };
+
+    // Min-heap on the delivery time, packets due at the same time keep the order they were sent in
+    static bool deliveredAfter(const Packet& first, const Packet& second)
+    {
+        return first.deliveryTime != second.deliveryTime ? first.deliveryTime > second.deliveryTime : first.sequence > second.sequence;
+    }
+
+    VOID send(PBYTE pData, UINT32 dataLen)
+    {
+        std::uniform_int_distribution<UINT32> permille(0, 999);
+        UINT64 now = GETTIME(), departureTime = now, deliveryTime;
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (stopped || permille(random) < params.lossPermille) {
+                packetsDropped++;
+                return;
+            }
+
+            if (params.bandwidthKbps != 0) {
+                if (busyUntil > now + LOOPBACK_BENCHMARK_MAX_QUEUE_DELAY) {
+                    packetsDropped++;
+                    return;
+                }
+                // Time it takes the packet to go on the wire once the ones queued before it are gone
+                departureTime = MAX(now, busyUntil) + (UINT64) dataLen * 8 * HUNDREDS_OF_NANOS_IN_A_SECOND / (params.bandwidthKbps * 1000ULL);
+                busyUntil = departureTime;
+            }
+
+            deliveryTime = departureTime + params.delay;
+            if (params.jitter != 0) {
+                deliveryTime += std::uniform_int_distribution<UINT64>(0, params.jitter)(random);
+            }
+            if (permille(random) < params.reorderPermille) {
+                deliveryTime += LOOPBACK_BENCHMARK_REORDER_DELAY;
+            }
+
+            packets.push_back(Packet{deliveryTime, nextSequence++, std::vector<BYTE>(pData, pData + dataLen)});
+            std::push_heap(packets.begin(), packets.end(), deliveredAfter);
+        }
+        cvar.notify_one();
+    }
+
+    VOID deliver()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        std::vector<BYTE> data;
+        UINT64 now;
+
+        while (!stopped) {
+            if (packets.empty()) {
+                cvar.wait(guard);
+                continue;
+            }
+
+            now = GETTIME();
+            if (packets.front().deliveryTime > now) {
+                cvar.wait_for(guard, std::chrono::microseconds((packets.front().deliveryTime - now) / HUNDREDS_OF_NANOS_IN_A_MICROSECOND));
+                continue;
+            }
+
+            std::pop_heap(packets.begin(), packets.end(), deliveredAfter);
+            data = std::move(packets.back().data);
+            packets.pop_back();
+
+            guard.unlock();
+            onInboundPacket((UINT64) pReceiver, data.data(), (UINT32) data.size());
+            guard.lock();
+        }
+    }
+
+    std::mutex lock;
+    std::condition_variable cvar;
+    std::vector<Packet> packets;
+    std::mt19937 random;
+    VirtualLinkParams params;
+    UINT64 busyUntil = 0;
+    UINT64 nextSequence = 0;
+    bool stopped = true;
+    PRtcPeerConnection pReceiver = NULL;
+    std::thread deliveryThread;
+};
+
+STATUS VirtualLink::onOutboundPacket(UINT64 customData, PBYTE pData, UINT32 dataLen)
+{
+    // Like UDP, the sender doesn't get to know whether the packet made it
+    ((VirtualLink*) customData)->send(pData, dataLen);
+    return STATUS_SUCCESS;
+}
+
+// What the receiving end of a stream got. The frames carry the time they were written at, so the latency is from
+// writeFrame on the sender to RtcOnFrame on the receiver.
+struct StreamStats {
+    BOOL isVideo;
+    LatencyHistogram latencyHistogram;
+    std::atomic<UINT64> framesReceived;
+    std::atomic<UINT64> bytesReceived;
+};
+
+class LoopbackBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    // Negotiates an H264 and an Opus stream from the offer to the answer, then connects the two ends over the virtual
+    // network. There is no signaling and no socket, the descriptions are handed over directly and ICE is skipped.
+    STATUS connect()
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        RtcConfiguration configuration;
+        RtcSessionDescriptionInit sdp;
+        PRtcRtpTransceiver pAnswerTransceiver = NULL;
+        UINT64 deadline;
+
+        resetStreamStats(&videoStats, TRUE);
+        resetStreamStats(&audioStats, FALSE);
+        connectedCount = 0;
+        videoFramesSent = audioFramesSent = bytesSent = 0;
+
+        MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+        // No ICE server and relay only, so no candidate is gathered and no socket is opened
+        configuration.iceTransportPolicy = ICE_TRANSPORT_POLICY_RELAY;
+        // The ICE agent of either end never finds a pair, it mustn't give up during the run
+        configuration.kvsRtcConfiguration.iceConnectionCheckTimeout = MAX_UINT32;
+
+        CHK_STATUS(createPeerConnection(&configuration, &offerPc));
+        CHK_STATUS(createPeerConnection(&configuration, &answerPc));
+        CHK_STATUS(peerConnectionOnConnectionStateChange(offerPc, (UINT64) this, onConnectionStateChange));
+        CHK_STATUS(peerConnectionOnConnectionStateChange(answerPc, (UINT64) this, onConnectionStateChange));
+
+        CHK_STATUS(addStream(offerPc, RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE, MEDIA_STREAM_TRACK_KIND_VIDEO,
+                             &pVideoSender));
+        CHK_STATUS(addStream(offerPc, RTC_CODEC_OPUS, MEDIA_STREAM_TRACK_KIND_AUDIO, &pAudioSender));
+        CHK_STATUS(addStream(answerPc, RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE, MEDIA_STREAM_TRACK_KIND_VIDEO,
+                             &pAnswerTransceiver));
+        CHK_STATUS(transceiverOnFrame(pAnswerTransceiver, (UINT64) &videoStats, onFrame));
+        CHK_STATUS(addStream(answerPc, RTC_CODEC_OPUS, MEDIA_STREAM_TRACK_KIND_AUDIO, &pAnswerTransceiver));
+        CHK_STATUS(transceiverOnFrame(pAnswerTransceiver, (UINT64) &audioStats, onFrame));
+
+        CHK_STATUS(createOffer(offerPc, &sdp));
+        CHK_STATUS(setLocalDescription(offerPc, &sdp));
+        CHK_STATUS(setRemoteDescription(answerPc, &sdp));
+        CHK_STATUS(createAnswer(answerPc, &sdp));
+        CHK_STATUS(setLocalDescription(answerPc, &sdp));
+        CHK_STATUS(setRemoteDescription(offerPc, &sdp));
+
+        ((PKvsPeerConnection) offerPc)->pIceAgent->outboundPacketCustomData = (UINT64) &toAnswer;
+        ((PKvsPeerConnection) offerPc)->pIceAgent->outboundPacketFn = VirtualLink::onOutboundPacket;
+        ((PKvsPeerConnection) answerPc)->pIceAgent->outboundPacketCustomData = (UINT64) &toOffer;
+        ((PKvsPeerConnection) answerPc)->pIceAgent->outboundPacketFn = VirtualLink::onOutboundPacket;
+        toOffer.start(offerPc);
+        toAnswer.start(answerPc);
+
+        // What the ICE agents would report once a pair succeeded, it starts the DTLS handshake
+        onIceConnectionStateChange((UINT64) offerPc, ICE_AGENT_STATE_CONNECTED);
+        onIceConnectionStateChange((UINT64) answerPc, ICE_AGENT_STATE_CONNECTED);
+
+        // The SRTP session of an end is created after it reported being connected
+        deadline = GETTIME() + LOOPBACK_BENCHMARK_AWAIT_DURATION;
+        while (connectedCount.load() != 2 || !isSrtpReady(offerPc) || !isSrtpReady(answerPc)) {
+            CHK(GETTIME() < deadline, STATUS_OPERATION_TIMED_OUT);
+            THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    VOID disconnect()
+    {
+        // Whatever the ends send while closing is dropped by the stopped links
+        toOffer.stop();
+        toAnswer.stop();
+
+        if (offerPc != NULL) {
+            closePeerConnection(offerPc);
+            freePeerConnection(&offerPc);
+        }
+
+        if (answerPc != NULL) {
+            closePeerConnection(answerPc);
+            freePeerConnection(&answerPc);
+        }
+    }
+
+    VOID impair(benchmark::State& state)
+    {
+        VirtualLinkParams params;
+
+        params.lossPermille = (UINT32) state.range(0);
+        params.delay = (UINT64) state.range(1) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        params.jitter = (UINT64) state.range(2) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        params.reorderPermille = (UINT32) state.range(3);
+        params.bandwidthKbps = (UINT32) state.range(4);
+        toOffer.impair(params);
+        toAnswer.impair(params);
+    }
+
+    STATUS writeVideoFrame(UINT32 frameSize)
+    {
+        BOOL isKeyFrame = videoFramesSent % LOOPBACK_BENCHMARK_KEY_FRAME_INTERVAL == 0;
+
+        return writeSyntheticFrame(pVideoSender, isKeyFrame ? frameSize * LOOPBACK_BENCHMARK_KEY_FRAME_FACTOR : frameSize, TRUE, isKeyFrame,
+                                   videoFramesSent++ * LOOPBACK_BENCHMARK_VIDEO_FRAME_DURATION);
+    }
+
+    STATUS writeAudioFrame()
+    {
+        return writeSyntheticFrame(pAudioSender, LOOPBACK_BENCHMARK_AUDIO_FRAME_SIZE, FALSE, FALSE,
+                                   audioFramesSent++ * LOOPBACK_BENCHMARK_AUDIO_FRAME_DURATION);
+    }
+
+    // The jitter buffer hands a frame out once the first packet of the next one arrives, so the last frame of each
+    // stream is never received
+    VOID awaitDelivery()
+    {
+        UINT64 deadline = GETTIME() + LOOPBACK_BENCHMARK_DRAIN_DURATION;
+
+        while (GETTIME() < deadline &&
+               (videoStats.framesReceived.load() + 1 < videoFramesSent || audioStats.framesReceived.load() + 1 < audioFramesSent)) {
+            THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+    }
+
+    VOID reportCounters(benchmark::State& state, clock_t cpuStart, UINT64 startTime, UINT32 streamCount)
+    {
+        DOUBLE wallSeconds = (DOUBLE) (GETTIME() - startTime) / HUNDREDS_OF_NANOS_IN_A_SECOND;
+
+        // Both ends run in this process, so this is the CPU time of sending and of receiving
+        state.counters["cpuPercentPerStream"] = (DOUBLE) (clock() - cpuStart) / CLOCKS_PER_SEC / wallSeconds / streamCount * 100;
+        state.SetBytesProcessed((INT64) bytesSent);
+
+        awaitDelivery();
+        reportStreamCounters(state, &videoStats, videoFramesSent, "video");
+        if (audioFramesSent != 0) {
+            reportStreamCounters(state, &audioStats, audioFramesSent, "audio");
+        }
+        state.counters["packetsDropped"] = (DOUBLE) (toOffer.packetsDropped.load() + toAnswer.packetsDropped.load());
+    }
+
+    UINT64 framesInFlight()
+    {
+        return videoFramesSent - videoStats.framesReceived.load();
+    }
+
+    static VOID onConnectionStateChange(UINT64 customData, RTC_PEER_CONNECTION_STATE state);
+    static VOID onFrame(UINT64 customData, PFrame pFrame);
+
+  protected:
+    STATUS addStream(PRtcPeerConnection pPeerConnection, RTC_CODEC codec, MEDIA_STREAM_TRACK_KIND kind, PRtcRtpTransceiver* ppTransceiver)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        RtcMediaStreamTrack track;
+
+        MEMSET(&track, 0x00, SIZEOF(RtcMediaStreamTrack));
+        track.kind = kind;
+        track.codec = codec;
+        CHK_STATUS(generateJSONSafeString(track.streamId, MAX_MEDIA_STREAM_ID_LEN));
+        CHK_STATUS(generateJSONSafeString(track.trackId, MAX_MEDIA_STREAM_ID_LEN));
+
+        CHK_STATUS(addSupportedCodec(pPeerConnection, codec));
+        CHK_STATUS(addTransceiver(pPeerConnection, &track, NULL, ppTransceiver));
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    // H264 frames are a single Annex-B slice, both kinds start their payload with the time they are written at in hex
+    // and are filled with bytes which make no start code
+    STATUS writeSyntheticFrame(PRtcRtpTransceiver pTransceiver, UINT32 frameSize, BOOL isVideo, BOOL isKeyFrame, UINT64 presentationTs)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        BYTE annexBHeader[] = {0x00, 0x00, 0x00, 0x01, (BYTE) (isKeyFrame ? 0x65 : 0x41)};
+        CHAR sendTime[LOOPBACK_BENCHMARK_SEND_TIME_LEN + 1];
+        UINT32 headerLen = isVideo ? SIZEOF(annexBHeader) : 0, i;
+        Frame frame;
+
+        CHK(frameSize >= headerLen + LOOPBACK_BENCHMARK_SEND_TIME_LEN, STATUS_INVALID_ARG);
+        if (frameBuffer.size() < frameSize) {
+            frameBuffer.resize(frameSize);
+            for (i = 0; i < frameSize; i++) {
+                frameBuffer[i] = (BYTE) (i % 251 + 1);
+            }
+        }
+
+        MEMCPY(frameBuffer.data(), annexBHeader, headerLen);
+        SNPRINTF(sendTime, ARRAY_SIZE(sendTime), "%016" PRIx64, GETTIME());
+        MEMCPY(frameBuffer.data() + headerLen, sendTime, LOOPBACK_BENCHMARK_SEND_TIME_LEN);
+
+        MEMSET(&frame, 0x00, SIZEOF(Frame));
+        frame.version = FRAME_CURRENT_VERSION;
+        frame.flags = isKeyFrame ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        frame.presentationTs = frame.decodingTs = presentationTs;
+        frame.duration = isVideo ? LOOPBACK_BENCHMARK_VIDEO_FRAME_DURATION : LOOPBACK_BENCHMARK_AUDIO_FRAME_DURATION;
+        frame.size = frameSize;
+        frame.frameData = frameBuffer.data();
+
+        CHK_STATUS(writeFrame(pTransceiver, &frame));
+        bytesSent += frameSize;
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    static VOID resetStreamStats(StreamStats* pStreamStats, BOOL isVideo)
+    {
+        pStreamStats->isVideo = isVideo;
+        MEMSET(&pStreamStats->latencyHistogram, 0x00, SIZEOF(LatencyHistogram));
+        pStreamStats->framesReceived = 0;
+        pStreamStats->bytesReceived = 0;
+    }
+
+    static BOOL isSrtpReady(PRtcPeerConnection pPeerConnection)
+    {
+        PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pPeerConnection;
+        BOOL ready;
+
+        MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+        ready = pKvsPeerConnection->pSrtpSession != NULL;
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+
+        return ready;
+    }
+
+    static VOID reportStreamCounters(benchmark::State& state, StreamStats* pStreamStats, UINT64 framesSent, std::string name)
+    {
+        LatencyHistogramStats latencyStats;
+
+        state.counters[name + "FramesPerSecond"] = benchmark::Counter((DOUBLE) pStreamStats->framesReceived.load(), benchmark::Counter::kIsRate);
+        state.counters[name + "BytesPerSecond"] = benchmark::Counter((DOUBLE) pStreamStats->bytesReceived.load(), benchmark::Counter::kIsRate);
+        state.counters[name + "FramesLost"] = (DOUBLE) (framesSent - MIN(framesSent, pStreamStats->framesReceived.load() + 1));
+        if (STATUS_SUCCEEDED(latencyHistogramGetStats(&pStreamStats->latencyHistogram, &latencyStats))) {
+            state.counters[name + "P50Ms"] = (DOUBLE) latencyStats.p50 / HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+            state.counters[name + "P99Ms"] = (DOUBLE) latencyStats.p99 / HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        }
+    }
+
+    PRtcPeerConnection offerPc = NULL;
+    PRtcPeerConnection answerPc = NULL;
+    PRtcRtpTransceiver pVideoSender = NULL;
+    PRtcRtpTransceiver pAudioSender = NULL;
+    VirtualLink toOffer;
+    VirtualLink toAnswer;
+    StreamStats videoStats;
+    StreamStats audioStats;
+    std::atomic<SIZE_T> connectedCount{0};
+    std::vector<BYTE> frameBuffer;
+    UINT64 videoFramesSent = 0;
+    UINT64 audioFramesSent = 0;
+    UINT64 bytesSent = 0;
+};
+
+VOID LoopbackBenchmark::onConnectionStateChange(UINT64 customData, RTC_PEER_CONNECTION_STATE state)
+{
+    if (state == RTC_PEER_CONNECTION_STATE_CONNECTED) {
+        ((LoopbackBenchmark*) customData)->connectedCount++;
+    }
+}
+
+VOID LoopbackBenchmark::onFrame(UINT64 customData, PFrame pFrame)
+{
+    StreamStats* pStreamStats = (StreamStats*) customData;
+    PBYTE pCur = pFrame->frameData, pEnd = pFrame->frameData + pFrame->size;
+    UINT64 sendTime;
+
+    // Skip the start code the depayloader put back and the NAL header
+    if (pStreamStats->isVideo) {
+        while (pCur < pEnd && *pCur == 0x00) {
+            pCur++;
+        }
+        pCur += 2;
+    }
+
+    if (pCur + LOOPBACK_BENCHMARK_SEND_TIME_LEN <= pEnd &&
+        STATUS_SUCCEEDED(STRTOUI64((PCHAR) pCur, (PCHAR) pCur + LOOPBACK_BENCHMARK_SEND_TIME_LEN, 16, &sendTime))) {
+        latencyHistogramRecord(&pStreamStats->latencyHistogram, GETTIME() - sendTime);
+    }
+    pStreamStats->framesReceived++;
+    pStreamStats->bytesReceived += pFrame->size;
+}
+
+// Video frames of the size of the argument written as fast as they are received, over a network without impairment.
+// The sender stays at most a few frames ahead so that the network queue doesn't grow without bounds.
+BENCHMARK_DEFINE_F(LoopbackBenchmark, BM_LoopbackThroughput)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 frameSize = (UINT32) state.range(0);
+    UINT64 startTime, deadline;
+    clock_t cpuStart;
+
+    CHK_STATUS(connect());
+
+    startTime = GETTIME();
+    cpuStart = clock();
+    for (auto _ : state) {
+        // Frames stop coming back once the connection broke, waiting on them would hang the run
+        deadline = GETTIME() + LOOPBACK_BENCHMARK_STALL_DURATION;
+        while (framesInFlight() > LOOPBACK_BENCHMARK_MAX_FRAMES_IN_FLIGHT && GETTIME() < deadline) {
+            std::this_thread::yield();
+        }
+        if (framesInFlight() > LOOPBACK_BENCHMARK_MAX_FRAMES_IN_FLIGHT) {
+            state.SkipWithError("Sent frames stopped arriving");
+            break;
+        }
+        CHK_STATUS(writeVideoFrame(frameSize));
+    }
+    if (!state.error_occurred()) {
+        reportCounters(state, cpuStart, startTime, 1);
+    }
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Loopback benchmark failed with 0x%08x", retStatus);
+    }
+
+    disconnect();
+}
+
+// A 25 fps video stream and a 50 fps audio stream written in real time over an impaired network, an iteration is a
+// video frame interval. The arguments are the loss (permille), the delay (ms), the jitter (ms), the reordering
+// (permille) and the bandwidth cap (kbps, 0 for none) of each direction.
+BENCHMARK_DEFINE_F(LoopbackBenchmark, BM_LoopbackImpaired)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 startTime, nextTick, now;
+    clock_t cpuStart;
+
+    CHK_STATUS(connect());
+    impair(state);
+
+    startTime = nextTick = GETTIME();
+    cpuStart = clock();
+    for (auto _ : state) {
+        CHK_STATUS(writeVideoFrame(LOOPBACK_BENCHMARK_VIDEO_FRAME_SIZE));
+        for (UINT64 audioTick = 0; audioTick < LOOPBACK_BENCHMARK_VIDEO_FRAME_DURATION; audioTick += LOOPBACK_BENCHMARK_AUDIO_FRAME_DURATION) {
+            CHK_STATUS(writeAudioFrame());
+            nextTick += LOOPBACK_BENCHMARK_AUDIO_FRAME_DURATION;
+            if ((now = GETTIME()) < nextTick) {
+                THREAD_SLEEP(nextTick - now);
+            }
+        }
+    }
+    reportCounters(state, cpuStart, startTime, 2);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Loopback benchmark failed with 0x%08x", retStatus);
+    }
+
+    disconnect();
+}
+
+BENCHMARK_REGISTER_F(LoopbackBenchmark, BM_LoopbackThroughput)->Arg(10 << 10)->Arg(100 << 10)->UseRealTime();
+BENCHMARK_REGISTER_F(LoopbackBenchmark, BM_LoopbackImpaired)
+    ->Args({0, 0, 0, 0, 0})
+    ->Args({0, 40, 10, 0, 0})
+    ->Args({10, 40, 10, 0, 0})
+    ->Args({10, 40, 10, 50, 0})
+    ->Args({10, 40, 10, 0, 2000})
+    ->Iterations(250)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
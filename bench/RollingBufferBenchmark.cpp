@@ -0,0 +1,180 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define ROLLING_BUFFER_BENCHMARK_CAPACITY    (DEFAULT_ROLLING_BUFFER_DURATION_IN_SECONDS * HIGHEST_EXPECTED_BIT_RATE / 8 / DEFAULT_MTU_SIZE)
+#define ROLLING_BUFFER_BENCHMARK_NACK_LENGTH 64
+#define ROLLING_BUFFER_BENCHMARK_PAYLOAD     1100
+
+class RollingBufferBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    static STATUS createSentPacket(PRtpPacket* ppRtpPacket)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        BYTE payload[ROLLING_BUFFER_BENCHMARK_PAYLOAD] = {0};
+        PRtpPacket pRtpPacket = NULL;
+
+        CHK_STATUS(createRtpPacket(2, FALSE, FALSE, 0, FALSE, 96, 0, 100, 0x1234ABCD, NULL, 0, 0, NULL, payload, SIZEOF(payload), &pRtpPacket));
+        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, NULL, &pRtpPacket->rawPacketLength));
+        CHK(NULL != (pRtpPacket->pRawPacket = (PBYTE) MEMALLOC(pRtpPacket->rawPacketLength)), STATUS_NOT_ENOUGH_MEMORY);
+        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, pRtpPacket->pRawPacket, &pRtpPacket->rawPacketLength));
+
+    CleanUp:
+
+        if (STATUS_FAILED(retStatus)) {
+            freeRtpPacket(&pRtpPacket);
+        }
+        *ppRtpPacket = pRtpPacket;
+
+        return retStatus;
+    }
+
+    // What resendPacketOnNack does with the history for a NACK of the last packets sent, short of sending them
+    static STATUS handleNack(PRtpRollingBuffer pRtpRollingBuffer, PUINT16 pSequenceNumberList, PUINT64 pValidIndexList, PUINT32 pResentCount)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        UINT64 lastIndex = (UINT64) ATOMIC_LOAD(&pRtpRollingBuffer->lastIndex), item;
+        UINT32 i, validIndexListLen = ROLLING_BUFFER_BENCHMARK_NACK_LENGTH;
+        PRtpPacket pRtpPacket;
+
+        for (i = 0; i < ROLLING_BUFFER_BENCHMARK_NACK_LENGTH; i++) {
+            pSequenceNumberList[i] = GET_UINT16_SEQ_NUM(lastIndex - ROLLING_BUFFER_BENCHMARK_NACK_LENGTH + i);
+        }
+        CHK_STATUS(rtpRollingBufferGetValidSeqIndexList(pRtpRollingBuffer, pSequenceNumberList, ROLLING_BUFFER_BENCHMARK_NACK_LENGTH,
+                                                        pValidIndexList, &validIndexListLen));
+        for (i = 0; i < validIndexListLen; i++) {
+            CHK_STATUS(rollingBufferExtractData(pRtpRollingBuffer->pRollingBuffer, pValidIndexList[i], &item));
+            if (item == (UINT64) NULL) {
+                continue;
+            }
+            pRtpPacket = (PRtpPacket) item;
+            pRtpPacket->sentTime = GETTIME();
+            (*pResentCount)++;
+            retStatus = rollingBufferInsertData(pRtpRollingBuffer->pRollingBuffer, pValidIndexList[i], item);
+            if (retStatus == STATUS_ROLLING_BUFFER_NOT_IN_RANGE) {
+                freeRtpPacket(&pRtpPacket);
+                retStatus = STATUS_SUCCESS;
+            }
+            CHK_STATUS(retStatus);
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    static VOID nackStormRoutine(PRtpRollingBuffer pRtpRollingBuffer, std::atomic<BOOL>* pStop)
+    {
+        UINT16 sequenceNumberList[ROLLING_BUFFER_BENCHMARK_NACK_LENGTH];
+        UINT64 validIndexList[ROLLING_BUFFER_BENCHMARK_NACK_LENGTH];
+        UINT32 resentCount = 0;
+
+        while (!pStop->load()) {
+            if (STATUS_FAILED(handleNack(pRtpRollingBuffer, sequenceNumberList, validIndexList, &resentCount))) {
+                break;
+            }
+        }
+    }
+
+    static VOID sendRoutine(PRtpRollingBuffer pRtpRollingBuffer, PRtpPacket pRtpPacket, std::atomic<BOOL>* pStop)
+    {
+        while (!pStop->load()) {
+            if (STATUS_FAILED(rtpRollingBufferAddRtpPacket(pRtpRollingBuffer, pRtpPacket))) {
+                break;
+            }
+        }
+    }
+};
+
+// Sender thread adding every packet sent to the history while receive threads keep asking for the last packets again
+BENCHMARK_DEFINE_F(RollingBufferBenchmark, BM_RollingBufferAddUnderNackStorm)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpRollingBuffer pRtpRollingBuffer = NULL;
+    PRtpPacket pRtpPacket = NULL;
+    std::atomic<BOOL> stop(FALSE);
+    std::vector<std::thread> nackThreads;
+    INT64 i;
+
+    CHK_STATUS(createRtpRollingBuffer(ROLLING_BUFFER_BENCHMARK_CAPACITY, &pRtpRollingBuffer));
+    CHK_STATUS(createSentPacket(&pRtpPacket));
+    for (i = 0; i < ROLLING_BUFFER_BENCHMARK_CAPACITY; i++) {
+        CHK_STATUS(rtpRollingBufferAddRtpPacket(pRtpRollingBuffer, pRtpPacket));
+    }
+    for (i = 0; i < state.range(0); i++) {
+        nackThreads.push_back(std::thread(nackStormRoutine, pRtpRollingBuffer, &stop));
+    }
+
+    for (auto _ : state) {
+        CHK_STATUS(rtpRollingBufferAddRtpPacket(pRtpRollingBuffer, pRtpPacket));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Rolling buffer benchmark failed with 0x%08x", retStatus);
+    }
+
+    stop = TRUE;
+    for (auto& nackThread : nackThreads) {
+        nackThread.join();
+    }
+    freeRtpRollingBuffer(&pRtpRollingBuffer);
+    freeRtpPacket(&pRtpPacket);
+}
+
+// NACKs of the last 64 packets handled while the sender keeps adding packets and other receive threads hit the same history
+BENCHMARK_DEFINE_F(RollingBufferBenchmark, BM_RollingBufferNackStormWhileSending)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpRollingBuffer pRtpRollingBuffer = NULL;
+    PRtpPacket pRtpPacket = NULL;
+    std::atomic<BOOL> stop(FALSE);
+    std::vector<std::thread> threads;
+    UINT16 sequenceNumberList[ROLLING_BUFFER_BENCHMARK_NACK_LENGTH];
+    UINT64 validIndexList[ROLLING_BUFFER_BENCHMARK_NACK_LENGTH];
+    UINT32 resentCount = 0;
+    INT64 i;
+
+    CHK_STATUS(createRtpRollingBuffer(ROLLING_BUFFER_BENCHMARK_CAPACITY, &pRtpRollingBuffer));
+    CHK_STATUS(createSentPacket(&pRtpPacket));
+    for (i = 0; i < ROLLING_BUFFER_BENCHMARK_CAPACITY; i++) {
+        CHK_STATUS(rtpRollingBufferAddRtpPacket(pRtpRollingBuffer, pRtpPacket));
+    }
+    threads.push_back(std::thread(sendRoutine, pRtpRollingBuffer, pRtpPacket, &stop));
+    for (i = 1; i < state.range(0); i++) {
+        threads.push_back(std::thread(nackStormRoutine, pRtpRollingBuffer, &stop));
+    }
+
+    for (auto _ : state) {
+        CHK_STATUS(handleNack(pRtpRollingBuffer, sequenceNumberList, validIndexList, &resentCount));
+    }
+    state.SetItemsProcessed((INT64) resentCount);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Rolling buffer benchmark failed with 0x%08x", retStatus);
+    }
+
+    stop = TRUE;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    freeRtpRollingBuffer(&pRtpRollingBuffer);
+    freeRtpPacket(&pRtpPacket);
+}
+
+BENCHMARK_REGISTER_F(RollingBufferBenchmark, BM_RollingBufferAddUnderNackStorm)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+BENCHMARK_REGISTER_F(RollingBufferBenchmark, BM_RollingBufferNackStormWhileSending)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
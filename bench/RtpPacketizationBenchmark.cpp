@@ -0,0 +1,180 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define RTP_PACKETIZATION_BENCHMARK_MTU         1200
+#define RTP_PACKETIZATION_BENCHMARK_HEADER_ROOM 64
+
+typedef STATUS (*TwoPassPayloadFunc)(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+
+class RtpPacketizationBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    // Annex-B frame of 10KB slices so every codec gets the same input, non H264 payloaders ignore the start codes
+    static std::vector<BYTE> createFrame(UINT32 frameSize)
+    {
+        std::vector<BYTE> frame(frameSize);
+        UINT32 i;
+
+        for (i = 0; i < frameSize; i++) {
+            frame[i] = (BYTE) (i % 251 + 2);
+        }
+        for (i = 0; i + 4 <= frameSize; i += 10 * 1024) {
+            frame[i] = 0x00;
+            frame[i + 1] = 0x00;
+            frame[i + 2] = 0x00;
+            frame[i + 3] = 0x01;
+        }
+
+        return frame;
+    }
+
+    static VOID getPayloadFuncs(INT64 codec, TwoPassPayloadFunc* pTwoPassFn, RtpPayloadArrayFunc* pSinglePassFn)
+    {
+        switch (codec) {
+            case RTC_CODEC_VP8:
+                *pTwoPassFn = createPayloadForVP8;
+                *pSinglePassFn = createPayloadArrayForVP8;
+                break;
+            case RTC_CODEC_OPUS:
+                *pTwoPassFn = createPayloadForOpus;
+                *pSinglePassFn = createPayloadArrayForOpus;
+                break;
+            case RTC_CODEC_MULAW:
+                *pTwoPassFn = createPayloadForG711;
+                *pSinglePassFn = createPayloadArrayForG711;
+                break;
+            default:
+                *pTwoPassFn = createPayloadForH264;
+                *pSinglePassFn = createPayloadArrayForH264;
+                break;
+        }
+    }
+
+    // Packetize into RTP and serialize every packet, like writeFrame does before encryption
+    static STATUS serializePackets(PPayloadArray pPayloadArray, PRtpPacket pPacketList, PBYTE rawPacket, UINT32 rawPacketSize)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        UINT32 i, packetLen;
+
+        CHK_STATUS(constructRtpPackets(pPayloadArray, 96, 0, 0, 0x1234ABCD, pPacketList, pPayloadArray->payloadSubLenSize));
+        for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
+            packetLen = rawPacketSize;
+            CHK_STATUS(createBytesFromRtpPacket(pPacketList + i, rawPacket, &packetLen));
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+};
+
+// Size pass, buffer allocation and fill pass, followed by per frame packet list and per packet raw buffer allocations
+BENCHMARK_DEFINE_F(RtpPacketizationBenchmark, BM_RtpPacketizeTwoPass)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    std::vector<BYTE> frame = createFrame((UINT32) state.range(1));
+    TwoPassPayloadFunc twoPassFn;
+    RtpPayloadArrayFunc singlePassFn;
+    PayloadArray payloadArray;
+    PRtpPacket pPacketList = NULL;
+    PBYTE rawPacket = NULL;
+    UINT32 i, packetLen;
+
+    getPayloadFuncs(state.range(0), &twoPassFn, &singlePassFn);
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+
+    for (auto _ : state) {
+        CHK_STATUS(twoPassFn(RTP_PACKETIZATION_BENCHMARK_MTU, frame.data(), (UINT32) frame.size(), NULL, &payloadArray.payloadLength, NULL,
+                             &payloadArray.payloadSubLenSize));
+        if (payloadArray.payloadLength > payloadArray.maxPayloadLength) {
+            SAFE_MEMFREE(payloadArray.payloadBuffer);
+            payloadArray.payloadBuffer = (PBYTE) MEMALLOC(payloadArray.payloadLength);
+            payloadArray.maxPayloadLength = payloadArray.payloadLength;
+        }
+        if (payloadArray.payloadSubLenSize > payloadArray.maxPayloadSubLenSize) {
+            SAFE_MEMFREE(payloadArray.payloadSubLength);
+            payloadArray.payloadSubLength = (PUINT32) MEMALLOC(payloadArray.payloadSubLenSize * SIZEOF(UINT32));
+            payloadArray.maxPayloadSubLenSize = payloadArray.payloadSubLenSize;
+        }
+        CHK_STATUS(twoPassFn(RTP_PACKETIZATION_BENCHMARK_MTU, frame.data(), (UINT32) frame.size(), payloadArray.payloadBuffer,
+                             &payloadArray.payloadLength, payloadArray.payloadSubLength, &payloadArray.payloadSubLenSize));
+
+        CHK(NULL != (pPacketList = (PRtpPacket) MEMALLOC(payloadArray.payloadSubLenSize * SIZEOF(RtpPacket))), STATUS_NOT_ENOUGH_MEMORY);
+        CHK_STATUS(constructRtpPackets(&payloadArray, 96, 0, 0, 0x1234ABCD, pPacketList, payloadArray.payloadSubLenSize));
+        for (i = 0; i < payloadArray.payloadSubLenSize; i++) {
+            CHK_STATUS(createBytesFromRtpPacket(pPacketList + i, NULL, &packetLen));
+            CHK(NULL != (rawPacket = (PBYTE) MEMALLOC(packetLen + SRTP_AUTH_TAG_OVERHEAD)), STATUS_NOT_ENOUGH_MEMORY);
+            CHK_STATUS(createBytesFromRtpPacket(pPacketList + i, rawPacket, &packetLen));
+            SAFE_MEMFREE(rawPacket);
+        }
+        SAFE_MEMFREE(pPacketList);
+    }
+    state.SetBytesProcessed((INT64) state.iterations() * (INT64) frame.size());
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Rtp packetization benchmark failed with 0x%08x", retStatus);
+    }
+
+    SAFE_MEMFREE(rawPacket);
+    SAFE_MEMFREE(pPacketList);
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+// Single pass into a reused payload array, packet list and raw packet buffer
+BENCHMARK_DEFINE_F(RtpPacketizationBenchmark, BM_RtpPacketizeSinglePass)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    std::vector<BYTE> frame = createFrame((UINT32) state.range(1));
+    TwoPassPayloadFunc twoPassFn;
+    RtpPayloadArrayFunc singlePassFn;
+    PayloadArray payloadArray;
+    std::vector<RtpPacket> packetList;
+    // Payloads never exceed the MTU, leave room for the RTP header and the SRTP tag
+    std::vector<BYTE> rawPacket(RTP_PACKETIZATION_BENCHMARK_MTU + RTP_PACKETIZATION_BENCHMARK_HEADER_ROOM + SRTP_AUTH_TAG_OVERHEAD);
+
+    getPayloadFuncs(state.range(0), &twoPassFn, &singlePassFn);
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+
+    for (auto _ : state) {
+        CHK_STATUS(singlePassFn(RTP_PACKETIZATION_BENCHMARK_MTU, frame.data(), (UINT32) frame.size(), &payloadArray));
+        if (payloadArray.payloadSubLenSize > packetList.size()) {
+            packetList.resize(payloadArray.payloadSubLenSize);
+        }
+        CHK_STATUS(serializePackets(&payloadArray, packetList.data(), rawPacket.data(), (UINT32) rawPacket.size()));
+    }
+    state.SetBytesProcessed((INT64) state.iterations() * (INT64) frame.size());
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Rtp packetization benchmark failed with 0x%08x", retStatus);
+    }
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+static VOID rtpPacketizationArguments(benchmark::internal::Benchmark* pBenchmark)
+{
+    // Audio frames are small, video frames range from a P frame to a large key frame
+    pBenchmark->Args({RTC_CODEC_OPUS, 160})->Args({RTC_CODEC_MULAW, 160});
+    for (INT64 frameSize : {10 << 10, 100 << 10, 1 << 20}) {
+        pBenchmark->Args({RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE, frameSize})->Args({RTC_CODEC_VP8, frameSize});
+    }
+}
+
+BENCHMARK_REGISTER_F(RtpPacketizationBenchmark, BM_RtpPacketizeTwoPass)->Apply(rtpPacketizationArguments);
+BENCHMARK_REGISTER_F(RtpPacketizationBenchmark, BM_RtpPacketizeSinglePass)->Apply(rtpPacketizationArguments);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,252 @@
+#include "WebRTCClientBenchmarkFixture.h"
+#include <condition_variable>
+#include <ctime>
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define SCTP_BENCHMARK_MESSAGE_SIZE   (16 * 1024)
+#define SCTP_BENCHMARK_TRANSFER_SIZE  (4 * 1024 * 1024)
+#define SCTP_BENCHMARK_LOW_THRESHOLD  (64 * 1024)
+#define SCTP_BENCHMARK_AWAIT_DURATION (10 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+class SctpBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    // Connects the two PeerConnections over an in-memory transport, the pump thread stands in for the ICE receive thread
+    // of both ends and is woken up by every packet
+    STATUS startLoopback(PRtcPeerConnection offerPc, PRtcPeerConnection answerPc)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        PKvsPeerConnection pOfferKvsPc = (PKvsPeerConnection) offerPc, pAnswerKvsPc = (PKvsPeerConnection) answerPc;
+
+        ATOMIC_STORE_BOOL(&pOfferKvsPc->sctpIsEnabled, TRUE);
+        ATOMIC_STORE_BOOL(&pAnswerKvsPc->sctpIsEnabled, TRUE);
+        pOfferKvsPc->dtlsIsServer = FALSE;
+        pAnswerKvsPc->dtlsIsServer = TRUE;
+        CHK_STATUS(dtlsSessionGetLocalCertificateFingerprint(pAnswerKvsPc->pDtlsSession, pOfferKvsPc->remoteCertificateFingerprint,
+                                                             CERTIFICATE_FINGERPRINT_LENGTH));
+        CHK_STATUS(dtlsSessionGetLocalCertificateFingerprint(pOfferKvsPc->pDtlsSession, pAnswerKvsPc->remoteCertificateFingerprint,
+                                                             CERTIFICATE_FINGERPRINT_LENGTH));
+
+        CHK_STATUS(dtlsSessionOnOutBoundData(pOfferKvsPc->pDtlsSession, (UINT64) &toAnswer, onOutboundPacket));
+        CHK_STATUS(dtlsSessionOnOutBoundData(pAnswerKvsPc->pDtlsSession, (UINT64) &toOffer, onOutboundPacket));
+
+        stopPump = false;
+        pump = std::thread([this, pOfferKvsPc, pAnswerKvsPc]() {
+            std::queue<std::vector<BYTE>> pending;
+            std::unique_lock<std::mutex> lock(this->lock);
+            while (!stopPump) {
+                for (auto link : {std::make_pair(&toOffer, pOfferKvsPc), std::make_pair(&toAnswer, pAnswerKvsPc)}) {
+                    link.first->packets.swap(pending);
+                    lock.unlock();
+                    for (; !pending.empty(); pending.pop()) {
+                        processInboundPacket((UINT64) link.second, pending.front().data(), (UINT32) pending.front().size());
+                    }
+                    lock.lock();
+                }
+                if (toOffer.packets.empty() && toAnswer.packets.empty() && !stopPump) {
+                    // DTLS retransmissions during the handshake are timer driven
+                    cvar.wait_for(lock, std::chrono::milliseconds(10));
+                }
+            }
+        });
+
+        CHK_STATUS(dtlsSessionStart(pOfferKvsPc->pDtlsSession, FALSE));
+        CHK_STATUS(dtlsSessionStart(pAnswerKvsPc->pDtlsSession, TRUE));
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    VOID stopLoopback()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopPump = true;
+        }
+        cvar.notify_one();
+        if (pump.joinable()) {
+            pump.join();
+        }
+    }
+
+    // Sends transferSize bytes as fast as the non-blocking DataChannel takes them and waits for all of them to arrive
+    STATUS transfer(PRtcDataChannel pDataChannel, PBYTE pMessage, UINT64 transferSize)
+    {
+        STATUS retStatus = STATUS_SUCCESS, sendStatus;
+        UINT64 sent = 0, bufferedAmount, expected = bytesReceived + transferSize, deadline = GETTIME() + SCTP_BENCHMARK_AWAIT_DURATION;
+
+        while (sent < transferSize) {
+            CHK(GETTIME() < deadline, STATUS_OPERATION_TIMED_OUT);
+            sendStatus = dataChannelSend(pDataChannel, TRUE, pMessage, SCTP_BENCHMARK_MESSAGE_SIZE);
+            if (sendStatus == STATUS_SCTP_SEND_WOULD_BLOCK) {
+                do {
+                    THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+                    CHK_STATUS(dataChannelGetBufferedAmount(pDataChannel, &bufferedAmount));
+                } while (bufferedAmount > SCTP_BENCHMARK_LOW_THRESHOLD && GETTIME() < deadline);
+                continue;
+            }
+            CHK_STATUS(sendStatus);
+            sent += SCTP_BENCHMARK_MESSAGE_SIZE;
+        }
+
+        while (bytesReceived < expected) {
+            CHK(GETTIME() < deadline, STATUS_OPERATION_TIMED_OUT);
+            THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    static VOID onOutboundPacket(UINT64 customData, PBYTE pData, UINT32 dataLen);
+    static VOID onDataChannel(UINT64 customData, PRtcDataChannel pRtcDataChannel);
+    static VOID onMessage(UINT64 customData, PRtcDataChannel pDataChannel, BOOL isBinary, PBYTE pMessage, UINT32 messageLen);
+    static VOID onOwnedMessage(UINT64 customData, PRtcDataChannel pDataChannel, BOOL isBinary, PBYTE pMessage, UINT32 messageLen);
+
+  protected:
+    struct LoopbackLink {
+        SctpBenchmark* pBenchmark;
+        std::queue<std::vector<BYTE>> packets;
+    };
+
+    std::mutex lock;
+    std::condition_variable cvar;
+    LoopbackLink toOffer{this, {}}, toAnswer{this, {}};
+    bool stopPump = false;
+    std::thread pump;
+
+  public:
+    bool ownedDelivery = false;
+    std::atomic<PRtcDataChannel> pRemoteDataChannel{nullptr};
+    std::atomic<UINT64> bytesReceived{0};
+};
+
+VOID SctpBenchmark::onOutboundPacket(UINT64 customData, PBYTE pData, UINT32 dataLen)
+{
+    LoopbackLink* pLink = (LoopbackLink*) customData;
+    {
+        std::lock_guard<std::mutex> guard(pLink->pBenchmark->lock);
+        pLink->packets.push(std::vector<BYTE>(pData, pData + dataLen));
+    }
+    pLink->pBenchmark->cvar.notify_one();
+}
+
+VOID SctpBenchmark::onDataChannel(UINT64 customData, PRtcDataChannel pRtcDataChannel)
+{
+    if (((SctpBenchmark*) customData)->ownedDelivery) {
+        dataChannelOnOwnedMessage(pRtcDataChannel, customData, onOwnedMessage);
+    } else {
+        dataChannelOnMessage(pRtcDataChannel, customData, onMessage);
+    }
+    ((SctpBenchmark*) customData)->pRemoteDataChannel = pRtcDataChannel;
+}
+
+VOID SctpBenchmark::onMessage(UINT64 customData, PRtcDataChannel pDataChannel, BOOL isBinary, PBYTE pMessage, UINT32 messageLen)
+{
+    UNUSED_PARAM(pDataChannel);
+    UNUSED_PARAM(isBinary);
+    // An application that keeps the message past the callback has to copy it
+    std::vector<BYTE> message(pMessage, pMessage + messageLen);
+    benchmark::DoNotOptimize(message.data());
+    ((SctpBenchmark*) customData)->bytesReceived += messageLen;
+}
+
+VOID SctpBenchmark::onOwnedMessage(UINT64 customData, PRtcDataChannel pDataChannel, BOOL isBinary, PBYTE pMessage, UINT32 messageLen)
+{
+    UNUSED_PARAM(pDataChannel);
+    UNUSED_PARAM(isBinary);
+    benchmark::DoNotOptimize(pMessage);
+    dataChannelFreeMessage(pMessage);
+    ((SctpBenchmark*) customData)->bytesReceived += messageLen;
+}
+
+// Bulk transfer over a DataChannel between two PeerConnections with the MTU configured to the first argument. The SCTP
+// packets start at the size the default MTU allows and grow to what the configured MTU allows once probed, which
+// is done before the measurement. The second argument is how the received messages are kept by the application,
+// copied out of the callback (0) or taken over with the buffer (1)
+BENCHMARK_DEFINE_F(SctpBenchmark, BM_SctpBulkTransfer)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+    PRtcDataChannel pOfferDataChannel = NULL;
+    PSctpSession pSctpSession;
+    std::vector<BYTE> message(SCTP_BENCHMARK_MESSAGE_SIZE, 0x5a);
+    UINT64 deadline;
+    clock_t cpuStart;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    configuration.kvsRtcConfiguration.maximumTransmissionUnit = (UINT16) state.range(0);
+    ownedDelivery = state.range(1) != 0;
+
+    CHK_STATUS(createPeerConnection(&configuration, &offerPc));
+    CHK_STATUS(createPeerConnection(&configuration, &answerPc));
+
+    CHK_STATUS(peerConnectionOnDataChannel(answerPc, (UINT64) this, onDataChannel));
+    CHK_STATUS(createDataChannel(offerPc, (PCHAR) "Bulk", NULL, &pOfferDataChannel));
+    CHK_STATUS(dataChannelSetNonBlocking(pOfferDataChannel, TRUE));
+
+    CHK_STATUS(startLoopback(offerPc, answerPc));
+
+    deadline = GETTIME() + SCTP_BENCHMARK_AWAIT_DURATION;
+    while (pRemoteDataChannel.load() == nullptr) {
+        CHK(GETTIME() < deadline, STATUS_OPERATION_TIMED_OUT);
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    // Probes go out as packets are received, so there has to be traffic until the search is done
+    pSctpSession = ((PKvsPeerConnection) offerPc)->pSctpSession;
+    while (pSctpSession->pmtuProbeState == SCTP_PMTU_PROBE_STATE_SEARCHING) {
+        CHK(GETTIME() < deadline, STATUS_OPERATION_TIMED_OUT);
+        CHK_STATUS(transfer(pOfferDataChannel, message.data(), SCTP_BENCHMARK_MESSAGE_SIZE));
+    }
+
+    cpuStart = clock();
+    for (auto _ : state) {
+        CHK_STATUS(transfer(pOfferDataChannel, message.data(), SCTP_BENCHMARK_TRANSFER_SIZE));
+    }
+    // Both ends run in this process, so this is the CPU time of sending and of receiving
+    state.counters["cpuMsPerMB"] = (DOUBLE) (clock() - cpuStart) * 1000 / CLOCKS_PER_SEC /
+        ((DOUBLE) state.iterations() * SCTP_BENCHMARK_TRANSFER_SIZE / (1024 * 1024));
+    state.SetBytesProcessed((INT64) state.iterations() * SCTP_BENCHMARK_TRANSFER_SIZE);
+    state.counters["sctpPacketSize"] = pSctpSession->packetSize;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Sctp benchmark failed with 0x%08x", retStatus);
+    }
+
+    stopLoopback();
+
+    if (offerPc != NULL) {
+        closePeerConnection(offerPc);
+        freePeerConnection(&offerPc);
+    }
+
+    if (answerPc != NULL) {
+        closePeerConnection(answerPc);
+        freePeerConnection(&answerPc);
+    }
+}
+
+BENCHMARK_REGISTER_F(SctpBenchmark, BM_SctpBulkTransfer)
+    ->Args({DEFAULT_MTU_SIZE, 0})
+    ->Args({DEFAULT_MTU_SIZE, 1})
+    ->Args({1500, 0})
+    ->Args({1500, 1})
+    ->Args({9000, 0})
+    ->Args({9000, 1})
+    ->UseRealTime();
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
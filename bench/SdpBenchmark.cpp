@@ -0,0 +1,276 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+// Audio, video and data channel offer from a desktop browser, candidates included
+static const CHAR SDP_BENCHMARK_OFFER[] = "v=0\r\n"
+                                          "o=- 4420233394185736958 2 IN IP4 127.0.0.1\r\n"
+                                          "s=-\r\n"
+                                          "t=0 0\r\n"
+                                          "a=group:BUNDLE 0 1 2\r\n"
+                                          "a=extmap-allow-mixed\r\n"
+                                          "a=msid-semantic: WMS 7b4a3e0a-6a67-4d5b-9c68-8b0d2a3f3c21\r\n"
+                                          "m=audio 9 UDP/TLS/RTP/SAVPF 111 63 9 0 8 13 110 126\r\n"
+                                          "c=IN IP4 0.0.0.0\r\n"
+                                          "a=rtcp:9 IN IP4 0.0.0.0\r\n"
+                                          "a=candidate:2315209435 1 udp 2122260223 192.168.1.20 54921 typ host generation 0 network-id 1\r\n"
+                                          "a=candidate:3490613727 1 udp 1686052607 203.0.113.7 54921 typ srflx raddr 192.168.1.20 rport 54921\r\n"
+                                          "a=candidate:1119411883 1 tcp 1518280447 192.168.1.20 9 typ host tcptype active generation 0\r\n"
+                                          "a=ice-ufrag:Tz5h\r\n"
+                                          "a=ice-pwd:4Ew2nZ2gkHRpAPS4ndq4mRgL\r\n"
+                                          "a=ice-options:trickle\r\n"
+                                          "a=fingerprint:sha-256 87:E6:EC:59:93:76:9F:42:7D:15:17:F6:8F:C4:29:AB:EA:3F:28:B6:DF:F8:14:2F:96:62:2F:16:98:"
+                                          "F5:76:E5\r\n"
+                                          "a=setup:actpass\r\n"
+                                          "a=mid:0\r\n"
+                                          "a=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n"
+                                          "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+                                          "a=extmap:3 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+                                          "a=extmap:4 urn:ietf:params:rtp-hdrext:sdes:mid\r\n"
+                                          "a=sendrecv\r\n"
+                                          "a=msid:7b4a3e0a-6a67-4d5b-9c68-8b0d2a3f3c21 0f0a5b2e-53a1-4f3c-9d0a-2cf7a9e4b1d8\r\n"
+                                          "a=rtcp-mux\r\n"
+                                          "a=rtpmap:111 opus/48000/2\r\n"
+                                          "a=rtcp-fb:111 transport-cc\r\n"
+                                          "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+                                          "a=rtpmap:63 red/48000/2\r\n"
+                                          "a=fmtp:63 111/111\r\n"
+                                          "a=rtpmap:9 G722/8000\r\n"
+                                          "a=rtpmap:0 PCMU/8000\r\n"
+                                          "a=rtpmap:8 PCMA/8000\r\n"
+                                          "a=rtpmap:13 CN/8000\r\n"
+                                          "a=rtpmap:110 telephone-event/48000\r\n"
+                                          "a=rtpmap:126 telephone-event/8000\r\n"
+                                          "a=ssrc:1713890283 cname:Ql1MKEnV3j3y1aFt\r\n"
+                                          "a=ssrc:1713890283 msid:7b4a3e0a-6a67-4d5b-9c68-8b0d2a3f3c21 0f0a5b2e-53a1-4f3c-9d0a-2cf7a9e4b1d8\r\n"
+                                          "m=video 9 UDP/TLS/RTP/SAVPF 96 97 102 103 104 105 106 107 108 109 127 125\r\n"
+                                          "c=IN IP4 0.0.0.0\r\n"
+                                          "a=rtcp:9 IN IP4 0.0.0.0\r\n"
+                                          "a=ice-ufrag:Tz5h\r\n"
+                                          "a=ice-pwd:4Ew2nZ2gkHRpAPS4ndq4mRgL\r\n"
+                                          "a=ice-options:trickle\r\n"
+                                          "a=fingerprint:sha-256 87:E6:EC:59:93:76:9F:42:7D:15:17:F6:8F:C4:29:AB:EA:3F:28:B6:DF:F8:14:2F:96:62:2F:16:98:"
+                                          "F5:76:E5\r\n"
+                                          "a=setup:actpass\r\n"
+                                          "a=mid:1\r\n"
+                                          "a=extmap:14 urn:ietf:params:rtp-hdrext:toffset\r\n"
+                                          "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+                                          "a=extmap:13 urn:3gpp:video-orientation\r\n"
+                                          "a=extmap:3 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+                                          "a=extmap:4 urn:ietf:params:rtp-hdrext:sdes:mid\r\n"
+                                          "a=sendrecv\r\n"
+                                          "a=msid:7b4a3e0a-6a67-4d5b-9c68-8b0d2a3f3c21 5d1c7f0e-8a44-4b1e-a3f9-1c2b9e8d7a60\r\n"
+                                          "a=rtcp-mux\r\n"
+                                          "a=rtcp-rsize\r\n"
+                                          "a=rtpmap:96 VP8/90000\r\n"
+                                          "a=rtcp-fb:96 goog-remb\r\n"
+                                          "a=rtcp-fb:96 transport-cc\r\n"
+                                          "a=rtcp-fb:96 ccm fir\r\n"
+                                          "a=rtcp-fb:96 nack\r\n"
+                                          "a=rtcp-fb:96 nack pli\r\n"
+                                          "a=rtpmap:97 rtx/90000\r\n"
+                                          "a=fmtp:97 apt=96\r\n"
+                                          "a=rtpmap:102 H264/90000\r\n"
+                                          "a=rtcp-fb:102 goog-remb\r\n"
+                                          "a=rtcp-fb:102 transport-cc\r\n"
+                                          "a=rtcp-fb:102 ccm fir\r\n"
+                                          "a=rtcp-fb:102 nack\r\n"
+                                          "a=rtcp-fb:102 nack pli\r\n"
+                                          "a=fmtp:102 level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42001f\r\n"
+                                          "a=rtpmap:103 rtx/90000\r\n"
+                                          "a=fmtp:103 apt=102\r\n"
+                                          "a=rtpmap:104 H264/90000\r\n"
+                                          "a=rtcp-fb:104 goog-remb\r\n"
+                                          "a=rtcp-fb:104 transport-cc\r\n"
+                                          "a=rtcp-fb:104 ccm fir\r\n"
+                                          "a=rtcp-fb:104 nack\r\n"
+                                          "a=rtcp-fb:104 nack pli\r\n"
+                                          "a=fmtp:104 level-asymmetry-allowed=1;packetization-mode=0;profile-level-id=42001f\r\n"
+                                          "a=rtpmap:105 rtx/90000\r\n"
+                                          "a=fmtp:105 apt=104\r\n"
+                                          "a=rtpmap:106 H264/90000\r\n"
+                                          "a=rtcp-fb:106 goog-remb\r\n"
+                                          "a=rtcp-fb:106 transport-cc\r\n"
+                                          "a=rtcp-fb:106 ccm fir\r\n"
+                                          "a=rtcp-fb:106 nack\r\n"
+                                          "a=rtcp-fb:106 nack pli\r\n"
+                                          "a=fmtp:106 level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f\r\n"
+                                          "a=rtpmap:107 rtx/90000\r\n"
+                                          "a=fmtp:107 apt=106\r\n"
+                                          "a=rtpmap:108 VP9/90000\r\n"
+                                          "a=rtcp-fb:108 goog-remb\r\n"
+                                          "a=rtcp-fb:108 transport-cc\r\n"
+                                          "a=rtcp-fb:108 ccm fir\r\n"
+                                          "a=rtcp-fb:108 nack\r\n"
+                                          "a=rtcp-fb:108 nack pli\r\n"
+                                          "a=fmtp:108 profile-id=0\r\n"
+                                          "a=rtpmap:109 rtx/90000\r\n"
+                                          "a=fmtp:109 apt=108\r\n"
+                                          "a=rtpmap:127 red/90000\r\n"
+                                          "a=rtpmap:125 ulpfec/90000\r\n"
+                                          "a=ssrc-group:FID 2546733386 1039470165\r\n"
+                                          "a=ssrc:2546733386 cname:Ql1MKEnV3j3y1aFt\r\n"
+                                          "a=ssrc:2546733386 msid:7b4a3e0a-6a67-4d5b-9c68-8b0d2a3f3c21 5d1c7f0e-8a44-4b1e-a3f9-1c2b9e8d7a60\r\n"
+                                          "a=ssrc:1039470165 cname:Ql1MKEnV3j3y1aFt\r\n"
+                                          "a=ssrc:1039470165 msid:7b4a3e0a-6a67-4d5b-9c68-8b0d2a3f3c21 5d1c7f0e-8a44-4b1e-a3f9-1c2b9e8d7a60\r\n"
+                                          "m=application 9 UDP/DTLS/SCTP webrtc-datachannel\r\n"
+                                          "c=IN IP4 0.0.0.0\r\n"
+                                          "a=ice-ufrag:Tz5h\r\n"
+                                          "a=ice-pwd:4Ew2nZ2gkHRpAPS4ndq4mRgL\r\n"
+                                          "a=ice-options:trickle\r\n"
+                                          "a=fingerprint:sha-256 87:E6:EC:59:93:76:9F:42:7D:15:17:F6:8F:C4:29:AB:EA:3F:28:B6:DF:F8:14:2F:96:62:2F:16:98:"
+                                          "F5:76:E5\r\n"
+                                          "a=setup:actpass\r\n"
+                                          "a=mid:2\r\n"
+                                          "a=sctp-port:5000\r\n"
+                                          "a=max-message-size:262144\r\n";
+
+class SdpBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    // What a parsed description holds on to, its index and the arena blocks behind it
+    static UINT64 sessionDescriptionFootprint(PSessionDescription pSessionDescription)
+    {
+        UINT64 footprint = SIZEOF(SessionDescription);
+        PSdpArenaBlock pBlock;
+
+        for (pBlock = pSessionDescription->pArena; pBlock != NULL; pBlock = pBlock->pNext) {
+            footprint += SIZEOF(SdpArenaBlock) + pBlock->size;
+        }
+
+        return footprint;
+    }
+};
+
+BENCHMARK_DEFINE_F(SdpBenchmark, BM_SdpDeserialize)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSessionDescription pSessionDescription = NULL;
+    UINT64 footprint = 0;
+
+    CHK(NULL != (pSessionDescription = (PSessionDescription) MEMCALLOC(1, SIZEOF(SessionDescription))), STATUS_NOT_ENOUGH_MEMORY);
+
+    for (auto _ : state) {
+        CHK_STATUS(deserializeSessionDescription(pSessionDescription, (PCHAR) SDP_BENCHMARK_OFFER));
+        footprint = sessionDescriptionFootprint(pSessionDescription);
+        CHK_STATUS(resetSessionDescription(pSessionDescription));
+    }
+    state.SetBytesProcessed(state.iterations() * (INT64) STRLEN(SDP_BENCHMARK_OFFER));
+    state.counters["bytesPerDescription"] = (DOUBLE) footprint;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("SDP benchmark failed with 0x%08x", retStatus);
+    }
+
+    if (pSessionDescription != NULL) {
+        resetSessionDescription(pSessionDescription);
+    }
+    SAFE_MEMFREE(pSessionDescription);
+}
+
+BENCHMARK_DEFINE_F(SdpBenchmark, BM_SdpSerialize)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSessionDescription pSessionDescription = NULL;
+    CHAR sdp[SIZEOF(SDP_BENCHMARK_OFFER) + 64];
+    UINT32 sdpLength = 0;
+
+    CHK(NULL != (pSessionDescription = (PSessionDescription) MEMCALLOC(1, SIZEOF(SessionDescription))), STATUS_NOT_ENOUGH_MEMORY);
+    CHK_STATUS(deserializeSessionDescription(pSessionDescription, (PCHAR) SDP_BENCHMARK_OFFER));
+
+    for (auto _ : state) {
+        sdpLength = SIZEOF(sdp);
+        CHK_STATUS(serializeSessionDescription(pSessionDescription, sdp, &sdpLength));
+    }
+    state.SetBytesProcessed(state.iterations() * (INT64) sdpLength);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("SDP benchmark failed with 0x%08x", retStatus);
+    }
+
+    if (pSessionDescription != NULL) {
+        resetSessionDescription(pSessionDescription);
+    }
+    SAFE_MEMFREE(pSessionDescription);
+}
+
+// Offer of an audio and video peer connection, populated and serialized (0) or rendered from the configuration's template (1)
+BENCHMARK_DEFINE_F(SdpBenchmark, BM_SdpCreateOffer)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+    PKvsPeerConnection pKvsPeerConnection;
+    PSessionDescription pSessionDescription = NULL;
+    RtcConfiguration rtcConfiguration;
+    RtcMediaStreamTrack track;
+    RtcRtpTransceiverInit rtcRtpTransceiverInit;
+    RtcSessionDescriptionInit offer;
+    BOOL useTemplate = state.range(0) != 0;
+    UINT32 sdpLength = 0;
+
+    MEMSET(&rtcConfiguration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&track, 0x00, SIZEOF(RtcMediaStreamTrack));
+    MEMSET(&offer, 0x00, SIZEOF(RtcSessionDescriptionInit));
+
+    CHK_STATUS(createPeerConnection(&rtcConfiguration, &pRtcPeerConnection));
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV;
+    track.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+    track.codec = RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE;
+    STRCPY(track.streamId, "myKvsVideoStream");
+    STRCPY(track.trackId, "myVideoTrack");
+    CHK_STATUS(addTransceiver(pRtcPeerConnection, &track, &rtcRtpTransceiverInit, &pRtcRtpTransceiver));
+    track.kind = MEDIA_STREAM_TRACK_KIND_AUDIO;
+    track.codec = RTC_CODEC_OPUS;
+    STRCPY(track.trackId, "myAudioTrack");
+    CHK_STATUS(addTransceiver(pRtcPeerConnection, &track, &rtcRtpTransceiverInit, &pRtcRtpTransceiver));
+
+    // Compiles the template
+    CHK_STATUS(createOffer(pRtcPeerConnection, &offer));
+    CHK(NULL != (pSessionDescription = (PSessionDescription) MEMCALLOC(1, SIZEOF(SessionDescription))), STATUS_NOT_ENOUGH_MEMORY);
+
+    for (auto _ : state) {
+        if (useTemplate) {
+            CHK_STATUS(createOffer(pRtcPeerConnection, &offer));
+        } else {
+            CHK_STATUS(populateSessionDescription(pKvsPeerConnection, &pKvsPeerConnection->remoteSessionDescription, pSessionDescription));
+            sdpLength = MAX_SESSION_DESCRIPTION_INIT_SDP_LEN;
+            CHK_STATUS(serializeSessionDescription(pSessionDescription, offer.sdp, &sdpLength));
+            CHK_STATUS(resetSessionDescription(pSessionDescription));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("SDP benchmark failed with 0x%08x", retStatus);
+    }
+
+    if (pSessionDescription != NULL) {
+        resetSessionDescription(pSessionDescription);
+    }
+    SAFE_MEMFREE(pSessionDescription);
+    if (pRtcPeerConnection != NULL) {
+        closePeerConnection(pRtcPeerConnection);
+        freePeerConnection(&pRtcPeerConnection);
+    }
+}
+
+BENCHMARK_REGISTER_F(SdpBenchmark, BM_SdpDeserialize);
+BENCHMARK_REGISTER_F(SdpBenchmark, BM_SdpSerialize);
+BENCHMARK_REGISTER_F(SdpBenchmark, BM_SdpCreateOffer)->Arg(0)->Arg(1);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,128 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define SIGNALING_CACHE_BENCHMARK_V0_FILE_PATH (PCHAR) "./.BenchmarkSignalingCache_v0"
+#define SIGNALING_CACHE_BENCHMARK_FILE_PATH    (PCHAR) "./.BenchmarkSignalingCache_v1"
+#define SIGNALING_CACHE_BENCHMARK_REGION       (PCHAR) "us-west-2"
+
+class SignalingCacheBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    // Full cache with the entry looked up last in it, in both the v0 and the binary file
+    STATUS fillCacheFiles(PCHAR channelName)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        SignalingFileCacheEntry entry;
+        std::string v0Content;
+        CHAR line[MAX_SERIALIZED_SIGNALING_CACHE_ENTRY_LEN];
+        UINT32 i;
+
+        FREMOVE(SIGNALING_CACHE_BENCHMARK_V0_FILE_PATH);
+        FREMOVE(SIGNALING_CACHE_BENCHMARK_FILE_PATH);
+
+        for (i = 0; i < MAX_SIGNALING_CACHE_ENTRY_COUNT; i++) {
+            MEMSET(&entry, 0x00, SIZEOF(entry));
+            entry.role = SIGNALING_CHANNEL_ROLE_TYPE_MASTER;
+            SNPRINTF(entry.channelName, ARRAY_SIZE(entry.channelName), "benchmark-channel-%u", i);
+            STRCPY(entry.region, SIGNALING_CACHE_BENCHMARK_REGION);
+            SNPRINTF(entry.channelArn, ARRAY_SIZE(entry.channelArn), "arn:aws:kinesisvideo:us-west-2:123456789012:channel/%s/1690000000000",
+                     entry.channelName);
+            STRCPY(entry.httpsEndpoint, "https://r-2c136a55.kinesisvideo.us-west-2.amazonaws.com");
+            STRCPY(entry.wssEndpoint, "wss://m-26d02974.kinesisvideo.us-west-2.amazonaws.com");
+            STRCPY(entry.storageEnabled, "0");
+            entry.creationTsEpochSeconds = 1690000000 + i;
+            CHK_STATUS(signalingCacheSaveToFile(&entry, SIGNALING_CACHE_BENCHMARK_FILE_PATH));
+
+            SNPRINTF(line, ARRAY_SIZE(line), "%s,%s,%s,%s,%s,%s,%s,%s,%s,%.10" PRIu64 "\n", entry.channelName,
+                     SIGNALING_FILE_CACHE_ROLE_TYPE_MASTER_STR, entry.region, entry.channelArn, entry.httpsEndpoint, entry.wssEndpoint,
+                     entry.storageEnabled, entry.storageStreamArn, entry.webrtcEndpoint, entry.creationTsEpochSeconds);
+            v0Content += line;
+        }
+
+        CHK_STATUS(writeFile(SIGNALING_CACHE_BENCHMARK_V0_FILE_PATH, FALSE, FALSE, (PBYTE) v0Content.c_str(), v0Content.size()));
+        STRCPY(channelName, entry.channelName);
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    // What every load did before the binary file, read and tokenize all of the file and scan the entries
+    STATUS loadFromV0File(PCHAR channelName, PSignalingFileCacheEntry pEntry, PBOOL pCacheFound)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        SignalingFileCacheEntry entries[MAX_SIGNALING_CACHE_ENTRY_COUNT];
+        UINT32 entryCount = ARRAY_SIZE(entries), i;
+        UINT64 fileSize = 0;
+        std::vector<CHAR> fileBuffer;
+
+        MEMSET(entries, 0x00, SIZEOF(entries));
+        *pCacheFound = FALSE;
+
+        CHK_STATUS(readFile(SIGNALING_CACHE_BENCHMARK_V0_FILE_PATH, FALSE, NULL, &fileSize));
+        fileBuffer.resize(fileSize + 1);
+        CHK_STATUS(readFile(SIGNALING_CACHE_BENCHMARK_V0_FILE_PATH, FALSE, (PBYTE) fileBuffer.data(), &fileSize));
+        CHK_STATUS(deserializeSignalingCacheEntries(fileBuffer.data(), fileSize, entries, &entryCount, SIGNALING_CACHE_BENCHMARK_V0_FILE_PATH));
+
+        for (i = 0; !*pCacheFound && i < entryCount; i++) {
+            if (STRCMP(entries[i].channelName, channelName) == 0 && STRCMP(entries[i].region, SIGNALING_CACHE_BENCHMARK_REGION) == 0 &&
+                entries[i].role == SIGNALING_CHANNEL_ROLE_TYPE_MASTER) {
+                *pCacheFound = TRUE;
+                *pEntry = entries[i];
+            }
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+};
+
+// Lookup of the last of 32 entries: parsing the v0 file (0), mapping the binary file and building its index (1), and
+// through the index of the already mapped file (2)
+BENCHMARK_DEFINE_F(SignalingCacheBenchmark, BM_SignalingCacheLoad)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    SignalingFileCacheEntry entry;
+    CHAR channelName[MAX_CHANNEL_NAME_LEN + 1];
+    BOOL cacheFound = FALSE;
+
+    CHK_STATUS(fillCacheFiles(channelName));
+
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            CHK_STATUS(loadFromV0File(channelName, &entry, &cacheFound));
+        } else {
+            if (state.range(0) == 1) {
+                // Cold start, nothing mapped yet
+                deinitSignalingFileCache();
+            }
+            CHK_STATUS(signalingCacheLoadFromFile(channelName, SIGNALING_CACHE_BENCHMARK_REGION, SIGNALING_CHANNEL_ROLE_TYPE_MASTER, &entry,
+                                                  &cacheFound, SIGNALING_CACHE_BENCHMARK_FILE_PATH));
+        }
+        CHK(cacheFound, STATUS_INTERNAL_ERROR);
+        benchmark::DoNotOptimize(entry.creationTsEpochSeconds);
+    }
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Signaling cache benchmark failed with 0x%08x", retStatus);
+    }
+
+    deinitSignalingFileCache();
+    FREMOVE(SIGNALING_CACHE_BENCHMARK_V0_FILE_PATH);
+    FREMOVE(SIGNALING_CACHE_BENCHMARK_FILE_PATH);
+}
+
+BENCHMARK_REGISTER_F(SignalingCacheBenchmark, BM_SignalingCacheLoad)->Arg(0)->Arg(1)->Arg(2);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
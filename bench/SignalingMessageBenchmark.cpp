@@ -0,0 +1,145 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+// Trickled candidate and offer as a browser sends them through the signaling channel, before base64 encoding
+static const CHAR SIGNALING_BENCHMARK_CANDIDATE[] =
+    "{\"candidate\":\"candidate:2315209435 1 udp 2122260223 192.168.1.20 54921 typ host generation 0 ufrag Tz5h network-id 1\","
+    "\"sdpMid\":\"0\",\"sdpMLineIndex\":0,\"usernameFragment\":\"Tz5h\"}";
+
+static const CHAR SIGNALING_BENCHMARK_OFFER_SDP[] =
+    "v=0\\r\\no=- 4420233394185736958 2 IN IP4 127.0.0.1\\r\\ns=-\\r\\nt=0 0\\r\\n"
+    "a=group:BUNDLE 0 1\\r\\na=msid-semantic: WMS myKvsVideoStream\\r\\n"
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111\\r\\nc=IN IP4 0.0.0.0\\r\\na=rtcp:9 IN IP4 0.0.0.0\\r\\n"
+    "a=ice-ufrag:Tz5h\\r\\na=ice-pwd:4Ew2nZ2gkHRpAPS4ndq4mRgL\\r\\na=ice-options:trickle\\r\\n"
+    "a=fingerprint:sha-256 87:E6:EC:59:93:76:9F:42:7D:15:17:F6:8F:C4:29:AB:EA:3F:28:B6:DF:F8:14:2F:96:"
+    "62:2F:16:98:F5:76:E5\\r\\na=setup:actpass\\r\\na=mid:0\\r\\na=sendrecv\\r\\na=rtcp-mux\\r\\n"
+    "a=rtpmap:111 opus/48000/2\\r\\na=fmtp:111 minptime=10;useinbandfec=1\\r\\n"
+    "a=ssrc:1713890283 cname:Ql1MKEnV3j3y1aFt\\r\\n"
+    "m=video 9 UDP/TLS/RTP/SAVPF 96 97\\r\\nc=IN IP4 0.0.0.0\\r\\na=rtcp:9 IN IP4 0.0.0.0\\r\\n"
+    "a=ice-ufrag:Tz5h\\r\\na=ice-pwd:4Ew2nZ2gkHRpAPS4ndq4mRgL\\r\\na=ice-options:trickle\\r\\n"
+    "a=fingerprint:sha-256 87:E6:EC:59:93:76:9F:42:7D:15:17:F6:8F:C4:29:AB:EA:3F:28:B6:DF:F8:14:2F:96:"
+    "62:2F:16:98:F5:76:E5\\r\\na=setup:actpass\\r\\na=mid:1\\r\\na=sendrecv\\r\\na=rtcp-mux\\r\\n"
+    "a=rtcp-rsize\\r\\na=rtpmap:96 H264/90000\\r\\na=rtcp-fb:96 goog-remb\\r\\na=rtcp-fb:96 nack\\r\\n"
+    "a=rtcp-fb:96 nack pli\\r\\na=fmtp:96 level-asymmetry-allowed=1;packetization-mode=1;"
+    "profile-level-id=42e01f\\r\\na=rtpmap:97 rtx/90000\\r\\na=fmtp:97 apt=96\\r\\n"
+    "a=ssrc-group:FID 2336212310 1853225366\\r\\na=ssrc:2336212310 cname:Ql1MKEnV3j3y1aFt\\r\\n"
+    "a=ssrc:1853225366 cname:Ql1MKEnV3j3y1aFt\\r\\n";
+
+class SignalingMessageBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    // Message of the given type as received over the web socket, the offer one carries an ICE server list
+    STATUS buildMessage(SIGNALING_MESSAGE_TYPE messageType, std::vector<CHAR>& message)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        std::string payload, json;
+        std::vector<CHAR> encoded;
+        UINT32 encodedLen;
+
+        if (messageType == SIGNALING_MESSAGE_TYPE_OFFER) {
+            payload = std::string("{\"type\":\"offer\",\"sdp\":\"") + SIGNALING_BENCHMARK_OFFER_SDP + "\"}";
+        } else {
+            payload = SIGNALING_BENCHMARK_CANDIDATE;
+        }
+
+        CHK_STATUS(base64Encode((PVOID) payload.c_str(), (UINT32) payload.size(), NULL, &encodedLen));
+        encoded.resize(encodedLen);
+        CHK_STATUS(base64Encode((PVOID) payload.c_str(), (UINT32) payload.size(), encoded.data(), &encodedLen));
+
+        json = std::string("{\"senderClientId\":\"ConsoleViewer-4f9a2c\",\"messageType\":\"") +
+            (messageType == SIGNALING_MESSAGE_TYPE_OFFER ? "SDP_OFFER" : "ICE_CANDIDATE") + "\",\"messagePayload\":\"" + encoded.data() + "\"";
+        if (messageType == SIGNALING_MESSAGE_TYPE_OFFER) {
+            json += ",\"IceServerList\":[{\"Password\":\"Zm9vYmFyYmF6cXV4\",\"Ttl\":298,\"Uris\":["
+                    "\"turn:35-90-63-38.t-ae7dd61a.kinesisvideo.us-west-2.amazonaws.com:443?transport=udp\","
+                    "\"turns:35-90-63-38.t-ae7dd61a.kinesisvideo.us-west-2.amazonaws.com:443?transport=udp\","
+                    "\"turns:35-90-63-38.t-ae7dd61a.kinesisvideo.us-west-2.amazonaws.com:443?transport=tcp\"],\"Username\":\"1690000000:"
+                    "djE6YXJuOmF3czpraW5lc2lzdmlkZW8\"}]";
+        }
+        json += ",\"statusResponse\":{\"correlationId\":\"\",\"errorType\":\"\",\"statusCode\":\"200\",\"description\":\"\"}}";
+
+        message.assign(json.begin(), json.end());
+        message.push_back('\0');
+
+    CleanUp:
+
+        return retStatus;
+    }
+};
+
+// ICE candidate (0) or offer with an ICE server list (1), parsed into a message wrapper taken from the free list
+BENCHMARK_DEFINE_F(SignalingMessageBenchmark, BM_SignalingParseMessage)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingClient pSignalingClient = NULL;
+    PSignalingMessageWrapper pSignalingMessageWrapper = NULL;
+    std::vector<CHAR> message;
+    BOOL parsedIceServerList;
+
+    CHK_STATUS(buildMessage(state.range(0) == 0 ? SIGNALING_MESSAGE_TYPE_ICE_CANDIDATE : SIGNALING_MESSAGE_TYPE_OFFER, message));
+    CHK(NULL != (pSignalingClient = (PSignalingClient) MEMCALLOC(1, SIZEOF(SignalingClient))), STATUS_NOT_ENOUGH_MEMORY);
+    CHK_STATUS(createSignalingMessageDispatcher(0, 0, receiveLwsMessageWrapper, &pSignalingClient->pMessageDispatcher));
+
+    for (auto _ : state) {
+        CHK_STATUS(getSignalingMessageWrapper(pSignalingClient, &pSignalingMessageWrapper));
+        CHK_STATUS(parseSignalingMessage(pSignalingClient, message.data(), (UINT32) message.size(),
+                                         &pSignalingMessageWrapper->receivedSignalingMessage, &parsedIceServerList));
+        benchmark::DoNotOptimize(pSignalingMessageWrapper->receivedSignalingMessage.signalingMessage.payloadLen);
+        CHK_STATUS(releaseSignalingMessageWrapper(pSignalingClient, &pSignalingMessageWrapper));
+    }
+    state.SetBytesProcessed(state.iterations() * (INT64) message.size());
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Signaling message benchmark failed with 0x%08x", retStatus);
+    }
+
+    if (pSignalingClient != NULL) {
+        releaseSignalingMessageWrapper(pSignalingClient, &pSignalingMessageWrapper);
+        freeSignalingMessageDispatcher(&pSignalingClient->pMessageDispatcher);
+    }
+    SAFE_MEMFREE(pSignalingClient);
+}
+
+// Only walks the tokens of the message, what any JSON tokenizer has to do at the least
+BENCHMARK_DEFINE_F(SignalingMessageBenchmark, BM_SignalingJsonReader)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    SignalingJsonReader reader;
+    SignalingJsonToken token;
+    std::vector<CHAR> message;
+    UINT32 tokenCount = 0;
+
+    CHK_STATUS(buildMessage(state.range(0) == 0 ? SIGNALING_MESSAGE_TYPE_ICE_CANDIDATE : SIGNALING_MESSAGE_TYPE_OFFER, message));
+
+    for (auto _ : state) {
+        CHK_STATUS(signalingJsonReaderInit(&reader, message.data(), (UINT32) message.size()));
+        tokenCount = 0;
+        do {
+            CHK_STATUS(signalingJsonReaderNext(&reader, &token));
+            tokenCount++;
+        } while (token.type != SIGNALING_JSON_TOKEN_END);
+        benchmark::DoNotOptimize(tokenCount);
+    }
+    state.SetBytesProcessed(state.iterations() * (INT64) message.size());
+    state.counters["tokens"] = (DOUBLE) tokenCount;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Signaling message benchmark failed with 0x%08x", retStatus);
+    }
+}
+
+BENCHMARK_REGISTER_F(SignalingMessageBenchmark, BM_SignalingParseMessage)->Arg(0)->Arg(1);
+BENCHMARK_REGISTER_F(SignalingMessageBenchmark, BM_SignalingJsonReader)->Arg(0)->Arg(1);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
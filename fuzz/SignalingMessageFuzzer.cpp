@@ -0,0 +1,25 @@
+#include "../src/source/Include_i.h"
+
+// Feeds the input to the signaling message parser as if it had been received over the web socket
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* pData, size_t size)
+{
+    static PSignalingClient pSignalingClient = (PSignalingClient) MEMCALLOC(1, SIZEOF(SignalingClient));
+    static PReceivedSignalingMessage pReceivedSignalingMessage = (PReceivedSignalingMessage) MEMCALLOC(1, SIZEOF(ReceivedSignalingMessage));
+    PCHAR pMessage;
+    BOOL parsedIceServerList;
+
+    if (pSignalingClient == NULL || pReceivedSignalingMessage == NULL || size > MAX_UINT32) {
+        return 0;
+    }
+
+    // Own copy of the exact size so that reads past the end are caught
+    if (NULL == (pMessage = (PCHAR) MEMALLOC(MAX(size, 1)))) {
+        return 0;
+    }
+    MEMCPY(pMessage, pData, size);
+
+    parseSignalingMessage(pSignalingClient, pMessage, (UINT32) size, pReceivedSignalingMessage, &parsedIceServerList);
+
+    SAFE_MEMFREE(pMessage);
+    return 0;
+}
@@ -106,6 +106,7 @@ extern "C" {
 #define STATUS_SDP_URI_ERROR                    STATUS_SDP_BASE + 0x0000000D
 #define STATUS_SDP_VERSION_ERROR                STATUS_SDP_BASE + 0x0000000E
 #define STATUS_SDP_ATTRIBUTE_MAX_EXCEEDED       STATUS_SDP_BASE + 0x0000000F
+#define STATUS_SDP_TEMPLATE_UNSUPPORTED         STATUS_SDP_BASE + 0x00000010
 /*!@} */
 
 /////////////////////////////////////////////////////
@@ -264,11 +265,18 @@ extern "C" {
  * WEBRTC RTP related codes. Values are derived from STATUS_RTP_BASE (0x5c000000)
  *  @{
  */
-#define STATUS_RTP_BASE                   STATUS_SRTP_BASE + 0x01000000
-#define STATUS_RTP_INPUT_PACKET_TOO_SMALL STATUS_RTP_BASE + 0x00000001
-#define STATUS_RTP_INPUT_MTU_TOO_SMALL    STATUS_RTP_BASE + 0x00000002
-#define STATUS_RTP_INVALID_NALU           STATUS_RTP_BASE + 0x00000003
-#define STATUS_RTP_INVALID_EXTENSION_LEN  STATUS_RTP_BASE + 0x00000004
+#define STATUS_RTP_BASE                           STATUS_SRTP_BASE + 0x01000000
+#define STATUS_RTP_INPUT_PACKET_TOO_SMALL         STATUS_RTP_BASE + 0x00000001
+#define STATUS_RTP_INPUT_MTU_TOO_SMALL            STATUS_RTP_BASE + 0x00000002
+#define STATUS_RTP_INVALID_NALU                   STATUS_RTP_BASE + 0x00000003
+#define STATUS_RTP_INVALID_EXTENSION_LEN          STATUS_RTP_BASE + 0x00000004
+#define STATUS_RTP_INVALID_AV1_OBU                STATUS_RTP_BASE + 0x00000005
+#define STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR  STATUS_RTP_BASE + 0x00000006
+#define STATUS_RTP_MISSING_DEPENDENCY_STRUCTURE   STATUS_RTP_BASE + 0x00000007
+#define STATUS_RTP_HEADER_EXTENSION_NOT_FOUND     STATUS_RTP_BASE + 0x00000008
+#define STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR STATUS_RTP_BASE + 0x00000009
+#define STATUS_RTP_INVALID_FLEXFEC_PACKET         STATUS_RTP_BASE + 0x0000000a
+#define STATUS_RTP_INVALID_RED_PAYLOAD            STATUS_RTP_BASE + 0x0000000b
 /*!@} */
 
 /////////////////////////////////////////////////////
@@ -340,6 +348,7 @@ extern "C" {
 #define STATUS_SIGNALING_JOIN_SESSION_CALL_FAILED                  STATUS_SIGNALING_BASE + 0x0000004a
 #define STATUS_SIGNALING_JOIN_SESSION_CONNECTED_FAILED             STATUS_SIGNALING_BASE + 0x0000004b
 #define STATUS_SIGNALING_DESCRIBE_MEDIA_CALL_FAILED                STATUS_SIGNALING_BASE + 0x0000004c
+#define STATUS_SIGNALING_MESSAGE_QUEUE_FULL                        STATUS_SIGNALING_BASE + 0x0000004d
 
 /*!@} */
 
@@ -356,6 +365,7 @@ extern "C" {
 #define STATUS_PEERCONNECTION_CREATE_ANSWER_WITHOUT_REMOTE_DESCRIPTION STATUS_PEERCONNECTION_BASE + 0x00000001
 #define STATUS_PEERCONNECTION_CODEC_INVALID                            STATUS_PEERCONNECTION_BASE + 0x00000002
 #define STATUS_PEERCONNECTION_CODEC_MAX_EXCEEDED                       STATUS_PEERCONNECTION_BASE + 0x00000003
+#define STATUS_PEERCONNECTION_RECEIVE_QUEUE_FULL                       STATUS_PEERCONNECTION_BASE + 0x00000004
 /*!@} */
 
 /////////////////////////////////////////////////////
@@ -369,6 +379,10 @@ extern "C" {
 #define STATUS_SCTP_BASE                 STATUS_PEERCONNECTION_BASE + 0x01000000
 #define STATUS_SCTP_SESSION_SETUP_FAILED STATUS_SCTP_BASE + 0x00000001
 #define STATUS_SCTP_INVALID_DCEP_PACKET  STATUS_SCTP_BASE + 0x00000002
+#define STATUS_SCTP_SEND_WOULD_BLOCK     STATUS_SCTP_BASE + 0x00000003
+#define STATUS_SCTP_NO_FREE_STREAM       STATUS_SCTP_BASE + 0x00000004
+#define STATUS_SCTP_DATA_CHANNEL_CLOSED  STATUS_SCTP_BASE + 0x00000005
+#define STATUS_SCTP_STREAM_RESET_FAILED  STATUS_SCTP_BASE + 0x00000006
 /*!@} */
 
 /////////////////////////////////////////////////////
@@ -499,6 +513,11 @@ extern "C" {
  */
 #define MAX_DATA_CHANNEL_PROTOCOL_LEN 255
 
+/**
+ * Bytes a non-blocking DataChannel can have buffered before dataChannelSend returns STATUS_SCTP_SEND_WOULD_BLOCK
+ */
+#define MAX_DATA_CHANNEL_BUFFERED_AMOUNT (1024 * 1024)
+
 /**
  * Maximum length of signaling message
  */
@@ -566,7 +585,7 @@ extern "C" {
 /**
  * Version of SignalingClientMetrics structure
  */
-#define SIGNALING_CLIENT_METRICS_CURRENT_VERSION 1
+#define SIGNALING_CLIENT_METRICS_CURRENT_VERSION 2
 
 /**
  * Version of PeerConnectionMetrics structure
@@ -578,6 +597,11 @@ extern "C" {
  */
 #define ICE_AGENT_METRICS_CURRENT_VERSION 0
 
+/**
+ * Version of LatencyMetrics structure
+ */
+#define LATENCY_METRICS_CURRENT_VERSION 0
+
 /*!@} */
 
 /////////////////////////////////////////////////////
@@ -793,6 +817,9 @@ typedef enum {
     RTC_CODEC_MULAW = 4,                                                          //!< MULAW audio codec
     RTC_CODEC_ALAW = 5,                                                           //!< ALAW audio codec
     RTC_CODEC_UNKNOWN = 6,
+    RTC_CODEC_H265 = 7, //!< H265 video codec
+    RTC_CODEC_AV1 = 8,  //!< AV1 video codec
+    RTC_CODEC_VP9 = 9,  //!< VP9 video codec
 } RTC_CODEC;
 
 /**
@@ -925,6 +952,15 @@ typedef enum {
                                                         //!< which will allow the cache to persist next time the signaling client is created.
 } SIGNALING_API_CALL_CACHE_TYPE;
 
+/**
+ * @brief Policy used by the staged receive pipeline when its queue is full
+ */
+typedef enum {
+    RTC_RECEIVE_PIPELINE_DROP_NEWEST = 0, //!< Discard the packet that has just arrived from the network. This is the default.
+    RTC_RECEIVE_PIPELINE_DROP_OLDEST = 1, //!< Discard the oldest queued media packets so the freshest media is processed first.
+                                          //!< DTLS and RTCP packets are never discarded in favour of media.
+} RTC_RECEIVE_PIPELINE_DROP_POLICY;
+
 /*!@} */
 
 ////////////////////////////////////////////////////
@@ -999,6 +1035,13 @@ typedef struct __RtcDataChannel {
  */
 typedef VOID (*RtcOnMessage)(UINT64, PRtcDataChannel, BOOL, PBYTE, UINT32);
 
+/**
+ * @brief RtcOnOwnedMessage is fired instead of RtcOnMessage when a message is received for the DataChannel and the
+ * application takes ownership of the message buffer. The buffer stays valid after the callback returns and has to be
+ * released with dataChannelFreeMessage, which can be done from any thread
+ */
+typedef VOID (*RtcOnOwnedMessage)(UINT64, PRtcDataChannel, BOOL, PBYTE, UINT32);
+
 /**
  * RtcOnOpen is fired when the DataChannel has opened
  *
@@ -1006,6 +1049,21 @@ typedef VOID (*RtcOnMessage)(UINT64, PRtcDataChannel, BOOL, PBYTE, UINT32);
  */
 typedef VOID (*RtcOnOpen)(UINT64, PRtcDataChannel);
 
+/**
+ * RtcOnClose is fired when the DataChannel has closed, after both ends reset their stream of it
+ *
+ * Reference: https://www.w3.org/TR/webrtc/#dom-rtcdatachannel-onclose
+ */
+typedef VOID (*RtcOnClose)(UINT64, PRtcDataChannel);
+
+/**
+ * RtcOnBufferedAmountLow is fired when the buffered amount of the DataChannel drops to or below its threshold.
+ * Argument is the buffered amount at the time it was fired
+ *
+ * Reference: https://www.w3.org/TR/webrtc/#dom-rtcdatachannel-onbufferedamountlow
+ */
+typedef VOID (*RtcOnBufferedAmountLow)(UINT64, PRtcDataChannel, UINT64);
+
 /**
  * @brief RtcOnDataChannel is fired when the remote PeerConnection
  * creates a new DataChannel
@@ -1159,6 +1217,23 @@ typedef struct {
     BOOL disableSenderSideBandwidthEstimation; //!< Disable TWCC feedback based sender bandwidth estimation, enabled by default.
                                                //!< You want to set this to TRUE if you are on a very stable connection and want to save 1.2MB of
                                                //!< memory
+
+    BOOL enableReceivePipeline; //!< When TRUE, the network thread only reads and enqueues inbound packets into a bounded per
+                                //!< peer connection queue. DTLS, SRTP decryption, depacketization and frame delivery then run on a
+                                //!< shared media worker pool so a slow RtcOnFrame callback does not stall socket reads.
+
+    UINT32 receivePipelineQueueDepth; //!< Number of packets the receive pipeline queue can hold. Rounded up to a power of two.
+                                      //!< Use DEFAULT_RECEIVE_PIPELINE_QUEUE_DEPTH if 0. Ignored unless enableReceivePipeline is set.
+
+    RTC_RECEIVE_PIPELINE_DROP_POLICY receivePipelineDropPolicy; //!< What to discard when the receive pipeline queue is full.
+
+    BOOL enableFlexFec; //!< Offer and accept FlexFEC (RFC 8627) for video. Repair packets are only sent while RTCP reports loss, in
+                        //!< proportion to it, and lost packets are recovered before reaching the jitter buffer. Both peers need RFC 8627
+                        //!< support, browsers implementing the earlier flexfec-03 draft will not negotiate it.
+
+    UINT32 opusRedDepth; //!< Number of earlier Opus packets repeated in every audio packet using RED (RFC 2198), capped at 4.
+                         //!< 0 disables RED. Each level costs about one more Opus packet of bandwidth and lets the receiver
+                         //!< recover a burst of that many lost packets.
 } KvsRtcConfiguration, *PKvsRtcConfiguration;
 
 /**
@@ -1266,8 +1341,9 @@ typedef struct {
     INT32 signalingClientCreationMaxRetryAttempts;             //!< Max attempts to create signaling client before returning error to the caller
     UINT32 stateMachineRetryCountReadOnly; //!< Retry count of state machine. Note that this **MUST NOT** be modified by the user. It is a read only
                                            //!< field
-    UINT32 signalingMessagesMinimumThreads;
-    UINT32 signalingMessagesMaximumThreads;
+    UINT32 signalingMessagesMinimumThreads; //!< Threads handing received messages to the application started with the client
+    UINT32 signalingMessagesMaximumThreads; //!< Threads handing received messages to the application, the messages of a peer are
+                                            //!< always handled in order on the same one. 0 uses the default of 2, at most 16.
 } SignalingClientInfo, *PSignalingClientInfo;
 
 /**
@@ -1526,6 +1602,14 @@ typedef struct {
     PeerConnectionStats peerConnectionStats; //!< Peer connection metrics stats. Reference in Stats.h
 } PeerConnectionMetrics, *PPeerConnectionMetrics;
 
+/**
+ * @brief Latency histograms of the stages of an SDK object. The stages the object doesn't go through have a zero count
+ */
+typedef struct {
+    UINT32 version;                                          //!< Structure version
+    LatencyHistogramStats stageLatency[LATENCY_STAGE_COUNT]; //!< Latencies of each stage, indexed by LATENCY_STAGE. Reference in Stats.h
+} LatencyMetrics, *PLatencyMetrics;
+
 /**
  * @brief The stats object is populated based on RTCStatsType request
  *
@@ -1817,6 +1901,20 @@ PUBLIC_API STATUS transceiverOnBandwidthEstimation(PRtcRtpTransceiver, UINT64, R
  */
 PUBLIC_API STATUS transceiverOnPictureLoss(PRtcRtpTransceiver, UINT64, RtcOnPictureLoss);
 
+/**
+ * @brief Limits the layers of a scalable stream which are reassembled into received frames
+ *
+ * Packets above the given spatial and temporal layers are dropped before reassembly, so a viewer only decodes the layers it
+ * needs. Currently applies to VP9 transceivers, all layers are received by default.
+ *
+ * @param[in] PRtcRtpTransceiver Populated RtcRtpTransceiver struct
+ * @param[in] UINT8 Highest spatial layer id to receive
+ * @param[in] UINT8 Highest temporal layer id to receive
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS transceiverSetMaxReceiveLayers(PRtcRtpTransceiver, UINT8, UINT8);
+
 /**
  * @brief Frees the previously created transceiver object
  *
@@ -1892,7 +1990,8 @@ PUBLIC_API STATUS addIceCandidate(PRtcPeerConnection, PCHAR);
  *
  * NOTE: The RtcDataChannelInit dictionary can be used to configure properties of the underlying
  * channel such as data reliability.
- * NOTE: Data channel can be created only after signaling for now
+ * NOTE: A data channel created once the PeerConnection is connected is opened in-band with DATA_CHANNEL_OPEN
+ * on the next free stream id. RtcOnOpen is fired when the remote peer acknowledges it, messages can be sent before that
  *
  * Reference: https://www.w3.org/TR/webrtc/#methods-11
  *
@@ -1917,7 +2016,26 @@ PUBLIC_API STATUS createDataChannel(PRtcPeerConnection, PCHAR, PRtcDataChannelIn
 PUBLIC_API STATUS dataChannelOnMessage(PRtcDataChannel, UINT64, RtcOnMessage);
 
 /**
- * @brief Set a callback for data channel open
+ * @brief Set a callback for data channel message that takes ownership of the received message buffer instead of
+ * having it freed when the callback returns. Takes precedence over the callback set with dataChannelOnMessage
+ *
+ * @param[in] PRtcDataChannel Data channel struct created by createDataChannel()
+ * @param[in] UINT64 User customData that will be passed along when RtcOnOwnedMessage is called
+ * @param[in] RtcOnOwnedMessage User RtcOnOwnedMessage callback
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS dataChannelOnOwnedMessage(PRtcDataChannel, UINT64, RtcOnOwnedMessage);
+
+/**
+ * @brief Release a message buffer handed over by RtcOnOwnedMessage
+ *
+ * @param[in] PBYTE Message buffer passed to RtcOnOwnedMessage. NULL is ignored
+ */
+PUBLIC_API VOID dataChannelFreeMessage(PBYTE);
+
+/**
+ * @brief Set a callback for data channel open. It is fired right away when the data channel is open already
  *
  * @param[in] PRtcDataChannel Data channel struct created by createDataChannel()
  * @param[in] UINT64 User customData that will be passed along when RtcOnOpen is called
@@ -1927,6 +2045,80 @@ PUBLIC_API STATUS dataChannelOnMessage(PRtcDataChannel, UINT64, RtcOnMessage);
  */
 PUBLIC_API STATUS dataChannelOnOpen(PRtcDataChannel, UINT64, RtcOnOpen);
 
+/**
+ * @brief Set a callback for data channel close
+ *
+ * @param[in] PRtcDataChannel Data channel struct created by createDataChannel()
+ * @param[in] UINT64 User customData that will be passed along when RtcOnClose is called
+ * @param[in] RtcOnClose User RtcOnClose callback
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS dataChannelOnClose(PRtcDataChannel, UINT64, RtcOnClose);
+
+/**
+ * @brief Close the data channel by resetting its outgoing stream, https://www.rfc-editor.org/rfc/rfc8831#section-6.7
+ * The remote peer resets its stream in turn, which fires RtcOnClose. Nothing can be sent on the data channel
+ * after this. The data channel stays valid until the PeerConnection is freed.
+ *
+ * Reference: https://www.w3.org/TR/webrtc/#dom-rtcdatachannel-close
+ *
+ * @param[in] PRtcDataChannel Data channel of a connected PeerConnection
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS dataChannelClose(PRtcDataChannel);
+
+/**
+ * @brief Set a callback for the buffered amount of the data channel dropping to or below the threshold
+ *
+ * Reference: https://www.w3.org/TR/webrtc/#dom-rtcdatachannel-onbufferedamountlow
+ *
+ * @param[in] PRtcDataChannel Data channel struct created by createDataChannel()
+ * @param[in] UINT64 User customData that will be passed along when RtcOnBufferedAmountLow is called
+ * @param[in] RtcOnBufferedAmountLow User RtcOnBufferedAmountLow callback
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS dataChannelOnBufferedAmountLow(PRtcDataChannel, UINT64, RtcOnBufferedAmountLow);
+
+/**
+ * @brief Set the buffered amount at or below which RtcOnBufferedAmountLow is fired. Default is 0
+ *
+ * Reference: https://www.w3.org/TR/webrtc/#dom-rtcdatachannel-bufferedamountlowthreshold
+ *
+ * @param[in] PRtcDataChannel Data channel struct created by createDataChannel()
+ * @param[in] UINT64 Threshold in bytes
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS dataChannelSetBufferedAmountLowThreshold(PRtcDataChannel, UINT64);
+
+/**
+ * @brief Get the number of bytes sent on the data channel that the remote peer has not acknowledged yet
+ *
+ * Reference: https://www.w3.org/TR/webrtc/#dom-rtcdatachannel-bufferedamount
+ *
+ * @param[in] PRtcDataChannel Data channel struct created by createDataChannel()
+ * @param[out] PUINT64 Buffered amount in bytes
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS dataChannelGetBufferedAmount(PRtcDataChannel, PUINT64);
+
+/**
+ * @brief Switch the data channel to non-blocking sends. In non-blocking mode dataChannelSend returns
+ * STATUS_SCTP_SEND_WOULD_BLOCK instead of queueing the message when MAX_DATA_CHANNEL_BUFFERED_AMOUNT
+ * bytes are already buffered or the SCTP send buffer is full. The message can be sent again after
+ * RtcOnBufferedAmountLow fires.
+ *
+ * @param[in] PRtcDataChannel Data channel struct created by createDataChannel()
+ * @param[in] BOOL TRUE for non-blocking sends
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS dataChannelSetNonBlocking(PRtcDataChannel, BOOL);
+
 /**
  * @brief Send data via the PRtcDataChannel
  *
@@ -1937,7 +2129,8 @@ PUBLIC_API STATUS dataChannelOnOpen(PRtcDataChannel, UINT64, RtcOnOpen);
  * @param[in] PBYTE Data that you wish to send
  * @param[in] UINT32 Length of the PBYTE you wish to send
  *
- * @return STATUS code of the execution. STATUS_SUCCESS on success
+ * @return STATUS code of the execution. STATUS_SUCCESS on success, STATUS_SCTP_SEND_WOULD_BLOCK when the
+ * SCTP send buffer is full or, for a non-blocking data channel, MAX_DATA_CHANNEL_BUFFERED_AMOUNT is reached
  *
  */
 PUBLIC_API STATUS dataChannelSend(PRtcDataChannel, BOOL, PBYTE, UINT32);
@@ -2108,6 +2301,14 @@ PUBLIC_API STATUS signalingClientDeleteSync(SIGNALING_CLIENT_HANDLE);
  */
 PUBLIC_API STATUS signalingClientGetMetrics(SIGNALING_CLIENT_HANDLE, PSignalingClientMetrics);
 
+/**
+ * @brief Get the latency histograms of the signaling client, only LATENCY_STAGE_SIGNALING_DISPATCH is recorded by it
+ *
+ * @param[in] SIGNALING_CLIENT_HANDLE Signaling client handle
+ * @param[in,out] PLatencyMetrics Latency histograms
+ */
+PUBLIC_API STATUS signalingClientGetLatencyMetrics(SIGNALING_CLIENT_HANDLE, PLatencyMetrics);
+
 /**
  * @brief Get peer connection related metrics
  *
@@ -2124,6 +2325,15 @@ PUBLIC_API STATUS peerConnectionGetMetrics(PRtcPeerConnection, PPeerConnectionMe
  */
 PUBLIC_API STATUS iceAgentGetMetrics(PRtcPeerConnection, PKvsIceAgentMetrics);
 
+/**
+ * @brief Get the latency histograms of the peer connection, all stages but LATENCY_STAGE_SIGNALING_DISPATCH are
+ * recorded by it. Recording is lock free and goes on while the percentiles are computed.
+ *
+ * @param[in] PRtcPeerConnection Peer connection object
+ * @param[in,out] PLatencyMetrics Latency histograms
+ */
+PUBLIC_API STATUS peerConnectionGetLatencyMetrics(PRtcPeerConnection, PLatencyMetrics);
+
 /**
  * @brief Get the relevant/all metrics based on the RTCStatsType field. This does not include
  * any signaling related metrics. The caller of the API is expected to populate requestedTypeOfStats
@@ -2143,6 +2353,35 @@ PUBLIC_API STATUS iceAgentGetMetrics(PRtcPeerConnection, PKvsIceAgentMetrics);
  */
 PUBLIC_API STATUS rtcPeerConnectionGetMetrics(PRtcPeerConnection, PRtcRtpTransceiver, PRtcStats);
 
+/**
+ * @brief Serializes the metrics of every live peer connection, transceiver, ICE agent and signaling client in the
+ * OpenMetrics text format, as scraped by Prometheus. Samples are labelled with peer_connection and signaling_client
+ * ids, which stay the same for the lifetime of the object, and transceiver samples with their track id and kind.
+ * Times are in seconds and the text ends with "# EOF".
+ *
+ * Reference: https://github.com/OpenObservability/OpenMetrics/blob/main/specification/OpenMetrics.md
+ *
+ * @param[out] PCHAR Buffer the text is written to, the text is NULL terminated
+ * @param[in,out] PUINT32 If PCHAR is NULL this is the required buffer size. If PCHAR is non-NULL this is the size of
+ * the buffer and it is set to the length of the text
+ *
+ * @return STATUS code of the execution. STATUS_BUFFER_TOO_SMALL if objects were created since the size was queried
+ */
+PUBLIC_API STATUS exportOpenMetrics(PCHAR, PUINT32);
+
+/**
+ * @brief Dumps the trace events recorded on the packet path as Chrome trace JSON, which chrome://tracing and the
+ * Perfetto UI open. Each thread keeps its most recent events in its own ring, the dump leaves them in place.
+ * Trace points are only recorded when the SDK is built with ENABLE_TRACING, otherwise the trace is empty.
+ *
+ * @param[out] PCHAR Buffer the JSON is written to, the JSON is NULL terminated. Events that don't fit are left out
+ * @param[in,out] PUINT32 If PCHAR is NULL this is the required buffer size. If PCHAR is non-NULL this is the size of
+ * the buffer and it is set to the length of the JSON
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS dumpTraceEvents(PCHAR, PUINT32);
+
 /**
  * @brief Creates an RtcCertificate object
 
@@ -368,7 +368,7 @@ typedef struct {
     UINT32 sliCount;              //!< Only valid for video. Count the total number of Slice Loss Indication (SLI) packets received by this sender
     UINT32 qualityLimitationResolutionChanges; //!< Only valid for video. The number of times that the resolution has changed because we are quality
                                                //!< limited
-    INT32 fecPacketsSent; //!< TODO Total number of RTP FEC packets sent for this SSRC. Can also be incremented while sending FEC packets in band
+    INT32 fecPacketsSent; //!< Total number of RTP FEC packets sent for this SSRC. Can also be incremented while sending FEC packets in band
     UINT64 lastPacketSentTimestamp;  //!< The timestamp in milliseconds at which the last packet was sent for this SSRC
     UINT64 headerBytesSent;          //!< Total number of RTP header and padding bytes sent for this SSRC
     UINT64 bytesDiscardedOnSend;     //!< Total number of bytes for this SSRC that have been discarded due to socket errors
@@ -412,7 +412,7 @@ typedef struct {
     UINT64 packetsDiscarded; //!< The cumulative number of RTP packets discarded by the jitter buffer due to late or early-arrival, i.e., these
                              //!< packets are not played out. RTP packets discarded due to packet duplication are not reported in this metric
                              //!< [XRBLOCK-STATS]. Calculated as defined in [RFC7002] section 3.2 and Appendix A.a.
-    UINT64 packetsRepaired; //!< TODO The cumulative number of lost RTP packets repaired after applying an error-resilience mechanism [XRBLOCK-STATS].
+    UINT64 packetsRepaired; //!< The cumulative number of lost RTP packets repaired after applying an error-resilience mechanism [XRBLOCK-STATS].
     UINT64 burstPacketsLost;      //!< TODO The cumulative number of RTP packets lost during loss bursts, Appendix A (c) of [RFC6958].
     UINT64 burstPacketsDiscarded; //!< TODO The cumulative number of RTP packets discarded during discard bursts, Appendix A (b) of [RFC7003].
     UINT32 burstLossCount; //!< TODO The cumulative number of bursts of lost RTP packets, Appendix A (e) of [RFC6958].     [RFC3611] recommends a Gmin
@@ -489,10 +489,10 @@ typedef struct {
     UINT64 headerBytesReceived; //!< Total number of RTP header and padding bytes received for this SSRC. This does not include the size of transport
                                 //!< layer headers such as IP or UDP. headerBytesReceived + bytesReceived equals the number of bytes received as
                                 //!< payload over the transport.
-    UINT64 fecPacketsReceived;  //!< TODO Total number of RTP FEC packets received for this SSRC. This counter can also be incremented when receiving
+    UINT64 fecPacketsReceived;  //!< Total number of RTP FEC packets received for this SSRC. This counter can also be incremented when receiving
                                 //!< FEC packets in-band with media packets (e.g., with Opus).
     UINT64
-    fecPacketsDiscarded;  //!< TODO Total number of RTP FEC packets received for this SSRC where the error correction payload was discarded by the
+    fecPacketsDiscarded;  //!< Total number of RTP FEC packets received for this SSRC where the error correction payload was discarded by the
                           //!< application. This may happen 1. if all the source packets protected by the FEC packet were received or already
                           //!< recovered by a separate FEC packet, or 2. if the FEC packet arrived late, i.e., outside the recovery window, and
                           //!< the lost RTP packets have already been skipped during playout. This is a subset of fecPacketsReceived.
@@ -548,8 +548,8 @@ typedef struct {
 typedef enum {
     RTC_DATA_CHANNEL_STATE_CONNECTING, //!< Set while creating data channel
     RTC_DATA_CHANNEL_STATE_OPEN,       //!< Set on opening data channel on embedded side or receiving onOpen event
-    RTC_DATA_CHANNEL_STATE_CLOSING,    //!< TODO: Set the state to closed after adding onClosing handler to data channel
-    RTC_DATA_CHANNEL_STATE_CLOSED      //!< TODO: Set the state to closed after adding onClose handler to data channel
+    RTC_DATA_CHANNEL_STATE_CLOSING,    //!< Set on dataChannelClose until the remote end has closed the data channel as well
+    RTC_DATA_CHANNEL_STATE_CLOSED      //!< Set once both ends have reset their stream of the data channel
 } RTC_DATA_CHANNEL_STATE;
 
 /**
@@ -607,6 +607,10 @@ typedef struct {
     UINT64 connectClientTime; //!< Total time (ms) taken to  connect the signaling client which includes connecting to the signaling channel
     UINT64 offerToAnswerTime;
     UINT64 joinSessionToOfferRecvTime; //!< Total time (ms) taken from joinSession call until offer is received
+    UINT32 messageQueueDepth;          //!< Number of received messages waiting to be handed to the application
+    UINT32 maxMessageQueueDepth;       //!< Highest number of received messages waiting to be handed to the application
+    UINT64 messageDispatchLatency;     //!< Average time (in 100 ns) a received message waits before the message callback is called
+    UINT64 maxMessageDispatchLatency;  //!< Longest time (in 100 ns) a received message waited before the message callback was called
 } SignalingClientStats, *PSignalingClientStats;
 
 typedef struct {
@@ -617,6 +621,34 @@ typedef struct {
     UINT64 freePeerConnectionTime;     //!< Time taken (ms) to free the peer connection object
 } PeerConnectionStats, *PPeerConnectionStats;
 
+/**
+ * @brief Stages of the SDK whose latencies are recorded in a histogram
+ */
+typedef enum {
+    LATENCY_STAGE_DTLS_HANDSHAKE,     //!< From the DTLS session being started until the handshake completed
+    LATENCY_STAGE_ICE_CHECK_RTT,      //!< Round trip time of the ICE connectivity checks
+    LATENCY_STAGE_FRAME_ASSEMBLY,     //!< From the first packet of a received frame arriving until the jitter buffer hands the frame out
+    LATENCY_STAGE_WRITE_FRAME,        //!< Time writeFrame takes to packetize, encrypt and send a frame
+    LATENCY_STAGE_SRTP,               //!< Time taken to encrypt a sent or decrypt a received media packet
+    LATENCY_STAGE_SIGNALING_DISPATCH, //!< From a signaling message being received until the message callback is called
+    LATENCY_STAGE_COUNT,              //!< Number of stages
+} LATENCY_STAGE;
+
+/**
+ * @brief Distribution of the latencies recorded for a stage. Latencies fall in buckets which are at most ~3% wide, the
+ * min, max and percentiles are the lowest or highest latency of their bucket.
+ */
+typedef struct {
+    UINT64 count; //!< Number of latencies recorded
+    UINT64 min;   //!< Lowest latency (in 100 ns)
+    UINT64 max;   //!< Highest latency (in 100 ns)
+    UINT64 mean;  //!< Mean latency (in 100 ns)
+    UINT64 p50;   //!< Median latency (in 100 ns)
+    UINT64 p90;   //!< 90th percentile latency (in 100 ns)
+    UINT64 p99;   //!< 99th percentile latency (in 100 ns)
+    UINT64 p999;  //!< 99.9th percentile latency (in 100 ns)
+} LatencyHistogramStats, *PLatencyHistogramStats;
+
 /**
  * @brief RTCStatsObject Represents an object passed in by the application developer which will
  * be populated internally
@@ -31,6 +31,11 @@ extern "C" {
 
 #define DTLS_SESSION_TIMER_START_DELAY (100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
 
+/*
+ * Largest growth of a DTLS 1.2 record over its payload: record header, explicit IV, MAC and block padding
+ */
+#define DTLS_MAX_RECORD_OVERHEAD (13 + 16 + 48 + 16)
+
 #define SECONDS_IN_A_DAY (24 * 60 * 60LL)
 
 #define HUNDREDS_OF_NANOS_IN_A_DAY (HUNDREDS_OF_NANOS_IN_AN_HOUR * 24LL)
@@ -105,6 +110,8 @@ struct __DtlsSession {
     UINT32 timerId;
     UINT64 dtlsSessionStartTime;
     UINT64 dtlsSessionSetupTime;
+    // Same as dtlsSessionSetupTime in 100 ns rather than ms
+    UINT64 handshakeDuration;
     RTC_DTLS_TRANSPORT_STATE state;
     MUTEX sslLock;
 
@@ -116,6 +123,8 @@ struct __DtlsSession {
     CHAR certFingerprints[MAX_RTCCONFIGURATION_CERTIFICATES][CERTIFICATE_FINGERPRINT_LENGTH + 1];
     SSL_CTX* pSslCtx;
     SSL* pSsl;
+    // Write BIO method that hands records to outboundPacketFn straight from the SSL write buffer, set once the handshake is done
+    BIO_METHOD* pRecordSinkMethod;
 #elif KVS_USE_MBEDTLS
     DtlsSessionTimer transmissionTimer;
     TlsKeys tlsKeys;
@@ -166,6 +175,16 @@ STATUS dtlsSessionVerifyRemoteCertificateFingerprint(PDtlsSession, PCHAR);
 STATUS dtlsSessionPutApplicationData(PDtlsSession, PBYTE, INT32);
 STATUS dtlsSessionShutdown(PDtlsSession);
 
+/**
+ * Set the largest datagram DTLS may send and get the largest application data that fits in one record of that size
+ * with the negotiated cipher. Should be called once the handshake is done
+ * @param PDtlsSession - DtlsSession object
+ * @param UINT32 - largest datagram in bytes
+ * @param PUINT32 - largest application data per record in bytes
+ * @return STATUS - status of operation
+ */
+STATUS dtlsSessionSetMtu(PDtlsSession, UINT32, PUINT32);
+
 STATUS dtlsSessionOnOutBoundData(PDtlsSession, UINT64, DtlsSessionOutboundPacketFunc);
 STATUS dtlsSessionOnStateChange(PDtlsSession, UINT64, DtlsSessionOnStateChange);
 
@@ -177,6 +196,9 @@ STATUS dtlsFillPseudoRandomBits(PBYTE, UINT32);
 
 #ifdef KVS_USE_OPENSSL
 STATUS dtlsCheckOutgoingDataBuffer(PDtlsSession);
+STATUS dtlsSessionSetRecordSink(PDtlsSession);
+INT32 dtlsRecordSinkWrite(BIO*, const char*, INT32);
+LONG dtlsRecordSinkCtrl(BIO*, INT32, LONG, PVOID);
 STATUS dtlsCertificateFingerprint(X509*, PCHAR);
 STATUS dtlsGenerateCertificateFingerprints(PDtlsSession, PDtlsSessionCertificateInfo);
 STATUS createCertificateAndKey(INT32, BOOL, X509** ppCert, EVP_PKEY** ppPkey);
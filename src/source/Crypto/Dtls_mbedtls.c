@@ -414,6 +414,34 @@ CleanUp:
     return retStatus;
 }
 
+STATUS dtlsSessionSetMtu(PDtlsSession pDtlsSession, UINT32 mtu, PUINT32 pApplicationDataMtu)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    INT32 maxPayload;
+
+    CHK(pDtlsSession != NULL && pApplicationDataMtu != NULL, STATUS_NULL_ARG);
+    CHK(mtu > DTLS_MAX_RECORD_OVERHEAD && mtu <= MAX_UINT16, STATUS_INVALID_ARG);
+
+    MUTEX_LOCK(pDtlsSession->sslLock);
+    locked = TRUE;
+
+    mbedtls_ssl_set_mtu(&pDtlsSession->sslCtx, (UINT16) mtu);
+    // Accounts for the expansion of the record with the negotiated cipher
+    maxPayload = mbedtls_ssl_get_max_out_record_payload(&pDtlsSession->sslCtx);
+    CHK(maxPayload > 0, STATUS_INVALID_ARG);
+    *pApplicationDataMtu = (UINT32) maxPayload;
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pDtlsSession->sslLock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS dtlsSessionGetLocalCertificateFingerprint(PDtlsSession pDtlsSession, PCHAR pBuff, UINT32 buffLen)
 {
     ENTERS();
@@ -421,6 +421,11 @@ STATUS freeDtlsSession(PDtlsSession* ppDtlsSession)
     if (pDtlsSession->pSsl != NULL) {
         SSL_free(pDtlsSession->pSsl);
     }
+#if (OPENSSL_VERSION_NUMBER >= 0x10100000L)
+    if (pDtlsSession->pRecordSinkMethod != NULL) {
+        BIO_meth_free(pDtlsSession->pRecordSinkMethod);
+    }
+#endif
     if (pDtlsSession->pSslCtx != NULL) {
         SSL_CTX_free(pDtlsSession->pSslCtx);
     }
@@ -470,6 +475,7 @@ STATUS dtlsSessionProcessPacket(PDtlsSession pDtlsSession, PBYTE pData, PINT32 p
     if (!ATOMIC_LOAD_BOOL(&pDtlsSession->sslInitFinished)) {
         CHK_STATUS(dtlsCheckOutgoingDataBuffer(pDtlsSession));
     }
+    CHK_STATUS(dtlsSessionSetRecordSink(pDtlsSession));
 
     /* if SSL_read failed then set to 0 */
     dataLen = sslRet < 0 ? 0 : sslRet;
@@ -500,15 +506,13 @@ STATUS dtlsSessionPutApplicationData(PDtlsSession pDtlsSession, PBYTE pData, INT
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     INT32 amountWritten;
-    BYTE buf[MAX_UDP_PACKET_SIZE];
-    BIO* wbio;
-    SIZE_T pending;
     BOOL locked = FALSE;
 
     CHK(pDtlsSession != NULL && pData != NULL, STATUS_NULL_ARG);
     MUTEX_LOCK(pDtlsSession->sslLock);
     locked = TRUE;
     CHK(!ATOMIC_LOAD_BOOL(&pDtlsSession->shutdown), retStatus);
+    CHK_STATUS(dtlsSessionSetRecordSink(pDtlsSession));
 
     if ((amountWritten = SSL_write(pDtlsSession->pSsl, pData, dataLen)) != dataLen &&
         SSL_get_error(pDtlsSession->pSsl, amountWritten) == SSL_ERROR_SSL) {
@@ -516,12 +520,42 @@ STATUS dtlsSessionPutApplicationData(PDtlsSession pDtlsSession, PBYTE pData, INT
         CHK(FALSE, STATUS_INTERNAL_ERROR);
     }
 
-    wbio = SSL_get_wbio(pDtlsSession->pSsl);
-    if ((pending = BIO_ctrl_pending(wbio)) > 0) {
-        pending = BIO_read(wbio, buf, pending);
-        pDtlsSession->dtlsSessionCallbacks.outboundPacketFn(pDtlsSession->dtlsSessionCallbacks.outBoundPacketFnCustomData, buf, (UINT32) pending);
+    // Nothing is pending once the record sink is set, the record has been sent from within SSL_write
+    CHK_STATUS(dtlsCheckOutgoingDataBuffer(pDtlsSession));
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pDtlsSession->sslLock);
     }
 
+    LEAVES();
+    return retStatus;
+}
+
+STATUS dtlsSessionSetMtu(PDtlsSession pDtlsSession, UINT32 mtu, PUINT32 pApplicationDataMtu)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+
+    CHK(pDtlsSession != NULL && pApplicationDataMtu != NULL, STATUS_NULL_ARG);
+    CHK(mtu > DTLS_MAX_RECORD_OVERHEAD, STATUS_INVALID_ARG);
+
+    MUTEX_LOCK(pDtlsSession->sslLock);
+    locked = TRUE;
+
+    // The memory BIOs can't tell the MTU, so it has to be set rather than queried
+    SSL_set_options(pDtlsSession->pSsl, SSL_OP_NO_QUERY_MTU);
+    CHK(SSL_set_mtu(pDtlsSession->pSsl, mtu) > 0, STATUS_INVALID_ARG);
+
+    // Version greater than or equal to 1.1.1
+#if (OPENSSL_VERSION_NUMBER >= 0x10101000L)
+    *pApplicationDataMtu = (UINT32) DTLS_get_data_mtu(pDtlsSession->pSsl);
+    CHK(*pApplicationDataMtu > 0, STATUS_INVALID_ARG);
+#else
+    *pApplicationDataMtu = mtu - DTLS_MAX_RECORD_OVERHEAD;
+#endif
+
 CleanUp:
     if (locked) {
         MUTEX_UNLOCK(pDtlsSession->sslLock);
@@ -584,6 +618,66 @@ CleanUp:
     return retStatus;
 }
 
+STATUS dtlsSessionSetRecordSink(PDtlsSession pDtlsSession)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+#if (OPENSSL_VERSION_NUMBER >= 0x10100000L)
+    BIO_METHOD* pMethod = NULL;
+    BIO* pSinkBIO = NULL;
+
+    CHK(pDtlsSession->pRecordSinkMethod == NULL && SSL_is_init_finished(pDtlsSession->pSsl), retStatus);
+
+    // Whatever the handshake left in the memory BIO has to go out first
+    CHK_STATUS(dtlsCheckOutgoingDataBuffer(pDtlsSession));
+
+    CHK((pMethod = BIO_meth_new(BIO_TYPE_SOURCE_SINK, "kvs dtls record sink")) != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    CHK(BIO_meth_set_write(pMethod, dtlsRecordSinkWrite) == 1 && BIO_meth_set_ctrl(pMethod, dtlsRecordSinkCtrl) == 1, STATUS_INTERNAL_ERROR);
+    CHK((pSinkBIO = BIO_new(pMethod)) != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    BIO_set_data(pSinkBIO, pDtlsSession);
+    BIO_set_init(pSinkBIO, 1);
+
+    // Frees the memory BIO
+    SSL_set0_wbio(pDtlsSession->pSsl, pSinkBIO);
+    pDtlsSession->pRecordSinkMethod = pMethod;
+    pMethod = NULL;
+
+CleanUp:
+
+    if (pMethod != NULL) {
+        BIO_meth_free(pMethod);
+    }
+#else
+    // BIO_METHOD is opaque only since 1.1.0, older versions keep copying out of the memory BIO
+    UNUSED_PARAM(pDtlsSession);
+#endif
+
+    LEAVES();
+    return retStatus;
+}
+
+// OpenSSL writes a DTLS record at a time from the write buffer it keeps for the connection, so the record is sealed
+// in place and sent without being copied out of a memory BIO first
+INT32 dtlsRecordSinkWrite(BIO* pBio, const char* pData, INT32 dataLen)
+{
+    PDtlsSession pDtlsSession = (PDtlsSession) BIO_get_data(pBio);
+
+    pDtlsSession->dtlsSessionCallbacks.outboundPacketFn(pDtlsSession->dtlsSessionCallbacks.outBoundPacketFnCustomData, (PBYTE) pData,
+                                                        (UINT32) dataLen);
+
+    return dataLen;
+}
+
+LONG dtlsRecordSinkCtrl(BIO* pBio, INT32 cmd, LONG num, PVOID ptr)
+{
+    UNUSED_PARAM(pBio);
+    UNUSED_PARAM(num);
+    UNUSED_PARAM(ptr);
+
+    // Nothing is ever buffered, the rest of the datagram BIO controls are not supported same as with the memory BIO
+    return cmd == BIO_CTRL_FLUSH ? 1 : 0;
+}
+
 STATUS dtlsSessionIsInitFinished(PDtlsSession pDtlsSession, PBOOL pIsConnected)
 {
     ENTERS();
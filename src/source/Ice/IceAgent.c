@@ -632,22 +632,47 @@ CleanUp:
 STATUS iceAgentSendPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pIceAgent != NULL && pBuffer != NULL, STATUS_NULL_ARG);
+    CHK(bufferLen != 0, STATUS_INVALID_ARG);
+
+    retStatus = iceAgentSendPackets(pIceAgent, &pBuffer, &bufferLen, 1);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS iceAgentSendPackets(PIceAgent pIceAgent, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 packetCount)
+{
+    STATUS retStatus = STATUS_SUCCESS, sendStatus;
     BOOL locked = FALSE, isRelay = FALSE;
     PTurnConnection pTurnConnection = NULL;
     UINT32 packetsDiscarded = 0;
     UINT32 bytesDiscarded = 0;
     UINT32 bytesSent = 0;
     UINT32 packetsSent = 0;
+    UINT32 i;
 
-    CHK(pIceAgent != NULL && pBuffer != NULL, STATUS_NULL_ARG);
-    CHK(bufferLen != 0, STATUS_INVALID_ARG);
+    CHK(pIceAgent != NULL && ppBuffers != NULL && pBufferLens != NULL, STATUS_NULL_ARG);
+    for (i = 0; i < packetCount; i++) {
+        CHK(ppBuffers[i] != NULL, STATUS_NULL_ARG);
+        CHK(pBufferLens[i] != 0, STATUS_INVALID_ARG);
+    }
+
+    // Nothing goes through the candidate pairs, they are not even checked
+    if (pIceAgent->outboundPacketFn != NULL) {
+        for (i = 0; i < packetCount; i++) {
+            CHK_STATUS(pIceAgent->outboundPacketFn(pIceAgent->outboundPacketCustomData, ppBuffers[i], pBufferLens[i]));
+        }
+        CHK(FALSE, retStatus);
+    }
 
     MUTEX_LOCK(pIceAgent->lock);
     locked = TRUE;
 
     /* Do not proceed if ice is shutting down */
     CHK(!ATOMIC_LOAD_BOOL(&pIceAgent->shutdown), retStatus);
-    CHK(bufferLen != 0, STATUS_INVALID_ARG);
 
     CHK_WARN(pIceAgent->pDataSendingIceCandidatePair != NULL, retStatus, "No valid ice candidate pair available to send data");
     CHK_WARN(pIceAgent->pDataSendingIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED, retStatus,
@@ -662,28 +687,34 @@ STATUS iceAgentSendPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen)
         pTurnConnection = pIceAgent->pDataSendingIceCandidatePair->local->pTurnConnection;
     }
 
-    retStatus = iceUtilsSendData(pBuffer, bufferLen, &pIceAgent->pDataSendingIceCandidatePair->remote->ipAddress,
-                                 pIceAgent->pDataSendingIceCandidatePair->local->pSocketConnection, pTurnConnection, isRelay);
+    // The pair stops being usable once its connection is closed, the rest of the batch is discarded
+    for (i = 0; i < packetCount && pIceAgent->pDataSendingIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED; i++) {
+        sendStatus = iceUtilsSendData(ppBuffers[i], pBufferLens[i], &pIceAgent->pDataSendingIceCandidatePair->remote->ipAddress,
+                                      pIceAgent->pDataSendingIceCandidatePair->local->pSocketConnection, pTurnConnection, isRelay);
 
-    if (STATUS_FAILED(retStatus)) {
-        DLOGW("iceUtilsSendData failed with 0x%08x", retStatus);
-        packetsDiscarded++;
-        bytesDiscarded = bufferLen; // This includes header and padding. TODO: update length to remove header and padding
-        if (retStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
-            DLOGW("IceAgent connection closed unexpectedly");
-            pIceAgent->iceAgentStatus = STATUS_SOCKET_CONNECTION_CLOSED_ALREADY;
-            pIceAgent->pDataSendingIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+        if (STATUS_FAILED(sendStatus)) {
+            DLOGW("iceUtilsSendData failed with 0x%08x", sendStatus);
+            packetsDiscarded++;
+            bytesDiscarded += pBufferLens[i]; // This includes header and padding. TODO: update length to remove header and padding
+            if (sendStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
+                DLOGW("IceAgent connection closed unexpectedly");
+                pIceAgent->iceAgentStatus = STATUS_SOCKET_CONNECTION_CLOSED_ALREADY;
+                pIceAgent->pDataSendingIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+            }
+        } else {
+            // TODO: use a better estimate of actual time when packet was sent
+            // eg setsockopt(SO_TIMESTAMPING)
+            // SOF_TIMESTAMPING_TX_HARDWARE - tx timestamps generated by network hardware
+            // SOF_TIMESTAMPING_TX_SOFTWARE - tx timestamps generated by kernel, when data leaves kernel, before hardware
+            pIceAgent->pDataSendingIceCandidatePair->lastDataSentTime = GETTIME();
+
+            bytesSent += pBufferLens[i];
+            packetsSent++;
         }
-        retStatus = STATUS_SUCCESS;
-    } else {
-        // TODO: use a better estimate of actual time when packet was sent
-        // eg setsockopt(SO_TIMESTAMPING)
-        // SOF_TIMESTAMPING_TX_HARDWARE - tx timestamps generated by network hardware
-        // SOF_TIMESTAMPING_TX_SOFTWARE - tx timestamps generated by kernel, when data leaves kernel, before hardware
-        pIceAgent->pDataSendingIceCandidatePair->lastDataSentTime = GETTIME();
-
-        bytesSent = bufferLen;
-        packetsSent++;
+    }
+    for (; i < packetCount; i++) {
+        packetsDiscarded++;
+        bytesDiscarded += pBufferLens[i];
     }
 
 CleanUp:
@@ -705,19 +736,54 @@ CleanUp:
     return retStatus;
 }
 
-STATUS iceAgentPopulateSdpMediaDescriptionCandidates(PIceAgent pIceAgent, PSdpMediaDescription pSdpMediaDescription, UINT32 attrBufferLen,
-                                                     PUINT32 pIndex)
+STATUS iceAgentPopulateSdpMediaDescriptionCandidates(PIceAgent pIceAgent, PSessionDescription pSessionDescription,
+                                                     PSdpMediaDescription pSdpMediaDescription)
 {
     STATUS retStatus = STATUS_SUCCESS;
     UINT64 data;
     PDoubleListNode pCurNode = NULL;
     BOOL locked = FALSE;
-    UINT32 attrIndex;
+    UINT32 candidateLen;
     PIceCandidate pCandidate = NULL;
+    CHAR candidateStr[MAX_SDP_ATTRIBUTE_VALUE_LENGTH + 1];
+
+    CHK(pIceAgent != NULL && pSessionDescription != NULL && pSdpMediaDescription != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pIceAgent->lock);
+    locked = TRUE;
 
-    CHK(pIceAgent != NULL && pSdpMediaDescription != NULL && pIndex != NULL, STATUS_NULL_ARG);
+    CHK_STATUS(doubleListGetHeadNode(pIceAgent->localCandidates, &pCurNode));
+    while (pCurNode != NULL) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &data));
+        pCurNode = pCurNode->pNext;
+        pCandidate = (PIceCandidate) data;
+        if (pCandidate->state == ICE_CANDIDATE_STATE_VALID) {
+            candidateLen = SIZEOF(candidateStr);
+            CHK_STATUS(iceCandidateSerialize(pCandidate, candidateStr, &candidateLen));
+            CHK_STATUS(sdpAddMediaAttribute(pSessionDescription, pSdpMediaDescription, "candidate", "%s", candidateStr));
+        }
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pIceAgent->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS iceAgentSerializeSdpCandidates(PIceAgent pIceAgent, PCHAR pOutput, UINT32 bufferSize, PUINT32 pLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 data;
+    PDoubleListNode pCurNode = NULL;
+    BOOL locked = FALSE;
+    UINT32 candidateLen, length = 0;
+    PIceCandidate pCandidate = NULL;
+    CHAR candidateStr[MAX_SDP_ATTRIBUTE_VALUE_LENGTH + 1];
 
-    attrIndex = *pIndex;
+    CHK(pIceAgent != NULL && pOutput != NULL && pLength != NULL, STATUS_NULL_ARG);
 
     MUTEX_LOCK(pIceAgent->lock);
     locked = TRUE;
@@ -728,13 +794,21 @@ STATUS iceAgentPopulateSdpMediaDescriptionCandidates(PIceAgent pIceAgent, PSdpMe
         pCurNode = pCurNode->pNext;
         pCandidate = (PIceCandidate) data;
         if (pCandidate->state == ICE_CANDIDATE_STATE_VALID) {
-            STRCPY(pSdpMediaDescription->sdpAttributes[attrIndex].attributeName, "candidate");
-            CHK_STATUS(iceCandidateSerialize((PIceCandidate) data, pSdpMediaDescription->sdpAttributes[attrIndex].attributeValue, &attrBufferLen));
-            attrIndex++;
+            // Same bound as the candidate attribute iceAgentPopulateSdpMediaDescriptionCandidates adds
+            candidateLen = SIZEOF(candidateStr);
+            CHK_STATUS(iceCandidateSerialize(pCandidate, candidateStr, &candidateLen));
+            candidateLen = (UINT32) STRLEN(candidateStr);
+            CHK(length + STRLEN(SDP_ATTRIBUTE_MARKER "candidate:" SDP_LINE_SEPARATOR) + candidateLen <= bufferSize, STATUS_BUFFER_TOO_SMALL);
+            MEMCPY(pOutput + length, SDP_ATTRIBUTE_MARKER "candidate:", STRLEN(SDP_ATTRIBUTE_MARKER "candidate:"));
+            length += STRLEN(SDP_ATTRIBUTE_MARKER "candidate:");
+            MEMCPY(pOutput + length, candidateStr, candidateLen);
+            length += candidateLen;
+            MEMCPY(pOutput + length, SDP_LINE_SEPARATOR, STRLEN(SDP_LINE_SEPARATOR));
+            length += STRLEN(SDP_LINE_SEPARATOR);
         }
     }
 
-    *pIndex = attrIndex;
+    *pLength = length;
 
 CleanUp:
 
@@ -2536,6 +2610,7 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
                 pIceCandidatePair->roundTripTime = GETTIME() - requestSentTime;
                 pIceCandidatePair->rtcIceCandidatePairDiagnostics.currentRoundTripTime =
                     (DOUBLE) (pIceCandidatePair->roundTripTime) / HUNDREDS_OF_NANOS_IN_A_SECOND;
+                latencyHistogramRecord(&pIceAgent->checkRoundTripTimeLatency, pIceCandidatePair->roundTripTime);
             } else {
                 DLOGW("Unable to fetch request Timestamp from the hash table. No update to RTT for the pair (error code: 0x%08x)", retStatus);
             }
@@ -65,6 +65,7 @@ typedef enum {
 typedef VOID (*IceInboundPacketFunc)(UINT64, PBYTE, UINT32);
 typedef VOID (*IceConnectionStateChangedFunc)(UINT64, UINT64);
 typedef VOID (*IceNewLocalCandidateFunc)(UINT64, PCHAR);
+typedef STATUS (*IceOutboundPacketFunc)(UINT64, PBYTE, UINT32);
 
 typedef struct __IceAgent IceAgent;
 typedef struct __IceAgent* PIceAgent;
@@ -197,6 +198,9 @@ struct __IceAgent {
     volatile ATOMIC_BOOL restart;
     volatile ATOMIC_BOOL processStun;
 
+    // Round trip time of the connectivity checks that got a response
+    LatencyHistogram checkRoundTripTimeLatency;
+
     CHAR localUsername[MAX_ICE_CONFIG_USER_NAME_LEN + 1];
     CHAR localPassword[MAX_ICE_CONFIG_CREDENTIAL_LEN + 1];
     CHAR remoteUsername[MAX_ICE_CONFIG_USER_NAME_LEN + 1];
@@ -238,6 +242,10 @@ struct __IceAgent {
 
     IceAgentCallbacks iceAgentCallbacks;
 
+    // Carries the sent packets instead of the candidate pairs when set, for in-process networks such as the loopback benchmark
+    IceOutboundPacketFunc outboundPacketFn;
+    UINT64 outboundPacketCustomData;
+
     IceServer iceServers[MAX_ICE_SERVERS_COUNT];
     UINT32 iceServersCount;
 
@@ -344,6 +352,19 @@ STATUS iceCandidateSerialize(PIceCandidate, PCHAR, PUINT32);
  */
 STATUS iceAgentSendPacket(PIceAgent, PBYTE, UINT32);
 
+/**
+ * Send a batch of packets through selected connection, taking the agent lock once. Packets that fail to send are counted
+ * as discarded like in iceAgentSendPacket.
+ *
+ * @param - PIceAgent - IN - IceAgent object
+ * @param - PBYTE* - IN - buffers storing the packets to be sent
+ * @param - PUINT32 - IN - lengths of the packets
+ * @param - UINT32 - IN - number of packets
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS iceAgentSendPackets(PIceAgent, PBYTE*, PUINT32, UINT32);
+
 /**
  * gather local ip addresses and create a udp port. If port creation succeeded then create a new candidate
  * and store it in localCandidates. Ips that are already a local candidate will not be added again.
@@ -355,16 +376,27 @@ STATUS iceAgentSendPacket(PIceAgent, PBYTE, UINT32);
 STATUS iceAgentInitHostCandidate(PIceAgent);
 
 /**
- * Starting from given index, fillout PSdpMediaDescription->sdpAttributes with serialize local candidate strings.
+ * Append the serialized local candidate strings to PSdpMediaDescription->sdpAttributes.
  *
  * @param - PIceAgent - IN - IceAgent object
+ * @param - PSessionDescription - IN - PSessionDescription whose arena holds the candidate strings
  * @param - PSdpMediaDescription - IN - PSdpMediaDescription object whose sdpAttributes will be filled with local candidate strings
- * @param - UINT32 - IN - buffer length of pSdpMediaDescription->sdpAttributes[index].attributeValue
- * @param - PUINT32 - IN - starting index in sdpAttributes
  *
  * @return - STATUS - status of execution
  */
-STATUS iceAgentPopulateSdpMediaDescriptionCandidates(PIceAgent, PSdpMediaDescription, UINT32, PUINT32);
+STATUS iceAgentPopulateSdpMediaDescriptionCandidates(PIceAgent, PSessionDescription, PSdpMediaDescription);
+
+/**
+ * Write the a=candidate lines of the valid local candidates, as serializeSessionDescription would write them.
+ *
+ * @param - PIceAgent - IN - IceAgent object
+ * @param - PCHAR - OUT - Buffer the lines are written to, not NULL terminated
+ * @param - UINT32 - IN - Size of the buffer
+ * @param - PUINT32 - OUT - Length of the lines written
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS iceAgentSerializeSdpCandidates(PIceAgent, PCHAR, UINT32, PUINT32);
 
 /**
  * Start shutdown sequence for IceAgent. Once the function returns Ice will not deliver anymore data and
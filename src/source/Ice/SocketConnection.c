@@ -435,6 +435,8 @@ STATUS socketSendDataWithRetry(PSocketConnection pSocketConnection, PBYTE buf, U
         *pBytesWritten = bytesWritten;
     }
 
+    TRACE_INSTANT(TRACE_POINT_SOCKET_SEND, bytesWritten);
+
     if (result < 0) {
         CLOSE_SOCKET_IF_CANT_RETRY(errorNum, pSocketConnection);
     }
@@ -118,6 +118,8 @@ STATUS generateJSONSafeString(PCHAR, UINT32);
 ////////////////////////////////////////////////////
 // Project internal includes
 ////////////////////////////////////////////////////
+#include "Metrics/LatencyHistogram.h"
+#include "Metrics/Tracer.h"
 #include "Crypto/IOBuffer.h"
 #include "Crypto/Crypto.h"
 #include "Crypto/Dtls.h"
@@ -135,25 +137,37 @@ STATUS generateJSONSafeString(PCHAR, UINT32);
 #include "Srtp/SrtpSession.h"
 #include "Sctp/Sctp.h"
 #include "Rtp/RtpPacket.h"
+#include "Rtp/Codecs/StartCodeScanner.h"
+#include "Rtp/Codecs/RtpVP8Payloader.h"
+#include "Rtp/Codecs/RtpVP9Payloader.h"
+#include "Rtp/Codecs/RtpH264Payloader.h"
+#include "Rtp/Codecs/RtpH265Payloader.h"
+#include "Rtp/Codecs/RtpAV1Payloader.h"
+#include "Rtp/Codecs/RtpAV1DependencyDescriptor.h"
+#include "Rtp/Codecs/RtpOpusPayloader.h"
+#include "Rtp/Codecs/RtpRedPayloader.h"
+#include "Rtp/Codecs/RtpG711Payloader.h"
 #include "Rtcp/RtcpPacket.h"
 #include "Rtcp/RollingBuffer.h"
 #include "Rtcp/RtpRollingBuffer.h"
 #include "PeerConnection/JitterBuffer.h"
+#include "PeerConnection/ReceivePipeline.h"
 #include "PeerConnection/PeerConnection.h"
 #include "PeerConnection/Retransmitter.h"
-#include "PeerConnection/SessionDescription.h"
+#include "PeerConnection/FlexFec.h"
 #include "PeerConnection/Rtp.h"
+#include "PeerConnection/SessionDescription.h"
+#include "PeerConnection/SdpTemplate.h"
 #include "PeerConnection/Rtcp.h"
 #include "PeerConnection/DataChannel.h"
-#include "Rtp/Codecs/RtpVP8Payloader.h"
-#include "Rtp/Codecs/RtpH264Payloader.h"
-#include "Rtp/Codecs/RtpOpusPayloader.h"
-#include "Rtp/Codecs/RtpG711Payloader.h"
+#include "Metrics/OpenMetrics.h"
 #include "Signaling/FileCache.h"
 #include "Signaling/Signaling.h"
 #include "Signaling/ChannelInfo.h"
 #include "Signaling/StateMachine.h"
 #include "Signaling/LwsApiCalls.h"
+#include "Signaling/MessageParser.h"
+#include "Signaling/MessageDispatcher.h"
 #include "Metrics/Metrics.h"
 
 ////////////////////////////////////////////////////
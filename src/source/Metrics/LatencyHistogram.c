@@ -0,0 +1,106 @@
+/**
+ * Kinesis WebRTC latency histogram
+ */
+#define LOG_CLASS "LatencyHistogram"
+#include "../Include_i.h"
+
+static UINT32 latencyHistogramBucketIndex(UINT32 value)
+{
+    UINT32 shift = 0;
+
+    if (value < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+        return value;
+    }
+
+    // Shift the value down to the sub buckets of its power of two
+    while ((value >> shift) >= 2 * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+        shift++;
+    }
+
+    return (shift + 1) * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + (value >> shift) - LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+}
+
+static UINT64 latencyHistogramBucketLowestValue(UINT32 index)
+{
+    UINT32 shift;
+
+    if (index < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+        return index;
+    }
+
+    shift = index / LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1;
+    return (UINT64) (LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + index % LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) << shift;
+}
+
+static UINT64 latencyHistogramBucketWidth(UINT32 index)
+{
+    return index < 2 * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT ? 1 : (UINT64) 1 << (index / LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1);
+}
+
+VOID latencyHistogramRecord(PLatencyHistogram pLatencyHistogram, UINT64 value)
+{
+    if (pLatencyHistogram == NULL) {
+        return;
+    }
+
+    ATOMIC_INCREMENT(&pLatencyHistogram->counts[latencyHistogramBucketIndex((UINT32) MIN(value, LATENCY_HISTOGRAM_MAX_VALUE))]);
+}
+
+STATUS latencyHistogramGetStats(PLatencyHistogram pLatencyHistogram, PLatencyHistogramStats pLatencyHistogramStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    // Rank of p50, p90, p99 and p99.9 in thousandths
+    UINT64 percentileRanks[] = {500, 900, 990, 999};
+    PUINT64 percentileValues[ARRAY_SIZE(percentileRanks)];
+    UINT64 count, total = 0, seen = 0, target, highestValue;
+    DOUBLE sum = 0;
+    UINT32 i, percentile = 0;
+    BOOL first = TRUE;
+
+    CHK(pLatencyHistogram != NULL && pLatencyHistogramStats != NULL, STATUS_NULL_ARG);
+
+    MEMSET(pLatencyHistogramStats, 0x00, SIZEOF(LatencyHistogramStats));
+    percentileValues[0] = &pLatencyHistogramStats->p50;
+    percentileValues[1] = &pLatencyHistogramStats->p90;
+    percentileValues[2] = &pLatencyHistogramStats->p99;
+    percentileValues[3] = &pLatencyHistogramStats->p999;
+
+    // Counts only go up, so the second pass reaches every rank the first pass computed from the total
+    for (i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++) {
+        count = (UINT64) ATOMIC_LOAD(&pLatencyHistogram->counts[i]);
+        total += count;
+        sum += (DOUBLE) count * ((DOUBLE) latencyHistogramBucketLowestValue(i) + (DOUBLE) (latencyHistogramBucketWidth(i) - 1) / 2);
+    }
+
+    CHK(total > 0, retStatus);
+
+    pLatencyHistogramStats->count = total;
+    pLatencyHistogramStats->mean = (UINT64) (sum / (DOUBLE) total);
+
+    for (i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++) {
+        count = (UINT64) ATOMIC_LOAD(&pLatencyHistogram->counts[i]);
+        if (count == 0) {
+            continue;
+        }
+
+        highestValue = latencyHistogramBucketLowestValue(i) + latencyHistogramBucketWidth(i) - 1;
+        if (first) {
+            pLatencyHistogramStats->min = latencyHistogramBucketLowestValue(i);
+            first = FALSE;
+        }
+        pLatencyHistogramStats->max = highestValue;
+
+        seen += count;
+        while (percentile < ARRAY_SIZE(percentileRanks)) {
+            target = MAX((total * percentileRanks[percentile] + 999) / 1000, 1);
+            if (seen < target) {
+                break;
+            }
+            *percentileValues[percentile++] = highestValue;
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
@@ -0,0 +1,44 @@
+/*******************************************
+Latency histogram internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_LATENCY_HISTOGRAM__
+#define __KINESIS_VIDEO_WEBRTC_LATENCY_HISTOGRAM__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Each power of two range is split into 2^5 linear buckets, a bucket is at most ~3% wider than the values in it
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS  5
+#define LATENCY_HISTOGRAM_SUB_BUCKET_COUNT (1 << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+
+// Latencies are recorded in 100 ns and clamped to 32 bits, a little over 7 minutes
+#define LATENCY_HISTOGRAM_MAX_VALUE    MAX_UINT32
+#define LATENCY_HISTOGRAM_BUCKET_COUNT ((32 - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+
+/*
+ * Log-linear histogram of latencies in the manner of HdrHistogram: values below 2^5 have a bucket each, above that the
+ * range of every power of two is split into 2^5 equal buckets. Recording is a single atomic increment so it can be done
+ * from any thread without a lock, and a zeroed histogram is an empty one.
+ */
+typedef struct {
+    volatile SIZE_T counts[LATENCY_HISTOGRAM_BUCKET_COUNT];
+} LatencyHistogram, *PLatencyHistogram;
+
+/**
+ * Records a latency in 100 ns
+ */
+VOID latencyHistogramRecord(PLatencyHistogram, UINT64);
+
+/**
+ * Fills the count and the percentiles of what has been recorded so far. Recording carries on meanwhile, values recorded
+ * while the stats are computed may or may not be part of them. The values are the highest latency of their bucket.
+ */
+STATUS latencyHistogramGetStats(PLatencyHistogram, PLatencyHistogramStats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_LATENCY_HISTOGRAM__ */
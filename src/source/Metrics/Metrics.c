@@ -152,9 +152,7 @@ STATUS getRtpOutboundStats(PRtcPeerConnection pRtcPeerConnection, PRtcRtpTransce
     }
     // check if specified transceiver belongs to this connection
     CHK_STATUS(hasTransceiverWithSsrc(pKvsPeerConnection, pKvsRtpTransceiver->sender.ssrc));
-    MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
-    *pRtcOutboundRtpStreamStats = pKvsRtpTransceiver->outboundStats;
-    MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+    kvsRtpTransceiverGetOutboundStats(pKvsRtpTransceiver, pRtcOutboundRtpStreamStats);
 CleanUp:
     return retStatus;
 }
@@ -175,9 +173,7 @@ STATUS getRtpInboundStats(PRtcPeerConnection pRtcPeerConnection, PRtcRtpTranscei
     }
     // check if specified transceiver belongs to this connection
     CHK_STATUS(hasTransceiverWithSsrc(pKvsPeerConnection, pKvsRtpTransceiver->jitterBufferSsrc));
-    MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
-    *pRtcInboundRtpStreamStats = pKvsRtpTransceiver->inboundStats;
-    MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+    kvsRtpTransceiverGetInboundStats(pKvsRtpTransceiver, pRtcInboundRtpStreamStats);
 CleanUp:
     return retStatus;
 }
@@ -186,10 +182,27 @@ STATUS getDataChannelStats(PRtcPeerConnection pRtcPeerConnection, PRtcDataChanne
 {
     STATUS retStatus = STATUS_SUCCESS;
     PKvsDataChannel pKvsDataChannel = NULL;
-    UINT64 hashValue = 0;
+    UINT64 hashValue = 0, item;
+    PDoubleListNode pCurNode = NULL;
+    BOOL locked = FALSE;
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
     CHK(pRtcPeerConnection != NULL && pRtcDataChannelStats != NULL, STATUS_NULL_ARG);
-    CHK_STATUS(hashTableGet(pKvsPeerConnection->pDataChannels, pRtcDataChannelStats->dataChannelIdentifier, &hashValue));
+    MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = TRUE;
+    retStatus = hashTableGet(pKvsPeerConnection->pDataChannels, pRtcDataChannelStats->dataChannelIdentifier, &hashValue);
+    if (retStatus == STATUS_HASH_KEY_NOT_PRESENT) {
+        // Most recently closed channel with the id
+        CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pClosedDataChannels, &pCurNode));
+        while (pCurNode != NULL && hashValue == 0) {
+            CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+            if (((PKvsDataChannel) item)->channelId == pRtcDataChannelStats->dataChannelIdentifier) {
+                hashValue = item;
+            }
+            pCurNode = pCurNode->pNext;
+        }
+    }
+    CHK(hashValue != 0, retStatus);
+    retStatus = STATUS_SUCCESS;
     pKvsDataChannel = (PKvsDataChannel) hashValue;
     pRtcDataChannelStats->bytesReceived = pKvsDataChannel->rtcDataChannelDiagnostics.bytesReceived;
     pRtcDataChannelStats->bytesSent = pKvsDataChannel->rtcDataChannelDiagnostics.bytesSent;
@@ -198,6 +211,9 @@ STATUS getDataChannelStats(PRtcPeerConnection pRtcPeerConnection, PRtcDataChanne
     pRtcDataChannelStats->messagesSent = pKvsDataChannel->rtcDataChannelDiagnostics.messagesSent;
     pRtcDataChannelStats->state = pKvsDataChannel->rtcDataChannelDiagnostics.state;
 CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    }
     return retStatus;
 }
 
@@ -0,0 +1,650 @@
+/**
+ * Kinesis WebRTC OpenMetrics exporter
+ */
+#define LOG_CLASS "OpenMetrics"
+#include "../Include_i.h"
+
+#define OPEN_METRICS_TYPE_COUNTER "counter"
+#define OPEN_METRICS_TYPE_GAUGE   "gauge"
+
+// Turns the ms and 100 ns the stats are kept in into the seconds OpenMetrics expects
+#define OPEN_METRICS_SCALE_MS         (1.0 / 1000)
+#define OPEN_METRICS_SCALE_HUNDRED_NS (1.0 / HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+typedef struct {
+    MUTEX lock;
+    UINT64 nextId;
+    PDoubleList pPeerConnections;
+} MetricsRegistry, *PMetricsRegistry;
+
+typedef struct {
+    UINT64 id;
+    UINT64 object;
+} MetricsRegistryEntry, *PMetricsRegistryEntry;
+
+typedef enum {
+    OPEN_METRICS_SOURCE_PEER_CONNECTION,
+    OPEN_METRICS_SOURCE_TRANSCEIVER,
+    OPEN_METRICS_SOURCE_SIGNALING_CLIENT,
+} OPEN_METRICS_SOURCE;
+
+typedef enum {
+    OPEN_METRICS_VALUE_UINT32,
+    OPEN_METRICS_VALUE_INT32,
+    OPEN_METRICS_VALUE_UINT64,
+    OPEN_METRICS_VALUE_INT64,
+    OPEN_METRICS_VALUE_DOUBLE,
+} OPEN_METRICS_VALUE;
+
+/*
+ * A metric family and where its value sits in the snapshot of the objects it is exported for. A non zero scale turns the
+ * value into a floating point one.
+ */
+typedef struct {
+    PCHAR name;
+    PCHAR type;
+    PCHAR help;
+    OPEN_METRICS_SOURCE source;
+    UINT32 offset;
+    OPEN_METRICS_VALUE valueType;
+    DOUBLE scale;
+} OpenMetricsFamily, *POpenMetricsFamily;
+
+typedef struct {
+    PPeerConnectionMetricsSnapshot pPeerConnections;
+    UINT32 peerConnectionCount;
+    PTransceiverMetricsSnapshot pTransceivers;
+    UINT32 transceiverCount;
+    PSignalingClientMetricsSnapshot pSignalingClients;
+    UINT32 signalingClientCount;
+} OpenMetricsSnapshots, *POpenMetricsSnapshots;
+
+typedef struct {
+    PCHAR pBuffer;
+    UINT32 bufferSize;
+    UINT32 length;
+} OpenMetricsWriter, *POpenMetricsWriter;
+
+#define OPEN_METRICS_FAMILY(name, type, help, source, snapshotType, field, valueType, scale)                                                    \
+    { OPEN_METRICS_NAME_PREFIX name, type, help, source, (UINT32) offsetof(snapshotType, field), valueType, scale }
+#define OPEN_METRICS_PEER_CONNECTION_FAMILY(name, type, help, field, valueType, scale)                                                         \
+    OPEN_METRICS_FAMILY(name, type, help, OPEN_METRICS_SOURCE_PEER_CONNECTION, PeerConnectionMetricsSnapshot, field, valueType, scale)
+#define OPEN_METRICS_TRANSCEIVER_FAMILY(name, type, help, field, valueType, scale)                                                             \
+    OPEN_METRICS_FAMILY(name, type, help, OPEN_METRICS_SOURCE_TRANSCEIVER, TransceiverMetricsSnapshot, field, valueType, scale)
+#define OPEN_METRICS_SIGNALING_CLIENT_FAMILY(name, type, help, field, valueType, scale)                                                        \
+    OPEN_METRICS_FAMILY(name, type, help, OPEN_METRICS_SOURCE_SIGNALING_CLIENT, SignalingClientMetricsSnapshot, field, valueType, scale)
+
+static OpenMetricsFamily gOpenMetricsFamilies[] = {
+    OPEN_METRICS_PEER_CONNECTION_FAMILY("peer_connection_creation_seconds", OPEN_METRICS_TYPE_GAUGE, "Time taken to create the peer connection",
+                                        peerConnectionMetrics.peerConnectionStats.peerConnectionCreationTime, OPEN_METRICS_VALUE_UINT64,
+                                        OPEN_METRICS_SCALE_MS),
+    OPEN_METRICS_PEER_CONNECTION_FAMILY("dtls_setup_seconds", OPEN_METRICS_TYPE_GAUGE, "Time taken for the DTLS handshake to complete",
+                                        peerConnectionMetrics.peerConnectionStats.dtlsSessionSetupTime, OPEN_METRICS_VALUE_UINT64,
+                                        OPEN_METRICS_SCALE_MS),
+    OPEN_METRICS_PEER_CONNECTION_FAMILY("ice_hole_punching_seconds", OPEN_METRICS_TYPE_GAUGE, "Time taken for the ICE agent to connect",
+                                        peerConnectionMetrics.peerConnectionStats.iceHolePunchingTime, OPEN_METRICS_VALUE_UINT64,
+                                        OPEN_METRICS_SCALE_MS),
+    OPEN_METRICS_PEER_CONNECTION_FAMILY("ice_candidate_gathering_seconds", OPEN_METRICS_TYPE_GAUGE, "Time taken to gather the local candidates",
+                                        iceAgentMetrics.kvsIceAgentStats.candidateGatheringTime, OPEN_METRICS_VALUE_UINT64,
+                                        OPEN_METRICS_SCALE_MS),
+    OPEN_METRICS_PEER_CONNECTION_FAMILY("ice_agent_setup_seconds", OPEN_METRICS_TYPE_GAUGE, "Time taken to set the ICE agent up",
+                                        iceAgentMetrics.kvsIceAgentStats.iceAgentSetUpTime, OPEN_METRICS_VALUE_UINT64, OPEN_METRICS_SCALE_MS),
+    OPEN_METRICS_PEER_CONNECTION_FAMILY("ice_selected_pair_packets_sent", OPEN_METRICS_TYPE_COUNTER, "Packets sent on the selected candidate pair",
+                                        selectedPairStats.packetsSent, OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_PEER_CONNECTION_FAMILY("ice_selected_pair_packets_received", OPEN_METRICS_TYPE_COUNTER,
+                                        "Packets received on the selected candidate pair", selectedPairStats.packetsReceived,
+                                        OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_PEER_CONNECTION_FAMILY("ice_selected_pair_bytes_sent", OPEN_METRICS_TYPE_COUNTER, "Bytes sent on the selected candidate pair",
+                                        selectedPairStats.bytesSent, OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_PEER_CONNECTION_FAMILY("ice_selected_pair_bytes_received", OPEN_METRICS_TYPE_COUNTER,
+                                        "Bytes received on the selected candidate pair", selectedPairStats.bytesReceived, OPEN_METRICS_VALUE_UINT64,
+                                        0),
+    OPEN_METRICS_PEER_CONNECTION_FAMILY("ice_selected_pair_round_trip_time_seconds", OPEN_METRICS_TYPE_GAUGE,
+                                        "Latest round trip time of the selected candidate pair", selectedPairStats.currentRoundTripTime,
+                                        OPEN_METRICS_VALUE_DOUBLE, 0),
+
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_packets_sent", OPEN_METRICS_TYPE_COUNTER, "RTP packets sent", outboundStats.sent.packetsSent,
+                                    OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_bytes_sent", OPEN_METRICS_TYPE_COUNTER, "RTP payload bytes sent", outboundStats.sent.bytesSent,
+                                    OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_header_bytes_sent", OPEN_METRICS_TYPE_COUNTER, "RTP header and padding bytes sent",
+                                    outboundStats.headerBytesSent, OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_packets_discarded_on_send", OPEN_METRICS_TYPE_COUNTER, "RTP packets the socket failed to send",
+                                    outboundStats.packetsDiscardedOnSend, OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_retransmitted_packets_sent", OPEN_METRICS_TYPE_COUNTER, "RTP packets retransmitted",
+                                    outboundStats.retransmittedPacketsSent, OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_fec_packets_sent", OPEN_METRICS_TYPE_COUNTER, "RTP FEC packets sent", outboundStats.fecPacketsSent,
+                                    OPEN_METRICS_VALUE_INT32, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_frames_sent", OPEN_METRICS_TYPE_COUNTER, "Frames sent", outboundStats.framesSent,
+                                    OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_frames_discarded_on_send", OPEN_METRICS_TYPE_COUNTER, "Frames the socket failed to send",
+                                    outboundStats.framesDiscardedOnSend, OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_nack_received", OPEN_METRICS_TYPE_COUNTER, "NACK packets received", outboundStats.nackCount,
+                                    OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_pli_received", OPEN_METRICS_TYPE_COUNTER, "PLI packets received", outboundStats.pliCount,
+                                    OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_fir_received", OPEN_METRICS_TYPE_COUNTER, "FIR packets received", outboundStats.firCount,
+                                    OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_frames_per_second", OPEN_METRICS_TYPE_GAUGE, "Frames sent during the last second",
+                                    outboundStats.framesPerSecond, OPEN_METRICS_VALUE_DOUBLE, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("outbound_rtp_target_bitrate", OPEN_METRICS_TYPE_GAUGE, "Target bitrate in bits per second",
+                                    outboundStats.targetBitrate, OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_packets_received", OPEN_METRICS_TYPE_COUNTER, "RTP packets received",
+                                    inboundStats.received.packetsReceived, OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_bytes_received", OPEN_METRICS_TYPE_COUNTER, "RTP payload bytes received", inboundStats.bytesReceived,
+                                    OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_header_bytes_received", OPEN_METRICS_TYPE_COUNTER, "RTP header and padding bytes received",
+                                    inboundStats.headerBytesReceived, OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_packets_lost", OPEN_METRICS_TYPE_GAUGE, "RTP packets lost, duplicates can make it go down",
+                                    inboundStats.received.packetsLost, OPEN_METRICS_VALUE_INT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_packets_discarded", OPEN_METRICS_TYPE_COUNTER, "RTP packets discarded by the jitter buffer",
+                                    inboundStats.received.packetsDiscarded, OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_packets_failed_decryption", OPEN_METRICS_TYPE_COUNTER, "RTP packets that failed to be decrypted",
+                                    inboundStats.packetsFailedDecryption, OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_fec_packets_received", OPEN_METRICS_TYPE_COUNTER, "RTP FEC packets received",
+                                    inboundStats.fecPacketsReceived, OPEN_METRICS_VALUE_UINT64, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_frames_received", OPEN_METRICS_TYPE_COUNTER, "Complete frames received", inboundStats.framesReceived,
+                                    OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_frames_dropped", OPEN_METRICS_TYPE_COUNTER, "Frames dropped before being handed out",
+                                    inboundStats.received.framesDropped, OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_nack_sent", OPEN_METRICS_TYPE_COUNTER, "NACK packets sent", inboundStats.nackCount,
+                                    OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_jitter_seconds", OPEN_METRICS_TYPE_GAUGE, "Interarrival jitter of the RTP packets",
+                                    inboundStats.received.jitter, OPEN_METRICS_VALUE_DOUBLE, 0),
+    OPEN_METRICS_TRANSCEIVER_FAMILY("inbound_rtp_jitter_buffer_delay_seconds", OPEN_METRICS_TYPE_COUNTER,
+                                    "Sum of the time the frames spent in the jitter buffer", inboundStats.jitterBufferDelay,
+                                    OPEN_METRICS_VALUE_DOUBLE, 0),
+
+    OPEN_METRICS_SIGNALING_CLIENT_FAMILY("signaling_messages_sent", OPEN_METRICS_TYPE_COUNTER, "Messages sent by the signaling client",
+                                         signalingClientMetrics.signalingClientStats.numberOfMessagesSent, OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_SIGNALING_CLIENT_FAMILY("signaling_messages_received", OPEN_METRICS_TYPE_COUNTER, "Messages received by the signaling client",
+                                         signalingClientMetrics.signalingClientStats.numberOfMessagesReceived, OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_SIGNALING_CLIENT_FAMILY("signaling_errors", OPEN_METRICS_TYPE_COUNTER, "Signaling client API call failures",
+                                         signalingClientMetrics.signalingClientStats.numberOfErrors, OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_SIGNALING_CLIENT_FAMILY("signaling_runtime_errors", OPEN_METRICS_TYPE_COUNTER, "Errors on the signaling client background threads",
+                                         signalingClientMetrics.signalingClientStats.numberOfRuntimeErrors, OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_SIGNALING_CLIENT_FAMILY("signaling_reconnects", OPEN_METRICS_TYPE_COUNTER, "Reconnects of the signaling client",
+                                         signalingClientMetrics.signalingClientStats.numberOfReconnects, OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_SIGNALING_CLIENT_FAMILY("signaling_message_queue_depth", OPEN_METRICS_TYPE_GAUGE,
+                                         "Received messages waiting to be handed to the application",
+                                         signalingClientMetrics.signalingClientStats.messageQueueDepth, OPEN_METRICS_VALUE_UINT32, 0),
+    OPEN_METRICS_SIGNALING_CLIENT_FAMILY("signaling_uptime_seconds", OPEN_METRICS_TYPE_GAUGE, "Time the signaling client has been connected for",
+                                         signalingClientMetrics.signalingClientStats.signalingClientUptime, OPEN_METRICS_VALUE_UINT64,
+                                         OPEN_METRICS_SCALE_HUNDRED_NS),
+    OPEN_METRICS_SIGNALING_CLIENT_FAMILY("signaling_connection_duration_seconds", OPEN_METRICS_TYPE_GAUGE, "Duration of the signaling connection",
+                                         signalingClientMetrics.signalingClientStats.connectionDuration, OPEN_METRICS_VALUE_UINT64,
+                                         OPEN_METRICS_SCALE_HUNDRED_NS),
+};
+
+// Indexed by LATENCY_STAGE
+static PCHAR gOpenMetricsLatencyStageNames[] = {
+    "dtls_handshake", "ice_check_rtt", "frame_assembly", "write_frame", "srtp", "signaling_dispatch",
+};
+
+// Registry of the live peer connections, created when the first one is added. Signaling clients are kept by the
+// signaling library
+static volatile SIZE_T gMetricsRegistry = (SIZE_T) NULL;
+
+static STATUS getMetricsRegistry(PMetricsRegistry* ppMetricsRegistry)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PMetricsRegistry pMetricsRegistry = (PMetricsRegistry) ATOMIC_LOAD(&gMetricsRegistry);
+    SIZE_T expected = (SIZE_T) NULL;
+
+    if (pMetricsRegistry == NULL) {
+        CHK(NULL != (pMetricsRegistry = (PMetricsRegistry) MEMCALLOC(1, SIZEOF(MetricsRegistry))), STATUS_NOT_ENOUGH_MEMORY);
+        pMetricsRegistry->lock = MUTEX_CREATE(FALSE);
+        CHK_STATUS(doubleListCreate(&pMetricsRegistry->pPeerConnections));
+        // Objects can be created on several threads at once, keep whichever registry got published first
+        if (ATOMIC_COMPARE_EXCHANGE(&gMetricsRegistry, &expected, (SIZE_T) pMetricsRegistry)) {
+            *ppMetricsRegistry = pMetricsRegistry;
+            pMetricsRegistry = NULL;
+        } else {
+            *ppMetricsRegistry = (PMetricsRegistry) expected;
+        }
+    } else {
+        *ppMetricsRegistry = pMetricsRegistry;
+        pMetricsRegistry = NULL;
+    }
+
+CleanUp:
+
+    if (pMetricsRegistry != NULL) {
+        doubleListFree(pMetricsRegistry->pPeerConnections);
+        MUTEX_FREE(pMetricsRegistry->lock);
+        SAFE_MEMFREE(pMetricsRegistry);
+    }
+
+    return retStatus;
+}
+
+STATUS deinitMetricsRegistry(VOID)
+{
+    PMetricsRegistry pMetricsRegistry = (PMetricsRegistry) ATOMIC_EXCHANGE(&gMetricsRegistry, (SIZE_T) NULL);
+
+    if (pMetricsRegistry != NULL) {
+        // Objects still alive were never going to be exported again, only their entries are freed
+        doubleListClear(pMetricsRegistry->pPeerConnections, TRUE);
+        doubleListFree(pMetricsRegistry->pPeerConnections);
+        MUTEX_FREE(pMetricsRegistry->lock);
+        SAFE_MEMFREE(pMetricsRegistry);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+STATUS metricsRegistryAddPeerConnection(PKvsPeerConnection pKvsPeerConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PMetricsRegistry pMetricsRegistry = NULL;
+    PMetricsRegistryEntry pEntry = NULL;
+    BOOL locked = FALSE;
+
+    CHK(pKvsPeerConnection != NULL, STATUS_NULL_ARG);
+    CHK_STATUS(getMetricsRegistry(&pMetricsRegistry));
+    CHK(NULL != (pEntry = (PMetricsRegistryEntry) MEMCALLOC(1, SIZEOF(MetricsRegistryEntry))), STATUS_NOT_ENOUGH_MEMORY);
+    pEntry->object = (UINT64) pKvsPeerConnection;
+
+    MUTEX_LOCK(pMetricsRegistry->lock);
+    locked = TRUE;
+    pEntry->id = pMetricsRegistry->nextId++;
+    CHK_STATUS(doubleListInsertItemTail(pMetricsRegistry->pPeerConnections, (UINT64) pEntry));
+    pEntry = NULL;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pMetricsRegistry->lock);
+    }
+
+    SAFE_MEMFREE(pEntry);
+
+    return retStatus;
+}
+
+STATUS metricsRegistryRemovePeerConnection(PKvsPeerConnection pKvsPeerConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PMetricsRegistry pMetricsRegistry = (PMetricsRegistry) ATOMIC_LOAD(&gMetricsRegistry);
+    PDoubleListNode pCurNode = NULL;
+    PMetricsRegistryEntry pEntry = NULL;
+    UINT64 item;
+    BOOL locked = FALSE;
+
+    // Nothing was ever added
+    CHK(pMetricsRegistry != NULL, retStatus);
+
+    MUTEX_LOCK(pMetricsRegistry->lock);
+    locked = TRUE;
+
+    CHK_STATUS(doubleListGetHeadNode(pMetricsRegistry->pPeerConnections, &pCurNode));
+    while (pCurNode != NULL) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+        if (((PMetricsRegistryEntry) item)->object == (UINT64) pKvsPeerConnection) {
+            pEntry = (PMetricsRegistryEntry) item;
+            CHK_STATUS(doubleListDeleteNode(pMetricsRegistry->pPeerConnections, pCurNode));
+            break;
+        }
+        pCurNode = pCurNode->pNext;
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pMetricsRegistry->lock);
+    }
+
+    SAFE_MEMFREE(pEntry);
+
+    return retStatus;
+}
+
+STATUS openMetricsEscapeLabelValue(PCHAR pValue, PCHAR pBuffer, UINT32 bufferLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 length = 0;
+    PCHAR pCurPtr;
+
+    CHK(pValue != NULL && pBuffer != NULL, STATUS_NULL_ARG);
+    // Both quotes and the terminating NULL
+    CHK(bufferLen >= 3, STATUS_BUFFER_TOO_SMALL);
+
+    pBuffer[length++] = '"';
+    for (pCurPtr = pValue; *pCurPtr != '\0'; pCurPtr++) {
+        CHK(length + (*pCurPtr == '\\' || *pCurPtr == '"' || *pCurPtr == '\n' ? 2 : 1) + 2 <= bufferLen, STATUS_BUFFER_TOO_SMALL);
+        switch (*pCurPtr) {
+            case '\\':
+                pBuffer[length++] = '\\';
+                pBuffer[length++] = '\\';
+                break;
+            case '"':
+                pBuffer[length++] = '\\';
+                pBuffer[length++] = '"';
+                break;
+            case '\n':
+                pBuffer[length++] = '\\';
+                pBuffer[length++] = 'n';
+                break;
+            default:
+                pBuffer[length++] = *pCurPtr;
+                break;
+        }
+    }
+    pBuffer[length++] = '"';
+    pBuffer[length] = '\0';
+
+CleanUp:
+
+    return retStatus;
+}
+
+static VOID freeOpenMetricsSnapshots(POpenMetricsSnapshots pSnapshots)
+{
+    SAFE_MEMFREE(pSnapshots->pPeerConnections);
+    SAFE_MEMFREE(pSnapshots->pTransceivers);
+    SAFE_MEMFREE(pSnapshots->pSignalingClients);
+}
+
+static STATUS openMetricsSnapshotTransceiver(UINT64 peerConnectionId, PKvsRtpTransceiver pKvsRtpTransceiver,
+                                             PTransceiverMetricsSnapshot pSnapshot)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    CHAR trackId[2 * MAX_MEDIA_STREAM_ID_LEN + 3];
+
+    CHK_STATUS(openMetricsEscapeLabelValue(pKvsRtpTransceiver->sender.track.trackId, trackId, ARRAY_SIZE(trackId)));
+    SNPRINTF(pSnapshot->labels, ARRAY_SIZE(pSnapshot->labels), "peer_connection=\"%" PRIu64 "\",track=%s,kind=\"%s\"", peerConnectionId, trackId,
+             pKvsRtpTransceiver->sender.track.kind == MEDIA_STREAM_TRACK_KIND_VIDEO ? "video" : "audio");
+    kvsRtpTransceiverGetOutboundStats(pKvsRtpTransceiver, &pSnapshot->outboundStats);
+    kvsRtpTransceiverGetInboundStats(pKvsRtpTransceiver, &pSnapshot->inboundStats);
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS openMetricsSnapshotPeerConnection(PMetricsRegistryEntry pEntry, PPeerConnectionMetricsSnapshot pSnapshot,
+                                                PTransceiverMetricsSnapshot pTransceivers, UINT32 transceiverCapacity, PUINT32 pTransceiverCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pEntry->object;
+    PRtcPeerConnection pRtcPeerConnection = (PRtcPeerConnection) pKvsPeerConnection;
+    PDoubleListNode pCurNode = NULL;
+    UINT64 item;
+
+    SNPRINTF(pSnapshot->labels, ARRAY_SIZE(pSnapshot->labels), "peer_connection=\"%" PRIu64 "\"", pEntry->id);
+    pSnapshot->peerConnectionMetrics.version = PEER_CONNECTION_METRICS_CURRENT_VERSION;
+    CHK_STATUS(peerConnectionGetMetrics(pRtcPeerConnection, &pSnapshot->peerConnectionMetrics));
+    pSnapshot->iceAgentMetrics.version = ICE_AGENT_METRICS_CURRENT_VERSION;
+    CHK_STATUS(iceAgentGetMetrics(pRtcPeerConnection, &pSnapshot->iceAgentMetrics));
+    CHK_STATUS(getIceCandidatePairStats(pRtcPeerConnection, &pSnapshot->selectedPairStats));
+    pSnapshot->latencyMetrics.version = LATENCY_METRICS_CURRENT_VERSION;
+    CHK_STATUS(peerConnectionGetLatencyMetrics(pRtcPeerConnection, &pSnapshot->latencyMetrics));
+
+    // Transceivers added since they were counted don't fit, they are exported by the next scrape
+    CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
+    while (pCurNode != NULL && *pTransceiverCount < transceiverCapacity) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+        CHK_STATUS(openMetricsSnapshotTransceiver(pEntry->id, (PKvsRtpTransceiver) item, &pTransceivers[(*pTransceiverCount)++]));
+        pCurNode = pCurNode->pNext;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS openMetricsLabelSignalingClient(PSignalingClientMetricsSnapshot pSnapshot)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    CHAR channel[2 * MAX_CHANNEL_NAME_LEN + 3];
+
+    CHK_STATUS(openMetricsEscapeLabelValue(pSnapshot->channel, channel, ARRAY_SIZE(channel)));
+    SNPRINTF(pSnapshot->labels, ARRAY_SIZE(pSnapshot->labels), "signaling_client=\"%" PRIu64 "\",channel=%s,role=\"%s\"", pSnapshot->id, channel,
+             pSnapshot->role == SIGNALING_CHANNEL_ROLE_TYPE_MASTER ? "master" : "viewer");
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Copies the stats of every registered object under the registry lock, so none of them can be freed halfway through and
+ * formatting the text happens without holding anything.
+ */
+static STATUS openMetricsTakeSnapshots(POpenMetricsSnapshots pSnapshots)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PMetricsRegistry pMetricsRegistry = (PMetricsRegistry) ATOMIC_LOAD(&gMetricsRegistry);
+    PDoubleListNode pCurNode = NULL;
+    UINT64 item;
+    UINT32 count, transceiverCount = 0;
+    BOOL locked = FALSE;
+
+    // The signaling library holds its clients under a lock of its own
+    CHK_STATUS(signalingTakeMetricsSnapshots(&pSnapshots->pSignalingClients, &pSnapshots->signalingClientCount));
+    for (count = 0; count < pSnapshots->signalingClientCount; count++) {
+        CHK_STATUS(openMetricsLabelSignalingClient(&pSnapshots->pSignalingClients[count]));
+    }
+
+    // No peer connection was ever added
+    CHK(pMetricsRegistry != NULL, retStatus);
+
+    MUTEX_LOCK(pMetricsRegistry->lock);
+    locked = TRUE;
+
+    CHK_STATUS(doubleListGetNodeCount(pMetricsRegistry->pPeerConnections, &pSnapshots->peerConnectionCount));
+    CHK_STATUS(doubleListGetHeadNode(pMetricsRegistry->pPeerConnections, &pCurNode));
+    while (pCurNode != NULL) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+        CHK_STATUS(doubleListGetNodeCount(((PKvsPeerConnection) ((PMetricsRegistryEntry) item)->object)->pTransceivers, &count));
+        transceiverCount += count;
+        pCurNode = pCurNode->pNext;
+    }
+
+    if (pSnapshots->peerConnectionCount > 0) {
+        CHK(NULL != (pSnapshots->pPeerConnections = (PPeerConnectionMetricsSnapshot) MEMCALLOC(pSnapshots->peerConnectionCount,
+                                                                                                 SIZEOF(PeerConnectionMetricsSnapshot))),
+            STATUS_NOT_ENOUGH_MEMORY);
+    }
+    if (transceiverCount > 0) {
+        CHK(NULL !=
+                (pSnapshots->pTransceivers = (PTransceiverMetricsSnapshot) MEMCALLOC(transceiverCount, SIZEOF(TransceiverMetricsSnapshot))),
+            STATUS_NOT_ENOUGH_MEMORY);
+    }
+
+    count = 0;
+    CHK_STATUS(doubleListGetHeadNode(pMetricsRegistry->pPeerConnections, &pCurNode));
+    while (pCurNode != NULL) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+        CHK_STATUS(openMetricsSnapshotPeerConnection((PMetricsRegistryEntry) item, &pSnapshots->pPeerConnections[count++], pSnapshots->pTransceivers,
+                                                     transceiverCount, &pSnapshots->transceiverCount));
+        pCurNode = pCurNode->pNext;
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pMetricsRegistry->lock);
+    }
+
+    return retStatus;
+}
+
+// Keeps counting once the buffer is full so that the caller learns the size it needs
+static VOID openMetricsWrite(POpenMetricsWriter pWriter, PCHAR pFormat, ...)
+{
+    va_list args;
+    INT32 length;
+    BOOL fits = pWriter->pBuffer != NULL && pWriter->length < pWriter->bufferSize;
+
+    va_start(args, pFormat);
+    length = vsnprintf(fits ? pWriter->pBuffer + pWriter->length : NULL, fits ? pWriter->bufferSize - pWriter->length : 0, pFormat, args);
+    va_end(args);
+
+    if (length > 0) {
+        pWriter->length += (UINT32) length;
+    }
+}
+
+// Sample labels come first in every snapshot
+static UINT32 openMetricsGetSnapshots(POpenMetricsSnapshots pSnapshots, OPEN_METRICS_SOURCE source, PBYTE* ppFirst, PUINT32 pStride)
+{
+    switch (source) {
+        case OPEN_METRICS_SOURCE_PEER_CONNECTION:
+            *ppFirst = (PBYTE) pSnapshots->pPeerConnections;
+            *pStride = SIZEOF(PeerConnectionMetricsSnapshot);
+            return pSnapshots->peerConnectionCount;
+        case OPEN_METRICS_SOURCE_TRANSCEIVER:
+            *ppFirst = (PBYTE) pSnapshots->pTransceivers;
+            *pStride = SIZEOF(TransceiverMetricsSnapshot);
+            return pSnapshots->transceiverCount;
+        case OPEN_METRICS_SOURCE_SIGNALING_CLIENT:
+            *ppFirst = (PBYTE) pSnapshots->pSignalingClients;
+            *pStride = SIZEOF(SignalingClientMetricsSnapshot);
+            return pSnapshots->signalingClientCount;
+    }
+
+    return 0;
+}
+
+static VOID openMetricsWriteValue(POpenMetricsWriter pWriter, POpenMetricsFamily pFamily, PBYTE pValue)
+{
+    INT64 signedValue = 0;
+    UINT64 unsignedValue = 0;
+    DOUBLE doubleValue;
+    BOOL isSigned = FALSE;
+
+    switch (pFamily->valueType) {
+        case OPEN_METRICS_VALUE_UINT32:
+            unsignedValue = *(PUINT32) pValue;
+            break;
+        case OPEN_METRICS_VALUE_INT32:
+            signedValue = *(PINT32) pValue;
+            isSigned = TRUE;
+            break;
+        case OPEN_METRICS_VALUE_UINT64:
+            unsignedValue = *(PUINT64) pValue;
+            break;
+        case OPEN_METRICS_VALUE_INT64:
+            signedValue = *(PINT64) pValue;
+            isSigned = TRUE;
+            break;
+        case OPEN_METRICS_VALUE_DOUBLE:
+            openMetricsWrite(pWriter, " %.9g\n", *(PDOUBLE) pValue);
+            return;
+    }
+
+    if (pFamily->scale != 0) {
+        doubleValue = isSigned ? (DOUBLE) signedValue : (DOUBLE) unsignedValue;
+        openMetricsWrite(pWriter, " %.9g\n", doubleValue * pFamily->scale);
+    } else if (isSigned) {
+        openMetricsWrite(pWriter, " %" PRId64 "\n", signedValue);
+    } else {
+        openMetricsWrite(pWriter, " %" PRIu64 "\n", unsignedValue);
+    }
+}
+
+static VOID openMetricsWriteFamily(POpenMetricsWriter pWriter, POpenMetricsFamily pFamily, POpenMetricsSnapshots pSnapshots)
+{
+    PBYTE pFirst = NULL, pSnapshot;
+    UINT32 i, stride = 0, count;
+    BOOL counter = STRCMP(pFamily->type, OPEN_METRICS_TYPE_COUNTER) == 0;
+
+    count = openMetricsGetSnapshots(pSnapshots, pFamily->source, &pFirst, &stride);
+    if (count == 0) {
+        return;
+    }
+
+    openMetricsWrite(pWriter, "# TYPE %s %s\n# HELP %s %s\n", pFamily->name, pFamily->type, pFamily->name, pFamily->help);
+    for (i = 0, pSnapshot = pFirst; i < count; i++, pSnapshot += stride) {
+        openMetricsWrite(pWriter, "%s%s{%s}", pFamily->name, counter ? "_total" : "", (PCHAR) pSnapshot);
+        openMetricsWriteValue(pWriter, pFamily, pSnapshot + pFamily->offset);
+    }
+}
+
+static VOID openMetricsWriteLatencySamples(POpenMetricsWriter pWriter, PCHAR pLabels, PLatencyMetrics pLatencyMetrics)
+{
+    PLatencyHistogramStats pStats;
+    UINT32 stage;
+
+    for (stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        pStats = &pLatencyMetrics->stageLatency[stage];
+        if (pStats->count == 0) {
+            continue;
+        }
+
+        openMetricsWrite(pWriter,
+                         OPEN_METRICS_NAME_PREFIX "latency_seconds{%s,stage=\"%s\",quantile=\"0.5\"} %.9g\n" OPEN_METRICS_NAME_PREFIX
+                                                  "latency_seconds{%s,stage=\"%s\",quantile=\"0.9\"} %.9g\n" OPEN_METRICS_NAME_PREFIX
+                                                  "latency_seconds{%s,stage=\"%s\",quantile=\"0.99\"} %.9g\n" OPEN_METRICS_NAME_PREFIX
+                                                  "latency_seconds{%s,stage=\"%s\",quantile=\"0.999\"} %.9g\n",
+                         pLabels, gOpenMetricsLatencyStageNames[stage], (DOUBLE) pStats->p50 * OPEN_METRICS_SCALE_HUNDRED_NS, pLabels,
+                         gOpenMetricsLatencyStageNames[stage], (DOUBLE) pStats->p90 * OPEN_METRICS_SCALE_HUNDRED_NS, pLabels,
+                         gOpenMetricsLatencyStageNames[stage], (DOUBLE) pStats->p99 * OPEN_METRICS_SCALE_HUNDRED_NS, pLabels,
+                         gOpenMetricsLatencyStageNames[stage], (DOUBLE) pStats->p999 * OPEN_METRICS_SCALE_HUNDRED_NS);
+        openMetricsWrite(pWriter,
+                         OPEN_METRICS_NAME_PREFIX "latency_seconds_sum{%s,stage=\"%s\"} %.9g\n" OPEN_METRICS_NAME_PREFIX
+                                                  "latency_seconds_count{%s,stage=\"%s\"} %" PRIu64 "\n",
+                         pLabels, gOpenMetricsLatencyStageNames[stage],
+                         (DOUBLE) pStats->mean * (DOUBLE) pStats->count * OPEN_METRICS_SCALE_HUNDRED_NS, pLabels,
+                         gOpenMetricsLatencyStageNames[stage], pStats->count);
+    }
+}
+
+static VOID openMetricsWriteLatency(POpenMetricsWriter pWriter, POpenMetricsSnapshots pSnapshots)
+{
+    UINT32 i;
+
+    if (pSnapshots->peerConnectionCount == 0 && pSnapshots->signalingClientCount == 0) {
+        return;
+    }
+
+    openMetricsWrite(pWriter,
+                     "# TYPE " OPEN_METRICS_NAME_PREFIX "latency_seconds summary\n"
+                     "# HELP " OPEN_METRICS_NAME_PREFIX "latency_seconds Latency of the SDK stages, quantiles are the upper bound of their bucket\n");
+    for (i = 0; i < pSnapshots->peerConnectionCount; i++) {
+        openMetricsWriteLatencySamples(pWriter, pSnapshots->pPeerConnections[i].labels, &pSnapshots->pPeerConnections[i].latencyMetrics);
+    }
+    for (i = 0; i < pSnapshots->signalingClientCount; i++) {
+        openMetricsWriteLatencySamples(pWriter, pSnapshots->pSignalingClients[i].labels, &pSnapshots->pSignalingClients[i].latencyMetrics);
+    }
+}
+
+STATUS exportOpenMetrics(PCHAR pBuffer, PUINT32 pBufferSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    OpenMetricsSnapshots snapshots;
+    OpenMetricsWriter writer;
+    UINT32 i;
+
+    MEMSET(&snapshots, 0x00, SIZEOF(OpenMetricsSnapshots));
+    CHK(pBufferSize != NULL, STATUS_NULL_ARG);
+
+    writer.pBuffer = pBuffer;
+    writer.bufferSize = pBuffer == NULL ? 0 : *pBufferSize;
+    writer.length = 0;
+
+    CHK_STATUS(openMetricsTakeSnapshots(&snapshots));
+
+    for (i = 0; i < ARRAY_SIZE(gOpenMetricsFamilies); i++) {
+        openMetricsWriteFamily(&writer, &gOpenMetricsFamilies[i], &snapshots);
+    }
+    openMetricsWriteLatency(&writer, &snapshots);
+    openMetricsWrite(&writer, "# EOF\n");
+
+    if (pBuffer == NULL) {
+        // Room for the terminating NULL
+        *pBufferSize = writer.length + 1;
+    } else {
+        CHK(writer.length < *pBufferSize, STATUS_BUFFER_TOO_SMALL);
+        *pBufferSize = writer.length;
+    }
+
+CleanUp:
+
+    freeOpenMetricsSnapshots(&snapshots);
+
+    LEAVES();
+    return retStatus;
+}
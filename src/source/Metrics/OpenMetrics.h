@@ -0,0 +1,58 @@
+/*******************************************
+OpenMetrics exporter internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_OPEN_METRICS__
+#define __KINESIS_VIDEO_WEBRTC_OPEN_METRICS__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Labels of a sample, the track id alone can take 255 characters before escaping
+#define OPEN_METRICS_MAX_LABELS_LEN 1024
+
+#define OPEN_METRICS_NAME_PREFIX "kvs_webrtc_"
+
+/*
+ * What a signaling client exports. Signaling lives in its own library, which takes these snapshots of its clients for the
+ * exporter. The exporter makes the labels out of the id, channel and role.
+ */
+typedef struct {
+    CHAR labels[OPEN_METRICS_MAX_LABELS_LEN + 1];
+    UINT64 id;
+    CHAR channel[MAX_ARN_LEN + 1];
+    SIGNALING_CHANNEL_ROLE_TYPE role;
+    SignalingClientMetrics signalingClientMetrics;
+    LatencyMetrics latencyMetrics;
+} SignalingClientMetricsSnapshot, *PSignalingClientMetricsSnapshot;
+
+typedef struct {
+    CHAR labels[OPEN_METRICS_MAX_LABELS_LEN + 1];
+    PeerConnectionMetrics peerConnectionMetrics;
+    KvsIceAgentMetrics iceAgentMetrics;
+    RtcIceCandidatePairStats selectedPairStats;
+    LatencyMetrics latencyMetrics;
+} PeerConnectionMetricsSnapshot, *PPeerConnectionMetricsSnapshot;
+
+typedef struct {
+    CHAR labels[OPEN_METRICS_MAX_LABELS_LEN + 1];
+    RtcOutboundRtpStreamStats outboundStats;
+    RtcInboundRtpStreamStats inboundStats;
+} TransceiverMetricsSnapshot, *PTransceiverMetricsSnapshot;
+
+STATUS metricsRegistryAddPeerConnection(PKvsPeerConnection);
+STATUS metricsRegistryRemovePeerConnection(PKvsPeerConnection);
+STATUS deinitMetricsRegistry(VOID);
+
+/**
+ * Writes the value of a label between quotes, escaping the backslashes, quotes and line feeds. Fails with
+ * STATUS_BUFFER_TOO_SMALL rather than cut the value short.
+ */
+STATUS openMetricsEscapeLabelValue(PCHAR, PCHAR, UINT32);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_OPEN_METRICS__ */
@@ -0,0 +1,200 @@
+/**
+ * Kinesis WebRTC packet path tracer
+ */
+#define LOG_CLASS "Tracer"
+#include "../Include_i.h"
+
+#define TRACER_JSON_HEADER "{\"traceEvents\":["
+#define TRACER_JSON_FOOTER "],\"displayTimeUnit\":\"ms\"}\n"
+
+// Indexed by TRACE_POINT
+static PCHAR gTracePointNames[] = {
+    "packet_ingress", "receive_dequeue", "srtp_decrypt", "jitter_push", "frame_ready", "write_frame", "srtp_encrypt", "socket_send",
+};
+
+static PCHAR gTracePointArgNames[] = {
+    "bytes", "bytes", "bytes", "sequence_number", "bytes", "bytes", "bytes", "bytes",
+};
+
+// Rings of the threads which recorded so far, a thread claims a slot the first time it records
+static volatile SIZE_T gTracerRings[TRACER_MAX_RING_COUNT];
+static volatile SIZE_T gTracerRingCount = 0;
+
+// Bumped by deinitTracer so threads don't keep using the ring they had before
+static volatile SIZE_T gTracerGeneration = 1;
+
+#ifdef ENABLE_TRACING
+#if defined _MSC_VER
+#define TRACER_THREAD_LOCAL __declspec(thread)
+#else
+#define TRACER_THREAD_LOCAL __thread
+#endif
+
+static TRACER_THREAD_LOCAL PTraceRing gThreadTraceRing = NULL;
+static TRACER_THREAD_LOCAL SIZE_T gThreadTraceRingGeneration = 0;
+
+static PTraceRing tracerGetThreadRing(VOID)
+{
+    SIZE_T generation = ATOMIC_LOAD(&gTracerGeneration), index;
+    PTraceRing pTraceRing = NULL;
+
+    if (gThreadTraceRingGeneration == generation) {
+        return gThreadTraceRing;
+    }
+
+    // A thread which finds no free slot doesn't try again until the next generation
+    gThreadTraceRingGeneration = generation;
+    gThreadTraceRing = NULL;
+
+    index = ATOMIC_INCREMENT(&gTracerRingCount);
+    if (index < TRACER_MAX_RING_COUNT && NULL != (pTraceRing = (PTraceRing) MEMCALLOC(1, SIZEOF(TraceRing)))) {
+        pTraceRing->threadId = (UINT64) GETTID();
+        ATOMIC_STORE(&gTracerRings[index], (SIZE_T) pTraceRing);
+        gThreadTraceRing = pTraceRing;
+    }
+
+    return pTraceRing;
+}
+#endif
+
+VOID tracerRecord(TRACE_POINT point, UINT64 timestamp, UINT64 duration, UINT64 arg)
+{
+#ifdef ENABLE_TRACING
+    PTraceRing pTraceRing = tracerGetThreadRing();
+    PTraceEvent pTraceEvent;
+    SIZE_T head;
+
+    if (pTraceRing == NULL) {
+        return;
+    }
+
+    head = ATOMIC_LOAD(&pTraceRing->head);
+    pTraceEvent = &pTraceRing->events[head % TRACER_RING_EVENT_COUNT];
+    ATOMIC_STORE(&pTraceEvent->sequence, 0);
+    pTraceEvent->timestamp = timestamp;
+    pTraceEvent->duration = duration;
+    pTraceEvent->arg = arg;
+    pTraceEvent->point = point;
+    ATOMIC_STORE(&pTraceEvent->sequence, head + 1);
+    ATOMIC_STORE(&pTraceRing->head, head + 1);
+#else
+    UNUSED_PARAM(point);
+    UNUSED_PARAM(timestamp);
+    UNUSED_PARAM(duration);
+    UNUSED_PARAM(arg);
+#endif
+}
+
+STATUS deinitTracer(VOID)
+{
+    PTraceRing pTraceRing;
+    SIZE_T count, i;
+
+    ATOMIC_INCREMENT(&gTracerGeneration);
+    count = MIN(ATOMIC_EXCHANGE(&gTracerRingCount, 0), TRACER_MAX_RING_COUNT);
+    for (i = 0; i < count; i++) {
+        pTraceRing = (PTraceRing) ATOMIC_EXCHANGE(&gTracerRings[i], (SIZE_T) NULL);
+        SAFE_MEMFREE(pTraceRing);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+// Copies the event, returns FALSE if it was overwritten or being written meanwhile
+static BOOL tracerReadEvent(PTraceRing pTraceRing, SIZE_T index, PTraceEvent pTraceEvent)
+{
+    PTraceEvent pRingEvent = &pTraceRing->events[index % TRACER_RING_EVENT_COUNT];
+    SIZE_T sequence = ATOMIC_LOAD(&pRingEvent->sequence);
+
+    pTraceEvent->timestamp = pRingEvent->timestamp;
+    pTraceEvent->duration = pRingEvent->duration;
+    pTraceEvent->arg = pRingEvent->arg;
+    pTraceEvent->point = pRingEvent->point;
+
+    return sequence == index + 1 && ATOMIC_LOAD(&pRingEvent->sequence) == sequence && pTraceEvent->point < TRACE_POINT_COUNT;
+}
+
+static UINT32 tracerFormatEvent(PTraceEvent pTraceEvent, UINT64 threadId, BOOL first, PCHAR pBuffer, UINT32 bufferSize)
+{
+    INT32 length;
+
+    // Timestamps of Chrome trace events are in microseconds
+    if (pTraceEvent->duration == 0) {
+        length = SNPRINTF(pBuffer, bufferSize,
+                          "%s{\"name\":\"%s\",\"cat\":\"kvs\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.1f,\"pid\":1,\"tid\":%" PRIu64
+                          ",\"args\":{\"%s\":%" PRIu64 "}}",
+                          first ? "" : ",", gTracePointNames[pTraceEvent->point],
+                          (DOUBLE) pTraceEvent->timestamp / HUNDREDS_OF_NANOS_IN_A_MICROSECOND, threadId,
+                          gTracePointArgNames[pTraceEvent->point], pTraceEvent->arg);
+    } else {
+        length = SNPRINTF(pBuffer, bufferSize,
+                          "%s{\"name\":\"%s\",\"cat\":\"kvs\",\"ph\":\"X\",\"ts\":%.1f,\"dur\":%.1f,\"pid\":1,\"tid\":%" PRIu64
+                          ",\"args\":{\"%s\":%" PRIu64 "}}",
+                          first ? "" : ",", gTracePointNames[pTraceEvent->point],
+                          (DOUBLE) pTraceEvent->timestamp / HUNDREDS_OF_NANOS_IN_A_MICROSECOND,
+                          (DOUBLE) pTraceEvent->duration / HUNDREDS_OF_NANOS_IN_A_MICROSECOND, threadId, gTracePointArgNames[pTraceEvent->point],
+                          pTraceEvent->arg);
+    }
+
+    return length > 0 ? (UINT32) MIN((UINT32) length, bufferSize - 1) : 0;
+}
+
+STATUS dumpTraceEvents(PCHAR pBuffer, PUINT32 pBufferSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    CHAR eventJson[TRACER_MAX_EVENT_JSON_LEN];
+    TraceEvent traceEvent;
+    PTraceRing pTraceRing;
+    SIZE_T ringCount, ring, index, head;
+    UINT32 length, eventLength;
+    BOOL first = TRUE, full = FALSE;
+
+    CHK(pBufferSize != NULL, STATUS_NULL_ARG);
+    CHK(pBuffer == NULL || *pBufferSize > STRLEN(TRACER_JSON_HEADER TRACER_JSON_FOOTER), STATUS_BUFFER_TOO_SMALL);
+
+    length = (UINT32) STRLEN(TRACER_JSON_HEADER);
+    if (pBuffer != NULL) {
+        MEMCPY(pBuffer, TRACER_JSON_HEADER, length);
+    }
+
+    ringCount = MIN(ATOMIC_LOAD(&gTracerRingCount), TRACER_MAX_RING_COUNT);
+    for (ring = 0; ring < ringCount && !full; ring++) {
+        // The slot is claimed before the ring is stored
+        if (NULL == (pTraceRing = (PTraceRing) ATOMIC_LOAD(&gTracerRings[ring]))) {
+            continue;
+        }
+
+        head = ATOMIC_LOAD(&pTraceRing->head);
+        for (index = head > TRACER_RING_EVENT_COUNT ? head - TRACER_RING_EVENT_COUNT : 0; index < head; index++) {
+            if (!tracerReadEvent(pTraceRing, index, &traceEvent)) {
+                continue;
+            }
+
+            eventLength = tracerFormatEvent(&traceEvent, pTraceRing->threadId, first, eventJson, ARRAY_SIZE(eventJson));
+            if (pBuffer != NULL) {
+                // Events that don't fit are left out so that the output stays valid JSON
+                if (length + eventLength + STRLEN(TRACER_JSON_FOOTER) >= *pBufferSize) {
+                    full = TRUE;
+                    break;
+                }
+                MEMCPY(pBuffer + length, eventJson, eventLength);
+            }
+            length += eventLength;
+            first = FALSE;
+        }
+    }
+
+    if (pBuffer != NULL) {
+        STRCPY(pBuffer + length, TRACER_JSON_FOOTER);
+    }
+    length += (UINT32) STRLEN(TRACER_JSON_FOOTER);
+
+    // Room for the terminating NULL when only the size is queried
+    *pBufferSize = pBuffer == NULL ? length + 1 : length;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
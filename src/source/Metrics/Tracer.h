@@ -0,0 +1,72 @@
+/*******************************************
+Packet path tracer internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_TRACER__
+#define __KINESIS_VIDEO_WEBRTC_TRACER__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Events kept per thread, older ones are overwritten
+#define TRACER_RING_EVENT_COUNT 2048
+
+// Threads beyond this many don't record, it bounds the memory of thread pools whose threads come and go
+#define TRACER_MAX_RING_COUNT 64
+
+// Chrome trace events are written one at a time, none is longer than this
+#define TRACER_MAX_EVENT_JSON_LEN 256
+
+typedef enum {
+    TRACE_POINT_PACKET_INGRESS,  //!< A packet was read from the socket, the arg is its length
+    TRACE_POINT_RECEIVE_DEQUEUE, //!< A media worker took a packet off the receive pipeline, the arg is its length
+    TRACE_POINT_SRTP_DECRYPT,    //!< A received packet was decrypted, the arg is its length
+    TRACE_POINT_JITTER_PUSH,     //!< A packet was pushed in the jitter buffer, the arg is its sequence number
+    TRACE_POINT_FRAME_READY,     //!< From the first packet of a frame arriving until it was handed out, the arg is the frame size
+    TRACE_POINT_WRITE_FRAME,     //!< writeFrame from start to end, the arg is the frame size
+    TRACE_POINT_SRTP_ENCRYPT,    //!< A sent packet was encrypted, the arg is its length
+    TRACE_POINT_SOCKET_SEND,     //!< A packet was written to the socket, the arg is the bytes written
+    TRACE_POINT_COUNT,
+} TRACE_POINT;
+
+/*
+ * The sequence is the index of the event plus one once it is completely written and zero while it is being written,
+ * the dump only keeps the events whose sequence didn't change while it copied them.
+ */
+typedef struct {
+    volatile SIZE_T sequence;
+    UINT64 timestamp;
+    UINT64 duration;
+    UINT64 arg;
+    TRACE_POINT point;
+} TraceEvent, *PTraceEvent;
+
+/*
+ * Events of one thread. The thread is the only writer so recording needs no lock, the dump reads it concurrently.
+ */
+typedef struct {
+    volatile SIZE_T head;
+    UINT64 threadId;
+    TraceEvent events[TRACER_RING_EVENT_COUNT];
+} TraceRing, *PTraceRing;
+
+#ifdef ENABLE_TRACING
+// Instant event
+#define TRACE_INSTANT(point, arg) tracerRecord((point), GETTIME(), 0, (UINT64) (arg))
+// Event which lasted from startTime until endTime, trace points reuse the times the latency stats already take
+#define TRACE_COMPLETE(point, startTime, endTime, arg) tracerRecord((point), (startTime), (endTime) - (startTime), (UINT64) (arg))
+#else
+// Arguments are not evaluated when tracing is compiled out
+#define TRACE_INSTANT(point, arg)
+#define TRACE_COMPLETE(point, startTime, endTime, arg)
+#endif
+
+VOID tracerRecord(TRACE_POINT, UINT64, UINT64, UINT64);
+STATUS deinitTracer(VOID);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_TRACER__ */
@@ -15,12 +15,11 @@ STATUS createDataChannel(PRtcPeerConnection pPeerConnection, PCHAR pDataChannelN
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pPeerConnection;
     UINT32 channelId = 0;
     PKvsDataChannel pKvsDataChannel = NULL;
+    PSctpSession pSctpSession = NULL;
+    BOOL locked = FALSE, inserted = FALSE, contained = TRUE;
 
     CHK(pKvsPeerConnection != NULL && pDataChannelName != NULL && ppRtcDataChannel != NULL, STATUS_NULL_ARG);
 
-    // Only support creating DataChannels before signaling for now
-    CHK(pKvsPeerConnection->pSctpSession == NULL, STATUS_INTERNAL_ERROR);
-
     CHK((pKvsDataChannel = (PKvsDataChannel) MEMCALLOC(1, SIZEOF(KvsDataChannel))) != NULL, STATUS_NOT_ENOUGH_MEMORY);
     STRNCPY(pKvsDataChannel->dataChannel.name, pDataChannelName, MAX_DATA_CHANNEL_NAME_LEN);
     pKvsDataChannel->pRtcPeerConnection = (PRtcPeerConnection) pKvsPeerConnection;
@@ -36,20 +35,60 @@ STATUS createDataChannel(PRtcPeerConnection pPeerConnection, PCHAR pDataChannelN
     }
     STRNCPY(pKvsDataChannel->rtcDataChannelDiagnostics.label, pKvsDataChannel->dataChannel.name, STRLEN(pKvsDataChannel->dataChannel.name));
     pKvsDataChannel->rtcDataChannelDiagnostics.state = RTC_DATA_CHANNEL_STATE_CONNECTING;
-    CHK_STATUS(hashTableGetCount(pKvsPeerConnection->pDataChannels, &channelId));
-    pKvsDataChannel->rtcDataChannelDiagnostics.dataChannelIdentifier = channelId;
-    pKvsDataChannel->dataChannel.id = channelId;
     STRNCPY(pKvsDataChannel->rtcDataChannelDiagnostics.protocol, DATA_CHANNEL_PROTOCOL_STR,
             ARRAY_SIZE(pKvsDataChannel->rtcDataChannelDiagnostics.protocol));
+
+    MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = TRUE;
+
+    pSctpSession = pKvsPeerConnection->pSctpSession;
+    if (pSctpSession == NULL) {
+        // Temporary id, the stream id is assigned once the DTLS role is known
+        CHK_STATUS(hashTableGetCount(pKvsPeerConnection->pDataChannels, &channelId));
+    } else {
+        // https://www.rfc-editor.org/rfc/rfc8832#section-6, the DTLS client uses even stream ids and the server odd ones
+        for (channelId = pKvsPeerConnection->dtlsIsServer ? 1 : 0; channelId < SCTP_MAX_STREAM_COUNT; channelId += 2) {
+            CHK_STATUS(hashTableContains(pKvsPeerConnection->pDataChannels, channelId, &contained));
+            if (!contained) {
+                break;
+            }
+        }
+        CHK(!contained, STATUS_SCTP_NO_FREE_STREAM);
+        pKvsDataChannel->channelId = channelId;
+    }
+
+    pKvsDataChannel->rtcDataChannelDiagnostics.dataChannelIdentifier = channelId;
+    pKvsDataChannel->dataChannel.id = channelId;
     CHK_STATUS(hashTablePut(pKvsPeerConnection->pDataChannels, channelId, (UINT64) pKvsDataChannel));
+    inserted = TRUE;
+
+    MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = FALSE;
+
+    // On the established association the channel opens once the remote peer acknowledges the DATA_CHANNEL_OPEN
+    if (pSctpSession != NULL) {
+        CHK_STATUS(sctpSessionWriteDcep(pSctpSession, channelId, pKvsDataChannel->dataChannel.name, STRLEN(pKvsDataChannel->dataChannel.name),
+                                        &pKvsDataChannel->rtcDataChannelInit));
+    }
 
 CleanUp:
     if (STATUS_SUCCEEDED(retStatus)) {
         *ppRtcDataChannel = (PRtcDataChannel) pKvsDataChannel;
     } else {
+        if (inserted) {
+            if (!locked) {
+                MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
+                locked = TRUE;
+            }
+            CHK_LOG_ERR(hashTableRemove(pKvsPeerConnection->pDataChannels, channelId));
+        }
         SAFE_MEMFREE(pKvsDataChannel);
     }
 
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    }
+
     LEAVES();
     return retStatus;
 }
@@ -59,12 +98,28 @@ STATUS dataChannelSend(PRtcDataChannel pRtcDataChannel, BOOL isBinary, PBYTE pMe
     STATUS retStatus = STATUS_SUCCESS;
     PSctpSession pSctpSession = NULL;
     PKvsDataChannel pKvsDataChannel = (PKvsDataChannel) pRtcDataChannel;
+    UINT64 bufferedAmount;
 
     CHK(pKvsDataChannel != NULL && pMessage != NULL, STATUS_NULL_ARG);
+    CHK(pKvsDataChannel->rtcDataChannelDiagnostics.state != RTC_DATA_CHANNEL_STATE_CLOSING &&
+            pKvsDataChannel->rtcDataChannelDiagnostics.state != RTC_DATA_CHANNEL_STATE_CLOSED,
+        STATUS_SCTP_DATA_CHANNEL_CLOSED);
 
     pSctpSession = ((PKvsPeerConnection) pKvsDataChannel->pRtcPeerConnection)->pSctpSession;
 
-    CHK_STATUS(sctpSessionWriteMessage(pSctpSession, pKvsDataChannel->channelId, isBinary, pMessage, pMessageLen));
+    // A message larger than the limit still goes out when nothing else is buffered
+    bufferedAmount = (UINT64) ATOMIC_LOAD(&pKvsDataChannel->bufferedAmount);
+    CHK(!pKvsDataChannel->nonBlocking || bufferedAmount == 0 || bufferedAmount + pMessageLen <= MAX_DATA_CHANNEL_BUFFERED_AMOUNT,
+        STATUS_SCTP_SEND_WOULD_BLOCK);
+
+    // Accounted before the write as the acknowledgement can arrive before it returns
+    ATOMIC_ADD(&pKvsDataChannel->bufferedAmount, (SIZE_T) pMessageLen);
+    retStatus = sctpSessionWriteMessage(pSctpSession, pKvsDataChannel->channelId, isBinary, &pKvsDataChannel->rtcDataChannelInit, pMessage,
+                                        pMessageLen);
+    if (STATUS_FAILED(retStatus)) {
+        ATOMIC_SUBTRACT(&pKvsDataChannel->bufferedAmount, (SIZE_T) pMessageLen);
+        CHK(FALSE, retStatus);
+    }
     pKvsDataChannel->rtcDataChannelDiagnostics.messagesSent++;
     pKvsDataChannel->rtcDataChannelDiagnostics.bytesSent += pMessageLen;
 CleanUp:
@@ -89,16 +144,175 @@ CleanUp:
     return retStatus;
 }
 
+STATUS dataChannelOnOwnedMessage(PRtcDataChannel pRtcDataChannel, UINT64 customData, RtcOnOwnedMessage rtcOnOwnedMessage)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsDataChannel pKvsDataChannel = (PKvsDataChannel) pRtcDataChannel;
+
+    CHK(pKvsDataChannel != NULL && rtcOnOwnedMessage != NULL, STATUS_NULL_ARG);
+
+    pKvsDataChannel->onOwnedMessageCustomData = customData;
+    pKvsDataChannel->onOwnedMessage = rtcOnOwnedMessage;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+VOID dataChannelFreeMessage(PBYTE pMessage)
+{
+    /*
+     * The message is allocated in the sctp library using default allocator
+     * so we need to use the default free API.
+     */
+    if (pMessage != NULL) {
+        free(pMessage);
+    }
+}
+
 STATUS dataChannelOnOpen(PRtcDataChannel pRtcDataChannel, UINT64 customData, RtcOnOpen rtcOnOpen)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PKvsDataChannel pKvsDataChannel = (PKvsDataChannel) pRtcDataChannel;
+    PKvsPeerConnection pKvsPeerConnection;
+    BOOL open;
 
     CHK(pKvsDataChannel != NULL && rtcOnOpen != NULL, STATUS_NULL_ARG);
 
+    // Under the lock the channel opens either before, and the callback is fired here, or after with the callback set
+    pKvsPeerConnection = (PKvsPeerConnection) pKvsDataChannel->pRtcPeerConnection;
+    MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
     pKvsDataChannel->onOpen = rtcOnOpen;
     pKvsDataChannel->onOpenCustomData = customData;
+    open = pKvsDataChannel->rtcDataChannelDiagnostics.state == RTC_DATA_CHANNEL_STATE_OPEN;
+    MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+
+    if (open) {
+        rtcOnOpen(customData, pRtcDataChannel);
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS dataChannelOnClose(PRtcDataChannel pRtcDataChannel, UINT64 customData, RtcOnClose rtcOnClose)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsDataChannel pKvsDataChannel = (PKvsDataChannel) pRtcDataChannel;
+
+    CHK(pKvsDataChannel != NULL && rtcOnClose != NULL, STATUS_NULL_ARG);
+
+    pKvsDataChannel->onClose = rtcOnClose;
+    pKvsDataChannel->onCloseCustomData = customData;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS dataChannelClose(PRtcDataChannel pRtcDataChannel)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsDataChannel pKvsDataChannel = (PKvsDataChannel) pRtcDataChannel;
+    PKvsPeerConnection pKvsPeerConnection = NULL;
+    BOOL locked = FALSE;
+
+    CHK(pKvsDataChannel != NULL, STATUS_NULL_ARG);
+
+    pKvsPeerConnection = (PKvsPeerConnection) pKvsDataChannel->pRtcPeerConnection;
+    CHK(pKvsPeerConnection->pSctpSession != NULL, STATUS_INVALID_OPERATION);
+
+    MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = TRUE;
+
+    // Closing is in progress already
+    CHK(pKvsDataChannel->rtcDataChannelDiagnostics.state != RTC_DATA_CHANNEL_STATE_CLOSING &&
+            pKvsDataChannel->rtcDataChannelDiagnostics.state != RTC_DATA_CHANNEL_STATE_CLOSED,
+        retStatus);
+    pKvsDataChannel->rtcDataChannelDiagnostics.state = RTC_DATA_CHANNEL_STATE_CLOSING;
+
+    MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = FALSE;
+
+    // The channel is closed once the remote peer resets its outgoing stream in turn
+    CHK_STATUS(sctpSessionResetStream(pKvsPeerConnection->pSctpSession, pKvsDataChannel->channelId));
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS dataChannelOnBufferedAmountLow(PRtcDataChannel pRtcDataChannel, UINT64 customData, RtcOnBufferedAmountLow rtcOnBufferedAmountLow)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsDataChannel pKvsDataChannel = (PKvsDataChannel) pRtcDataChannel;
+
+    CHK(pKvsDataChannel != NULL && rtcOnBufferedAmountLow != NULL, STATUS_NULL_ARG);
+
+    pKvsDataChannel->onBufferedAmountLow = rtcOnBufferedAmountLow;
+    pKvsDataChannel->onBufferedAmountLowCustomData = customData;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS dataChannelSetBufferedAmountLowThreshold(PRtcDataChannel pRtcDataChannel, UINT64 threshold)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsDataChannel pKvsDataChannel = (PKvsDataChannel) pRtcDataChannel;
+
+    CHK(pKvsDataChannel != NULL, STATUS_NULL_ARG);
+
+    pKvsDataChannel->bufferedAmountLowThreshold = threshold;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS dataChannelGetBufferedAmount(PRtcDataChannel pRtcDataChannel, PUINT64 pBufferedAmount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsDataChannel pKvsDataChannel = (PKvsDataChannel) pRtcDataChannel;
+
+    CHK(pKvsDataChannel != NULL && pBufferedAmount != NULL, STATUS_NULL_ARG);
+
+    *pBufferedAmount = (UINT64) ATOMIC_LOAD(&pKvsDataChannel->bufferedAmount);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS dataChannelSetNonBlocking(PRtcDataChannel pRtcDataChannel, BOOL nonBlocking)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsDataChannel pKvsDataChannel = (PKvsDataChannel) pRtcDataChannel;
+
+    CHK(pKvsDataChannel != NULL, STATUS_NULL_ARG);
+
+    pKvsDataChannel->nonBlocking = nonBlocking;
 
 CleanUp:
 
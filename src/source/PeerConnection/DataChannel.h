@@ -20,10 +20,22 @@ typedef struct {
     UINT32 channelId;
     UINT64 onMessageCustomData;
     RtcOnMessage onMessage;
+    UINT64 onOwnedMessageCustomData;
+    RtcOnOwnedMessage onOwnedMessage;
     RtcDataChannelStats rtcDataChannelDiagnostics;
 
     UINT64 onOpenCustomData;
     RtcOnOpen onOpen;
+
+    UINT64 onCloseCustomData;
+    RtcOnClose onClose;
+
+    // Bytes sent on the channel that are still in the SCTP send buffer
+    volatile SIZE_T bufferedAmount;
+    UINT64 bufferedAmountLowThreshold;
+    UINT64 onBufferedAmountLowCustomData;
+    RtcOnBufferedAmountLow onBufferedAmountLow;
+    BOOL nonBlocking;
 } KvsDataChannel, *PKvsDataChannel;
 
 #ifdef __cplusplus
@@ -0,0 +1,609 @@
+#define LOG_CLASS "FlexFec"
+
+#include "../Include_i.h"
+
+#define FLEXFEC_MASK_BIT_SET(mask, i) (((mask)[(i) / 64] >> ((i) % 64)) & 1)
+
+static VOID flexFecXorBytes(PBYTE pDst, PBYTE pSrc, UINT32 length)
+{
+    UINT32 i;
+
+    for (i = 0; i < length; i++) {
+        pDst[i] ^= pSrc[i];
+    }
+}
+
+static STATUS flexFecReserveRepairPayload(PFlexFecRepairState pRepairState, UINT32 length)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE pNewPayload = NULL;
+
+    if (length > pRepairState->payloadCapacity) {
+        CHK(NULL != (pNewPayload = (PBYTE) MEMREALLOC(pRepairState->pPayload, length)), STATUS_NOT_ENOUGH_MEMORY);
+        pRepairState->pPayload = pNewPayload;
+        pRepairState->payloadCapacity = length;
+    }
+
+CleanUp:
+    return retStatus;
+}
+
+// The protection operation of https://www.rfc-editor.org/rfc/rfc8627#section-6.2, applied to one source packet
+static STATUS flexFecProtect(PFlexFecRepairState pRepairState, PBYTE pRawPacket, UINT32 rawPacketLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 length = rawPacketLength - MIN_HEADER_LENGTH;
+
+    CHK_STATUS(flexFecReserveRepairPayload(pRepairState, length));
+    // Shorter packets are padded with zeros
+    if (length > pRepairState->payloadLength) {
+        MEMSET(pRepairState->pPayload + pRepairState->payloadLength, 0x00, length - pRepairState->payloadLength);
+        pRepairState->payloadLength = length;
+    }
+
+    pRepairState->flags ^= pRawPacket[0];
+    pRepairState->markerPayloadType ^= pRawPacket[1];
+    pRepairState->lengthRecovery ^= (UINT16) length;
+    pRepairState->timestampRecovery ^= (UINT32) getUnalignedInt32BigEndian(pRawPacket + TIMESTAMP_OFFSET);
+    flexFecXorBytes(pRepairState->pPayload, pRawPacket + MIN_HEADER_LENGTH, length);
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS createFlexFecEncoder(UINT32 protectedSsrc, UINT32 ssrc, UINT8 payloadType, PFlexFecEncoder* ppFlexFecEncoder)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFlexFecEncoder pFlexFecEncoder = NULL;
+
+    CHK(ppFlexFecEncoder != NULL, STATUS_NULL_ARG);
+    CHK(NULL != (pFlexFecEncoder = (PFlexFecEncoder) MEMCALLOC(1, SIZEOF(FlexFecEncoder))), STATUS_NOT_ENOUGH_MEMORY);
+
+    pFlexFecEncoder->protectedSsrc = protectedSsrc;
+    pFlexFecEncoder->ssrc = ssrc;
+    pFlexFecEncoder->payloadType = payloadType;
+    // The repair stream is an RTP stream of its own, https://tools.ietf.org/html/rfc3550#section-5.1
+    pFlexFecEncoder->sequenceNumber = (UINT16) RAND();
+    ATOMIC_STORE(&pFlexFecEncoder->repairRate, 0);
+
+CleanUp:
+    if (STATUS_FAILED(retStatus)) {
+        freeFlexFecEncoder(&pFlexFecEncoder);
+    }
+
+    if (ppFlexFecEncoder != NULL) {
+        *ppFlexFecEncoder = pFlexFecEncoder;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeFlexFecEncoder(PFlexFecEncoder* ppFlexFecEncoder)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFlexFecEncoder pFlexFecEncoder = NULL;
+    UINT32 i;
+
+    CHK(ppFlexFecEncoder != NULL, STATUS_NULL_ARG);
+    pFlexFecEncoder = *ppFlexFecEncoder;
+    CHK(pFlexFecEncoder != NULL, retStatus);
+
+    for (i = 0; i < pFlexFecEncoder->maxRepairStates; i++) {
+        SAFE_MEMFREE(pFlexFecEncoder->pRepairStates[i].pPayload);
+    }
+    SAFE_MEMFREE(pFlexFecEncoder->pRepairStates);
+    SAFE_MEMFREE(*ppFlexFecEncoder);
+
+CleanUp:
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS flexFecEncoderUpdateLoss(PFlexFecEncoder pFlexFecEncoder, DOUBLE lossRate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    DOUBLE repairRate = 0.0;
+
+    CHK(pFlexFecEncoder != NULL, STATUS_NULL_ARG);
+    CHK(lossRate >= 0.0 && lossRate <= 1.0, STATUS_INVALID_ARG);
+
+    pFlexFecEncoder->smoothedLossRate =
+        FLEXFEC_LOSS_SMOOTHING_FACTOR * lossRate + (1.0 - FLEXFEC_LOSS_SMOOTHING_FACTOR) * pFlexFecEncoder->smoothedLossRate;
+    if (pFlexFecEncoder->smoothedLossRate >= FLEXFEC_MIN_LOSS_RATE) {
+        repairRate = MIN(pFlexFecEncoder->smoothedLossRate * FLEXFEC_LOSS_PROTECTION_MULTIPLIER, FLEXFEC_MAX_REPAIR_RATE);
+    }
+    ATOMIC_STORE(&pFlexFecEncoder->repairRate, (SIZE_T) (repairRate * FLEXFEC_REPAIR_RATE_SCALE));
+
+CleanUp:
+    return retStatus;
+}
+
+// Repair packets protecting a block of packets, at least one as long as the repair rate is not 0
+static UINT32 flexFecBlockRepairPacketCount(UINT32 blockPacketCount, UINT32 repairRate)
+{
+    UINT32 repairPacketCount = (blockPacketCount * repairRate + FLEXFEC_REPAIR_RATE_SCALE - 1) / FLEXFEC_REPAIR_RATE_SCALE;
+
+    return MIN(repairPacketCount, blockPacketCount);
+}
+
+STATUS flexFecEncoderStartFrame(PFlexFecEncoder pFlexFecEncoder, UINT32 packetCount, UINT32 timestamp)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, repairRate, repairPacketCount, fullBlockCount;
+    PFlexFecRepairState pNewRepairStates = NULL;
+
+    CHK(pFlexFecEncoder != NULL, STATUS_NULL_ARG);
+
+    repairRate = (UINT32) ATOMIC_LOAD(&pFlexFecEncoder->repairRate);
+    fullBlockCount = packetCount / FLEXFEC_MAX_BLOCK_SIZE;
+    repairPacketCount = fullBlockCount * flexFecBlockRepairPacketCount(FLEXFEC_MAX_BLOCK_SIZE, repairRate) +
+        flexFecBlockRepairPacketCount(packetCount % FLEXFEC_MAX_BLOCK_SIZE, repairRate);
+
+    if (repairPacketCount > pFlexFecEncoder->maxRepairStates) {
+        pNewRepairStates = (PFlexFecRepairState) MEMREALLOC(pFlexFecEncoder->pRepairStates, repairPacketCount * SIZEOF(FlexFecRepairState));
+        CHK(pNewRepairStates != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        MEMSET(pNewRepairStates + pFlexFecEncoder->maxRepairStates, 0x00,
+               (repairPacketCount - pFlexFecEncoder->maxRepairStates) * SIZEOF(FlexFecRepairState));
+        pFlexFecEncoder->pRepairStates = pNewRepairStates;
+        pFlexFecEncoder->maxRepairStates = repairPacketCount;
+    }
+
+    // Payload buffers are kept, everything else starts from zero
+    for (i = 0; i < repairPacketCount; i++) {
+        pFlexFecEncoder->pRepairStates[i].flags = 0;
+        pFlexFecEncoder->pRepairStates[i].markerPayloadType = 0;
+        pFlexFecEncoder->pRepairStates[i].lengthRecovery = 0;
+        pFlexFecEncoder->pRepairStates[i].timestampRecovery = 0;
+        pFlexFecEncoder->pRepairStates[i].mask[0] = 0;
+        pFlexFecEncoder->pRepairStates[i].mask[1] = 0;
+        pFlexFecEncoder->pRepairStates[i].payloadLength = 0;
+    }
+
+    pFlexFecEncoder->frameRepairRate = repairRate;
+    pFlexFecEncoder->timestamp = timestamp;
+    pFlexFecEncoder->framePacketCount = packetCount;
+    pFlexFecEncoder->protectedPacketCount = 0;
+    pFlexFecEncoder->repairPacketCount = repairPacketCount;
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+STATUS flexFecEncoderProtectPacket(PFlexFecEncoder pFlexFecEncoder, PBYTE pRawPacket, UINT32 rawPacketLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 block, blockIndex, blockPacketCount, blockRepairPacketCount, fullBlockRepairPacketCount, repairRate, maskIndex;
+    UINT16 sequenceNumber;
+    PFlexFecRepairState pRepairState;
+
+    CHK(pFlexFecEncoder != NULL && pRawPacket != NULL, STATUS_NULL_ARG);
+    CHK(rawPacketLength >= MIN_HEADER_LENGTH, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+    CHK(pFlexFecEncoder->protectedPacketCount < pFlexFecEncoder->framePacketCount, STATUS_INVALID_OPERATION);
+    block = pFlexFecEncoder->protectedPacketCount / FLEXFEC_MAX_BLOCK_SIZE;
+    blockIndex = pFlexFecEncoder->protectedPacketCount % FLEXFEC_MAX_BLOCK_SIZE;
+    pFlexFecEncoder->protectedPacketCount++;
+    CHK(pFlexFecEncoder->repairPacketCount > 0, STATUS_SUCCESS);
+
+    // Packets of a block are spread over its repair packets in turn, so a burst loses at most one packet per repair packet
+    repairRate = pFlexFecEncoder->frameRepairRate;
+    blockPacketCount = MIN(FLEXFEC_MAX_BLOCK_SIZE, pFlexFecEncoder->framePacketCount - block * FLEXFEC_MAX_BLOCK_SIZE);
+    fullBlockRepairPacketCount = flexFecBlockRepairPacketCount(FLEXFEC_MAX_BLOCK_SIZE, repairRate);
+    blockRepairPacketCount = flexFecBlockRepairPacketCount(blockPacketCount, repairRate);
+    CHK(blockRepairPacketCount > 0, STATUS_SUCCESS);
+    pRepairState = pFlexFecEncoder->pRepairStates + block * fullBlockRepairPacketCount + blockIndex % blockRepairPacketCount;
+
+    sequenceNumber = (UINT16) getUnalignedInt16BigEndian(pRawPacket + SEQ_NUMBER_OFFSET);
+    if (blockIndex < blockRepairPacketCount) {
+        pRepairState->sequenceNumberBase = sequenceNumber;
+    }
+    maskIndex = (UINT16) (sequenceNumber - pRepairState->sequenceNumberBase);
+    CHK(maskIndex < FLEXFEC_MASK_LONG_BITS, STATUS_INVALID_ARG);
+    pRepairState->mask[maskIndex / 64] |= ((UINT64) 1) << (maskIndex % 64);
+
+    CHK_STATUS(flexFecProtect(pRepairState, pRawPacket, rawPacketLength));
+
+CleanUp:
+    return retStatus;
+}
+
+// Writes the mask of a repair state and returns the number of bytes written
+static UINT32 flexFecWriteMask(PFlexFecRepairState pRepairState, PBYTE pBuffer)
+{
+    UINT32 i, highestBit = 0, bitOffset, maskSize;
+    BYTE mask[FLEXFEC_MASK_LONG_SIZE];
+
+    for (i = 0; i < FLEXFEC_MASK_LONG_BITS; i++) {
+        if (FLEXFEC_MASK_BIT_SET(pRepairState->mask, i)) {
+            highestBit = i;
+        }
+    }
+
+    if (highestBit < FLEXFEC_MASK_SHORT_BITS) {
+        maskSize = FLEXFEC_MASK_SHORT_SIZE;
+    } else if (highestBit < FLEXFEC_MASK_MEDIUM_BITS) {
+        maskSize = FLEXFEC_MASK_MEDIUM_SIZE;
+    } else {
+        maskSize = FLEXFEC_MASK_LONG_SIZE;
+    }
+
+    // Mask bits follow each other skipping the k bits at the start of the first two chunks
+    MEMSET(mask, 0x00, SIZEOF(mask));
+    for (i = 0; i < FLEXFEC_MASK_LONG_BITS; i++) {
+        if (FLEXFEC_MASK_BIT_SET(pRepairState->mask, i)) {
+            bitOffset = i < FLEXFEC_MASK_SHORT_BITS ? i + 1 : i + 2;
+            mask[bitOffset / 8] |= 0x80 >> (bitOffset % 8);
+        }
+    }
+    if (maskSize == FLEXFEC_MASK_SHORT_SIZE) {
+        mask[0] |= FLEXFEC_MASK_K;
+    } else if (maskSize == FLEXFEC_MASK_MEDIUM_SIZE) {
+        mask[FLEXFEC_MASK_SHORT_SIZE] |= FLEXFEC_MASK_K;
+    }
+
+    MEMCPY(pBuffer, mask, maskSize);
+    return maskSize;
+}
+
+STATUS flexFecEncoderFinishFrame(PFlexFecEncoder pFlexFecEncoder, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, length;
+    PBYTE pCurPtr;
+    PFlexFecRepairState pRepairState;
+
+    CHK(pFlexFecEncoder != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(pFlexFecEncoder->protectedPacketCount == pFlexFecEncoder->framePacketCount, STATUS_INVALID_OPERATION);
+
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+    for (i = 0; i < pFlexFecEncoder->repairPacketCount; i++) {
+        pRepairState = pFlexFecEncoder->pRepairStates + i;
+        CHK_STATUS(payloadArrayReserve(pPayloadArray, FLEXFEC_MAX_REPAIR_HEADER_SIZE + pRepairState->payloadLength, 1));
+        pCurPtr = pPayloadArray->payloadBuffer + pPayloadArray->payloadLength;
+
+        // RTP header with the protected SSRC as the only CSRC
+        *pCurPtr++ = (BYTE) ((2 << VERSION_SHIFT) | 1);
+        *pCurPtr++ = pFlexFecEncoder->payloadType;
+        putUnalignedInt16BigEndian(pCurPtr, pFlexFecEncoder->sequenceNumber);
+        pCurPtr += SIZEOF(UINT16);
+        putUnalignedInt32BigEndian(pCurPtr, pFlexFecEncoder->timestamp);
+        pCurPtr += SIZEOF(UINT32);
+        putUnalignedInt32BigEndian(pCurPtr, pFlexFecEncoder->ssrc);
+        pCurPtr += SIZEOF(UINT32);
+        putUnalignedInt32BigEndian(pCurPtr, pFlexFecEncoder->protectedSsrc);
+        pCurPtr += SIZEOF(UINT32);
+        pFlexFecEncoder->sequenceNumber++;
+
+        *pCurPtr++ = pRepairState->flags & FLEXFEC_HEADER_RECOVERY_MASK;
+        *pCurPtr++ = pRepairState->markerPayloadType;
+        putUnalignedInt16BigEndian(pCurPtr, pRepairState->lengthRecovery);
+        pCurPtr += SIZEOF(UINT16);
+        putUnalignedInt32BigEndian(pCurPtr, pRepairState->timestampRecovery);
+        pCurPtr += SIZEOF(UINT32);
+        putUnalignedInt16BigEndian(pCurPtr, pRepairState->sequenceNumberBase);
+        pCurPtr += SIZEOF(UINT16);
+        pCurPtr += flexFecWriteMask(pRepairState, pCurPtr);
+
+        MEMCPY(pCurPtr, pRepairState->pPayload, pRepairState->payloadLength);
+        pCurPtr += pRepairState->payloadLength;
+
+        length = (UINT32) (pCurPtr - (pPayloadArray->payloadBuffer + pPayloadArray->payloadLength));
+        pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize++] = length;
+        pPayloadArray->payloadLength += length;
+    }
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+STATUS createFlexFecDecoder(UINT32 protectedSsrc, FlexFecRecoveredPacketFunc onRecoveredPacket, UINT64 customData,
+                            PFlexFecDecoder* ppFlexFecDecoder)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFlexFecDecoder pFlexFecDecoder = NULL;
+
+    CHK(ppFlexFecDecoder != NULL && onRecoveredPacket != NULL, STATUS_NULL_ARG);
+    CHK(NULL != (pFlexFecDecoder = (PFlexFecDecoder) MEMCALLOC(1, SIZEOF(FlexFecDecoder))), STATUS_NOT_ENOUGH_MEMORY);
+
+    pFlexFecDecoder->protectedSsrc = protectedSsrc;
+    pFlexFecDecoder->onRecoveredPacket = onRecoveredPacket;
+    pFlexFecDecoder->customData = customData;
+
+CleanUp:
+    if (ppFlexFecDecoder != NULL) {
+        *ppFlexFecDecoder = pFlexFecDecoder;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeFlexFecDecoder(PFlexFecDecoder* ppFlexFecDecoder)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFlexFecDecoder pFlexFecDecoder = NULL;
+    UINT32 i;
+
+    CHK(ppFlexFecDecoder != NULL, STATUS_NULL_ARG);
+    pFlexFecDecoder = *ppFlexFecDecoder;
+    CHK(pFlexFecDecoder != NULL, retStatus);
+
+    for (i = 0; i < FLEXFEC_RECEIVE_WINDOW_SIZE; i++) {
+        SAFE_MEMFREE(pFlexFecDecoder->mediaPackets[i].pPacket);
+    }
+    for (i = 0; i < FLEXFEC_MAX_PENDING_REPAIR_PACKETS; i++) {
+        SAFE_MEMFREE(pFlexFecDecoder->pendingRepairs[i].pPayload);
+    }
+    SAFE_MEMFREE(*ppFlexFecDecoder);
+
+CleanUp:
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+static PFlexFecMediaPacket flexFecGetMediaPacket(PFlexFecDecoder pFlexFecDecoder, UINT16 sequenceNumber)
+{
+    PFlexFecMediaPacket pMediaPacket = &pFlexFecDecoder->mediaPackets[sequenceNumber % FLEXFEC_RECEIVE_WINDOW_SIZE];
+
+    return pMediaPacket->present && pMediaPacket->sequenceNumber == sequenceNumber ? pMediaPacket : NULL;
+}
+
+// Packets this far behind the newest one may have been replaced in the window already
+static BOOL flexFecOutsideWindow(PFlexFecDecoder pFlexFecDecoder, UINT16 sequenceNumber)
+{
+    UINT16 distance = (UINT16) (pFlexFecDecoder->highestSequenceNumber - sequenceNumber);
+
+    return pFlexFecDecoder->receivedMedia && distance < MAX_UINT16 / 2 && distance >= FLEXFEC_RECEIVE_WINDOW_SIZE;
+}
+
+static STATUS flexFecStoreMediaPacket(PFlexFecDecoder pFlexFecDecoder, PBYTE pRawPacket, UINT32 rawPacketLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT16 sequenceNumber = (UINT16) getUnalignedInt16BigEndian(pRawPacket + SEQ_NUMBER_OFFSET);
+    PFlexFecMediaPacket pMediaPacket = &pFlexFecDecoder->mediaPackets[sequenceNumber % FLEXFEC_RECEIVE_WINDOW_SIZE];
+    PBYTE pNewPacket = NULL;
+
+    CHK(!flexFecOutsideWindow(pFlexFecDecoder, sequenceNumber), STATUS_SUCCESS);
+    if (rawPacketLength > pMediaPacket->capacity) {
+        CHK(NULL != (pNewPacket = (PBYTE) MEMREALLOC(pMediaPacket->pPacket, rawPacketLength)), STATUS_NOT_ENOUGH_MEMORY);
+        pMediaPacket->pPacket = pNewPacket;
+        pMediaPacket->capacity = rawPacketLength;
+    }
+    MEMCPY(pMediaPacket->pPacket, pRawPacket, rawPacketLength);
+    pMediaPacket->length = rawPacketLength;
+    pMediaPacket->sequenceNumber = sequenceNumber;
+    pMediaPacket->present = TRUE;
+
+    if (!pFlexFecDecoder->receivedMedia || (INT16) (sequenceNumber - pFlexFecDecoder->highestSequenceNumber) > 0) {
+        pFlexFecDecoder->highestSequenceNumber = sequenceNumber;
+    }
+    pFlexFecDecoder->receivedMedia = TRUE;
+
+CleanUp:
+    return retStatus;
+}
+
+/*
+ * Counts the protected packets which are missing. When exactly one is missing its sequence number is returned,
+ * repair packets reaching outside of the window can't be used any more and report no missing packet.
+ */
+static UINT32 flexFecCountMissing(PFlexFecDecoder pFlexFecDecoder, PFlexFecRepairState pRepairState, PUINT16 pMissingSequenceNumber)
+{
+    UINT32 i, missingCount = 0;
+    UINT16 sequenceNumber;
+
+    for (i = 0; i < FLEXFEC_MASK_LONG_BITS; i++) {
+        if (FLEXFEC_MASK_BIT_SET(pRepairState->mask, i)) {
+            sequenceNumber = (UINT16) (pRepairState->sequenceNumberBase + i);
+            if (flexFecOutsideWindow(pFlexFecDecoder, sequenceNumber)) {
+                return 0;
+            }
+            if (flexFecGetMediaPacket(pFlexFecDecoder, sequenceNumber) == NULL) {
+                *pMissingSequenceNumber = sequenceNumber;
+                missingCount++;
+            }
+        }
+    }
+
+    return missingCount;
+}
+
+// The recovery operation of https://www.rfc-editor.org/rfc/rfc8627#section-6.3.2
+static STATUS flexFecRecover(PFlexFecDecoder pFlexFecDecoder, PFlexFecRepairState pRepairState, UINT16 missingSequenceNumber)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, length;
+    UINT16 sequenceNumber;
+    PFlexFecMediaPacket pMediaPacket;
+    PBYTE pRecoveredPacket = NULL;
+
+    // Every other protected packet is XORed into the repair state, which leaves the missing one
+    for (i = 0; i < FLEXFEC_MASK_LONG_BITS; i++) {
+        sequenceNumber = (UINT16) (pRepairState->sequenceNumberBase + i);
+        if (FLEXFEC_MASK_BIT_SET(pRepairState->mask, i) && sequenceNumber != missingSequenceNumber) {
+            pMediaPacket = flexFecGetMediaPacket(pFlexFecDecoder, sequenceNumber);
+            CHK(pMediaPacket->length - MIN_HEADER_LENGTH <= pRepairState->payloadLength, STATUS_RTP_INVALID_FLEXFEC_PACKET);
+            pRepairState->flags ^= pMediaPacket->pPacket[0];
+            pRepairState->markerPayloadType ^= pMediaPacket->pPacket[1];
+            pRepairState->lengthRecovery ^= (UINT16) (pMediaPacket->length - MIN_HEADER_LENGTH);
+            pRepairState->timestampRecovery ^= (UINT32) getUnalignedInt32BigEndian(pMediaPacket->pPacket + TIMESTAMP_OFFSET);
+            flexFecXorBytes(pRepairState->pPayload, pMediaPacket->pPacket + MIN_HEADER_LENGTH, pMediaPacket->length - MIN_HEADER_LENGTH);
+        }
+    }
+
+    length = pRepairState->lengthRecovery;
+    CHK(length <= pRepairState->payloadLength, STATUS_RTP_INVALID_FLEXFEC_PACKET);
+    CHK(NULL != (pRecoveredPacket = (PBYTE) MEMALLOC(MIN_HEADER_LENGTH + length)), STATUS_NOT_ENOUGH_MEMORY);
+    pRecoveredPacket[0] = (BYTE) ((2 << VERSION_SHIFT) | (pRepairState->flags & FLEXFEC_HEADER_RECOVERY_MASK));
+    pRecoveredPacket[1] = pRepairState->markerPayloadType;
+    putUnalignedInt16BigEndian(pRecoveredPacket + SEQ_NUMBER_OFFSET, missingSequenceNumber);
+    putUnalignedInt32BigEndian(pRecoveredPacket + TIMESTAMP_OFFSET, pRepairState->timestampRecovery);
+    putUnalignedInt32BigEndian(pRecoveredPacket + SSRC_OFFSET, pFlexFecDecoder->protectedSsrc);
+    MEMCPY(pRecoveredPacket + MIN_HEADER_LENGTH, pRepairState->pPayload, length);
+
+    CHK_STATUS(flexFecStoreMediaPacket(pFlexFecDecoder, pRecoveredPacket, MIN_HEADER_LENGTH + length));
+    pFlexFecDecoder->packetsRecovered++;
+    // Ownership of the packet goes to the callback
+    retStatus = pFlexFecDecoder->onRecoveredPacket(pFlexFecDecoder->customData, pRecoveredPacket, MIN_HEADER_LENGTH + length);
+    pRecoveredPacket = NULL;
+    CHK_STATUS(retStatus);
+
+CleanUp:
+    SAFE_MEMFREE(pRecoveredPacket);
+
+    return retStatus;
+}
+
+static VOID flexFecRemovePendingRepair(PFlexFecDecoder pFlexFecDecoder, UINT32 index)
+{
+    FlexFecRepairState repairState = pFlexFecDecoder->pendingRepairs[index];
+
+    // Pending repairs stay in arrival order, the removed one's payload buffer is kept behind them for reuse
+    pFlexFecDecoder->pendingRepairCount--;
+    MEMMOVE(pFlexFecDecoder->pendingRepairs + index, pFlexFecDecoder->pendingRepairs + index + 1,
+            (pFlexFecDecoder->pendingRepairCount - index) * SIZEOF(FlexFecRepairState));
+    pFlexFecDecoder->pendingRepairs[pFlexFecDecoder->pendingRepairCount] = repairState;
+}
+
+// Recovering a packet may complete other repair packets, so pending ones are checked until nothing changes
+static STATUS flexFecProcessPendingRepairs(PFlexFecDecoder pFlexFecDecoder)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, missingCount;
+    UINT16 missingSequenceNumber = 0;
+    BOOL progress = TRUE;
+
+    while (progress) {
+        progress = FALSE;
+        for (i = 0; i < pFlexFecDecoder->pendingRepairCount && !progress; i++) {
+            missingCount = flexFecCountMissing(pFlexFecDecoder, pFlexFecDecoder->pendingRepairs + i, &missingSequenceNumber);
+            if (missingCount == 1) {
+                retStatus = flexFecRecover(pFlexFecDecoder, pFlexFecDecoder->pendingRepairs + i, missingSequenceNumber);
+                flexFecRemovePendingRepair(pFlexFecDecoder, i);
+                CHK_STATUS(retStatus);
+                progress = TRUE;
+            } else if (missingCount == 0) {
+                flexFecRemovePendingRepair(pFlexFecDecoder, i);
+                pFlexFecDecoder->repairPacketsDiscarded++;
+                progress = TRUE;
+            }
+        }
+    }
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS flexFecDecoderAddMediaPacket(PFlexFecDecoder pFlexFecDecoder, PBYTE pRawPacket, UINT32 rawPacketLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pFlexFecDecoder != NULL && pRawPacket != NULL, STATUS_NULL_ARG);
+    CHK(rawPacketLength >= MIN_HEADER_LENGTH, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+
+    CHK_STATUS(flexFecStoreMediaPacket(pFlexFecDecoder, pRawPacket, rawPacketLength));
+    CHK(pFlexFecDecoder->pendingRepairCount > 0, retStatus);
+    CHK_STATUS(flexFecProcessPendingRepairs(pFlexFecDecoder));
+
+CleanUp:
+    return retStatus;
+}
+
+// Parses a repair packet into a free pending slot
+static STATUS flexFecParseRepairPacket(PFlexFecDecoder pFlexFecDecoder, PBYTE pRawPacket, UINT32 rawPacketLength, PFlexFecRepairState pRepairState)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, headerLength, chunkSize, bitOffset = 0, maskBits;
+    PBYTE pMask, pEnd = pRawPacket + rawPacketLength;
+
+    CHK(rawPacketLength >= MIN_HEADER_LENGTH && ((pRawPacket[0] >> VERSION_SHIFT) & VERSION_MASK) == 2, STATUS_RTP_INVALID_FLEXFEC_PACKET);
+    headerLength = MIN_HEADER_LENGTH + (pRawPacket[0] & CSRC_COUNT_MASK) * CSRC_LENGTH;
+    if ((pRawPacket[0] >> EXTENSION_SHIFT) & EXTENSION_MASK) {
+        CHK(rawPacketLength >= headerLength + 4, STATUS_RTP_INVALID_FLEXFEC_PACKET);
+        headerLength += 4 + getUnalignedInt16BigEndian(pRawPacket + headerLength + 2) * 4;
+    }
+    CHK(rawPacketLength >= headerLength + FLEXFEC_HEADER_FIXED_SIZE + SIZEOF(UINT16) + FLEXFEC_MASK_SHORT_SIZE, STATUS_RTP_INVALID_FLEXFEC_PACKET);
+
+    // Only single stream protection with flexible masks is generated, see flexFecEncoderFinishFrame
+    CHK((pRawPacket[0] & CSRC_COUNT_MASK) == 1 && (UINT32) getUnalignedInt32BigEndian(pRawPacket + CSRC_OFFSET) == pFlexFecDecoder->protectedSsrc,
+        STATUS_NOT_IMPLEMENTED);
+    CHK((pRawPacket[headerLength] & (FLEXFEC_HEADER_R | FLEXFEC_HEADER_F)) == 0, STATUS_NOT_IMPLEMENTED);
+
+    pRepairState->flags = pRawPacket[headerLength] & FLEXFEC_HEADER_RECOVERY_MASK;
+    pRepairState->markerPayloadType = pRawPacket[headerLength + 1];
+    pRepairState->lengthRecovery = (UINT16) getUnalignedInt16BigEndian(pRawPacket + headerLength + 2);
+    pRepairState->timestampRecovery = (UINT32) getUnalignedInt32BigEndian(pRawPacket + headerLength + 4);
+    pRepairState->sequenceNumberBase = (UINT16) getUnalignedInt16BigEndian(pRawPacket + headerLength + FLEXFEC_HEADER_FIXED_SIZE);
+    pRepairState->mask[0] = 0;
+    pRepairState->mask[1] = 0;
+
+    // Chunks of 15, 31 and 64 bits, the first two end the mask when their k bit is set
+    pMask = pRawPacket + headerLength + FLEXFEC_HEADER_FIXED_SIZE + SIZEOF(UINT16);
+    if (pMask[0] & FLEXFEC_MASK_K) {
+        chunkSize = FLEXFEC_MASK_SHORT_SIZE;
+        maskBits = FLEXFEC_MASK_SHORT_BITS;
+    } else if (pMask + FLEXFEC_MASK_MEDIUM_SIZE <= pEnd && (pMask[FLEXFEC_MASK_SHORT_SIZE] & FLEXFEC_MASK_K)) {
+        chunkSize = FLEXFEC_MASK_MEDIUM_SIZE;
+        maskBits = FLEXFEC_MASK_MEDIUM_BITS;
+    } else {
+        CHK(pMask + FLEXFEC_MASK_LONG_SIZE <= pEnd, STATUS_RTP_INVALID_FLEXFEC_PACKET);
+        chunkSize = FLEXFEC_MASK_LONG_SIZE;
+        maskBits = FLEXFEC_MASK_LONG_BITS;
+    }
+    for (i = 0; i < maskBits; i++) {
+        bitOffset = i < FLEXFEC_MASK_SHORT_BITS ? i + 1 : i + 2;
+        if (pMask[bitOffset / 8] & (0x80 >> (bitOffset % 8))) {
+            pRepairState->mask[i / 64] |= ((UINT64) 1) << (i % 64);
+        }
+    }
+
+    pRepairState->payloadLength = (UINT32) (pEnd - (pMask + chunkSize));
+    if (pRepairState->payloadLength > 0) {
+        CHK_STATUS(flexFecReserveRepairPayload(pRepairState, pRepairState->payloadLength));
+        MEMCPY(pRepairState->pPayload, pMask + chunkSize, pRepairState->payloadLength);
+    }
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS flexFecDecoderAddRepairPacket(PFlexFecDecoder pFlexFecDecoder, PBYTE pRawPacket, UINT32 rawPacketLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PFlexFecRepairState pRepairState;
+
+    CHK(pFlexFecDecoder != NULL && pRawPacket != NULL, STATUS_NULL_ARG);
+
+    // When every slot is taken the oldest pending repair packet makes room
+    if (pFlexFecDecoder->pendingRepairCount == FLEXFEC_MAX_PENDING_REPAIR_PACKETS) {
+        flexFecRemovePendingRepair(pFlexFecDecoder, 0);
+        pFlexFecDecoder->repairPacketsDiscarded++;
+    }
+    pRepairState = pFlexFecDecoder->pendingRepairs + pFlexFecDecoder->pendingRepairCount;
+
+    // Unsupported repair packets are discarded quietly, malformed ones are reported as well
+    if (STATUS_FAILED(retStatus = flexFecParseRepairPacket(pFlexFecDecoder, pRawPacket, rawPacketLength, pRepairState))) {
+        pFlexFecDecoder->repairPacketsDiscarded++;
+        CHK(retStatus != STATUS_NOT_IMPLEMENTED, STATUS_SUCCESS);
+        CHK(FALSE, retStatus);
+    }
+
+    pFlexFecDecoder->pendingRepairCount++;
+    CHK_STATUS(flexFecProcessPendingRepairs(pFlexFecDecoder));
+
+CleanUp:
+    return retStatus;
+}
@@ -0,0 +1,165 @@
+/*******************************************
+FlexFEC internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_FLEXFEC__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_FLEXFEC__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * FlexFEC repair packet payload, flexible mask variant https://www.rfc-editor.org/rfc/rfc8627#section-4.2.2.1
+ * The repair packet's CSRC list carries the SSRC of the protected stream.
+ *
+ *  0                   1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |0|0|P|X|  CC   |M| PT recovery |        length recovery        |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                          TS recovery                          |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |           SN base             |k|          Mask [0-14]        |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |k|                   Mask [15-45] (optional)                   |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                     Mask [46-109] (optional)                  |
+ * |                                                               |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                   Repair "Payload" follows                    |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ */
+#define FLEXFEC_HEADER_FIXED_SIZE      8
+#define FLEXFEC_HEADER_R               0x80
+#define FLEXFEC_HEADER_F               0x40
+#define FLEXFEC_HEADER_RECOVERY_MASK   0x3F
+#define FLEXFEC_MASK_K                 0x80
+#define FLEXFEC_MASK_SHORT_BITS        15
+#define FLEXFEC_MASK_MEDIUM_BITS       46
+#define FLEXFEC_MASK_LONG_BITS         110
+#define FLEXFEC_MASK_SHORT_SIZE        2
+#define FLEXFEC_MASK_MEDIUM_SIZE       6
+#define FLEXFEC_MASK_LONG_SIZE         14
+#define FLEXFEC_RTP_HEADER_SIZE        (MIN_HEADER_LENGTH + CSRC_LENGTH)
+#define FLEXFEC_MAX_REPAIR_HEADER_SIZE (FLEXFEC_RTP_HEADER_SIZE + FLEXFEC_HEADER_FIXED_SIZE + SIZEOF(UINT16) + FLEXFEC_MASK_LONG_SIZE)
+
+// Packets a repair packet can reach from its SN base, frames with more packets are protected in blocks of this size
+#define FLEXFEC_MAX_BLOCK_SIZE FLEXFEC_MASK_LONG_BITS
+
+// Repair packets are sent in proportion to the smoothed loss rate reported by RTCP, no repair packets are sent below the minimum loss
+#define FLEXFEC_LOSS_SMOOTHING_FACTOR      0.3
+#define FLEXFEC_MIN_LOSS_RATE              0.005
+#define FLEXFEC_LOSS_PROTECTION_MULTIPLIER 2.0
+#define FLEXFEC_MAX_REPAIR_RATE            0.5
+#define FLEXFEC_REPAIR_RATE_SCALE          1000
+
+// Media packets kept by the receiver for recovery and repair packets waiting for more media packets to arrive
+#define FLEXFEC_RECEIVE_WINDOW_SIZE        256
+#define FLEXFEC_MAX_PENDING_REPAIR_PACKETS 16
+#define FLEXFEC_DEFAULT_REPAIR_WINDOW_USEC 200000
+
+/**
+ * Protection operation state of a single repair packet, the XOR of the protected packets' headers and payloads
+ */
+typedef struct {
+    UINT8 flags;
+    UINT8 markerPayloadType;
+    UINT16 lengthRecovery;
+    UINT32 timestampRecovery;
+    UINT16 sequenceNumberBase;
+    // Bit i is set when the packet SN base + i is protected
+    UINT64 mask[2];
+    PBYTE pPayload;
+    UINT32 payloadLength;
+    UINT32 payloadCapacity;
+} FlexFecRepairState, *PFlexFecRepairState;
+
+typedef struct {
+    // Published by the RTCP handlers, read when a frame starts
+    volatile SIZE_T repairRate;
+    DOUBLE smoothedLossRate;
+
+    UINT32 protectedSsrc;
+    UINT32 ssrc;
+    UINT8 payloadType;
+    UINT16 sequenceNumber;
+
+    // Frame being protected, the repair rate is sampled once so a report arriving mid-frame can't change the layout
+    UINT32 frameRepairRate;
+    UINT32 timestamp;
+    UINT32 framePacketCount;
+    UINT32 protectedPacketCount;
+    UINT32 repairPacketCount;
+
+    // Reused across frames, only grown when a frame needs more repair packets than seen so far
+    PFlexFecRepairState pRepairStates;
+    UINT32 maxRepairStates;
+} FlexFecEncoder, *PFlexFecEncoder;
+
+/**
+ * Called with every packet the decoder recovers. The callee owns the raw packet buffer and must free it
+ */
+typedef STATUS (*FlexFecRecoveredPacketFunc)(UINT64, PBYTE, UINT32);
+
+typedef struct {
+    UINT16 sequenceNumber;
+    BOOL present;
+    PBYTE pPacket;
+    UINT32 length;
+    UINT32 capacity;
+} FlexFecMediaPacket, *PFlexFecMediaPacket;
+
+typedef struct {
+    UINT32 protectedSsrc;
+    FlexFecRecoveredPacketFunc onRecoveredPacket;
+    UINT64 customData;
+
+    BOOL receivedMedia;
+    UINT16 highestSequenceNumber;
+    FlexFecMediaPacket mediaPackets[FLEXFEC_RECEIVE_WINDOW_SIZE];
+
+    FlexFecRepairState pendingRepairs[FLEXFEC_MAX_PENDING_REPAIR_PACKETS];
+    UINT32 pendingRepairCount;
+
+    UINT64 packetsRecovered;
+    UINT64 repairPacketsDiscarded;
+} FlexFecDecoder, *PFlexFecDecoder;
+
+STATUS createFlexFecEncoder(UINT32, UINT32, UINT8, PFlexFecEncoder*);
+STATUS freeFlexFecEncoder(PFlexFecEncoder*);
+
+/**
+ * Folds a loss fraction reported by a receiver report or transport wide feedback into the repair rate
+ */
+STATUS flexFecEncoderUpdateLoss(PFlexFecEncoder, DOUBLE);
+
+/**
+ * Starts protecting a frame of the given number of packets with the given RTP timestamp. Every packet of the frame is then
+ * passed in order to flexFecEncoderProtectPacket before encryption, and flexFecEncoderFinishFrame writes the repair packets
+ * into the payload array as complete RTP packets.
+ */
+STATUS flexFecEncoderStartFrame(PFlexFecEncoder, UINT32, UINT32);
+STATUS flexFecEncoderProtectPacket(PFlexFecEncoder, PBYTE, UINT32);
+STATUS flexFecEncoderFinishFrame(PFlexFecEncoder, PPayloadArray);
+
+STATUS createFlexFecDecoder(UINT32, FlexFecRecoveredPacketFunc, UINT64, PFlexFecDecoder*);
+STATUS freeFlexFecDecoder(PFlexFecDecoder*);
+
+/**
+ * Keeps a decrypted media packet for recovery. Pending repair packets may recover other packets once it arrived
+ */
+STATUS flexFecDecoderAddMediaPacket(PFlexFecDecoder, PBYTE, UINT32);
+
+/**
+ * Uses a decrypted repair packet to recover a lost media packet, or keeps it until enough media packets arrived.
+ * Repair packets protecting other streams, in the retransmission format or with fixed offset masks are discarded.
+ * Every discarded repair packet, malformed ones included, is counted in repairPacketsDiscarded.
+ */
+STATUS flexFecDecoderAddRepairPacket(PFlexFecDecoder, PBYTE, UINT32);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_FLEXFEC__ */
@@ -475,7 +475,6 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
     UINT32 curTimestamp = 0;
     UINT16 startDropIndex = 0;
     UINT32 curFrameSize = 0;
-    UINT32 partialFrameSize = 0;
     UINT64 hashValue = 0;
     BOOL isStart = FALSE, containStartForEarliestFrame = FALSE, hasEntry = FALSE;
     UINT16 lastNonNullIndex = 0;
@@ -553,10 +552,10 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
                 curFrameSize = 0;
             }
 
-            // With the missing output buffer parameter, this will only return the size of the packet, and identify if it is a starting packet of a
-            // frame
-            CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, NULL, &partialFrameSize, &isStart));
-            curFrameSize += partialFrameSize;
+            // Without an output buffer or size this only identifies a starting packet. The frame is depayloaded once, when it is filled,
+            // and the payload sizes only give the consumer a starting point for its buffer
+            CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, NULL, NULL, &isStart));
+            curFrameSize += pCurPacket->payloadLength;
             if (isStart && pJitterBuffer->headTimestamp == curTimestamp) {
                 containStartForEarliestFrame = TRUE;
             }
@@ -572,8 +571,7 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
             if (hasEntry) {
                 CHK_STATUS(hashTableGet(pJitterBuffer->pPkgBufferHashTable, index, &hashValue));
                 pCurPacket = (PRtpPacket) hashValue;
-                CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, NULL, &partialFrameSize, NULL));
-                curFrameSize += partialFrameSize;
+                curFrameSize += pCurPacket->payloadLength;
             }
         }
 
@@ -661,7 +659,33 @@ CleanUp:
     if (pFilledSize != NULL) {
         *pFilledSize = frameSize - remainingFrameSize;
     }
-    CHK_LOG_ERR(retStatus);
+    // Consumers size their buffer from the payloads and grow it when the depayloaded frame doesn't fit
+    if (retStatus != STATUS_BUFFER_TOO_SMALL) {
+        CHK_LOG_ERR(retStatus);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS jitterBufferIsPacketMissing(PJitterBuffer pJitterBuffer, UINT16 sequenceNumber, PBOOL pMissing)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL hasEntry = TRUE;
+
+    CHK(pJitterBuffer != NULL && pMissing != NULL, STATUS_NULL_ARG);
+
+    // Sequence numbers behind the head belong to frames that were delivered or dropped already
+    if (pJitterBuffer->started && (INT16) (sequenceNumber - pJitterBuffer->headSequenceNumber) >= 0) {
+        CHK_STATUS(hashTableContains(pJitterBuffer->pPkgBufferHashTable, sequenceNumber, &hasEntry));
+    }
+
+CleanUp:
+
+    if (pMissing != NULL) {
+        *pMissing = !hasEntry;
+    }
 
     LEAVES();
     return retStatus;
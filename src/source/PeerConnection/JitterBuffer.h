@@ -10,6 +10,7 @@ PeerConnection internal include file
 extern "C" {
 #endif
 
+// The frame size passed on is the payload size of its packets, depayloading can make the frame larger or smaller than that
 typedef STATUS (*FrameReadyFunc)(UINT64, UINT16, UINT16, UINT32);
 typedef STATUS (*FrameDroppedFunc)(UINT64, UINT16, UINT16, UINT32);
 #define UINT16_DEC(a) ((UINT16) ((a) -1))
@@ -51,6 +52,8 @@ STATUS freeJitterBuffer(PJitterBuffer*);
 STATUS jitterBufferPush(PJitterBuffer, PRtpPacket, PBOOL);
 STATUS jitterBufferDropBufferData(PJitterBuffer, UINT16, UINT16, UINT32);
 STATUS jitterBufferFillFrameData(PJitterBuffer, PBYTE, UINT32, PUINT32, UINT16, UINT16);
+// A packet is missing when it is neither buffered nor part of a frame already handed out
+STATUS jitterBufferIsPacketMissing(PJitterBuffer, UINT16, PBOOL);
 
 #ifdef __cplusplus
 }
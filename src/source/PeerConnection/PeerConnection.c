@@ -58,13 +58,19 @@ STATUS allocateSctp(PKvsPeerConnection pKvsPeerConnection)
     STATUS retStatus = STATUS_SUCCESS;
     SctpSessionCallbacks sctpSessionCallbacks;
     AllocateSctpSortDataChannelsData data;
-    UINT32 currentDataChannelId = 0;
+    UINT32 currentDataChannelId = 0, basePacketSize, maxPacketSize;
     UINT64 hashValue = 0;
     PKvsDataChannel pKvsDataChannel = NULL;
+    RtcOnOpen onOpen;
+    BOOL locked = FALSE;
 
     CHK(pKvsPeerConnection != NULL, STATUS_NULL_ARG);
     currentDataChannelId = (pKvsPeerConnection->dtlsIsServer) ? 1 : 0;
 
+    // DataChannels created from here on are announced to the remote peer as soon as the session is up
+    MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = TRUE;
+
     // Re-sort DataChannel hashmap using proper streamIds if we are offerer or answerer
     data.currentDataChannelId = currentDataChannelId;
     data.pKvsPeerConnection = pKvsPeerConnection;
@@ -80,12 +86,29 @@ STATUS allocateSctp(PKvsPeerConnection pKvsPeerConnection)
     sctpSessionCallbacks.outboundPacketFunc = onSctpSessionOutboundPacket;
     sctpSessionCallbacks.dataChannelMessageFunc = onSctpSessionDataChannelMessage;
     sctpSessionCallbacks.dataChannelOpenFunc = onSctpSessionDataChannelOpen;
+    sctpSessionCallbacks.dataChannelBufferDrainedFunc = onSctpSessionDataChannelBufferDrained;
+    sctpSessionCallbacks.dataChannelAckFunc = onSctpSessionDataChannelAck;
+    sctpSessionCallbacks.dataChannelCloseFunc = onSctpSessionDataChannelClose;
     sctpSessionCallbacks.customData = (UINT64) pKvsPeerConnection;
-    CHK_STATUS(createSctpSession(&sctpSessionCallbacks, &(pKvsPeerConnection->pSctpSession)));
+
+    // SCTP packets go in one DTLS record each, no larger than what is left of the configured MTU after the IP and UDP
+    // headers. Packets start out at the size they would have with the default MTU and grow as probes confirm the path
+    // carries larger ones
+    CHK(pKvsPeerConnection->MTU > PEER_CONNECTION_IP_UDP_OVERHEAD, STATUS_INVALID_ARG);
+    CHK_STATUS(dtlsSessionSetMtu(pKvsPeerConnection->pDtlsSession, pKvsPeerConnection->MTU - PEER_CONNECTION_IP_UDP_OVERHEAD, &maxPacketSize));
+    maxPacketSize = MAX(maxPacketSize, SCTP_MIN_PACKET_SIZE);
+    basePacketSize = MAX(maxPacketSize - (pKvsPeerConnection->MTU - MIN(pKvsPeerConnection->MTU, DEFAULT_MTU_SIZE)), SCTP_MIN_PACKET_SIZE);
+    CHK_STATUS(createSctpSession(&sctpSessionCallbacks, basePacketSize, maxPacketSize, &(pKvsPeerConnection->pSctpSession)));
+
+    // Not held while sending, usrsctp can call back into the DataChannels from its own threads meanwhile
+    MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = FALSE;
 
     for (; currentDataChannelId < data.currentDataChannelId; currentDataChannelId += 2) {
         pKvsDataChannel = NULL;
+        MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
         retStatus = hashTableGet(pKvsPeerConnection->pDataChannels, currentDataChannelId, &hashValue);
+        MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
         pKvsDataChannel = (PKvsDataChannel) hashValue;
         if (retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT) {
             retStatus = STATUS_SUCCESS;
@@ -95,21 +118,51 @@ STATUS allocateSctp(PKvsPeerConnection pKvsPeerConnection)
         CHK(pKvsDataChannel != NULL, STATUS_INTERNAL_ERROR);
         CHK_STATUS(sctpSessionWriteDcep(pKvsPeerConnection->pSctpSession, currentDataChannelId, pKvsDataChannel->dataChannel.name,
                                         STRLEN(pKvsDataChannel->dataChannel.name), &pKvsDataChannel->rtcDataChannelInit));
+
+        // Channels created before signaling don't wait for the DATA_CHANNEL_ACK, the remote peer knows them from the offer
+        MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
         pKvsDataChannel->rtcDataChannelDiagnostics.state = RTC_DATA_CHANNEL_STATE_OPEN;
-        if (STATUS_FAILED(hashTableUpsert(pKvsPeerConnection->pDataChannels, currentDataChannelId, (UINT64) pKvsDataChannel))) {
-            DLOGW("Failed to update entry in hash table with recent changes to data channel");
-        }
-        if (pKvsDataChannel->onOpen != NULL) {
-            pKvsDataChannel->onOpen(pKvsDataChannel->onOpenCustomData, &pKvsDataChannel->dataChannel);
+        onOpen = pKvsDataChannel->onOpen;
+        MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+        if (onOpen != NULL) {
+            onOpen(pKvsDataChannel->onOpenCustomData, &pKvsDataChannel->dataChannel);
         }
     }
 
 CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    }
+
     return retStatus;
 }
 #endif
 
 VOID onInboundPacket(UINT64 customData, PBYTE buff, UINT32 buffLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+
+    CHK(pKvsPeerConnection != NULL, STATUS_SUCCESS);
+    TRACE_INSTANT(TRACE_POINT_PACKET_INGRESS, buffLen);
+
+    // With the receive pipeline the network thread only enqueues, processInboundPacket runs on a media worker
+    if (pKvsPeerConnection->pReceivePipeline != NULL) {
+        retStatus = receivePipelineEnqueue(pKvsPeerConnection->pReceivePipeline, buff, buffLen);
+        if (retStatus == STATUS_PEERCONNECTION_RECEIVE_QUEUE_FULL) {
+            DLOGS("Receive pipeline full, dropping inbound packet");
+            retStatus = STATUS_SUCCESS;
+        }
+    } else {
+        processInboundPacket(customData, buff, buffLen);
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+}
+
+VOID processInboundPacket(UINT64 customData, PBYTE buff, UINT32 buffLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
@@ -176,18 +229,62 @@ CleanUp:
     CHK_LOG_ERR(retStatus);
 }
 
+// Unwraps a RED packet in place to its primary encoding. The redundant encodings of packets the jitter buffer is still missing are
+// pushed ahead of it, blocks whose sequence number can't be told from their timestamp offset are left out
+STATUS unwrapRedPacket(PJitterBuffer pJitterBuffer, PRedDecoder pRedDecoder, PRtpPacket pRtpPacket, PUINT64 pPacketsRecovered)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    RedBlock blocks[RED_MAX_BLOCKS];
+    UINT32 i, blockCount = RED_MAX_BLOCKS;
+    UINT16 sequenceNumber;
+    BOOL placed = FALSE, missing = FALSE, discarded = FALSE;
+    PRtpPacket pRecoveredPacket = NULL;
+
+    CHK(pJitterBuffer != NULL && pRedDecoder != NULL && pRtpPacket != NULL && pPacketsRecovered != NULL, STATUS_NULL_ARG);
+    CHK_STATUS(parseRedPayload(pRtpPacket->payload, pRtpPacket->payloadLength, blocks, &blockCount));
+    CHK_STATUS(redDecoderUpdate(pRedDecoder, pRtpPacket->header.sequenceNumber, pRtpPacket->header.timestamp));
+
+    for (i = 0; i < blockCount - 1; i++) {
+        CHK_STATUS(redDecoderGetBlockSequenceNumber(pRedDecoder, pRtpPacket->header.sequenceNumber, &blocks[i], &sequenceNumber, &placed));
+        if (!placed || blocks[i].length == 0) {
+            continue;
+        }
+        CHK_STATUS(jitterBufferIsPacketMissing(pJitterBuffer, sequenceNumber, &missing));
+        if (!missing) {
+            continue;
+        }
+
+        CHK_STATUS(createRtpPacketFromRedBlock(pRtpPacket, &blocks[i], sequenceNumber, &pRecoveredPacket));
+        discarded = FALSE;
+        CHK_STATUS(jitterBufferPush(pJitterBuffer, pRecoveredPacket, &discarded));
+        pRecoveredPacket = NULL;
+        if (!discarded) {
+            (*pPacketsRecovered)++;
+        }
+    }
+
+    pRtpPacket->header.payloadType = blocks[blockCount - 1].payloadType;
+    pRtpPacket->payload = blocks[blockCount - 1].pData;
+    pRtpPacket->payloadLength = blocks[blockCount - 1].length;
+
+CleanUp:
+    freeRtpPacket(&pRecoveredPacket);
+
+    return retStatus;
+}
+
 STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuffer, UINT32 bufferLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PDoubleListNode pCurNode = NULL;
     PKvsRtpTransceiver pTransceiver;
-    UINT64 item, now;
+    UINT64 item, now, decryptStartTime;
     UINT32 ssrc;
     PRtpPacket pRtpPacket = NULL;
     PBYTE pPayload = NULL;
     BOOL ownedByJitterBuffer = FALSE, discarded = FALSE;
     UINT64 packetsReceived = 0, packetsFailedDecryption = 0, lastPacketReceivedTimestamp = 0, headerBytesReceived = 0, bytesReceived = 0,
-           packetsDiscarded = 0;
+           packetsDiscarded = 0, fecPacketsReceived = 0, redPacketsRecovered = 0;
     INT64 arrival, r_ts, transit, delta;
 
     CHK(pKvsPeerConnection != NULL && pBuffer != NULL, STATUS_NULL_ARG);
@@ -202,12 +299,15 @@ STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuf
 
         if (pTransceiver->jitterBufferSsrc == ssrc) {
             packetsReceived++;
+            decryptStartTime = GETTIME();
             if (STATUS_FAILED(retStatus = decryptSrtpPacket(pKvsPeerConnection->pSrtpSession, pBuffer, (PINT32) &bufferLen))) {
                 DLOGW("decryptSrtpPacket failed with 0x%08x", retStatus);
                 packetsFailedDecryption++;
                 CHK(FALSE, STATUS_SUCCESS);
             }
             now = GETTIME();
+            latencyHistogramRecord(&pKvsPeerConnection->srtpLatency, now - decryptStartTime);
+            TRACE_COMPLETE(TRACE_POINT_SRTP_DECRYPT, decryptStartTime, now, bufferLen);
             CHK(NULL != (pPayload = (PBYTE) MEMALLOC(bufferLen)), STATUS_NOT_ENOUGH_MEMORY);
             MEMCPY(pPayload, pBuffer, bufferLen);
             CHK_STATUS(createRtpPacketFromBytes(pPayload, bufferLen, &pRtpPacket));
@@ -216,6 +316,11 @@ STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuf
             pPayload = NULL;
             pRtpPacket->receivedTime = now;
 
+            // Kept for FlexFEC recovery before the layer filter below changes the payload
+            if (pTransceiver->pFlexFecDecoder != NULL) {
+                CHK_LOG_ERR(flexFecDecoderAddMediaPacket(pTransceiver->pFlexFecDecoder, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength));
+            }
+
             // https://tools.ietf.org/html/rfc3550#section-6.4.1
             // https://tools.ietf.org/html/rfc3550#appendix-A.8
             // interarrival jitter
@@ -231,6 +336,24 @@ STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuf
             headerBytesReceived += RTP_HEADER_LEN(pRtpPacket);
             bytesReceived += pRtpPacket->rawPacketLength - RTP_HEADER_LEN(pRtpPacket);
 
+            if (pKvsPeerConnection->redPayloadType != 0 && pRtpPacket->header.payloadType == pKvsPeerConnection->redPayloadType) {
+                retStatus = unwrapRedPacket(pTransceiver->pJitterBuffer, &pTransceiver->redDecoder, pRtpPacket, &redPacketsRecovered);
+                if (retStatus == STATUS_RTP_INVALID_RED_PAYLOAD) {
+                    packetsDiscarded++;
+                    CHK(FALSE, STATUS_SUCCESS);
+                }
+                CHK_STATUS(retStatus);
+            }
+
+            // Malformed descriptors are rejected here rather than failing reassembly of every frame still in the jitter buffer
+            if (pTransceiver->transceiver.receiver.track.codec == RTC_CODEC_VP9 &&
+                STATUS_FAILED(vp9FilterLayers(pRtpPacket->payload, &pRtpPacket->payloadLength, pTransceiver->maxReceiveSpatialLayer,
+                                              pTransceiver->maxReceiveTemporalLayer))) {
+                packetsDiscarded++;
+                CHK(FALSE, STATUS_SUCCESS);
+            }
+
+            TRACE_INSTANT(TRACE_POINT_JITTER_PUSH, pRtpPacket->header.sequenceNumber);
             CHK_STATUS(jitterBufferPush(pTransceiver->pJitterBuffer, pRtpPacket, &discarded));
             if (discarded) {
                 packetsDiscarded++;
@@ -238,6 +361,15 @@ STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuf
             lastPacketReceivedTimestamp = KVS_CONVERT_TIMESCALE(now, HUNDREDS_OF_NANOS_IN_A_SECOND, 1000);
             ownedByJitterBuffer = TRUE;
             CHK(FALSE, STATUS_SUCCESS);
+        } else if (pTransceiver->pFlexFecDecoder != NULL && pTransceiver->flexFecSsrc == ssrc) {
+            fecPacketsReceived++;
+            if (STATUS_FAILED(retStatus = decryptSrtpPacket(pKvsPeerConnection->pSrtpSession, pBuffer, (PINT32) &bufferLen))) {
+                DLOGW("decryptSrtpPacket failed with 0x%08x", retStatus);
+                CHK(FALSE, STATUS_SUCCESS);
+            }
+            // Recovered packets reach the jitter buffer through onFlexFecRecoveredPacket
+            CHK_LOG_ERR(flexFecDecoderAddRepairPacket(pTransceiver->pFlexFecDecoder, pBuffer, bufferLen));
+            CHK(FALSE, STATUS_SUCCESS);
         }
         pCurNode = pCurNode->pNext;
     }
@@ -245,8 +377,9 @@ STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuf
     DLOGW("No transceiver to handle inbound ssrc %u", ssrc);
 
 CleanUp:
+    // Packets are received by one thread at a time
     if (packetsReceived > 0) {
-        MUTEX_LOCK(pTransceiver->statsLock);
+        RTP_STATS_UPDATE_BEGIN(&pTransceiver->inboundStatsSequence);
         pTransceiver->inboundStats.received.packetsReceived += packetsReceived;
         pTransceiver->inboundStats.packetsFailedDecryption += packetsFailedDecryption;
         pTransceiver->inboundStats.lastPacketReceivedTimestamp = lastPacketReceivedTimestamp;
@@ -254,7 +387,14 @@ CleanUp:
         pTransceiver->inboundStats.bytesReceived += bytesReceived;
         pTransceiver->inboundStats.received.jitter = pTransceiver->pJitterBuffer->jitter / pTransceiver->pJitterBuffer->clockRate;
         pTransceiver->inboundStats.received.packetsDiscarded = packetsDiscarded;
-        MUTEX_UNLOCK(pTransceiver->statsLock);
+        pTransceiver->inboundStats.received.packetsRepaired += redPacketsRecovered;
+        RTP_STATS_UPDATE_END(&pTransceiver->inboundStatsSequence);
+    }
+    if (fecPacketsReceived > 0) {
+        RTP_STATS_UPDATE_BEGIN(&pTransceiver->inboundStatsSequence);
+        pTransceiver->inboundStats.fecPacketsReceived += fecPacketsReceived;
+        pTransceiver->inboundStats.fecPacketsDiscarded = pTransceiver->pFlexFecDecoder->repairPacketsDiscarded;
+        RTP_STATS_UPDATE_END(&pTransceiver->inboundStatsSequence);
     }
     if (!ownedByJitterBuffer) {
         SAFE_MEMFREE(pPayload);
@@ -264,6 +404,39 @@ CleanUp:
     return retStatus;
 }
 
+STATUS onFlexFecRecoveredPacket(UINT64 customData, PBYTE pRawPacket, UINT32 rawPacketLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pTransceiver = (PKvsRtpTransceiver) customData;
+    PRtpPacket pRtpPacket = NULL;
+    BOOL discarded = FALSE;
+
+    CHK(pTransceiver != NULL && pRawPacket != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(createRtpPacketFromBytes(pRawPacket, rawPacketLength, &pRtpPacket));
+    // pRtpPacket took ownership of the recovered packet
+    pRawPacket = NULL;
+    pRtpPacket->receivedTime = GETTIME();
+
+    if (pTransceiver->transceiver.receiver.track.codec == RTC_CODEC_VP9) {
+        CHK_STATUS(vp9FilterLayers(pRtpPacket->payload, &pRtpPacket->payloadLength, pTransceiver->maxReceiveSpatialLayer,
+                                   pTransceiver->maxReceiveTemporalLayer));
+    }
+
+    CHK_STATUS(jitterBufferPush(pTransceiver->pJitterBuffer, pRtpPacket, &discarded));
+    pRtpPacket = NULL;
+
+    RTP_STATS_UPDATE_BEGIN(&pTransceiver->inboundStatsSequence);
+    pTransceiver->inboundStats.received.packetsRepaired++;
+    RTP_STATS_UPDATE_END(&pTransceiver->inboundStatsSequence);
+
+CleanUp:
+    SAFE_MEMFREE(pRawPacket);
+    freeRtpPacket(&pRtpPacket);
+
+    return retStatus;
+}
+
 STATUS changePeerConnectionState(PKvsPeerConnection pKvsPeerConnection, RTC_PEER_CONNECTION_STATE newState)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -316,13 +489,29 @@ CleanUp:
     return retStatus;
 }
 
+// The frame is filled again after growing, so the previous contents are not carried over
+static STATUS growPeerFrameBuffer(PKvsRtpTransceiver pTransceiver, UINT32 minSize)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 bufferSize = (UINT32) (minSize * PEER_FRAME_BUFFER_SIZE_INCREMENT_FACTOR);
+
+    SAFE_MEMFREE(pTransceiver->peerFrameBuffer);
+    pTransceiver->peerFrameBufferSize = 0;
+    pTransceiver->peerFrameBuffer = (PBYTE) MEMALLOC(bufferSize);
+    CHK(pTransceiver->peerFrameBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pTransceiver->peerFrameBufferSize = bufferSize;
+
+CleanUp:
+    return retStatus;
+}
+
 STATUS onFrameReadyFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 frameSize)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PKvsRtpTransceiver pTransceiver = (PKvsRtpTransceiver) customData;
     PRtpPacket pPacket = NULL;
     Frame frame;
-    UINT64 hashValue;
+    UINT64 hashValue, assemblyTime;
     UINT32 filledSize = 0, index;
 
     CHK(pTransceiver != NULL, STATUS_NULL_ARG);
@@ -336,26 +525,42 @@ STATUS onFrameReadyFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, U
         CHK(FALSE, retStatus);
     }
     CHK(pPacket != NULL, STATUS_NULL_ARG);
-    MUTEX_LOCK(pTransceiver->statsLock);
+    // The first packet of the frame waited in the jitter buffer until the last one came in
+    assemblyTime = GETTIME() - pPacket->receivedTime;
+
+    // The frame is depayloaded straight into the buffer, which only grows when the payloads expand past it
+    if (frameSize > pTransceiver->peerFrameBufferSize) {
+        CHK_STATUS(growPeerFrameBuffer(pTransceiver, frameSize));
+    }
+    while ((retStatus = jitterBufferFillFrameData(pTransceiver->pJitterBuffer, pTransceiver->peerFrameBuffer, pTransceiver->peerFrameBufferSize,
+                                                  &filledSize, startIndex, endIndex)) == STATUS_BUFFER_TOO_SMALL) {
+        CHK_STATUS(growPeerFrameBuffer(pTransceiver, pTransceiver->peerFrameBufferSize + 1));
+    }
+    CHK_STATUS(retStatus);
+    // Pictures whose layers were all dropped on receive have nothing to deliver
+    CHK(filledSize > 0, retStatus);
+    frameSize = filledSize;
+
+    latencyHistogramRecord(&pTransceiver->pKvsPeerConnection->frameAssemblyLatency, assemblyTime);
+    TRACE_COMPLETE(TRACE_POINT_FRAME_READY, pPacket->receivedTime, pPacket->receivedTime + assemblyTime, frameSize);
+    // Frames are emitted by the jitter buffer on the receive path
+    RTP_STATS_UPDATE_BEGIN(&pTransceiver->inboundStatsSequence);
     // https://www.w3.org/TR/webrtc-stats/#dom-rtcinboundrtpstreamstats-jitterbufferdelay
-    pTransceiver->inboundStats.jitterBufferDelay += (DOUBLE) (GETTIME() - pPacket->receivedTime) / HUNDREDS_OF_NANOS_IN_A_SECOND;
+    pTransceiver->inboundStats.jitterBufferDelay += (DOUBLE) assemblyTime / HUNDREDS_OF_NANOS_IN_A_SECOND;
     index = pTransceiver->inboundStats.jitterBufferEmittedCount;
     pTransceiver->inboundStats.jitterBufferEmittedCount++;
     if (MEDIA_STREAM_TRACK_KIND_VIDEO == pTransceiver->transceiver.receiver.track.kind) {
         pTransceiver->inboundStats.framesReceived++;
     }
-    MUTEX_UNLOCK(pTransceiver->statsLock);
+    RTP_STATS_UPDATE_END(&pTransceiver->inboundStatsSequence);
 
-    if (frameSize > pTransceiver->peerFrameBufferSize) {
-        MEMFREE(pTransceiver->peerFrameBuffer);
-        pTransceiver->peerFrameBufferSize = (UINT32) (frameSize * PEER_FRAME_BUFFER_SIZE_INCREMENT_FACTOR);
-        pTransceiver->peerFrameBuffer = (PBYTE) MEMALLOC(pTransceiver->peerFrameBufferSize);
-        CHK(pTransceiver->peerFrameBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    // AV1 OBU sizes are only known once every fragment of the frame is in
+    if (pTransceiver->transceiver.receiver.track.codec == RTC_CODEC_AV1) {
+        CHK_STATUS(av1ObuElementsToTemporalUnit(pTransceiver->peerFrameBuffer, filledSize, &frameSize));
+    } else if (pTransceiver->transceiver.receiver.track.codec == RTC_CODEC_VP9) {
+        CHK_STATUS(vp9LayerFramesToSuperframe(pTransceiver->peerFrameBuffer, filledSize, &frameSize));
     }
 
-    CHK_STATUS(jitterBufferFillFrameData(pTransceiver->pJitterBuffer, pTransceiver->peerFrameBuffer, frameSize, &filledSize, startIndex, endIndex));
-    CHK(frameSize == filledSize, STATUS_INVALID_ARG_LEN);
-
     frame.version = FRAME_CURRENT_VERSION;
     frame.decodingTs = pPacket->header.timestamp * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
     frame.presentationTs = frame.decodingTs;
@@ -390,13 +595,13 @@ STATUS onFrameDroppedFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex,
         CHK(FALSE, retStatus);
     }
     CHK(pPacket != NULL, STATUS_NULL_ARG);
-    MUTEX_LOCK(pTransceiver->statsLock);
+    RTP_STATS_UPDATE_BEGIN(&pTransceiver->inboundStatsSequence);
     // https://www.w3.org/TR/webrtc-stats/#dom-rtcinboundrtpstreamstats-jitterbufferdelay
     pTransceiver->inboundStats.jitterBufferDelay += (DOUBLE) (GETTIME() - pPacket->receivedTime) / HUNDREDS_OF_NANOS_IN_A_SECOND;
     pTransceiver->inboundStats.jitterBufferEmittedCount++;
     pTransceiver->inboundStats.received.framesDropped++;
     pTransceiver->inboundStats.received.fullFramesLost++;
-    MUTEX_UNLOCK(pTransceiver->statsLock);
+    RTP_STATS_UPDATE_END(&pTransceiver->inboundStatsSequence);
 
 CleanUp:
     return retStatus;
@@ -517,34 +722,71 @@ CleanUp:
     }
 }
 
-VOID onSctpSessionDataChannelMessage(UINT64 customData, UINT32 channelId, BOOL isBinary, PBYTE pMessage, UINT32 pMessageLen)
+BOOL onSctpSessionDataChannelMessage(UINT64 customData, UINT32 channelId, BOOL isBinary, PBYTE pMessage, UINT32 pMessageLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
     PKvsDataChannel pKvsDataChannel = NULL;
     UINT64 hashValue = 0;
+    BOOL retained = FALSE;
 
     CHK(pKvsPeerConnection != NULL, STATUS_INTERNAL_ERROR);
 
+    MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
     retStatus = hashTableGet(pKvsPeerConnection->pDataChannels, channelId, &hashValue);
+    MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
     pKvsDataChannel = (PKvsDataChannel) hashValue;
     if (retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT) {
         retStatus = STATUS_SUCCESS;
     } else {
         CHK(FALSE, retStatus);
     }
-    CHK(pKvsDataChannel != NULL && pKvsDataChannel->onMessage != NULL, STATUS_INTERNAL_ERROR);
+    CHK(pKvsDataChannel != NULL && (pKvsDataChannel->onOwnedMessage != NULL || pKvsDataChannel->onMessage != NULL), STATUS_INTERNAL_ERROR);
     pKvsDataChannel->rtcDataChannelDiagnostics.messagesReceived++;
     pKvsDataChannel->rtcDataChannelDiagnostics.bytesReceived += pMessageLen;
-    if (STATUS_FAILED(hashTableUpsert(pKvsPeerConnection->pDataChannels, channelId, (UINT64) pKvsDataChannel))) {
-        DLOGW("Failed to update entry in hash table with recent changes to data channel");
+    if (pKvsDataChannel->onOwnedMessage != NULL) {
+        pKvsDataChannel->onOwnedMessage(pKvsDataChannel->onOwnedMessageCustomData, &pKvsDataChannel->dataChannel, isBinary, pMessage, pMessageLen);
+        retained = TRUE;
+    } else {
+        pKvsDataChannel->onMessage(pKvsDataChannel->onMessageCustomData, &pKvsDataChannel->dataChannel, isBinary, pMessage, pMessageLen);
     }
-    pKvsDataChannel->onMessage(pKvsDataChannel->onMessageCustomData, &pKvsDataChannel->dataChannel, isBinary, pMessage, pMessageLen);
 
 CleanUp:
     if (STATUS_FAILED(retStatus)) {
         DLOGW("onSctpSessionDataChannelMessage failed with 0x%08x", retStatus);
     }
+
+    return retained;
+}
+
+VOID onSctpSessionDataChannelBufferDrained(UINT64 customData, UINT32 channelId, UINT32 drained)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+    PKvsDataChannel pKvsDataChannel = NULL;
+    UINT64 hashValue = 0, bufferedAmount;
+
+    CHK(pKvsPeerConnection != NULL, STATUS_INTERNAL_ERROR);
+
+    MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
+    retStatus = hashTableGet(pKvsPeerConnection->pDataChannels, channelId, &hashValue);
+    MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    CHK_STATUS(retStatus);
+    pKvsDataChannel = (PKvsDataChannel) hashValue;
+    CHK(pKvsDataChannel != NULL, STATUS_INTERNAL_ERROR);
+
+    bufferedAmount = (UINT64) ATOMIC_SUBTRACT(&pKvsDataChannel->bufferedAmount, (SIZE_T) drained);
+
+    // Fired once per crossing of the threshold, on the acknowledgement that takes the buffered amount to it
+    if (bufferedAmount > pKvsDataChannel->bufferedAmountLowThreshold && bufferedAmount - drained <= pKvsDataChannel->bufferedAmountLowThreshold &&
+        pKvsDataChannel->onBufferedAmountLow != NULL) {
+        pKvsDataChannel->onBufferedAmountLow(pKvsDataChannel->onBufferedAmountLowCustomData, &pKvsDataChannel->dataChannel, bufferedAmount - drained);
+    }
+
+CleanUp:
+    if (STATUS_FAILED(retStatus)) {
+        DLOGW("onSctpSessionDataChannelBufferDrained failed with 0x%08x", retStatus);
+    }
 }
 
 VOID onSctpSessionDataChannelOpen(UINT64 customData, UINT32 channelId, PBYTE pName, UINT32 nameLen)
@@ -563,11 +805,19 @@ VOID onSctpSessionDataChannelOpen(UINT64 customData, UINT32 channelId, PBYTE pNa
     pKvsDataChannel->pRtcPeerConnection = (PRtcPeerConnection) pKvsPeerConnection;
     pKvsDataChannel->channelId = channelId;
 
+    // Messages are sent reliably and in order
+    pKvsDataChannel->rtcDataChannelInit.ordered = TRUE;
+    NULLABLE_SET_EMPTY(pKvsDataChannel->rtcDataChannelInit.maxPacketLifeTime);
+    NULLABLE_SET_EMPTY(pKvsDataChannel->rtcDataChannelInit.maxRetransmits);
+
     // Set the data channel parameters when data channel is created by peer
     pKvsDataChannel->rtcDataChannelDiagnostics.dataChannelIdentifier = channelId;
     pKvsDataChannel->rtcDataChannelDiagnostics.state = RTC_DATA_CHANNEL_STATE_OPEN;
     STRNCPY(pKvsDataChannel->rtcDataChannelDiagnostics.label, (PCHAR) pName, nameLen);
-    CHK_STATUS(hashTablePut(pKvsPeerConnection->pDataChannels, channelId, (UINT64) pKvsDataChannel));
+    MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
+    retStatus = hashTablePut(pKvsPeerConnection->pDataChannels, channelId, (UINT64) pKvsDataChannel);
+    MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    CHK_STATUS(retStatus);
     pKvsPeerConnection->onDataChannel(pKvsPeerConnection->onDataChannelCustomData, &(pKvsDataChannel->dataChannel));
 
 CleanUp:
@@ -575,6 +825,93 @@ CleanUp:
     CHK_LOG_ERR(retStatus);
 }
 
+#ifdef ENABLE_DATA_CHANNEL
+VOID onSctpSessionDataChannelAck(UINT64 customData, UINT32 channelId)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+    PKvsDataChannel pKvsDataChannel = NULL;
+    UINT64 hashValue = 0;
+    RtcOnOpen onOpen = NULL;
+    BOOL locked = FALSE;
+
+    CHK(pKvsPeerConnection != NULL, STATUS_INTERNAL_ERROR);
+
+    MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = TRUE;
+    CHK_STATUS(hashTableGet(pKvsPeerConnection->pDataChannels, channelId, &hashValue));
+    pKvsDataChannel = (PKvsDataChannel) hashValue;
+    CHK(pKvsDataChannel != NULL, STATUS_INTERNAL_ERROR);
+
+    // Only channels created on the established association wait for the acknowledgement
+    if (pKvsDataChannel->rtcDataChannelDiagnostics.state == RTC_DATA_CHANNEL_STATE_CONNECTING) {
+        pKvsDataChannel->rtcDataChannelDiagnostics.state = RTC_DATA_CHANNEL_STATE_OPEN;
+        onOpen = pKvsDataChannel->onOpen;
+    }
+
+    MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = FALSE;
+
+    if (onOpen != NULL) {
+        onOpen(pKvsDataChannel->onOpenCustomData, &pKvsDataChannel->dataChannel);
+    }
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    }
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGW("onSctpSessionDataChannelAck failed with 0x%08x", retStatus);
+    }
+}
+
+// The remote peer reset its outgoing stream. It either answers the reset of a channel closed locally, or closes the
+// channel, in which case the outgoing stream is reset as well
+VOID onSctpSessionDataChannelClose(UINT64 customData, UINT32 channelId)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+    PKvsDataChannel pKvsDataChannel = NULL;
+    UINT64 hashValue = 0;
+    BOOL locked = FALSE, closedLocally;
+
+    CHK(pKvsPeerConnection != NULL, STATUS_INTERNAL_ERROR);
+
+    MUTEX_LOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = TRUE;
+    CHK_STATUS(hashTableGet(pKvsPeerConnection->pDataChannels, channelId, &hashValue));
+    pKvsDataChannel = (PKvsDataChannel) hashValue;
+    CHK(pKvsDataChannel != NULL, STATUS_INTERNAL_ERROR);
+
+    // The stream id is free for a new channel, the application can still hold this one
+    CHK_STATUS(hashTableRemove(pKvsPeerConnection->pDataChannels, channelId));
+    CHK_STATUS(doubleListInsertItemHead(pKvsPeerConnection->pClosedDataChannels, (UINT64) pKvsDataChannel));
+    closedLocally = pKvsDataChannel->rtcDataChannelDiagnostics.state == RTC_DATA_CHANNEL_STATE_CLOSING;
+    pKvsDataChannel->rtcDataChannelDiagnostics.state = RTC_DATA_CHANNEL_STATE_CLOSED;
+
+    MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    locked = FALSE;
+
+    if (!closedLocally) {
+        CHK_STATUS(sctpSessionResetStream(pKvsPeerConnection->pSctpSession, channelId));
+    }
+
+    if (pKvsDataChannel->onClose != NULL) {
+        pKvsDataChannel->onClose(pKvsDataChannel->onCloseCustomData, &pKvsDataChannel->dataChannel);
+    }
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->dataChannelsLock);
+    }
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGW("onSctpSessionDataChannelClose failed with 0x%08x", retStatus);
+    }
+}
+#endif
+
 VOID onDtlsOutboundPacket(UINT64 customData, PBYTE pBuffer, UINT32 bufferLen)
 {
     PKvsPeerConnection pKvsPeerConnection = NULL;
@@ -598,6 +935,9 @@ VOID onDtlsStateChange(UINT64 customData, RTC_DTLS_TRANSPORT_STATE newDtlsState)
     switch (newDtlsState) {
         case RTC_DTLS_TRANSPORT_STATE_CONNECTED:
             pKvsPeerConnection->peerConnectionDiagnostics.dtlsSessionSetupTime = pKvsPeerConnection->pDtlsSession->dtlsSessionSetupTime;
+            if (pKvsPeerConnection->pDtlsSession->handshakeDuration != 0) {
+                latencyHistogramRecord(&pKvsPeerConnection->dtlsHandshakeLatency, pKvsPeerConnection->pDtlsSession->handshakeDuration);
+            }
             break;
         case RTC_DTLS_TRANSPORT_STATE_CLOSED:
             changePeerConnectionState(pKvsPeerConnection, RTC_PEER_CONNECTION_STATE_CLOSED);
@@ -638,6 +978,7 @@ STATUS rtcpReportsCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData
     UINT32 packetCount, octetCount, packetLen, allocSize, ssrc;
     PBYTE rawPacket = NULL;
     PKvsPeerConnection pKvsPeerConnection = NULL;
+    RtcOutboundRtpStreamStats outboundStats;
 
     PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) customData;
     CHK(pKvsRtpTransceiver != NULL && pKvsRtpTransceiver->pJitterBuffer != NULL && pKvsRtpTransceiver->pKvsPeerConnection != NULL, STATUS_NULL_ARG);
@@ -657,10 +998,9 @@ STATUS rtcpReportsCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData
         ntpTime = convertTimestampToNTP(currentTime);
         rtpTime = pKvsRtpTransceiver->sender.rtpTimeOffset +
             CONVERT_TIMESTAMP_TO_RTP(pKvsRtpTransceiver->pJitterBuffer->clockRate, currentTime - pKvsRtpTransceiver->sender.firstFrameWallClockTime);
-        MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
-        packetCount = pKvsRtpTransceiver->outboundStats.sent.packetsSent;
-        octetCount = pKvsRtpTransceiver->outboundStats.sent.bytesSent;
-        MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+        kvsRtpTransceiverGetOutboundStats(pKvsRtpTransceiver, &outboundStats);
+        packetCount = outboundStats.sent.packetsSent;
+        octetCount = outboundStats.sent.bytesSent;
         DLOGV("sender report %u %" PRIu64 " %" PRIu64 " : %u packets %u bytes", ssrc, ntpTime, rtpTime, packetCount, octetCount);
         packetLen = RTCP_PACKET_HEADER_LEN + 24;
 
@@ -728,6 +1068,7 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
 
     CHK_STATUS(hashTableCreateWithParams(CODEC_HASH_TABLE_BUCKET_COUNT, CODEC_HASH_TABLE_BUCKET_LENGTH, &pKvsPeerConnection->pCodecTable));
     CHK_STATUS(hashTableCreateWithParams(CODEC_HASH_TABLE_BUCKET_COUNT, CODEC_HASH_TABLE_BUCKET_LENGTH, &pKvsPeerConnection->pDataChannels));
+    CHK_STATUS(doubleListCreate(&pKvsPeerConnection->pClosedDataChannels));
     CHK_STATUS(hashTableCreateWithParams(RTX_HASH_TABLE_BUCKET_COUNT, RTX_HASH_TABLE_BUCKET_LENGTH, &pKvsPeerConnection->pRtxTable));
     CHK_STATUS(doubleListCreate(&(pKvsPeerConnection->pTransceivers)));
     CHK_STATUS(doubleListCreate(&(pKvsPeerConnection->pFakeTransceivers)));
@@ -735,11 +1076,22 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
 
     pKvsPeerConnection->pSrtpSessionLock = MUTEX_CREATE(TRUE);
     pKvsPeerConnection->peerConnectionObjLock = MUTEX_CREATE(FALSE);
+    pKvsPeerConnection->dataChannelsLock = MUTEX_CREATE(TRUE);
     pKvsPeerConnection->connectionState = RTC_PEER_CONNECTION_STATE_NONE;
     pKvsPeerConnection->MTU = pConfiguration->kvsRtcConfiguration.maximumTransmissionUnit == 0
         ? DEFAULT_MTU_SIZE
         : pConfiguration->kvsRtcConfiguration.maximumTransmissionUnit;
     ATOMIC_STORE_BOOL(&pKvsPeerConnection->sctpIsEnabled, FALSE);
+    pKvsPeerConnection->enableFlexFec = pConfiguration->kvsRtcConfiguration.enableFlexFec;
+    pKvsPeerConnection->flexFecPayloadType = pKvsPeerConnection->enableFlexFec ? (UINT8) DEFAULT_PAYLOAD_FLEXFEC : 0;
+    pKvsPeerConnection->opusRedDepth = MIN(pConfiguration->kvsRtcConfiguration.opusRedDepth, RED_MAX_REDUNDANCY_DEPTH);
+    pKvsPeerConnection->redPayloadType = pKvsPeerConnection->opusRedDepth > 0 ? (UINT8) DEFAULT_PAYLOAD_RED : 0;
+
+    if (pConfiguration->kvsRtcConfiguration.enableReceivePipeline) {
+        CHK_STATUS(createReceivePipeline(pConfiguration->kvsRtcConfiguration.receivePipelineQueueDepth,
+                                         pConfiguration->kvsRtcConfiguration.receivePipelineDropPolicy, processInboundPacket,
+                                         (UINT64) pKvsPeerConnection, &pKvsPeerConnection->pReceivePipeline));
+    }
 
     iceAgentCallbacks.customData = (UINT64) pKvsPeerConnection;
     iceAgentCallbacks.inboundPacketFn = onInboundPacket;
@@ -757,6 +1109,8 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
         pKvsPeerConnection->pTwccManager = (PTwccManager) MEMCALLOC(1, SIZEOF(TwccManager));
     }
 
+    CHK_STATUS(metricsRegistryAddPeerConnection(pKvsPeerConnection));
+
     *ppPeerConnection = (PRtcPeerConnection) pKvsPeerConnection;
 
 CleanUp:
@@ -800,10 +1154,18 @@ STATUS freePeerConnection(PRtcPeerConnection* ppPeerConnection)
     CHK(pKvsPeerConnection != NULL, retStatus);
 
     startTime = GETTIME();
+    // An export going on holds the registry until it is done with the peer connection
+    CHK_LOG_ERR(metricsRegistryRemovePeerConnection(pKvsPeerConnection));
+
     /* Shutdown IceAgent first so there is no more incoming packets which can cause
      * SCTP to be allocated again after SCTP is freed. */
     CHK_LOG_ERR(iceAgentShutdown(pKvsPeerConnection->pIceAgent));
 
+    // Stop media workers before anything they touch (SCTP, transceivers, SRTP) is freed
+    if (pKvsPeerConnection->pReceivePipeline != NULL) {
+        CHK_LOG_ERR(receivePipelineShutdown(pKvsPeerConnection->pReceivePipeline));
+    }
+
     // free timer queue first to remove liveness provided by timer
     if (IS_VALID_TIMER_QUEUE_HANDLE(pKvsPeerConnection->timerQueueHandle)) {
         timerQueueShutdown(pKvsPeerConnection->timerQueueHandle);
@@ -815,6 +1177,7 @@ STATUS freePeerConnection(PRtcPeerConnection* ppPeerConnection)
     CHK_LOG_ERR(freeSctpSession(&pKvsPeerConnection->pSctpSession));
 #endif
     CHK_LOG_ERR(freeIceAgent(&pKvsPeerConnection->pIceAgent));
+    CHK_LOG_ERR(freeReceivePipeline(&pKvsPeerConnection->pReceivePipeline));
 
     // free transceivers
     CHK_LOG_ERR(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
@@ -836,6 +1199,10 @@ STATUS freePeerConnection(PRtcPeerConnection* ppPeerConnection)
     // Free DataChannels
     CHK_LOG_ERR(hashTableIterateEntries(pKvsPeerConnection->pDataChannels, 0, freeHashEntry));
     CHK_LOG_ERR(hashTableFree(pKvsPeerConnection->pDataChannels));
+    if (pKvsPeerConnection->pClosedDataChannels != NULL) {
+        CHK_LOG_ERR(doubleListClear(pKvsPeerConnection->pClosedDataChannels, TRUE));
+        CHK_LOG_ERR(doubleListFree(pKvsPeerConnection->pClosedDataChannels));
+    }
 
     // free rest of structs
     CHK_LOG_ERR(freeSrtpSession(&pKvsPeerConnection->pSrtpSession));
@@ -845,6 +1212,7 @@ STATUS freePeerConnection(PRtcPeerConnection* ppPeerConnection)
     CHK_LOG_ERR(doubleListFree(pKvsPeerConnection->pAnswerTransceivers));
     CHK_LOG_ERR(hashTableFree(pKvsPeerConnection->pCodecTable));
     CHK_LOG_ERR(hashTableFree(pKvsPeerConnection->pRtxTable));
+    CHK_LOG_ERR(resetSessionDescription(&pKvsPeerConnection->remoteSessionDescription));
     if (IS_VALID_MUTEX_VALUE(pKvsPeerConnection->pSrtpSessionLock)) {
         MUTEX_FREE(pKvsPeerConnection->pSrtpSessionLock);
     }
@@ -853,6 +1221,10 @@ STATUS freePeerConnection(PRtcPeerConnection* ppPeerConnection)
         MUTEX_FREE(pKvsPeerConnection->peerConnectionObjLock);
     }
 
+    if (IS_VALID_MUTEX_VALUE(pKvsPeerConnection->dataChannelsLock)) {
+        MUTEX_FREE(pKvsPeerConnection->dataChannelsLock);
+    }
+
     if (IS_VALID_TIMER_QUEUE_HANDLE(pKvsPeerConnection->timerQueueHandle)) {
         timerQueueFree(&pKvsPeerConnection->timerQueueHandle);
     }
@@ -981,30 +1353,22 @@ STATUS peerConnectionGetLocalDescription(PRtcPeerConnection pRtcPeerConnection,
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PSessionDescription pSessionDescription = NULL;
     UINT32 serializeLen = 0;
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
 
     CHK(pRtcPeerConnection != NULL && pRtcSessionDescriptionInit != NULL, STATUS_NULL_ARG);
 
-    CHK(NULL != (pSessionDescription = (PSessionDescription) MEMCALLOC(1, SIZEOF(SessionDescription))), STATUS_NOT_ENOUGH_MEMORY);
-
     if (pKvsPeerConnection->isOffer) {
         pRtcSessionDescriptionInit->type = SDP_TYPE_OFFER;
     } else {
         pRtcSessionDescriptionInit->type = SDP_TYPE_ANSWER;
     }
 
-    CHK_STATUS(populateSessionDescription(pKvsPeerConnection, &(pKvsPeerConnection->remoteSessionDescription), pSessionDescription));
-    CHK_STATUS(serializeSessionDescription(pSessionDescription, NULL, &serializeLen));
-    CHK(serializeLen <= MAX_SESSION_DESCRIPTION_INIT_SDP_LEN, STATUS_NOT_ENOUGH_MEMORY);
-
-    CHK_STATUS(serializeSessionDescription(pSessionDescription, pRtcSessionDescriptionInit->sdp, &serializeLen));
+    serializeLen = MAX_SESSION_DESCRIPTION_INIT_SDP_LEN;
+    CHK_STATUS(serializeLocalSessionDescription(pKvsPeerConnection, pRtcSessionDescriptionInit->sdp, &serializeLen));
 
 CleanUp:
 
-    SAFE_MEMFREE(pSessionDescription);
-
     LEAVES();
     return retStatus;
 }
@@ -1013,27 +1377,18 @@ STATUS peerConnectionGetCurrentLocalDescription(PRtcPeerConnection pRtcPeerConne
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PSessionDescription pSessionDescription = NULL;
     UINT32 serializeLen = 0;
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
 
     CHK(pRtcPeerConnection != NULL && pRtcSessionDescriptionInit != NULL, STATUS_NULL_ARG);
     // do nothing if remote session description hasn't been received
-    CHK(pKvsPeerConnection->remoteSessionDescription.sessionName[0] != '\0', retStatus);
-
-    CHK(NULL != (pSessionDescription = (PSessionDescription) MEMCALLOC(1, SIZEOF(SessionDescription))), STATUS_NOT_ENOUGH_MEMORY);
-
-    CHK_STATUS(populateSessionDescription(pKvsPeerConnection, &(pKvsPeerConnection->remoteSessionDescription), pSessionDescription));
-
-    CHK_STATUS(serializeSessionDescription(pSessionDescription, NULL, &serializeLen));
-    CHK(serializeLen <= MAX_SESSION_DESCRIPTION_INIT_SDP_LEN, STATUS_NOT_ENOUGH_MEMORY);
+    CHK(!IS_EMPTY_SDP_FIELD(pKvsPeerConnection->remoteSessionDescription.sessionName), retStatus);
 
-    CHK_STATUS(serializeSessionDescription(pSessionDescription, pRtcSessionDescriptionInit->sdp, &serializeLen));
+    serializeLen = MAX_SESSION_DESCRIPTION_INIT_SDP_LEN;
+    CHK_STATUS(serializeLocalSessionDescription(pKvsPeerConnection, pRtcSessionDescriptionInit->sdp, &serializeLen));
 
 CleanUp:
 
-    SAFE_MEMFREE(pSessionDescription);
-
     LEAVES();
     return retStatus;
 }
@@ -1067,7 +1422,7 @@ STATUS setRemoteDescription(PRtcPeerConnection pPeerConnection, PRtcSessionDescr
 
     CHK(pSessionDescriptionInit != NULL, STATUS_NULL_ARG);
 
-    MEMSET(pSessionDescription, 0x00, SIZEOF(SessionDescription));
+    CHK_STATUS(resetSessionDescription(pSessionDescription));
     pKvsPeerConnection->dtlsIsServer = FALSE;
     /* Assume cant trickle at first */
     NULLABLE_SET_VALUE(pKvsPeerConnection->canTrickleIce, FALSE);
@@ -1149,6 +1504,8 @@ STATUS setRemoteDescription(PRtcPeerConnection pPeerConnection, PRtcSessionDescr
     }
     CHK_STATUS(setTransceiverPayloadTypes(pKvsPeerConnection->pCodecTable, pKvsPeerConnection->pRtxTable, pKvsPeerConnection->pTransceivers));
     CHK_STATUS(setReceiversSsrc(pSessionDescription, pKvsPeerConnection->pTransceivers));
+    CHK_STATUS(setFlexFecFromRemoteDescription(pKvsPeerConnection, pSessionDescription));
+    CHK_STATUS(setRedFromRemoteDescription(pKvsPeerConnection, pSessionDescription));
 
     if (NULL != GETENV(DEBUG_LOG_SDP)) {
         DLOGD("REMOTE_SDP:%s\n", pSessionDescriptionInit->sdp);
@@ -1164,15 +1521,12 @@ STATUS createOffer(PRtcPeerConnection pPeerConnection, PRtcSessionDescriptionIni
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PSessionDescription pSessionDescription = NULL;
     UINT32 serializeLen = 0;
 
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pPeerConnection;
 
     CHK(pKvsPeerConnection != NULL && pSessionDescriptionInit != NULL, STATUS_NULL_ARG);
 
-    // SessionDescription is large enough structure to not define on the stack and use heap memory
-    CHK(NULL != (pSessionDescription = (PSessionDescription) MEMCALLOC(1, SIZEOF(SessionDescription))), STATUS_NOT_ENOUGH_MEMORY);
     pSessionDescriptionInit->type = SDP_TYPE_OFFER;
     pKvsPeerConnection->isOffer = TRUE;
 
@@ -1182,11 +1536,8 @@ STATUS createOffer(PRtcPeerConnection pPeerConnection, PRtcSessionDescriptionIni
 
     CHK_STATUS(setPayloadTypesForOffer(pKvsPeerConnection->pCodecTable));
 
-    CHK_STATUS(populateSessionDescription(pKvsPeerConnection, &(pKvsPeerConnection->remoteSessionDescription), pSessionDescription));
-    CHK_STATUS(serializeSessionDescription(pSessionDescription, NULL, &serializeLen));
-    CHK(serializeLen <= MAX_SESSION_DESCRIPTION_INIT_SDP_LEN, STATUS_NOT_ENOUGH_MEMORY);
-
-    CHK_STATUS(serializeSessionDescription(pSessionDescription, pSessionDescriptionInit->sdp, &serializeLen));
+    serializeLen = MAX_SESSION_DESCRIPTION_INIT_SDP_LEN;
+    CHK_STATUS(serializeLocalSessionDescription(pKvsPeerConnection, pSessionDescriptionInit->sdp, &serializeLen));
 
     // If embedded SDK acts as the viewer
     if (NULL != GETENV(DEBUG_LOG_SDP)) {
@@ -1194,8 +1545,6 @@ STATUS createOffer(PRtcPeerConnection pPeerConnection, PRtcSessionDescriptionIni
     }
 CleanUp:
 
-    SAFE_MEMFREE(pSessionDescription);
-
     LEAVES();
     return retStatus;
 }
@@ -1208,7 +1557,8 @@ STATUS createAnswer(PRtcPeerConnection pPeerConnection, PRtcSessionDescriptionIn
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pPeerConnection;
 
     CHK(pKvsPeerConnection != NULL && pSessionDescriptionInit != NULL, STATUS_NULL_ARG);
-    CHK(pKvsPeerConnection->remoteSessionDescription.sessionName[0] != '\0', STATUS_PEERCONNECTION_CREATE_ANSWER_WITHOUT_REMOTE_DESCRIPTION);
+    CHK(!IS_EMPTY_SDP_FIELD(pKvsPeerConnection->remoteSessionDescription.sessionName),
+        STATUS_PEERCONNECTION_CREATE_ANSWER_WITHOUT_REMOTE_DESCRIPTION);
 
     pSessionDescriptionInit->type = SDP_TYPE_ANSWER;
     pKvsPeerConnection->isOffer = FALSE;
@@ -1287,11 +1637,26 @@ STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack p
             clockRate = VIDEO_CLOCKRATE;
             break;
 
+        case RTC_CODEC_H265:
+            depayFunc = depayH265FromRtpPayload;
+            clockRate = VIDEO_CLOCKRATE;
+            break;
+
+        case RTC_CODEC_AV1:
+            depayFunc = depayAV1FromRtpPayload;
+            clockRate = VIDEO_CLOCKRATE;
+            break;
+
         case RTC_CODEC_VP8:
             depayFunc = depayVP8FromRtpPayload;
             clockRate = VIDEO_CLOCKRATE;
             break;
 
+        case RTC_CODEC_VP9:
+            depayFunc = depayVP9FromRtpPayload;
+            clockRate = VIDEO_CLOCKRATE;
+            break;
+
         default:
             CHK(FALSE, STATUS_NOT_IMPLEMENTED);
     }
@@ -1457,6 +1822,13 @@ STATUS deinitKvsWebRtc(VOID)
     deinitSctpSession();
 #endif
 
+    deinitReceivePipelineWorkers();
+    deinitSdpTemplateCache();
+    deinitMetricsRegistry();
+    deinitSignalingMetricsRegistry();
+    deinitSignalingFileCache();
+    deinitTracer();
+
     srtp_shutdown();
 
     ATOMIC_STORE_BOOL(&gKvsWebRtcInitialized, FALSE);
@@ -1477,7 +1849,8 @@ STATUS twccManagerOnPacketSent(PKvsPeerConnection pc, PRtpPacket pRtpPacket)
     BOOL isEmpty = FALSE;
     INT64 firstTimeKvs, lastLocalTimeKvs, ageOfOldest;
     CHK(pc != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
-    CHK(pc->onSenderBandwidthEstimation != NULL && pc->pTwccManager != NULL, STATUS_SUCCESS);
+    // Feedback is only evaluated for the bandwidth estimation callback and the FlexFEC repair rate
+    CHK(pc->pTwccManager != NULL && (pc->onSenderBandwidthEstimation != NULL || pc->enableFlexFec), STATUS_SUCCESS);
     CHK(TWCC_EXT_PROFILE == pRtpPacket->header.extensionProfile, STATUS_SUCCESS);
 
     MUTEX_LOCK(pc->twccLock);
@@ -1534,6 +1907,32 @@ CleanUp:
     return retStatus;
 }
 
+STATUS peerConnectionGetLatencyMetrics(PRtcPeerConnection pPeerConnection, PLatencyMetrics pLatencyMetrics)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pPeerConnection;
+    PLatencyHistogramStats pStageLatency;
+    CHK(pKvsPeerConnection != NULL && pLatencyMetrics != NULL, STATUS_NULL_ARG);
+
+    if (pLatencyMetrics->version > LATENCY_METRICS_CURRENT_VERSION) {
+        DLOGW("Latency metrics object version invalid..setting to highest default version %d", LATENCY_METRICS_CURRENT_VERSION);
+        pLatencyMetrics->version = LATENCY_METRICS_CURRENT_VERSION;
+    }
+
+    MEMSET(pLatencyMetrics->stageLatency, 0x00, SIZEOF(pLatencyMetrics->stageLatency));
+    pStageLatency = pLatencyMetrics->stageLatency;
+    CHK_STATUS(latencyHistogramGetStats(&pKvsPeerConnection->dtlsHandshakeLatency, &pStageLatency[LATENCY_STAGE_DTLS_HANDSHAKE]));
+    CHK_STATUS(latencyHistogramGetStats(&pKvsPeerConnection->frameAssemblyLatency, &pStageLatency[LATENCY_STAGE_FRAME_ASSEMBLY]));
+    CHK_STATUS(latencyHistogramGetStats(&pKvsPeerConnection->writeFrameLatency, &pStageLatency[LATENCY_STAGE_WRITE_FRAME]));
+    CHK_STATUS(latencyHistogramGetStats(&pKvsPeerConnection->srtpLatency, &pStageLatency[LATENCY_STAGE_SRTP]));
+    if (pKvsPeerConnection->pIceAgent != NULL) {
+        CHK_STATUS(latencyHistogramGetStats(&pKvsPeerConnection->pIceAgent->checkRoundTripTimeLatency, &pStageLatency[LATENCY_STAGE_ICE_CHECK_RTT]));
+    }
+
+CleanUp:
+    return retStatus;
+}
+
 STATUS iceAgentGetMetrics(PRtcPeerConnection pPeerConnection, PKvsIceAgentMetrics pKvsIceAgentMetrics)
 {
     STATUS retStatus = STATUS_SUCCESS;
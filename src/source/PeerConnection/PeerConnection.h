@@ -35,12 +35,19 @@ extern "C" {
 #define DATA_CHANNEL_HASH_TABLE_BUCKET_COUNT  200
 #define DATA_CHANNEL_HASH_TABLE_BUCKET_LENGTH 2
 
+// IPv6 and UDP headers, what the MTU leaves room for on any path
+#define PEER_CONNECTION_IP_UDP_OVERHEAD (40 + 8)
+
 // Environment variable to display SDPs
 #define DEBUG_LOG_SDP ((PCHAR) "DEBUG_LOG_SDP")
 
 typedef enum {
     RTC_RTX_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE = 1,
     RTC_RTX_CODEC_VP8 = 2,
+    // Same values as RTC_CODEC_H265, RTC_CODEC_AV1 and RTC_CODEC_VP9 as setTransceiverPayloadTypes looks the rtx payload type up by the track codec
+    RTC_RTX_CODEC_H265 = 7,
+    RTC_RTX_CODEC_AV1 = 8,
+    RTC_RTX_CODEC_VP9 = 9,
 } RTX_CODEC;
 
 typedef struct {
@@ -74,6 +81,12 @@ typedef struct {
     UINT32 padding;
     volatile SIZE_T transportWideSequenceNumber;
 
+    // Latency of the stages going through the peer connection, ICE check round trips are recorded by the ICE agent
+    LatencyHistogram dtlsHandshakeLatency;
+    LatencyHistogram frameAssemblyLatency;
+    LatencyHistogram writeFrameLatency;
+    LatencyHistogram srtpLatency;
+
     PIceAgent pIceAgent;
     PDtlsSession pDtlsSession;
     BOOL dtlsIsServer;
@@ -83,6 +96,9 @@ typedef struct {
 
     PSctpSession pSctpSession;
 
+    // Only set when KvsRtcConfiguration.enableReceivePipeline is on
+    PReceivePipeline pReceivePipeline;
+
     SessionDescription remoteSessionDescription;
     PDoubleList pTransceivers;
     PDoubleList pFakeTransceivers;
@@ -115,8 +131,11 @@ typedef struct {
     // When answering this is populated from the remote offer
     PHashTable pRtxTable;
 
-    // DataChannels keyed by streamId
+    // DataChannels keyed by streamId, the lock is held to look them up, add and remove them
+    MUTEX dataChannelsLock;
     PHashTable pDataChannels;
+    // Closed DataChannels, the application can still hold them so they are freed with the PeerConnection
+    PDoubleList pClosedDataChannels;
 
     UINT64 onDataChannelCustomData;
     RtcOnDataChannel onDataChannel;
@@ -132,6 +151,14 @@ typedef struct {
 
     NullableBool canTrickleIce;
 
+    // https://www.rfc-editor.org/rfc/rfc8627, the payload type is cleared when the remote does not support it
+    BOOL enableFlexFec;
+    UINT8 flexFecPayloadType;
+
+    // https://www.rfc-editor.org/rfc/rfc2198 for Opus, the payload type is cleared when the remote does not support it
+    UINT32 opusRedDepth;
+    UINT8 redPayloadType;
+
     // congestion control
     // https://tools.ietf.org/html/draft-holmer-rmcat-transport-wide-cc-extensions-01
     UINT16 twccExtId;
@@ -153,15 +180,22 @@ typedef struct {
 STATUS onFrameReadyFunc(UINT64, UINT16, UINT16, UINT32);
 STATUS onFrameDroppedFunc(UINT64, UINT16, UINT16, UINT32);
 VOID onSctpSessionOutboundPacket(UINT64, PBYTE, UINT32);
-VOID onSctpSessionDataChannelMessage(UINT64, UINT32, BOOL, PBYTE, UINT32);
+BOOL onSctpSessionDataChannelMessage(UINT64, UINT32, BOOL, PBYTE, UINT32);
 VOID onSctpSessionDataChannelOpen(UINT64, UINT32, PBYTE, UINT32);
+VOID onSctpSessionDataChannelBufferDrained(UINT64, UINT32, UINT32);
+VOID onSctpSessionDataChannelAck(UINT64, UINT32);
+VOID onSctpSessionDataChannelClose(UINT64, UINT32);
 
 STATUS sendPacketToRtpReceiver(PKvsPeerConnection, PBYTE, UINT32);
+STATUS onFlexFecRecoveredPacket(UINT64, PBYTE, UINT32);
+STATUS unwrapRedPacket(PJitterBuffer, PRedDecoder, PRtpPacket, PUINT64);
 STATUS changePeerConnectionState(PKvsPeerConnection, RTC_PEER_CONNECTION_STATE);
 STATUS twccManagerOnPacketSent(PKvsPeerConnection, PRtpPacket);
 
 // visible for testing only
 VOID onIceConnectionStateChange(UINT64, UINT64);
+VOID onInboundPacket(UINT64, PBYTE, UINT32);
+VOID processInboundPacket(UINT64, PBYTE, UINT32);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,311 @@
+#define LOG_CLASS "ReceivePipeline"
+
+#include "../Include_i.h"
+
+// Media worker pool shared by all receive pipelines, created on first use
+static volatile SIZE_T gReceivePipelineWorkers = (SIZE_T) NULL;
+
+static STATUS getReceivePipelineWorkers(PThreadpool* ppThreadpool)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PThreadpool pThreadpool = (PThreadpool) ATOMIC_LOAD(&gReceivePipelineWorkers);
+    SIZE_T expected = (SIZE_T) NULL;
+
+    if (pThreadpool == NULL) {
+        CHK_STATUS(threadpoolCreate(&pThreadpool, RECEIVE_PIPELINE_MIN_WORKER_THREADS, RECEIVE_PIPELINE_MAX_WORKER_THREADS));
+        // Another pipeline could have raced us to create the pool, keep whichever got published first
+        if (!ATOMIC_COMPARE_EXCHANGE(&gReceivePipelineWorkers, &expected, (SIZE_T) pThreadpool)) {
+            threadpoolFree(pThreadpool);
+            pThreadpool = (PThreadpool) expected;
+        }
+    }
+
+    *ppThreadpool = pThreadpool;
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * All receive pipelines must have been freed before calling this
+ */
+STATUS deinitReceivePipelineWorkers(VOID)
+{
+    PThreadpool pThreadpool = (PThreadpool) ATOMIC_EXCHANGE(&gReceivePipelineWorkers, (SIZE_T) NULL);
+
+    if (pThreadpool != NULL) {
+        threadpoolFree(pThreadpool);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+// SRTP media packet as opposed to DTLS or SRTCP, see the demux in processInboundPacket
+static BOOL isMediaPacket(PReceivePipelineSlot pSlot)
+{
+    return pSlot->length > 1 && pSlot->pBuffer[0] > 127 && pSlot->pBuffer[0] < 192 && (pSlot->pBuffer[1] < 192 || pSlot->pBuffer[1] > 223);
+}
+
+STATUS createReceivePipeline(UINT32 queueDepth, RTC_RECEIVE_PIPELINE_DROP_POLICY dropPolicy, ReceivePipelineProcessFunc processFn, UINT64 customData,
+                             PReceivePipeline* ppReceivePipeline)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PReceivePipeline pReceivePipeline = NULL;
+    PThreadpool pThreadpool = NULL;
+    UINT32 roundedDepth = 1, capacity;
+
+    CHK(processFn != NULL && ppReceivePipeline != NULL, STATUS_NULL_ARG);
+    CHK(queueDepth <= MAX_RECEIVE_PIPELINE_QUEUE_DEPTH, STATUS_INVALID_ARG);
+    CHK(dropPolicy == RTC_RECEIVE_PIPELINE_DROP_NEWEST || dropPolicy == RTC_RECEIVE_PIPELINE_DROP_OLDEST, STATUS_INVALID_ARG);
+
+    if (queueDepth == 0) {
+        queueDepth = DEFAULT_RECEIVE_PIPELINE_QUEUE_DEPTH;
+    }
+
+    // Power of two so the ring index is a mask instead of a modulo
+    while (roundedDepth < queueDepth) {
+        roundedDepth <<= 1;
+    }
+
+    // Dropping oldest is done by the consumer, which owns head. Give the producer headroom so it can keep
+    // enqueueing while the consumer trims the backlog back down to queueDepth.
+    capacity = dropPolicy == RTC_RECEIVE_PIPELINE_DROP_OLDEST ? roundedDepth << 1 : roundedDepth;
+
+    CHK_STATUS(getReceivePipelineWorkers(&pThreadpool));
+
+    pReceivePipeline = (PReceivePipeline) MEMCALLOC(1, SIZEOF(ReceivePipeline) + capacity * SIZEOF(ReceivePipelineSlot));
+    CHK(pReceivePipeline != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    ATOMIC_STORE(&pReceivePipeline->head, 0);
+    ATOMIC_STORE(&pReceivePipeline->tail, 0);
+    ATOMIC_STORE(&pReceivePipeline->activeDrains, 0);
+    ATOMIC_STORE_BOOL(&pReceivePipeline->drainScheduled, FALSE);
+    ATOMIC_STORE_BOOL(&pReceivePipeline->terminated, FALSE);
+
+    pReceivePipeline->dropPolicy = dropPolicy;
+    pReceivePipeline->queueDepth = roundedDepth;
+    pReceivePipeline->capacity = capacity;
+    pReceivePipeline->mask = capacity - 1;
+    // Slot buffers are allocated lazily by the producer the first time the ring wraps onto them
+    pReceivePipeline->pSlots = (PReceivePipelineSlot) (pReceivePipeline + 1);
+    pReceivePipeline->processFn = processFn;
+    pReceivePipeline->customData = customData;
+    pReceivePipeline->pThreadpool = pThreadpool;
+
+    pReceivePipeline->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pReceivePipeline->lock), STATUS_INVALID_OPERATION);
+    pReceivePipeline->drainCompletedCvar = CVAR_CREATE();
+    CHK(IS_VALID_CVAR_VALUE(pReceivePipeline->drainCompletedCvar), STATUS_INVALID_OPERATION);
+
+    *ppReceivePipeline = pReceivePipeline;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freeReceivePipeline(&pReceivePipeline);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS receivePipelineShutdown(PReceivePipeline pReceivePipeline)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+
+    CHK(pReceivePipeline != NULL, STATUS_NULL_ARG);
+
+    ATOMIC_STORE_BOOL(&pReceivePipeline->terminated, TRUE);
+
+    // Wait for an in-flight drain to notice termination. It stops after the packet it is currently processing.
+    MUTEX_LOCK(pReceivePipeline->lock);
+    locked = TRUE;
+    while (ATOMIC_LOAD(&pReceivePipeline->activeDrains) > 0) {
+        CHK_STATUS(CVAR_WAIT(pReceivePipeline->drainCompletedCvar, pReceivePipeline->lock, INFINITE_TIME_VALUE));
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pReceivePipeline->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeReceivePipeline(PReceivePipeline* ppReceivePipeline)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PReceivePipeline pReceivePipeline = NULL;
+    UINT32 i;
+
+    CHK(ppReceivePipeline != NULL, STATUS_NULL_ARG);
+    pReceivePipeline = *ppReceivePipeline;
+    CHK(pReceivePipeline != NULL, retStatus);
+
+    if (IS_VALID_MUTEX_VALUE(pReceivePipeline->lock) && IS_VALID_CVAR_VALUE(pReceivePipeline->drainCompletedCvar)) {
+        CHK_LOG_ERR(receivePipelineShutdown(pReceivePipeline));
+    }
+
+    for (i = 0; i < pReceivePipeline->capacity; i++) {
+        SAFE_MEMFREE(pReceivePipeline->pSlots[i].pBuffer);
+    }
+
+    if (IS_VALID_CVAR_VALUE(pReceivePipeline->drainCompletedCvar)) {
+        CVAR_FREE(pReceivePipeline->drainCompletedCvar);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pReceivePipeline->lock)) {
+        MUTEX_FREE(pReceivePipeline->lock);
+    }
+
+    SAFE_MEMFREE(*ppReceivePipeline);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+static VOID receivePipelineDrainCompleted(PReceivePipeline pReceivePipeline)
+{
+    // Nothing may touch the pipeline after the unlock, receivePipelineShutdown could free it right away
+    MUTEX_LOCK(pReceivePipeline->lock);
+    ATOMIC_DECREMENT(&pReceivePipeline->activeDrains);
+    CVAR_BROADCAST(pReceivePipeline->drainCompletedCvar);
+    MUTEX_UNLOCK(pReceivePipeline->lock);
+}
+
+// Process up to RECEIVE_PIPELINE_MAX_BATCH_SIZE packets. Returns whether packets are still pending.
+static BOOL receivePipelineDrainBatch(PReceivePipeline pReceivePipeline)
+{
+    SIZE_T head = ATOMIC_LOAD(&pReceivePipeline->head), tail = ATOMIC_LOAD(&pReceivePipeline->tail);
+    PReceivePipelineSlot pSlot;
+    UINT32 count;
+
+    for (count = 0; head != tail && count < RECEIVE_PIPELINE_MAX_BATCH_SIZE && !ATOMIC_LOAD_BOOL(&pReceivePipeline->terminated); count++) {
+        pSlot = &pReceivePipeline->pSlots[head & pReceivePipeline->mask];
+
+        if (pReceivePipeline->dropPolicy == RTC_RECEIVE_PIPELINE_DROP_OLDEST && tail - head > pReceivePipeline->queueDepth &&
+            isMediaPacket(pSlot)) {
+            ATOMIC_INCREMENT(&pReceivePipeline->packetsDroppedOldest);
+        } else {
+            TRACE_INSTANT(TRACE_POINT_RECEIVE_DEQUEUE, pSlot->length);
+            pReceivePipeline->processFn(pReceivePipeline->customData, pSlot->pBuffer, pSlot->length);
+            ATOMIC_INCREMENT(&pReceivePipeline->packetsProcessed);
+        }
+
+        // Hand the slot back to the producer
+        ATOMIC_STORE(&pReceivePipeline->head, ++head);
+        tail = ATOMIC_LOAD(&pReceivePipeline->tail);
+    }
+
+    return head != tail;
+}
+
+static PVOID receivePipelineDrainRoutine(PVOID args)
+{
+    PReceivePipeline pReceivePipeline = (PReceivePipeline) args;
+
+    while (TRUE) {
+        if (receivePipelineDrainBatch(pReceivePipeline) && !ATOMIC_LOAD_BOOL(&pReceivePipeline->terminated)) {
+            // Yield the worker to other peer connections. The new task inherits drainScheduled and activeDrains.
+            if (STATUS_SUCCEEDED(threadpoolPush(pReceivePipeline->pThreadpool, receivePipelineDrainRoutine, (PVOID) pReceivePipeline))) {
+                return NULL;
+            }
+
+            continue;
+        }
+
+        ATOMIC_STORE_BOOL(&pReceivePipeline->drainScheduled, FALSE);
+
+        // The producer may have enqueued after the last batch but before drainScheduled was cleared. If it has not
+        // scheduled a new drain in the meantime we take the work back, otherwise the new drain will pick it up.
+        if (ATOMIC_LOAD_BOOL(&pReceivePipeline->terminated) || ATOMIC_LOAD(&pReceivePipeline->head) == ATOMIC_LOAD(&pReceivePipeline->tail) ||
+            ATOMIC_EXCHANGE_BOOL(&pReceivePipeline->drainScheduled, TRUE)) {
+            break;
+        }
+    }
+
+    receivePipelineDrainCompleted(pReceivePipeline);
+
+    return NULL;
+}
+
+/*
+ * Only ever called from a single thread, the one reading the socket
+ */
+STATUS receivePipelineEnqueue(PReceivePipeline pReceivePipeline, PBYTE pBuffer, UINT32 bufferLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    SIZE_T head, tail, backlog;
+    PReceivePipelineSlot pSlot;
+    PBYTE pNewBuffer;
+
+    CHK(pReceivePipeline != NULL && pBuffer != NULL, STATUS_NULL_ARG);
+    CHK(!ATOMIC_LOAD_BOOL(&pReceivePipeline->terminated), retStatus);
+
+    tail = ATOMIC_LOAD(&pReceivePipeline->tail);
+    head = ATOMIC_LOAD(&pReceivePipeline->head);
+    backlog = tail - head;
+
+    if (backlog >= pReceivePipeline->capacity) {
+        ATOMIC_INCREMENT(&pReceivePipeline->packetsDroppedNewest);
+        CHK(FALSE, STATUS_PEERCONNECTION_RECEIVE_QUEUE_FULL);
+    }
+
+    pSlot = &pReceivePipeline->pSlots[tail & pReceivePipeline->mask];
+    if (pSlot->capacity < bufferLen) {
+        pNewBuffer = (PBYTE) MEMREALLOC(pSlot->pBuffer, MAX(bufferLen, RECEIVE_PIPELINE_SLOT_SIZE));
+        CHK(pNewBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pSlot->pBuffer = pNewBuffer;
+        pSlot->capacity = MAX(bufferLen, RECEIVE_PIPELINE_SLOT_SIZE);
+    }
+
+    MEMCPY(pSlot->pBuffer, pBuffer, bufferLen);
+    pSlot->length = bufferLen;
+
+    // Publish the slot to the consumer
+    ATOMIC_STORE(&pReceivePipeline->tail, tail + 1);
+    ATOMIC_INCREMENT(&pReceivePipeline->packetsEnqueued);
+    if (backlog + 1 > ATOMIC_LOAD(&pReceivePipeline->highWaterMark)) {
+        ATOMIC_STORE(&pReceivePipeline->highWaterMark, backlog + 1);
+    }
+
+    if (!ATOMIC_EXCHANGE_BOOL(&pReceivePipeline->drainScheduled, TRUE)) {
+        ATOMIC_INCREMENT(&pReceivePipeline->activeDrains);
+        if (STATUS_FAILED(retStatus = threadpoolPush(pReceivePipeline->pThreadpool, receivePipelineDrainRoutine, (PVOID) pReceivePipeline))) {
+            // The packet stays queued and is picked up by the next successful schedule
+            ATOMIC_STORE_BOOL(&pReceivePipeline->drainScheduled, FALSE);
+            receivePipelineDrainCompleted(pReceivePipeline);
+            CHK(FALSE, retStatus);
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS receivePipelineGetStats(PReceivePipeline pReceivePipeline, PReceivePipelineStats pStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pReceivePipeline != NULL && pStats != NULL, STATUS_NULL_ARG);
+
+    pStats->packetsEnqueued = ATOMIC_LOAD(&pReceivePipeline->packetsEnqueued);
+    pStats->packetsProcessed = ATOMIC_LOAD(&pReceivePipeline->packetsProcessed);
+    pStats->packetsDroppedNewest = ATOMIC_LOAD(&pReceivePipeline->packetsDroppedNewest);
+    pStats->packetsDroppedOldest = ATOMIC_LOAD(&pReceivePipeline->packetsDroppedOldest);
+    pStats->highWaterMark = (UINT32) ATOMIC_LOAD(&pReceivePipeline->highWaterMark);
+
+CleanUp:
+
+    return retStatus;
+}
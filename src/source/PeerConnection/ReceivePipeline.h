@@ -0,0 +1,92 @@
+/*******************************************
+ReceivePipeline internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_RECEIVEPIPELINE__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_RECEIVEPIPELINE__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEFAULT_RECEIVE_PIPELINE_QUEUE_DEPTH 512
+#define MAX_RECEIVE_PIPELINE_QUEUE_DEPTH     65536
+
+// Slots are preallocated with this capacity and grown by the producer on demand
+#define RECEIVE_PIPELINE_SLOT_SIZE 1500
+
+// Max packets a worker processes for a single pipeline before yielding the worker to other peer connections
+#define RECEIVE_PIPELINE_MAX_BATCH_SIZE 64
+
+#define RECEIVE_PIPELINE_MIN_WORKER_THREADS 1
+#define RECEIVE_PIPELINE_MAX_WORKER_THREADS 4
+
+/**
+ * Called on a media worker thread for every dequeued packet. The buffer is only valid for the duration of the call
+ * and may be modified in place (e.g. decrypted).
+ */
+typedef VOID (*ReceivePipelineProcessFunc)(UINT64, PBYTE, UINT32);
+
+typedef struct {
+    UINT32 length;
+    UINT32 capacity;
+    PBYTE pBuffer;
+} ReceivePipelineSlot, *PReceivePipelineSlot;
+
+typedef struct {
+    UINT64 packetsEnqueued;
+    UINT64 packetsProcessed;
+    UINT64 packetsDroppedNewest;
+    UINT64 packetsDroppedOldest;
+    UINT32 highWaterMark;
+} ReceivePipelineStats, *PReceivePipelineStats;
+
+/*
+ * Bounded single producer single consumer ring. The network thread is the only producer and owns tail,
+ * the worker currently draining the pipeline is the only consumer and owns head. At most one drain task
+ * per pipeline is ever scheduled on the worker pool so per peer connection ordering is preserved.
+ */
+typedef struct {
+    // atomics first, see KvsPeerConnection for the alignment rationale
+    volatile SIZE_T head;
+    volatile SIZE_T tail;
+    volatile SIZE_T activeDrains;
+    volatile ATOMIC_BOOL drainScheduled;
+    volatile ATOMIC_BOOL terminated;
+
+    // Counters have a single writer each, they are atomics only so stats can be read from any thread
+    volatile SIZE_T packetsEnqueued;
+    volatile SIZE_T packetsDroppedNewest;
+    volatile SIZE_T highWaterMark;
+    volatile SIZE_T packetsProcessed;
+    volatile SIZE_T packetsDroppedOldest;
+
+    RTC_RECEIVE_PIPELINE_DROP_POLICY dropPolicy;
+
+    // Backlog the consumer trims to when dropping oldest. Ring capacity is twice that for headroom
+    UINT32 queueDepth;
+    UINT32 capacity;
+    UINT32 mask;
+    PReceivePipelineSlot pSlots;
+
+    ReceivePipelineProcessFunc processFn;
+    UINT64 customData;
+
+    PThreadpool pThreadpool;
+
+    MUTEX lock;
+    CVAR drainCompletedCvar;
+} ReceivePipeline, *PReceivePipeline;
+
+STATUS createReceivePipeline(UINT32, RTC_RECEIVE_PIPELINE_DROP_POLICY, ReceivePipelineProcessFunc, UINT64, PReceivePipeline*);
+STATUS freeReceivePipeline(PReceivePipeline*);
+STATUS receivePipelineEnqueue(PReceivePipeline, PBYTE, UINT32);
+STATUS receivePipelineShutdown(PReceivePipeline);
+STATUS receivePipelineGetStats(PReceivePipeline, PReceivePipelineStats);
+STATUS deinitReceivePipelineWorkers(VOID);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_RECEIVEPIPELINE__ */
@@ -6,12 +6,19 @@ STATUS createRetransmitter(UINT32 seqNumListLen, UINT32 validIndexListLen, PRetr
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PRetransmitter pRetransmitter = MEMALLOC(SIZEOF(Retransmitter) + SIZEOF(UINT16) * seqNumListLen + SIZEOF(UINT64) * validIndexListLen);
-    CHK(pRetransmitter != NULL, STATUS_NOT_ENOUGH_MEMORY);
-    pRetransmitter->sequenceNumberList = (PUINT16) (pRetransmitter + 1);
-    pRetransmitter->seqNumListLen = seqNumListLen;
-    pRetransmitter->validIndexList = (PUINT64) (pRetransmitter->sequenceNumberList + seqNumListLen);
+    PRetransmitter pRetransmitter = NULL;
+    // Lists go from the widest element to the narrowest so each one stays aligned
+    UINT32 allocSize = SIZEOF(Retransmitter) + (SIZEOF(UINT64) + SIZEOF(PRtpPacket) + SIZEOF(PBYTE) + SIZEOF(UINT32)) * validIndexListLen +
+        SIZEOF(UINT16) * seqNumListLen;
+
+    CHK(NULL != (pRetransmitter = (PRetransmitter) MEMCALLOC(1, allocSize)), STATUS_NOT_ENOUGH_MEMORY);
+    pRetransmitter->validIndexList = (PUINT64) (pRetransmitter + 1);
     pRetransmitter->validIndexListLen = validIndexListLen;
+    pRetransmitter->pPacketList = (PRtpPacket*) (pRetransmitter->validIndexList + validIndexListLen);
+    pRetransmitter->pSendBufferList = (PBYTE*) (pRetransmitter->pPacketList + validIndexListLen);
+    pRetransmitter->pSendLengthList = (PUINT32) (pRetransmitter->pSendBufferList + validIndexListLen);
+    pRetransmitter->sequenceNumberList = (PUINT16) (pRetransmitter->pSendLengthList + validIndexListLen);
+    pRetransmitter->seqNumListLen = seqNumListLen;
 
 CleanUp:
     if (STATUS_FAILED(retStatus) && pRetransmitter != NULL) {
@@ -32,6 +39,9 @@ STATUS freeRetransmitter(PRetransmitter* ppRetransmitter)
     STATUS retStatus = STATUS_SUCCESS;
 
     CHK(ppRetransmitter != NULL, STATUS_NULL_ARG);
+    if (*ppRetransmitter != NULL) {
+        SAFE_MEMFREE((*ppRetransmitter)->pRtxBuffer);
+    }
     SAFE_MEMFREE(*ppRetransmitter);
 CleanUp:
     CHK_LOG_ERR(retStatus);
@@ -46,12 +56,16 @@ STATUS resendPacketOnNack(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerCo
 
     STATUS retStatus = STATUS_SUCCESS;
     UINT32 senderSsrc = 0, receiverSsrc = 0;
-    UINT32 filledLen = 0, validIndexListLen = 0;
+    UINT32 filledLen = 0, validIndexListLen = 0, packetCount = 0, rtxBufferSize = 0, packetLen;
     PKvsRtpTransceiver pSenderTranceiver = NULL;
     UINT64 item, index;
+    UINT16 sequenceNumber;
     STATUS tmpStatus = STATUS_SUCCESS;
-    PRtpPacket pRtpPacket = NULL, pRtxRtpPacket = NULL;
+    PRtpPacket pRtpPacket = NULL;
     PRetransmitter pRetransmitter = NULL;
+    PRollingBuffer pRollingBuffer = NULL;
+    PBYTE pCurPtr;
+    BOOL isRtx, locked = FALSE;
     // stats
     UINT32 retransmittedPacketsSent = 0, retransmittedBytesSent = 0, nackCount = 0;
 
@@ -78,64 +92,108 @@ STATUS resendPacketOnNack(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerCo
     validIndexListLen = pRetransmitter->validIndexListLen;
     CHK_STATUS(rtpRollingBufferGetValidSeqIndexList(pSenderTranceiver->sender.packetBuffer, pRetransmitter->sequenceNumberList, filledLen,
                                                     pRetransmitter->validIndexList, &validIndexListLen));
+    pRollingBuffer = pSenderTranceiver->sender.packetBuffer->pRollingBuffer;
+    isRtx = pSenderTranceiver->sender.payloadType != pSenderTranceiver->sender.rtxPayloadType;
+
+    // Take every packet asked for out of the rolling buffer first, they are all sent in one batch. The index list is
+    // compacted as it goes so each packet goes back where it came from.
     for (index = 0; index < validIndexListLen; index++) {
-        retStatus = rollingBufferExtractData(pSenderTranceiver->sender.packetBuffer->pRollingBuffer, pRetransmitter->validIndexList[index], &item);
+        CHK_STATUS(rollingBufferExtractData(pRollingBuffer, pRetransmitter->validIndexList[index], &item));
+        if (item == (UINT64) NULL) {
+            continue;
+        }
         pRtpPacket = (PRtpPacket) item;
-        CHK(retStatus == STATUS_SUCCESS, retStatus);
-
-        if (pRtpPacket != NULL) {
-            if (pSenderTranceiver->sender.payloadType == pSenderTranceiver->sender.rtxPayloadType) {
-                retStatus = iceAgentSendPacket(pKvsPeerConnection->pIceAgent, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
-            } else {
-                CHK_STATUS(constructRetransmitRtpPacketFromBytes(
-                    pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength, pSenderTranceiver->sender.rtxSequenceNumber,
-                    pSenderTranceiver->sender.rtxPayloadType, pSenderTranceiver->sender.rtxSsrc, &pRtxRtpPacket));
-                pSenderTranceiver->sender.rtxSequenceNumber++;
-                retStatus = writeRtpPacket(pKvsPeerConnection, pRtxRtpPacket);
-            }
-            // resendPacket
-            if (STATUS_SUCCEEDED(retStatus)) {
-                pRtpPacket->sentTime = GETTIME();
-                retransmittedPacketsSent++;
-                retransmittedBytesSent += pRtpPacket->rawPacketLength - RTP_HEADER_LEN(pRtpPacket);
-                DLOGV("Resent packet ssrc %lu seq %lu succeeded", pRtpPacket->header.ssrc, pRtpPacket->header.sequenceNumber);
-                twccManagerOnPacketSent(pKvsPeerConnection, pRtpPacket);
-            } else {
-                DLOGV("Resent packet ssrc %lu seq %lu failed 0x%08x", pRtpPacket->header.ssrc, pRtpPacket->header.sequenceNumber, retStatus);
-            }
-            // putBackPacketToRollingBuffer
-            retStatus =
-                rollingBufferInsertData(pSenderTranceiver->sender.packetBuffer->pRollingBuffer, pRetransmitter->sequenceNumberList[index], item);
-            CHK(retStatus == STATUS_SUCCESS || retStatus == STATUS_ROLLING_BUFFER_NOT_IN_RANGE, retStatus);
-
-            // free the packet if it is not in the valid range any more
-            if (retStatus == STATUS_ROLLING_BUFFER_NOT_IN_RANGE) {
-                DLOGS("Retransmit STATUS_ROLLING_BUFFER_NOT_IN_RANGE free %lu by self", pRtpPacket->header.sequenceNumber);
-                freeRtpPacket(&pRtpPacket);
-                retStatus = STATUS_SUCCESS;
-            } else {
-                DLOGS("Retransmit add back to rolling %lu", pRtpPacket->header.sequenceNumber);
-            }
-
-            freeRtpPacket(&pRtxRtpPacket);
-            pRtpPacket = NULL;
+        pRetransmitter->pPacketList[packetCount] = pRtpPacket;
+        pRetransmitter->validIndexList[packetCount] = pRetransmitter->validIndexList[index];
+        packetCount++;
+        if (isRtx) {
+            CHK_STATUS(createRetransmitBytesFromRtpPacket(pRtpPacket, 0, 0, 0, NULL, &packetLen));
+            rtxBufferSize += packetLen + SRTP_AUTH_TAG_OVERHEAD;
         }
     }
-CleanUp:
+    pRtpPacket = NULL;
+    CHK(packetCount > 0, retStatus);
+
+    if (!isRtx) {
+        // Packets are kept encrypted when there is no RTX stream, they go out as they are
+        for (index = 0; index < packetCount; index++) {
+            pRetransmitter->pSendBufferList[index] = pRetransmitter->pPacketList[index]->pRawPacket;
+            pRetransmitter->pSendLengthList[index] = pRetransmitter->pPacketList[index]->rawPacketLength;
+        }
+    } else {
+        if (rtxBufferSize > pRetransmitter->rtxBufferSize) {
+            SAFE_MEMFREE(pRetransmitter->pRtxBuffer);
+            pRetransmitter->rtxBufferSize = 0;
+            CHK(NULL != (pRetransmitter->pRtxBuffer = (PBYTE) MEMALLOC(rtxBufferSize)), STATUS_NOT_ENOUGH_MEMORY);
+            pRetransmitter->rtxBufferSize = rtxBufferSize;
+        }
 
-    MUTEX_LOCK(pSenderTranceiver->statsLock);
-    pSenderTranceiver->outboundStats.nackCount += nackCount;
-    pSenderTranceiver->outboundStats.retransmittedPacketsSent += retransmittedPacketsSent;
-    pSenderTranceiver->outboundStats.retransmittedBytesSent += retransmittedBytesSent;
-    MUTEX_UNLOCK(pSenderTranceiver->statsLock);
+        // RTX packets are written back to back into the pooled buffer and protected in place
+        MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+        locked = TRUE;
+        CHK(pKvsPeerConnection->pSrtpSession != NULL, STATUS_SUCCESS); // Discard packets till SRTP is ready
+        pCurPtr = pRetransmitter->pRtxBuffer;
+        for (index = 0; index < packetCount; index++) {
+            packetLen = (UINT32) (pRetransmitter->pRtxBuffer + pRetransmitter->rtxBufferSize - pCurPtr);
+            CHK_STATUS(createRetransmitBytesFromRtpPacket(pRetransmitter->pPacketList[index], pSenderTranceiver->sender.rtxSequenceNumber,
+                                                          pSenderTranceiver->sender.rtxPayloadType, pSenderTranceiver->sender.rtxSsrc, pCurPtr,
+                                                          &packetLen));
+            pSenderTranceiver->sender.rtxSequenceNumber++;
+            CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, pCurPtr, (PINT32) &packetLen));
+            pRetransmitter->pSendBufferList[index] = pCurPtr;
+            pRetransmitter->pSendLengthList[index] = packetLen;
+            pCurPtr += packetLen;
+        }
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+        locked = FALSE;
+    }
 
-    CHK_LOG_ERR(retStatus);
-    if (pRtpPacket != NULL) {
-        // free the packet as it is not put back into rolling buffer
-        freeRtpPacket(&pRtpPacket);
+    retStatus = iceAgentSendPackets(pKvsPeerConnection->pIceAgent, pRetransmitter->pSendBufferList, pRetransmitter->pSendLengthList, packetCount);
+    if (STATUS_FAILED(retStatus)) {
+        DLOGV("Resending %u packets for ssrc %lu failed 0x%08x", packetCount, pSenderTranceiver->sender.ssrc, retStatus);
+        retStatus = STATUS_SUCCESS;
+    } else {
+        for (index = 0; index < packetCount; index++) {
+            pRtpPacket = pRetransmitter->pPacketList[index];
+            pRtpPacket->sentTime = GETTIME();
+            retransmittedPacketsSent++;
+            retransmittedBytesSent += pRtpPacket->rawPacketLength - RTP_HEADER_LEN(pRtpPacket);
+            DLOGV("Resent packet ssrc %lu seq %lu succeeded", pRtpPacket->header.ssrc, pRtpPacket->header.sequenceNumber);
+            twccManagerOnPacketSent(pKvsPeerConnection, pRtpPacket);
+        }
         pRtpPacket = NULL;
     }
 
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    }
+
+    // putBackPacketToRollingBuffer, the sender thread can free a packet as soon as it is back
+    for (index = 0; index < packetCount; index++) {
+        pRtpPacket = pRetransmitter->pPacketList[index];
+        pRetransmitter->pPacketList[index] = NULL;
+        sequenceNumber = pRtpPacket->header.sequenceNumber;
+        // free the packet if it is not in the valid range any more
+        if (rollingBufferInsertData(pRollingBuffer, pRetransmitter->validIndexList[index], (UINT64) pRtpPacket) != STATUS_SUCCESS) {
+            DLOGS("Retransmit STATUS_ROLLING_BUFFER_NOT_IN_RANGE free %lu by self", sequenceNumber);
+            freeRtpPacket(&pRtpPacket);
+        } else {
+            DLOGS("Retransmit add back to rolling %lu", sequenceNumber);
+        }
+    }
+
+    if (pSenderTranceiver != NULL) {
+        MUTEX_LOCK(pSenderTranceiver->statsLock);
+        pSenderTranceiver->outboundStats.nackCount += nackCount;
+        pSenderTranceiver->outboundStats.retransmittedPacketsSent += retransmittedPacketsSent;
+        pSenderTranceiver->outboundStats.retransmittedBytesSent += retransmittedBytesSent;
+        MUTEX_UNLOCK(pSenderTranceiver->statsLock);
+    }
+
+    CHK_LOG_ERR(retStatus);
+
     LEAVES();
     return retStatus;
 }
@@ -15,6 +15,14 @@ typedef struct {
     UINT32 seqNumListLen;
     UINT32 validIndexListLen;
     PUINT64 validIndexList;
+    // Packets of the NACK being handled, taken out of the rolling buffer until they are resent
+    PRtpPacket* pPacketList;
+    // Datagrams of the NACK being handled, sent in one batch
+    PBYTE* pSendBufferList;
+    PUINT32 pSendLengthList;
+    // RTX packets are built and protected here, grows to fit the largest NACK handled
+    PBYTE pRtxBuffer;
+    UINT32 rtxBufferSize;
 } Retransmitter, *PRetransmitter;
 
 STATUS createRetransmitter(UINT32, UINT32, PRetransmitter*);
@@ -132,6 +132,10 @@ static STATUS onRtcpReceiverReport(PRtcpPacket pRtcpPacket, PKvsPeerConnection p
     pTransceiver->remoteInboundStats.roundTripTime = rttPropDelayMsec;
     MUTEX_UNLOCK(pTransceiver->statsLock);
 
+    if (pTransceiver->sender.pFlexFecEncoder != NULL) {
+        CHK_STATUS(flexFecEncoderUpdateLoss(pTransceiver->sender.pFlexFecEncoder, fractionLost));
+    }
+
 CleanUp:
 
     return retStatus;
@@ -274,6 +278,27 @@ CleanUp:
     return retStatus;
 }
 
+static STATUS updateFlexFecLoss(PKvsPeerConnection pKvsPeerConnection, DOUBLE lossRate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDoubleListNode pCurNode = NULL;
+    PKvsRtpTransceiver pTransceiver;
+    UINT64 item;
+
+    CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
+    while (pCurNode != NULL) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+        pTransceiver = (PKvsRtpTransceiver) item;
+        if (pTransceiver->sender.pFlexFecEncoder != NULL) {
+            CHK_STATUS(flexFecEncoderUpdateLoss(pTransceiver->sender.pFlexFecEncoder, lossRate));
+        }
+        pCurNode = pCurNode->pNext;
+    }
+
+CleanUp:
+    return retStatus;
+}
+
 STATUS onRtcpTwccPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConnection)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -290,7 +315,9 @@ STATUS onRtcpTwccPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConn
     PTwccPacket twccPacket;
 
     CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
-    CHK(pKvsPeerConnection->onSenderBandwidthEstimation != NULL && pKvsPeerConnection->pTwccManager != NULL, STATUS_SUCCESS);
+    // The loss is reported to the bandwidth estimation callback and drives the FlexFEC repair rate, either one needs it
+    CHK(pKvsPeerConnection->pTwccManager != NULL && (pKvsPeerConnection->onSenderBandwidthEstimation != NULL || pKvsPeerConnection->enableFlexFec),
+        STATUS_SUCCESS);
 
     MUTEX_LOCK(pKvsPeerConnection->twccLock);
     locked = TRUE;
@@ -321,8 +348,12 @@ STATUS onRtcpTwccPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConn
     if (duration > 0) {
         MUTEX_UNLOCK(pKvsPeerConnection->twccLock);
         locked = FALSE;
-        pKvsPeerConnection->onSenderBandwidthEstimation(pKvsPeerConnection->onSenderBandwidthEstimationCustomData, sentBytes, receivedBytes,
-                                                        sentPackets, receivedPackets, duration);
+        if (pKvsPeerConnection->onSenderBandwidthEstimation != NULL) {
+            pKvsPeerConnection->onSenderBandwidthEstimation(pKvsPeerConnection->onSenderBandwidthEstimationCustomData, sentBytes, receivedBytes,
+                                                            sentPackets, receivedPackets, duration);
+        }
+        // Transport wide feedback arrives more often than receiver reports, so the repair rate follows loss more closely
+        CHK_STATUS(updateFlexFecLoss(pKvsPeerConnection, 1.0 - (DOUBLE) receivedPackets / sentPackets));
     }
 
 CleanUp:
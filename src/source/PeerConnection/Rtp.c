@@ -2,8 +2,6 @@
 
 #include "../Include_i.h"
 
-typedef STATUS (*RtpPayloadFunc)(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
-
 STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION direction, PKvsPeerConnection pKvsPeerConnection, UINT32 ssrc, UINT32 rtxSsrc,
                                PRtcMediaStreamTrack pRtcMediaStreamTrack, PJitterBuffer pJitterBuffer, RTC_CODEC rtcCodec,
                                PKvsRtpTransceiver* ppKvsRtpTransceiver)
@@ -23,6 +21,7 @@ STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION direction, PKvsPeer
     pKvsRtpTransceiver->statsLock = MUTEX_CREATE(FALSE);
     pKvsRtpTransceiver->sender.ssrc = ssrc;
     pKvsRtpTransceiver->sender.rtxSsrc = rtxSsrc;
+    pKvsRtpTransceiver->sender.flexFecSsrc = (UINT32) RAND();
     pKvsRtpTransceiver->sender.track = *pRtcMediaStreamTrack;
     pKvsRtpTransceiver->sender.packetBuffer = NULL;
     pKvsRtpTransceiver->sender.retransmitter = NULL;
@@ -30,6 +29,8 @@ STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION direction, PKvsPeer
     pKvsRtpTransceiver->transceiver.receiver.track.codec = rtcCodec;
     pKvsRtpTransceiver->transceiver.receiver.track.kind = pRtcMediaStreamTrack->kind;
     pKvsRtpTransceiver->transceiver.direction = direction;
+    pKvsRtpTransceiver->maxReceiveSpatialLayer = VP9_MAX_SPATIAL_LAYERS - 1;
+    pKvsRtpTransceiver->maxReceiveTemporalLayer = VP9_MAX_TEMPORAL_LAYERS - 1;
 
     pKvsRtpTransceiver->outboundStats.sent.rtpStream.ssrc = ssrc;
     STRNCPY(pKvsRtpTransceiver->outboundStats.sent.rtpStream.kind, pRtcMediaStreamTrack->kind == MEDIA_STREAM_TRACK_KIND_AUDIO ? "audio" : "video",
@@ -76,11 +77,27 @@ STATUS freeKvsRtpTransceiver(PKvsRtpTransceiver* ppKvsRtpTransceiver)
     if (pKvsRtpTransceiver->sender.retransmitter != NULL) {
         freeRetransmitter(&pKvsRtpTransceiver->sender.retransmitter);
     }
+
+    if (pKvsRtpTransceiver->sender.pFlexFecEncoder != NULL) {
+        freeFlexFecEncoder(&pKvsRtpTransceiver->sender.pFlexFecEncoder);
+    }
+
+    if (pKvsRtpTransceiver->pFlexFecDecoder != NULL) {
+        freeFlexFecDecoder(&pKvsRtpTransceiver->pFlexFecDecoder);
+    }
+
+    if (pKvsRtpTransceiver->sender.pRedEncoder != NULL) {
+        freeRedEncoder(&pKvsRtpTransceiver->sender.pRedEncoder);
+    }
     MUTEX_FREE(pKvsRtpTransceiver->statsLock);
 
     SAFE_MEMFREE(pKvsRtpTransceiver->peerFrameBuffer);
     SAFE_MEMFREE(pKvsRtpTransceiver->sender.payloadArray.payloadBuffer);
     SAFE_MEMFREE(pKvsRtpTransceiver->sender.payloadArray.payloadSubLength);
+    SAFE_MEMFREE(pKvsRtpTransceiver->sender.pPacketList);
+    SAFE_MEMFREE(pKvsRtpTransceiver->sender.pRawPacketBuffer);
+    SAFE_MEMFREE(pKvsRtpTransceiver->sender.flexFecPayloadArray.payloadBuffer);
+    SAFE_MEMFREE(pKvsRtpTransceiver->sender.flexFecPayloadArray.payloadSubLength);
 
     SAFE_MEMFREE(pKvsRtpTransceiver);
 
@@ -103,6 +120,35 @@ CleanUp:
     return retStatus;
 }
 
+// Copies the stats once no update of the media path overlapped the copy. The media path is never held up, a snapshot
+// is retried instead, which takes no longer than the few additions of an update
+static VOID kvsRtpTransceiverSnapshotStats(PKvsRtpTransceiver pKvsRtpTransceiver, volatile SIZE_T* pSequence, PVOID pSnapshot, PVOID pStats,
+                                           UINT32 statsSize)
+{
+    SIZE_T sequence;
+
+    do {
+        sequence = ATOMIC_LOAD(pSequence);
+        if ((sequence & 1) == 0) {
+            MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
+            MEMCPY(pSnapshot, pStats, statsSize);
+            MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+        }
+    } while ((sequence & 1) != 0 || ATOMIC_LOAD(pSequence) != sequence);
+}
+
+VOID kvsRtpTransceiverGetOutboundStats(PKvsRtpTransceiver pKvsRtpTransceiver, PRtcOutboundRtpStreamStats pRtcOutboundRtpStreamStats)
+{
+    kvsRtpTransceiverSnapshotStats(pKvsRtpTransceiver, &pKvsRtpTransceiver->outboundStatsSequence, pRtcOutboundRtpStreamStats,
+                                   &pKvsRtpTransceiver->outboundStats, SIZEOF(RtcOutboundRtpStreamStats));
+}
+
+VOID kvsRtpTransceiverGetInboundStats(PKvsRtpTransceiver pKvsRtpTransceiver, PRtcInboundRtpStreamStats pRtcInboundRtpStreamStats)
+{
+    kvsRtpTransceiverSnapshotStats(pKvsRtpTransceiver, &pKvsRtpTransceiver->inboundStatsSequence, pRtcInboundRtpStreamStats,
+                                   &pKvsRtpTransceiver->inboundStats, SIZEOF(RtcInboundRtpStreamStats));
+}
+
 STATUS transceiverOnFrame(PRtcRtpTransceiver pRtcRtpTransceiver, UINT64 customData, RtcOnFrame rtcOnFrame)
 {
     ENTERS();
@@ -154,6 +200,23 @@ CleanUp:
     return retStatus;
 }
 
+STATUS transceiverSetMaxReceiveLayers(PRtcRtpTransceiver pRtcRtpTransceiver, UINT8 maxSpatialLayer, UINT8 maxTemporalLayer)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+
+    CHK(pKvsRtpTransceiver != NULL, STATUS_NULL_ARG);
+
+    pKvsRtpTransceiver->maxReceiveSpatialLayer = maxSpatialLayer;
+    pKvsRtpTransceiver->maxReceiveTemporalLayer = maxTemporalLayer;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS updateEncoderStats(PRtcRtpTransceiver pRtcRtpTransceiver, PRtcEncoderStats encoderStats)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -162,6 +225,7 @@ STATUS updateEncoderStats(PRtcRtpTransceiver pRtcRtpTransceiver, PRtcEncoderStat
     MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
     pKvsRtpTransceiver->outboundStats.totalEncodeTime += encoderStats->encodeTimeMsec;
     pKvsRtpTransceiver->outboundStats.targetBitrate = encoderStats->targetBitrate;
+    ATOMIC_STORE(&pKvsRtpTransceiver->sender.targetBitrate, (SIZE_T) encoderStats->targetBitrate);
     if (encoderStats->width < pKvsRtpTransceiver->outboundStats.frameWidth || encoderStats->height < pKvsRtpTransceiver->outboundStats.frameHeight) {
         pKvsRtpTransceiver->outboundStats.qualityLimitationResolutionChanges++;
     }
@@ -181,6 +245,39 @@ CleanUp:
     return retStatus;
 }
 
+// Sends the repair packets protecting the frame just sent. Called with the SRTP session lock held
+static STATUS sendFlexFecRepairPackets(PKvsRtpTransceiver pKvsRtpTransceiver, PUINT32 pPacketsSent)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = pKvsRtpTransceiver->pKvsPeerConnection;
+    PPayloadArray pPayloadArray = &pKvsRtpTransceiver->sender.flexFecPayloadArray;
+    UINT32 i, offset = 0, allocSize;
+    INT32 packetLen;
+
+    CHK_STATUS(flexFecEncoderFinishFrame(pKvsRtpTransceiver->sender.pFlexFecEncoder, pPayloadArray));
+    for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
+        packetLen = (INT32) pPayloadArray->payloadSubLength[i];
+        allocSize = pPayloadArray->payloadSubLength[i] + SRTP_AUTH_TAG_OVERHEAD;
+        if (allocSize > pKvsRtpTransceiver->sender.rawPacketBufferSize) {
+            SAFE_MEMFREE(pKvsRtpTransceiver->sender.pRawPacketBuffer);
+            pKvsRtpTransceiver->sender.rawPacketBufferSize = 0;
+            CHK(NULL != (pKvsRtpTransceiver->sender.pRawPacketBuffer = (PBYTE) MEMALLOC(allocSize)), STATUS_NOT_ENOUGH_MEMORY);
+            pKvsRtpTransceiver->sender.rawPacketBufferSize = allocSize;
+        }
+        MEMCPY(pKvsRtpTransceiver->sender.pRawPacketBuffer, pPayloadArray->payloadBuffer + offset, packetLen);
+        offset += pPayloadArray->payloadSubLength[i];
+
+        CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, pKvsRtpTransceiver->sender.pRawPacketBuffer, &packetLen));
+        // Repair packets are best effort, losing one is no reason to fail the frame
+        if (STATUS_SUCCEEDED(iceAgentSendPacket(pKvsPeerConnection->pIceAgent, pKvsRtpTransceiver->sender.pRawPacketBuffer, packetLen))) {
+            (*pPacketsSent)++;
+        }
+    }
+
+CleanUp:
+    return retStatus;
+}
+
 STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -191,19 +288,20 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
     UINT32 i = 0, packetLen = 0, headerLen = 0, allocSize;
     PBYTE rawPacket = NULL;
     PPayloadArray pPayloadArray = NULL;
-    RtpPayloadFunc rtpPayloadFunc = NULL;
+    RtpPayloadArrayFunc rtpPayloadFunc = NULL;
     UINT64 randomRtpTimeoffset = 0; // TODO: spec requires random rtp time offset
     UINT64 rtpTimestamp = 0;
     UINT64 now = GETTIME();
+    UINT8 payloadType;
 
     // stats updates
     DOUBLE fps = 0.0;
     UINT32 frames = 0, keyframes = 0, bytesSent = 0, packetsSent = 0, headerBytesSent = 0, framesSent = 0;
-    UINT32 packetsDiscardedOnSend = 0, bytesDiscardedOnSend = 0, framesDiscardedOnSend = 0;
+    UINT32 packetsDiscardedOnSend = 0, bytesDiscardedOnSend = 0, framesDiscardedOnSend = 0, fecPacketsSent = 0;
     UINT64 lastPacketSentTimestamp = 0;
 
     // temp vars :(
-    UINT64 tmpFrames, tmpTime;
+    UINT64 tmpFrames, tmpTime, encryptStartTime;
     UINT16 twsn;
     UINT32 extpayload;
     STATUS sendStatus;
@@ -231,23 +329,38 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
     CHK(pKvsPeerConnection->pSrtpSession != NULL, STATUS_SRTP_NOT_READY_YET); // Discard packets till SRTP is ready
     switch (pKvsRtpTransceiver->sender.track.codec) {
         case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
-            rtpPayloadFunc = createPayloadForH264;
+            rtpPayloadFunc = createPayloadArrayForH264;
+            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
+            break;
+
+        case RTC_CODEC_H265:
+            rtpPayloadFunc = createPayloadArrayForH265;
+            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
+            break;
+
+        case RTC_CODEC_AV1:
+            rtpPayloadFunc = createPayloadArrayForAV1;
             rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
             break;
 
         case RTC_CODEC_OPUS:
-            rtpPayloadFunc = createPayloadForOpus;
+            rtpPayloadFunc = createPayloadArrayForOpus;
             rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(OPUS_CLOCKRATE, pFrame->presentationTs);
             break;
 
         case RTC_CODEC_MULAW:
         case RTC_CODEC_ALAW:
-            rtpPayloadFunc = createPayloadForG711;
+            rtpPayloadFunc = createPayloadArrayForG711;
             rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(PCM_CLOCKRATE, pFrame->presentationTs);
             break;
 
         case RTC_CODEC_VP8:
-            rtpPayloadFunc = createPayloadForVP8;
+            rtpPayloadFunc = createPayloadArrayForVP8;
+            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
+            break;
+
+        case RTC_CODEC_VP9:
+            rtpPayloadFunc = createPayloadArrayForVP9;
             rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
             break;
 
@@ -257,25 +370,30 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
 
     rtpTimestamp += randomRtpTimeoffset;
 
-    CHK_STATUS(rtpPayloadFunc(pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size, NULL, &(pPayloadArray->payloadLength), NULL,
-                              &(pPayloadArray->payloadSubLenSize)));
-    if (pPayloadArray->payloadLength > pPayloadArray->maxPayloadLength) {
-        SAFE_MEMFREE(pPayloadArray->payloadBuffer);
-        pPayloadArray->payloadBuffer = (PBYTE) MEMALLOC(pPayloadArray->payloadLength);
-        pPayloadArray->maxPayloadLength = pPayloadArray->payloadLength;
+    // Payloads are written in a single pass into the sender's payload array, which keeps its buffers across frames
+    CHK_STATUS(rtpPayloadFunc(pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size, pPayloadArray));
+    payloadType = pKvsRtpTransceiver->sender.payloadType;
+    if (pKvsRtpTransceiver->sender.pRedEncoder != NULL) {
+        CHK_STATUS(redEncoderWrapPayloadArray(pKvsRtpTransceiver->sender.pRedEncoder, payloadType, (UINT32) rtpTimestamp, pKvsPeerConnection->MTU,
+                                              pPayloadArray));
+        payloadType = pKvsPeerConnection->redPayloadType;
     }
-    if (pPayloadArray->payloadSubLenSize > pPayloadArray->maxPayloadSubLenSize) {
-        SAFE_MEMFREE(pPayloadArray->payloadSubLength);
-        pPayloadArray->payloadSubLength = (PUINT32) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(UINT32));
-        pPayloadArray->maxPayloadSubLenSize = pPayloadArray->payloadSubLenSize;
+
+    if (pPayloadArray->payloadSubLenSize > pKvsRtpTransceiver->sender.maxPacketListSize) {
+        SAFE_MEMFREE(pKvsRtpTransceiver->sender.pPacketList);
+        pKvsRtpTransceiver->sender.maxPacketListSize = 0;
+        CHK(NULL != (pKvsRtpTransceiver->sender.pPacketList = (PRtpPacket) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(RtpPacket))),
+            STATUS_NOT_ENOUGH_MEMORY);
+        pKvsRtpTransceiver->sender.maxPacketListSize = pPayloadArray->payloadSubLenSize;
     }
-    CHK_STATUS(rtpPayloadFunc(pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size, pPayloadArray->payloadBuffer,
-                              &(pPayloadArray->payloadLength), pPayloadArray->payloadSubLength, &(pPayloadArray->payloadSubLenSize)));
-    pPacketList = (PRtpPacket) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(RtpPacket));
+    pPacketList = pKvsRtpTransceiver->sender.pPacketList;
 
-    CHK_STATUS(constructRtpPackets(pPayloadArray, pKvsRtpTransceiver->sender.payloadType, pKvsRtpTransceiver->sender.sequenceNumber, rtpTimestamp,
+    CHK_STATUS(constructRtpPackets(pPayloadArray, payloadType, pKvsRtpTransceiver->sender.sequenceNumber, rtpTimestamp,
                                    pKvsRtpTransceiver->sender.ssrc, pPacketList, pPayloadArray->payloadSubLenSize));
     pKvsRtpTransceiver->sender.sequenceNumber = GET_UINT16_SEQ_NUM(pKvsRtpTransceiver->sender.sequenceNumber + pPayloadArray->payloadSubLenSize);
+    if (pKvsRtpTransceiver->sender.pFlexFecEncoder != NULL) {
+        CHK_STATUS(flexFecEncoderStartFrame(pKvsRtpTransceiver->sender.pFlexFecEncoder, pPayloadArray->payloadSubLenSize, (UINT32) rtpTimestamp));
+    }
 
     bufferAfterEncrypt = (pKvsRtpTransceiver->sender.payloadType == pKvsRtpTransceiver->sender.rtxPayloadType);
     for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
@@ -288,13 +406,20 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
             extpayload = TWCC_PAYLOAD(pKvsRtpTransceiver->pKvsPeerConnection->twccExtId, twsn);
             pRtpPacket->header.extensionPayload = (PBYTE) &extpayload;
         }
-        // Get the required size first
-        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, NULL, &packetLen));
-
-        // Account for SRTP authentication tag
+        // Account for SRTP authentication tag. The rolling buffer keeps its own copy so the raw packet buffer is reused
+        packetLen = RTP_GET_RAW_PACKET_SIZE(pRtpPacket);
         allocSize = packetLen + SRTP_AUTH_TAG_OVERHEAD;
-        CHK(NULL != (rawPacket = (PBYTE) MEMALLOC(allocSize)), STATUS_NOT_ENOUGH_MEMORY);
+        if (allocSize > pKvsRtpTransceiver->sender.rawPacketBufferSize) {
+            SAFE_MEMFREE(pKvsRtpTransceiver->sender.pRawPacketBuffer);
+            pKvsRtpTransceiver->sender.rawPacketBufferSize = 0;
+            CHK(NULL != (pKvsRtpTransceiver->sender.pRawPacketBuffer = (PBYTE) MEMALLOC(allocSize)), STATUS_NOT_ENOUGH_MEMORY);
+            pKvsRtpTransceiver->sender.rawPacketBufferSize = allocSize;
+        }
+        rawPacket = pKvsRtpTransceiver->sender.pRawPacketBuffer;
         CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, rawPacket, &packetLen));
+        if (pKvsRtpTransceiver->sender.pFlexFecEncoder != NULL) {
+            CHK_STATUS(flexFecEncoderProtectPacket(pKvsRtpTransceiver->sender.pFlexFecEncoder, rawPacket, packetLen));
+        }
 
         if (!bufferAfterEncrypt) {
             pRtpPacket->pRawPacket = rawPacket;
@@ -302,14 +427,16 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
             CHK_STATUS(rtpRollingBufferAddRtpPacket(pKvsRtpTransceiver->sender.packetBuffer, pRtpPacket));
         }
 
+        encryptStartTime = GETTIME();
         CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, rawPacket, (PINT32) &packetLen));
+        latencyHistogramRecord(&pKvsPeerConnection->srtpLatency, GETTIME() - encryptStartTime);
+        TRACE_COMPLETE(TRACE_POINT_SRTP_ENCRYPT, encryptStartTime, GETTIME(), packetLen);
         sendStatus = iceAgentSendPacket(pKvsPeerConnection->pIceAgent, rawPacket, packetLen);
         if (sendStatus == STATUS_SEND_DATA_FAILED) {
             packetsDiscardedOnSend++;
             bytesDiscardedOnSend += packetLen - headerLen;
             // TODO is frame considered discarded when at least one of its packets is discarded or all of its packets discarded?
             framesDiscardedOnSend = 1;
-            SAFE_MEMFREE(rawPacket);
             continue;
         } else if (sendStatus == STATUS_SUCCESS && pKvsRtpTransceiver->pKvsPeerConnection->twccExtId != 0) {
             pRtpPacket->sentTime = GETTIME();
@@ -329,8 +456,10 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
         packetsSent++;
         lastPacketSentTimestamp = KVS_CONVERT_TIMESCALE(GETTIME(), HUNDREDS_OF_NANOS_IN_A_SECOND, 1000);
         headerBytesSent += headerLen;
+    }
 
-        SAFE_MEMFREE(rawPacket);
+    if (pKvsRtpTransceiver->sender.pFlexFecEncoder != NULL) {
+        CHK_STATUS(sendFlexFecRepairPackets(pKvsRtpTransceiver, &fecPacketsSent));
     }
 
     if (MEDIA_STREAM_TRACK_KIND_VIDEO == pKvsRtpTransceiver->sender.track.kind) {
@@ -343,41 +472,48 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
     }
 
 CleanUp:
+    // Frames are written one at a time under pSrtpSessionLock, which is held unless there is no frame to write
     if (locked) {
-        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
-    }
-    MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
-    pKvsRtpTransceiver->outboundStats.totalEncodedBytesTarget += pFrame->size;
-    pKvsRtpTransceiver->outboundStats.framesEncoded += frames;
-    pKvsRtpTransceiver->outboundStats.keyFramesEncoded += keyframes;
-    if (fps > 0.0) {
-        pKvsRtpTransceiver->outboundStats.framesPerSecond = fps;
-    }
-    pKvsRtpTransceiver->sender.lastKnownFrameCountTime = now;
-    pKvsRtpTransceiver->sender.lastKnownFrameCount = pKvsRtpTransceiver->outboundStats.framesEncoded;
-    pKvsRtpTransceiver->outboundStats.sent.bytesSent += bytesSent;
-    pKvsRtpTransceiver->outboundStats.sent.packetsSent += packetsSent;
-    if (lastPacketSentTimestamp > 0) {
-        pKvsRtpTransceiver->outboundStats.lastPacketSentTimestamp = lastPacketSentTimestamp;
-    }
-    pKvsRtpTransceiver->outboundStats.headerBytesSent += headerBytesSent;
-    pKvsRtpTransceiver->outboundStats.framesSent += framesSent;
-    if (pKvsRtpTransceiver->outboundStats.framesPerSecond > 0.0) {
-        if (pFrame->size >=
-            pKvsRtpTransceiver->outboundStats.targetBitrate / pKvsRtpTransceiver->outboundStats.framesPerSecond * HUGE_FRAME_MULTIPLIER) {
-            pKvsRtpTransceiver->outboundStats.hugeFramesSent++;
+        RTP_STATS_UPDATE_BEGIN(&pKvsRtpTransceiver->outboundStatsSequence);
+        pKvsRtpTransceiver->outboundStats.totalEncodedBytesTarget += pFrame->size;
+        pKvsRtpTransceiver->outboundStats.framesEncoded += frames;
+        pKvsRtpTransceiver->outboundStats.keyFramesEncoded += keyframes;
+        if (fps > 0.0) {
+            pKvsRtpTransceiver->outboundStats.framesPerSecond = fps;
+        }
+        pKvsRtpTransceiver->sender.lastKnownFrameCountTime = now;
+        pKvsRtpTransceiver->sender.lastKnownFrameCount = pKvsRtpTransceiver->outboundStats.framesEncoded;
+        pKvsRtpTransceiver->outboundStats.sent.bytesSent += bytesSent;
+        pKvsRtpTransceiver->outboundStats.sent.packetsSent += packetsSent;
+        if (lastPacketSentTimestamp > 0) {
+            pKvsRtpTransceiver->outboundStats.lastPacketSentTimestamp = lastPacketSentTimestamp;
         }
+        pKvsRtpTransceiver->outboundStats.headerBytesSent += headerBytesSent;
+        pKvsRtpTransceiver->outboundStats.framesSent += framesSent;
+        if (pKvsRtpTransceiver->outboundStats.framesPerSecond > 0.0) {
+            if (pFrame->size >=
+                (UINT64) ATOMIC_LOAD(&pKvsRtpTransceiver->sender.targetBitrate) / pKvsRtpTransceiver->outboundStats.framesPerSecond *
+                    HUGE_FRAME_MULTIPLIER) {
+                pKvsRtpTransceiver->outboundStats.hugeFramesSent++;
+            }
+        }
+        // iceAgentSendPacket tries to send packet immediately, explicitly settings totalPacketSendDelay to 0
+        pKvsRtpTransceiver->outboundStats.totalPacketSendDelay = 0;
+
+        pKvsRtpTransceiver->outboundStats.framesDiscardedOnSend += framesDiscardedOnSend;
+        pKvsRtpTransceiver->outboundStats.packetsDiscardedOnSend += packetsDiscardedOnSend;
+        pKvsRtpTransceiver->outboundStats.bytesDiscardedOnSend += bytesDiscardedOnSend;
+        pKvsRtpTransceiver->outboundStats.fecPacketsSent += fecPacketsSent;
+        RTP_STATS_UPDATE_END(&pKvsRtpTransceiver->outboundStatsSequence);
+
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
     }
-    // iceAgentSendPacket tries to send packet immediately, explicitly settings totalPacketSendDelay to 0
-    pKvsRtpTransceiver->outboundStats.totalPacketSendDelay = 0;
 
-    pKvsRtpTransceiver->outboundStats.framesDiscardedOnSend += framesDiscardedOnSend;
-    pKvsRtpTransceiver->outboundStats.packetsDiscardedOnSend += packetsDiscardedOnSend;
-    pKvsRtpTransceiver->outboundStats.bytesDiscardedOnSend += bytesDiscardedOnSend;
-    MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+    if (STATUS_SUCCEEDED(retStatus)) {
+        latencyHistogramRecord(&pKvsPeerConnection->writeFrameLatency, GETTIME() - now);
+        TRACE_COMPLETE(TRACE_POINT_WRITE_FRAME, now, GETTIME(), pFrame->size);
+    }
 
-    SAFE_MEMFREE(rawPacket);
-    SAFE_MEMFREE(pPacketList);
     if (retStatus != STATUS_SRTP_NOT_READY_YET) {
         CHK_LOG_ERR(retStatus);
     }
@@ -29,11 +29,24 @@ typedef struct {
     UINT32 ssrc;
     UINT32 rtxSsrc;
     PayloadArray payloadArray;
+    // Reused across frames, only grown when a frame needs more packets or a larger packet than seen so far
+    PRtpPacket pPacketList;
+    UINT32 maxPacketListSize;
+    PBYTE pRawPacketBuffer;
+    UINT32 rawPacketBufferSize;
 
     RtcMediaStreamTrack track;
     PRtpRollingBuffer packetBuffer;
     PRetransmitter retransmitter;
 
+    // Repair stream, the SSRC is advertised when FlexFEC is enabled and the encoder only set up once it was negotiated
+    UINT32 flexFecSsrc;
+    PFlexFecEncoder pFlexFecEncoder;
+    PayloadArray flexFecPayloadArray;
+
+    // Set up once RED was negotiated for an Opus track, see setRedFromRemoteDescription
+    PRedEncoder pRedEncoder;
+
     UINT64 rtpTimeOffset;
     UINT64 firstFrameWallClockTime; // 100ns precision
 
@@ -41,6 +54,9 @@ typedef struct {
     UINT64 lastKnownFrameCount;
     UINT64 lastKnownFrameCountTime; // 100ns precision
 
+    // Last target bitrate of the encoder, see updateEncoderStats, read by writeFrame to count huge frames
+    volatile SIZE_T targetBitrate;
+
 } RtcRtpSender, *PRtcRtpSender;
 
 typedef struct {
@@ -52,6 +68,13 @@ typedef struct {
     UINT32 jitterBufferSsrc;
     PJitterBuffer pJitterBuffer;
 
+    // Remote repair stream protecting jitterBufferSsrc, see setFlexFecFromRemoteDescription
+    UINT32 flexFecSsrc;
+    PFlexFecDecoder pFlexFecDecoder;
+
+    // Places the redundant encodings of received RED packets, see unwrapRedPacket
+    RedDecoder redDecoder;
+
     UINT64 onFrameCustomData;
     RtcOnFrame onFrame;
 
@@ -63,19 +86,34 @@ typedef struct {
     PBYTE peerFrameBuffer;
     UINT32 peerFrameBufferSize;
 
+    // Highest layers reassembled from scalable streams, see transceiverSetMaxReceiveLayers
+    UINT8 maxReceiveSpatialLayer;
+    UINT8 maxReceiveTemporalLayer;
+
     UINT32 rtcpReportsTimerId;
 
+    // Stats updated by the media path, writeFrame for outbound and the receive path for inbound, never take statsLock.
+    // Each is updated by one thread at a time, which makes its sequence odd while it does, see RTP_STATS_UPDATE_BEGIN.
+    // statsLock is held for the rest of the updates and to take snapshots
     MUTEX statsLock;
+    volatile SIZE_T outboundStatsSequence;
+    volatile SIZE_T inboundStatsSequence;
     RtcOutboundRtpStreamStats outboundStats;
     RtcRemoteInboundRtpStreamStats remoteInboundStats;
     RtcInboundRtpStreamStats inboundStats;
 } KvsRtpTransceiver, *PKvsRtpTransceiver;
 
+// Brackets the stats updates of the media path, snapshots taken meanwhile are retried
+#define RTP_STATS_UPDATE_BEGIN(pSequence) ATOMIC_INCREMENT(pSequence)
+#define RTP_STATS_UPDATE_END(pSequence)   ATOMIC_INCREMENT(pSequence)
+
 STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION, PKvsPeerConnection, UINT32, UINT32, PRtcMediaStreamTrack, PJitterBuffer, RTC_CODEC,
                                PKvsRtpTransceiver*);
 STATUS freeKvsRtpTransceiver(PKvsRtpTransceiver*);
 
 STATUS kvsRtpTransceiverSetJitterBuffer(PKvsRtpTransceiver, PJitterBuffer);
+VOID kvsRtpTransceiverGetOutboundStats(PKvsRtpTransceiver, PRtcOutboundRtpStreamStats);
+VOID kvsRtpTransceiverGetInboundStats(PKvsRtpTransceiver, PRtcInboundRtpStreamStats);
 
 #define CONVERT_TIMESTAMP_TO_RTP(clockRate, pts) ((UINT64) ((DOUBLE) (pts) * ((DOUBLE) (clockRate) / HUNDREDS_OF_NANOS_IN_A_SECOND)))
 
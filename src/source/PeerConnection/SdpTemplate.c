@@ -0,0 +1,653 @@
+#define LOG_CLASS "SdpTemplate"
+
+#include "../Include_i.h"
+
+#define SDP_TEMPLATE_FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define SDP_TEMPLATE_FNV_PRIME        0x00000100000001b3ULL
+
+#define SDP_TEMPLATE_MAX_UINT64_DIGIT_COUNT 20
+
+#define SDP_TEMPLATE_CANDIDATE_PREFIX   SDP_ATTRIBUTE_MARKER "candidate:"
+#define SDP_TEMPLATE_ICE_UFRAG_PREFIX   SDP_ATTRIBUTE_MARKER "ice-ufrag:"
+#define SDP_TEMPLATE_ICE_PWD_PREFIX     SDP_ATTRIBUTE_MARKER "ice-pwd:"
+#define SDP_TEMPLATE_FINGERPRINT_PREFIX SDP_ATTRIBUTE_MARKER "fingerprint:sha-256 "
+#define SDP_TEMPLATE_SSRC_PREFIX        SDP_ATTRIBUTE_MARKER "ssrc:"
+#define SDP_TEMPLATE_SSRC_GROUP_PREFIX  SDP_ATTRIBUTE_MARKER "ssrc-group:"
+#define SDP_TEMPLATE_CNAME_PREFIX       " cname:"
+
+#define SDP_TEMPLATE_HAS_PREFIX(pLine, prefix) (STRNCMP((pLine), (prefix), ARRAY_SIZE(prefix) - 1) == 0)
+
+typedef struct {
+    MUTEX lock;
+    UINT64 hits;
+    UINT64 misses;
+    UINT32 templateCount;
+    PSdpTemplate templates[SDP_TEMPLATE_CACHE_MAX_COUNT];
+} SdpTemplateCache, *PSdpTemplateCache;
+
+// Templates shared by all peer connections, created on first use
+static volatile SIZE_T gSdpTemplateCache = (SIZE_T) NULL;
+
+static STATUS getSdpTemplateCache(PSdpTemplateCache* ppSdpTemplateCache)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpTemplateCache pSdpTemplateCache = (PSdpTemplateCache) ATOMIC_LOAD(&gSdpTemplateCache);
+    SIZE_T expected = (SIZE_T) NULL;
+
+    if (pSdpTemplateCache == NULL) {
+        CHK(NULL != (pSdpTemplateCache = (PSdpTemplateCache) MEMCALLOC(1, SIZEOF(SdpTemplateCache))), STATUS_NOT_ENOUGH_MEMORY);
+        pSdpTemplateCache->lock = MUTEX_CREATE(FALSE);
+        // Another peer connection could have raced us to create the cache, keep whichever got published first
+        if (!ATOMIC_COMPARE_EXCHANGE(&gSdpTemplateCache, &expected, (SIZE_T) pSdpTemplateCache)) {
+            MUTEX_FREE(pSdpTemplateCache->lock);
+            SAFE_MEMFREE(pSdpTemplateCache);
+            pSdpTemplateCache = (PSdpTemplateCache) expected;
+        }
+    }
+
+    *ppSdpTemplateCache = pSdpTemplateCache;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS deinitSdpTemplateCache(VOID)
+{
+    PSdpTemplateCache pSdpTemplateCache = (PSdpTemplateCache) ATOMIC_EXCHANGE(&gSdpTemplateCache, (SIZE_T) NULL);
+    UINT32 i;
+
+    if (pSdpTemplateCache != NULL) {
+        for (i = 0; i < pSdpTemplateCache->templateCount; i++) {
+            freeSdpTemplate(&pSdpTemplateCache->templates[i]);
+        }
+        MUTEX_FREE(pSdpTemplateCache->lock);
+        SAFE_MEMFREE(pSdpTemplateCache);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+static BOOL sdpTemplateMatches(PSdpTemplate pSdpTemplate, PSdpTemplateSignature pSignature)
+{
+    return pSdpTemplate->signatureHash == pSignature->hash && pSdpTemplate->signatureLength == pSignature->length &&
+        MEMCMP(pSdpTemplate->pSignature, pSignature->pBuffer, pSignature->length) == 0;
+}
+
+STATUS sdpTemplateCacheGet(PSdpTemplateSignature pSignature, PSdpTemplate* ppSdpTemplate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpTemplateCache pSdpTemplateCache = NULL;
+    PSdpTemplate pSdpTemplate = NULL;
+    BOOL locked = FALSE;
+    UINT32 i;
+
+    CHK(pSignature != NULL && ppSdpTemplate != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(getSdpTemplateCache(&pSdpTemplateCache));
+    MUTEX_LOCK(pSdpTemplateCache->lock);
+    locked = TRUE;
+
+    for (i = 0; i < pSdpTemplateCache->templateCount && pSdpTemplate == NULL; i++) {
+        if (sdpTemplateMatches(pSdpTemplateCache->templates[i], pSignature)) {
+            pSdpTemplate = pSdpTemplateCache->templates[i];
+        }
+    }
+
+    if (pSdpTemplate != NULL) {
+        pSdpTemplateCache->hits++;
+    } else {
+        pSdpTemplateCache->misses++;
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSdpTemplateCache->lock);
+    }
+
+    if (ppSdpTemplate != NULL) {
+        *ppSdpTemplate = pSdpTemplate;
+    }
+
+    return retStatus;
+}
+
+/*
+ * The cache takes the template over, it is freed right away when the cache is full or already has one for the signature
+ */
+STATUS sdpTemplateCachePut(PSdpTemplate pSdpTemplate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpTemplateCache pSdpTemplateCache = NULL;
+    BOOL locked = FALSE, stored = FALSE;
+    SdpTemplateSignature signature;
+    UINT32 i;
+
+    CHK(pSdpTemplate != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(getSdpTemplateCache(&pSdpTemplateCache));
+    MUTEX_LOCK(pSdpTemplateCache->lock);
+    locked = TRUE;
+
+    signature.hash = pSdpTemplate->signatureHash;
+    signature.length = pSdpTemplate->signatureLength;
+    signature.pBuffer = pSdpTemplate->pSignature;
+    for (i = 0; i < pSdpTemplateCache->templateCount; i++) {
+        // Another session of the same configuration got there first
+        CHK(!sdpTemplateMatches(pSdpTemplateCache->templates[i], &signature), retStatus);
+    }
+
+    CHK(pSdpTemplateCache->templateCount < SDP_TEMPLATE_CACHE_MAX_COUNT, retStatus);
+    pSdpTemplateCache->templates[pSdpTemplateCache->templateCount++] = pSdpTemplate;
+    stored = TRUE;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSdpTemplateCache->lock);
+    }
+
+    if (!stored) {
+        freeSdpTemplate(&pSdpTemplate);
+    }
+
+    return retStatus;
+}
+
+STATUS sdpTemplateCacheGetStats(PSdpTemplateCacheStats pSdpTemplateCacheStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpTemplateCache pSdpTemplateCache = NULL;
+
+    CHK(pSdpTemplateCacheStats != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(getSdpTemplateCache(&pSdpTemplateCache));
+    MUTEX_LOCK(pSdpTemplateCache->lock);
+    pSdpTemplateCacheStats->hits = pSdpTemplateCache->hits;
+    pSdpTemplateCacheStats->misses = pSdpTemplateCache->misses;
+    pSdpTemplateCacheStats->templateCount = pSdpTemplateCache->templateCount;
+    MUTEX_UNLOCK(pSdpTemplateCache->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS signatureAppend(PSdpTemplateSignature pSignature, PVOID pData, UINT32 length)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 capacity;
+    PBYTE pBuffer;
+
+    if (pSignature->length + length > pSignature->capacity) {
+        capacity = MAX(MAX(pSignature->capacity * 2, pSignature->length + length), SDP_TEMPLATE_SIGNATURE_INITIAL_CAPACITY);
+        CHK(NULL != (pBuffer = (PBYTE) MEMREALLOC(pSignature->pBuffer, capacity)), STATUS_NOT_ENOUGH_MEMORY);
+        pSignature->pBuffer = pBuffer;
+        pSignature->capacity = capacity;
+    }
+
+    MEMCPY(pSignature->pBuffer + pSignature->length, pData, length);
+    pSignature->length += length;
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS signatureAppendValue(PSdpTemplateSignature pSignature, UINT64 value)
+{
+    return signatureAppend(pSignature, &value, SIZEOF(value));
+}
+
+// NULL terminator included so that consecutive strings can't run into each other
+static STATUS signatureAppendString(PSdpTemplateSignature pSignature, PCHAR pString)
+{
+    if (pString == NULL) {
+        pString = EMPTY_STRING;
+    }
+
+    return signatureAppend(pSignature, pString, (UINT32) STRLEN(pString) + 1);
+}
+
+static STATUS signatureAppendTableValue(PSdpTemplateSignature pSignature, PHashTable pHashTable, UINT64 key)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 value = 0;
+
+    retStatus = hashTableGet(pHashTable, key, &value);
+    CHK(retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT, retStatus);
+    CHK_STATUS(signatureAppendValue(pSignature, (UINT64) (retStatus == STATUS_SUCCESS)));
+    retStatus = STATUS_SUCCESS;
+    CHK_STATUS(signatureAppendValue(pSignature, value));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS buildSdpTemplateSignature(PKvsPeerConnection pKvsPeerConnection, PLocalMediaSections pLocalMediaSections, PSdpTemplateSignature pSignature)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSessionDescription pRemoteSessionDescription;
+    PSdpMediaDescription pSdpMediaDescription;
+    PSdpAttributes pSdpAttribute;
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PRtcMediaStreamTrack pRtcMediaStreamTrack;
+    UINT64 payloadType = 0, rtpMapValue = 0;
+    UINT32 i, j;
+
+    CHK(pKvsPeerConnection != NULL && pLocalMediaSections != NULL && pSignature != NULL, STATUS_NULL_ARG);
+
+    MEMSET(pSignature, 0x00, SIZEOF(SdpTemplateSignature));
+    pRemoteSessionDescription = &pKvsPeerConnection->remoteSessionDescription;
+
+    CHK_STATUS(signatureAppendValue(pSignature, (UINT64) pKvsPeerConnection->isOffer));
+    CHK_STATUS(signatureAppendValue(pSignature, (UINT64) pLocalMediaSections->dataChannel));
+    CHK_STATUS(signatureAppendValue(pSignature, (UINT64) pKvsPeerConnection->twccExtId));
+    CHK_STATUS(signatureAppendValue(pSignature, (UINT64) pKvsPeerConnection->flexFecPayloadType));
+    CHK_STATUS(signatureAppendValue(pSignature, (UINT64) pKvsPeerConnection->redPayloadType));
+
+    // RTX codecs share their values with the codecs they repair
+    for (i = RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE; i <= RTC_CODEC_VP9; i++) {
+        CHK_STATUS(signatureAppendTableValue(pSignature, pKvsPeerConnection->pCodecTable, i));
+        CHK_STATUS(signatureAppendTableValue(pSignature, pKvsPeerConnection->pRtxTable, i));
+    }
+
+    CHK_STATUS(signatureAppendValue(pSignature, pLocalMediaSections->count));
+    for (i = 0; i < pLocalMediaSections->count; i++) {
+        pKvsRtpTransceiver = pLocalMediaSections->transceivers[i];
+        pRtcMediaStreamTrack = &pKvsRtpTransceiver->sender.track;
+        CHK_STATUS(signatureAppendValue(pSignature, (UINT64) pRtcMediaStreamTrack->kind));
+        CHK_STATUS(signatureAppendValue(pSignature, (UINT64) pRtcMediaStreamTrack->codec));
+        CHK_STATUS(signatureAppendValue(pSignature, (UINT64) pKvsRtpTransceiver->transceiver.direction));
+        CHK_STATUS(signatureAppendString(pSignature, pRtcMediaStreamTrack->streamId));
+        CHK_STATUS(signatureAppendString(pSignature, pRtcMediaStreamTrack->trackId));
+
+        if (pRtcMediaStreamTrack->codec == RTC_CODEC_UNKNOWN && pLocalMediaSections->pUnknownCodecPayloadTypesTable != NULL) {
+            CHK_STATUS(signatureAppendTableValue(pSignature, pLocalMediaSections->pUnknownCodecPayloadTypesTable,
+                                                 pLocalMediaSections->unknownCodecHashTableKeys[i]));
+            rtpMapValue = 0;
+            if (STATUS_SUCCEEDED(hashTableGet(pLocalMediaSections->pUnknownCodecRtpmapTable, pLocalMediaSections->unknownCodecHashTableKeys[i],
+                                              &rtpMapValue))) {
+                CHK_STATUS(signatureAppendString(pSignature, (PCHAR) rtpMapValue));
+            }
+            CHK_STATUS(signatureAppendValue(pSignature, rtpMapValue != 0));
+        }
+    }
+
+    // What the local description takes from the remote one: the BUNDLE group, the mids, the directions answered and the
+    // fmtp of the payload types
+    for (i = 0; i < pRemoteSessionDescription->sessionAttributesCount; i++) {
+        if (STRSTR(pRemoteSessionDescription->sdpAttributes[i].attributeValue, BUNDLE_KEY) != NULL) {
+            CHK_STATUS(signatureAppendString(pSignature, pRemoteSessionDescription->sdpAttributes[i].attributeValue));
+            break;
+        }
+    }
+
+    CHK_STATUS(signatureAppendValue(pSignature, pRemoteSessionDescription->mediaCount));
+    for (i = 0; i < pRemoteSessionDescription->mediaCount; i++) {
+        pSdpMediaDescription = &pRemoteSessionDescription->mediaDescriptions[i];
+        CHK_STATUS(signatureAppendString(pSignature, pSdpMediaDescription->mediaName));
+        for (j = 0; j < pSdpMediaDescription->mediaAttributesCount; j++) {
+            pSdpAttribute = &pSdpMediaDescription->sdpAttributes[j];
+            if (STRCMP(pSdpAttribute->attributeName, MID_KEY) == 0 || STRCMP(pSdpAttribute->attributeName, "fmtp") == 0 ||
+                STRCMP(pSdpAttribute->attributeName, "sendrecv") == 0 || STRCMP(pSdpAttribute->attributeName, "recvonly") == 0 ||
+                STRCMP(pSdpAttribute->attributeName, "sendonly") == 0) {
+                CHK_STATUS(signatureAppendString(pSignature, pSdpAttribute->attributeName));
+                CHK_STATUS(signatureAppendString(pSignature, pSdpAttribute->attributeValue));
+            }
+        }
+    }
+
+    // FNV-1a, the signature itself is compared on a match
+    pSignature->hash = SDP_TEMPLATE_FNV_OFFSET_BASIS;
+    for (i = 0; i < pSignature->length; i++) {
+        pSignature->hash = (pSignature->hash ^ pSignature->pBuffer[i]) * SDP_TEMPLATE_FNV_PRIME;
+    }
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && pSignature != NULL) {
+        freeSdpTemplateSignature(pSignature);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeSdpTemplateSignature(PSdpTemplateSignature pSignature)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pSignature != NULL, STATUS_NULL_ARG);
+
+    SAFE_MEMFREE(pSignature->pBuffer);
+    pSignature->length = 0;
+    pSignature->capacity = 0;
+
+CleanUp:
+
+    return retStatus;
+}
+
+// Which of the SSRCs of the transceiver the number is, it has to be exactly one of them for the slot to be filled right later
+static STATUS classifySsrc(PKvsRtpTransceiver pKvsRtpTransceiver, PCHAR pStart, PCHAR pEnd, SDP_TEMPLATE_SLOT_TYPE* pType)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 ssrc, matches = 0;
+
+    CHK_STATUS(STRTOUI32(pStart, pEnd, 10, &ssrc));
+
+    if (ssrc == pKvsRtpTransceiver->sender.ssrc) {
+        *pType = SDP_TEMPLATE_SLOT_SSRC;
+        matches++;
+    }
+    if (ssrc == pKvsRtpTransceiver->sender.rtxSsrc) {
+        *pType = SDP_TEMPLATE_SLOT_RTX_SSRC;
+        matches++;
+    }
+    if (ssrc == pKvsRtpTransceiver->sender.flexFecSsrc) {
+        *pType = SDP_TEMPLATE_SLOT_FLEXFEC_SSRC;
+        matches++;
+    }
+    CHK(matches == 1, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+
+CleanUp:
+
+    return retStatus;
+}
+
+typedef struct {
+    PCHAR pCopied;
+    PCHAR pLiteral;
+    UINT32 literalLength;
+    PSdpTemplateSlot pSlots;
+    UINT32 slotCount;
+    UINT32 maxSlotCount;
+} SdpTemplateCompiler, *PSdpTemplateCompiler;
+
+// Cuts the value out of the text, what comes before it since the last value is literal
+static STATUS compilerAddSlot(PSdpTemplateCompiler pCompiler, SDP_TEMPLATE_SLOT_TYPE type, UINT32 mediaSectionId, PCHAR pValueStart, PCHAR pValueEnd)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpTemplateSlot pSlot;
+
+    CHK(pCompiler->slotCount < pCompiler->maxSlotCount, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+
+    pSlot = &pCompiler->pSlots[pCompiler->slotCount++];
+    pSlot->literalLength = (UINT32) (pValueStart - pCompiler->pCopied);
+    pSlot->type = type;
+    pSlot->mediaSectionId = mediaSectionId;
+    MEMCPY(pCompiler->pLiteral + pCompiler->literalLength, pCompiler->pCopied, pSlot->literalLength);
+    pCompiler->literalLength += pSlot->literalLength;
+    pCompiler->pCopied = pValueEnd;
+
+CleanUp:
+
+    return retStatus;
+}
+
+// The value runs from the prefix to the end of the line and has to be the one given
+static STATUS compilerAddLineValueSlot(PSdpTemplateCompiler pCompiler, SDP_TEMPLATE_SLOT_TYPE type, UINT32 mediaSectionId, PCHAR pValueStart,
+                                       PCHAR pLineEnd, PCHAR pValue)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(STRLEN(pValue) == (SIZE_T) (pLineEnd - pValueStart) && STRNCMP(pValueStart, pValue, pLineEnd - pValueStart) == 0,
+        STATUS_SDP_TEMPLATE_UNSUPPORTED);
+    CHK_STATUS(compilerAddSlot(pCompiler, type, mediaSectionId, pValueStart, pLineEnd));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS createSdpTemplate(PSdpTemplateSignature pSignature, PKvsPeerConnection pKvsPeerConnection, PLocalMediaSections pLocalMediaSections,
+                         PCHAR pSdp, UINT64 sessionId, PSdpTemplate* ppSdpTemplate)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    SdpTemplateCompiler compiler;
+    PSdpTemplate pSdpTemplate = NULL;
+    CHAR certificateFingerprint[CERTIFICATE_FINGERPRINT_LENGTH];
+    CHAR sessionIdStr[SDP_TEMPLATE_MAX_UINT64_DIGIT_COUNT + 1];
+    PCHAR pCur, pEnd, pLineEnd, pValueStart, pValueEnd, pVerify = NULL;
+    INT32 mediaSectionId = -1;
+    BOOL attributesSeen = FALSE;
+    SDP_TEMPLATE_SLOT_TYPE type;
+    UINT32 sdpLength, verifyLength;
+
+    CHK(pSignature != NULL && pKvsPeerConnection != NULL && pLocalMediaSections != NULL && pSdp != NULL && ppSdpTemplate != NULL,
+        STATUS_NULL_ARG);
+
+    MEMSET(&compiler, 0x00, SIZEOF(SdpTemplateCompiler));
+    sdpLength = (UINT32) STRLEN(pSdp);
+    pEnd = pSdp + sdpLength;
+    compiler.pCopied = pSdp;
+
+    // Every line holds at most two values, each section a candidates slot on top of that
+    for (pCur = pSdp; pCur < pEnd; pCur++) {
+        if (*pCur == '\n') {
+            compiler.maxSlotCount += 2;
+        }
+    }
+    compiler.maxSlotCount += MAX_SDP_SESSION_MEDIA_COUNT;
+    CHK(NULL != (compiler.pSlots = (PSdpTemplateSlot) MEMALLOC(compiler.maxSlotCount * SIZEOF(SdpTemplateSlot))), STATUS_NOT_ENOUGH_MEMORY);
+    CHK(NULL != (compiler.pLiteral = (PCHAR) MEMALLOC(sdpLength + 1)), STATUS_NOT_ENOUGH_MEMORY);
+
+    CHK_STATUS(dtlsSessionGetLocalCertificateFingerprint(pKvsPeerConnection->pDtlsSession, certificateFingerprint, CERTIFICATE_FINGERPRINT_LENGTH));
+    SNPRINTF(sessionIdStr, SIZEOF(sessionIdStr), "%" PRIu64, sessionId);
+
+    pCur = pSdp;
+    while (pCur < pEnd) {
+        CHK(NULL != (pLineEnd = STRSTR(pCur, SDP_LINE_SEPARATOR)), STATUS_SDP_TEMPLATE_UNSUPPORTED);
+
+        if (SDP_TEMPLATE_HAS_PREFIX(pCur, SDP_MEDIA_NAME_MARKER)) {
+            mediaSectionId++;
+            attributesSeen = FALSE;
+        } else if (mediaSectionId >= 0 && !attributesSeen && SDP_TEMPLATE_HAS_PREFIX(pCur, SDP_ATTRIBUTE_MARKER)) {
+            // Candidates are the first attributes of a section, the slot stays even when there are none yet
+            attributesSeen = TRUE;
+            pValueStart = pCur;
+            while (pCur < pEnd && SDP_TEMPLATE_HAS_PREFIX(pCur, SDP_TEMPLATE_CANDIDATE_PREFIX)) {
+                CHK(NULL != (pLineEnd = STRSTR(pCur, SDP_LINE_SEPARATOR)), STATUS_SDP_TEMPLATE_UNSUPPORTED);
+                pCur = pLineEnd + STRLEN(SDP_LINE_SEPARATOR);
+            }
+            CHK_STATUS(compilerAddSlot(&compiler, SDP_TEMPLATE_SLOT_CANDIDATES, (UINT32) mediaSectionId, pValueStart, pCur));
+            continue;
+        } else if (SDP_TEMPLATE_HAS_PREFIX(pCur, SDP_TEMPLATE_CANDIDATE_PREFIX)) {
+            CHK(FALSE, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+        } else if (mediaSectionId < 0 && SDP_TEMPLATE_HAS_PREFIX(pCur, SDP_ORIGIN_MARKER)) {
+            // o=<username> <sess-id> <sess-version> ...
+            CHK(NULL != (pValueStart = STRCHR(pCur, ' ')) && pValueStart < pLineEnd, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+            pValueStart++;
+            CHK(NULL != (pValueEnd = STRCHR(pValueStart, ' ')) && pValueEnd < pLineEnd, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+            CHK(STRLEN(sessionIdStr) == (SIZE_T) (pValueEnd - pValueStart) && STRNCMP(pValueStart, sessionIdStr, pValueEnd - pValueStart) == 0,
+                STATUS_SDP_TEMPLATE_UNSUPPORTED);
+            CHK_STATUS(compilerAddSlot(&compiler, SDP_TEMPLATE_SLOT_SESSION_ID, 0, pValueStart, pValueEnd));
+        } else if (SDP_TEMPLATE_HAS_PREFIX(pCur, SDP_TEMPLATE_ICE_UFRAG_PREFIX)) {
+            CHK_STATUS(compilerAddLineValueSlot(&compiler, SDP_TEMPLATE_SLOT_ICE_UFRAG, 0, pCur + STRLEN(SDP_TEMPLATE_ICE_UFRAG_PREFIX), pLineEnd,
+                                                pKvsPeerConnection->localIceUfrag));
+        } else if (SDP_TEMPLATE_HAS_PREFIX(pCur, SDP_TEMPLATE_ICE_PWD_PREFIX)) {
+            CHK_STATUS(compilerAddLineValueSlot(&compiler, SDP_TEMPLATE_SLOT_ICE_PWD, 0, pCur + STRLEN(SDP_TEMPLATE_ICE_PWD_PREFIX), pLineEnd,
+                                                pKvsPeerConnection->localIcePwd));
+        } else if (SDP_TEMPLATE_HAS_PREFIX(pCur, SDP_TEMPLATE_FINGERPRINT_PREFIX)) {
+            CHK_STATUS(compilerAddLineValueSlot(&compiler, SDP_TEMPLATE_SLOT_FINGERPRINT, 0, pCur + STRLEN(SDP_TEMPLATE_FINGERPRINT_PREFIX), pLineEnd,
+                                                certificateFingerprint));
+        } else if (SDP_TEMPLATE_HAS_PREFIX(pCur, SDP_TEMPLATE_SSRC_PREFIX)) {
+            // a=ssrc:<ssrc> <attribute>, only our own media sections announce SSRCs
+            CHK(mediaSectionId >= 0 && (UINT32) mediaSectionId < pLocalMediaSections->count, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+            pValueStart = pCur + STRLEN(SDP_TEMPLATE_SSRC_PREFIX);
+            CHK(NULL != (pValueEnd = STRCHR(pValueStart, ' ')) && pValueEnd < pLineEnd, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+            CHK_STATUS(classifySsrc(pLocalMediaSections->transceivers[mediaSectionId], pValueStart, pValueEnd, &type));
+            CHK_STATUS(compilerAddSlot(&compiler, type, (UINT32) mediaSectionId, pValueStart, pValueEnd));
+            if (SDP_TEMPLATE_HAS_PREFIX(pValueEnd, SDP_TEMPLATE_CNAME_PREFIX)) {
+                CHK_STATUS(compilerAddLineValueSlot(&compiler, SDP_TEMPLATE_SLOT_CNAME, 0, pValueEnd + STRLEN(SDP_TEMPLATE_CNAME_PREFIX), pLineEnd,
+                                                    pKvsPeerConnection->localCNAME));
+            }
+        } else if (SDP_TEMPLATE_HAS_PREFIX(pCur, SDP_TEMPLATE_SSRC_GROUP_PREFIX)) {
+            // a=ssrc-group:<semantics> <ssrc> <ssrc>
+            CHK(mediaSectionId >= 0 && (UINT32) mediaSectionId < pLocalMediaSections->count, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+            CHK(NULL != (pValueStart = STRCHR(pCur, ' ')) && pValueStart < pLineEnd, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+            pValueStart++;
+            CHK(NULL != (pValueEnd = STRCHR(pValueStart, ' ')) && pValueEnd < pLineEnd, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+            CHK_STATUS(classifySsrc(pLocalMediaSections->transceivers[mediaSectionId], pValueStart, pValueEnd, &type));
+            CHK_STATUS(compilerAddSlot(&compiler, type, (UINT32) mediaSectionId, pValueStart, pValueEnd));
+            pValueStart = pValueEnd + 1;
+            CHK_STATUS(classifySsrc(pLocalMediaSections->transceivers[mediaSectionId], pValueStart, pLineEnd, &type));
+            CHK_STATUS(compilerAddSlot(&compiler, type, (UINT32) mediaSectionId, pValueStart, pLineEnd));
+        }
+
+        pCur = pLineEnd + STRLEN(SDP_LINE_SEPARATOR);
+    }
+
+    MEMCPY(compiler.pLiteral + compiler.literalLength, compiler.pCopied, pEnd - compiler.pCopied);
+    compiler.literalLength += (UINT32) (pEnd - compiler.pCopied);
+
+    CHK(NULL !=
+            (pSdpTemplate = (PSdpTemplate) MEMALLOC(SIZEOF(SdpTemplate) + compiler.slotCount * SIZEOF(SdpTemplateSlot) + compiler.literalLength +
+                                                    pSignature->length)),
+        STATUS_NOT_ENOUGH_MEMORY);
+    pSdpTemplate->slotCount = compiler.slotCount;
+    pSdpTemplate->pSlots = (PSdpTemplateSlot) (pSdpTemplate + 1);
+    MEMCPY(pSdpTemplate->pSlots, compiler.pSlots, compiler.slotCount * SIZEOF(SdpTemplateSlot));
+    pSdpTemplate->literalLength = compiler.literalLength;
+    pSdpTemplate->pLiteral = (PCHAR) (pSdpTemplate->pSlots + compiler.slotCount);
+    MEMCPY(pSdpTemplate->pLiteral, compiler.pLiteral, compiler.literalLength);
+    pSdpTemplate->signatureHash = pSignature->hash;
+    pSdpTemplate->signatureLength = pSignature->length;
+    pSdpTemplate->pSignature = (PBYTE) (pSdpTemplate->pLiteral + compiler.literalLength);
+    MEMCPY(pSdpTemplate->pSignature, pSignature->pBuffer, pSignature->length);
+
+    // Only ever hand out templates that give back the very text they were compiled from
+    verifyLength = sdpLength + 1;
+    CHK(NULL != (pVerify = (PCHAR) MEMALLOC(verifyLength)), STATUS_NOT_ENOUGH_MEMORY);
+    retStatus = sdpTemplateRender(pSdpTemplate, pKvsPeerConnection, pLocalMediaSections, sessionId, pVerify, &verifyLength);
+    CHK(retStatus == STATUS_SUCCESS || retStatus == STATUS_BUFFER_TOO_SMALL, retStatus);
+    CHK(retStatus == STATUS_SUCCESS && verifyLength == sdpLength + 1 && MEMCMP(pVerify, pSdp, sdpLength) == 0, STATUS_SDP_TEMPLATE_UNSUPPORTED);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freeSdpTemplate(&pSdpTemplate);
+    }
+
+    if (ppSdpTemplate != NULL) {
+        *ppSdpTemplate = pSdpTemplate;
+    }
+
+    SAFE_MEMFREE(compiler.pSlots);
+    SAFE_MEMFREE(compiler.pLiteral);
+    SAFE_MEMFREE(pVerify);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeSdpTemplate(PSdpTemplate* ppSdpTemplate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(ppSdpTemplate != NULL, STATUS_NULL_ARG);
+
+    // Slots, literal text and signature are part of the same allocation
+    SAFE_MEMFREE(*ppSdpTemplate);
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS renderWrite(PCHAR* ppCur, PCHAR pLimit, PCHAR pData, UINT32 length)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK((SIZE_T) (pLimit - *ppCur) >= length, STATUS_BUFFER_TOO_SMALL);
+    MEMCPY(*ppCur, pData, length);
+    *ppCur += length;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS sdpTemplateRender(PSdpTemplate pSdpTemplate, PKvsPeerConnection pKvsPeerConnection, PLocalMediaSections pLocalMediaSections, UINT64 sessionId,
+                         PCHAR pOutput, PUINT32 pOutputLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    CHAR value[CERTIFICATE_FINGERPRINT_LENGTH];
+    PCHAR pCur, pLimit, pLiteral, pCandidates = NULL, pValue;
+    PSdpTemplateSlot pSlot;
+    UINT32 i, candidatesLength = 0;
+
+    CHK(pSdpTemplate != NULL && pKvsPeerConnection != NULL && pLocalMediaSections != NULL && pOutput != NULL && pOutputLength != NULL,
+        STATUS_NULL_ARG);
+
+    pCur = pOutput;
+    pLimit = pOutput + *pOutputLength;
+    pLiteral = pSdpTemplate->pLiteral;
+
+    for (i = 0; i < pSdpTemplate->slotCount; i++) {
+        pSlot = &pSdpTemplate->pSlots[i];
+        CHK_STATUS(renderWrite(&pCur, pLimit, pLiteral, pSlot->literalLength));
+        pLiteral += pSlot->literalLength;
+
+        pValue = value;
+        switch (pSlot->type) {
+            case SDP_TEMPLATE_SLOT_SESSION_ID:
+                SNPRINTF(value, SIZEOF(value), "%" PRIu64, sessionId);
+                break;
+            case SDP_TEMPLATE_SLOT_ICE_UFRAG:
+                pValue = pKvsPeerConnection->localIceUfrag;
+                break;
+            case SDP_TEMPLATE_SLOT_ICE_PWD:
+                pValue = pKvsPeerConnection->localIcePwd;
+                break;
+            case SDP_TEMPLATE_SLOT_FINGERPRINT:
+                CHK_STATUS(dtlsSessionGetLocalCertificateFingerprint(pKvsPeerConnection->pDtlsSession, value, CERTIFICATE_FINGERPRINT_LENGTH));
+                break;
+            case SDP_TEMPLATE_SLOT_CNAME:
+                pValue = pKvsPeerConnection->localCNAME;
+                break;
+            case SDP_TEMPLATE_SLOT_CANDIDATES:
+                // Every section carries the same candidates, serialize them once and copy them over to the next sections
+                pValue = NULL;
+                if (pCandidates == NULL) {
+                    CHK_STATUS(iceAgentSerializeSdpCandidates(pKvsPeerConnection->pIceAgent, pCur, (UINT32) (pLimit - pCur), &candidatesLength));
+                    pCandidates = pCur;
+                    pCur += candidatesLength;
+                } else {
+                    CHK_STATUS(renderWrite(&pCur, pLimit, pCandidates, candidatesLength));
+                }
+                break;
+            case SDP_TEMPLATE_SLOT_SSRC:
+                CHK(pSlot->mediaSectionId < pLocalMediaSections->count, STATUS_INVALID_ARG);
+                SNPRINTF(value, SIZEOF(value), "%u", pLocalMediaSections->transceivers[pSlot->mediaSectionId]->sender.ssrc);
+                break;
+            case SDP_TEMPLATE_SLOT_RTX_SSRC:
+                CHK(pSlot->mediaSectionId < pLocalMediaSections->count, STATUS_INVALID_ARG);
+                SNPRINTF(value, SIZEOF(value), "%u", pLocalMediaSections->transceivers[pSlot->mediaSectionId]->sender.rtxSsrc);
+                break;
+            case SDP_TEMPLATE_SLOT_FLEXFEC_SSRC:
+                CHK(pSlot->mediaSectionId < pLocalMediaSections->count, STATUS_INVALID_ARG);
+                SNPRINTF(value, SIZEOF(value), "%u", pLocalMediaSections->transceivers[pSlot->mediaSectionId]->sender.flexFecSsrc);
+                break;
+        }
+
+        if (pValue != NULL) {
+            CHK_STATUS(renderWrite(&pCur, pLimit, pValue, (UINT32) STRLEN(pValue)));
+        }
+    }
+
+    CHK_STATUS(renderWrite(&pCur, pLimit, pLiteral, (UINT32) (pSdpTemplate->pLiteral + pSdpTemplate->literalLength - pLiteral)));
+    CHK(pCur < pLimit, STATUS_BUFFER_TOO_SMALL);
+    *pCur++ = '\0';
+
+    *pOutputLength = (UINT32) (pCur - pOutput);
+
+CleanUp:
+
+    return retStatus;
+}
@@ -0,0 +1,107 @@
+/*******************************************
+SDP template internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_SDPTEMPLATE__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_SDPTEMPLATE__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Configurations whose local description is kept as a template, the ones seen after that are always populated
+#define SDP_TEMPLATE_CACHE_MAX_COUNT 16
+
+#define SDP_TEMPLATE_SIGNATURE_INITIAL_CAPACITY 1024
+
+/*
+ * Values of a local description that change from one session to the next while the rest of the text only depends on the
+ * configuration. SSRC slots take the value from the transceiver of their media section.
+ */
+typedef enum {
+    SDP_TEMPLATE_SLOT_SESSION_ID,
+    SDP_TEMPLATE_SLOT_ICE_UFRAG,
+    SDP_TEMPLATE_SLOT_ICE_PWD,
+    SDP_TEMPLATE_SLOT_FINGERPRINT,
+    SDP_TEMPLATE_SLOT_CNAME,
+    // Every a=candidate line of the section
+    SDP_TEMPLATE_SLOT_CANDIDATES,
+    SDP_TEMPLATE_SLOT_SSRC,
+    SDP_TEMPLATE_SLOT_RTX_SSRC,
+    SDP_TEMPLATE_SLOT_FLEXFEC_SSRC,
+} SDP_TEMPLATE_SLOT_TYPE;
+
+typedef struct {
+    // Length of the literal text preceding the value
+    UINT32 literalLength;
+    SDP_TEMPLATE_SLOT_TYPE type;
+    UINT32 mediaSectionId;
+} SdpTemplateSlot, *PSdpTemplateSlot;
+
+/*
+ * Serialized local description with the per-session values cut out. The slots, the literal text and the configuration
+ * signature the template was compiled for are allocated along with the struct.
+ */
+typedef struct {
+    UINT64 signatureHash;
+    UINT32 signatureLength;
+    PBYTE pSignature;
+
+    UINT32 slotCount;
+    PSdpTemplateSlot pSlots;
+
+    UINT32 literalLength;
+    PCHAR pLiteral;
+} SdpTemplate, *PSdpTemplate;
+
+typedef struct {
+    UINT64 hash;
+    UINT32 length;
+    UINT32 capacity;
+    PBYTE pBuffer;
+} SdpTemplateSignature, *PSdpTemplateSignature;
+
+typedef struct {
+    UINT64 hits;
+    UINT64 misses;
+    UINT32 templateCount;
+} SdpTemplateCacheStats, *PSdpTemplateCacheStats;
+
+/**
+ * Everything besides the per-session values the local description is generated from: the peer connection settings, the
+ * transceivers of the sections and what the description takes from the remote one.
+ */
+STATUS buildSdpTemplateSignature(PKvsPeerConnection, PLocalMediaSections, PSdpTemplateSignature);
+STATUS freeSdpTemplateSignature(PSdpTemplateSignature);
+
+/**
+ * Compiles the serialized local description of the KvsPeerConnection, generated from the given sections with the given
+ * session id, into a template. Fails with STATUS_SDP_TEMPLATE_UNSUPPORTED when the text can't be told apart from the
+ * per-session values.
+ */
+STATUS createSdpTemplate(PSdpTemplateSignature, PKvsPeerConnection, PLocalMediaSections, PCHAR, UINT64, PSdpTemplate*);
+STATUS freeSdpTemplate(PSdpTemplate*);
+
+/**
+ * Fills the template with the per-session values of the KvsPeerConnection into the buffer of the given size, NULL
+ * terminated. The length written, NULL included, is returned in the last argument.
+ */
+STATUS sdpTemplateRender(PSdpTemplate, PKvsPeerConnection, PLocalMediaSections, UINT64, PCHAR, PUINT32);
+
+/**
+ * Templates are shared by all peer connections of the process and live until deinitSdpTemplateCache
+ */
+STATUS sdpTemplateCacheGet(PSdpTemplateSignature, PSdpTemplate*);
+STATUS sdpTemplateCachePut(PSdpTemplate);
+STATUS sdpTemplateCacheGetStats(PSdpTemplateCacheStats);
+
+/*
+ * All peer connections must have been freed before calling this
+ */
+STATUS deinitSdpTemplateCache(VOID);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_SDPTEMPLATE__ */
@@ -138,6 +138,9 @@ STATUS setPayloadTypesForOffer(PHashTable codecTable)
     CHK_STATUS(hashTableUpsert(codecTable, RTC_CODEC_VP8, DEFAULT_PAYLOAD_VP8));
     CHK_STATUS(hashTableUpsert(codecTable, RTC_CODEC_OPUS, DEFAULT_PAYLOAD_OPUS));
     CHK_STATUS(hashTableUpsert(codecTable, RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE, DEFAULT_PAYLOAD_H264));
+    CHK_STATUS(hashTableUpsert(codecTable, RTC_CODEC_H265, DEFAULT_PAYLOAD_H265));
+    CHK_STATUS(hashTableUpsert(codecTable, RTC_CODEC_AV1, DEFAULT_PAYLOAD_AV1));
+    CHK_STATUS(hashTableUpsert(codecTable, RTC_CODEC_VP9, DEFAULT_PAYLOAD_VP9));
 
 CleanUp:
     return retStatus;
@@ -160,12 +163,14 @@ STATUS setPayloadTypesFromOffer(PHashTable codecTable, PHashTable rtxTable, PSes
     BOOL supportCodec;
     UINT32 tokenLen, i, aptFmtpValCount;
     PCHAR fmtp;
-    UINT64 fmtpScore, bestFmtpScore;
+    UINT64 fmtpScore, bestFmtpScore, bestH265FmtpScore, bestVP9FmtpScore;
 
     for (currentMedia = 0; currentMedia < pSessionDescription->mediaCount; currentMedia++) {
         pMediaDescription = &(pSessionDescription->mediaDescriptions[currentMedia]);
         aptFmtpValCount = 0;
         bestFmtpScore = 0;
+        bestH265FmtpScore = 0;
+        bestVP9FmtpScore = 0;
         attributeValue = pMediaDescription->mediaName;
         do {
             if ((end = STRCHR(attributeValue, ' ')) != NULL) {
@@ -203,6 +208,19 @@ STATUS setPayloadTypesFromOffer(PHashTable codecTable, PHashTable rtxTable, PSes
                 }
             }
 
+            CHK_STATUS(hashTableContains(codecTable, RTC_CODEC_H265, &supportCodec));
+            if (supportCodec && (end = STRSTR(attributeValue, H265_VALUE)) != NULL) {
+                CHK_STATUS(STRTOUI64(attributeValue, end - 1, 10, &parsedPayloadType));
+                fmtp = fmtpForPayloadType(parsedPayloadType, pSessionDescription);
+                fmtpScore = getH265FmtpScore(fmtp);
+                // The last payload type wins a tie like H264, but a zero score is a mode the depayloader can't handle and is never picked
+                if (fmtpScore > 0 && fmtpScore >= bestH265FmtpScore) {
+                    DLOGV("Found H265 payload type %" PRId64 " with score %lu: %s", parsedPayloadType, fmtpScore, fmtp);
+                    CHK_STATUS(hashTableUpsert(codecTable, RTC_CODEC_H265, parsedPayloadType));
+                    bestH265FmtpScore = fmtpScore;
+                }
+            }
+
             CHK_STATUS(hashTableContains(codecTable, RTC_CODEC_OPUS, &supportCodec));
             if (supportCodec && (end = STRSTR(attributeValue, OPUS_VALUE)) != NULL) {
                 CHK_STATUS(STRTOUI64(attributeValue, end - 1, 10, &parsedPayloadType));
@@ -215,6 +233,23 @@ STATUS setPayloadTypesFromOffer(PHashTable codecTable, PHashTable rtxTable, PSes
                 CHK_STATUS(hashTableUpsert(codecTable, RTC_CODEC_VP8, parsedPayloadType));
             }
 
+            CHK_STATUS(hashTableContains(codecTable, RTC_CODEC_VP9, &supportCodec));
+            if (supportCodec && (end = STRSTR(attributeValue, VP9_VALUE)) != NULL) {
+                CHK_STATUS(STRTOUI64(attributeValue, end - 1, 10, &parsedPayloadType));
+                fmtpScore = getVP9FmtpScore(fmtpForPayloadType(parsedPayloadType, pSessionDescription));
+                // Browsers offer every profile they decode, profile 0 is preferred and the last payload type wins a tie
+                if (fmtpScore >= bestVP9FmtpScore) {
+                    CHK_STATUS(hashTableUpsert(codecTable, RTC_CODEC_VP9, parsedPayloadType));
+                    bestVP9FmtpScore = fmtpScore;
+                }
+            }
+
+            CHK_STATUS(hashTableContains(codecTable, RTC_CODEC_AV1, &supportCodec));
+            if (supportCodec && (end = STRSTR(attributeValue, AV1_VALUE)) != NULL) {
+                CHK_STATUS(STRTOUI64(attributeValue, end - 1, 10, &parsedPayloadType));
+                CHK_STATUS(hashTableUpsert(codecTable, RTC_CODEC_AV1, parsedPayloadType));
+            }
+
             CHK_STATUS(hashTableContains(codecTable, RTC_CODEC_MULAW, &supportCodec));
             if (supportCodec && (end = STRSTR(attributeValue, MULAW_VALUE)) != NULL) {
                 CHK_STATUS(STRTOUI64(attributeValue, end - 1, 10, &parsedPayloadType));
@@ -257,6 +292,30 @@ STATUS setPayloadTypesFromOffer(PHashTable codecTable, PHashTable rtxTable, PSes
                     CHK_STATUS(hashTableUpsert(rtxTable, RTC_RTX_CODEC_VP8, fmtpVal));
                 }
             }
+
+            CHK_STATUS(hashTableContains(codecTable, RTC_CODEC_H265, &supportCodec));
+            if (supportCodec) {
+                CHK_STATUS(hashTableGet(codecTable, RTC_CODEC_H265, &hashmapPayloadType));
+                if (aptVal == hashmapPayloadType) {
+                    CHK_STATUS(hashTableUpsert(rtxTable, RTC_RTX_CODEC_H265, fmtpVal));
+                }
+            }
+
+            CHK_STATUS(hashTableContains(codecTable, RTC_CODEC_AV1, &supportCodec));
+            if (supportCodec) {
+                CHK_STATUS(hashTableGet(codecTable, RTC_CODEC_AV1, &hashmapPayloadType));
+                if (aptVal == hashmapPayloadType) {
+                    CHK_STATUS(hashTableUpsert(rtxTable, RTC_RTX_CODEC_AV1, fmtpVal));
+                }
+            }
+
+            CHK_STATUS(hashTableContains(codecTable, RTC_CODEC_VP9, &supportCodec));
+            if (supportCodec) {
+                CHK_STATUS(hashTableGet(codecTable, RTC_CODEC_VP9, &hashmapPayloadType));
+                if (aptVal == hashmapPayloadType) {
+                    CHK_STATUS(hashTableUpsert(rtxTable, RTC_RTX_CODEC_VP9, fmtpVal));
+                }
+            }
         }
     }
 
@@ -384,24 +443,96 @@ UINT64 getH264FmtpScore(PCHAR fmtp)
     return score;
 }
 
+/*
+ * Extracts a decimal value after the provided parameter name. Only whole
+ * names match, so "level-id=" is not found in "max-recv-level-id=". Returns
+ * true if successful.
+ */
+BOOL readDecimalValue(PCHAR input, PCHAR prefix, PUINT32 value)
+{
+    PCHAR substr = STRSTR(input, prefix);
+    while (substr != NULL && substr != input && substr[-1] != ';' && substr[-1] != ' ') {
+        substr = STRSTR(substr + 1, prefix);
+    }
+    if (substr != NULL && SSCANF(substr + STRLEN(prefix), "%u", value) == 1) {
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ * Scores the provided fmtp string based on this library's ability to
+ * process various types of H265 streams. All H265 fmtp parameters are
+ * optional, so a missing fmtp line scores like one carrying the defaults.
+ * A score of 0 indicates an incompatible fmtp line: the depayloader only
+ * handles single stream transmission without DONL fields. Beyond this, a
+ * higher score indicates a match with the Main profile, the Main tier and
+ * a peer able to decode at least the level we offer.
+ */
+UINT64 getH265FmtpScore(PCHAR fmtp)
+{
+    UINT32 profileId = H265_FMTP_DEFAULT_PROFILE_ID, tierFlag = H265_FMTP_DEFAULT_TIER_FLAG, levelId = H265_FMTP_DEFAULT_LEVEL_ID;
+    UINT32 maxDonDiff = 0;
+    UINT64 score = 0;
+
+    if (fmtp != NULL) {
+        // https://tools.ietf.org/html/rfc7798#section-4.4
+        if ((STRSTR(fmtp, "tx-mode=") != NULL && STRSTR(fmtp, "tx-mode=SRST") == NULL) ||
+            (readDecimalValue(fmtp, "sprop-max-don-diff=", &maxDonDiff) && maxDonDiff != 0)) {
+            return 0;
+        }
+
+        readDecimalValue(fmtp, "profile-id=", &profileId);
+        readDecimalValue(fmtp, "tier-flag=", &tierFlag);
+        readDecimalValue(fmtp, "level-id=", &levelId);
+    }
+
+    if (profileId == H265_FMTP_DEFAULT_PROFILE_ID) {
+        score++;
+    }
+
+    if (tierFlag == H265_FMTP_DEFAULT_TIER_FLAG) {
+        score++;
+    }
+
+    if (levelId >= H265_FMTP_DEFAULT_LEVEL_ID) {
+        score++;
+    }
+
+    return score;
+}
+
+/*
+ * Scores the provided VP9 fmtp string. The depayloader handles every profile, but
+ * profile 0 is the one every decoder supports, so it scores higher than the others.
+ */
+UINT64 getVP9FmtpScore(PCHAR fmtp)
+{
+    UINT32 profileId = VP9_FMTP_DEFAULT_PROFILE_ID;
+
+    if (fmtp != NULL) {
+        readDecimalValue(fmtp, "profile-id=", &profileId);
+    }
+
+    return profileId == VP9_FMTP_DEFAULT_PROFILE_ID ? 1 : 0;
+}
+
 // Populate a single media section from a PKvsRtpTransceiver
 STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtpTransceiver pKvsRtpTransceiver,
-                                  PSdpMediaDescription pSdpMediaDescription, PSessionDescription pRemoteSessionDescription,
+                                  PSessionDescription pLocalSessionDescription, PSessionDescription pRemoteSessionDescription,
                                   PCHAR pCertificateFingerprint, UINT32 mediaSectionId, PCHAR pDtlsRole, PHashTable pUnknownCodecPayloadTypesTable,
                                   PHashTable pUnknownCodecRtpmapTable, UINT32 unknownCodecHashTableKey)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     UINT64 payloadType, rtxPayloadType;
-    BOOL containRtx = FALSE;
-    BOOL directionFound = FALSE;
-    UINT32 i, remoteAttributeCount, attributeCount = 0;
+    BOOL containRtx = FALSE, containFlexFec = FALSE, containRed = FALSE;
+    UINT32 i, remoteAttributeCount;
     PRtcMediaStreamTrack pRtcMediaStreamTrack = &(pKvsRtpTransceiver->sender.track);
+    PSdpMediaDescription pSdpMediaDescription = &pLocalSessionDescription->mediaDescriptions[mediaSectionId];
     PSdpMediaDescription pSdpMediaDescriptionRemote;
-    PCHAR currentFmtp = NULL, rtpMapValue = NULL;
-    CHAR remoteSdpAttributeValue[MAX_SDP_ATTRIBUTE_VALUE_LENGTH];
-
-    MEMSET(remoteSdpAttributeValue, 0, MAX_SDP_ATTRIBUTE_VALUE_LENGTH);
+    PCHAR currentFmtp = NULL, rtpMapValue = NULL, pRemoteMid = NULL, pDirection = EMPTY_STRING;
+    CHAR mediaName[MAX_SDP_MEDIA_NAME_LENGTH + 1];
 
     if (pRtcMediaStreamTrack->codec == RTC_CODEC_UNKNOWN && pUnknownCodecPayloadTypesTable != NULL) {
         CHK_STATUS(hashTableGet(pUnknownCodecPayloadTypesTable, unknownCodecHashTableKey, &payloadType));
@@ -416,6 +547,12 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
                                      &rtxPayloadType);
         } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_VP8) {
             retStatus = hashTableGet(pKvsPeerConnection->pRtxTable, RTC_RTX_CODEC_VP8, &rtxPayloadType);
+        } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_H265) {
+            retStatus = hashTableGet(pKvsPeerConnection->pRtxTable, RTC_RTX_CODEC_H265, &rtxPayloadType);
+        } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_AV1) {
+            retStatus = hashTableGet(pKvsPeerConnection->pRtxTable, RTC_RTX_CODEC_AV1, &rtxPayloadType);
+        } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_VP9) {
+            retStatus = hashTableGet(pKvsPeerConnection->pRtxTable, RTC_RTX_CODEC_VP9, &rtxPayloadType);
         } else {
             retStatus = STATUS_HASH_KEY_NOT_PRESENT;
         }
@@ -423,135 +560,106 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
         containRtx = (retStatus == STATUS_SUCCESS);
         retStatus = STATUS_SUCCESS;
         if (containRtx) {
-            SPRINTF(pSdpMediaDescription->mediaName, "video 9 UDP/TLS/RTP/SAVPF %" PRId64 " %" PRId64, payloadType, rtxPayloadType);
+            SPRINTF(mediaName, "video 9 UDP/TLS/RTP/SAVPF %" PRId64 " %" PRId64, payloadType, rtxPayloadType);
         } else {
-            SPRINTF(pSdpMediaDescription->mediaName, "video 9 UDP/TLS/RTP/SAVPF %" PRId64, payloadType);
+            SPRINTF(mediaName, "video 9 UDP/TLS/RTP/SAVPF %" PRId64, payloadType);
+        }
+        containFlexFec = pKvsPeerConnection->flexFecPayloadType != 0 && pRtcMediaStreamTrack->codec != RTC_CODEC_UNKNOWN;
+        if (containFlexFec) {
+            SPRINTF(mediaName + STRLEN(mediaName), " %u", pKvsPeerConnection->flexFecPayloadType);
         }
+        CHK_STATUS(sdpArenaPrintf(pLocalSessionDescription, &pSdpMediaDescription->mediaName, "%s", mediaName));
     } else if (pRtcMediaStreamTrack->kind == MEDIA_STREAM_TRACK_KIND_AUDIO) {
-        SPRINTF(pSdpMediaDescription->mediaName, "audio 9 UDP/TLS/RTP/SAVPF %" PRId64, payloadType);
+        SPRINTF(mediaName, "audio 9 UDP/TLS/RTP/SAVPF %" PRId64, payloadType);
+        containRed = pKvsPeerConnection->redPayloadType != 0 && pRtcMediaStreamTrack->codec == RTC_CODEC_OPUS;
+        if (containRed) {
+            SPRINTF(mediaName + STRLEN(mediaName), " %u", pKvsPeerConnection->redPayloadType);
+        }
+        CHK_STATUS(sdpArenaPrintf(pLocalSessionDescription, &pSdpMediaDescription->mediaName, "%s", mediaName));
     }
 
-    CHK_STATUS(iceAgentPopulateSdpMediaDescriptionCandidates(pKvsPeerConnection->pIceAgent, pSdpMediaDescription, MAX_SDP_ATTRIBUTE_VALUE_LENGTH,
-                                                             &attributeCount));
+    CHK_STATUS(iceAgentPopulateSdpMediaDescriptionCandidates(pKvsPeerConnection->pIceAgent, pLocalSessionDescription, pSdpMediaDescription));
 
     if (containRtx) {
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "msid");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%s %sRTX", pRtcMediaStreamTrack->streamId,
-                pRtcMediaStreamTrack->trackId);
-        attributeCount++;
-
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc-group");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "FID %u %u", pKvsRtpTransceiver->sender.ssrc,
-                pKvsRtpTransceiver->sender.rtxSsrc);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "msid", "%s %sRTX", pRtcMediaStreamTrack->streamId,
+                                        pRtcMediaStreamTrack->trackId));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc-group", "FID %u %u", pKvsRtpTransceiver->sender.ssrc,
+                                        pKvsRtpTransceiver->sender.rtxSsrc));
     } else {
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "msid");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%s %s", pRtcMediaStreamTrack->streamId,
-                pRtcMediaStreamTrack->trackId);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "msid", "%s %s", pRtcMediaStreamTrack->streamId,
+                                        pRtcMediaStreamTrack->trackId));
     }
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
-    SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u cname:%s", pKvsRtpTransceiver->sender.ssrc,
-            pKvsPeerConnection->localCNAME);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u cname:%s", pKvsRtpTransceiver->sender.ssrc,
+                                    pKvsPeerConnection->localCNAME));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
-    SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u msid:%s %s", pKvsRtpTransceiver->sender.ssrc,
-            pRtcMediaStreamTrack->streamId, pRtcMediaStreamTrack->trackId);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u msid:%s %s", pKvsRtpTransceiver->sender.ssrc,
+                                    pRtcMediaStreamTrack->streamId, pRtcMediaStreamTrack->trackId));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
-    SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u mslabel:%s", pKvsRtpTransceiver->sender.ssrc,
-            pRtcMediaStreamTrack->streamId);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u mslabel:%s", pKvsRtpTransceiver->sender.ssrc,
+                                    pRtcMediaStreamTrack->streamId));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
-    SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u label:%s", pKvsRtpTransceiver->sender.ssrc,
-            pRtcMediaStreamTrack->trackId);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u label:%s", pKvsRtpTransceiver->sender.ssrc,
+                                    pRtcMediaStreamTrack->trackId));
 
     if (containRtx) {
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u cname:%s", pKvsRtpTransceiver->sender.rtxSsrc,
-                pKvsPeerConnection->localCNAME);
-        attributeCount++;
-
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u msid:%s %sRTX", pKvsRtpTransceiver->sender.rtxSsrc,
-                pRtcMediaStreamTrack->streamId, pRtcMediaStreamTrack->trackId);
-        attributeCount++;
-
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u mslabel:%sRTX", pKvsRtpTransceiver->sender.rtxSsrc,
-                pRtcMediaStreamTrack->streamId);
-        attributeCount++;
-
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u label:%sRTX", pKvsRtpTransceiver->sender.rtxSsrc,
-                pRtcMediaStreamTrack->trackId);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u cname:%s", pKvsRtpTransceiver->sender.rtxSsrc,
+                                        pKvsPeerConnection->localCNAME));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u msid:%s %sRTX",
+                                        pKvsRtpTransceiver->sender.rtxSsrc, pRtcMediaStreamTrack->streamId, pRtcMediaStreamTrack->trackId));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u mslabel:%sRTX",
+                                        pKvsRtpTransceiver->sender.rtxSsrc, pRtcMediaStreamTrack->streamId));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u label:%sRTX", pKvsRtpTransceiver->sender.rtxSsrc,
+                                        pRtcMediaStreamTrack->trackId));
     }
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "9 IN IP4 0.0.0.0");
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp", "9 IN IP4 0.0.0.0"));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ice-ufrag");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, pKvsPeerConnection->localIceUfrag);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ice-ufrag", "%s", pKvsPeerConnection->localIceUfrag));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ice-pwd");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, pKvsPeerConnection->localIcePwd);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ice-pwd", "%s", pKvsPeerConnection->localIcePwd));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ice-options");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "trickle");
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ice-options", "trickle"));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "fingerprint");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "sha-256 ");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue + 8, pCertificateFingerprint);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fingerprint", "sha-256 %s", pCertificateFingerprint));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "setup");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, pDtlsRole);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "setup", "%s", pDtlsRole));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "mid");
-    // check all session attribute lines to see if a line with mid is present. If it is present, copy its content and break
+    // check all session attribute lines to see if a line with mid is present. If it is present, use its content and break
     for (i = 0; i < pRemoteSessionDescription->mediaDescriptions[mediaSectionId].mediaAttributesCount; i++) {
         if (STRCMP(pRemoteSessionDescription->mediaDescriptions[mediaSectionId].sdpAttributes[i].attributeName, MID_KEY) == 0) {
-            STRCPY(remoteSdpAttributeValue, pRemoteSessionDescription->mediaDescriptions[mediaSectionId].sdpAttributes[i].attributeValue);
+            pRemoteMid = pRemoteSessionDescription->mediaDescriptions[mediaSectionId].sdpAttributes[i].attributeValue;
             break;
         }
     }
 
     // check if we already have a value for the "mid" session attribute from remote description. If we have it, we use it.
     // If we don't have it, we loop over, create and add them
-    if (STRLEN(remoteSdpAttributeValue) > 0) {
-        CHK(STRLEN(remoteSdpAttributeValue) < MAX_SDP_ATTRIBUTE_VALUE_LENGTH, STATUS_BUFFER_TOO_SMALL);
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%s", remoteSdpAttributeValue);
+    if (!IS_EMPTY_SDP_FIELD(pRemoteMid)) {
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "mid", "%s", pRemoteMid));
     } else {
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%d", mediaSectionId);
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "mid", "%d", mediaSectionId));
     }
-    attributeCount++;
 
     if (pKvsPeerConnection->isOffer) {
         switch (pKvsRtpTransceiver->transceiver.direction) {
             case RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV:
-                STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "sendrecv");
+                pDirection = "sendrecv";
                 break;
             case RTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY:
-                STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "sendonly");
+                pDirection = "sendonly";
                 break;
             case RTC_RTP_TRANSCEIVER_DIRECTION_RECVONLY:
-                STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "recvonly");
+                pDirection = "recvonly";
                 break;
             default:
                 // https://www.w3.org/TR/webrtc/#dom-rtcrtptransceiverdirection
                 DLOGW("Incorrect/no transceiver direction set...this attribute will be set to inactive");
-                STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "inactive");
+                pDirection = "inactive";
         }
     } else {
         pSdpMediaDescriptionRemote = &pRemoteSessionDescription->mediaDescriptions[mediaSectionId];
@@ -559,31 +667,25 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
 
         // in case of a missing m-line, we respond with the same m-line but direction set to inactive
         if (pKvsRtpTransceiver->transceiver.direction == RTC_RTP_TRANSCEIVER_DIRECTION_INACTIVE) {
-            STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "inactive");
-            directionFound = TRUE;
+            pDirection = "inactive";
         }
-        for (i = 0; i < remoteAttributeCount && directionFound == FALSE; i++) {
+        for (i = 0; i < remoteAttributeCount && pDirection[0] == '\0'; i++) {
             if (STRCMP(pSdpMediaDescriptionRemote->sdpAttributes[i].attributeName, "sendrecv") == 0) {
-                STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "sendrecv");
-                directionFound = TRUE;
+                pDirection = "sendrecv";
             } else if (STRCMP(pSdpMediaDescriptionRemote->sdpAttributes[i].attributeName, "recvonly") == 0) {
-                STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "sendonly");
-                directionFound = TRUE;
+                pDirection = "sendonly";
             } else if (STRCMP(pSdpMediaDescriptionRemote->sdpAttributes[i].attributeName, "sendonly") == 0) {
-                STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "recvonly");
-                directionFound = TRUE;
+                pDirection = "recvonly";
             }
         }
     }
 
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, pDirection, NULL));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp-mux");
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-mux", NULL));
 
     if (mediaSectionId != 0) {
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp-rsize");
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-rsize", NULL));
     }
 
     if (pRtcMediaStreamTrack->codec == RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE) {
@@ -591,96 +693,148 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
         if (pKvsPeerConnection->isOffer) {
             currentFmtp = DEFAULT_H264_FMTP;
         }
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtpmap");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " H264/90000", payloadType);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " H264/90000", payloadType));
 
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp-fb");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " nack", payloadType);
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " nack pli", payloadType);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-fb", "%" PRId64 " nack pli", payloadType));
 
         // TODO: If level asymmetry is allowed, consider sending back DEFAULT_H264_FMTP instead of the received fmtp value.
         if (currentFmtp != NULL) {
-            STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "fmtp");
-            SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " %s", payloadType, currentFmtp);
-            attributeCount++;
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%" PRId64 " %s", payloadType, currentFmtp));
+        }
+
+        if (containRtx) {
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " RTX_VALUE, rtxPayloadType));
+
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%" PRId64 " apt=%" PRId64 "", rtxPayloadType,
+                                            payloadType));
+        }
+    } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_H265) {
+        if (pKvsPeerConnection->isOffer) {
+            currentFmtp = DEFAULT_H265_FMTP;
+        }
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " H265_VALUE, payloadType));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-fb", "%" PRId64 " nack", payloadType));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-fb", "%" PRId64 " nack pli", payloadType));
+
+        if (currentFmtp != NULL) {
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%" PRId64 " %s", payloadType, currentFmtp));
+        }
+
+        if (containRtx) {
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " RTX_VALUE, rtxPayloadType));
+
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%" PRId64 " apt=%" PRId64 "", rtxPayloadType,
+                                            payloadType));
+        }
+    } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_AV1) {
+        if (pKvsPeerConnection->isOffer) {
+            currentFmtp = DEFAULT_AV1_FMTP;
+        }
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " AV1_VALUE, payloadType));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-fb", "%" PRId64 " nack", payloadType));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-fb", "%" PRId64 " nack pli", payloadType));
+
+        if (currentFmtp != NULL) {
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%" PRId64 " %s", payloadType, currentFmtp));
+        }
+
+        if (containRtx) {
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " RTX_VALUE, rtxPayloadType));
+
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%" PRId64 " apt=%" PRId64 "", rtxPayloadType,
+                                            payloadType));
+        }
+    } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_VP9) {
+        if (pKvsPeerConnection->isOffer) {
+            currentFmtp = DEFAULT_VP9_FMTP;
+        }
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " VP9_VALUE, payloadType));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-fb", "%" PRId64 " nack", payloadType));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-fb", "%" PRId64 " nack pli", payloadType));
+
+        if (currentFmtp != NULL) {
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%" PRId64 " %s", payloadType, currentFmtp));
         }
 
         if (containRtx) {
-            STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtpmap");
-            SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " " RTX_VALUE, rtxPayloadType);
-            attributeCount++;
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " RTX_VALUE, rtxPayloadType));
 
-            STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "fmtp");
-            SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " apt=%" PRId64 "", rtxPayloadType, payloadType);
-            attributeCount++;
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%" PRId64 " apt=%" PRId64 "", rtxPayloadType,
+                                            payloadType));
         }
     } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_OPUS) {
         if (pKvsPeerConnection->isOffer) {
             currentFmtp = DEFAULT_OPUS_FMTP;
         }
 
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtpmap");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " opus/48000/2", payloadType);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " opus/48000/2", payloadType));
 
         if (currentFmtp != NULL) {
-            STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "fmtp");
-            SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " %s", payloadType, currentFmtp);
-            attributeCount++;
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%" PRId64 " %s", payloadType, currentFmtp));
+        }
+
+        // https://www.rfc-editor.org/rfc/rfc2198#section-5, every encoding in a RED packet is Opus
+        if (containRed) {
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%u " RED_VALUE,
+                                            pKvsPeerConnection->redPayloadType));
+
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%u %" PRId64 "/%" PRId64,
+                                            pKvsPeerConnection->redPayloadType, payloadType, payloadType));
         }
     } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_VP8) {
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtpmap");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " " VP8_VALUE, payloadType);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " VP8_VALUE, payloadType));
 
         if (containRtx) {
             CHK_STATUS(hashTableGet(pKvsPeerConnection->pRtxTable, RTC_RTX_CODEC_VP8, &rtxPayloadType));
-            STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtpmap");
-            SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " " RTX_VALUE, rtxPayloadType);
-            attributeCount++;
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " RTX_VALUE, rtxPayloadType));
 
-            STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "fmtp");
-            SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " apt=%" PRId64 "", rtxPayloadType, payloadType);
-            attributeCount++;
+            CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%" PRId64 " apt=%" PRId64 "", rtxPayloadType,
+                                            payloadType));
         }
     } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_MULAW) {
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtpmap");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " " MULAW_VALUE, payloadType);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " MULAW_VALUE, payloadType));
     } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_ALAW) {
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtpmap");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " " ALAW_VALUE, payloadType);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " " ALAW_VALUE, payloadType));
     } else if (pRtcMediaStreamTrack->codec == RTC_CODEC_UNKNOWN) {
         CHK_STATUS(hashTableGet(pUnknownCodecRtpmapTable, unknownCodecHashTableKey, (PUINT64) &rtpMapValue));
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtpmap");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " %s", payloadType, rtpMapValue);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%" PRId64 " %s", payloadType, rtpMapValue));
     }
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
-    SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u cname:%s", pKvsRtpTransceiver->sender.ssrc,
-            pKvsPeerConnection->localCNAME);
-    attributeCount++;
+    // https://www.rfc-editor.org/rfc/rfc8627#section-5.1.2
+    if (containFlexFec) {
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtpmap", "%u " FLEXFEC_VALUE,
+                                        pKvsPeerConnection->flexFecPayloadType));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
-    SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%u msid:%s %s", pKvsRtpTransceiver->sender.ssrc,
-            pRtcMediaStreamTrack->streamId, pRtcMediaStreamTrack->trackId);
-    attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fmtp", "%u repair-window=%u",
+                                        pKvsPeerConnection->flexFecPayloadType, FLEXFEC_DEFAULT_REPAIR_WINDOW_USEC));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp-fb");
-    SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " goog-remb", payloadType);
-    attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc-group", FEC_FR_KEY " %u %u",
+                                        pKvsRtpTransceiver->sender.ssrc, pKvsRtpTransceiver->sender.flexFecSsrc));
 
-    if (pKvsPeerConnection->twccExtId != 0) {
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp-fb");
-        SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%" PRId64 " " TWCC_SDP_ATTR, payloadType);
-        attributeCount++;
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u cname:%s", pKvsRtpTransceiver->sender.flexFecSsrc,
+                                        pKvsPeerConnection->localCNAME));
+
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u msid:%s %s",
+                                        pKvsRtpTransceiver->sender.flexFecSsrc, pRtcMediaStreamTrack->streamId, pRtcMediaStreamTrack->trackId));
     }
 
-    pSdpMediaDescription->mediaAttributesCount = attributeCount;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u cname:%s", pKvsRtpTransceiver->sender.ssrc,
+                                    pKvsPeerConnection->localCNAME));
+
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ssrc", "%u msid:%s %s", pKvsRtpTransceiver->sender.ssrc,
+                                    pRtcMediaStreamTrack->streamId, pRtcMediaStreamTrack->trackId));
+
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-fb", "%" PRId64 " goog-remb", payloadType));
+
+    if (pKvsPeerConnection->twccExtId != 0) {
+        CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp-fb", "%" PRId64 " " TWCC_SDP_ATTR, payloadType));
+    }
 
 CleanUp:
 
@@ -688,48 +842,30 @@ CleanUp:
     return retStatus;
 }
 
-STATUS populateSessionDescriptionDataChannel(PKvsPeerConnection pKvsPeerConnection, PSdpMediaDescription pSdpMediaDescription,
+STATUS populateSessionDescriptionDataChannel(PKvsPeerConnection pKvsPeerConnection, PSessionDescription pLocalSessionDescription,
                                              PCHAR pCertificateFingerprint, UINT32 mediaSectionId, PCHAR pDtlsRole)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 attributeCount = 0;
-
-    SPRINTF(pSdpMediaDescription->mediaName, "application 9 UDP/DTLS/SCTP webrtc-datachannel");
+    PSdpMediaDescription pSdpMediaDescription = &pLocalSessionDescription->mediaDescriptions[mediaSectionId];
 
-    CHK_STATUS(iceAgentPopulateSdpMediaDescriptionCandidates(pKvsPeerConnection->pIceAgent, pSdpMediaDescription, MAX_SDP_ATTRIBUTE_VALUE_LENGTH,
-                                                             &attributeCount));
+    pSdpMediaDescription->mediaName = "application 9 UDP/DTLS/SCTP webrtc-datachannel";
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtcp");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "9 IN IP4 0.0.0.0");
-    attributeCount++;
+    CHK_STATUS(iceAgentPopulateSdpMediaDescriptionCandidates(pKvsPeerConnection->pIceAgent, pLocalSessionDescription, pSdpMediaDescription));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ice-ufrag");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, pKvsPeerConnection->localIceUfrag);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "rtcp", "9 IN IP4 0.0.0.0"));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ice-pwd");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, pKvsPeerConnection->localIcePwd);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ice-ufrag", "%s", pKvsPeerConnection->localIceUfrag));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "fingerprint");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "sha-256 ");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue + 8, pCertificateFingerprint);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "ice-pwd", "%s", pKvsPeerConnection->localIcePwd));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "setup");
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, pDtlsRole);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "fingerprint", "sha-256 %s", pCertificateFingerprint));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "mid");
-    SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "%d", mediaSectionId);
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "setup", "%s", pDtlsRole));
 
-    STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "sctp-port");
-    SPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue, "5000");
-    attributeCount++;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "mid", "%d", mediaSectionId));
 
-    pSdpMediaDescription->mediaAttributesCount = attributeCount;
+    CHK_STATUS(sdpAddMediaAttribute(pLocalSessionDescription, pSdpMediaDescription, "sctp-port", "5000"));
 
 CleanUp:
 
@@ -776,50 +912,41 @@ BOOL isPresentInRemote(PKvsRtpTransceiver pKvsRtpTransceiver, PSessionDescriptio
     return wasFound;
 }
 
-// Populate the media sections of a SessionDescription with the current state of the KvsPeerConnection
-STATUS populateSessionDescriptionMedia(PKvsPeerConnection pKvsPeerConnection, PSessionDescription pRemoteSessionDescription,
-                                       PSessionDescription pLocalSessionDescription)
+// Collects the transceivers the media sections of the local description are generated from, in m-line order
+STATUS collectLocalMediaSections(PKvsPeerConnection pKvsPeerConnection, PSessionDescription pRemoteSessionDescription,
+                                 PLocalMediaSections pLocalMediaSections)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PDoubleListNode pCurNode = NULL;
-    CHAR certificateFingerprint[CERTIFICATE_FINGERPRINT_LENGTH];
     UINT64 data;
     PKvsRtpTransceiver pKvsRtpTransceiver;
-    PCHAR pDtlsRole = NULL;
-    PHashTable pUnknownCodecPayloadTypesTable = NULL, pUnknownCodecRtpmapTable = NULL;
     UINT32 unknownCodecHashTableKey = 0;
 
-    CHK_STATUS(dtlsSessionGetLocalCertificateFingerprint(pKvsPeerConnection->pDtlsSession, certificateFingerprint, CERTIFICATE_FINGERPRINT_LENGTH));
+    CHK(pKvsPeerConnection != NULL && pRemoteSessionDescription != NULL && pLocalMediaSections != NULL, STATUS_NULL_ARG);
 
-    if (pKvsPeerConnection->isOffer) {
-        pDtlsRole = DTLS_ROLE_ACTPASS;
+    MEMSET(pLocalMediaSections, 0x00, SIZEOF(LocalMediaSections));
 
+    if (pKvsPeerConnection->isOffer) {
         CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
         while (pCurNode != NULL) {
             CHK_STATUS(doubleListGetNodeData(pCurNode, &data));
             pCurNode = pCurNode->pNext;
             pKvsRtpTransceiver = (PKvsRtpTransceiver) data;
             if (pKvsRtpTransceiver != NULL) {
-                CHK(pLocalSessionDescription->mediaCount < MAX_SDP_SESSION_MEDIA_COUNT, STATUS_SESSION_DESCRIPTION_MAX_MEDIA_COUNT);
-
-                // If generating answer, need to check if Local Description is present in remote -- if not, we don't need to create a local
-                // description for it or else our Answer will have an extra m-line, for offer the local is the offer itself, don't care about remote
-                CHK_STATUS(populateSingleMediaSection(
-                    pKvsPeerConnection, pKvsRtpTransceiver, &(pLocalSessionDescription->mediaDescriptions[pLocalSessionDescription->mediaCount]),
-                    pRemoteSessionDescription, certificateFingerprint, pLocalSessionDescription->mediaCount, pDtlsRole, NULL, NULL, 0));
-                pLocalSessionDescription->mediaCount++;
+                CHK(pLocalMediaSections->count < MAX_SDP_SESSION_MEDIA_COUNT, STATUS_SESSION_DESCRIPTION_MAX_MEDIA_COUNT);
+                pLocalMediaSections->transceivers[pLocalMediaSections->count++] = pKvsRtpTransceiver;
             }
         }
     } else {
-        pDtlsRole = DTLS_ROLE_ACTIVE;
-        CHK_STATUS(hashTableCreate(&pUnknownCodecPayloadTypesTable));
-        CHK_STATUS(hashTableCreate(&pUnknownCodecRtpmapTable));
+        CHK_STATUS(hashTableCreate(&pLocalMediaSections->pUnknownCodecPayloadTypesTable));
+        CHK_STATUS(hashTableCreate(&pLocalMediaSections->pUnknownCodecRtpmapTable));
 
         // this function creates a list of transceivers corresponding to each m-line and adds it answerTransceivers
         // if an m-line does not have a corresponding transceiver created by the user, we create a fake transceiver
-        CHK_STATUS(findTransceiversByRemoteDescription(pKvsPeerConnection, pRemoteSessionDescription, pUnknownCodecPayloadTypesTable,
-                                                       pUnknownCodecRtpmapTable));
+        CHK_STATUS(findTransceiversByRemoteDescription(pKvsPeerConnection, pRemoteSessionDescription,
+                                                       pLocalMediaSections->pUnknownCodecPayloadTypesTable,
+                                                       pLocalMediaSections->pUnknownCodecRtpmapTable));
 
         // pAnswerTransceivers contains transceivers created by the user as well as fake transceivers
         CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pAnswerTransceivers, &pCurNode));
@@ -828,49 +955,91 @@ STATUS populateSessionDescriptionMedia(PKvsPeerConnection pKvsPeerConnection, PS
             pCurNode = pCurNode->pNext;
             pKvsRtpTransceiver = (PKvsRtpTransceiver) data;
             if (pKvsRtpTransceiver != NULL) {
-                CHK(pLocalSessionDescription->mediaCount < MAX_SDP_SESSION_MEDIA_COUNT, STATUS_SESSION_DESCRIPTION_MAX_MEDIA_COUNT);
+                CHK(pLocalMediaSections->count < MAX_SDP_SESSION_MEDIA_COUNT, STATUS_SESSION_DESCRIPTION_MAX_MEDIA_COUNT);
+                // If generating answer, need to check if Local Description is present in remote -- if not, we don't need to create a local
+                // description for it or else our Answer will have an extra m-line
                 if (isPresentInRemote(pKvsRtpTransceiver, pRemoteSessionDescription)) {
+                    // unknownCodecHashTableKey is the key for pUnknownCodecRtpmapTable and pUnknownCodecPayloadTypesTable
+                    // a value for the same key in both hashtables corresponds to rtpmap and payloadtype for the same m-line / unknown codec
                     if (pKvsRtpTransceiver->sender.track.codec == RTC_CODEC_UNKNOWN) {
-                        CHK_STATUS(populateSingleMediaSection(pKvsPeerConnection, pKvsRtpTransceiver,
-                                                              &(pLocalSessionDescription->mediaDescriptions[pLocalSessionDescription->mediaCount]),
-                                                              pRemoteSessionDescription, certificateFingerprint, pLocalSessionDescription->mediaCount,
-                                                              pDtlsRole, pUnknownCodecPayloadTypesTable, pUnknownCodecRtpmapTable,
-                                                              unknownCodecHashTableKey));
-                        unknownCodecHashTableKey++;
-                        // unknownCodecHashTableKey is the key for pUnknownCodecRtpmapTable and pUnknownCodecPayloadTypesTable
-                        // a value for the same key in both hashtables corresponds to rtpmap and payloadtype for the same m-line / unknown codec
-
-                    } else {
-                        // in case of a user-added transceiver, the pUnknownCodecPayloadTypesTable, pUnknownCodecRtpmapTable are not populated by
-                        // the function findTransceiversByRemoteDescription and are NULL
-                        CHK_STATUS(populateSingleMediaSection(pKvsPeerConnection, pKvsRtpTransceiver,
-                                                              &(pLocalSessionDescription->mediaDescriptions[pLocalSessionDescription->mediaCount]),
-                                                              pRemoteSessionDescription, certificateFingerprint, pLocalSessionDescription->mediaCount,
-                                                              pDtlsRole, NULL, NULL, 0));
+                        pLocalMediaSections->unknownCodecHashTableKeys[pLocalMediaSections->count] = unknownCodecHashTableKey++;
                     }
-                    pLocalSessionDescription->mediaCount++;
+                    pLocalMediaSections->transceivers[pLocalMediaSections->count++] = pKvsRtpTransceiver;
                 }
             }
         }
     }
 
     if (ATOMIC_LOAD_BOOL(&pKvsPeerConnection->sctpIsEnabled)) {
-        CHK(pLocalSessionDescription->mediaCount < MAX_SDP_SESSION_MEDIA_COUNT, STATUS_SESSION_DESCRIPTION_MAX_MEDIA_COUNT);
-        CHK_STATUS(populateSessionDescriptionDataChannel(pKvsPeerConnection,
-                                                         &(pLocalSessionDescription->mediaDescriptions[pLocalSessionDescription->mediaCount]),
-                                                         certificateFingerprint, pLocalSessionDescription->mediaCount, pDtlsRole));
-        pLocalSessionDescription->mediaCount++;
+        CHK(pLocalMediaSections->count < MAX_SDP_SESSION_MEDIA_COUNT, STATUS_SESSION_DESCRIPTION_MAX_MEDIA_COUNT);
+        pLocalMediaSections->dataChannel = TRUE;
+    }
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && pLocalMediaSections != NULL) {
+        freeLocalMediaSections(pLocalMediaSections);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeLocalMediaSections(PLocalMediaSections pLocalMediaSections)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pLocalMediaSections != NULL, STATUS_NULL_ARG);
+
+    if (pLocalMediaSections->pUnknownCodecPayloadTypesTable != NULL) {
+        CHK_LOG_ERR(hashTableFree(pLocalMediaSections->pUnknownCodecPayloadTypesTable));
+        pLocalMediaSections->pUnknownCodecPayloadTypesTable = NULL;
+    }
+    if (pLocalMediaSections->pUnknownCodecRtpmapTable != NULL) {
+        CHK_LOG_ERR(hashTableFree(pLocalMediaSections->pUnknownCodecRtpmapTable));
+        pLocalMediaSections->pUnknownCodecRtpmapTable = NULL;
     }
 
 CleanUp:
 
-    if (pUnknownCodecPayloadTypesTable != NULL) {
-        CHK_STATUS(hashTableFree(pUnknownCodecPayloadTypesTable));
+    return retStatus;
+}
+
+// Populate the media sections of a SessionDescription, one per collected transceiver and the data channel last
+static STATUS populateSessionDescriptionMedia(PKvsPeerConnection pKvsPeerConnection, PSessionDescription pRemoteSessionDescription,
+                                              PLocalMediaSections pLocalMediaSections, PSessionDescription pLocalSessionDescription)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    CHAR certificateFingerprint[CERTIFICATE_FINGERPRINT_LENGTH];
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PCHAR pDtlsRole = pKvsPeerConnection->isOffer ? DTLS_ROLE_ACTPASS : DTLS_ROLE_ACTIVE;
+    UINT32 i;
+
+    CHK_STATUS(dtlsSessionGetLocalCertificateFingerprint(pKvsPeerConnection->pDtlsSession, certificateFingerprint, CERTIFICATE_FINGERPRINT_LENGTH));
+
+    for (i = 0; i < pLocalMediaSections->count; i++) {
+        pKvsRtpTransceiver = pLocalMediaSections->transceivers[i];
+        // in case of a user-added transceiver, the unknown codec tables are not populated by findTransceiversByRemoteDescription
+        if (pKvsRtpTransceiver->sender.track.codec == RTC_CODEC_UNKNOWN && !pKvsPeerConnection->isOffer) {
+            CHK_STATUS(populateSingleMediaSection(pKvsPeerConnection, pKvsRtpTransceiver, pLocalSessionDescription, pRemoteSessionDescription,
+                                                  certificateFingerprint, i, pDtlsRole, pLocalMediaSections->pUnknownCodecPayloadTypesTable,
+                                                  pLocalMediaSections->pUnknownCodecRtpmapTable, pLocalMediaSections->unknownCodecHashTableKeys[i]));
+        } else {
+            CHK_STATUS(populateSingleMediaSection(pKvsPeerConnection, pKvsRtpTransceiver, pLocalSessionDescription, pRemoteSessionDescription,
+                                                  certificateFingerprint, i, pDtlsRole, NULL, NULL, 0));
+        }
+        pLocalSessionDescription->mediaCount++;
     }
-    if (pUnknownCodecRtpmapTable != NULL) {
-        CHK_STATUS(hashTableFree(pUnknownCodecRtpmapTable));
+
+    if (pLocalMediaSections->dataChannel) {
+        CHK_STATUS(populateSessionDescriptionDataChannel(pKvsPeerConnection, pLocalSessionDescription, certificateFingerprint,
+                                                         pLocalSessionDescription->mediaCount, pDtlsRole));
+        pLocalSessionDescription->mediaCount++;
     }
 
+CleanUp:
+
     LEAVES();
     return retStatus;
 }
@@ -881,74 +1050,166 @@ STATUS populateSessionDescription(PKvsPeerConnection pKvsPeerConnection, PSessio
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    CHAR bundleValue[MAX_SDP_ATTRIBUTE_VALUE_LENGTH], wmsValue[MAX_SDP_ATTRIBUTE_VALUE_LENGTH],
-        remoteSdpAttributeValue[MAX_SDP_ATTRIBUTE_VALUE_LENGTH];
-    PCHAR curr = NULL;
+    LocalMediaSections localMediaSections;
+    BOOL collected = FALSE;
+
+    CHK(pKvsPeerConnection != NULL && pLocalSessionDescription != NULL && pRemoteSessionDescription != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(collectLocalMediaSections(pKvsPeerConnection, pRemoteSessionDescription, &localMediaSections));
+    collected = TRUE;
+
+    CHK_STATUS(populateSessionDescriptionForSections(pKvsPeerConnection, pRemoteSessionDescription, &localMediaSections, pLocalSessionDescription));
+
+CleanUp:
+
+    if (collected) {
+        freeLocalMediaSections(&localMediaSections);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS populateSessionDescriptionForSections(PKvsPeerConnection pKvsPeerConnection, PSessionDescription pRemoteSessionDescription,
+                                             PLocalMediaSections pLocalMediaSections, PSessionDescription pLocalSessionDescription)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    CHAR bundleValue[MAX_SDP_ATTRIBUTE_VALUE_LENGTH + 1];
+    PCHAR curr = NULL, pRemoteBundle = NULL;
     UINT32 i, sizeRemaining;
     INT32 charsCopied;
 
-    CHK(pKvsPeerConnection != NULL && pLocalSessionDescription != NULL && pRemoteSessionDescription != NULL, STATUS_NULL_ARG);
+    CHK(pKvsPeerConnection != NULL && pLocalSessionDescription != NULL && pRemoteSessionDescription != NULL && pLocalMediaSections != NULL,
+        STATUS_NULL_ARG);
 
-    CHK_STATUS(populateSessionDescriptionMedia(pKvsPeerConnection, pRemoteSessionDescription, pLocalSessionDescription));
+    CHK_STATUS(populateSessionDescriptionMedia(pKvsPeerConnection, pRemoteSessionDescription, pLocalMediaSections, pLocalSessionDescription));
 
-    MEMSET(bundleValue, 0, MAX_SDP_ATTRIBUTE_VALUE_LENGTH);
-    MEMSET(wmsValue, 0, MAX_SDP_ATTRIBUTE_VALUE_LENGTH);
-    MEMSET(remoteSdpAttributeValue, 0, MAX_SDP_ATTRIBUTE_VALUE_LENGTH);
+    MEMSET(bundleValue, 0, SIZEOF(bundleValue));
 
-    STRCPY(pLocalSessionDescription->sdpOrigin.userName, "-");
+    pLocalSessionDescription->sdpOrigin.userName = "-";
     pLocalSessionDescription->sdpOrigin.sessionId = RAND();
     pLocalSessionDescription->sdpOrigin.sessionVersion = 2;
-    STRCPY(pLocalSessionDescription->sdpOrigin.sdpConnectionInformation.networkType, "IN");
-    STRCPY(pLocalSessionDescription->sdpOrigin.sdpConnectionInformation.addressType, "IP4");
-    STRCPY(pLocalSessionDescription->sdpOrigin.sdpConnectionInformation.connectionAddress, "127.0.0.1");
+    pLocalSessionDescription->sdpOrigin.sdpConnectionInformation.networkType = "IN";
+    pLocalSessionDescription->sdpOrigin.sdpConnectionInformation.addressType = "IP4";
+    pLocalSessionDescription->sdpOrigin.sdpConnectionInformation.connectionAddress = "127.0.0.1";
 
-    STRCPY(pLocalSessionDescription->sessionName, "-");
+    pLocalSessionDescription->sessionName = "-";
 
     pLocalSessionDescription->timeDescriptionCount = 1;
     pLocalSessionDescription->sdpTimeDescription[0].startTime = 0;
     pLocalSessionDescription->sdpTimeDescription[0].stopTime = 0;
 
-    STRCPY(pLocalSessionDescription->sdpAttributes[0].attributeName, "group");
-    STRCPY(pLocalSessionDescription->sdpAttributes[0].attributeValue, BUNDLE_KEY);
-
-    // check all session attribute lines to see if a line with BUNDLE is present. If it is present, copy its content and break
+    // check all session attribute lines to see if a line with BUNDLE is present. If it is present, use its content and break
     for (i = 0; i < pRemoteSessionDescription->sessionAttributesCount; i++) {
         if (STRSTR(pRemoteSessionDescription->sdpAttributes[i].attributeValue, BUNDLE_KEY) != NULL) {
-            STRCPY(remoteSdpAttributeValue, pRemoteSessionDescription->sdpAttributes[i].attributeValue + ARRAY_SIZE(BUNDLE_KEY) - 1);
+            pRemoteBundle = pRemoteSessionDescription->sdpAttributes[i].attributeValue + ARRAY_SIZE(BUNDLE_KEY) - 1;
             break;
         }
     }
 
     // check if we already have a value for the "group" session attribute from remote description. If we have it, we use it.
     // If we don't have it, we loop over, create and add them
-    if (STRLEN(remoteSdpAttributeValue) > 0) {
-        CHK(STRLEN(remoteSdpAttributeValue) < MAX_SDP_ATTRIBUTE_VALUE_LENGTH, STATUS_BUFFER_TOO_SMALL);
-        STRCAT(pLocalSessionDescription->sdpAttributes[0].attributeValue, remoteSdpAttributeValue);
+    if (!IS_EMPTY_SDP_FIELD(pRemoteBundle)) {
+        CHK_STATUS(sdpAddSessionAttribute(pLocalSessionDescription, "group", BUNDLE_KEY "%s", pRemoteBundle));
     } else {
-        for (curr = (pLocalSessionDescription->sdpAttributes[0].attributeValue + ARRAY_SIZE(BUNDLE_KEY) - 1), i = 0;
-             i < pLocalSessionDescription->mediaCount; i++) {
-            sizeRemaining = MAX_SDP_ATTRIBUTE_VALUE_LENGTH - (curr - pLocalSessionDescription->sdpAttributes[0].attributeValue);
+        for (curr = bundleValue, i = 0; i < pLocalSessionDescription->mediaCount; i++) {
+            sizeRemaining = SIZEOF(bundleValue) - (curr - bundleValue);
             charsCopied = SNPRINTF(curr, sizeRemaining, " %d", i);
 
             CHK(charsCopied > 0 && (UINT32) charsCopied < sizeRemaining, STATUS_BUFFER_TOO_SMALL);
 
             curr += charsCopied;
         }
+        CHK_STATUS(sdpAddSessionAttribute(pLocalSessionDescription, "group", BUNDLE_KEY "%s", bundleValue));
     }
 
     for (i = 0; i < pLocalSessionDescription->mediaCount; i++) {
-        STRCPY(pLocalSessionDescription->mediaDescriptions[i].sdpConnectionInformation.networkType, "IN");
-        STRCPY(pLocalSessionDescription->mediaDescriptions[i].sdpConnectionInformation.addressType, "IP4");
-        STRCPY(pLocalSessionDescription->mediaDescriptions[i].sdpConnectionInformation.connectionAddress, "127.0.0.1");
+        pLocalSessionDescription->mediaDescriptions[i].sdpConnectionInformation.networkType = "IN";
+        pLocalSessionDescription->mediaDescriptions[i].sdpConnectionInformation.addressType = "IP4";
+        pLocalSessionDescription->mediaDescriptions[i].sdpConnectionInformation.connectionAddress = "127.0.0.1";
     }
-    pLocalSessionDescription->sessionAttributesCount++;
 
-    STRCPY(pLocalSessionDescription->sdpAttributes[pLocalSessionDescription->sessionAttributesCount].attributeName, "msid-semantic");
-    STRCPY(pLocalSessionDescription->sdpAttributes[pLocalSessionDescription->sessionAttributesCount].attributeValue, " WMS myKvsVideoStream");
-    pLocalSessionDescription->sessionAttributesCount++;
+    CHK_STATUS(sdpAddSessionAttribute(pLocalSessionDescription, "msid-semantic", " WMS myKvsVideoStream"));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS serializeLocalSessionDescription(PKvsPeerConnection pKvsPeerConnection, PCHAR pSdp, PUINT32 pSdpLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    LocalMediaSections localMediaSections;
+    BOOL collected = FALSE;
+
+    CHK(pKvsPeerConnection != NULL && pSdp != NULL && pSdpLength != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(collectLocalMediaSections(pKvsPeerConnection, &pKvsPeerConnection->remoteSessionDescription, &localMediaSections));
+    collected = TRUE;
+
+    CHK_STATUS(serializeLocalSessionDescriptionForSections(pKvsPeerConnection, &localMediaSections, pSdp, pSdpLength));
 
 CleanUp:
 
+    if (collected) {
+        freeLocalMediaSections(&localMediaSections);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS serializeLocalSessionDescriptionForSections(PKvsPeerConnection pKvsPeerConnection, PLocalMediaSections pLocalMediaSections, PCHAR pSdp,
+                                                   PUINT32 pSdpLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    SdpTemplateSignature signature;
+    PSdpTemplate pSdpTemplate = NULL;
+    PSessionDescription pSessionDescription = NULL;
+    UINT32 serializeLen = 0;
+
+    MEMSET(&signature, 0x00, SIZEOF(SdpTemplateSignature));
+
+    CHK(pKvsPeerConnection != NULL && pLocalMediaSections != NULL && pSdp != NULL && pSdpLength != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(buildSdpTemplateSignature(pKvsPeerConnection, pLocalMediaSections, &signature));
+    CHK_STATUS(sdpTemplateCacheGet(&signature, &pSdpTemplate));
+
+    if (pSdpTemplate != NULL) {
+        retStatus = sdpTemplateRender(pSdpTemplate, pKvsPeerConnection, pLocalMediaSections, (UINT64) RAND(), pSdp, pSdpLength);
+        CHK(retStatus != STATUS_BUFFER_TOO_SMALL, STATUS_NOT_ENOUGH_MEMORY);
+        CHK_STATUS(retStatus);
+    } else {
+        CHK(NULL != (pSessionDescription = (PSessionDescription) MEMCALLOC(1, SIZEOF(SessionDescription))), STATUS_NOT_ENOUGH_MEMORY);
+        CHK_STATUS(populateSessionDescriptionForSections(pKvsPeerConnection, &pKvsPeerConnection->remoteSessionDescription, pLocalMediaSections,
+                                                         pSessionDescription));
+        CHK_STATUS(serializeSessionDescription(pSessionDescription, NULL, &serializeLen));
+        CHK(serializeLen <= *pSdpLength, STATUS_NOT_ENOUGH_MEMORY);
+        CHK_STATUS(serializeSessionDescription(pSessionDescription, pSdp, &serializeLen));
+        *pSdpLength = serializeLen;
+
+        // Sessions of the same configuration render this one from now on. Not every description can be made into a
+        // template, those keep being populated
+        if (STATUS_SUCCEEDED(createSdpTemplate(&signature, pKvsPeerConnection, pLocalMediaSections, pSdp, pSessionDescription->sdpOrigin.sessionId,
+                                               &pSdpTemplate))) {
+            sdpTemplateCachePut(pSdpTemplate);
+        }
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (pSessionDescription != NULL) {
+        resetSessionDescription(pSessionDescription);
+    }
+    SAFE_MEMFREE(pSessionDescription);
+    freeSdpTemplateSignature(&signature);
+
     LEAVES();
     return retStatus;
 }
@@ -1094,6 +1355,15 @@ STATUS findTransceiversByRemoteDescription(PKvsPeerConnection pKvsPeerConnection
                 if (STRSTR(attributeValue, H264_VALUE) != NULL) {
                     supportCodec = TRUE;
                     rtcCodec = RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE;
+                } else if (STRSTR(attributeValue, H265_VALUE) != NULL) {
+                    supportCodec = TRUE;
+                    rtcCodec = RTC_CODEC_H265;
+                } else if (STRSTR(attributeValue, AV1_VALUE) != NULL) {
+                    supportCodec = TRUE;
+                    rtcCodec = RTC_CODEC_AV1;
+                } else if (STRSTR(attributeValue, VP9_VALUE) != NULL) {
+                    supportCodec = TRUE;
+                    rtcCodec = RTC_CODEC_VP9;
                 } else if (STRSTR(attributeValue, OPUS_VALUE) != NULL) {
                     supportCodec = TRUE;
                     rtcCodec = RTC_CODEC_OPUS;
@@ -1238,7 +1508,8 @@ STATUS setReceiversSsrc(PSessionDescription pRemoteSessionDescription, PDoubleLi
                     CHK_STATUS(doubleListGetNodeData(pCurNode, &data));
                     pKvsRtpTransceiver = (PKvsRtpTransceiver) data;
                     codec = pKvsRtpTransceiver->sender.track.codec;
-                    isVideoCodec = (codec == RTC_CODEC_VP8 || codec == RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE);
+                    isVideoCodec = (codec == RTC_CODEC_VP8 || codec == RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE ||
+                                    codec == RTC_CODEC_H265 || codec == RTC_CODEC_AV1 || codec == RTC_CODEC_VP9);
                     isAudioCodec = (codec == RTC_CODEC_MULAW || codec == RTC_CODEC_ALAW || codec == RTC_CODEC_OPUS);
 
                     if (pKvsRtpTransceiver->jitterBufferSsrc == 0 &&
@@ -1263,3 +1534,124 @@ CleanUp:
 
     return retStatus;
 }
+
+STATUS setFlexFecFromRemoteDescription(PKvsPeerConnection pKvsPeerConnection, PSessionDescription pRemoteSessionDescription)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpMediaDescription pMediaDescription = NULL;
+    UINT32 currentAttribute, currentMedia, primarySsrc, flexFecSsrc;
+    UINT64 payloadType = 0, data;
+    PDoubleListNode pCurNode = NULL;
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PCHAR attributeValue, end = NULL;
+
+    CHK(pKvsPeerConnection != NULL && pRemoteSessionDescription != NULL, STATUS_NULL_ARG);
+    CHK(pKvsPeerConnection->enableFlexFec, retStatus);
+
+    for (currentMedia = 0; currentMedia < pRemoteSessionDescription->mediaCount && payloadType == 0; currentMedia++) {
+        pMediaDescription = &(pRemoteSessionDescription->mediaDescriptions[currentMedia]);
+        if (STRNCMP(pMediaDescription->mediaName, MEDIA_SECTION_VIDEO_VALUE, ARRAY_SIZE(MEDIA_SECTION_VIDEO_VALUE) - 1) != 0) {
+            continue;
+        }
+        for (currentAttribute = 0; currentAttribute < pMediaDescription->mediaAttributesCount && payloadType == 0; currentAttribute++) {
+            attributeValue = pMediaDescription->sdpAttributes[currentAttribute].attributeValue;
+            if (STRCMP(pMediaDescription->sdpAttributes[currentAttribute].attributeName, RTPMAP_VALUE) == 0 &&
+                STRSTR(attributeValue, FLEXFEC_VALUE) != NULL && (end = STRCHR(attributeValue, ' ')) != NULL) {
+                CHK_STATUS(STRTOUI64(attributeValue, end, 10, &payloadType));
+            }
+        }
+    }
+
+    // Without FlexFEC in the remote description later descriptions we generate leave it out as well
+    pKvsPeerConnection->flexFecPayloadType = (UINT8) payloadType;
+    CHK(payloadType != 0, retStatus);
+
+    CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
+    while (pCurNode != NULL) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &data));
+        pKvsRtpTransceiver = (PKvsRtpTransceiver) data;
+        if (pKvsRtpTransceiver->sender.track.kind == MEDIA_STREAM_TRACK_KIND_VIDEO && pKvsRtpTransceiver->sender.pFlexFecEncoder == NULL) {
+            CHK_STATUS(createFlexFecEncoder(pKvsRtpTransceiver->sender.ssrc, pKvsRtpTransceiver->sender.flexFecSsrc, (UINT8) payloadType,
+                                            &pKvsRtpTransceiver->sender.pFlexFecEncoder));
+        }
+        pCurNode = pCurNode->pNext;
+    }
+
+    // a=ssrc-group:FEC-FR <primary ssrc> <repair ssrc>
+    for (currentMedia = 0; currentMedia < pRemoteSessionDescription->mediaCount; currentMedia++) {
+        pMediaDescription = &(pRemoteSessionDescription->mediaDescriptions[currentMedia]);
+        for (currentAttribute = 0; currentAttribute < pMediaDescription->mediaAttributesCount; currentAttribute++) {
+            attributeValue = pMediaDescription->sdpAttributes[currentAttribute].attributeValue;
+            if (STRCMP(pMediaDescription->sdpAttributes[currentAttribute].attributeName, "ssrc-group") != 0 ||
+                STRNCMP(attributeValue, FEC_FR_KEY " ", ARRAY_SIZE(FEC_FR_KEY)) != 0) {
+                continue;
+            }
+            attributeValue += ARRAY_SIZE(FEC_FR_KEY);
+            CHK((end = STRCHR(attributeValue, ' ')) != NULL, STATUS_SDP_ATTRIBUTES_ERROR);
+            CHK_STATUS(STRTOUI32(attributeValue, end, 10, &primarySsrc));
+            CHK_STATUS(STRTOUI32(end + 1, NULL, 10, &flexFecSsrc));
+
+            CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
+            while (pCurNode != NULL) {
+                CHK_STATUS(doubleListGetNodeData(pCurNode, &data));
+                pKvsRtpTransceiver = (PKvsRtpTransceiver) data;
+                if (pKvsRtpTransceiver->jitterBufferSsrc == primarySsrc && pKvsRtpTransceiver->pFlexFecDecoder == NULL) {
+                    pKvsRtpTransceiver->flexFecSsrc = flexFecSsrc;
+                    CHK_STATUS(createFlexFecDecoder(primarySsrc, onFlexFecRecoveredPacket, (UINT64) pKvsRtpTransceiver,
+                                                    &pKvsRtpTransceiver->pFlexFecDecoder));
+                }
+                pCurNode = pCurNode->pNext;
+            }
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS setRedFromRemoteDescription(PKvsPeerConnection pKvsPeerConnection, PSessionDescription pRemoteSessionDescription)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpMediaDescription pMediaDescription = NULL;
+    UINT32 currentAttribute, currentMedia;
+    UINT64 payloadType = 0, data;
+    PDoubleListNode pCurNode = NULL;
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PCHAR attributeValue, end = NULL;
+
+    CHK(pKvsPeerConnection != NULL && pRemoteSessionDescription != NULL, STATUS_NULL_ARG);
+    CHK(pKvsPeerConnection->opusRedDepth > 0, retStatus);
+
+    for (currentMedia = 0; currentMedia < pRemoteSessionDescription->mediaCount && payloadType == 0; currentMedia++) {
+        pMediaDescription = &(pRemoteSessionDescription->mediaDescriptions[currentMedia]);
+        if (STRNCMP(pMediaDescription->mediaName, MEDIA_SECTION_AUDIO_VALUE, ARRAY_SIZE(MEDIA_SECTION_AUDIO_VALUE) - 1) != 0) {
+            continue;
+        }
+        for (currentAttribute = 0; currentAttribute < pMediaDescription->mediaAttributesCount && payloadType == 0; currentAttribute++) {
+            attributeValue = pMediaDescription->sdpAttributes[currentAttribute].attributeValue;
+            if (STRCMP(pMediaDescription->sdpAttributes[currentAttribute].attributeName, RTPMAP_VALUE) == 0 &&
+                STRSTR(attributeValue, RED_VALUE) != NULL && (end = STRCHR(attributeValue, ' ')) != NULL) {
+                CHK_STATUS(STRTOUI64(attributeValue, end, 10, &payloadType));
+            }
+        }
+    }
+
+    // Without RED in the remote description later descriptions we generate leave it out as well
+    pKvsPeerConnection->redPayloadType = (UINT8) payloadType;
+    CHK(payloadType != 0, retStatus);
+
+    CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
+    while (pCurNode != NULL) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &data));
+        pKvsRtpTransceiver = (PKvsRtpTransceiver) data;
+        if (pKvsRtpTransceiver->sender.track.codec == RTC_CODEC_OPUS && pKvsRtpTransceiver->sender.pRedEncoder == NULL) {
+            CHK_STATUS(createRedEncoder(pKvsPeerConnection->opusRedDepth, &pKvsRtpTransceiver->sender.pRedEncoder));
+        }
+        pCurNode = pCurNode->pNext;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
@@ -26,16 +26,22 @@ extern "C" {
 #define SDP_KEY       "sdp"
 #define CANDIDATE_KEY "candidate"
 #define SSRC_KEY      "ssrc"
+#define FEC_FR_KEY    "FEC-FR"
 #define BUNDLE_KEY    "BUNDLE"
 #define MID_KEY       "mid"
 
 #define H264_VALUE      "H264/90000"
+#define H265_VALUE      "H265/90000"
+#define AV1_VALUE       "AV1/90000"
 #define OPUS_VALUE      "opus/48000"
 #define VP8_VALUE       "VP8/90000"
+#define VP9_VALUE       "VP9/90000"
 #define MULAW_VALUE     "PCMU/8000"
 #define ALAW_VALUE      "PCMA/8000"
 #define RTX_VALUE       "rtx/90000"
 #define RTX_CODEC_VALUE "apt="
+#define FLEXFEC_VALUE   "flexfec/90000"
+#define RED_VALUE       "red/48000/2"
 #define FMTP_VALUE      "fmtp:"
 #define RTPMAP_VALUE    "rtpmap"
 
@@ -44,13 +50,21 @@ extern "C" {
 #define DEFAULT_PAYLOAD_ALAW    (UINT64) 8
 #define DEFAULT_PAYLOAD_OPUS    (UINT64) 111
 #define DEFAULT_PAYLOAD_VP8     (UINT64) 96
+#define DEFAULT_PAYLOAD_VP9     (UINT64) 98
 #define DEFAULT_PAYLOAD_H264    (UINT64) 125
+#define DEFAULT_PAYLOAD_H265    (UINT64) 126
+#define DEFAULT_PAYLOAD_AV1     (UINT64) 127
+#define DEFAULT_PAYLOAD_FLEXFEC (UINT64) 124
+#define DEFAULT_PAYLOAD_RED     (UINT64) 63
 
 #define DEFAULT_PAYLOAD_MULAW_STR (PCHAR) "0"
 #define DEFAULT_PAYLOAD_ALAW_STR  (PCHAR) "8"
 
 #define DEFAULT_H264_FMTP   (PCHAR) "level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f"
 #define DEFAULT_OPUS_FMTP   (PCHAR) "minptime=10;useinbandfec=1"
+#define DEFAULT_H265_FMTP   (PCHAR) "level-id=93;profile-id=1;tier-flag=0;tx-mode=SRST"
+#define DEFAULT_AV1_FMTP    (PCHAR) "level-idx=5;profile=0;tier=0"
+#define DEFAULT_VP9_FMTP    (PCHAR) "profile-id=0"
 #define H264_PROFILE_42E01F 0x42e01f
 // profile-level-id:
 //   A base16 [7] (hexadecimal) representation of the following
@@ -67,6 +81,17 @@ extern "C" {
 #define H264_FMTP_SUBPROFILE_MASK    0xFFFF00
 #define H264_FMTP_PROFILE_LEVEL_MASK 0x0000FF
 
+// profile-id, tier-flag and level-id are decimal values from the profile_tier_level syntax of the
+// VPS/SPS, absent parameters take the defaults below. level-id is 30 times the level number.
+//
+// Reference: https://tools.ietf.org/html/rfc7798#section-7.1
+#define H265_FMTP_DEFAULT_PROFILE_ID 1
+#define H265_FMTP_DEFAULT_TIER_FLAG  0
+#define H265_FMTP_DEFAULT_LEVEL_ID   93
+
+// profile-id is the VP9 profile of the stream, 0 when absent. Reference: https://www.rfc-editor.org/rfc/rfc9628#section-6
+#define VP9_FMTP_DEFAULT_PROFILE_ID 0
+
 #define DTLS_ROLE_ACTPASS (PCHAR) "actpass"
 #define DTLS_ROLE_ACTIVE  (PCHAR) "active"
 
@@ -81,12 +106,58 @@ extern "C" {
 STATUS setPayloadTypesFromOffer(PHashTable, PHashTable, PSessionDescription);
 STATUS setPayloadTypesForOffer(PHashTable);
 
+/*
+ * Transceivers the media sections of the local description are generated from, in m-line order. The unknown codec tables
+ * hold the payload type and rtpmap value answered for the m-lines we have no transceiver for, under the key kept for the
+ * section.
+ */
+typedef struct {
+    UINT32 count;
+    PKvsRtpTransceiver transceivers[MAX_SDP_SESSION_MEDIA_COUNT];
+    UINT32 unknownCodecHashTableKeys[MAX_SDP_SESSION_MEDIA_COUNT];
+    PHashTable pUnknownCodecPayloadTypesTable;
+    PHashTable pUnknownCodecRtpmapTable;
+    // Whether a data channel section follows the media ones
+    BOOL dataChannel;
+} LocalMediaSections, *PLocalMediaSections;
+
 STATUS setTransceiverPayloadTypes(PHashTable, PHashTable, PDoubleList);
 STATUS populateSessionDescription(PKvsPeerConnection, PSessionDescription, PSessionDescription);
+
+/**
+ * Answers create the transceivers missing for the remote m-lines while collecting, so collect once per local description
+ * and hand the sections to populateSessionDescriptionForSections.
+ */
+STATUS collectLocalMediaSections(PKvsPeerConnection, PSessionDescription, PLocalMediaSections);
+STATUS freeLocalMediaSections(PLocalMediaSections);
+STATUS populateSessionDescriptionForSections(PKvsPeerConnection, PSessionDescription, PLocalMediaSections, PSessionDescription);
+
+/**
+ * Writes the local description of the current state of the KvsPeerConnection to the buffer of the given size, NULL
+ * terminated. Renders it from the cached template of the same configuration when there is one, which gives the same text
+ * as populateSessionDescription followed by serializeSessionDescription.
+ */
+STATUS serializeLocalSessionDescription(PKvsPeerConnection, PCHAR, PUINT32);
+STATUS serializeLocalSessionDescriptionForSections(PKvsPeerConnection, PLocalMediaSections, PCHAR, PUINT32);
 STATUS findTransceiversByRemoteDescription(PKvsPeerConnection, PSessionDescription, PHashTable, PHashTable);
 STATUS setReceiversSsrc(PSessionDescription, PDoubleList);
+
+/**
+ * Picks up the FlexFEC payload type from the remote description, sets up repair packet generation for video senders and
+ * recovery for every remote stream announced in a FEC-FR ssrc-group. Disables FlexFEC when the remote does not support it.
+ */
+STATUS setFlexFecFromRemoteDescription(PKvsPeerConnection, PSessionDescription);
+
+/**
+ * Picks up the RED payload type from the remote description and sets up RED encapsulation for Opus senders.
+ * Disables RED when the remote does not support it.
+ */
+STATUS setRedFromRemoteDescription(PKvsPeerConnection, PSessionDescription);
+
 PCHAR fmtpForPayloadType(UINT64, PSessionDescription);
 UINT64 getH264FmtpScore(PCHAR);
+UINT64 getH265FmtpScore(PCHAR);
+UINT64 getVP9FmtpScore(PCHAR);
 
 #ifdef __cplusplus
 }
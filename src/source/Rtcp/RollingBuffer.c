@@ -7,18 +7,25 @@ STATUS createRollingBuffer(UINT32 capacity, FreeDataFunc freeDataFunc, PRollingB
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PRollingBuffer pRollingBuffer = NULL;
-    CHK(capacity != 0, STATUS_INVALID_ARG);
+    UINT32 slotCount = 1;
+    CHK(capacity != 0 && capacity <= MAX_ROLLING_BUFFER_CAPACITY, STATUS_INVALID_ARG);
 
     CHK(ppRollingBuffer != NULL, STATUS_NULL_ARG);
-    pRollingBuffer = (PRollingBuffer) MEMALLOC(SIZEOF(RollingBuffer) + SIZEOF(UINT64) * capacity);
+
+    // Power of two slot count so an index maps to its slot with a mask
+    while (slotCount < capacity) {
+        slotCount <<= 1;
+    }
+
+    pRollingBuffer = (PRollingBuffer) MEMALLOC(SIZEOF(RollingBuffer) + SIZEOF(SIZE_T) * slotCount);
     CHK(pRollingBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
     pRollingBuffer->capacity = capacity;
+    pRollingBuffer->indexMask = slotCount - 1;
     pRollingBuffer->headIndex = 0;
     pRollingBuffer->tailIndex = 0;
     pRollingBuffer->freeDataFn = freeDataFunc;
-    pRollingBuffer->lock = MUTEX_CREATE(FALSE);
-    pRollingBuffer->dataBuffer = (PUINT64) (pRollingBuffer + 1);
-    MEMSET(pRollingBuffer->dataBuffer, 0, SIZEOF(UINT64) * pRollingBuffer->capacity);
+    pRollingBuffer->dataBuffer = (volatile SIZE_T*) (pRollingBuffer + 1);
+    MEMSET((PVOID) pRollingBuffer->dataBuffer, 0, SIZEOF(SIZE_T) * slotCount);
 
 CleanUp:
     if (STATUS_FAILED(retStatus) && pRollingBuffer != NULL) {
@@ -37,7 +44,7 @@ STATUS freeRollingBuffer(PRollingBuffer* ppRollingBuffer)
 {
     ENTERS();
     PRollingBuffer pRollingBuffer = NULL;
-    PUINT64 pCurData;
+    UINT32 i;
 
     STATUS retStatus = STATUS_SUCCESS;
 
@@ -47,17 +54,11 @@ STATUS freeRollingBuffer(PRollingBuffer* ppRollingBuffer)
     // freeRollingBuffer is idempotent
     CHK(pRollingBuffer != NULL, retStatus);
 
-    MUTEX_LOCK(pRollingBuffer->lock);
-    while (pRollingBuffer->tailIndex < pRollingBuffer->headIndex) {
-        pCurData = pRollingBuffer->dataBuffer + ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, pRollingBuffer->tailIndex);
-        if (pRollingBuffer->freeDataFn != NULL) {
-            pRollingBuffer->freeDataFn(pCurData);
-            *pCurData = (UINT64) NULL;
-        }
-        pRollingBuffer->tailIndex++;
+    // No reader or writer is left at this point. Every slot is looked at as a reader that lost a race can leave an entry
+    // behind the tail, the writer frees it when it gets to the slot again otherwise
+    for (i = 0; i <= pRollingBuffer->indexMask; i++) {
+        rollingBufferFreeData(pRollingBuffer, ATOMIC_EXCHANGE(pRollingBuffer->dataBuffer + i, (SIZE_T) NULL));
     }
-    MUTEX_UNLOCK(pRollingBuffer->lock);
-    MUTEX_FREE(pRollingBuffer->lock);
     SAFE_MEMFREE(*ppRollingBuffer);
 CleanUp:
     CHK_LOG_ERR(retStatus);
@@ -66,39 +67,53 @@ CleanUp:
     return retStatus;
 }
 
+STATUS rollingBufferFreeData(PRollingBuffer pRollingBuffer, SIZE_T data)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 item = (UINT64) data;
+
+    CHK(pRollingBuffer != NULL, STATUS_NULL_ARG);
+
+    if (item != (UINT64) NULL && pRollingBuffer->freeDataFn != NULL) {
+        CHK_STATUS(pRollingBuffer->freeDataFn(&item));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
 STATUS rollingBufferAppendData(PRollingBuffer pRollingBuffer, UINT64 data, PUINT64 pIndex)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    BOOL isLocked = FALSE;
+    SIZE_T headIndex, tailIndex, evictedData = (SIZE_T) NULL, staleData;
 
     CHK(pRollingBuffer != NULL, STATUS_NULL_ARG);
 
-    MUTEX_LOCK(pRollingBuffer->lock);
-    isLocked = TRUE;
-
-    if (pRollingBuffer->headIndex == pRollingBuffer->tailIndex) {
-        // Empty buffer
-        pRollingBuffer->dataBuffer[ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, pRollingBuffer->tailIndex)] = data;
-        pRollingBuffer->headIndex = pRollingBuffer->tailIndex + 1;
-    } else {
-        if (pRollingBuffer->headIndex == pRollingBuffer->tailIndex + pRollingBuffer->capacity) {
-            if (pRollingBuffer->freeDataFn != NULL) {
-                CHK_STATUS(
-                    pRollingBuffer->freeDataFn(pRollingBuffer->dataBuffer + ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, pRollingBuffer->tailIndex)));
-            }
-            pRollingBuffer->tailIndex++;
-        }
-        pRollingBuffer->dataBuffer[ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, pRollingBuffer->headIndex)] = data;
-        pRollingBuffer->headIndex++;
+    // Only this thread moves the indexes, loading them is just for the readers' sake
+    headIndex = ATOMIC_LOAD(&pRollingBuffer->headIndex);
+    tailIndex = ATOMIC_LOAD(&pRollingBuffer->tailIndex);
+
+    if (headIndex - tailIndex == pRollingBuffer->capacity) {
+        // Move the tail before taking the oldest data out, a reader holding that slot sees it after its own exchange and
+        // hands the data back instead of keeping it
+        ATOMIC_STORE(&pRollingBuffer->tailIndex, tailIndex + 1);
+        evictedData = ATOMIC_EXCHANGE(pRollingBuffer->dataBuffer + ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, tailIndex), (SIZE_T) NULL);
     }
+
+    // The slot is normally empty, it can only hold something a reader handed back after it rolled out
+    staleData = ATOMIC_EXCHANGE(pRollingBuffer->dataBuffer + ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, headIndex), (SIZE_T) data);
+    ATOMIC_STORE(&pRollingBuffer->headIndex, headIndex + 1);
+
     if (pIndex != NULL) {
-        *pIndex = pRollingBuffer->headIndex - 1;
+        *pIndex = headIndex;
     }
+
+    CHK_STATUS(rollingBufferFreeData(pRollingBuffer, evictedData));
+    CHK_STATUS(rollingBufferFreeData(pRollingBuffer, staleData));
+
 CleanUp:
-    if (isLocked) {
-        MUTEX_UNLOCK(pRollingBuffer->lock);
-    }
 
     CHK_LOG_ERR(retStatus);
 
@@ -110,26 +125,32 @@ STATUS rollingBufferInsertData(PRollingBuffer pRollingBuffer, UINT64 index, UINT
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    BOOL isLocked = FALSE;
-    PUINT64 pData;
+    volatile SIZE_T* pSlot;
+    SIZE_T oldData, expected;
     CHK(pRollingBuffer != NULL, STATUS_NULL_ARG);
 
-    MUTEX_LOCK(pRollingBuffer->lock);
-    isLocked = TRUE;
+    CHK(ROLLING_BUFFER_INDEX_IN_RANGE(index, ATOMIC_LOAD(&pRollingBuffer->tailIndex), ATOMIC_LOAD(&pRollingBuffer->headIndex)),
+        STATUS_ROLLING_BUFFER_NOT_IN_RANGE);
 
-    CHK(pRollingBuffer->headIndex > index && pRollingBuffer->tailIndex <= index, STATUS_ROLLING_BUFFER_NOT_IN_RANGE);
+    pSlot = pRollingBuffer->dataBuffer + ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, index);
+    oldData = ATOMIC_EXCHANGE(pSlot, (SIZE_T) data);
 
-    pData = pRollingBuffer->dataBuffer + ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, index);
-    if (*pData != (UINT64) NULL && pRollingBuffer->freeDataFn != NULL) {
-        pRollingBuffer->freeDataFn(pData);
+    // The writer moved the tail past the index meanwhile. Either the data is still in the slot and goes back to the caller,
+    // or the writer took it out and frees it
+    if ((SIZE_T) ((SIZE_T) index - ATOMIC_LOAD(&pRollingBuffer->tailIndex)) >= pRollingBuffer->capacity) {
+        expected = (SIZE_T) data;
+        if (ATOMIC_COMPARE_EXCHANGE(pSlot, &expected, oldData)) {
+            oldData = (SIZE_T) NULL;
+            retStatus = STATUS_ROLLING_BUFFER_NOT_IN_RANGE;
+        }
     }
-    *pData = data;
 
-CleanUp:
-    if (isLocked) {
-        MUTEX_UNLOCK(pRollingBuffer->lock);
+    if (oldData != (SIZE_T) data) {
+        rollingBufferFreeData(pRollingBuffer, oldData);
     }
 
+CleanUp:
+
     LEAVES();
     return retStatus;
 }
@@ -138,22 +159,29 @@ STATUS rollingBufferExtractData(PRollingBuffer pRollingBuffer, UINT64 index, PUI
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    BOOL isLocked = FALSE;
+    volatile SIZE_T* pSlot;
+    SIZE_T data = (SIZE_T) NULL, expected;
     CHK(pRollingBuffer != NULL && pData != NULL, STATUS_NULL_ARG);
 
-    MUTEX_LOCK(pRollingBuffer->lock);
-    isLocked = TRUE;
-    if (pRollingBuffer->headIndex > index && pRollingBuffer->tailIndex <= index) {
-        *pData = pRollingBuffer->dataBuffer[ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, index)];
-        if (*pData != (UINT64) NULL) {
-            pRollingBuffer->dataBuffer[ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, index)] = (UINT64) NULL;
+    CHK(ROLLING_BUFFER_INDEX_IN_RANGE(index, ATOMIC_LOAD(&pRollingBuffer->tailIndex), ATOMIC_LOAD(&pRollingBuffer->headIndex)), retStatus);
+
+    pSlot = pRollingBuffer->dataBuffer + ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, index);
+    data = ATOMIC_EXCHANGE(pSlot, (SIZE_T) NULL);
+
+    // The writer moved the tail past the index meanwhile, the data is either the rolled out one or already the next one
+    // put in the slot. Hand it back, the writer frees it with the slot in the first case. If the writer filled the slot
+    // in between, the data rolled out and nobody else knows about it.
+    if (data != (SIZE_T) NULL && (SIZE_T) ((SIZE_T) index - ATOMIC_LOAD(&pRollingBuffer->tailIndex)) >= pRollingBuffer->capacity) {
+        expected = (SIZE_T) NULL;
+        if (!ATOMIC_COMPARE_EXCHANGE(pSlot, &expected, data)) {
+            rollingBufferFreeData(pRollingBuffer, data);
         }
-    } else {
-        *pData = (UINT64) NULL;
+        data = (SIZE_T) NULL;
     }
+
 CleanUp:
-    if (isLocked) {
-        MUTEX_UNLOCK(pRollingBuffer->lock);
+    if (pData != NULL) {
+        *pData = (UINT64) data;
     }
     CHK_LOG_ERR(retStatus);
 
@@ -165,9 +193,12 @@ STATUS rollingBufferGetSize(PRollingBuffer pRollingBuffer, PUINT32 pSize)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
+    SIZE_T tailIndex;
 
     CHK(pRollingBuffer != NULL && pSize != NULL, STATUS_NULL_ARG);
-    *pSize = pRollingBuffer->headIndex - pRollingBuffer->tailIndex;
+    // Tail first, the head loaded after it can't be behind it. Both can move in between so the size is capped
+    tailIndex = ATOMIC_LOAD(&pRollingBuffer->tailIndex);
+    *pSize = (UINT32) MIN(ATOMIC_LOAD(&pRollingBuffer->headIndex) - tailIndex, pRollingBuffer->capacity);
 CleanUp:
     CHK_LOG_ERR(retStatus);
 
@@ -180,7 +211,7 @@ STATUS rollingBufferIsEmpty(PRollingBuffer pRollingBuffer, PBOOL pIsEmpty)
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     CHK(pRollingBuffer != NULL && pIsEmpty != NULL, STATUS_NULL_ARG);
-    *pIsEmpty = (pRollingBuffer->headIndex == pRollingBuffer->tailIndex);
+    *pIsEmpty = (ATOMIC_LOAD(&pRollingBuffer->headIndex) == ATOMIC_LOAD(&pRollingBuffer->tailIndex));
 
 CleanUp:
     CHK_LOG_ERR(retStatus);
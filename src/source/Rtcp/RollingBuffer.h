@@ -12,27 +12,55 @@ extern "C" {
 
 typedef STATUS (*FreeDataFunc)(PUINT64);
 
+// Keeps the power of two slot count in a UINT32
+#define MAX_ROLLING_BUFFER_CAPACITY 0x80000000
+
+/*
+ * Single writer, many reader ring without a lock. Only one thread appends, any number of threads extract and insert back.
+ * Whoever atomically exchanges a data pointer out of a slot owns it, so an entry is either in its slot, taken by a reader
+ * or freed by the writer when it rolls out, never two of them. A reader re-checks the tail after every exchange and hands
+ * the entry back when the writer rolled past the index meanwhile. Only if the writer gets all the way around to the same
+ * slot during a single call can a reader end up with the entry of an index a multiple of the slot count away.
+ */
 typedef struct {
-    // Lock guarding the rolling buffer
-    MUTEX lock;
-    // Max size of data buffer array
+    // Max number of data kept in the buffer
     UINT32 capacity;
-    // Head index point to next empty slot to put data
-    UINT64 headIndex;
-    // Tail index point to oldest slot with data inside
-    UINT64 tailIndex;
+    // Number of slots minus one, the slot count is capacity rounded up to a power of two
+    UINT32 indexMask;
+    // Head index point to next empty slot to put data, only moved by the writer
+    volatile SIZE_T headIndex;
+    // Tail index point to oldest slot with data inside, only moved by the writer
+    volatile SIZE_T tailIndex;
     // Buffer storing pointers, each pointer point to actual data
-    PUINT64 dataBuffer;
+    volatile SIZE_T* dataBuffer;
     // Function being called when data pointer is removed from buffer
     FreeDataFunc freeDataFn;
 } RollingBuffer, *PRollingBuffer;
 
-#define ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, index) ((index) % (pRollingBuffer)->capacity)
+#define ROLLING_BUFFER_MAP_INDEX(pRollingBuffer, index) ((SIZE_T) (index) & (pRollingBuffer)->indexMask)
+
+// Whether index is in [tailIndex, headIndex), still right once the indexes wrap
+#define ROLLING_BUFFER_INDEX_IN_RANGE(index, tailIndex, headIndex) ((SIZE_T) ((SIZE_T) (index) - (tailIndex)) < (SIZE_T) ((headIndex) - (tailIndex)))
 
 STATUS createRollingBuffer(UINT32, FreeDataFunc, PRollingBuffer*);
 STATUS freeRollingBuffer(PRollingBuffer*);
+STATUS rollingBufferFreeData(PRollingBuffer, SIZE_T);
+
+/**
+ * Appends data and frees the oldest one if the buffer is full. Wait free, must only be called from one thread at a time.
+ */
 STATUS rollingBufferAppendData(PRollingBuffer, UINT64, PUINT64);
+
+/**
+ * Puts data back at an index, freeing what is there. Returns STATUS_ROLLING_BUFFER_NOT_IN_RANGE and leaves the data to
+ * the caller if the index rolled out of the buffer, otherwise the buffer owns the data even if it rolls out right after.
+ */
 STATUS rollingBufferInsertData(PRollingBuffer, UINT64, UINT64);
+
+/**
+ * Takes the data at an index out of the buffer, the caller owns it until it is inserted back. Data is NULL if the index
+ * is not in the buffer or another reader holds it.
+ */
 STATUS rollingBufferExtractData(PRollingBuffer, UINT64, PUINT64);
 STATUS rollingBufferGetSize(PRollingBuffer, PUINT32);
 STATUS rollingBufferIsEmpty(PRollingBuffer, PBOOL);
@@ -68,7 +68,7 @@ STATUS rtpRollingBufferAddRtpPacket(PRtpRollingBuffer pRollingBuffer, PRtpPacket
     pRawPacketCopy = NULL;
 
     CHK_STATUS(rollingBufferAppendData(pRollingBuffer->pRollingBuffer, (UINT64) pRtpPacketCopy, &index));
-    pRollingBuffer->lastIndex = index;
+    ATOMIC_STORE(&pRollingBuffer->lastIndex, (SIZE_T) index);
 
 CleanUp:
     SAFE_MEMFREE(pRawPacketCopy);
@@ -90,15 +90,19 @@ STATUS rtpRollingBufferGetValidSeqIndexList(PRtpRollingBuffer pRollingBuffer, PU
     PUINT64 pCurSeqIndexListPtr;
     UINT16 seqNum;
     UINT32 size = 0;
+    UINT64 lastIndex;
 
     CHK(pRollingBuffer != NULL && pValidSeqIndexList != NULL && pSequenceNumberList != NULL, STATUS_NULL_ARG);
 
+    // Loaded before the size, a packet added in between only makes the range start before the tail, which extracting
+    // treats as not found
+    lastIndex = (UINT64) ATOMIC_LOAD(&pRollingBuffer->lastIndex);
     CHK_STATUS(rollingBufferGetSize(pRollingBuffer->pRollingBuffer, &size));
     // Empty buffer, just return
     CHK(size > 0, retStatus);
 
-    startSeq = GET_UINT16_SEQ_NUM(pRollingBuffer->lastIndex - size + 1);
-    endSeq = GET_UINT16_SEQ_NUM(pRollingBuffer->lastIndex);
+    startSeq = GET_UINT16_SEQ_NUM(lastIndex - size + 1);
+    endSeq = GET_UINT16_SEQ_NUM(lastIndex);
 
     if (startSeq >= endSeq) {
         crossMaxSeq = TRUE;
@@ -109,10 +113,10 @@ STATUS rtpRollingBufferGetValidSeqIndexList(PRtpRollingBuffer pRollingBuffer, PU
         seqNum = *pCurSeqPtr;
         foundPacket = FALSE;
         if ((!crossMaxSeq && seqNum >= startSeq && seqNum <= endSeq) || (crossMaxSeq && seqNum >= startSeq)) {
-            *pCurSeqIndexListPtr = pRollingBuffer->lastIndex - size + 1 + seqNum - startSeq;
+            *pCurSeqIndexListPtr = lastIndex - size + 1 + seqNum - startSeq;
             foundPacket = TRUE;
         } else if (crossMaxSeq && seqNum <= endSeq) {
-            *pCurSeqIndexListPtr = pRollingBuffer->lastIndex - endSeq + seqNum;
+            *pCurSeqIndexListPtr = lastIndex - endSeq + seqNum;
             foundPacket = TRUE;
         }
         if (foundPacket) {
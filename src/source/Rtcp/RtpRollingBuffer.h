@@ -12,8 +12,8 @@ extern "C" {
 
 typedef struct {
     PRollingBuffer pRollingBuffer;
-    // index of last rtp packet in rolling buffer
-    UINT64 lastIndex;
+    // index of last rtp packet in rolling buffer, stored by the sender and loaded by the NACK handlers
+    volatile SIZE_T lastIndex;
 } RtpRollingBuffer, *PRtpRollingBuffer;
 
 STATUS createRtpRollingBuffer(UINT32, PRtpRollingBuffer*);
@@ -0,0 +1,457 @@
+#define LOG_CLASS "RtpAV1DependencyDescriptor"
+
+#include "../../Include_i.h"
+
+#define AV1_DD_NEXT_LAYER_SAME          0
+#define AV1_DD_NEXT_LAYER_NEXT_TEMPORAL 1
+#define AV1_DD_NEXT_LAYER_NEXT_SPATIAL  2
+#define AV1_DD_NEXT_LAYER_NONE          3
+#define AV1_DD_MAX_TEMPORAL_LAYERS      8
+#define AV1_DD_MAX_TEMPLATE_FRAME_DIFF  16
+#define AV1_DD_MAX_CUSTOM_FRAME_DIFF    4096
+#define AV1_DD_MAX_TEMPLATE_CHAIN_DIFF  15
+
+// Bit stream over the descriptor, the writer only counts bits when the buffer is NULL
+typedef struct {
+    PBYTE buffer;
+    UINT32 bitLength;
+    UINT32 bitOffset;
+} Av1BitStream, *PAv1BitStream;
+
+static STATUS av1ReadBits(PAv1BitStream pStream, UINT32 bitCount, PUINT32 pValue)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 value = 0, i;
+
+    CHK(bitCount <= pStream->bitLength - pStream->bitOffset, STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR);
+
+    for (i = 0; i < bitCount; i++, pStream->bitOffset++) {
+        value = (value << 1) | ((pStream->buffer[pStream->bitOffset / 8] >> (7 - pStream->bitOffset % 8)) & 0x01);
+    }
+
+    *pValue = value;
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS av1WriteBits(PAv1BitStream pStream, UINT32 bitCount, UINT32 value)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, bitOffset;
+
+    if (pStream->buffer != NULL) {
+        CHK(bitCount <= pStream->bitLength - pStream->bitOffset, STATUS_BUFFER_TOO_SMALL);
+        for (i = 0; i < bitCount; i++) {
+            bitOffset = pStream->bitOffset + i;
+            pStream->buffer[bitOffset / 8] |= (BYTE) (((value >> (bitCount - 1 - i)) & 0x01) << (7 - bitOffset % 8));
+        }
+    }
+
+    pStream->bitOffset += bitCount;
+
+CleanUp:
+
+    return retStatus;
+}
+
+// ns(n) non-symmetric unsigned encoding of a value below n https://aomediacodec.github.io/av1-spec/#nsn
+static UINT32 av1NonSymmetricWidth(UINT32 n)
+{
+    UINT32 width = 0;
+
+    while (n != 0) {
+        n >>= 1;
+        width++;
+    }
+
+    return width;
+}
+
+static STATUS av1ReadNonSymmetric(PAv1BitStream pStream, UINT32 n, PUINT32 pValue)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 width = av1NonSymmetricWidth(n), m = (1 << width) - n, value, extraBit;
+
+    CHK_STATUS(av1ReadBits(pStream, width - 1, &value));
+    if (value >= m) {
+        CHK_STATUS(av1ReadBits(pStream, 1, &extraBit));
+        value = (value << 1) - m + extraBit;
+    }
+
+    *pValue = value;
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS av1WriteNonSymmetric(PAv1BitStream pStream, UINT32 n, UINT32 value)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 width = av1NonSymmetricWidth(n), m = (1 << width) - n;
+
+    if (value < m) {
+        CHK_STATUS(av1WriteBits(pStream, width - 1, value));
+    } else {
+        CHK_STATUS(av1WriteBits(pStream, width - 1, (value + m) >> 1));
+        CHK_STATUS(av1WriteBits(pStream, 1, (value + m) & 0x01));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS readAv1DependencyStructure(PAv1BitStream pStream, PAv1DependencyStructure pStructure)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 value, nextLayerIdc, i, j, spatialId = 0, temporalId = 0;
+    PAv1FrameDependencies pTemplate;
+
+    MEMSET(pStructure, 0x00, SIZEOF(Av1DependencyStructure));
+
+    CHK_STATUS(av1ReadBits(pStream, 6, &value));
+    pStructure->templateIdOffset = (UINT8) value;
+    CHK_STATUS(av1ReadBits(pStream, 5, &value));
+    pStructure->decodeTargetCount = (UINT8) (value + 1);
+
+    // template_layers()
+    do {
+        CHK(pStructure->templateCount < AV1_DEPENDENCY_DESCRIPTOR_MAX_TEMPLATES, STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR);
+        pTemplate = &pStructure->templates[pStructure->templateCount++];
+        pTemplate->spatialId = (UINT8) spatialId;
+        pTemplate->temporalId = (UINT8) temporalId;
+        CHK_STATUS(av1ReadBits(pStream, 2, &nextLayerIdc));
+        if (nextLayerIdc == AV1_DD_NEXT_LAYER_NEXT_TEMPORAL) {
+            CHK(++temporalId < AV1_DD_MAX_TEMPORAL_LAYERS, STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR);
+        } else if (nextLayerIdc == AV1_DD_NEXT_LAYER_NEXT_SPATIAL) {
+            temporalId = 0;
+            CHK(++spatialId < AV1_DEPENDENCY_DESCRIPTOR_MAX_SPATIAL_LAYERS, STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR);
+        }
+    } while (nextLayerIdc != AV1_DD_NEXT_LAYER_NONE);
+
+    // template_dtis()
+    for (i = 0; i < pStructure->templateCount; i++) {
+        for (j = 0; j < pStructure->decodeTargetCount; j++) {
+            CHK_STATUS(av1ReadBits(pStream, 2, &value));
+            pStructure->templates[i].decodeTargetIndications[j] = (UINT8) value;
+        }
+    }
+
+    // template_fdiffs()
+    for (i = 0; i < pStructure->templateCount; i++) {
+        pTemplate = &pStructure->templates[i];
+        CHK_STATUS(av1ReadBits(pStream, 1, &value));
+        while (value != 0) {
+            CHK(pTemplate->frameDiffCount < AV1_DEPENDENCY_DESCRIPTOR_MAX_FRAME_DIFFS, STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR);
+            CHK_STATUS(av1ReadBits(pStream, 4, &value));
+            pTemplate->frameDiffs[pTemplate->frameDiffCount++] = (UINT16) (value + 1);
+            CHK_STATUS(av1ReadBits(pStream, 1, &value));
+        }
+    }
+
+    // template_chains()
+    CHK_STATUS(av1ReadNonSymmetric(pStream, pStructure->decodeTargetCount + 1, &value));
+    pStructure->chainCount = (UINT8) value;
+    if (pStructure->chainCount != 0) {
+        for (i = 0; i < pStructure->decodeTargetCount; i++) {
+            CHK_STATUS(av1ReadNonSymmetric(pStream, pStructure->chainCount, &value));
+            pStructure->decodeTargetProtectedBy[i] = (UINT8) value;
+        }
+        for (i = 0; i < pStructure->templateCount; i++) {
+            for (j = 0; j < pStructure->chainCount; j++) {
+                CHK_STATUS(av1ReadBits(pStream, 4, &value));
+                pStructure->templates[i].chainDiffs[j] = (UINT8) value;
+            }
+        }
+    }
+
+    // render_resolutions(), one per spatial layer up to the spatial id of the last template
+    CHK_STATUS(av1ReadBits(pStream, 1, &value));
+    pStructure->resolutionsPresent = value != 0;
+    if (pStructure->resolutionsPresent) {
+        for (i = 0; i <= spatialId; i++) {
+            CHK_STATUS(av1ReadBits(pStream, 16, &value));
+            pStructure->renderWidths[i] = value + 1;
+            CHK_STATUS(av1ReadBits(pStream, 16, &value));
+            pStructure->renderHeights[i] = value + 1;
+        }
+    }
+
+CleanUp:
+
+    // Descriptors which follow can not be resolved against a partially parsed structure
+    if (STATUS_FAILED(retStatus)) {
+        pStructure->templateCount = 0;
+    }
+
+    return retStatus;
+}
+
+static STATUS writeAv1DependencyStructure(PAv1BitStream pStream, PAv1DependencyStructure pStructure)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 nextLayerIdc, i, j;
+    PAv1FrameDependencies pTemplate, pNextTemplate;
+
+    CHK(pStructure->decodeTargetCount != 0 && pStructure->decodeTargetCount <= AV1_DEPENDENCY_DESCRIPTOR_MAX_DECODE_TARGETS &&
+            pStructure->templateCount != 0 && pStructure->templateCount <= AV1_DEPENDENCY_DESCRIPTOR_MAX_TEMPLATES &&
+            pStructure->templateIdOffset < AV1_DEPENDENCY_DESCRIPTOR_MAX_TEMPLATES && pStructure->chainCount <= pStructure->decodeTargetCount,
+        STATUS_INVALID_ARG);
+    CHK(pStructure->templates[0].spatialId == 0 && pStructure->templates[0].temporalId == 0, STATUS_INVALID_ARG);
+
+    CHK_STATUS(av1WriteBits(pStream, 6, pStructure->templateIdOffset));
+    CHK_STATUS(av1WriteBits(pStream, 5, pStructure->decodeTargetCount - 1));
+
+    // Templates are ordered by spatial then temporal id, each one may only step to the next layer
+    for (i = 0; i < pStructure->templateCount; i++) {
+        pTemplate = &pStructure->templates[i];
+        nextLayerIdc = AV1_DD_NEXT_LAYER_NONE;
+        if (i + 1 < pStructure->templateCount) {
+            pNextTemplate = &pStructure->templates[i + 1];
+            if (pNextTemplate->spatialId == pTemplate->spatialId && pNextTemplate->temporalId == pTemplate->temporalId) {
+                nextLayerIdc = AV1_DD_NEXT_LAYER_SAME;
+            } else if (pNextTemplate->spatialId == pTemplate->spatialId && pNextTemplate->temporalId == pTemplate->temporalId + 1) {
+                nextLayerIdc = AV1_DD_NEXT_LAYER_NEXT_TEMPORAL;
+            } else if (pNextTemplate->spatialId == pTemplate->spatialId + 1 && pNextTemplate->temporalId == 0) {
+                nextLayerIdc = AV1_DD_NEXT_LAYER_NEXT_SPATIAL;
+            }
+            CHK(nextLayerIdc != AV1_DD_NEXT_LAYER_NONE, STATUS_INVALID_ARG);
+        }
+        CHK_STATUS(av1WriteBits(pStream, 2, nextLayerIdc));
+    }
+    CHK(pStructure->templates[pStructure->templateCount - 1].spatialId < AV1_DEPENDENCY_DESCRIPTOR_MAX_SPATIAL_LAYERS, STATUS_INVALID_ARG);
+
+    for (i = 0; i < pStructure->templateCount; i++) {
+        for (j = 0; j < pStructure->decodeTargetCount; j++) {
+            CHK_STATUS(av1WriteBits(pStream, 2, pStructure->templates[i].decodeTargetIndications[j]));
+        }
+    }
+
+    for (i = 0; i < pStructure->templateCount; i++) {
+        pTemplate = &pStructure->templates[i];
+        CHK(pTemplate->frameDiffCount <= AV1_DEPENDENCY_DESCRIPTOR_MAX_FRAME_DIFFS, STATUS_INVALID_ARG);
+        for (j = 0; j < pTemplate->frameDiffCount; j++) {
+            CHK(pTemplate->frameDiffs[j] != 0 && pTemplate->frameDiffs[j] <= AV1_DD_MAX_TEMPLATE_FRAME_DIFF, STATUS_INVALID_ARG);
+            CHK_STATUS(av1WriteBits(pStream, 1, 1));
+            CHK_STATUS(av1WriteBits(pStream, 4, pTemplate->frameDiffs[j] - 1));
+        }
+        CHK_STATUS(av1WriteBits(pStream, 1, 0));
+    }
+
+    CHK_STATUS(av1WriteNonSymmetric(pStream, pStructure->decodeTargetCount + 1, pStructure->chainCount));
+    if (pStructure->chainCount != 0) {
+        for (i = 0; i < pStructure->decodeTargetCount; i++) {
+            CHK(pStructure->decodeTargetProtectedBy[i] < pStructure->chainCount, STATUS_INVALID_ARG);
+            CHK_STATUS(av1WriteNonSymmetric(pStream, pStructure->chainCount, pStructure->decodeTargetProtectedBy[i]));
+        }
+        for (i = 0; i < pStructure->templateCount; i++) {
+            for (j = 0; j < pStructure->chainCount; j++) {
+                CHK(pStructure->templates[i].chainDiffs[j] <= AV1_DD_MAX_TEMPLATE_CHAIN_DIFF, STATUS_INVALID_ARG);
+                CHK_STATUS(av1WriteBits(pStream, 4, pStructure->templates[i].chainDiffs[j]));
+            }
+        }
+    }
+
+    CHK_STATUS(av1WriteBits(pStream, 1, pStructure->resolutionsPresent ? 1 : 0));
+    if (pStructure->resolutionsPresent) {
+        for (i = 0; i <= pStructure->templates[pStructure->templateCount - 1].spatialId; i++) {
+            CHK(pStructure->renderWidths[i] != 0 && pStructure->renderWidths[i] <= MAX_UINT16 + 1 && pStructure->renderHeights[i] != 0 &&
+                    pStructure->renderHeights[i] <= MAX_UINT16 + 1,
+                STATUS_INVALID_ARG);
+            CHK_STATUS(av1WriteBits(pStream, 16, pStructure->renderWidths[i] - 1));
+            CHK_STATUS(av1WriteBits(pStream, 16, pStructure->renderHeights[i] - 1));
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS parseAv1DependencyDescriptor(PBYTE pBuffer, UINT32 bufferLength, PAv1DependencyStructure pStructure, PAv1DependencyDescriptor pDescriptor)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    Av1BitStream stream;
+    UINT32 value, templateIndex, nextFrameDiffSize, i;
+    PAv1FrameDependencies pFrameDependencies;
+
+    CHK(pBuffer != NULL && pStructure != NULL && pDescriptor != NULL, STATUS_NULL_ARG);
+    CHK(bufferLength >= AV1_DEPENDENCY_DESCRIPTOR_MANDATORY_SIZE, STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR);
+
+    MEMSET(pDescriptor, 0x00, SIZEOF(Av1DependencyDescriptor));
+    stream.buffer = pBuffer;
+    stream.bitLength = bufferLength * 8;
+    stream.bitOffset = 0;
+
+    // mandatory_descriptor_fields()
+    CHK_STATUS(av1ReadBits(&stream, 1, &value));
+    pDescriptor->startOfFrame = value != 0;
+    CHK_STATUS(av1ReadBits(&stream, 1, &value));
+    pDescriptor->endOfFrame = value != 0;
+    CHK_STATUS(av1ReadBits(&stream, 6, &value));
+    pDescriptor->frameDependencyTemplateId = (UINT8) value;
+    CHK_STATUS(av1ReadBits(&stream, 16, &value));
+    pDescriptor->frameNumber = (UINT16) value;
+
+    // extended_descriptor_fields()
+    if (bufferLength > AV1_DEPENDENCY_DESCRIPTOR_MANDATORY_SIZE) {
+        CHK_STATUS(av1ReadBits(&stream, 1, &value));
+        pDescriptor->structurePresent = value != 0;
+        CHK_STATUS(av1ReadBits(&stream, 1, &value));
+        pDescriptor->activeDecodeTargetsPresent = value != 0;
+        CHK_STATUS(av1ReadBits(&stream, 1, &value));
+        pDescriptor->customDtis = value != 0;
+        CHK_STATUS(av1ReadBits(&stream, 1, &value));
+        pDescriptor->customFrameDiffs = value != 0;
+        CHK_STATUS(av1ReadBits(&stream, 1, &value));
+        pDescriptor->customChains = value != 0;
+
+        if (pDescriptor->structurePresent) {
+            CHK_STATUS(readAv1DependencyStructure(&stream, pStructure));
+            pDescriptor->activeDecodeTargetsBitmask = (UINT32) ((1ULL << pStructure->decodeTargetCount) - 1);
+        }
+
+        if (pDescriptor->activeDecodeTargetsPresent) {
+            CHK(pStructure->templateCount != 0, STATUS_RTP_MISSING_DEPENDENCY_STRUCTURE);
+            CHK_STATUS(av1ReadBits(&stream, pStructure->decodeTargetCount, &pDescriptor->activeDecodeTargetsBitmask));
+        }
+    }
+
+    // frame_dependency_definition()
+    CHK(pStructure->templateCount != 0, STATUS_RTP_MISSING_DEPENDENCY_STRUCTURE);
+    templateIndex = (pDescriptor->frameDependencyTemplateId + AV1_DEPENDENCY_DESCRIPTOR_MAX_TEMPLATES - pStructure->templateIdOffset) %
+        AV1_DEPENDENCY_DESCRIPTOR_MAX_TEMPLATES;
+    CHK(templateIndex < pStructure->templateCount, STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR);
+
+    pFrameDependencies = &pDescriptor->frameDependencies;
+    MEMCPY(pFrameDependencies, &pStructure->templates[templateIndex], SIZEOF(Av1FrameDependencies));
+
+    if (pDescriptor->customDtis) {
+        for (i = 0; i < pStructure->decodeTargetCount; i++) {
+            CHK_STATUS(av1ReadBits(&stream, 2, &value));
+            pFrameDependencies->decodeTargetIndications[i] = (UINT8) value;
+        }
+    }
+
+    if (pDescriptor->customFrameDiffs) {
+        pFrameDependencies->frameDiffCount = 0;
+        CHK_STATUS(av1ReadBits(&stream, 2, &nextFrameDiffSize));
+        while (nextFrameDiffSize != 0) {
+            CHK(pFrameDependencies->frameDiffCount < AV1_DEPENDENCY_DESCRIPTOR_MAX_FRAME_DIFFS, STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR);
+            CHK_STATUS(av1ReadBits(&stream, 4 * nextFrameDiffSize, &value));
+            pFrameDependencies->frameDiffs[pFrameDependencies->frameDiffCount++] = (UINT16) (value + 1);
+            CHK_STATUS(av1ReadBits(&stream, 2, &nextFrameDiffSize));
+        }
+    }
+
+    if (pDescriptor->customChains) {
+        for (i = 0; i < pStructure->chainCount; i++) {
+            CHK_STATUS(av1ReadBits(&stream, 8, &value));
+            pFrameDependencies->chainDiffs[i] = (UINT8) value;
+        }
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+static STATUS writeAv1DependencyDescriptorFields(PAv1BitStream pStream, PAv1DependencyDescriptor pDescriptor, PAv1DependencyStructure pStructure)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PAv1FrameDependencies pFrameDependencies = &pDescriptor->frameDependencies;
+    UINT32 frameDiffSize, i;
+    BOOL extended = pDescriptor->structurePresent || pDescriptor->activeDecodeTargetsPresent || pDescriptor->customDtis ||
+        pDescriptor->customFrameDiffs || pDescriptor->customChains;
+
+    CHK(pDescriptor->frameDependencyTemplateId < AV1_DEPENDENCY_DESCRIPTOR_MAX_TEMPLATES, STATUS_INVALID_ARG);
+    CHK(!extended || pStructure != NULL, STATUS_RTP_MISSING_DEPENDENCY_STRUCTURE);
+
+    CHK_STATUS(av1WriteBits(pStream, 1, pDescriptor->startOfFrame ? 1 : 0));
+    CHK_STATUS(av1WriteBits(pStream, 1, pDescriptor->endOfFrame ? 1 : 0));
+    CHK_STATUS(av1WriteBits(pStream, 6, pDescriptor->frameDependencyTemplateId));
+    CHK_STATUS(av1WriteBits(pStream, 16, pDescriptor->frameNumber));
+    CHK(extended, retStatus);
+
+    CHK_STATUS(av1WriteBits(pStream, 1, pDescriptor->structurePresent ? 1 : 0));
+    CHK_STATUS(av1WriteBits(pStream, 1, pDescriptor->activeDecodeTargetsPresent ? 1 : 0));
+    CHK_STATUS(av1WriteBits(pStream, 1, pDescriptor->customDtis ? 1 : 0));
+    CHK_STATUS(av1WriteBits(pStream, 1, pDescriptor->customFrameDiffs ? 1 : 0));
+    CHK_STATUS(av1WriteBits(pStream, 1, pDescriptor->customChains ? 1 : 0));
+
+    if (pDescriptor->structurePresent) {
+        CHK_STATUS(writeAv1DependencyStructure(pStream, pStructure));
+    }
+
+    if (pDescriptor->activeDecodeTargetsPresent) {
+        CHK_STATUS(av1WriteBits(pStream, pStructure->decodeTargetCount, pDescriptor->activeDecodeTargetsBitmask));
+    }
+
+    if (pDescriptor->customDtis) {
+        for (i = 0; i < pStructure->decodeTargetCount; i++) {
+            CHK_STATUS(av1WriteBits(pStream, 2, pFrameDependencies->decodeTargetIndications[i]));
+        }
+    }
+
+    // Each custom frame diff takes 4, 8 or 12 bits
+    if (pDescriptor->customFrameDiffs) {
+        CHK(pFrameDependencies->frameDiffCount <= AV1_DEPENDENCY_DESCRIPTOR_MAX_FRAME_DIFFS, STATUS_INVALID_ARG);
+        for (i = 0; i < pFrameDependencies->frameDiffCount; i++) {
+            CHK(pFrameDependencies->frameDiffs[i] != 0 && pFrameDependencies->frameDiffs[i] <= AV1_DD_MAX_CUSTOM_FRAME_DIFF, STATUS_INVALID_ARG);
+            frameDiffSize = pFrameDependencies->frameDiffs[i] <= 16 ? 1 : (pFrameDependencies->frameDiffs[i] <= 256 ? 2 : 3);
+            CHK_STATUS(av1WriteBits(pStream, 2, frameDiffSize));
+            CHK_STATUS(av1WriteBits(pStream, 4 * frameDiffSize, pFrameDependencies->frameDiffs[i] - 1));
+        }
+        CHK_STATUS(av1WriteBits(pStream, 2, 0));
+    }
+
+    if (pDescriptor->customChains) {
+        for (i = 0; i < pStructure->chainCount; i++) {
+            CHK_STATUS(av1WriteBits(pStream, 8, pFrameDependencies->chainDiffs[i]));
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS writeAv1DependencyDescriptor(PAv1DependencyDescriptor pDescriptor, PAv1DependencyStructure pStructure, PBYTE pBuffer, PUINT32 pBufferLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    Av1BitStream stream;
+    UINT32 descriptorLength = 0;
+
+    CHK(pDescriptor != NULL && pBufferLength != NULL, STATUS_NULL_ARG);
+
+    // Count the bits first so the buffer can be cleared to the exact size before the bits are OR'ed in
+    stream.buffer = NULL;
+    stream.bitLength = 0;
+    stream.bitOffset = 0;
+    CHK_STATUS(writeAv1DependencyDescriptorFields(&stream, pDescriptor, pStructure));
+    descriptorLength = (stream.bitOffset + 7) / 8;
+
+    CHK(pBuffer != NULL, retStatus);
+    CHK(descriptorLength <= *pBufferLength, STATUS_BUFFER_TOO_SMALL);
+
+    MEMSET(pBuffer, 0x00, descriptorLength);
+    stream.buffer = pBuffer;
+    stream.bitLength = descriptorLength * 8;
+    stream.bitOffset = 0;
+    CHK_STATUS(writeAv1DependencyDescriptorFields(&stream, pDescriptor, pStructure));
+
+CleanUp:
+
+    if (pBufferLength != NULL) {
+        *pBufferLength = descriptorLength;
+    }
+
+    LEAVES();
+    return retStatus;
+}
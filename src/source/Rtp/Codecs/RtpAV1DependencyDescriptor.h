@@ -0,0 +1,91 @@
+/*******************************************
+AV1 Dependency Descriptor include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_RTPAV1DEPENDENCYDESCRIPTOR_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_RTPAV1DEPENDENCYDESCRIPTOR_H
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// https://aomediacodec.github.io/av1-rtp-spec/#dependency-descriptor-rtp-header-extension
+#define AV1_DEPENDENCY_DESCRIPTOR_EXTENSION_URI      "https://aomediacodec.github.io/av1-rtp-spec/#dependency-descriptor-rtp-header-extension"
+#define AV1_DEPENDENCY_DESCRIPTOR_MANDATORY_SIZE     3
+#define AV1_DEPENDENCY_DESCRIPTOR_MAX_TEMPLATES      64
+#define AV1_DEPENDENCY_DESCRIPTOR_MAX_DECODE_TARGETS 32
+#define AV1_DEPENDENCY_DESCRIPTOR_MAX_SPATIAL_LAYERS 4
+#define AV1_DEPENDENCY_DESCRIPTOR_MAX_FRAME_DIFFS    16
+
+/**
+ * Decode target indications
+ */
+typedef enum {
+    AV1_DTI_NOT_PRESENT = 0,
+    AV1_DTI_DISCARDABLE = 1,
+    AV1_DTI_SWITCH = 2,
+    AV1_DTI_REQUIRED = 3,
+} AV1_DECODE_TARGET_INDICATION;
+
+/**
+ * Dependencies of a frame, either as a template of the structure or as resolved for a single frame
+ */
+typedef struct {
+    UINT8 spatialId;
+    UINT8 temporalId;
+    UINT8 decodeTargetIndications[AV1_DEPENDENCY_DESCRIPTOR_MAX_DECODE_TARGETS];
+    UINT8 frameDiffCount;
+    // Template frame diffs are at most 16, custom ones at most 4096
+    UINT16 frameDiffs[AV1_DEPENDENCY_DESCRIPTOR_MAX_FRAME_DIFFS];
+    UINT8 chainDiffs[AV1_DEPENDENCY_DESCRIPTOR_MAX_DECODE_TARGETS];
+} Av1FrameDependencies, *PAv1FrameDependencies;
+
+/**
+ * Template dependency structure, sent on key frames and kept by the receiver to resolve the descriptors which follow
+ */
+typedef struct {
+    UINT8 templateIdOffset;
+    UINT8 decodeTargetCount;
+    UINT8 chainCount;
+    UINT8 templateCount;
+    UINT8 decodeTargetProtectedBy[AV1_DEPENDENCY_DESCRIPTOR_MAX_DECODE_TARGETS];
+    BOOL resolutionsPresent;
+    UINT32 renderWidths[AV1_DEPENDENCY_DESCRIPTOR_MAX_SPATIAL_LAYERS];
+    UINT32 renderHeights[AV1_DEPENDENCY_DESCRIPTOR_MAX_SPATIAL_LAYERS];
+    Av1FrameDependencies templates[AV1_DEPENDENCY_DESCRIPTOR_MAX_TEMPLATES];
+} Av1DependencyStructure, *PAv1DependencyStructure;
+
+typedef struct {
+    BOOL startOfFrame;
+    BOOL endOfFrame;
+    UINT8 frameDependencyTemplateId;
+    UINT16 frameNumber;
+    // Set when the template dependency structure is attached to the descriptor
+    BOOL structurePresent;
+    BOOL activeDecodeTargetsPresent;
+    // Valid when either flag above is set, the active decode targets of the previous frame still apply otherwise
+    UINT32 activeDecodeTargetsBitmask;
+    // When written, the custom flags select which frame dependencies are sent instead of taken from the template
+    BOOL customDtis;
+    BOOL customFrameDiffs;
+    BOOL customChains;
+    Av1FrameDependencies frameDependencies;
+} Av1DependencyDescriptor, *PAv1DependencyDescriptor;
+
+/**
+ * Parses a dependency descriptor extension element. An attached structure replaces the content of pStructure, otherwise
+ * pStructure must hold the last structure received. frameDependencies are resolved from the template and custom fields.
+ */
+STATUS parseAv1DependencyDescriptor(PBYTE, UINT32, PAv1DependencyStructure, PAv1DependencyDescriptor);
+
+/**
+ * Writes a dependency descriptor extension element, pStructure is attached when structurePresent is set. Only the size is
+ * returned when the buffer is NULL.
+ */
+STATUS writeAv1DependencyDescriptor(PAv1DependencyDescriptor, PAv1DependencyStructure, PBYTE, PUINT32);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_RTPAV1DEPENDENCYDESCRIPTOR_H
@@ -0,0 +1,357 @@
+#define LOG_CLASS "RtpAV1Payloader"
+
+#include "../../Include_i.h"
+
+// At most W elements are aggregated so the last one never needs a length field
+#define AV1_MAX_ELEMENTS_PER_PACKET 3
+
+UINT32 av1Leb128Size(UINT64 value)
+{
+    UINT32 size = 1;
+
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+UINT32 av1WriteLeb128(UINT64 value, PBYTE pBuffer)
+{
+    UINT32 size = 0;
+
+    while (value >= 0x80) {
+        pBuffer[size++] = (BYTE) (0x80 | (value & 0x7F));
+        value >>= 7;
+    }
+    pBuffer[size++] = (BYTE) value;
+
+    return size;
+}
+
+STATUS av1ReadLeb128(PBYTE pBuffer, UINT32 bufferLength, PUINT64 pValue, PUINT32 pSize)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 value = 0;
+    UINT32 i;
+
+    CHK(pBuffer != NULL && pValue != NULL && pSize != NULL, STATUS_NULL_ARG);
+
+    for (i = 0; i < MIN(bufferLength, AV1_MAX_LEB128_SIZE); i++) {
+        value |= ((UINT64) (pBuffer[i] & 0x7F)) << (i * 7);
+        if ((pBuffer[i] & 0x80) == 0) {
+            *pValue = value;
+            *pSize = i + 1;
+            CHK(FALSE, retStatus);
+        }
+    }
+
+    // Truncated or longer than the 8 bytes allowed by the spec
+    CHK(FALSE, STATUS_RTP_INVALID_AV1_OBU);
+
+CleanUp:
+
+    return retStatus;
+}
+
+// Copies a slice of an OBU element, the header has obu_has_size_field cleared so it is not contiguous with the payload in the frame
+static VOID copyAV1ObuElement(PBYTE pDst, PBYTE pObuHeader, UINT32 obuHeaderSize, PBYTE pObuPayload, UINT32 offset, UINT32 length)
+{
+    UINT32 headerPart;
+
+    if (offset < obuHeaderSize) {
+        headerPart = MIN(length, obuHeaderSize - offset);
+        MEMCPY(pDst, pObuHeader + offset, headerPart);
+        pDst += headerPart;
+        offset += headerPart;
+        length -= headerPart;
+    }
+
+    MEMCPY(pDst, pObuPayload + offset - obuHeaderSize, length);
+}
+
+/*
+ * Packetizes a temporal unit in the low overhead bitstream format. Temporal delimiter and tile list OBUs are dropped and
+ * obu_size fields are stripped, OBU elements are aggregated while they fit the mtu and fragmented across packets otherwise.
+ * https://aomediacodec.github.io/av1-rtp-spec/#5-packetization-rules
+ */
+STATUS createPayloadArrayForAV1(UINT32 mtu, PBYTE temporalUnit, UINT32 temporalUnitLength, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE pCurPtr = temporalUnit, pEnd = temporalUnit + temporalUnitLength, pObuPayload, pPacket = NULL, pLastElement;
+    BYTE obuHeader[2], aggregationHeader = 0;
+    UINT32 obuHeaderSize, sizeFieldLength, elementLength, elementOffset, chunkLength, lengthFieldSize;
+    UINT32 packetOffset = 0, packetLength = 0, elementCount = 0, lastElementLength = 0;
+    UINT64 obuSize;
+    BOOL packetOpen = FALSE, hasSequenceHeader = FALSE;
+
+    CHK(temporalUnit != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(mtu > AV1_AGGREGATION_HEADER_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+
+    while (pCurPtr < pEnd) {
+        CHK((pCurPtr[0] & AV1_OBU_FORBIDDEN_BIT) == 0, STATUS_RTP_INVALID_AV1_OBU);
+        obuHeaderSize = (pCurPtr[0] & AV1_OBU_EXTENSION_FLAG) != 0 ? 2 : 1;
+        CHK(obuHeaderSize <= pEnd - pCurPtr, STATUS_RTP_INVALID_AV1_OBU);
+
+        // Without obu_size the OBU runs to the end of the temporal unit
+        sizeFieldLength = 0;
+        obuSize = pEnd - pCurPtr - obuHeaderSize;
+        if ((pCurPtr[0] & AV1_OBU_HAS_SIZE_FLAG) != 0) {
+            CHK_STATUS(av1ReadLeb128(pCurPtr + obuHeaderSize, (UINT32) (pEnd - pCurPtr) - obuHeaderSize, &obuSize, &sizeFieldLength));
+            CHK(obuSize <= (UINT64) (pEnd - pCurPtr - obuHeaderSize - sizeFieldLength), STATUS_RTP_INVALID_AV1_OBU);
+        }
+
+        obuHeader[0] = pCurPtr[0] & ~AV1_OBU_HAS_SIZE_FLAG;
+        obuHeader[1] = obuHeaderSize == 2 ? pCurPtr[1] : 0;
+        pObuPayload = pCurPtr + obuHeaderSize + sizeFieldLength;
+        pCurPtr = pObuPayload + obuSize;
+
+        switch (AV1_OBU_TYPE(obuHeader[0])) {
+            case AV1_OBU_TYPE_TEMPORAL_DELIMITER:
+            case AV1_OBU_TYPE_TILE_LIST:
+                continue;
+            case AV1_OBU_TYPE_SEQUENCE_HEADER:
+                hasSequenceHeader = TRUE;
+                break;
+            default:
+                break;
+        }
+
+        elementLength = obuHeaderSize + (UINT32) obuSize;
+        elementOffset = 0;
+        while (elementOffset < elementLength) {
+            if (!packetOpen) {
+                CHK_STATUS(payloadArrayReserve(pPayloadArray, mtu, 1));
+                packetOffset = pPayloadArray->payloadLength;
+                packetLength = AV1_AGGREGATION_HEADER_SIZE;
+                elementCount = 0;
+                aggregationHeader = elementOffset != 0 ? AV1_AGGREGATION_HEADER_Z : 0;
+                packetOpen = TRUE;
+            }
+            pPacket = pPayloadArray->payloadBuffer + packetOffset;
+
+            // The element which is currently last gets a length field when another one is aggregated behind it
+            lengthFieldSize = elementCount != 0 ? av1Leb128Size(lastElementLength) : 0;
+            if (packetLength + lengthFieldSize < mtu) {
+                if (elementCount != 0) {
+                    pLastElement = pPacket + packetLength - lastElementLength;
+                    MEMMOVE(pLastElement + lengthFieldSize, pLastElement, lastElementLength);
+                    av1WriteLeb128(lastElementLength, pLastElement);
+                    packetLength += lengthFieldSize;
+                }
+
+                chunkLength = MIN(elementLength - elementOffset, mtu - packetLength);
+                copyAV1ObuElement(pPacket + packetLength, obuHeader, obuHeaderSize, pObuPayload, elementOffset, chunkLength);
+                packetLength += chunkLength;
+                elementOffset += chunkLength;
+                lastElementLength = chunkLength;
+                elementCount++;
+
+                if (elementOffset < elementLength) {
+                    aggregationHeader |= AV1_AGGREGATION_HEADER_Y;
+                }
+            }
+
+            if (elementOffset < elementLength || elementCount == AV1_MAX_ELEMENTS_PER_PACKET) {
+                pPacket[0] = aggregationHeader | (BYTE) (elementCount << AV1_AGGREGATION_HEADER_W_SHIFT);
+                pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize++] = packetLength;
+                pPayloadArray->payloadLength += packetLength;
+                packetOpen = FALSE;
+            }
+        }
+    }
+
+    if (packetOpen) {
+        pPacket = pPayloadArray->payloadBuffer + packetOffset;
+        pPacket[0] = aggregationHeader | (BYTE) (elementCount << AV1_AGGREGATION_HEADER_W_SHIFT);
+        pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize++] = packetLength;
+        pPayloadArray->payloadLength += packetLength;
+    }
+
+    // A sequence header starts a new coded video sequence
+    if (hasSequenceHeader && pPayloadArray->payloadSubLenSize != 0) {
+        pPayloadArray->payloadBuffer[0] |= AV1_AGGREGATION_HEADER_N;
+    }
+
+CleanUp:
+    if (STATUS_FAILED(retStatus) && pPayloadArray != NULL) {
+        pPayloadArray->payloadLength = 0;
+        pPayloadArray->payloadSubLenSize = 0;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS depayAV1FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pObuData, PUINT32 pObuLength, PBOOL pIsStart)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE pCurPtr, pEnd, pOutPtr = pObuData;
+    UINT32 obuLength = 0, elementIndex = 0, elementCount, lengthFieldSize;
+    UINT64 elementLength;
+    BYTE flags;
+    BOOL sizeCalculationOnly = (pObuData == NULL);
+    BOOL isStartingPacket = FALSE;
+
+    CHK(pRawPacket != NULL && (pObuLength != NULL || sizeCalculationOnly), STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+    CHK(packetLength > AV1_AGGREGATION_HEADER_SIZE, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+
+    isStartingPacket = (pRawPacket[0] & AV1_AGGREGATION_HEADER_Z) == 0;
+    // Only the start flag was asked for, the elements don't need to be walked
+    CHK(pObuLength != NULL, retStatus);
+    elementCount = (pRawPacket[0] >> AV1_AGGREGATION_HEADER_W_SHIFT) & AV1_AGGREGATION_HEADER_W_MASK;
+    pCurPtr = pRawPacket + AV1_AGGREGATION_HEADER_SIZE;
+    pEnd = pRawPacket + packetLength;
+
+    while (pCurPtr < pEnd) {
+        // With W set the last element takes the rest of the packet
+        if (elementCount != 0 && elementIndex == elementCount - 1) {
+            elementLength = pEnd - pCurPtr;
+        } else {
+            CHK_STATUS(av1ReadLeb128(pCurPtr, (UINT32) (pEnd - pCurPtr), &elementLength, &lengthFieldSize));
+            pCurPtr += lengthFieldSize;
+            CHK(elementLength <= (UINT64) (pEnd - pCurPtr), STATUS_RTP_INVALID_AV1_OBU);
+        }
+
+        flags = 0;
+        if (elementIndex == 0 && !isStartingPacket) {
+            flags |= AV1_ELEMENT_CONTINUES_PREVIOUS;
+        }
+        if (pCurPtr + elementLength == pEnd && (pRawPacket[0] & AV1_AGGREGATION_HEADER_Y) != 0) {
+            flags |= AV1_ELEMENT_CONTINUES_NEXT;
+        }
+
+        if (!sizeCalculationOnly) {
+            CHK(obuLength + AV1_ELEMENT_PREFIX_SIZE + elementLength <= *pObuLength, STATUS_BUFFER_TOO_SMALL);
+            pOutPtr[0] = flags;
+            putUnalignedInt32BigEndian(pOutPtr + 1, (UINT32) elementLength);
+            MEMCPY(pOutPtr + AV1_ELEMENT_PREFIX_SIZE, pCurPtr, (UINT32) elementLength);
+            pOutPtr += AV1_ELEMENT_PREFIX_SIZE + elementLength;
+        }
+
+        obuLength += AV1_ELEMENT_PREFIX_SIZE + (UINT32) elementLength;
+        pCurPtr += elementLength;
+        elementIndex++;
+    }
+
+    DLOGS("AV1 packet starting %d elements %d len %d", isStartingPacket, elementIndex, obuLength);
+
+CleanUp:
+    if (STATUS_FAILED(retStatus) && sizeCalculationOnly) {
+        obuLength = 0;
+    }
+
+    if (pObuLength != NULL) {
+        *pObuLength = obuLength;
+    }
+
+    if (pIsStart != NULL) {
+        *pIsStart = isStartingPacket;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+// Walks the OBU fragments starting at elementOffset, skipping the first skipLength bytes of the OBU and moving up to copyLength bytes to pDst
+static STATUS moveAV1ObuFragments(PBYTE pFrame, UINT32 frameLength, UINT32 elementOffset, UINT32 skipLength, PBYTE pDst, UINT32 copyLength,
+                                  PUINT32 pObuLength, PUINT32 pNextElementOffset)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 obuLength = 0, elementLength, chunkOffset, chunkLength;
+    BYTE flags;
+
+    do {
+        CHK(elementOffset + AV1_ELEMENT_PREFIX_SIZE <= frameLength, STATUS_RTP_INVALID_AV1_OBU);
+        flags = pFrame[elementOffset];
+        elementLength = getUnalignedInt32BigEndian(pFrame + elementOffset + 1);
+        elementOffset += AV1_ELEMENT_PREFIX_SIZE;
+        CHK(elementLength <= frameLength - elementOffset, STATUS_RTP_INVALID_AV1_OBU);
+        CHK((obuLength == 0) == ((flags & AV1_ELEMENT_CONTINUES_PREVIOUS) == 0), STATUS_RTP_INVALID_AV1_OBU);
+
+        // The destination never overtakes the source, so the fragment prefixes ahead are still intact
+        if (skipLength < obuLength + elementLength && copyLength != 0) {
+            chunkOffset = skipLength > obuLength ? skipLength - obuLength : 0;
+            chunkLength = MIN(elementLength - chunkOffset, copyLength);
+            MEMMOVE(pDst, pFrame + elementOffset + chunkOffset, chunkLength);
+            pDst += chunkLength;
+            copyLength -= chunkLength;
+            skipLength += chunkLength;
+        }
+
+        obuLength += elementLength;
+        elementOffset += elementLength;
+    } while ((flags & AV1_ELEMENT_CONTINUES_NEXT) != 0);
+
+    if (pObuLength != NULL) {
+        *pObuLength = obuLength;
+    }
+
+    if (pNextElementOffset != NULL) {
+        *pNextElementOffset = elementOffset;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Reassembles the depayloaded OBU elements of a frame into OBUs with obu_size fields. Each OBU shrinks by at least a byte:
+ * the fragment prefixes are dropped and obu_size takes at most 4 bytes, so the conversion runs in place front to back.
+ */
+STATUS av1ObuElementsToTemporalUnit(PBYTE pFrame, UINT32 frameLength, PUINT32 pTemporalUnitLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE obuStart[2 + AV1_MAX_LEB128_SIZE];
+    UINT32 readOffset = 0, writeOffset = 0, nextElementOffset, obuLength, obuStartLength, obuHeaderSize, sizeFieldLength = 0, sizeFieldSize;
+    UINT64 obuSize;
+
+    CHK(pFrame != NULL && pTemporalUnitLength != NULL, STATUS_NULL_ARG);
+
+    while (readOffset < frameLength) {
+        CHK_STATUS(moveAV1ObuFragments(pFrame, frameLength, readOffset, 0, obuStart, SIZEOF(obuStart), &obuLength, &nextElementOffset));
+        obuStartLength = MIN(obuLength, SIZEOF(obuStart));
+        CHK(obuStartLength != 0 && (obuStart[0] & AV1_OBU_FORBIDDEN_BIT) == 0, STATUS_RTP_INVALID_AV1_OBU);
+        obuHeaderSize = (obuStart[0] & AV1_OBU_EXTENSION_FLAG) != 0 ? 2 : 1;
+        CHK(obuHeaderSize <= obuStartLength, STATUS_RTP_INVALID_AV1_OBU);
+
+        // Senders may keep obu_size even though the spec recommends stripping it
+        sizeFieldLength = 0;
+        if ((obuStart[0] & AV1_OBU_HAS_SIZE_FLAG) != 0) {
+            CHK_STATUS(av1ReadLeb128(obuStart + obuHeaderSize, obuStartLength - obuHeaderSize, &obuSize, &sizeFieldLength));
+            CHK(obuSize == obuLength - obuHeaderSize - sizeFieldLength, STATUS_RTP_INVALID_AV1_OBU);
+        }
+
+        obuSize = obuLength - obuHeaderSize - sizeFieldLength;
+        sizeFieldSize = av1Leb128Size(obuSize);
+        CHK(sizeFieldSize <= AV1_ELEMENT_PREFIX_SIZE - 1, STATUS_RTP_INVALID_AV1_OBU);
+
+        CHK_STATUS(moveAV1ObuFragments(pFrame, frameLength, readOffset, obuHeaderSize + sizeFieldLength,
+                                       pFrame + writeOffset + obuHeaderSize + sizeFieldSize, (UINT32) obuSize, NULL, NULL));
+        pFrame[writeOffset] = obuStart[0] | AV1_OBU_HAS_SIZE_FLAG;
+        if (obuHeaderSize == 2) {
+            pFrame[writeOffset + 1] = obuStart[1];
+        }
+        av1WriteLeb128(obuSize, pFrame + writeOffset + obuHeaderSize);
+
+        writeOffset += obuHeaderSize + sizeFieldSize + (UINT32) obuSize;
+        readOffset = nextElementOffset;
+    }
+
+CleanUp:
+    if (pTemporalUnitLength != NULL) {
+        *pTemporalUnitLength = STATUS_SUCCEEDED(retStatus) ? writeOffset : 0;
+    }
+
+    LEAVES();
+    return retStatus;
+}
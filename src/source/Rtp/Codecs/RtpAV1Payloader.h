@@ -0,0 +1,70 @@
+/*******************************************
+AV1 RTP Payloader include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_RTPAV1PAYLOADER_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_RTPAV1PAYLOADER_H
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Aggregation header https://aomediacodec.github.io/av1-rtp-spec/#44-av1-aggregation-header
+ *
+ *  0 1 2 3 4 5 6 7
+ * +-+-+-+-+-+-+-+-+
+ * |Z|Y| W |N|-|-|-|
+ * +-+-+-+-+-+-+-+-+
+ *
+ * Z: the first OBU element is the continuation of an OBU fragment from the previous packet
+ * Y: the last OBU element continues in the next packet
+ * W: number of OBU elements, the last one has no length field. 0 means every element has a length field
+ * N: first packet of a coded video sequence
+ */
+#define AV1_AGGREGATION_HEADER_SIZE    1
+#define AV1_AGGREGATION_HEADER_Z       0x80
+#define AV1_AGGREGATION_HEADER_Y       0x40
+#define AV1_AGGREGATION_HEADER_W_SHIFT 4
+#define AV1_AGGREGATION_HEADER_W_MASK  0x03
+#define AV1_AGGREGATION_HEADER_N       0x08
+
+/*
+ * OBU header https://aomediacodec.github.io/av1-spec/#obu-header-syntax
+ *
+ *  0 1 2 3 4 5 6 7
+ * +-+-+-+-+-+-+-+-+
+ * |F| type  |X|S|-|
+ * +-+-+-+-+-+-+-+-+
+ */
+#define AV1_OBU_FORBIDDEN_BIT           0x80
+#define AV1_OBU_EXTENSION_FLAG          0x04
+#define AV1_OBU_HAS_SIZE_FLAG           0x02
+#define AV1_OBU_TYPE(b)                 (((b) >> 3) & 0x0F)
+#define AV1_OBU_TYPE_SEQUENCE_HEADER    1
+#define AV1_OBU_TYPE_TEMPORAL_DELIMITER 2
+#define AV1_OBU_TYPE_TILE_LIST          8
+#define AV1_MAX_LEB128_SIZE             8
+
+/*
+ * depayAV1FromRtpPayload writes every OBU element behind a fixed size prefix: a flags byte and the element length as a
+ * 32 bit big endian integer. OBU sizes are only known once all fragments have arrived, so av1ObuElementsToTemporalUnit turns the
+ * depayloaded frame into a low overhead bitstream in place, which is never longer than its input.
+ */
+#define AV1_ELEMENT_PREFIX_SIZE        5
+#define AV1_ELEMENT_CONTINUES_PREVIOUS 0x01
+#define AV1_ELEMENT_CONTINUES_NEXT     0x02
+
+UINT32 av1Leb128Size(UINT64);
+UINT32 av1WriteLeb128(UINT64, PBYTE);
+STATUS av1ReadLeb128(PBYTE, UINT32, PUINT64, PUINT32);
+
+STATUS createPayloadArrayForAV1(UINT32, PBYTE, UINT32, PPayloadArray);
+STATUS depayAV1FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+STATUS av1ObuElementsToTemporalUnit(PBYTE, UINT32, PUINT32);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_RTPAV1PAYLOADER_H
@@ -9,9 +9,8 @@ STATUS createPayloadForG711(UINT32 mtu, PBYTE g711Frame, UINT32 g711FrameLength,
     STATUS retStatus = STATUS_SUCCESS;
     UINT32 payloadLength = 0;
     UINT32 payloadSubLenSize = 0;
-    UINT32 remainingLength = g711FrameLength;
-    PUINT32 pCurSubLen = pPayloadSubLength;
     BOOL sizeCalculationOnly = (payloadBuffer == NULL);
+    PayloadArray payloadArray;
 
     CHK(g711Frame != NULL && pPayloadSubLenSize != NULL && pPayloadLength != NULL && (sizeCalculationOnly || pPayloadSubLength != NULL),
         STATUS_NULL_ARG);
@@ -23,11 +22,13 @@ STATUS createPayloadForG711(UINT32 mtu, PBYTE g711Frame, UINT32 g711FrameLength,
     CHK(!sizeCalculationOnly, retStatus);
     CHK(payloadLength <= *pPayloadLength && payloadSubLenSize <= *pPayloadSubLenSize, STATUS_BUFFER_TOO_SMALL);
 
-    MEMCPY(payloadBuffer, g711Frame, g711FrameLength);
-    for (remainingLength = g711FrameLength; remainingLength > mtu; remainingLength -= mtu, pCurSubLen++) {
-        *pCurSubLen = mtu;
-    }
-    *pCurSubLen = remainingLength;
+    // Capacity is checked above so the single pass payloader never needs to grow the caller's buffers
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    payloadArray.payloadBuffer = payloadBuffer;
+    payloadArray.maxPayloadLength = *pPayloadLength;
+    payloadArray.payloadSubLength = pPayloadSubLength;
+    payloadArray.maxPayloadSubLenSize = *pPayloadSubLenSize;
+    CHK_STATUS(createPayloadArrayForG711(mtu, g711Frame, g711FrameLength, &payloadArray));
 
 CleanUp:
     if (STATUS_FAILED(retStatus) && sizeCalculationOnly) {
@@ -44,6 +45,37 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createPayloadArrayForG711(UINT32 mtu, PBYTE g711Frame, UINT32 g711FrameLength, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 remainingLength, payloadSubLenSize, curSubLength;
+    PUINT32 pCurSubLen;
+
+    CHK(g711Frame != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(mtu > 0, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    payloadSubLenSize = g711FrameLength / mtu + (g711FrameLength % mtu == 0 ? 0 : 1);
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+    CHK_STATUS(payloadArrayReserve(pPayloadArray, g711FrameLength, payloadSubLenSize));
+
+    MEMCPY(pPayloadArray->payloadBuffer, g711Frame, g711FrameLength);
+    pCurSubLen = pPayloadArray->payloadSubLength;
+    for (remainingLength = g711FrameLength; remainingLength > 0; remainingLength -= curSubLength, pCurSubLen++) {
+        curSubLength = MIN(mtu, remainingLength);
+        *pCurSubLen = curSubLength;
+    }
+
+    pPayloadArray->payloadLength = g711FrameLength;
+    pPayloadArray->payloadSubLenSize = payloadSubLenSize;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS depayG711FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pG711Data, PUINT32 pG711Length, PBOOL pIsStart)
 {
     ENTERS();
@@ -51,7 +83,7 @@ STATUS depayG711FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pG71
     UINT32 g711Length = 0;
     BOOL sizeCalculationOnly = (pG711Data == NULL);
 
-    CHK(pRawPacket != NULL && pG711Length != NULL, STATUS_NULL_ARG);
+    CHK(pRawPacket != NULL && (pG711Length != NULL || sizeCalculationOnly), STATUS_NULL_ARG);
     CHK(packetLength > 0, retStatus);
 
     g711Length = packetLength;
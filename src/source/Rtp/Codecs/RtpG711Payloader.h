@@ -11,6 +11,7 @@ extern "C" {
 #endif
 
 STATUS createPayloadForG711(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+STATUS createPayloadArrayForG711(UINT32, PBYTE, UINT32, PPayloadArray);
 STATUS depayG711FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
 
 #ifdef __cplusplus
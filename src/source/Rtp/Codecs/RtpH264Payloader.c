@@ -73,14 +73,67 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createPayloadArrayForH264(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE curPtrInNalus = nalus;
+    UINT32 remainNalusLength = nalusLength;
+    UINT32 nextNaluLength = 0;
+    UINT32 startIndex = 0;
+    UINT32 maxFragmentCount = 0;
+    UINT32 filledLength = 0;
+    UINT32 filledSubLenSize = 0;
+    PayloadArray remainingPayloadArray;
+
+    CHK(nalus != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(mtu > FU_A_HEADER_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+
+    do {
+        CHK_STATUS(getNextNaluLength(curPtrInNalus, remainNalusLength, &startIndex, &nextNaluLength));
+
+        curPtrInNalus += startIndex;
+
+        remainNalusLength -= startIndex;
+
+        CHK(remainNalusLength != 0, retStatus);
+
+        // Reserve for the FU-A worst case so the NALU is packetized straight into the array
+        maxFragmentCount = nextNaluLength / (mtu - FU_A_HEADER_SIZE) + 1;
+        CHK_STATUS(payloadArrayReserve(pPayloadArray, nextNaluLength + maxFragmentCount * FU_A_HEADER_SIZE, maxFragmentCount));
+
+        remainingPayloadArray.payloadBuffer = pPayloadArray->payloadBuffer + pPayloadArray->payloadLength;
+        remainingPayloadArray.maxPayloadLength = pPayloadArray->maxPayloadLength - pPayloadArray->payloadLength;
+        remainingPayloadArray.payloadSubLength = pPayloadArray->payloadSubLength + pPayloadArray->payloadSubLenSize;
+        remainingPayloadArray.maxPayloadSubLenSize = pPayloadArray->maxPayloadSubLenSize - pPayloadArray->payloadSubLenSize;
+        CHK_STATUS(createPayloadFromNalu(mtu, curPtrInNalus, nextNaluLength, &remainingPayloadArray, &filledLength, &filledSubLenSize));
+
+        pPayloadArray->payloadLength += filledLength;
+        pPayloadArray->payloadSubLenSize += filledSubLenSize;
+
+        remainNalusLength -= nextNaluLength;
+        curPtrInNalus += nextNaluLength;
+    } while (remainNalusLength != 0);
+
+CleanUp:
+    if (STATUS_FAILED(retStatus) && pPayloadArray != NULL) {
+        pPayloadArray->payloadLength = 0;
+        pPayloadArray->payloadSubLenSize = 0;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS getNextNaluLength(PBYTE nalus, UINT32 nalusLength, PUINT32 pStart, PUINT32 pNaluLength)
 {
     ENTERS();
 
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 zeroCount = 0, offset;
-    BOOL naluFound = FALSE;
-    PBYTE pCurrent = NULL;
+    UINT32 offset, nextStartCode;
 
     CHK(nalus != NULL && pStart != NULL && pNaluLength != NULL, STATUS_NULL_ARG);
 
@@ -90,34 +143,14 @@ STATUS getNextNaluLength(PBYTE nalus, UINT32 nalusLength, PUINT32 pStart, PUINT3
 
     CHK(offset < nalusLength && offset < 4 && offset >= 2 && nalus[offset] == 1, STATUS_RTP_INVALID_NALU);
     *pStart = ++offset;
-    pCurrent = nalus + offset;
 
     /* Not doing validation on number of consecutive zeros being less than 4 because some device can produce
-     * data with trailing zeros. */
-    while (offset < nalusLength) {
-        if (*pCurrent == 0) {
-            /* Maybe next byte is 1 */
-            offset++;
-            pCurrent++;
-
-        } else if (*pCurrent == 1) {
-            if (*(pCurrent - 1) == 0 && *(pCurrent - 2) == 0) {
-                zeroCount = *(pCurrent - 3) == 0 ? 3 : 2;
-                naluFound = TRUE;
-                break;
-            }
-
-            /* The jump is always 3 because of the 1 previously matched.
-             * All the 0's must be after this '1' matched at offset */
-            offset += 3;
-            pCurrent += 3;
-        } else {
-            /* Can jump 3 bytes forward */
-            offset += 3;
-            pCurrent += 3;
-        }
+     * data with trailing zeros. Only the zero directly in front of the next 0x000001 is taken as part of a 4 byte start code. */
+    nextStartCode = offset + findAnnexBStartCode(nalus + offset, nalusLength - offset);
+    if (nextStartCode < nalusLength && nextStartCode > offset && nalus[nextStartCode - 1] == 0) {
+        nextStartCode--;
     }
-    *pNaluLength = MIN(offset, nalusLength) - *pStart - (naluFound ? zeroCount : 0);
+    *pNaluLength = nextStartCode - offset;
 
 CleanUp:
 
@@ -224,6 +257,37 @@ CleanUp:
     return retStatus;
 }
 
+// Converts the aggregation units of a STAP-A/STAP-B packet to Annex-B, sizing and copying them in the same walk
+static STATUS depayH264AggregationPacket(PBYTE pRawPacket, UINT32 packetLength, UINT32 headerSize, PBYTE pNaluData, PUINT32 pNaluLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
+    UINT32 offset = headerSize;
+    UINT32 naluLength = 0;
+    UINT16 subNaluSize = 0;
+
+    // Both the size and the unit it announces have to be within the packet, it comes from the network
+    while (offset + SIZEOF(UINT16) <= packetLength) {
+        subNaluSize = getUnalignedInt16BigEndian(pRawPacket + offset);
+        offset += SIZEOF(UINT16);
+        CHK(offset + subNaluSize <= packetLength, STATUS_RTP_INVALID_NALU);
+        if (pNaluData != NULL) {
+            CHK(naluLength + SIZEOF(start4ByteCode) + subNaluSize <= *pNaluLength, STATUS_BUFFER_TOO_SMALL);
+            MEMCPY(pNaluData + naluLength, start4ByteCode, SIZEOF(start4ByteCode));
+            MEMCPY(pNaluData + naluLength + SIZEOF(start4ByteCode), pRawPacket + offset, subNaluSize);
+        }
+        naluLength += subNaluSize + SIZEOF(start4ByteCode);
+        offset += subNaluSize;
+    }
+
+    DLOGS("Aggregation packet len %d", naluLength);
+
+CleanUp:
+    *pNaluLength = naluLength;
+
+    return retStatus;
+}
+
 STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNaluData, PUINT32 pNaluLength, PBOOL pIsStart)
 {
     ENTERS();
@@ -236,9 +300,8 @@ STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
     BOOL isStartingPacket = FALSE;
     PBYTE pCurPtr = pRawPacket;
     static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
-    UINT16 subNaluSize = 0;
 
-    CHK(pRawPacket != NULL && pNaluLength != NULL, STATUS_NULL_ARG);
+    CHK(pRawPacket != NULL && (pNaluLength != NULL || sizeCalculationOnly), STATUS_NULL_ARG);
     CHK(packetLength > 0, retStatus);
 
     // TODO: Add support for Aggregate Packets https://tools.ietf.org/html/rfc6184#section-5.7
@@ -262,32 +325,21 @@ STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
             naluLength = packetLength - FU_A_HEADER_SIZE + 1;
             break;
         case STAP_A_INDICATOR:
-            pCurPtr += STAP_A_HEADER_SIZE;
-            do {
-                subNaluSize = getUnalignedInt16BigEndian(pCurPtr);
-                pCurPtr += SIZEOF(UINT16);
-                naluLength += subNaluSize + SIZEOF(start4ByteCode);
-                pCurPtr += subNaluSize;
-            } while (subNaluSize > 0 && pCurPtr < pRawPacket + packetLength);
-            isStartingPacket = TRUE;
-            break;
         case STAP_B_INDICATOR:
-            pCurPtr += STAP_B_HEADER_SIZE;
-            do {
-                subNaluSize = getUnalignedInt16BigEndian(pCurPtr);
-                pCurPtr += SIZEOF(UINT16);
-                naluLength += subNaluSize + SIZEOF(start4ByteCode);
-                pCurPtr += subNaluSize;
-            } while (subNaluSize > 0 && pCurPtr < pRawPacket + packetLength);
+            // Sized and, when a buffer is given, copied in a single walk over the aggregation units
             isStartingPacket = TRUE;
-            break;
+            CHK(pNaluLength != NULL, retStatus);
+            naluLength = sizeCalculationOnly ? 0 : *pNaluLength;
+            CHK_STATUS(depayH264AggregationPacket(pRawPacket, packetLength, indicator == STAP_A_INDICATOR ? STAP_A_HEADER_SIZE : STAP_B_HEADER_SIZE,
+                                                  pNaluData, &naluLength));
+            CHK(FALSE, retStatus);
         default:
             // Single NALU https://tools.ietf.org/html/rfc6184#section-5.6
             naluLength = packetLength;
             isStartingPacket = TRUE;
     }
 
-    if (isStartingPacket && indicator != STAP_A_INDICATOR && indicator != STAP_B_INDICATOR) {
+    if (isStartingPacket) {
         naluLength += SIZEOF(start4ByteCode);
     }
 
@@ -295,7 +347,7 @@ STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
     CHK(!sizeCalculationOnly, retStatus);
     CHK(naluLength <= *pNaluLength, STATUS_BUFFER_TOO_SMALL);
 
-    if (isStartingPacket && indicator != STAP_A_INDICATOR && indicator != STAP_B_INDICATOR) {
+    if (isStartingPacket) {
         MEMCPY(pNaluData, start4ByteCode, SIZEOF(start4ByteCode));
         naluLength -= SIZEOF(start4ByteCode);
         pNaluData += SIZEOF(start4ByteCode);
@@ -319,41 +371,11 @@ STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
                 MEMCPY(pNaluData, pRawPacket + FU_B_HEADER_SIZE, naluLength);
             }
             break;
-        case STAP_A_INDICATOR:
-            naluLength = 0;
-            pCurPtr = pRawPacket + STAP_A_HEADER_SIZE;
-            do {
-                subNaluSize = getUnalignedInt16BigEndian(pCurPtr);
-                pCurPtr += SIZEOF(UINT16);
-                MEMCPY(pNaluData, start4ByteCode, SIZEOF(start4ByteCode));
-                pNaluData += SIZEOF(start4ByteCode);
-                MEMCPY(pNaluData, pCurPtr, subNaluSize);
-                pCurPtr += subNaluSize;
-                pNaluData += subNaluSize;
-                naluLength += SIZEOF(start4ByteCode) + subNaluSize;
-            } while (subNaluSize > 0 && pCurPtr < pRawPacket + packetLength);
-            DLOGS("STAP_A_INDICATOR starting packet %d len %d", isStartingPacket, naluLength);
-            break;
-        case STAP_B_INDICATOR:
-            naluLength = 0;
-            pCurPtr = pRawPacket + STAP_A_HEADER_SIZE;
-            do {
-                subNaluSize = getUnalignedInt16BigEndian(pCurPtr);
-                pCurPtr += SIZEOF(UINT16);
-                MEMCPY(pNaluData, start4ByteCode, SIZEOF(start4ByteCode));
-                pNaluData += SIZEOF(start4ByteCode);
-                MEMCPY(pNaluData, pCurPtr, subNaluSize);
-                pCurPtr += subNaluSize;
-                pNaluData += subNaluSize;
-                naluLength += SIZEOF(start4ByteCode) + subNaluSize;
-            } while (subNaluSize > 0 && pCurPtr < pRawPacket + packetLength);
-            DLOGS("STAP_B_INDICATOR starting packet %d len %d", isStartingPacket, naluLength);
-            break;
         default:
             DLOGS("Single NALU %d len %d", isStartingPacket, packetLength);
             MEMCPY(pNaluData, pRawPacket, naluLength);
     }
-    if (isStartingPacket && indicator != STAP_A_INDICATOR && indicator != STAP_B_INDICATOR) {
+    if (isStartingPacket) {
         naluLength += SIZEOF(start4ByteCode);
     }
     DLOGS("Wrote naluLength %d isStartingPacket %d", naluLength, isStartingPacket);
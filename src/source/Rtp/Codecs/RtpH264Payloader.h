@@ -36,6 +36,7 @@ extern "C" {
  */
 
 STATUS createPayloadForH264(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+STATUS createPayloadArrayForH264(UINT32, PBYTE, UINT32, PPayloadArray);
 STATUS getNextNaluLength(PBYTE, UINT32, PUINT32, PUINT32);
 STATUS createPayloadFromNalu(UINT32, PBYTE, UINT32, PPayloadArray, PUINT32, PUINT32);
 STATUS depayH264FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
@@ -0,0 +1,250 @@
+#define LOG_CLASS "RtpH265Payloader"
+
+#include "../../Include_i.h"
+
+// Payload header of an aggregation packet: F bit is the OR of all units, LayerId and TID are the lowest of all units
+static VOID setH265AggregationHeader(PBYTE pPayloadHeader, BYTE forbiddenBit, UINT8 layerId, UINT8 tid)
+{
+    pPayloadHeader[0] = forbiddenBit | (H265_AP_INDICATOR << 1) | (layerId >> 5);
+    pPayloadHeader[1] = (BYTE) ((layerId << 3) | tid);
+}
+
+/*
+ * Small NALUs (VPS, SPS, PPS, SEI and small slices) are aggregated into AP packets while they fit the mtu, NALUs which fit
+ * the mtu by themselves are sent as single NAL unit packets and larger ones are split into FU packets.
+ * https://tools.ietf.org/html/rfc7798#section-4.4
+ */
+STATUS createPayloadArrayForH265(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE curPtrInNalus = nalus, pCurPtrInNalu, pPacket;
+    UINT32 remainNalusLength = nalusLength;
+    UINT32 nextNaluLength = 0, startIndex = 0, remainingNaluLength, curPayloadSize, maxFragmentCount;
+    UINT32 openPacketOffset = 0, openPacketNaluCount = 0, openPacketLength, firstNaluLength;
+    UINT8 naluType, layerId = 0, tid = 0;
+    BYTE forbiddenBit = 0;
+
+    CHK(nalus != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(mtu > H265_FU_HEADER_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+
+    do {
+        CHK_STATUS(getNextNaluLength(curPtrInNalus, remainNalusLength, &startIndex, &nextNaluLength));
+
+        curPtrInNalus += startIndex;
+
+        remainNalusLength -= startIndex;
+
+        CHK(remainNalusLength != 0, retStatus);
+        CHK(nextNaluLength >= H265_NALU_HEADER_SIZE, STATUS_RTP_INVALID_NALU);
+
+        if (nextNaluLength <= mtu) {
+            // Converting an open single NALU packet into an AP adds the payload header and two length fields
+            CHK_STATUS(payloadArrayReserve(pPayloadArray, nextNaluLength + H265_NALU_HEADER_SIZE + 2 * H265_AP_NALU_LENGTH_SIZE, 1));
+
+            if (openPacketNaluCount != 0) {
+                openPacketLength = pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize - 1];
+                if (openPacketNaluCount == 1) {
+                    openPacketLength += H265_NALU_HEADER_SIZE + H265_AP_NALU_LENGTH_SIZE;
+                }
+                if (openPacketLength + H265_AP_NALU_LENGTH_SIZE + nextNaluLength > mtu) {
+                    openPacketNaluCount = 0;
+                }
+            }
+
+            if (openPacketNaluCount == 0) {
+                // Single NAL unit packet https://tools.ietf.org/html/rfc7798#section-4.4.1, kept open for aggregation
+                openPacketOffset = pPayloadArray->payloadLength;
+                MEMCPY(pPayloadArray->payloadBuffer + openPacketOffset, curPtrInNalus, nextNaluLength);
+                pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize++] = nextNaluLength;
+                pPayloadArray->payloadLength += nextNaluLength;
+                forbiddenBit = curPtrInNalus[0] & H265_NALU_F_BIT;
+                layerId = H265_NALU_LAYER_ID(curPtrInNalus);
+                tid = H265_NALU_TID(curPtrInNalus);
+                openPacketNaluCount = 1;
+            } else {
+                // Aggregation packet https://tools.ietf.org/html/rfc7798#section-4.4.2
+                pPacket = pPayloadArray->payloadBuffer + openPacketOffset;
+                if (openPacketNaluCount == 1) {
+                    firstNaluLength = pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize - 1];
+                    MEMMOVE(pPacket + H265_NALU_HEADER_SIZE + H265_AP_NALU_LENGTH_SIZE, pPacket, firstNaluLength);
+                    putUnalignedInt16BigEndian(pPacket + H265_NALU_HEADER_SIZE, (UINT16) firstNaluLength);
+                    pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize - 1] += H265_NALU_HEADER_SIZE + H265_AP_NALU_LENGTH_SIZE;
+                    pPayloadArray->payloadLength += H265_NALU_HEADER_SIZE + H265_AP_NALU_LENGTH_SIZE;
+                }
+
+                putUnalignedInt16BigEndian(pPayloadArray->payloadBuffer + pPayloadArray->payloadLength, (UINT16) nextNaluLength);
+                MEMCPY(pPayloadArray->payloadBuffer + pPayloadArray->payloadLength + H265_AP_NALU_LENGTH_SIZE, curPtrInNalus, nextNaluLength);
+                pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize - 1] += H265_AP_NALU_LENGTH_SIZE + nextNaluLength;
+                pPayloadArray->payloadLength += H265_AP_NALU_LENGTH_SIZE + nextNaluLength;
+
+                forbiddenBit |= curPtrInNalus[0] & H265_NALU_F_BIT;
+                layerId = MIN(layerId, H265_NALU_LAYER_ID(curPtrInNalus));
+                tid = MIN(tid, H265_NALU_TID(curPtrInNalus));
+                setH265AggregationHeader(pPacket, forbiddenBit, layerId, tid);
+                openPacketNaluCount++;
+            }
+        } else {
+            // Fragmentation unit https://tools.ietf.org/html/rfc7798#section-4.4.3, the NALU header is carried by the payload and FU headers
+            openPacketNaluCount = 0;
+            naluType = H265_NALU_TYPE(curPtrInNalus[0]);
+            remainingNaluLength = nextNaluLength - H265_NALU_HEADER_SIZE;
+            pCurPtrInNalu = curPtrInNalus + H265_NALU_HEADER_SIZE;
+
+            maxFragmentCount = remainingNaluLength / (mtu - H265_FU_HEADER_SIZE) + 1;
+            CHK_STATUS(payloadArrayReserve(pPayloadArray, remainingNaluLength + maxFragmentCount * H265_FU_HEADER_SIZE, maxFragmentCount));
+
+            while (remainingNaluLength != 0) {
+                curPayloadSize = MIN(mtu - H265_FU_HEADER_SIZE, remainingNaluLength);
+                pPacket = pPayloadArray->payloadBuffer + pPayloadArray->payloadLength;
+
+                pPacket[0] = (curPtrInNalus[0] & 0x81) | (H265_FU_INDICATOR << 1);
+                pPacket[1] = curPtrInNalus[1];
+                pPacket[2] = naluType;
+                if (pCurPtrInNalu == curPtrInNalus + H265_NALU_HEADER_SIZE) {
+                    pPacket[2] |= H265_FU_START_BIT;
+                } else if (remainingNaluLength == curPayloadSize) {
+                    pPacket[2] |= H265_FU_END_BIT;
+                }
+                MEMCPY(pPacket + H265_FU_HEADER_SIZE, pCurPtrInNalu, curPayloadSize);
+
+                pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize++] = H265_FU_HEADER_SIZE + curPayloadSize;
+                pPayloadArray->payloadLength += H265_FU_HEADER_SIZE + curPayloadSize;
+
+                pCurPtrInNalu += curPayloadSize;
+                remainingNaluLength -= curPayloadSize;
+            }
+        }
+
+        remainNalusLength -= nextNaluLength;
+        curPtrInNalus += nextNaluLength;
+    } while (remainNalusLength != 0);
+
+CleanUp:
+    if (STATUS_FAILED(retStatus) && pPayloadArray != NULL) {
+        pPayloadArray->payloadLength = 0;
+        pPayloadArray->payloadSubLenSize = 0;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+// Converts the aggregation units of an AP packet to Annex-B, sizing and copying them in the same walk
+static STATUS depayH265AggregationPacket(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNaluData, PUINT32 pNaluLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
+    PBYTE pCurPtr = pRawPacket + H265_NALU_HEADER_SIZE, pEnd = pRawPacket + packetLength;
+    UINT32 naluLength = 0;
+    UINT16 subNaluSize = 0;
+
+    while (pCurPtr + H265_AP_NALU_LENGTH_SIZE <= pEnd) {
+        subNaluSize = getUnalignedInt16BigEndian(pCurPtr);
+        pCurPtr += H265_AP_NALU_LENGTH_SIZE;
+        CHK(subNaluSize <= pEnd - pCurPtr, STATUS_RTP_INVALID_NALU);
+        if (pNaluData != NULL) {
+            CHK(naluLength + SIZEOF(start4ByteCode) + subNaluSize <= *pNaluLength, STATUS_BUFFER_TOO_SMALL);
+            MEMCPY(pNaluData + naluLength, start4ByteCode, SIZEOF(start4ByteCode));
+            MEMCPY(pNaluData + naluLength + SIZEOF(start4ByteCode), pCurPtr, subNaluSize);
+        }
+        naluLength += subNaluSize + SIZEOF(start4ByteCode);
+        pCurPtr += subNaluSize;
+    }
+
+    DLOGS("Aggregation packet len %d", naluLength);
+
+CleanUp:
+    *pNaluLength = naluLength;
+
+    return retStatus;
+}
+
+STATUS depayH265FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNaluData, PUINT32 pNaluLength, PBOOL pIsStart)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 naluLength = 0;
+    UINT8 naluType = 0;
+    BOOL sizeCalculationOnly = (pNaluData == NULL);
+    BOOL isStartingPacket = FALSE;
+    static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
+
+    CHK(pRawPacket != NULL && (pNaluLength != NULL || sizeCalculationOnly), STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+    CHK(packetLength >= H265_NALU_HEADER_SIZE, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+
+    naluType = H265_NALU_TYPE(pRawPacket[0]);
+    switch (naluType) {
+        case H265_FU_INDICATOR:
+            CHK(packetLength > H265_FU_HEADER_SIZE, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+            isStartingPacket = (pRawPacket[2] & H265_FU_START_BIT) != 0;
+            naluLength = packetLength - H265_FU_HEADER_SIZE;
+            if (isStartingPacket) {
+                // The NALU header is rebuilt from the payload header and the FU type
+                naluLength += H265_NALU_HEADER_SIZE;
+            }
+            break;
+        case H265_AP_INDICATOR:
+            isStartingPacket = TRUE;
+            CHK(pNaluLength != NULL, retStatus);
+            naluLength = sizeCalculationOnly ? 0 : *pNaluLength;
+            CHK_STATUS(depayH265AggregationPacket(pRawPacket, packetLength, pNaluData, &naluLength));
+            CHK(FALSE, retStatus);
+        case H265_PACI_INDICATOR:
+            // PACI is never negotiated, skip the packet without failing the frame
+            DLOGW("Dropping unsupported H265 PACI packet");
+            CHK(FALSE, retStatus);
+        default:
+            // Single NAL unit packet
+            naluLength = packetLength;
+            isStartingPacket = TRUE;
+    }
+
+    if (isStartingPacket) {
+        naluLength += SIZEOF(start4ByteCode);
+    }
+
+    // Only return size if given buffer is NULL
+    CHK(!sizeCalculationOnly, retStatus);
+    CHK(naluLength <= *pNaluLength, STATUS_BUFFER_TOO_SMALL);
+
+    if (isStartingPacket) {
+        MEMCPY(pNaluData, start4ByteCode, SIZEOF(start4ByteCode));
+        pNaluData += SIZEOF(start4ByteCode);
+    }
+
+    if (naluType == H265_FU_INDICATOR) {
+        DLOGS("H265 FU starting packet %d len %d", isStartingPacket, naluLength);
+        if (isStartingPacket) {
+            pNaluData[0] = (pRawPacket[0] & 0x81) | ((pRawPacket[2] & H265_FU_TYPE_MASK) << 1);
+            pNaluData[1] = pRawPacket[1];
+            pNaluData += H265_NALU_HEADER_SIZE;
+        }
+        MEMCPY(pNaluData, pRawPacket + H265_FU_HEADER_SIZE, packetLength - H265_FU_HEADER_SIZE);
+    } else {
+        DLOGS("H265 single NALU len %d", packetLength);
+        MEMCPY(pNaluData, pRawPacket, packetLength);
+    }
+
+    DLOGS("Wrote naluLength %d isStartingPacket %d", naluLength, isStartingPacket);
+
+CleanUp:
+    if (STATUS_FAILED(retStatus) && sizeCalculationOnly) {
+        naluLength = 0;
+    }
+
+    if (pNaluLength != NULL) {
+        *pNaluLength = naluLength;
+    }
+
+    if (pIsStart != NULL) {
+        *pIsStart = isStartingPacket;
+    }
+
+    LEAVES();
+    return retStatus;
+}
@@ -0,0 +1,62 @@
+/*******************************************
+H265 RTP Payloader include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_RTPH265PAYLOADER_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_RTPH265PAYLOADER_H
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define H265_NALU_HEADER_SIZE    2
+#define H265_FU_HEADER_SIZE      3
+#define H265_AP_NALU_LENGTH_SIZE 2
+#define H265_AP_INDICATOR        48
+#define H265_FU_INDICATOR        49
+#define H265_PACI_INDICATOR      50
+
+/*
+ * H265 NAL unit header https://tools.ietf.org/html/rfc7798#section-1.1.4
+ *
+ *  +---------------+---------------+
+ *  |0|1|2|3|4|5|6|7|0|1|2|3|4|5|6|7|
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *  |F|   Type    |  LayerId  | TID |
+ *  +-------------+-----------------+
+ */
+#define H265_NALU_TYPE(b)      (((b) >> 1) & 0x3F)
+#define H265_NALU_F_BIT        0x80
+#define H265_NALU_LAYER_ID(h)  ((UINT8) ((((h)[0] & 0x01) << 5) | ((h)[1] >> 3)))
+#define H265_NALU_TID(h)       ((UINT8) ((h)[1] & 0x07))
+#define H265_FU_START_BIT      0x80
+#define H265_FU_END_BIT        0x40
+#define H265_FU_TYPE_MASK      0x3F
+
+/*
+ * Fragmentation unit https://tools.ietf.org/html/rfc7798#section-4.4.3
+ *
+ *   0                   1                   2                   3
+ *   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *  |    PayloadHdr (Type=49)       |   FU header   | DONL (cond)   |
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-|
+ *  | DONL (cond)   |                                               |
+ *  |-+-+-+-+-+-+-+-+                                               |
+ *  |                         FU payload                            |
+ *  |                                                               |
+ *  |                               +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *  |                               :...OPTIONAL RTP padding        |
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *
+ * DONL fields are only present when sprop-max-don-diff is greater than 0, which is never negotiated by this library.
+ */
+
+STATUS createPayloadArrayForH265(UINT32, PBYTE, UINT32, PPayloadArray);
+STATUS depayH265FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_RTPH265PAYLOADER_H
@@ -5,12 +5,12 @@
 STATUS createPayloadForOpus(UINT32 mtu, PBYTE opusFrame, UINT32 opusFrameLength, PBYTE payloadBuffer, PUINT32 pPayloadLength,
                             PUINT32 pPayloadSubLength, PUINT32 pPayloadSubLenSize)
 {
-    UNUSED_PARAM(mtu);
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     UINT32 payloadLength = 0;
     UINT32 payloadSubLenSize = 0;
     BOOL sizeCalculationOnly = (payloadBuffer == NULL);
+    PayloadArray payloadArray;
 
     CHK(opusFrame != NULL && pPayloadSubLenSize != NULL && pPayloadLength != NULL && (sizeCalculationOnly || pPayloadSubLength != NULL),
         STATUS_NULL_ARG);
@@ -22,8 +22,13 @@ STATUS createPayloadForOpus(UINT32 mtu, PBYTE opusFrame, UINT32 opusFrameLength,
     CHK(!sizeCalculationOnly, retStatus);
     CHK(payloadLength <= *pPayloadLength && payloadSubLenSize <= *pPayloadSubLenSize, STATUS_BUFFER_TOO_SMALL);
 
-    MEMCPY(payloadBuffer, opusFrame, opusFrameLength);
-    pPayloadSubLength[0] = opusFrameLength;
+    // Capacity is checked above so the single pass payloader never needs to grow the caller's buffers
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    payloadArray.payloadBuffer = payloadBuffer;
+    payloadArray.maxPayloadLength = *pPayloadLength;
+    payloadArray.payloadSubLength = pPayloadSubLength;
+    payloadArray.maxPayloadSubLenSize = *pPayloadSubLenSize;
+    CHK_STATUS(createPayloadArrayForOpus(mtu, opusFrame, opusFrameLength, &payloadArray));
 
 CleanUp:
     if (STATUS_FAILED(retStatus) && sizeCalculationOnly) {
@@ -40,6 +45,29 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createPayloadArrayForOpus(UINT32 mtu, PBYTE opusFrame, UINT32 opusFrameLength, PPayloadArray pPayloadArray)
+{
+    UNUSED_PARAM(mtu);
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(opusFrame != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+    CHK_STATUS(payloadArrayReserve(pPayloadArray, opusFrameLength, 1));
+
+    MEMCPY(pPayloadArray->payloadBuffer, opusFrame, opusFrameLength);
+    pPayloadArray->payloadSubLength[0] = opusFrameLength;
+    pPayloadArray->payloadLength = opusFrameLength;
+    pPayloadArray->payloadSubLenSize = 1;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS depayOpusFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pOpusData, PUINT32 pOpusLength, PBOOL pIsStart)
 {
     ENTERS();
@@ -47,7 +75,7 @@ STATUS depayOpusFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pOpu
     UINT32 opusLength = 0;
     BOOL sizeCalculationOnly = (pOpusData == NULL);
 
-    CHK(pRawPacket != NULL && pOpusLength != NULL, STATUS_NULL_ARG);
+    CHK(pRawPacket != NULL && (pOpusLength != NULL || sizeCalculationOnly), STATUS_NULL_ARG);
     CHK(packetLength > 0, retStatus);
 
     opusLength = packetLength;
@@ -11,6 +11,7 @@ extern "C" {
 #endif
 
 STATUS createPayloadForOpus(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+STATUS createPayloadArrayForOpus(UINT32, PBYTE, UINT32, PPayloadArray);
 STATUS depayOpusFromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
 
 #ifdef __cplusplus
@@ -0,0 +1,248 @@
+#define LOG_CLASS "RtpRedPayloader"
+
+#include "../../Include_i.h"
+
+STATUS createRedEncoder(UINT32 depth, PRedEncoder* ppRedEncoder)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRedEncoder pRedEncoder = NULL;
+
+    CHK(ppRedEncoder != NULL, STATUS_NULL_ARG);
+    CHK(depth > 0 && depth <= RED_MAX_REDUNDANCY_DEPTH, STATUS_INVALID_ARG);
+
+    CHK(NULL != (pRedEncoder = (PRedEncoder) MEMCALLOC(1, SIZEOF(RedEncoder))), STATUS_NOT_ENOUGH_MEMORY);
+    pRedEncoder->depth = depth;
+
+CleanUp:
+
+    if (ppRedEncoder != NULL) {
+        *ppRedEncoder = pRedEncoder;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeRedEncoder(PRedEncoder* ppRedEncoder)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRedEncoder pRedEncoder = NULL;
+    UINT32 i;
+
+    CHK(ppRedEncoder != NULL, STATUS_NULL_ARG);
+    pRedEncoder = *ppRedEncoder;
+    // free is idempotent
+    CHK(pRedEncoder != NULL, retStatus);
+
+    for (i = 0; i < RED_MAX_REDUNDANCY_DEPTH; i++) {
+        SAFE_MEMFREE(pRedEncoder->history[i].pData);
+    }
+    SAFE_MEMFREE(pRedEncoder);
+
+    *ppRedEncoder = NULL;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS redEncoderWrapPayloadArray(PRedEncoder pRedEncoder, UINT8 primaryPayloadType, UINT32 timestamp, UINT32 mtu, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, redundantCount = 0, headerLength = RED_PRIMARY_HEADER_SIZE, redundantLength = 0, primaryLength, timestampOffset, index;
+    PRedHistoryEntry pEntry;
+    PBYTE pCurPtr, pData = NULL;
+
+    CHK(pRedEncoder != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(pPayloadArray->payloadSubLenSize == 1, STATUS_INVALID_ARG);
+
+    primaryLength = pPayloadArray->payloadLength;
+
+    // Walk back from the newest encoding and stop at the first one that can't be carried, the ones repeated have to be contiguous
+    for (i = 1; i <= pRedEncoder->historyCount; i++) {
+        pEntry = &pRedEncoder->history[(pRedEncoder->nextHistoryIndex + RED_MAX_REDUNDANCY_DEPTH - i) % RED_MAX_REDUNDANCY_DEPTH];
+        timestampOffset = timestamp - pEntry->timestamp;
+        if (timestampOffset == 0 || timestampOffset > RED_TIMESTAMP_OFFSET_MAX || pEntry->length > RED_BLOCK_LENGTH_MAX ||
+            headerLength + RED_BLOCK_HEADER_SIZE + redundantLength + pEntry->length + primaryLength > mtu) {
+            break;
+        }
+        headerLength += RED_BLOCK_HEADER_SIZE;
+        redundantLength += pEntry->length;
+        redundantCount++;
+    }
+
+    CHK_STATUS(payloadArrayReserve(pPayloadArray, headerLength + redundantLength, 0));
+    MEMMOVE(pPayloadArray->payloadBuffer + headerLength + redundantLength, pPayloadArray->payloadBuffer, primaryLength);
+
+    pCurPtr = pPayloadArray->payloadBuffer;
+    pData = pPayloadArray->payloadBuffer + headerLength;
+    for (i = redundantCount; i > 0; i--) {
+        pEntry = &pRedEncoder->history[(pRedEncoder->nextHistoryIndex + RED_MAX_REDUNDANCY_DEPTH - i) % RED_MAX_REDUNDANCY_DEPTH];
+        timestampOffset = timestamp - pEntry->timestamp;
+        putUnalignedInt32BigEndian(pCurPtr,
+                                   ((UINT32) (RED_HEADER_F | (primaryPayloadType & RED_PAYLOAD_TYPE_MASK)) << 24) |
+                                       (timestampOffset << RED_BLOCK_LENGTH_BITS) | pEntry->length);
+        pCurPtr += RED_BLOCK_HEADER_SIZE;
+
+        if (pEntry->length > 0) {
+            MEMCPY(pData, pEntry->pData, pEntry->length);
+            pData += pEntry->length;
+        }
+    }
+    *pCurPtr = primaryPayloadType & RED_PAYLOAD_TYPE_MASK;
+
+    pPayloadArray->payloadLength = headerLength + redundantLength + primaryLength;
+    pPayloadArray->payloadSubLength[0] = pPayloadArray->payloadLength;
+
+    // Remember the primary encoding for the next packets
+    index = pRedEncoder->nextHistoryIndex;
+    pEntry = &pRedEncoder->history[index];
+    if (primaryLength > pEntry->capacity) {
+        CHK(NULL != (pCurPtr = (PBYTE) MEMREALLOC(pEntry->pData, primaryLength)), STATUS_NOT_ENOUGH_MEMORY);
+        pEntry->pData = pCurPtr;
+        pEntry->capacity = primaryLength;
+    }
+    if (primaryLength > 0) {
+        MEMCPY(pEntry->pData, pData, primaryLength);
+    }
+    pEntry->length = primaryLength;
+    pEntry->timestamp = timestamp;
+    pRedEncoder->nextHistoryIndex = (index + 1) % RED_MAX_REDUNDANCY_DEPTH;
+    pRedEncoder->historyCount = MIN(pRedEncoder->historyCount + 1, pRedEncoder->depth);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS parseRedPayload(PBYTE pPayload, UINT32 payloadLength, PRedBlock pBlocks, PUINT32 pBlockCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, offset = 0, blockCount = 0, value;
+    PRedBlock pBlock;
+
+    CHK(pPayload != NULL && pBlocks != NULL && pBlockCount != NULL, STATUS_NULL_ARG);
+    CHK(*pBlockCount > 0, STATUS_INVALID_ARG);
+
+    // Block headers, the primary one comes last and has F cleared
+    while (TRUE) {
+        CHK(offset < payloadLength && blockCount < *pBlockCount, STATUS_RTP_INVALID_RED_PAYLOAD);
+        pBlock = &pBlocks[blockCount++];
+        pBlock->payloadType = pPayload[offset] & RED_PAYLOAD_TYPE_MASK;
+        if ((pPayload[offset] & RED_HEADER_F) == 0) {
+            pBlock->timestampOffset = 0;
+            offset += RED_PRIMARY_HEADER_SIZE;
+            break;
+        }
+
+        CHK(offset + RED_BLOCK_HEADER_SIZE <= payloadLength, STATUS_RTP_INVALID_RED_PAYLOAD);
+        value = (UINT32) getUnalignedInt32BigEndian(pPayload + offset);
+        pBlock->timestampOffset = (UINT16) ((value >> RED_BLOCK_LENGTH_BITS) & RED_TIMESTAMP_OFFSET_MAX);
+        pBlock->length = value & RED_BLOCK_LENGTH_MAX;
+        offset += RED_BLOCK_HEADER_SIZE;
+    }
+
+    for (i = 0; i < blockCount - 1; i++) {
+        CHK(pBlocks[i].length <= payloadLength - offset, STATUS_RTP_INVALID_RED_PAYLOAD);
+        pBlocks[i].pData = pPayload + offset;
+        offset += pBlocks[i].length;
+    }
+    pBlocks[blockCount - 1].pData = pPayload + offset;
+    pBlocks[blockCount - 1].length = payloadLength - offset;
+
+    *pBlockCount = blockCount;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS redDecoderUpdate(PRedDecoder pRedDecoder, UINT16 sequenceNumber, UINT32 timestamp)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pRedDecoder != NULL, STATUS_NULL_ARG);
+
+    if (pRedDecoder->started) {
+        // Reordered packets are older than the last one and teach nothing
+        CHK((INT16) (sequenceNumber - pRedDecoder->lastSequenceNumber) > 0, retStatus);
+        // Only back to back packets give the step, a gap could hide packets of other durations or a pause in the stream
+        if (sequenceNumber == (UINT16) (pRedDecoder->lastSequenceNumber + 1) && (INT32) (timestamp - pRedDecoder->lastTimestamp) > 0) {
+            pRedDecoder->timestampStep = timestamp - pRedDecoder->lastTimestamp;
+        }
+    }
+
+    pRedDecoder->started = TRUE;
+    pRedDecoder->lastSequenceNumber = sequenceNumber;
+    pRedDecoder->lastTimestamp = timestamp;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS redDecoderGetBlockSequenceNumber(PRedDecoder pRedDecoder, UINT16 sequenceNumber, PRedBlock pRedBlock, PUINT16 pBlockSequenceNumber,
+                                        PBOOL pPlaced)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL placed = FALSE;
+
+    CHK(pRedDecoder != NULL && pRedBlock != NULL && pBlockSequenceNumber != NULL && pPlaced != NULL, STATUS_NULL_ARG);
+    CHK(pRedDecoder->timestampStep != 0 && pRedBlock->timestampOffset != 0, retStatus);
+    CHK(pRedBlock->timestampOffset % pRedDecoder->timestampStep == 0, retStatus);
+
+    *pBlockSequenceNumber = (UINT16) (sequenceNumber - pRedBlock->timestampOffset / pRedDecoder->timestampStep);
+    placed = TRUE;
+
+CleanUp:
+
+    if (pPlaced != NULL) {
+        *pPlaced = placed;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS createRtpPacketFromRedBlock(PRtpPacket pRedPacket, PRedBlock pRedBlock, UINT16 sequenceNumber, PRtpPacket* ppRtpPacket)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacket pRtpPacket = NULL;
+
+    CHK(pRedPacket != NULL && pRedBlock != NULL && ppRtpPacket != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(createRtpPacket(pRedPacket->header.version, FALSE, FALSE, 0, FALSE, pRedBlock->payloadType, sequenceNumber,
+                               pRedPacket->header.timestamp - pRedBlock->timestampOffset, pRedPacket->header.ssrc, NULL, 0, 0, NULL, pRedBlock->pData,
+                               pRedBlock->length, &pRtpPacket));
+
+    // The packet outlives the RED packet, so it gets its own copy of the encoding
+    CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, NULL, &pRtpPacket->rawPacketLength));
+    CHK(NULL != (pRtpPacket->pRawPacket = (PBYTE) MEMALLOC(pRtpPacket->rawPacketLength)), STATUS_NOT_ENOUGH_MEMORY);
+    CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, pRtpPacket->pRawPacket, &pRtpPacket->rawPacketLength));
+    pRtpPacket->payload = pRtpPacket->pRawPacket + RTP_HEADER_LEN(pRtpPacket);
+    pRtpPacket->receivedTime = pRedPacket->receivedTime;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freeRtpPacket(&pRtpPacket);
+    }
+
+    if (ppRtpPacket != NULL) {
+        *ppRtpPacket = pRtpPacket;
+    }
+
+    LEAVES();
+    return retStatus;
+}
@@ -0,0 +1,104 @@
+/*******************************************
+RED RTP Payloader include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_RTPREDPAYLOADER_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_RTPREDPAYLOADER_H
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Redundant audio data https://www.rfc-editor.org/rfc/rfc2198#section-3
+ * Every redundant encoding has a 4 byte header, the primary encoding a single byte one with F cleared. The encodings follow
+ * the headers in the same order, oldest first.
+ *
+ *  0                   1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |F|   block PT  |  timestamp offset         |   block length    |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |0|   block PT  |
+ * +-+-+-+-+-+-+-+-+
+ */
+#define RED_BLOCK_HEADER_SIZE    4
+#define RED_PRIMARY_HEADER_SIZE  1
+#define RED_HEADER_F             0x80
+#define RED_PAYLOAD_TYPE_MASK    0x7F
+#define RED_TIMESTAMP_OFFSET_MAX 0x3FFF
+#define RED_BLOCK_LENGTH_MAX     0x3FF
+#define RED_BLOCK_LENGTH_BITS    10
+
+// Encodings of earlier packets a RED packet we send can repeat, libwebrtc sends a single one
+#define RED_MAX_REDUNDANCY_DEPTH 4
+// Blocks, the primary encoding included, accepted in a received RED packet
+#define RED_MAX_BLOCKS 16
+
+typedef struct {
+    UINT32 timestamp;
+    PBYTE pData;
+    UINT32 length;
+    UINT32 capacity;
+} RedHistoryEntry, *PRedHistoryEntry;
+
+typedef struct {
+    UINT32 depth;
+    // Ring of the last depth primary encodings, nextHistoryIndex is where the next one goes
+    RedHistoryEntry history[RED_MAX_REDUNDANCY_DEPTH];
+    UINT32 historyCount;
+    UINT32 nextHistoryIndex;
+} RedEncoder, *PRedEncoder;
+
+typedef struct {
+    UINT8 payloadType;
+    UINT16 timestampOffset;
+    PBYTE pData;
+    UINT32 length;
+} RedBlock, *PRedBlock;
+
+// Receive side state, the sequence number of a redundant encoding is its timestamp offset in steps between consecutive packets
+typedef struct {
+    BOOL started;
+    UINT16 lastSequenceNumber;
+    UINT32 lastTimestamp;
+    // 0 until two consecutive RED packets came in
+    UINT32 timestampStep;
+} RedDecoder, *PRedDecoder;
+
+STATUS createRedEncoder(UINT32, PRedEncoder*);
+STATUS freeRedEncoder(PRedEncoder*);
+
+/**
+ * Turns the single packet payload array of an audio frame into a RED payload in place and remembers the frame for the
+ * following packets. Only the encodings of the packets sent right before this one are repeated, starting with the newest.
+ */
+STATUS redEncoderWrapPayloadArray(PRedEncoder, UINT8, UINT32, UINT32, PPayloadArray);
+
+/**
+ * Splits a RED payload into at most *pBlockCount blocks, the primary encoding being the last one. The blocks point into
+ * the payload.
+ */
+STATUS parseRedPayload(PBYTE, UINT32, PRedBlock, PUINT32);
+
+/**
+ * Learns the timestamp step between packets from the sequence number and timestamp of a RED packet
+ */
+STATUS redDecoderUpdate(PRedDecoder, UINT16, UINT32);
+
+/**
+ * Works out the sequence number of a redundant block from the RED packet's sequence number and the block's timestamp offset.
+ * *pPlaced is cleared when the step is not known yet or the offset isn't a whole number of steps.
+ */
+STATUS redDecoderGetBlockSequenceNumber(PRedDecoder, UINT16, PRedBlock, PUINT16, PBOOL);
+
+/**
+ * Builds a packet for a redundant encoding found in a RED packet, with its own copy of the encoding
+ */
+STATUS createRtpPacketFromRedBlock(PRtpPacket, PRedBlock, UINT16, PRtpPacket*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_RTPREDPAYLOADER_H
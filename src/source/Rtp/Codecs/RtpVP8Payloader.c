@@ -9,43 +9,75 @@ STATUS createPayloadForVP8(UINT32 mtu, PBYTE pData, UINT32 dataLen, PBYTE payloa
     STATUS retStatus = STATUS_SUCCESS;
     BOOL sizeCalculationOnly = (payloadBuffer == NULL);
     PayloadArray payloadArray;
-    UINT32 payloadRemaining = dataLen, payloadLenConsumed = 0;
-    PBYTE currentData = pData;
+    UINT32 payloadLength = 0, payloadSubLenSize = 0;
 
     CHK(pData != NULL && pPayloadSubLenSize != NULL && pPayloadLength != NULL && (sizeCalculationOnly || pPayloadSubLength != NULL), STATUS_NULL_ARG);
+    CHK(mtu > VP8_PAYLOAD_DESCRIPTOR_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
 
-    MEMSET(&payloadArray, 0, SIZEOF(payloadArray));
+    // Every packet carries at most mtu - VP8_PAYLOAD_DESCRIPTOR_SIZE bytes of the frame after its payload descriptor
+    payloadSubLenSize = dataLen / (mtu - VP8_PAYLOAD_DESCRIPTOR_SIZE) + (dataLen % (mtu - VP8_PAYLOAD_DESCRIPTOR_SIZE) == 0 ? 0 : 1);
+    payloadLength = dataLen + payloadSubLenSize * VP8_PAYLOAD_DESCRIPTOR_SIZE;
+
+    // Only return size if given buffer is NULL
+    CHK(!sizeCalculationOnly, retStatus);
+    CHK(payloadLength <= *pPayloadLength && payloadSubLenSize <= *pPayloadSubLenSize, STATUS_BUFFER_TOO_SMALL);
+
+    // Capacity is checked above so the single pass payloader never needs to grow the caller's buffers
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
     payloadArray.payloadBuffer = payloadBuffer;
+    payloadArray.maxPayloadLength = *pPayloadLength;
+    payloadArray.payloadSubLength = pPayloadSubLength;
+    payloadArray.maxPayloadSubLenSize = *pPayloadSubLenSize;
+    CHK_STATUS(createPayloadArrayForVP8(mtu, pData, dataLen, &payloadArray));
+
+CleanUp:
+    if (STATUS_FAILED(retStatus) && sizeCalculationOnly) {
+        payloadLength = 0;
+        payloadSubLenSize = 0;
+    }
+
+    if (pPayloadSubLenSize != NULL && pPayloadLength != NULL) {
+        *pPayloadLength = payloadLength;
+        *pPayloadSubLenSize = payloadSubLenSize;
+    }
+
+    LEAVES();
+    return retStatus;
+}
 
+STATUS createPayloadArrayForVP8(UINT32 mtu, PBYTE pData, UINT32 dataLen, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 payloadRemaining = dataLen, payloadLenConsumed = 0, payloadSubLenSize;
+    PBYTE currentData = pData, pCurPtrInPayload;
+
+    CHK(pData != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(mtu > VP8_PAYLOAD_DESCRIPTOR_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    payloadSubLenSize = dataLen / (mtu - VP8_PAYLOAD_DESCRIPTOR_SIZE) + (dataLen % (mtu - VP8_PAYLOAD_DESCRIPTOR_SIZE) == 0 ? 0 : 1);
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+    CHK_STATUS(payloadArrayReserve(pPayloadArray, dataLen + payloadSubLenSize * VP8_PAYLOAD_DESCRIPTOR_SIZE, payloadSubLenSize));
+
+    pCurPtrInPayload = pPayloadArray->payloadBuffer;
     while (payloadRemaining > 0) {
         payloadLenConsumed = MIN(mtu - VP8_PAYLOAD_DESCRIPTOR_SIZE, payloadRemaining);
-        payloadArray.payloadLength += (payloadLenConsumed + VP8_PAYLOAD_DESCRIPTOR_SIZE);
 
-        if (!sizeCalculationOnly) {
-            *payloadArray.payloadBuffer = payloadArray.payloadSubLenSize == 0 ? VP8_PAYLOAD_DESCRIPTOR_START_OF_PARTITION_VALUE : 0;
-            payloadArray.payloadBuffer++;
+        *pCurPtrInPayload = pPayloadArray->payloadSubLenSize == 0 ? VP8_PAYLOAD_DESCRIPTOR_START_OF_PARTITION_VALUE : 0;
+        pCurPtrInPayload++;
 
-            MEMCPY(payloadArray.payloadBuffer, currentData, payloadLenConsumed);
+        MEMCPY(pCurPtrInPayload, currentData, payloadLenConsumed);
+        pCurPtrInPayload += payloadLenConsumed;
+        currentData += payloadLenConsumed;
 
-            pPayloadSubLength[payloadArray.payloadSubLenSize] = (payloadLenConsumed + VP8_PAYLOAD_DESCRIPTOR_SIZE);
-            payloadArray.payloadBuffer += payloadLenConsumed;
-            currentData += payloadLenConsumed;
-        }
-
-        payloadArray.payloadSubLenSize++;
+        pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize] = payloadLenConsumed + VP8_PAYLOAD_DESCRIPTOR_SIZE;
+        pPayloadArray->payloadLength += payloadLenConsumed + VP8_PAYLOAD_DESCRIPTOR_SIZE;
+        pPayloadArray->payloadSubLenSize++;
         payloadRemaining -= payloadLenConsumed;
     }
 
 CleanUp:
-    if (STATUS_FAILED(retStatus) && sizeCalculationOnly) {
-        payloadArray.payloadLength = 0;
-        payloadArray.payloadSubLenSize = 0;
-    }
-
-    if (pPayloadSubLenSize != NULL && pPayloadLength != NULL) {
-        *pPayloadLength = payloadArray.payloadLength;
-        *pPayloadSubLenSize = payloadArray.payloadSubLenSize;
-    }
 
     LEAVES();
     return retStatus;
@@ -63,8 +95,10 @@ STATUS depayVP8FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pVp8D
     BOOL haveTID = FALSE;
     BOOL haveKEYIDX = FALSE;
 
-    CHK(pRawPacket != NULL && pVp8Length != NULL, STATUS_NULL_ARG);
+    CHK(pRawPacket != NULL && (pVp8Length != NULL || sizeCalculationOnly), STATUS_NULL_ARG);
     CHK(packetLength > 0, retStatus);
+    // Every packet is a start, the descriptor only matters when sizing or copying
+    CHK(pVp8Length != NULL, retStatus);
 
     haveExtendedControlBits = (pRawPacket[payloadDescriptorLength] & 0x80) >> 7;
     payloadDescriptorLength++;
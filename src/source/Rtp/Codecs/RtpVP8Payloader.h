@@ -14,6 +14,7 @@ extern "C" {
 #define VP8_PAYLOAD_DESCRIPTOR_START_OF_PARTITION_VALUE 0X10
 
 STATUS createPayloadForVP8(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+STATUS createPayloadArrayForVP8(UINT32, PBYTE, UINT32, PPayloadArray);
 STATUS depayVP8FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
 
 #ifdef __cplusplus
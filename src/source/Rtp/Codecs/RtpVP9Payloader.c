@@ -0,0 +1,495 @@
+#define LOG_CLASS "RtpVP9Payloader"
+
+#include "../../Include_i.h"
+
+#define VP9_READ_BIT(p, bit) (((p)[(bit) / 8] >> (7 - (bit) % 8)) & 1)
+
+static STATUS validateVp9PayloadDescriptor(PVp9PayloadDescriptor pDescriptor)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PVp9ScalabilityStructure pStructure = pDescriptor->pScalabilityStructure;
+    UINT32 i, j;
+
+    CHK(!pDescriptor->pictureIdPresent || pDescriptor->pictureId <= VP9_MAX_PICTURE_ID, STATUS_INVALID_ARG);
+    CHK(!pDescriptor->layerIndicesPresent ||
+            (pDescriptor->temporalId < VP9_MAX_TEMPORAL_LAYERS && pDescriptor->spatialId < VP9_MAX_SPATIAL_LAYERS),
+        STATUS_INVALID_ARG);
+
+    if (pDescriptor->flexibleMode && pDescriptor->interPicturePredicted) {
+        CHK(pDescriptor->referenceCount > 0 && pDescriptor->referenceCount <= VP9_MAX_REFERENCE_PICTURES, STATUS_INVALID_ARG);
+        for (i = 0; i < pDescriptor->referenceCount; i++) {
+            CHK(pDescriptor->pDiffs[i] > 0 && pDescriptor->pDiffs[i] <= VP9_MAX_P_DIFF, STATUS_INVALID_ARG);
+        }
+    }
+
+    if (pDescriptor->scalabilityStructurePresent) {
+        CHK(pStructure != NULL, STATUS_NULL_ARG);
+        CHK(pStructure->spatialLayerCount > 0 && pStructure->spatialLayerCount <= VP9_MAX_SPATIAL_LAYERS, STATUS_INVALID_ARG);
+        for (i = 0; pStructure->pictureGroupPresent && i < pStructure->pictureGroupSize; i++) {
+            CHK(pStructure->pictureGroup[i].temporalId < VP9_MAX_TEMPORAL_LAYERS &&
+                    pStructure->pictureGroup[i].referenceCount <= VP9_MAX_REFERENCE_PICTURES,
+                STATUS_INVALID_ARG);
+            for (j = 0; j < pStructure->pictureGroup[i].referenceCount; j++) {
+                CHK(pStructure->pictureGroup[i].pDiffs[j] > 0, STATUS_INVALID_ARG);
+            }
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+static UINT32 vp9PayloadDescriptorSize(PVp9PayloadDescriptor pDescriptor, BOOL withScalabilityStructure)
+{
+    PVp9ScalabilityStructure pStructure = pDescriptor->pScalabilityStructure;
+    UINT32 size = 1, i;
+
+    if (pDescriptor->pictureIdPresent) {
+        size += 2;
+    }
+
+    if (pDescriptor->layerIndicesPresent) {
+        size += pDescriptor->flexibleMode ? 1 : 2;
+    }
+
+    if (pDescriptor->flexibleMode && pDescriptor->interPicturePredicted) {
+        size += pDescriptor->referenceCount;
+    }
+
+    if (withScalabilityStructure && pDescriptor->scalabilityStructurePresent) {
+        size++;
+        if (pStructure->resolutionsPresent) {
+            size += pStructure->spatialLayerCount * 2 * SIZEOF(UINT16);
+        }
+        if (pStructure->pictureGroupPresent) {
+            size++;
+            for (i = 0; i < pStructure->pictureGroupSize; i++) {
+                size += 1 + pStructure->pictureGroup[i].referenceCount;
+            }
+        }
+    }
+
+    return size;
+}
+
+// pBuffer must hold vp9PayloadDescriptorSize bytes, the scalability structure is only written to the first packet
+static PBYTE writeVp9PayloadDescriptor(PVp9PayloadDescriptor pDescriptor, BOOL firstPacket, BOOL lastPacket, PBYTE pBuffer)
+{
+    PVp9ScalabilityStructure pStructure = pDescriptor->pScalabilityStructure;
+    BOOL withScalabilityStructure = firstPacket && pDescriptor->scalabilityStructurePresent;
+    PBYTE pCurPtr = pBuffer;
+    PVp9PictureGroupEntry pEntry;
+    UINT32 i, j;
+
+    *pCurPtr++ = (pDescriptor->pictureIdPresent ? VP9_PAYLOAD_DESCRIPTOR_I : 0) |
+        (pDescriptor->interPicturePredicted ? VP9_PAYLOAD_DESCRIPTOR_P : 0) | (pDescriptor->layerIndicesPresent ? VP9_PAYLOAD_DESCRIPTOR_L : 0) |
+        (pDescriptor->flexibleMode ? VP9_PAYLOAD_DESCRIPTOR_F : 0) | (firstPacket ? VP9_PAYLOAD_DESCRIPTOR_B : 0) |
+        (lastPacket ? VP9_PAYLOAD_DESCRIPTOR_E : 0) | (withScalabilityStructure ? VP9_PAYLOAD_DESCRIPTOR_V : 0) |
+        (pDescriptor->notReferenceForUpperSpatialLayers ? VP9_PAYLOAD_DESCRIPTOR_Z : 0);
+
+    if (pDescriptor->pictureIdPresent) {
+        *pCurPtr++ = VP9_PICTURE_ID_EXTENDED | (BYTE) (pDescriptor->pictureId >> 8);
+        *pCurPtr++ = (BYTE) pDescriptor->pictureId;
+    }
+
+    if (pDescriptor->layerIndicesPresent) {
+        *pCurPtr++ = (BYTE) (pDescriptor->temporalId << VP9_LAYER_TID_SHIFT) | (pDescriptor->switchingUpPoint ? VP9_LAYER_U : 0) |
+            (BYTE) (pDescriptor->spatialId << VP9_LAYER_SID_SHIFT) | (pDescriptor->interLayerDependency ? VP9_LAYER_D : 0);
+        if (!pDescriptor->flexibleMode) {
+            *pCurPtr++ = pDescriptor->tl0PicIdx;
+        }
+    }
+
+    if (pDescriptor->flexibleMode && pDescriptor->interPicturePredicted) {
+        for (i = 0; i < pDescriptor->referenceCount; i++) {
+            *pCurPtr++ = (BYTE) (pDescriptor->pDiffs[i] << VP9_P_DIFF_SHIFT) | (i + 1 < pDescriptor->referenceCount ? VP9_P_DIFF_N : 0);
+        }
+    }
+
+    if (withScalabilityStructure) {
+        *pCurPtr++ = (BYTE) ((pStructure->spatialLayerCount - 1) << VP9_SS_N_S_SHIFT) | (pStructure->resolutionsPresent ? VP9_SS_Y : 0) |
+            (pStructure->pictureGroupPresent ? VP9_SS_G : 0);
+        for (i = 0; pStructure->resolutionsPresent && i < pStructure->spatialLayerCount; i++) {
+            putUnalignedInt16BigEndian(pCurPtr, pStructure->widths[i]);
+            putUnalignedInt16BigEndian(pCurPtr + SIZEOF(UINT16), pStructure->heights[i]);
+            pCurPtr += 2 * SIZEOF(UINT16);
+        }
+        if (pStructure->pictureGroupPresent) {
+            *pCurPtr++ = pStructure->pictureGroupSize;
+            for (i = 0; i < pStructure->pictureGroupSize; i++) {
+                pEntry = &pStructure->pictureGroup[i];
+                *pCurPtr++ = (BYTE) (pEntry->temporalId << VP9_LAYER_TID_SHIFT) | (pEntry->switchingUpPoint ? VP9_LAYER_U : 0) |
+                    (BYTE) (pEntry->referenceCount << VP9_SS_PICTURE_GROUP_R_SHIFT);
+                for (j = 0; j < pEntry->referenceCount; j++) {
+                    *pCurPtr++ = pEntry->pDiffs[j];
+                }
+            }
+        }
+    }
+
+    return pCurPtr;
+}
+
+// Fills pStructure when it is not NULL, otherwise the structure is only skipped
+static STATUS parseVp9ScalabilityStructure(PBYTE pPayload, UINT32 payloadLength, PVp9ScalabilityStructure pStructure, PUINT32 pLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 offset = 0, spatialLayerCount, pictureGroupSize = 0, referenceCount, i, j;
+    BOOL resolutionsPresent, pictureGroupPresent;
+    BYTE entry;
+
+    CHK(payloadLength > 0, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+    spatialLayerCount = (pPayload[offset] >> VP9_SS_N_S_SHIFT) + 1;
+    resolutionsPresent = (pPayload[offset] & VP9_SS_Y) != 0;
+    pictureGroupPresent = (pPayload[offset] & VP9_SS_G) != 0;
+    offset++;
+
+    if (pStructure != NULL) {
+        MEMSET(pStructure, 0x00, SIZEOF(Vp9ScalabilityStructure));
+        pStructure->spatialLayerCount = (UINT8) spatialLayerCount;
+        pStructure->resolutionsPresent = resolutionsPresent;
+        pStructure->pictureGroupPresent = pictureGroupPresent;
+    }
+
+    if (resolutionsPresent) {
+        CHK(payloadLength - offset >= spatialLayerCount * 2 * SIZEOF(UINT16), STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+        for (i = 0; pStructure != NULL && i < spatialLayerCount; i++) {
+            pStructure->widths[i] = (UINT16) getUnalignedInt16BigEndian(pPayload + offset + i * 2 * SIZEOF(UINT16));
+            pStructure->heights[i] = (UINT16) getUnalignedInt16BigEndian(pPayload + offset + i * 2 * SIZEOF(UINT16) + SIZEOF(UINT16));
+        }
+        offset += spatialLayerCount * 2 * SIZEOF(UINT16);
+    }
+
+    if (pictureGroupPresent) {
+        CHK(offset < payloadLength, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+        pictureGroupSize = pPayload[offset++];
+        if (pStructure != NULL) {
+            pStructure->pictureGroupSize = (UINT8) pictureGroupSize;
+        }
+        for (i = 0; i < pictureGroupSize; i++) {
+            CHK(offset < payloadLength, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+            entry = pPayload[offset++];
+            referenceCount = (entry >> VP9_SS_PICTURE_GROUP_R_SHIFT) & VP9_SS_PICTURE_GROUP_R_MASK;
+            CHK(payloadLength - offset >= referenceCount, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+            if (pStructure != NULL) {
+                pStructure->pictureGroup[i].temporalId = entry >> VP9_LAYER_TID_SHIFT;
+                pStructure->pictureGroup[i].switchingUpPoint = (entry & VP9_LAYER_U) != 0;
+                pStructure->pictureGroup[i].referenceCount = (UINT8) referenceCount;
+                for (j = 0; j < referenceCount; j++) {
+                    pStructure->pictureGroup[i].pDiffs[j] = pPayload[offset + j];
+                }
+            }
+            offset += referenceCount;
+        }
+    }
+
+CleanUp:
+    if (pLength != NULL) {
+        *pLength = offset;
+    }
+
+    return retStatus;
+}
+
+STATUS parseVp9PayloadDescriptor(PBYTE pPayload, UINT32 payloadLength, PVp9PayloadDescriptor pDescriptor, PUINT32 pDescriptorLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PVp9ScalabilityStructure pStructure;
+    UINT32 offset = 0, structureLength = 0;
+    BOOL moreReferences;
+    BYTE header;
+
+    CHK(pPayload != NULL && pDescriptor != NULL && pDescriptorLength != NULL, STATUS_NULL_ARG);
+    CHK(payloadLength > 0, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+
+    pStructure = pDescriptor->pScalabilityStructure;
+    MEMSET(pDescriptor, 0x00, SIZEOF(Vp9PayloadDescriptor));
+    pDescriptor->pScalabilityStructure = pStructure;
+
+    header = pPayload[offset++];
+    pDescriptor->pictureIdPresent = (header & VP9_PAYLOAD_DESCRIPTOR_I) != 0;
+    pDescriptor->interPicturePredicted = (header & VP9_PAYLOAD_DESCRIPTOR_P) != 0;
+    pDescriptor->layerIndicesPresent = (header & VP9_PAYLOAD_DESCRIPTOR_L) != 0;
+    pDescriptor->flexibleMode = (header & VP9_PAYLOAD_DESCRIPTOR_F) != 0;
+    pDescriptor->startOfLayerFrame = (header & VP9_PAYLOAD_DESCRIPTOR_B) != 0;
+    pDescriptor->endOfLayerFrame = (header & VP9_PAYLOAD_DESCRIPTOR_E) != 0;
+    pDescriptor->scalabilityStructurePresent = (header & VP9_PAYLOAD_DESCRIPTOR_V) != 0;
+    pDescriptor->notReferenceForUpperSpatialLayers = (header & VP9_PAYLOAD_DESCRIPTOR_Z) != 0;
+
+    if (pDescriptor->pictureIdPresent) {
+        CHK(offset < payloadLength, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+        if ((pPayload[offset] & VP9_PICTURE_ID_EXTENDED) != 0) {
+            CHK(offset + 1 < payloadLength, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+            pDescriptor->pictureId = (UINT16) ((pPayload[offset] & ~VP9_PICTURE_ID_EXTENDED) << 8) | pPayload[offset + 1];
+            offset += 2;
+        } else {
+            pDescriptor->pictureId = pPayload[offset++];
+        }
+    }
+
+    if (pDescriptor->layerIndicesPresent) {
+        CHK(offset < payloadLength, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+        pDescriptor->temporalId = pPayload[offset] >> VP9_LAYER_TID_SHIFT;
+        pDescriptor->switchingUpPoint = (pPayload[offset] & VP9_LAYER_U) != 0;
+        pDescriptor->spatialId = (pPayload[offset] >> VP9_LAYER_SID_SHIFT) & VP9_LAYER_ID_MASK;
+        pDescriptor->interLayerDependency = (pPayload[offset] & VP9_LAYER_D) != 0;
+        offset++;
+        if (!pDescriptor->flexibleMode) {
+            CHK(offset < payloadLength, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+            pDescriptor->tl0PicIdx = pPayload[offset++];
+        }
+    }
+
+    if (pDescriptor->flexibleMode && pDescriptor->interPicturePredicted) {
+        do {
+            CHK(offset < payloadLength && pDescriptor->referenceCount < VP9_MAX_REFERENCE_PICTURES, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+            pDescriptor->pDiffs[pDescriptor->referenceCount++] = pPayload[offset] >> VP9_P_DIFF_SHIFT;
+            moreReferences = (pPayload[offset] & VP9_P_DIFF_N) != 0;
+            offset++;
+        } while (moreReferences);
+    }
+
+    if (pDescriptor->scalabilityStructurePresent) {
+        CHK_STATUS(parseVp9ScalabilityStructure(pPayload + offset, payloadLength - offset, pStructure, &structureLength));
+        offset += structureLength;
+    }
+
+CleanUp:
+    if (pDescriptorLength != NULL) {
+        *pDescriptorLength = STATUS_SUCCEEDED(retStatus) ? offset : 0;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+/*
+ * Reads the start of the uncompressed frame header, frames which are neither key frames nor intra-only frames are predicted
+ * from earlier pictures. Anything which can not be parsed is treated as predicted.
+ */
+static BOOL vp9IsInterPicturePredicted(PBYTE pData, UINT32 dataLen)
+{
+    UINT32 bit, profile;
+
+    if (dataLen < 2 || (pData[0] >> 6) != VP9_FRAME_MARKER) {
+        return TRUE;
+    }
+
+    profile = VP9_READ_BIT(pData, 2) | (VP9_READ_BIT(pData, 3) << 1);
+    bit = profile == VP9_MAX_PROFILE ? 5 : 4;
+
+    // show_existing_frame only repeats an already decoded frame
+    if (VP9_READ_BIT(pData, bit) != 0) {
+        return TRUE;
+    }
+
+    // frame_type, show_frame, error_resilient_mode and intra_only, the last one is only present on hidden frames
+    bit++;
+    if (VP9_READ_BIT(pData, bit) == VP9_KEY_FRAME) {
+        return FALSE;
+    }
+
+    return VP9_READ_BIT(pData, bit + 1) != 0 || VP9_READ_BIT(pData, bit + 3) == 0;
+}
+
+STATUS createPayloadArrayForVP9(UINT32 mtu, PBYTE pData, UINT32 dataLen, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    Vp9PayloadDescriptor descriptor;
+
+    CHK(pData != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+
+    // Frame carries no layer information, so the stream is sent as a single layer without picture IDs
+    MEMSET(&descriptor, 0x00, SIZEOF(Vp9PayloadDescriptor));
+    descriptor.interPicturePredicted = vp9IsInterPicturePredicted(pData, dataLen);
+    CHK_STATUS(createPayloadArrayForVP9WithDescriptor(mtu, pData, dataLen, &descriptor, pPayloadArray));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/*
+ * Packetizes a single layer frame. SVC senders call this once per spatial layer of a picture with the same RTP timestamp,
+ * the marker bit then belongs on the last packet of the highest spatial layer.
+ */
+STATUS createPayloadArrayForVP9WithDescriptor(UINT32 mtu, PBYTE pData, UINT32 dataLen, PVp9PayloadDescriptor pDescriptor,
+                                              PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 payloadRemaining = dataLen, payloadLenConsumed = 0, payloadSubLenSize = 1, descriptorSize, firstDescriptorSize, packetDescriptorSize;
+    PBYTE currentData = pData, pCurPtrInPayload, pDataPtrInPayload;
+
+    CHK(pData != NULL && pDescriptor != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+    CHK_STATUS(validateVp9PayloadDescriptor(pDescriptor));
+    CHK(dataLen > 0, retStatus);
+
+    firstDescriptorSize = vp9PayloadDescriptorSize(pDescriptor, TRUE);
+    descriptorSize = vp9PayloadDescriptorSize(pDescriptor, FALSE);
+    CHK(mtu > firstDescriptorSize, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    // Only the first packet carries the scalability structure, the others have the same descriptor size
+    if (dataLen > mtu - firstDescriptorSize) {
+        payloadSubLenSize += (dataLen - (mtu - firstDescriptorSize) + (mtu - descriptorSize) - 1) / (mtu - descriptorSize);
+    }
+    CHK_STATUS(payloadArrayReserve(pPayloadArray, dataLen + firstDescriptorSize + (payloadSubLenSize - 1) * descriptorSize, payloadSubLenSize));
+
+    pCurPtrInPayload = pPayloadArray->payloadBuffer;
+    while (payloadRemaining > 0) {
+        packetDescriptorSize = pPayloadArray->payloadSubLenSize == 0 ? firstDescriptorSize : descriptorSize;
+        payloadLenConsumed = MIN(mtu - packetDescriptorSize, payloadRemaining);
+
+        pDataPtrInPayload =
+            writeVp9PayloadDescriptor(pDescriptor, pPayloadArray->payloadSubLenSize == 0, payloadLenConsumed == payloadRemaining, pCurPtrInPayload);
+        MEMCPY(pDataPtrInPayload, currentData, payloadLenConsumed);
+        pCurPtrInPayload = pDataPtrInPayload + payloadLenConsumed;
+        currentData += payloadLenConsumed;
+
+        pPayloadArray->payloadSubLength[pPayloadArray->payloadSubLenSize] = payloadLenConsumed + packetDescriptorSize;
+        pPayloadArray->payloadLength += payloadLenConsumed + packetDescriptorSize;
+        pPayloadArray->payloadSubLenSize++;
+        payloadRemaining -= payloadLenConsumed;
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS depayVP9FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pVp9Data, PUINT32 pVp9Length, PBOOL pIsStart)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    Vp9PayloadDescriptor descriptor;
+    UINT32 vp9Length = 0, dataLength, descriptorLength = 0;
+    BOOL sizeCalculationOnly = (pVp9Data == NULL);
+    BOOL isStartingPacket = FALSE;
+
+    CHK(pRawPacket != NULL && (pVp9Length != NULL || sizeCalculationOnly), STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+
+    descriptor.pScalabilityStructure = NULL;
+    CHK_STATUS(parseVp9PayloadDescriptor(pRawPacket, packetLength, &descriptor, &descriptorLength));
+
+    // A layer frame predicted from a lower spatial layer continues the picture that layer started
+    isStartingPacket = descriptor.startOfLayerFrame && !descriptor.interLayerDependency;
+
+    // Packets of dropped layers are left with a bare descriptor and contribute nothing to the frame
+    dataLength = packetLength - descriptorLength;
+    if (dataLength > 0) {
+        vp9Length = VP9_LAYER_FRAME_PREFIX_SIZE + dataLength;
+    }
+
+    CHK(!sizeCalculationOnly, retStatus);
+    CHK(vp9Length <= *pVp9Length, STATUS_BUFFER_TOO_SMALL);
+
+    if (dataLength > 0) {
+        pVp9Data[0] = descriptor.startOfLayerFrame ? VP9_LAYER_FRAME_START : 0;
+        putUnalignedInt32BigEndian(pVp9Data + 1, dataLength);
+        MEMCPY(pVp9Data + VP9_LAYER_FRAME_PREFIX_SIZE, pRawPacket + descriptorLength, dataLength);
+    }
+
+CleanUp:
+    if (STATUS_FAILED(retStatus) && sizeCalculationOnly) {
+        vp9Length = 0;
+    }
+
+    if (pVp9Length != NULL) {
+        *pVp9Length = vp9Length;
+    }
+
+    if (pIsStart != NULL) {
+        *pIsStart = isStartingPacket;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+/*
+ * Drops the packet prefixes of a depayloaded frame and, when the picture has several layer frames, appends a superframe index
+ * so decoders can split them again. Every packet prefix is 5 bytes while the index takes 4 bytes per layer frame plus 2, so
+ * the superframe always fits in the space of the depayloaded frame.
+ */
+STATUS vp9LayerFramesToSuperframe(PBYTE pFrame, UINT32 frameLength, PUINT32 pSuperframeLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 readOffset = 0, writeOffset = 0, packetLength, layerFrameCount = 0, i;
+    UINT32 layerFrameSizes[VP9_SUPERFRAME_MAX_FRAMES];
+    BYTE marker;
+
+    CHK(pFrame != NULL && pSuperframeLength != NULL, STATUS_NULL_ARG);
+
+    while (readOffset < frameLength) {
+        CHK(frameLength - readOffset >= VP9_LAYER_FRAME_PREFIX_SIZE, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+        packetLength = getUnalignedInt32BigEndian(pFrame + readOffset + 1);
+        if (layerFrameCount == 0 || (pFrame[readOffset] & VP9_LAYER_FRAME_START) != 0) {
+            if (layerFrameCount < VP9_SUPERFRAME_MAX_FRAMES) {
+                layerFrameSizes[layerFrameCount] = 0;
+            }
+            layerFrameCount++;
+        }
+        readOffset += VP9_LAYER_FRAME_PREFIX_SIZE;
+        CHK(packetLength <= frameLength - readOffset, STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR);
+
+        MEMMOVE(pFrame + writeOffset, pFrame + readOffset, packetLength);
+        if (layerFrameCount <= VP9_SUPERFRAME_MAX_FRAMES) {
+            layerFrameSizes[layerFrameCount - 1] += packetLength;
+        }
+        writeOffset += packetLength;
+        readOffset += packetLength;
+    }
+
+    // More layer frames than a superframe can index are left concatenated, libvpx still decodes them one after another
+    if (layerFrameCount > 1 && layerFrameCount <= VP9_SUPERFRAME_MAX_FRAMES) {
+        marker = VP9_SUPERFRAME_MARKER | ((VP9_SUPERFRAME_SIZE_BYTES - 1) << 3) | (BYTE) (layerFrameCount - 1);
+        pFrame[writeOffset++] = marker;
+        for (i = 0; i < layerFrameCount; i++) {
+            putUnalignedInt32LittleEndian(pFrame + writeOffset, layerFrameSizes[i]);
+            writeOffset += VP9_SUPERFRAME_SIZE_BYTES;
+        }
+        pFrame[writeOffset++] = marker;
+    }
+
+CleanUp:
+    if (pSuperframeLength != NULL) {
+        *pSuperframeLength = STATUS_SUCCEEDED(retStatus) ? writeOffset : 0;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS vp9FilterLayers(PBYTE pPayload, PUINT32 pPayloadLength, UINT8 maxSpatialId, UINT8 maxTemporalId)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    Vp9PayloadDescriptor descriptor;
+    UINT32 descriptorLength;
+
+    CHK(pPayload != NULL && pPayloadLength != NULL, STATUS_NULL_ARG);
+    CHK(*pPayloadLength > 0, retStatus);
+
+    descriptor.pScalabilityStructure = NULL;
+    CHK_STATUS(parseVp9PayloadDescriptor(pPayload, *pPayloadLength, &descriptor, &descriptorLength));
+    CHK(descriptor.layerIndicesPresent && (descriptor.spatialId > maxSpatialId || descriptor.temporalId > maxTemporalId), retStatus);
+
+    // A dropped picture still has to start its frame in the jitter buffer, otherwise the following pictures wait on it
+    pPayload[0] = descriptor.startOfLayerFrame && !descriptor.interLayerDependency ? VP9_PAYLOAD_DESCRIPTOR_B : 0;
+    *pPayloadLength = 1;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
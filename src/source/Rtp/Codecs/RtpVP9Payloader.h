@@ -0,0 +1,143 @@
+/*******************************************
+VP9 RTP Payloader include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_RTPVP9PAYLOADER_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_RTPVP9PAYLOADER_H
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Payload descriptor https://www.rfc-editor.org/rfc/rfc9628#section-4.2
+ *
+ *  0 1 2 3 4 5 6 7
+ * +-+-+-+-+-+-+-+-+
+ * |I|P|L|F|B|E|V|Z|
+ * +-+-+-+-+-+-+-+-+
+ * |M| PICTURE ID  | (if I)
+ * | EXTENDED PID  | (if M)
+ * | TID |U| SID |D| (if L)
+ * |   TL0PICIDX   | (if L and not F)
+ * |   P_DIFF    |N| (if F and P, up to 3 times)
+ * |      SS       | (if V)
+ * +-+-+-+-+-+-+-+-+
+ *
+ * I: picture ID present, P: inter-picture predicted, L: layer indices present, F: flexible mode
+ * B: start of a layer frame, E: end of a layer frame, V: scalability structure present
+ * Z: not used for inter-layer prediction by the upper spatial layers of the picture
+ */
+#define VP9_PAYLOAD_DESCRIPTOR_I 0x80
+#define VP9_PAYLOAD_DESCRIPTOR_P 0x40
+#define VP9_PAYLOAD_DESCRIPTOR_L 0x20
+#define VP9_PAYLOAD_DESCRIPTOR_F 0x10
+#define VP9_PAYLOAD_DESCRIPTOR_B 0x08
+#define VP9_PAYLOAD_DESCRIPTOR_E 0x04
+#define VP9_PAYLOAD_DESCRIPTOR_V 0x02
+#define VP9_PAYLOAD_DESCRIPTOR_Z 0x01
+
+#define VP9_PICTURE_ID_EXTENDED      0x80
+#define VP9_MAX_PICTURE_ID           0x7FFF
+#define VP9_LAYER_TID_SHIFT          5
+#define VP9_LAYER_U                  0x10
+#define VP9_LAYER_SID_SHIFT          1
+#define VP9_LAYER_ID_MASK            0x07
+#define VP9_LAYER_D                  0x01
+#define VP9_P_DIFF_SHIFT             1
+#define VP9_P_DIFF_N                 0x01
+#define VP9_MAX_P_DIFF               0x7F
+#define VP9_SS_N_S_SHIFT             5
+#define VP9_SS_Y                     0x10
+#define VP9_SS_G                     0x08
+#define VP9_SS_PICTURE_GROUP_R_SHIFT 2
+#define VP9_SS_PICTURE_GROUP_R_MASK  0x03
+
+#define VP9_MAX_SPATIAL_LAYERS     8
+#define VP9_MAX_TEMPORAL_LAYERS    8
+#define VP9_MAX_REFERENCE_PICTURES 3
+#define VP9_MAX_PICTURE_GROUP_SIZE 255
+
+// Uncompressed frame header fields, VP9 bitstream specification section 6.2
+#define VP9_FRAME_MARKER 2
+#define VP9_MAX_PROFILE  3
+#define VP9_KEY_FRAME    0
+
+/*
+ * depayVP9FromRtpPayload writes the payload of every packet behind a fixed size prefix: a flags byte marking the start of a
+ * layer frame and the payload length as a 32 bit big endian integer. Spatial layers of a picture share the RTP timestamp and
+ * are handed out as one frame, so vp9LayerFramesToSuperframe joins them into a superframe in place once the frame is complete.
+ */
+#define VP9_LAYER_FRAME_PREFIX_SIZE 5
+#define VP9_LAYER_FRAME_START       0x01
+
+// Superframe index, VP9 bitstream specification Annex B
+#define VP9_SUPERFRAME_MARKER        0xC0
+#define VP9_SUPERFRAME_MARKER_MASK   0xE0
+#define VP9_SUPERFRAME_SIZE_BYTES    4
+#define VP9_SUPERFRAME_MAX_FRAMES    8
+#define VP9_SUPERFRAME_INDEX_SIZE(n) (2 + (n) * VP9_SUPERFRAME_SIZE_BYTES)
+
+typedef struct {
+    UINT8 temporalId;
+    BOOL switchingUpPoint;
+    UINT8 referenceCount;
+    UINT8 pDiffs[VP9_MAX_REFERENCE_PICTURES];
+} Vp9PictureGroupEntry, *PVp9PictureGroupEntry;
+
+/**
+ * Scalability structure, sent on the first packet of key pictures to describe the layers which follow
+ */
+typedef struct {
+    UINT8 spatialLayerCount;
+    BOOL resolutionsPresent;
+    UINT16 widths[VP9_MAX_SPATIAL_LAYERS];
+    UINT16 heights[VP9_MAX_SPATIAL_LAYERS];
+    BOOL pictureGroupPresent;
+    UINT8 pictureGroupSize;
+    Vp9PictureGroupEntry pictureGroup[VP9_MAX_PICTURE_GROUP_SIZE];
+} Vp9ScalabilityStructure, *PVp9ScalabilityStructure;
+
+typedef struct {
+    // Set by the payloader on the first and last packet of the layer frame, reported by the parser
+    BOOL startOfLayerFrame;
+    BOOL endOfLayerFrame;
+    BOOL pictureIdPresent;
+    // Always written as a 15 bit picture ID, 7 bit ones are accepted when parsing
+    UINT16 pictureId;
+    BOOL interPicturePredicted;
+    BOOL flexibleMode;
+    BOOL notReferenceForUpperSpatialLayers;
+    BOOL layerIndicesPresent;
+    UINT8 temporalId;
+    BOOL switchingUpPoint;
+    UINT8 spatialId;
+    BOOL interLayerDependency;
+    // Non-flexible mode only
+    UINT8 tl0PicIdx;
+    // Flexible mode only, required for inter-picture predicted frames
+    UINT8 referenceCount;
+    UINT8 pDiffs[VP9_MAX_REFERENCE_PICTURES];
+    // The structure is written to the first packet of the layer frame. When parsing it is only filled if the pointer is set
+    BOOL scalabilityStructurePresent;
+    PVp9ScalabilityStructure pScalabilityStructure;
+} Vp9PayloadDescriptor, *PVp9PayloadDescriptor;
+
+STATUS parseVp9PayloadDescriptor(PBYTE, UINT32, PVp9PayloadDescriptor, PUINT32);
+
+STATUS createPayloadArrayForVP9(UINT32, PBYTE, UINT32, PPayloadArray);
+STATUS createPayloadArrayForVP9WithDescriptor(UINT32, PBYTE, UINT32, PVp9PayloadDescriptor, PPayloadArray);
+STATUS depayVP9FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+STATUS vp9LayerFramesToSuperframe(PBYTE, UINT32, PUINT32);
+
+/**
+ * Strips the payload of packets above the given spatial and temporal layers, keeping a bare descriptor which still marks
+ * the start of the picture. The packet keeps its sequence number, so the jitter buffer sees the remaining layers as complete.
+ */
+STATUS vp9FilterLayers(PBYTE, PUINT32, UINT8, UINT8);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_RTPVP9PAYLOADER_H
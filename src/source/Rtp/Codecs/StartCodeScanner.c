@@ -0,0 +1,137 @@
+#define LOG_CLASS "StartCodeScanner"
+
+#include "../../Include_i.h"
+
+#if defined(KVS_START_CODE_SCANNER_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined(KVS_START_CODE_SCANNER_AVX2)
+#include <immintrin.h>
+#endif
+#if defined(KVS_START_CODE_SCANNER_NEON)
+#include <arm_neon.h>
+#endif
+
+typedef UINT32 (*StartCodeScannerFunc)(PBYTE, UINT32);
+
+UINT32 findAnnexBStartCodeScalar(PBYTE pBuffer, UINT32 length)
+{
+    UINT32 offset = 2;
+
+    // offset always points at the candidate 0x01, which needs two zeros in front of it
+    while (offset < length) {
+        if (pBuffer[offset] > 1) {
+            // Neither this byte nor the two before it can be part of a start code ending past offset
+            offset += 3;
+        } else if (pBuffer[offset] == 0) {
+            offset++;
+        } else if (pBuffer[offset - 1] == 0 && pBuffer[offset - 2] == 0) {
+            return offset - 2;
+        } else {
+            offset += 3;
+        }
+    }
+
+    return length;
+}
+
+#ifdef KVS_START_CODE_SCANNER_SSE2
+UINT32 findAnnexBStartCodeSse2(PBYTE pBuffer, UINT32 length)
+{
+    UINT32 offset = 0;
+    INT32 mask;
+    __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi8(1), first, second, third;
+
+    // Compare the buffer with itself shifted by one and two bytes, a set bit marks a 00 00 01 starting there
+    for (; offset + 2 + SIZEOF(__m128i) <= length; offset += SIZEOF(__m128i)) {
+        first = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*) (pBuffer + offset)), zero);
+        second = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*) (pBuffer + offset + 1)), zero);
+        third = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*) (pBuffer + offset + 2)), one);
+        mask = _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(first, second), third));
+        if (mask != 0) {
+            return offset + (UINT32) __builtin_ctz((UINT32) mask);
+        }
+    }
+
+    return offset + findAnnexBStartCodeScalar(pBuffer + offset, length - offset);
+}
+#endif
+
+#ifdef KVS_START_CODE_SCANNER_AVX2
+__attribute__((target("avx2"))) UINT32 findAnnexBStartCodeAvx2(PBYTE pBuffer, UINT32 length)
+{
+    UINT32 offset = 0;
+    UINT32 mask;
+    __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi8(1), first, second, third;
+
+    for (; offset + 2 + SIZEOF(__m256i) <= length; offset += SIZEOF(__m256i)) {
+        first = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*) (pBuffer + offset)), zero);
+        second = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*) (pBuffer + offset + 1)), zero);
+        third = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*) (pBuffer + offset + 2)), one);
+        mask = (UINT32) _mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(first, second), third));
+        if (mask != 0) {
+            return offset + (UINT32) __builtin_ctz(mask);
+        }
+    }
+
+    return offset + findAnnexBStartCodeSse2(pBuffer + offset, length - offset);
+}
+
+BOOL isAvx2StartCodeScannerSupported(VOID)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+}
+#endif
+
+#ifdef KVS_START_CODE_SCANNER_NEON
+UINT32 findAnnexBStartCodeNeon(PBYTE pBuffer, UINT32 length)
+{
+    UINT32 offset = 0;
+    uint8x16_t zero = vdupq_n_u8(0), one = vdupq_n_u8(1), match;
+    uint64x2_t lanes;
+
+    for (; offset + 2 + SIZEOF(uint8x16_t) <= length; offset += SIZEOF(uint8x16_t)) {
+        match = vandq_u8(vandq_u8(vceqq_u8(vld1q_u8(pBuffer + offset), zero), vceqq_u8(vld1q_u8(pBuffer + offset + 1), zero)),
+                         vceqq_u8(vld1q_u8(pBuffer + offset + 2), one));
+        lanes = vreinterpretq_u64_u8(match);
+        if ((vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1)) != 0) {
+            // Start codes are rare, locate the exact byte in the block with the scalar scanner
+            return offset + findAnnexBStartCodeScalar(pBuffer + offset, SIZEOF(uint8x16_t) + 2);
+        }
+    }
+
+    return offset + findAnnexBStartCodeScalar(pBuffer + offset, length - offset);
+}
+#endif
+
+static StartCodeScannerFunc selectStartCodeScanner(VOID)
+{
+#if defined(KVS_START_CODE_SCANNER_AVX2)
+    if (isAvx2StartCodeScannerSupported()) {
+        return findAnnexBStartCodeAvx2;
+    }
+#endif
+#if defined(KVS_START_CODE_SCANNER_SSE2)
+    return findAnnexBStartCodeSse2;
+#elif defined(KVS_START_CODE_SCANNER_NEON)
+    return findAnnexBStartCodeNeon;
+#else
+    return findAnnexBStartCodeScalar;
+#endif
+}
+
+// Selected on first use, threads racing on it all store the same implementation
+static volatile SIZE_T gStartCodeScannerFn = (SIZE_T) NULL;
+
+UINT32 findAnnexBStartCode(PBYTE pBuffer, UINT32 length)
+{
+    StartCodeScannerFunc scannerFn = (StartCodeScannerFunc) ATOMIC_LOAD(&gStartCodeScannerFn);
+
+    if (scannerFn == NULL) {
+        scannerFn = selectStartCodeScanner();
+        ATOMIC_STORE(&gStartCodeScannerFn, (SIZE_T) scannerFn);
+    }
+
+    return scannerFn(pBuffer, length);
+}
@@ -0,0 +1,49 @@
+/*******************************************
+Annex-B start code scanner include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_STARTCODESCANNER_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_STARTCODESCANNER_H
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Vector implementations are compiled in based on the target. Define KVS_DISABLE_SIMD to only build the scalar scanner.
+#ifndef KVS_DISABLE_SIMD
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#define KVS_START_CODE_SCANNER_SSE2
+#endif
+// AVX2 is selected at runtime so the library still runs on CPUs without it
+#if defined(KVS_START_CODE_SCANNER_SSE2) && (defined(__x86_64__) || defined(__i386__))
+#define KVS_START_CODE_SCANNER_AVX2
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+#define KVS_START_CODE_SCANNER_NEON
+#endif
+#endif
+
+/**
+ * Returns the offset of the first byte of the first 0x000001 sequence in the buffer or the buffer length if there is none.
+ * A four byte start code is reported at its second zero, the caller decides whether the preceding zero belongs to it.
+ */
+UINT32 findAnnexBStartCode(PBYTE, UINT32);
+
+// Individual implementations, visible for testing and benchmarking
+UINT32 findAnnexBStartCodeScalar(PBYTE, UINT32);
+#ifdef KVS_START_CODE_SCANNER_SSE2
+UINT32 findAnnexBStartCodeSse2(PBYTE, UINT32);
+#endif
+#ifdef KVS_START_CODE_SCANNER_AVX2
+UINT32 findAnnexBStartCodeAvx2(PBYTE, UINT32);
+BOOL isAvx2StartCodeScannerSupported(VOID);
+#endif
+#ifdef KVS_START_CODE_SCANNER_NEON
+UINT32 findAnnexBStartCodeNeon(PBYTE, UINT32);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_STARTCODESCANNER_H
@@ -157,6 +157,46 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createRetransmitBytesFromRtpPacket(PRtpPacket pRtpPacket, UINT16 sequenceNum, UINT8 payloadType, UINT32 ssrc, PBYTE pRawPacket,
+                                          PUINT32 pPacketLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 headerLength = 0, packetLength = 0;
+
+    CHK(pRtpPacket != NULL && pPacketLength != NULL, STATUS_NULL_ARG);
+
+    headerLength = RTP_HEADER_LEN(pRtpPacket);
+    packetLength = headerLength + RTX_OSN_SIZE + pRtpPacket->payloadLength;
+
+    // Check if we are trying to calculate the required size only
+    CHK(pRawPacket != NULL, retStatus);
+
+    // Otherwise, check if the specified size is enough
+    CHK(*pPacketLength >= packetLength, STATUS_NOT_ENOUGH_MEMORY);
+    CHK(pRtpPacket->pRawPacket != NULL && pRtpPacket->rawPacketLength >= headerLength, STATUS_INVALID_ARG);
+
+    // Same header as the original but for the padding, payload type, sequence number and ssrc
+    MEMCPY(pRawPacket, pRtpPacket->pRawPacket, headerLength);
+    pRawPacket[0] &= ~(PADDING_MASK << PADDING_SHIFT);
+    pRawPacket[1] = (pRawPacket[1] & (MARKER_MASK << MARKER_SHIFT)) | (payloadType & PAYLOAD_TYPE_MASK);
+    putUnalignedInt16BigEndian((PINT16) (pRawPacket + SEQ_NUMBER_OFFSET), sequenceNum);
+    putUnalignedInt32BigEndian((PINT32) (pRawPacket + SSRC_OFFSET), ssrc);
+
+    // Retransmission payload header is OSN original sequence number
+    putUnalignedInt16BigEndian((PINT16) (pRawPacket + headerLength), pRtpPacket->header.sequenceNumber);
+    MEMCPY(pRawPacket + headerLength + RTX_OSN_SIZE, pRtpPacket->payload, pRtpPacket->payloadLength);
+
+CleanUp:
+
+    if (pPacketLength != NULL) {
+        *pPacketLength = packetLength;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS setRtpPacketFromBytes(PBYTE rawPacket, UINT32 packetLength, PRtpPacket pRtpPacket)
 {
     ENTERS();
@@ -350,3 +390,91 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS payloadArrayReserve(PPayloadArray pPayloadArray, UINT32 additionalLength, UINT32 additionalSubLenSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 requiredLength, requiredSubLenSize, newSize;
+    PBYTE pNewPayloadBuffer = NULL;
+    PUINT32 pNewPayloadSubLength = NULL;
+
+    CHK(pPayloadArray != NULL, STATUS_NULL_ARG);
+
+    requiredLength = pPayloadArray->payloadLength + additionalLength;
+    requiredSubLenSize = pPayloadArray->payloadSubLenSize + additionalSubLenSize;
+
+    // Grow geometrically so a pooled array settles after the first few large frames
+    if (requiredLength > pPayloadArray->maxPayloadLength) {
+        newSize = MAX(requiredLength, pPayloadArray->maxPayloadLength + pPayloadArray->maxPayloadLength / 2);
+        CHK(NULL != (pNewPayloadBuffer = (PBYTE) MEMREALLOC(pPayloadArray->payloadBuffer, newSize)), STATUS_NOT_ENOUGH_MEMORY);
+        pPayloadArray->payloadBuffer = pNewPayloadBuffer;
+        pPayloadArray->maxPayloadLength = newSize;
+    }
+
+    if (requiredSubLenSize > pPayloadArray->maxPayloadSubLenSize) {
+        newSize = MAX(requiredSubLenSize, pPayloadArray->maxPayloadSubLenSize + pPayloadArray->maxPayloadSubLenSize / 2);
+        CHK(NULL != (pNewPayloadSubLength = (PUINT32) MEMREALLOC(pPayloadArray->payloadSubLength, newSize * SIZEOF(UINT32))),
+            STATUS_NOT_ENOUGH_MEMORY);
+        pPayloadArray->payloadSubLength = pNewPayloadSubLength;
+        pPayloadArray->maxPayloadSubLenSize = newSize;
+    }
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+// Looks up the element with the given id in a one-byte or two-byte header extension block
+STATUS getRtpHeaderExtensionElement(PRtpPacket pRtpPacket, UINT8 extensionId, PBYTE* ppElement, PUINT32 pElementLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE pCurPtr, pEnd;
+    UINT8 id;
+    UINT32 elementLength;
+    BOOL oneByteHeader;
+
+    CHK(pRtpPacket != NULL && ppElement != NULL && pElementLength != NULL, STATUS_NULL_ARG);
+    CHK(pRtpPacket->header.extension && extensionId != 0, STATUS_RTP_HEADER_EXTENSION_NOT_FOUND);
+
+    oneByteHeader = pRtpPacket->header.extensionProfile == RTP_ONE_BYTE_EXT_PROFILE;
+    CHK(oneByteHeader || (pRtpPacket->header.extensionProfile & RTP_TWO_BYTE_EXT_PROFILE_MASK) == RTP_TWO_BYTE_EXT_PROFILE,
+        STATUS_RTP_HEADER_EXTENSION_NOT_FOUND);
+
+    pCurPtr = pRtpPacket->header.extensionPayload;
+    pEnd = pCurPtr + pRtpPacket->header.extensionLength;
+    while (pCurPtr < pEnd) {
+        // Zero bytes are padding between elements
+        if (pCurPtr[0] == 0) {
+            pCurPtr++;
+            continue;
+        }
+
+        if (oneByteHeader) {
+            id = pCurPtr[0] >> 4;
+            CHK(id != RTP_ONE_BYTE_EXT_ID_RESERVED, STATUS_RTP_HEADER_EXTENSION_NOT_FOUND);
+            elementLength = (pCurPtr[0] & 0x0F) + 1;
+            pCurPtr++;
+        } else {
+            CHK(pCurPtr + 1 < pEnd, STATUS_RTP_INVALID_EXTENSION_LEN);
+            id = pCurPtr[0];
+            elementLength = pCurPtr[1];
+            pCurPtr += 2;
+        }
+
+        CHK(elementLength <= pEnd - pCurPtr, STATUS_RTP_INVALID_EXTENSION_LEN);
+        if (id == extensionId) {
+            *ppElement = pCurPtr;
+            *pElementLength = elementLength;
+            CHK(FALSE, retStatus);
+        }
+        pCurPtr += elementLength;
+    }
+
+    CHK(FALSE, STATUS_RTP_HEADER_EXTENSION_NOT_FOUND);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
@@ -26,6 +26,7 @@ extern "C" {
 #define SSRC_OFFSET       8
 #define CSRC_OFFSET       12
 #define CSRC_LENGTH       4
+#define RTX_OSN_SIZE      2
 
 #define RTP_HEADER_LEN(pRtpPacket)                                                                                                                   \
     (12 + (pRtpPacket)->header.csrcCount * CSRC_LENGTH + ((pRtpPacket)->header.extension ? 4 + (pRtpPacket)->header.extensionLength : 0))
@@ -49,6 +50,13 @@ extern "C" {
 #define TWCC_PAYLOAD(extId, sequenceNum) htonl((((extId) & 0xfu) << 28u) | (1u << 24u) | ((UINT32) (sequenceNum) << 8u))
 #define TWCC_SEQNUM(extPayload)          ((UINT16) getUnalignedInt16BigEndian(extPayload + 1))
 
+// One-byte and two-byte header extension profiles https://tools.ietf.org/html/rfc8285#section-4
+#define RTP_ONE_BYTE_EXT_PROFILE      0xBEDE
+#define RTP_TWO_BYTE_EXT_PROFILE      0x1000
+#define RTP_TWO_BYTE_EXT_PROFILE_MASK 0xFFF0
+#define RTP_ONE_BYTE_EXT_ID_RESERVED  15
+
+// Depayloads into the given buffer, or only sizes the output when the buffer is NULL. With a NULL size as well only the start flag is set
 typedef STATUS (*DepayRtpPayloadFunc)(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
 
 /*
@@ -95,6 +103,12 @@ struct __Payloads {
 typedef struct __Payloads PayloadArray;
 typedef PayloadArray* PPayloadArray;
 
+/*
+ * Single pass payloader. Packetizes a frame straight into the payload array, growing the array buffers when needed
+ * so the same array can be reused across frames.
+ */
+typedef STATUS (*RtpPayloadArrayFunc)(UINT32, PBYTE, UINT32, PPayloadArray);
+
 typedef struct __RtpPacket RtpPacket;
 struct __RtpPacket {
     RtpPacketHeader header;
@@ -114,10 +128,18 @@ STATUS setRtpPacket(UINT8, BOOL, BOOL, UINT8, BOOL, UINT8, UINT16, UINT32, UINT3
 STATUS freeRtpPacket(PRtpPacket*);
 STATUS createRtpPacketFromBytes(PBYTE, UINT32, PRtpPacket*);
 STATUS constructRetransmitRtpPacketFromBytes(PBYTE, UINT32, UINT16, UINT8, UINT32, PRtpPacket*);
+
+/**
+ * Serializes the RTX packet (https://tools.ietf.org/html/rfc4588#section-4) retransmitting a packet parsed from its raw
+ * bytes, without allocating. Only the size is returned when the buffer is NULL.
+ */
+STATUS createRetransmitBytesFromRtpPacket(PRtpPacket, UINT16, UINT8, UINT32, PBYTE, PUINT32);
 STATUS setRtpPacketFromBytes(PBYTE, UINT32, PRtpPacket);
 STATUS createBytesFromRtpPacket(PRtpPacket, PBYTE, PUINT32);
 STATUS setBytesFromRtpPacket(PRtpPacket, PBYTE, UINT32);
 STATUS constructRtpPackets(PPayloadArray, UINT8, UINT16, UINT32, UINT32, PRtpPacket, UINT32);
+STATUS payloadArrayReserve(PPayloadArray, UINT32, UINT32);
+STATUS getRtpHeaderExtensionElement(PRtpPacket, UINT8, PBYTE*, PUINT32);
 
 #ifdef __cplusplus
 }
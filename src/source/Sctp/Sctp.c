@@ -22,8 +22,9 @@ STATUS configureSctpSocket(struct socket* socket)
     struct sctp_event event;
     UINT32 i;
     UINT32 valueOn = 1;
-    UINT16 event_types[] = {SCTP_ASSOC_CHANGE,   SCTP_PEER_ADDR_CHANGE,      SCTP_REMOTE_ERROR,
-                            SCTP_SHUTDOWN_EVENT, SCTP_ADAPTATION_INDICATION, SCTP_PARTIAL_DELIVERY_EVENT};
+    struct sctp_assoc_value streamReset;
+    UINT16 event_types[] = {SCTP_ASSOC_CHANGE,          SCTP_PEER_ADDR_CHANGE,       SCTP_REMOTE_ERROR,       SCTP_SHUTDOWN_EVENT,
+                            SCTP_ADAPTATION_INDICATION, SCTP_PARTIAL_DELIVERY_EVENT, SCTP_STREAM_RESET_EVENT};
 
     CHK(usrsctp_set_non_blocking(socket, 1) == 0, STATUS_SCTP_SESSION_SETUP_FAILED);
 
@@ -46,10 +47,17 @@ STATUS configureSctpSocket(struct socket* socket)
 
     struct sctp_initmsg initmsg;
     MEMSET(&initmsg, 0, SIZEOF(struct sctp_initmsg));
-    initmsg.sinit_num_ostreams = 300;
-    initmsg.sinit_max_instreams = 300;
+    initmsg.sinit_num_ostreams = SCTP_MAX_STREAM_COUNT;
+    initmsg.sinit_max_instreams = SCTP_MAX_STREAM_COUNT;
     CHK(usrsctp_setsockopt(socket, IPPROTO_SCTP, SCTP_INITMSG, &initmsg, SIZEOF(struct sctp_initmsg)) == 0, STATUS_SCTP_SESSION_SETUP_FAILED);
 
+    // DataChannels are closed by resetting their streams
+    MEMSET(&streamReset, 0x00, SIZEOF(streamReset));
+    streamReset.assoc_id = SCTP_FUTURE_ASSOC;
+    streamReset.assoc_value = SCTP_ENABLE_RESET_STREAM_REQ;
+    CHK(usrsctp_setsockopt(socket, IPPROTO_SCTP, SCTP_ENABLE_STREAM_RESET, &streamReset, SIZEOF(streamReset)) == 0,
+        STATUS_SCTP_SESSION_SETUP_FAILED);
+
 CleanUp:
     LEAVES();
     return retStatus;
@@ -75,45 +83,76 @@ VOID deinitSctpSession()
     }
 }
 
-STATUS createSctpSession(PSctpSessionCallbacks pSctpSessionCallbacks, PSctpSession* ppSctpSession)
+STATUS createSctpSession(PSctpSessionCallbacks pSctpSessionCallbacks, UINT32 basePacketSize, UINT32 maxPacketSize, PSctpSession* ppSctpSession)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PSctpSession pSctpSession = NULL;
     struct sockaddr_conn localConn, remoteConn;
-    struct sctp_paddrparams params;
-    INT32 connectStatus = 0;
+    INT32 connectStatus = 0, sendBufferSize = 0;
+    socklen_t optionLen = SIZEOF(sendBufferSize);
 
     CHK(ppSctpSession != NULL && pSctpSessionCallbacks != NULL, STATUS_NULL_ARG);
+    CHK(basePacketSize >= SCTP_MIN_PACKET_SIZE && maxPacketSize >= basePacketSize, STATUS_INVALID_ARG);
 
-    pSctpSession = (PSctpSession) MEMALLOC(SIZEOF(SctpSession));
+    pSctpSession = (PSctpSession) MEMCALLOC(1, SIZEOF(SctpSession));
     CHK(pSctpSession != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pSctpSession->sendLock = INVALID_MUTEX_VALUE;
+    pSctpSession->sendCvar = INVALID_CVAR_VALUE;
+    pSctpSession->shutdownCvar = INVALID_CVAR_VALUE;
+    pSctpSession->pmtuLock = INVALID_MUTEX_VALUE;
+    pSctpSession->streamResetLock = INVALID_MUTEX_VALUE;
 
-    MEMSET(&params, 0x00, SIZEOF(struct sctp_paddrparams));
     MEMSET(&localConn, 0x00, SIZEOF(struct sockaddr_conn));
     MEMSET(&remoteConn, 0x00, SIZEOF(struct sockaddr_conn));
 
     ATOMIC_STORE(&pSctpSession->shutdownStatus, SCTP_SESSION_ACTIVE);
     pSctpSession->sctpSessionCallbacks = *pSctpSessionCallbacks;
 
+    pSctpSession->sendLock = MUTEX_CREATE(FALSE);
+    pSctpSession->sendCvar = CVAR_CREATE();
+    pSctpSession->shutdownCvar = CVAR_CREATE();
+    pSctpSession->pmtuLock = MUTEX_CREATE(FALSE);
+    pSctpSession->streamResetLock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pSctpSession->sendLock) && IS_VALID_CVAR_VALUE(pSctpSession->sendCvar) &&
+            IS_VALID_CVAR_VALUE(pSctpSession->shutdownCvar) && IS_VALID_MUTEX_VALUE(pSctpSession->pmtuLock) &&
+            IS_VALID_MUTEX_VALUE(pSctpSession->streamResetLock),
+        STATUS_INVALID_OPERATION);
+    CHK_STATUS(stackQueueCreate(&pSctpSession->pSentMessages));
+    CHK_STATUS(stackQueueCreate(&pSctpSession->pPendingStreamResets));
+
+    // Probes are padded to a multiple of 4 bytes like any chunk
+    pSctpSession->basePacketSize = basePacketSize;
+    pSctpSession->maxPacketSize = ROUND_DOWN(maxPacketSize, 4);
+    pSctpSession->packetSize = basePacketSize;
+    pSctpSession->pmtuProbeState = SCTP_PMTU_PROBE_STATE_DISABLED;
+    if (pSctpSession->maxPacketSize >= basePacketSize + SCTP_PMTU_SEARCH_STEP) {
+        CHK(NULL != (pSctpSession->pProbePacket = (PBYTE) MEMCALLOC(1, pSctpSession->maxPacketSize)), STATUS_NOT_ENOUGH_MEMORY);
+        pSctpSession->searchHighPacketSize = pSctpSession->maxPacketSize;
+        pSctpSession->pmtuProbeState = SCTP_PMTU_PROBE_STATE_SEARCHING;
+    }
+
     CHK_STATUS(initSctpAddrConn(pSctpSession, &localConn));
     CHK_STATUS(initSctpAddrConn(pSctpSession, &remoteConn));
 
-    CHK((pSctpSession->socket = usrsctp_socket(AF_CONN, SOCK_STREAM, IPPROTO_SCTP, onSctpInboundPacket, NULL, 0, pSctpSession)) != NULL,
+    CHK((pSctpSession->socket = usrsctp_socket(AF_CONN, SOCK_STREAM, IPPROTO_SCTP, onSctpInboundPacket, onSctpSendSpaceAvailable, 0,
+                                                  pSctpSession)) != NULL,
         STATUS_SCTP_SESSION_SETUP_FAILED);
     usrsctp_register_address(pSctpSession);
     CHK_STATUS(configureSctpSocket(pSctpSession->socket));
 
+    // Free space reported on every SACK is relative to the size of the send buffer
+    CHK(usrsctp_getsockopt(pSctpSession->socket, SOL_SOCKET, SO_SNDBUF, &sendBufferSize, &optionLen) == 0 && sendBufferSize > 0,
+        STATUS_SCTP_SESSION_SETUP_FAILED);
+    pSctpSession->sendBufferSize = (UINT32) sendBufferSize;
+
     CHK(usrsctp_bind(pSctpSession->socket, (struct sockaddr*) &localConn, SIZEOF(localConn)) == 0, STATUS_SCTP_SESSION_SETUP_FAILED);
 
     connectStatus = usrsctp_connect(pSctpSession->socket, (struct sockaddr*) &remoteConn, SIZEOF(remoteConn));
     CHK(connectStatus >= 0 || errno == EINPROGRESS, STATUS_SCTP_SESSION_SETUP_FAILED);
 
-    memcpy(&params.spp_address, &remoteConn, SIZEOF(remoteConn));
-    params.spp_flags = SPP_PMTUD_DISABLE;
-    params.spp_pathmtu = SCTP_MTU;
-    CHK(usrsctp_setsockopt(pSctpSession->socket, IPPROTO_SCTP, SCTP_PEER_ADDR_PARAMS, &params, SIZEOF(params)) == 0,
-        STATUS_SCTP_SESSION_SETUP_FAILED);
+    // Messages are fragmented for the packet size the association starts with
+    CHK_STATUS(sctpSessionSetPacketSize(pSctpSession, basePacketSize));
 
 CleanUp:
     if (STATUS_FAILED(retStatus)) {
@@ -131,7 +170,7 @@ STATUS freeSctpSession(PSctpSession* ppSctpSession)
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PSctpSession pSctpSession;
-    UINT64 shutdownTimeout;
+    UINT64 shutdownTimeout, now;
 
     CHK(ppSctpSession != NULL, STATUS_NULL_ARG);
 
@@ -148,13 +187,46 @@ STATUS freeSctpSession(PSctpSession* ppSctpSession)
         usrsctp_set_ulpinfo(pSctpSession->socket, NULL);
         usrsctp_shutdown(pSctpSession->socket, SHUT_RDWR);
         usrsctp_close(pSctpSession->socket);
+
+        // Wait for the last packet of the association, onSctpOutboundPacket signals once it has been refused
+        shutdownTimeout = GETTIME() + DEFAULT_SCTP_SHUTDOWN_TIMEOUT;
+        MUTEX_LOCK(pSctpSession->sendLock);
+        while (ATOMIC_LOAD(&pSctpSession->shutdownStatus) != SCTP_SESSION_SHUTDOWN_COMPLETED && (now = GETTIME()) < shutdownTimeout) {
+            CVAR_WAIT(pSctpSession->shutdownCvar, pSctpSession->sendLock, shutdownTimeout - now);
+        }
+        MUTEX_UNLOCK(pSctpSession->sendLock);
     }
 
-    shutdownTimeout = GETTIME() + DEFAULT_SCTP_SHUTDOWN_TIMEOUT;
-    while (ATOMIC_LOAD(&pSctpSession->shutdownStatus) != SCTP_SESSION_SHUTDOWN_COMPLETED && GETTIME() < shutdownTimeout) {
-        THREAD_SLEEP(DEFAULT_USRSCTP_TEARDOWN_POLLING_INTERVAL);
+    if (pSctpSession->pSentMessages != NULL) {
+        stackQueueFree(pSctpSession->pSentMessages);
     }
 
+    if (pSctpSession->pPendingStreamResets != NULL) {
+        stackQueueFree(pSctpSession->pPendingStreamResets);
+    }
+
+    if (IS_VALID_CVAR_VALUE(pSctpSession->sendCvar)) {
+        CVAR_FREE(pSctpSession->sendCvar);
+    }
+
+    if (IS_VALID_CVAR_VALUE(pSctpSession->shutdownCvar)) {
+        CVAR_FREE(pSctpSession->shutdownCvar);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pSctpSession->sendLock)) {
+        MUTEX_FREE(pSctpSession->sendLock);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pSctpSession->pmtuLock)) {
+        MUTEX_FREE(pSctpSession->pmtuLock);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pSctpSession->streamResetLock)) {
+        MUTEX_FREE(pSctpSession->streamResetLock);
+    }
+
+    SAFE_MEMFREE(pSctpSession->pProbePacket);
+
     SAFE_MEMFREE(*ppSctpSession);
 
     *ppSctpSession = NULL;
@@ -165,33 +237,156 @@ CleanUp:
     return retStatus;
 }
 
-STATUS sctpSessionWriteMessage(PSctpSession pSctpSession, UINT32 streamId, BOOL isBinary, PBYTE pMessage, UINT32 pMessageLen)
+// Hands the message to usrsctp and records it until the remote peer has acknowledged all of it. Bytes of tracked
+// messages are reported to dataChannelBufferDrainedFunc as they are acknowledged. Called by the thread owning the send
+// queue only
+STATUS sctpSessionSendv(PSctpSession pSctpSession, PSctpSendRequest pSendRequest)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
+    UINT32 count = 0;
+    INT32 sendErrno = 0;
+    BOOL locked = FALSE, sent;
+
+    // Recorded before usrsctp has the message, so that a SACK handled while it sends finds the records of all the bytes
+    // in the send buffer
+    MUTEX_LOCK(pSctpSession->sendLock);
+    locked = TRUE;
+    CHK_STATUS(stackQueueEnqueue(pSctpSession->pSentMessages, SCTP_SENT_MESSAGE_RECORD(pSendRequest->tracked, pSendRequest->spa.sendv_sndinfo.snd_sid,
+                                                                                        pSendRequest->messageLen)));
+    pSctpSession->bufferedAmount += pSendRequest->messageLen;
+    pSctpSession->sendingMessageLen = pSendRequest->messageLen;
+    MUTEX_UNLOCK(pSctpSession->sendLock);
+    locked = FALSE;
+
+    sent = usrsctp_sendv(pSctpSession->socket, pSendRequest->pMessage, pSendRequest->messageLen, NULL, 0, &pSendRequest->spa,
+                         SIZEOF(pSendRequest->spa), SCTP_SENDV_SPA, 0) > 0;
+    if (!sent) {
+        sendErrno = errno;
+    }
 
-    CHK(pSctpSession != NULL && pMessage != NULL, STATUS_NULL_ARG);
+    MUTEX_LOCK(pSctpSession->sendLock);
+    locked = TRUE;
+    pSctpSession->sendingMessageLen = 0;
+    if (!sent) {
+        // The record of the message is the last one as only the thread owning the send queue adds any
+        CHK_STATUS(stackQueueGetCount(pSctpSession->pSentMessages, &count));
+        CHK_STATUS(stackQueueRemoveAt(pSctpSession->pSentMessages, count - 1));
+        pSctpSession->bufferedAmount -= pSendRequest->messageLen;
+        CHK(sendErrno != EWOULDBLOCK && sendErrno != EAGAIN, STATUS_SCTP_SEND_WOULD_BLOCK);
+        CHK(FALSE, STATUS_INTERNAL_ERROR);
+    }
 
-    MEMSET(&pSctpSession->spa, 0x00, SIZEOF(struct sctp_sendv_spa));
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pSctpSession->sendLock);
+    }
 
-    pSctpSession->spa.sendv_flags |= SCTP_SEND_SNDINFO_VALID;
-    pSctpSession->spa.sendv_sndinfo.snd_sid = streamId;
+    LEAVES();
+    return retStatus;
+}
 
-    if ((pSctpSession->packet[1] & DCEP_DATA_CHANNEL_RELIABLE_UNORDERED) != 0) {
-        pSctpSession->spa.sendv_sndinfo.snd_flags |= SCTP_UNORDERED;
+// Queues the message and waits for it to be sent. When no other thread is sending, the calling thread takes over the
+// queue and sends everything queued so far, so messages reach usrsctp in the order they were queued from one thread
+// at a time, and their records are in the same order as the bytes in the send buffer
+STATUS sctpSessionQueueSend(PSctpSession pSctpSession, PSctpSendRequest pSendRequest)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSctpSendRequest pBatch, pRequest, pNext;
+
+    pSendRequest->pNext = NULL;
+    pSendRequest->sent = FALSE;
+
+    MUTEX_LOCK(pSctpSession->sendLock);
+    if (pSctpSession->pSendQueueTail == NULL) {
+        pSctpSession->pSendQueueHead = pSendRequest;
+    } else {
+        pSctpSession->pSendQueueTail->pNext = pSendRequest;
     }
-    if ((pSctpSession->packet[1] & DCEP_DATA_CHANNEL_REXMIT) != 0) {
-        pSctpSession->spa.sendv_prinfo.pr_policy = SCTP_PR_SCTP_RTX;
-        pSctpSession->spa.sendv_prinfo.pr_value = getUnalignedInt32BigEndian((PINT32) (pSctpSession->packet + SIZEOF(UINT32)));
+    pSctpSession->pSendQueueTail = pSendRequest;
+
+    while (!pSendRequest->sent) {
+        if (pSctpSession->sendQueueOwned) {
+            CVAR_WAIT(pSctpSession->sendCvar, pSctpSession->sendLock, INFINITE_TIME_VALUE);
+            continue;
+        }
+
+        // This request is still queued as nobody is sending
+        pSctpSession->sendQueueOwned = TRUE;
+        pBatch = pSctpSession->pSendQueueHead;
+        pSctpSession->pSendQueueHead = pSctpSession->pSendQueueTail = NULL;
+        MUTEX_UNLOCK(pSctpSession->sendLock);
+
+        for (pRequest = pBatch; pRequest != NULL; pRequest = pRequest->pNext) {
+            pRequest->status = sctpSessionSendv(pSctpSession, pRequest);
+        }
+
+        MUTEX_LOCK(pSctpSession->sendLock);
+        // Requests are gone as soon as their thread sees them sent
+        for (pRequest = pBatch; pRequest != NULL; pRequest = pNext) {
+            pNext = pRequest->pNext;
+            pRequest->sent = TRUE;
+        }
+        pSctpSession->sendQueueOwned = FALSE;
+        CVAR_BROADCAST(pSctpSession->sendCvar);
     }
-    if ((pSctpSession->packet[1] & DCEP_DATA_CHANNEL_TIMED) != 0) {
-        pSctpSession->spa.sendv_prinfo.pr_policy = SCTP_PR_SCTP_TTL;
-        pSctpSession->spa.sendv_prinfo.pr_value = getUnalignedInt32BigEndian((PINT32) (pSctpSession->packet + SIZEOF(UINT32)));
+
+    retStatus = pSendRequest->status;
+    MUTEX_UNLOCK(pSctpSession->sendLock);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS sctpSessionPrepareSendInfo(UINT32 streamId, UINT32 ppid, PRtcDataChannelInit pRtcDataChannelInit, struct sctp_sendv_spa* pSpa)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pSpa != NULL, STATUS_NULL_ARG);
+
+    MEMSET(pSpa, 0x00, SIZEOF(struct sctp_sendv_spa));
+
+    pSpa->sendv_flags |= SCTP_SEND_SNDINFO_VALID;
+    pSpa->sendv_sndinfo.snd_sid = streamId;
+    putInt32((PINT32) &pSpa->sendv_sndinfo.snd_ppid, ppid);
+
+    // Same precedence as in the DATA_CHANNEL_OPEN message of the channel
+    if (pRtcDataChannelInit != NULL) {
+        if (!pRtcDataChannelInit->ordered) {
+            pSpa->sendv_sndinfo.snd_flags |= SCTP_UNORDERED;
+        }
+        if (pRtcDataChannelInit->maxRetransmits.value >= 0 && pRtcDataChannelInit->maxRetransmits.isNull == FALSE) {
+            pSpa->sendv_flags |= SCTP_SEND_PRINFO_VALID;
+            pSpa->sendv_prinfo.pr_policy = SCTP_PR_SCTP_RTX;
+            pSpa->sendv_prinfo.pr_value = pRtcDataChannelInit->maxRetransmits.value;
+        } else if (pRtcDataChannelInit->maxPacketLifeTime.value >= 0 && pRtcDataChannelInit->maxPacketLifeTime.isNull == FALSE) {
+            pSpa->sendv_flags |= SCTP_SEND_PRINFO_VALID;
+            pSpa->sendv_prinfo.pr_policy = SCTP_PR_SCTP_TTL;
+            pSpa->sendv_prinfo.pr_value = pRtcDataChannelInit->maxPacketLifeTime.value;
+        }
     }
 
-    putInt32((PINT32) &pSctpSession->spa.sendv_sndinfo.snd_ppid, isBinary ? SCTP_PPID_BINARY : SCTP_PPID_STRING);
-    CHK(usrsctp_sendv(pSctpSession->socket, pMessage, pMessageLen, NULL, 0, &pSctpSession->spa, SIZEOF(pSctpSession->spa), SCTP_SENDV_SPA, 0) > 0,
-        STATUS_INTERNAL_ERROR);
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+STATUS sctpSessionWriteMessage(PSctpSession pSctpSession, UINT32 streamId, BOOL isBinary, PRtcDataChannelInit pRtcDataChannelInit, PBYTE pMessage,
+                               UINT32 pMessageLen)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    SctpSendRequest sendRequest;
+
+    CHK(pSctpSession != NULL && pMessage != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(sctpSessionPrepareSendInfo(streamId, isBinary ? SCTP_PPID_BINARY : SCTP_PPID_STRING, pRtcDataChannelInit, &sendRequest.spa));
+    sendRequest.tracked = TRUE;
+    sendRequest.pMessage = pMessage;
+    sendRequest.messageLen = pMessageLen;
+    CHK_STATUS(sctpSessionQueueSend(pSctpSession, &sendRequest));
 
 CleanUp:
     LEAVES();
@@ -221,18 +416,19 @@ STATUS sctpSessionWriteDcep(PSctpSession pSctpSession, UINT32 streamId, PCHAR pC
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
+    BYTE packet[SCTP_MAX_ALLOWABLE_PACKET_LENGTH];
+    SctpSendRequest sendRequest;
 
     CHK(pSctpSession != NULL && pChannelName != NULL, STATUS_NULL_ARG);
+    CHK(pChannelNameLen <= MAX_DATA_CHANNEL_NAME_LEN, STATUS_INVALID_ARG);
 
-    MEMSET(&pSctpSession->spa, 0x00, SIZEOF(struct sctp_sendv_spa));
-    MEMSET(pSctpSession->packet, 0x00, SIZEOF(pSctpSession->packet));
-    pSctpSession->packetSize = SCTP_DCEP_HEADER_LENGTH + pChannelNameLen;
+    MEMSET(packet, 0x00, SIZEOF(packet));
     /* Setting the fields of DATA_CHANNEL_OPEN message */
 
-    pSctpSession->packet[0] = DCEP_DATA_CHANNEL_OPEN; // message type
+    packet[0] = DCEP_DATA_CHANNEL_OPEN; // message type
 
     // Set Channel type based on supplied parameters
-    pSctpSession->packet[1] = DCEP_DATA_CHANNEL_RELIABLE_ORDERED;
+    packet[1] = DCEP_DATA_CHANNEL_RELIABLE_ORDERED;
 
     //   Set channel type and reliability parameters based on input
     //   SCTP allows fine tuning the channel robustness:
@@ -244,58 +440,411 @@ STATUS sctpSessionWriteDcep(PSctpSession pSctpSession, UINT32 streamId, PCHAR pC
     //   Default values for the parameters is 0. This falls back to reliable channel
 
     if (!pRtcDataChannelInit->ordered) {
-        pSctpSession->packet[1] |= DCEP_DATA_CHANNEL_RELIABLE_UNORDERED;
+        packet[1] |= DCEP_DATA_CHANNEL_RELIABLE_UNORDERED;
     }
     if (pRtcDataChannelInit->maxRetransmits.value >= 0 && pRtcDataChannelInit->maxRetransmits.isNull == FALSE) {
-        pSctpSession->packet[1] |= DCEP_DATA_CHANNEL_REXMIT;
-        putUnalignedInt32BigEndian(pSctpSession->packet + SIZEOF(UINT32), pRtcDataChannelInit->maxRetransmits.value);
+        packet[1] |= DCEP_DATA_CHANNEL_REXMIT;
+        putUnalignedInt32BigEndian(packet + SIZEOF(UINT32), pRtcDataChannelInit->maxRetransmits.value);
     } else if (pRtcDataChannelInit->maxPacketLifeTime.value >= 0 && pRtcDataChannelInit->maxPacketLifeTime.isNull == FALSE) {
-        pSctpSession->packet[1] |= DCEP_DATA_CHANNEL_TIMED;
-        putUnalignedInt32BigEndian(pSctpSession->packet + SIZEOF(UINT32), pRtcDataChannelInit->maxPacketLifeTime.value);
+        packet[1] |= DCEP_DATA_CHANNEL_TIMED;
+        putUnalignedInt32BigEndian(packet + SIZEOF(UINT32), pRtcDataChannelInit->maxPacketLifeTime.value);
+    }
+
+    putUnalignedInt16BigEndian(packet + SCTP_DCEP_LABEL_LEN_OFFSET, pChannelNameLen);
+    MEMCPY(packet + SCTP_DCEP_LABEL_OFFSET, pChannelName, pChannelNameLen);
+
+    // DCEP messages are always sent reliably and in order
+    CHK_STATUS(sctpSessionPrepareSendInfo(streamId, SCTP_PPID_DCEP, NULL, &sendRequest.spa));
+    sendRequest.tracked = FALSE;
+    sendRequest.pMessage = packet;
+    sendRequest.messageLen = SCTP_DCEP_HEADER_LENGTH + pChannelNameLen;
+    CHK_STATUS(sctpSessionQueueSend(pSctpSession, &sendRequest));
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+// https://www.rfc-editor.org/rfc/rfc8832#section-5.2, the message type is all of DATA_CHANNEL_ACK
+STATUS sctpSessionWriteDcepAck(PSctpSession pSctpSession, UINT32 streamId)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE packet = DCEP_DATA_CHANNEL_ACK;
+    SctpSendRequest sendRequest;
+
+    CHK(pSctpSession != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(sctpSessionPrepareSendInfo(streamId, SCTP_PPID_DCEP, NULL, &sendRequest.spa));
+    sendRequest.tracked = FALSE;
+    sendRequest.pMessage = &packet;
+    sendRequest.messageLen = SIZEOF(packet);
+    CHK_STATUS(sctpSessionQueueSend(pSctpSession, &sendRequest));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+// Requests the reset of all pending outgoing streams at once, unless a request is outstanding already.
+// streamResetLock is held by the caller
+STATUS sctpSessionSendStreamResets(PSctpSession pSctpSession)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    struct sctp_reset_streams* pResetStreams = NULL;
+    UINT32 streamCount = 0, size, i;
+    UINT64 streamId;
+
+    CHK(!pSctpSession->streamResetOutstanding, retStatus);
+    CHK_STATUS(stackQueueGetCount(pSctpSession->pPendingStreamResets, &streamCount));
+    CHK(streamCount > 0, retStatus);
+
+    size = SIZEOF(struct sctp_reset_streams) + streamCount * SIZEOF(UINT16);
+    CHK(NULL != (pResetStreams = (struct sctp_reset_streams*) MEMCALLOC(1, size)), STATUS_NOT_ENOUGH_MEMORY);
+    pResetStreams->srs_flags = SCTP_STREAM_RESET_OUTGOING;
+    pResetStreams->srs_number_streams = (UINT16) streamCount;
+    for (i = 0; i < streamCount; i++) {
+        CHK_STATUS(stackQueueDequeue(pSctpSession->pPendingStreamResets, &streamId));
+        pResetStreams->srs_stream_list[i] = (UINT16) streamId;
+    }
+
+    if (usrsctp_setsockopt(pSctpSession->socket, IPPROTO_SCTP, SCTP_RESET_STREAMS, pResetStreams, (socklen_t) size) != 0) {
+        CHK(errno == EALREADY || errno == EAGAIN, STATUS_SCTP_STREAM_RESET_FAILED);
+        // usrsctp has a request outstanding on its own, these streams go with the next one
+        for (i = 0; i < streamCount; i++) {
+            CHK_STATUS(stackQueueEnqueue(pSctpSession->pPendingStreamResets, pResetStreams->srs_stream_list[i]));
+        }
+    }
+
+    pSctpSession->streamResetOutstanding = TRUE;
+
+CleanUp:
+
+    SAFE_MEMFREE(pResetStreams);
+
+    LEAVES();
+    return retStatus;
+}
+
+// Closes the outgoing direction of a DataChannel, https://www.rfc-editor.org/rfc/rfc8831#section-6.7. Messages sent
+// before are delivered first as usrsctp resets the stream once it has nothing queued on it
+STATUS sctpSessionResetStream(PSctpSession pSctpSession, UINT32 streamId)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+
+    CHK(pSctpSession != NULL, STATUS_NULL_ARG);
+    CHK(streamId < SCTP_MAX_STREAM_COUNT, STATUS_INVALID_ARG);
+
+    MUTEX_LOCK(pSctpSession->streamResetLock);
+    locked = TRUE;
+
+    CHK_STATUS(stackQueueEnqueue(pSctpSession->pPendingStreamResets, streamId));
+    CHK_STATUS(sctpSessionSendStreamResets(pSctpSession));
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSctpSession->streamResetLock);
     }
 
-    putUnalignedInt16BigEndian(pSctpSession->packet + SCTP_DCEP_LABEL_LEN_OFFSET, pChannelNameLen);
-    MEMCPY(pSctpSession->packet + SCTP_DCEP_LABEL_OFFSET, pChannelName, pChannelNameLen);
-    pSctpSession->spa.sendv_flags |= SCTP_SEND_SNDINFO_VALID;
-    pSctpSession->spa.sendv_sndinfo.snd_sid = streamId;
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+// Sets the size of the SCTP packets sent to the remote peer, common header included
+STATUS sctpSessionSetPacketSize(PSctpSession pSctpSession, UINT32 packetSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    struct sockaddr_conn remoteConn;
+    struct sctp_paddrparams params;
+
+    CHK(pSctpSession != NULL, STATUS_NULL_ARG);
+
+    MEMSET(&params, 0x00, SIZEOF(struct sctp_paddrparams));
+    MEMSET(&remoteConn, 0x00, SIZEOF(struct sockaddr_conn));
+    CHK_STATUS(initSctpAddrConn(pSctpSession, &remoteConn));
+
+    memcpy(&params.spp_address, &remoteConn, SIZEOF(remoteConn));
+    params.spp_flags = SPP_PMTUD_DISABLE;
+    params.spp_pathmtu = packetSize - SCTP_COMMON_HEADER_SIZE;
+    CHK(usrsctp_setsockopt(pSctpSession->socket, IPPROTO_SCTP, SCTP_PEER_ADDR_PARAMS, &params, SIZEOF(params)) == 0,
+        STATUS_SCTP_SESSION_SETUP_FAILED);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+// https://www.rfc-editor.org/rfc/rfc8899#section-6.2.1.2
+//      0                   1                   2                   3
+//      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+//     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//     |   Type = 4    |  Chunk Flags  |       Chunk Length = 20       |
+//     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//     |   Heartbeat Info Type = 1     |      HB Info Length = 16      |
+//     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//     |                 Magic  |  Nonce  |  Probed Size               |
+//     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//     |  Type = 0x84  |  Chunk Flags  |         Chunk Length          |
+//     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//     |                                                               |
+//     |                            Padding                            |
+//     |                                                               |
+//     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// The HEARTBEAT ACK echoes the Heartbeat Info without the padding
+STATUS sctpSessionSendPmtuProbe(PSctpSession pSctpSession, UINT32 verificationTag)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE pPacket = pSctpSession->pProbePacket;
+    UINT32 size = pSctpSession->probedPacketSize, checksum;
+
+    CHK(ATOMIC_LOAD(&pSctpSession->shutdownStatus) == SCTP_SESSION_ACTIVE, retStatus);
+
+    MEMSET(pPacket, 0x00, size);
+    putUnalignedInt16BigEndian(pPacket, SCTP_ASSOCIATION_DEFAULT_PORT);
+    putUnalignedInt16BigEndian(pPacket + 2, SCTP_ASSOCIATION_DEFAULT_PORT);
+    MEMCPY(pPacket + 4, &verificationTag, SIZEOF(UINT32));
+
+    pPacket[SCTP_COMMON_HEADER_SIZE] = SCTP_CHUNK_TYPE_HEARTBEAT;
+    putUnalignedInt16BigEndian(pPacket + SCTP_COMMON_HEADER_SIZE + 2, 4 + SCTP_PMTU_PROBE_INFO_LENGTH);
+    putUnalignedInt16BigEndian(pPacket + SCTP_COMMON_HEADER_SIZE + 4, SCTP_PARAMETER_TYPE_HEARTBEAT_INFO);
+    putUnalignedInt16BigEndian(pPacket + SCTP_COMMON_HEADER_SIZE + 6, SCTP_PMTU_PROBE_INFO_LENGTH);
+    putUnalignedInt32BigEndian(pPacket + SCTP_COMMON_HEADER_SIZE + 8, SCTP_PMTU_PROBE_MAGIC);
+    putUnalignedInt32BigEndian(pPacket + SCTP_COMMON_HEADER_SIZE + 12, pSctpSession->probeNonce);
+    putUnalignedInt32BigEndian(pPacket + SCTP_COMMON_HEADER_SIZE + 16, size);
+
+    pPacket[SCTP_PMTU_PROBE_HEADER_SIZE] = SCTP_CHUNK_TYPE_PAD;
+    putUnalignedInt16BigEndian(pPacket + SCTP_PMTU_PROBE_HEADER_SIZE + 2, size - SCTP_PMTU_PROBE_HEADER_SIZE);
+
+    // Stored as computed, like usrsctp does
+    checksum = usrsctp_crc32c(pPacket, size);
+    MEMCPY(pPacket + 8, &checksum, SIZEOF(UINT32));
+
+    pSctpSession->sctpSessionCallbacks.outboundPacketFunc(pSctpSession->sctpSessionCallbacks.customData, pPacket, size);
 
-    putInt32((PINT32) &pSctpSession->spa.sendv_sndinfo.snd_ppid, SCTP_PPID_DCEP);
-    CHK(usrsctp_sendv(pSctpSession->socket, pSctpSession->packet, pSctpSession->packetSize, NULL, 0, &pSctpSession->spa, SIZEOF(pSctpSession->spa),
-                      SCTP_SENDV_SPA, 0) > 0,
-        STATUS_INTERNAL_ERROR);
 CleanUp:
 
     LEAVES();
     return retStatus;
 }
 
+// Runs the search for the largest packet the path carries on every packet received, with the nonce of the probe
+// acknowledged by it if any. The first probe is for the largest packet allowed, then the search halves the range
+// left until it is narrower than SCTP_PMTU_SEARCH_STEP. Once complete the search is run again every
+// SCTP_PMTU_RAISE_INTERVAL, confirming the packet size in use first and falling back to the base when the path no
+// longer carries it
+STATUS sctpSessionProbePmtu(PSctpSession pSctpSession, UINT32 ackedProbeNonce)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 currentTime;
+    UINT32 verificationTag, packetSize = 0, range;
+    BOOL locked = FALSE, sendProbe = FALSE, startProbe = FALSE;
+
+    CHK(pSctpSession != NULL, STATUS_NULL_ARG);
+    CHK(pSctpSession->pmtuProbeState != SCTP_PMTU_PROBE_STATE_DISABLED, retStatus);
+    CHK((verificationTag = (UINT32) ATOMIC_LOAD(&pSctpSession->peerVerificationTag)) != 0, retStatus);
+
+    MUTEX_LOCK(pSctpSession->pmtuLock);
+    locked = TRUE;
+    currentTime = GETTIME();
+
+    if (pSctpSession->probedPacketSize != 0) {
+        if (ackedProbeNonce == pSctpSession->probeNonce) {
+            if (pSctpSession->probedPacketSize != pSctpSession->packetSize) {
+                packetSize = pSctpSession->probedPacketSize;
+            }
+            pSctpSession->probedPacketSize = 0;
+            pSctpSession->probeCount = 0;
+        } else if (currentTime >= pSctpSession->probeTime + SCTP_PMTU_PROBE_TIMEOUT) {
+            if (++pSctpSession->probeCount < SCTP_PMTU_MAX_PROBES) {
+                sendProbe = TRUE;
+            } else {
+                if (pSctpSession->probedPacketSize == pSctpSession->packetSize) {
+                    DLOGW("SCTP packets of %u bytes no longer get through, falling back to %u bytes", pSctpSession->packetSize,
+                          pSctpSession->basePacketSize);
+                    packetSize = pSctpSession->basePacketSize;
+                    pSctpSession->searchHighPacketSize = pSctpSession->maxPacketSize;
+                } else {
+                    pSctpSession->searchHighPacketSize = pSctpSession->probedPacketSize - 4;
+                }
+                pSctpSession->probedPacketSize = 0;
+                pSctpSession->probeCount = 0;
+            }
+        }
+    }
+
+    if (packetSize != 0) {
+        CHK_STATUS(sctpSessionSetPacketSize(pSctpSession, packetSize));
+        pSctpSession->packetSize = packetSize;
+        DLOGI("SCTP packets are now up to %u bytes", packetSize);
+    }
+
+    if (pSctpSession->pmtuProbeState == SCTP_PMTU_PROBE_STATE_SEARCH_COMPLETE && currentTime >= pSctpSession->nextSearchTime) {
+        pSctpSession->pmtuProbeState = SCTP_PMTU_PROBE_STATE_SEARCHING;
+        pSctpSession->searchHighPacketSize = pSctpSession->maxPacketSize;
+        if (pSctpSession->packetSize > pSctpSession->basePacketSize) {
+            pSctpSession->probedPacketSize = pSctpSession->packetSize;
+            startProbe = TRUE;
+        }
+    }
+
+    if (pSctpSession->pmtuProbeState == SCTP_PMTU_PROBE_STATE_SEARCHING && pSctpSession->probedPacketSize == 0) {
+        range = pSctpSession->searchHighPacketSize > pSctpSession->packetSize ? pSctpSession->searchHighPacketSize - pSctpSession->packetSize : 0;
+        if (range < SCTP_PMTU_SEARCH_STEP) {
+            pSctpSession->pmtuProbeState = SCTP_PMTU_PROBE_STATE_SEARCH_COMPLETE;
+            pSctpSession->nextSearchTime = currentTime + SCTP_PMTU_RAISE_INTERVAL;
+        } else {
+            pSctpSession->probedPacketSize = pSctpSession->searchHighPacketSize == pSctpSession->maxPacketSize
+                ? pSctpSession->maxPacketSize
+                : pSctpSession->packetSize + ROUND_DOWN(range / 2, 4);
+            startProbe = TRUE;
+        }
+    }
+
+    if (startProbe) {
+        // Retransmissions of a probe share its nonce, the acknowledgement of any of them confirms the size
+        pSctpSession->probeNonce = MAX(pSctpSession->probeNonce + 1, 1);
+        pSctpSession->probeCount = 0;
+    }
+
+    if (startProbe || sendProbe) {
+        pSctpSession->probeTime = currentTime;
+        CHK_STATUS(sctpSessionSendPmtuProbe(pSctpSession, verificationTag));
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSctpSession->pmtuLock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 INT32 onSctpOutboundPacket(PVOID addr, PVOID data, ULONG length, UINT8 tos, UINT8 set_df)
 {
     UNUSED_PARAM(tos);
     UNUSED_PARAM(set_df);
 
     PSctpSession pSctpSession = (PSctpSession) addr;
+    UINT32 verificationTag;
 
     if (pSctpSession == NULL || ATOMIC_LOAD(&pSctpSession->shutdownStatus) == SCTP_SESSION_SHUTDOWN_INITIATED ||
         pSctpSession->sctpSessionCallbacks.outboundPacketFunc == NULL) {
         if (pSctpSession != NULL) {
+            MUTEX_LOCK(pSctpSession->sendLock);
             ATOMIC_STORE(&pSctpSession->shutdownStatus, SCTP_SESSION_SHUTDOWN_COMPLETED);
+            CVAR_BROADCAST(pSctpSession->shutdownCvar);
+            MUTEX_UNLOCK(pSctpSession->sendLock);
         }
         return -1;
     }
 
+    // The association carries data once DATA or SACK chunks are sent, their packets have the verification tag of the remote peer
+    if (ATOMIC_LOAD(&pSctpSession->peerVerificationTag) == 0 && length > SCTP_COMMON_HEADER_SIZE &&
+        (((PBYTE) data)[SCTP_COMMON_HEADER_SIZE] == SCTP_CHUNK_TYPE_DATA || ((PBYTE) data)[SCTP_COMMON_HEADER_SIZE] == SCTP_CHUNK_TYPE_SACK)) {
+        MEMCPY(&verificationTag, (PBYTE) data + 4, SIZEOF(UINT32));
+        ATOMIC_STORE(&pSctpSession->peerVerificationTag, (SIZE_T) verificationTag);
+    }
+
     pSctpSession->sctpSessionCallbacks.outboundPacketFunc(pSctpSession->sctpSessionCallbacks.customData, data, length);
 
     return 0;
 }
 
+// Fired by usrsctp with the free space of the send buffer after every SACK. The bytes no longer in the send buffer
+// are attributed to the oldest messages first. usrsctp interleaves the streams so that is approximate while more
+// than one channel is sending, but every message is reported as drained once the send buffer is empty.
+INT32 onSctpSendSpaceAvailable(struct socket* sock, UINT32 sbFree, PVOID ulpInfo)
+{
+    UNUSED_PARAM(sock);
+    PSctpSession pSctpSession = (PSctpSession) ulpInfo;
+    UINT64 outstanding, buffered, record = 0;
+    UINT32 drained;
+    BOOL empty = TRUE;
+
+    if (pSctpSession == NULL || ATOMIC_LOAD(&pSctpSession->shutdownStatus) != SCTP_SESSION_ACTIVE) {
+        return 0;
+    }
+
+    outstanding = sbFree < pSctpSession->sendBufferSize ? pSctpSession->sendBufferSize - sbFree : 0;
+
+    do {
+        drained = 0;
+        MUTEX_LOCK(pSctpSession->sendLock);
+        // The message being sent may not be in the send buffer yet, its bytes don't count as acknowledged
+        buffered = pSctpSession->bufferedAmount - pSctpSession->sendingMessageLen;
+        if (buffered > outstanding && STATUS_SUCCEEDED(stackQueueIsEmpty(pSctpSession->pSentMessages, &empty)) && !empty &&
+            STATUS_SUCCEEDED(stackQueuePeek(pSctpSession->pSentMessages, &record))) {
+            drained = (UINT32) MIN(SCTP_SENT_MESSAGE_LENGTH(record) - pSctpSession->sentMessageDrained, buffered - outstanding);
+            pSctpSession->bufferedAmount -= drained;
+            pSctpSession->sentMessageDrained += drained;
+            if (pSctpSession->sentMessageDrained == SCTP_SENT_MESSAGE_LENGTH(record)) {
+                stackQueueDequeue(pSctpSession->pSentMessages, &record);
+                pSctpSession->sentMessageDrained = 0;
+            }
+        }
+        MUTEX_UNLOCK(pSctpSession->sendLock);
+
+        // Called without the lock held so that the callback can send again
+        if (drained > 0 && SCTP_SENT_MESSAGE_IS_TRACKED(record) && pSctpSession->sctpSessionCallbacks.dataChannelBufferDrainedFunc != NULL) {
+            pSctpSession->sctpSessionCallbacks.dataChannelBufferDrainedFunc(pSctpSession->sctpSessionCallbacks.customData,
+                                                                            SCTP_SENT_MESSAGE_STREAM_ID(record), drained);
+        }
+    } while (drained > 0);
+
+    return 1;
+}
+
 STATUS putSctpPacket(PSctpSession pSctpSession, PBYTE buf, UINT32 bufLen)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
+    UINT32 ackedProbeNonce = 0, checksum;
+    PBYTE pStrippedPacket = NULL;
+
+    if (pSctpSession->pmtuProbeState != SCTP_PMTU_PROBE_STATE_DISABLED) {
+        if (bufLen >= SCTP_PMTU_PROBE_HEADER_SIZE && buf[SCTP_COMMON_HEADER_SIZE] == SCTP_CHUNK_TYPE_HEARTBEAT_ACK &&
+            (UINT16) getUnalignedInt16BigEndian(buf + SCTP_COMMON_HEADER_SIZE + 2) == 4 + SCTP_PMTU_PROBE_INFO_LENGTH &&
+            (UINT32) getUnalignedInt32BigEndian(buf + SCTP_COMMON_HEADER_SIZE + 8) == SCTP_PMTU_PROBE_MAGIC) {
+            ackedProbeNonce = (UINT32) getUnalignedInt32BigEndian(buf + SCTP_COMMON_HEADER_SIZE + 12);
+        }
+
+        if (STATUS_FAILED(sctpSessionProbePmtu(pSctpSession, ackedProbeNonce))) {
+            DLOGW("Failed to probe the path MTU of the SCTP association");
+        }
+
+        // usrsctp doesn't know the heartbeat of a probe and would drop what is bundled after it, so it only gets the rest
+        if (ackedProbeNonce != 0) {
+            CHK(bufLen > SCTP_PMTU_PROBE_HEADER_SIZE, retStatus);
+            CHK(NULL != (pStrippedPacket = (PBYTE) MEMALLOC(bufLen)), STATUS_NOT_ENOUGH_MEMORY);
+            MEMCPY(pStrippedPacket, buf, SCTP_COMMON_HEADER_SIZE);
+            MEMCPY(pStrippedPacket + SCTP_COMMON_HEADER_SIZE, buf + SCTP_PMTU_PROBE_HEADER_SIZE, bufLen - SCTP_PMTU_PROBE_HEADER_SIZE);
+            bufLen -= SCTP_PMTU_PROBE_HEADER_SIZE - SCTP_COMMON_HEADER_SIZE;
+            MEMSET(pStrippedPacket + 8, 0x00, SIZEOF(UINT32));
+            checksum = usrsctp_crc32c(pStrippedPacket, bufLen);
+            MEMCPY(pStrippedPacket + 8, &checksum, SIZEOF(UINT32));
+            buf = pStrippedPacket;
+        }
+    }
 
     usrsctp_conninput(pSctpSession, buf, bufLen, 0);
 
+CleanUp:
+
+    SAFE_MEMFREE(pStrippedPacket);
+
     LEAVES();
     return retStatus;
 }
@@ -307,19 +856,70 @@ STATUS handleDcepPacket(PSctpSession pSctpSession, UINT32 streamId, PBYTE data,
     UINT16 labelLength = 0;
     UINT16 protocolLength = 0;
 
-    // Assert that is DCEP of type DataChannelOpen
-    CHK(length > SCTP_DCEP_HEADER_LENGTH && data[0] == DCEP_DATA_CHANNEL_OPEN, STATUS_SUCCESS);
+    if (length == 1 && data[0] == DCEP_DATA_CHANNEL_ACK) {
+        if (pSctpSession->sctpSessionCallbacks.dataChannelAckFunc != NULL) {
+            pSctpSession->sctpSessionCallbacks.dataChannelAckFunc(pSctpSession->sctpSessionCallbacks.customData, streamId);
+        }
+        CHK(FALSE, retStatus);
+    }
+
+    // Assert that is DCEP of type DataChannelOpen, label and protocol can both be empty
+    CHK(length >= SCTP_DCEP_HEADER_LENGTH && data[0] == DCEP_DATA_CHANNEL_OPEN, STATUS_SUCCESS);
 
     MEMCPY(&labelLength, data + 8, SIZEOF(UINT16));
     MEMCPY(&protocolLength, data + 10, SIZEOF(UINT16));
     putInt16((PINT16) &labelLength, labelLength);
     putInt16((PINT16) &protocolLength, protocolLength);
 
-    CHK((labelLength + protocolLength + SCTP_DCEP_HEADER_LENGTH) >= length, STATUS_SCTP_INVALID_DCEP_PACKET);
+    // The label and protocol have to fit in the message
+    CHK(SCTP_DCEP_HEADER_LENGTH + labelLength + protocolLength <= length, STATUS_SCTP_INVALID_DCEP_PACKET);
 
     pSctpSession->sctpSessionCallbacks.dataChannelOpenFunc(pSctpSession->sctpSessionCallbacks.customData, streamId, data + SCTP_DCEP_HEADER_LENGTH,
                                                            labelLength);
 
+    CHK_STATUS(sctpSessionWriteDcepAck(pSctpSession, streamId));
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+STATUS handleSctpNotification(PSctpSession pSctpSession, union sctp_notification* pNotification, SIZE_T length)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    struct sctp_stream_reset_event* pStreamResetEvent;
+    UINT32 streamCount, i;
+
+    CHK(length >= SIZEOF(struct sctp_stream_reset_event) && pNotification->sn_header.sn_type == SCTP_STREAM_RESET_EVENT, retStatus);
+
+    pStreamResetEvent = &pNotification->sn_strreset_event;
+    CHK(pStreamResetEvent->strreset_length >= SIZEOF(struct sctp_stream_reset_event), retStatus);
+    streamCount = (UINT32) (MIN(pStreamResetEvent->strreset_length, length) - SIZEOF(struct sctp_stream_reset_event)) / SIZEOF(UINT16);
+
+    if ((pStreamResetEvent->strreset_flags & SCTP_STREAM_RESET_OUTGOING_SSN) != 0) {
+        if ((pStreamResetEvent->strreset_flags & (SCTP_STREAM_RESET_DENIED | SCTP_STREAM_RESET_FAILED)) != 0) {
+            DLOGW("Remote peer did not reset %u outgoing streams, flags 0x%04x", streamCount, pStreamResetEvent->strreset_flags);
+        }
+
+        // The request is answered, streams closed since go with the next one
+        MUTEX_LOCK(pSctpSession->streamResetLock);
+        pSctpSession->streamResetOutstanding = FALSE;
+        retStatus = sctpSessionSendStreamResets(pSctpSession);
+        MUTEX_UNLOCK(pSctpSession->streamResetLock);
+        CHK_STATUS(retStatus);
+    }
+
+    // The remote peer closed these DataChannels
+    if ((pStreamResetEvent->strreset_flags & SCTP_STREAM_RESET_INCOMING_SSN) != 0 &&
+        (pStreamResetEvent->strreset_flags & (SCTP_STREAM_RESET_DENIED | SCTP_STREAM_RESET_FAILED)) == 0 &&
+        pSctpSession->sctpSessionCallbacks.dataChannelCloseFunc != NULL) {
+        for (i = 0; i < streamCount; i++) {
+            pSctpSession->sctpSessionCallbacks.dataChannelCloseFunc(pSctpSession->sctpSessionCallbacks.customData,
+                                                                    pStreamResetEvent->strreset_stream_list[i]);
+        }
+    }
+
 CleanUp:
     LEAVES();
     return retStatus;
@@ -330,11 +930,18 @@ INT32 onSctpInboundPacket(struct socket* sock, union sctp_sockstore addr, PVOID
 {
     UNUSED_PARAM(sock);
     UNUSED_PARAM(addr);
-    UNUSED_PARAM(flags);
     STATUS retStatus = STATUS_SUCCESS;
     PSctpSession pSctpSession = (PSctpSession) ulp_info;
     BOOL isBinary = FALSE;
 
+    // The session is being freed
+    CHK(pSctpSession != NULL, retStatus);
+
+    if ((flags & MSG_NOTIFICATION) != 0) {
+        CHK_STATUS(handleSctpNotification(pSctpSession, (union sctp_notification*) data, length));
+        CHK(FALSE, retStatus);
+    }
+
     rcv.rcv_ppid = ntohl(rcv.rcv_ppid);
     switch (rcv.rcv_ppid) {
         case SCTP_PPID_DCEP:
@@ -346,8 +953,11 @@ INT32 onSctpInboundPacket(struct socket* sock, union sctp_sockstore addr, PVOID
             // fallthrough
         case SCTP_PPID_STRING:
         case SCTP_PPID_STRING_EMPTY:
-            pSctpSession->sctpSessionCallbacks.dataChannelMessageFunc(pSctpSession->sctpSessionCallbacks.customData, rcv.rcv_sid, isBinary, data,
-                                                                      length);
+            if (pSctpSession->sctpSessionCallbacks.dataChannelMessageFunc(pSctpSession->sctpSessionCallbacks.customData, rcv.rcv_sid, isBinary,
+                                                                          data, length)) {
+                // The application releases it with dataChannelFreeMessage
+                data = NULL;
+            }
             break;
         default:
             DLOGI("Unhandled PPID on incoming SCTP message %d", rcv.rcv_ppid);
@@ -11,14 +11,19 @@
 extern "C" {
 #endif
 
-// 1200 - 12 (SCTP header Size)
-#define SCTP_MTU                         1188
+// Size of the SCTP common header, usrsctp adds it to the path MTU of AF_CONN addresses
+#define SCTP_COMMON_HEADER_SIZE 12
+// Smallest SCTP packet the association is set up with
+#define SCTP_MIN_PACKET_SIZE             512
 #define SCTP_ASSOCIATION_DEFAULT_PORT    5000
 #define SCTP_DCEP_HEADER_LENGTH          12
 #define SCTP_DCEP_LABEL_LEN_OFFSET       8
 #define SCTP_DCEP_LABEL_OFFSET           12
 #define SCTP_MAX_ALLOWABLE_PACKET_LENGTH (SCTP_DCEP_HEADER_LENGTH + MAX_DATA_CHANNEL_NAME_LEN + MAX_DATA_CHANNEL_PROTOCOL_LEN + 2)
 
+// Streams offered and accepted in each direction, DataChannel ids are below it
+#define SCTP_MAX_STREAM_COUNT 300
+
 #define SCTP_SESSION_ACTIVE             0
 #define SCTP_SESSION_SHUTDOWN_INITIATED 1
 #define SCTP_SESSION_SHUTDOWN_COMPLETED 2
@@ -27,12 +32,46 @@ extern "C" {
 
 #define DEFAULT_USRSCTP_TEARDOWN_POLLING_INTERVAL (10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
 
+// Search for the largest packet the path carries, https://www.rfc-editor.org/rfc/rfc8899#section-5.1
+// Probes are HEARTBEAT chunks padded to the probed size, answered by the remote peer with a HEARTBEAT ACK
+#define SCTP_PMTU_PROBE_TIMEOUT     (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+#define SCTP_PMTU_MAX_PROBES        3
+#define SCTP_PMTU_SEARCH_STEP       16
+#define SCTP_PMTU_RAISE_INTERVAL    (600 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+#define SCTP_PMTU_PROBE_MAGIC       0x4B56534D
+#define SCTP_PMTU_PROBE_INFO_LENGTH 16
+#define SCTP_PMTU_PROBE_HEADER_SIZE (SCTP_COMMON_HEADER_SIZE + 4 + SCTP_PMTU_PROBE_INFO_LENGTH)
+
+// Record of a message in the send buffer: whether its drained bytes are reported, its stream id and its length
+#define SCTP_SENT_MESSAGE_TRACKED_FLAG ((UINT64) 1 << 63)
+#define SCTP_SENT_MESSAGE_RECORD(tracked, sid, len)                                                                                          \
+    (((tracked) ? SCTP_SENT_MESSAGE_TRACKED_FLAG : 0) | ((UINT64) ((sid) &0xFFFF) << 32) | (UINT64) (UINT32) (len))
+#define SCTP_SENT_MESSAGE_IS_TRACKED(record) (((record) &SCTP_SENT_MESSAGE_TRACKED_FLAG) != 0)
+#define SCTP_SENT_MESSAGE_STREAM_ID(record)  ((UINT32) (((record) >> 32) & 0xFFFF))
+#define SCTP_SENT_MESSAGE_LENGTH(record)     ((UINT32) (record))
+
 enum { SCTP_PPID_DCEP = 50, SCTP_PPID_STRING = 51, SCTP_PPID_BINARY = 53, SCTP_PPID_STRING_EMPTY = 56, SCTP_PPID_BINARY_EMPTY = 57 };
 
 enum {
+    DCEP_DATA_CHANNEL_ACK = 0x02,
     DCEP_DATA_CHANNEL_OPEN = 0x03,
 };
 
+enum {
+    SCTP_CHUNK_TYPE_DATA = 0x00,
+    SCTP_CHUNK_TYPE_SACK = 0x03,
+    SCTP_CHUNK_TYPE_HEARTBEAT = 0x04,
+    SCTP_CHUNK_TYPE_HEARTBEAT_ACK = 0x05,
+    SCTP_CHUNK_TYPE_PAD = 0x84,
+    SCTP_PARAMETER_TYPE_HEARTBEAT_INFO = 0x01,
+};
+
+typedef enum {
+    SCTP_PMTU_PROBE_STATE_DISABLED,
+    SCTP_PMTU_PROBE_STATE_SEARCHING,
+    SCTP_PMTU_PROBE_STATE_SEARCH_COMPLETE,
+} SCTP_PMTU_PROBE_STATE;
+
 typedef enum {
     DCEP_DATA_CHANNEL_RELIABLE_ORDERED = (BYTE) 0x00,
     DCEP_DATA_CHANNEL_RELIABLE_UNORDERED = (BYTE) 0x80,
@@ -48,36 +87,109 @@ typedef VOID (*SctpSessionOutboundPacketFunc)(UINT64, PBYTE, UINT32);
 typedef VOID (*SctpSessionDataChannelOpenFunc)(UINT64, UINT32, PBYTE, UINT32);
 
 // Callback that is fired when SCTP has a DataChannel Message.
-// Argument is ChannelID and Message + Len
-typedef VOID (*SctpSessionDataChannelMessageFunc)(UINT64, UINT32, BOOL, PBYTE, UINT32);
+// Argument is ChannelID and Message + Len, returns TRUE if it took ownership of the message buffer
+typedef BOOL (*SctpSessionDataChannelMessageFunc)(UINT64, UINT32, BOOL, PBYTE, UINT32);
+
+// Callback that is fired when bytes written to a DataChannel have left the SCTP send buffer.
+// Argument is ChannelID and the number of bytes
+typedef VOID (*SctpSessionDataChannelBufferDrainedFunc)(UINT64, UINT32, UINT32);
+
+// Callback that is fired when the remote peer acknowledged the DATA_CHANNEL_OPEN of a DataChannel.
+// Argument is ChannelID
+typedef VOID (*SctpSessionDataChannelAckFunc)(UINT64, UINT32);
+
+// Callback that is fired when the remote peer reset its outgoing stream of a DataChannel.
+// Argument is ChannelID
+typedef VOID (*SctpSessionDataChannelCloseFunc)(UINT64, UINT32);
 
 typedef struct {
     UINT64 customData;
     SctpSessionOutboundPacketFunc outboundPacketFunc;
     SctpSessionDataChannelOpenFunc dataChannelOpenFunc;
     SctpSessionDataChannelMessageFunc dataChannelMessageFunc;
+    SctpSessionDataChannelBufferDrainedFunc dataChannelBufferDrainedFunc;
+    SctpSessionDataChannelAckFunc dataChannelAckFunc;
+    SctpSessionDataChannelCloseFunc dataChannelCloseFunc;
 } SctpSessionCallbacks, *PSctpSessionCallbacks;
 
+// Message waiting to be handed to usrsctp, lives on the stack of the sending thread until it is sent
+typedef struct __SctpSendRequest {
+    struct __SctpSendRequest* pNext;
+    struct sctp_sendv_spa spa;
+    BOOL tracked;
+    PBYTE pMessage;
+    UINT32 messageLen;
+    STATUS status;
+    BOOL sent;
+} SctpSendRequest, *PSctpSendRequest;
+
 typedef struct {
     volatile SIZE_T shutdownStatus;
+    // Signaled with sendLock held once shutdownStatus is SCTP_SESSION_SHUTDOWN_COMPLETED
+    CVAR shutdownCvar;
     struct socket* socket;
-    struct sctp_sendv_spa spa;
-    BYTE packet[SCTP_MAX_ALLOWABLE_PACKET_LENGTH];
-    UINT32 packetSize;
     SctpSessionCallbacks sctpSessionCallbacks;
+
+    // Messages are queued by any thread and handed to usrsctp in order by the one thread that owns the queue at the
+    // time. The lock is only held to queue and dequeue, never while usrsctp sends
+    MUTEX sendLock;
+    CVAR sendCvar;
+    PSctpSendRequest pSendQueueHead;
+    PSctpSendRequest pSendQueueTail;
+    BOOL sendQueueOwned;
+
+    // Messages still in the send buffer, oldest first, and how much of the oldest has been acknowledged
+    PStackQueue pSentMessages;
+    UINT32 sentMessageDrained;
+    UINT64 bufferedAmount;
+    UINT32 sendBufferSize;
+    // Length of the message being handed to usrsctp. Its record is queued already, but none of it can have been
+    // acknowledged yet
+    UINT32 sendingMessageLen;
+
+    // Size of the SCTP packets sent, from basePacketSize up to maxPacketSize as probes confirm the path carries them.
+    // Messages are fragmented for basePacketSize, larger packets bundle more chunks, so that no chunk ever has to be
+    // sent in a packet the path doesn't carry
+    MUTEX pmtuLock;
+    SCTP_PMTU_PROBE_STATE pmtuProbeState;
+    UINT32 basePacketSize;
+    UINT32 maxPacketSize;
+    UINT32 packetSize;
+    UINT32 searchHighPacketSize;
+    UINT32 probedPacketSize;
+    UINT32 probeCount;
+    UINT32 probeNonce;
+    UINT64 probeTime;
+    UINT64 nextSearchTime;
+    PBYTE pProbePacket;
+    // Verification tag of the remote peer, known once the association carries data
+    volatile SIZE_T peerVerificationTag;
+
+    // Outgoing streams to reset, https://www.rfc-editor.org/rfc/rfc6525#section-5.1.2. Only one request can be
+    // outstanding, streams closed in the meantime are reset together with the next one
+    MUTEX streamResetLock;
+    PStackQueue pPendingStreamResets;
+    BOOL streamResetOutstanding;
 } SctpSession, *PSctpSession;
 
 STATUS initSctpSession();
 VOID deinitSctpSession();
-STATUS createSctpSession(PSctpSessionCallbacks, PSctpSession*);
+STATUS createSctpSession(PSctpSessionCallbacks, UINT32, UINT32, PSctpSession*);
 STATUS freeSctpSession(PSctpSession*);
 STATUS putSctpPacket(PSctpSession, PBYTE, UINT32);
-STATUS sctpSessionWriteMessage(PSctpSession, UINT32, BOOL, PBYTE, UINT32);
+STATUS sctpSessionPrepareSendInfo(UINT32, UINT32, PRtcDataChannelInit, struct sctp_sendv_spa*);
+STATUS sctpSessionWriteMessage(PSctpSession, UINT32, BOOL, PRtcDataChannelInit, PBYTE, UINT32);
 STATUS sctpSessionWriteDcep(PSctpSession, UINT32, PCHAR, UINT32, PRtcDataChannelInit);
+STATUS sctpSessionWriteDcepAck(PSctpSession, UINT32);
+STATUS sctpSessionResetStream(PSctpSession, UINT32);
+STATUS sctpSessionSetPacketSize(PSctpSession, UINT32);
+STATUS sctpSessionProbePmtu(PSctpSession, UINT32);
+STATUS handleDcepPacket(PSctpSession, UINT32, PBYTE, SIZE_T);
 
 // Callbacks used by usrsctp
 INT32 onSctpOutboundPacket(PVOID, PVOID, ULONG, UINT8, UINT8);
 INT32 onSctpInboundPacket(struct socket*, union sctp_sockstore, PVOID, ULONG, struct sctp_rcvinfo, INT32, PVOID);
+INT32 onSctpSendSpaceAvailable(struct socket*, UINT32, PVOID);
 
 #ifdef __cplusplus
 }
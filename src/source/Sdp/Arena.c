@@ -0,0 +1,168 @@
+#define LOG_CLASS "SDP"
+#include "../Include_i.h"
+
+#include <stdarg.h>
+
+STATUS resetSessionDescription(PSessionDescription pSessionDescription)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpArenaBlock pBlock, pNext;
+
+    CHK(pSessionDescription != NULL, STATUS_NULL_ARG);
+
+    for (pBlock = pSessionDescription->pArena; pBlock != NULL; pBlock = pNext) {
+        pNext = pBlock->pNext;
+        SAFE_MEMFREE(pBlock);
+    }
+
+    MEMSET(pSessionDescription, 0x00, SIZEOF(SessionDescription));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS sdpArenaAllocate(PSessionDescription pSessionDescription, UINT32 size, PCHAR* ppBuffer)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpArenaBlock pBlock = NULL, pHead;
+
+    CHK(pSessionDescription != NULL && ppBuffer != NULL, STATUS_NULL_ARG);
+
+    pHead = pSessionDescription->pArena;
+    if (pHead != NULL && pHead->size - pHead->used >= size) {
+        pBlock = pHead;
+    } else {
+        CHK(NULL != (pBlock = (PSdpArenaBlock) MEMALLOC(SIZEOF(SdpArenaBlock) + MAX(size, SDP_ARENA_BLOCK_SIZE))), STATUS_NOT_ENOUGH_MEMORY);
+        pBlock->size = MAX(size, SDP_ARENA_BLOCK_SIZE);
+        pBlock->used = 0;
+
+        // A large allocation is alone in its block, the current one keeps serving the small strings
+        if (pHead != NULL && size > SDP_ARENA_BLOCK_SIZE) {
+            pBlock->pNext = pHead->pNext;
+            pHead->pNext = pBlock;
+        } else {
+            pBlock->pNext = pHead;
+            pSessionDescription->pArena = pBlock;
+        }
+    }
+
+    *ppBuffer = (PCHAR) (pBlock + 1) + pBlock->used;
+    pBlock->used += size;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+static STATUS sdpArenaVPrintf(PSessionDescription pSessionDescription, PCHAR* ppString, PCHAR pFormat, va_list args)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpArenaBlock pHead = pSessionDescription->pArena;
+    PCHAR pString = NULL;
+    UINT32 available = 0;
+    INT32 length;
+    va_list argsCopy;
+
+    // Most strings fit in what is left of the current block, so format there first and only retry when they don't
+    if (pHead != NULL) {
+        pString = (PCHAR) (pHead + 1) + pHead->used;
+        available = pHead->size - pHead->used;
+    }
+
+    va_copy(argsCopy, args);
+    length = vsnprintf(pString, available, pFormat, argsCopy);
+    va_end(argsCopy);
+    CHK(length >= 0, STATUS_INVALID_ARG);
+
+    if ((UINT32) length < available) {
+        pHead->used += (UINT32) length + 1;
+    } else {
+        CHK_STATUS(sdpArenaAllocate(pSessionDescription, (UINT32) length + 1, &pString));
+        vsnprintf(pString, (UINT32) length + 1, pFormat, args);
+    }
+
+    *ppString = pString;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS sdpArenaPrintf(PSessionDescription pSessionDescription, PCHAR* ppString, PCHAR pFormat, ...)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    va_list args;
+
+    CHK(pSessionDescription != NULL && ppString != NULL && pFormat != NULL, STATUS_NULL_ARG);
+
+    va_start(args, pFormat);
+    retStatus = sdpArenaVPrintf(pSessionDescription, ppString, pFormat, args);
+    va_end(args);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS sdpAddSessionAttribute(PSessionDescription pSessionDescription, PCHAR pName, PCHAR pValueFormat, ...)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpAttributes pSdpAttribute;
+    va_list args;
+
+    CHK(pSessionDescription != NULL && pName != NULL, STATUS_NULL_ARG);
+    CHK(pSessionDescription->sessionAttributesCount < MAX_SDP_ATTRIBUTES_COUNT, STATUS_SDP_ATTRIBUTE_MAX_EXCEEDED);
+
+    pSdpAttribute = &pSessionDescription->sdpAttributes[pSessionDescription->sessionAttributesCount];
+    pSdpAttribute->attributeName = pName;
+    pSdpAttribute->attributeValue = EMPTY_STRING;
+    if (pValueFormat != NULL) {
+        va_start(args, pValueFormat);
+        retStatus = sdpArenaVPrintf(pSessionDescription, &pSdpAttribute->attributeValue, pValueFormat, args);
+        va_end(args);
+        CHK_STATUS(retStatus);
+    }
+
+    pSessionDescription->sessionAttributesCount++;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS sdpAddMediaAttribute(PSessionDescription pSessionDescription, PSdpMediaDescription pSdpMediaDescription, PCHAR pName, PCHAR pValueFormat, ...)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpAttributes pSdpAttribute;
+    va_list args;
+
+    CHK(pSessionDescription != NULL && pSdpMediaDescription != NULL && pName != NULL, STATUS_NULL_ARG);
+    CHK(pSdpMediaDescription->mediaAttributesCount < MAX_SDP_ATTRIBUTES_COUNT, STATUS_SDP_ATTRIBUTE_MAX_EXCEEDED);
+
+    pSdpAttribute = &pSdpMediaDescription->sdpAttributes[pSdpMediaDescription->mediaAttributesCount];
+    pSdpAttribute->attributeName = pName;
+    pSdpAttribute->attributeValue = EMPTY_STRING;
+    if (pValueFormat != NULL) {
+        va_start(args, pValueFormat);
+        retStatus = sdpArenaVPrintf(pSessionDescription, &pSdpAttribute->attributeValue, pValueFormat, args);
+        va_end(args);
+        CHK_STATUS(retStatus);
+    }
+
+    pSdpMediaDescription->mediaAttributesCount++;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
@@ -1,14 +1,40 @@
 #define LOG_CLASS "SDP"
 #include "../Include_i.h"
 
+// Terminates the value of a line in place, cutting it to at most maxLength characters
+static PCHAR sdpLineValue(PCHAR pch, UINT32 lineLen, UINT32 maxLength)
+{
+    PCHAR pValue = pch + SDP_ATTRIBUTE_LENGTH;
+
+    pValue[MIN(maxLength, lineLen - SDP_ATTRIBUTE_LENGTH)] = '\0';
+
+    return pValue;
+}
+
+// Splits a=<attribute>:<value> in place, an attribute without a value gets an empty one
+static VOID sdpLineAttribute(PSdpAttributes pSdpAttribute, PCHAR pch, UINT32 lineLen)
+{
+    PCHAR search, pName = pch + SDP_ATTRIBUTE_LENGTH;
+
+    if ((search = STRNCHR(pch, lineLen, ':')) == NULL) {
+        pSdpAttribute->attributeName = sdpLineValue(pch, lineLen, MAX_SDP_ATTRIBUTE_NAME_LENGTH);
+        pSdpAttribute->attributeValue = EMPTY_STRING;
+    } else {
+        *search = '\0';
+        pName[MIN(MAX_SDP_ATTRIBUTE_NAME_LENGTH, (UINT32) (search - pName))] = '\0';
+        search[1 + MIN(MAX_SDP_ATTRIBUTE_VALUE_LENGTH, lineLen - (search - pch + 1))] = '\0';
+        pSdpAttribute->attributeName = pName;
+        pSdpAttribute->attributeValue = search + 1;
+    }
+}
+
 STATUS parseMediaName(PSessionDescription pSessionDescription, PCHAR pch, UINT32 lineLen)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     CHK(pSessionDescription->mediaCount < MAX_SDP_SESSION_MEDIA_COUNT, STATUS_BUFFER_TOO_SMALL);
 
-    STRNCPY(pSessionDescription->mediaDescriptions[pSessionDescription->mediaCount].mediaName, (pch + SDP_ATTRIBUTE_LENGTH),
-            MIN(MAX_SDP_MEDIA_NAME_LENGTH, lineLen - SDP_ATTRIBUTE_LENGTH));
+    pSessionDescription->mediaDescriptions[pSessionDescription->mediaCount].mediaName = sdpLineValue(pch, lineLen, MAX_SDP_MEDIA_NAME_LENGTH);
     pSessionDescription->mediaCount++;
 
 CleanUp:
@@ -20,20 +46,10 @@ STATUS parseSessionAttributes(PSessionDescription pSessionDescription, PCHAR pch
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PCHAR search;
 
     CHK(pSessionDescription->sessionAttributesCount < MAX_SDP_ATTRIBUTES_COUNT, STATUS_SDP_ATTRIBUTE_MAX_EXCEEDED);
 
-    if ((search = STRNCHR(pch, lineLen, ':')) == NULL) {
-        STRNCPY(pSessionDescription->sdpAttributes[pSessionDescription->sessionAttributesCount].attributeName, pch + SDP_ATTRIBUTE_LENGTH,
-                MIN(MAX_SDP_ATTRIBUTE_NAME_LENGTH, lineLen - SDP_ATTRIBUTE_LENGTH));
-    } else {
-        STRNCPY(pSessionDescription->sdpAttributes[pSessionDescription->sessionAttributesCount].attributeName, pch + SDP_ATTRIBUTE_LENGTH,
-                (search - (pch + SDP_ATTRIBUTE_LENGTH)));
-        STRNCPY(pSessionDescription->sdpAttributes[pSessionDescription->sessionAttributesCount].attributeValue, search + 1,
-                MIN(MAX_SDP_ATTRIBUTE_VALUE_LENGTH, lineLen - (search - pch + 1)));
-    }
-
+    sdpLineAttribute(&pSessionDescription->sdpAttributes[pSessionDescription->sessionAttributesCount], pch, lineLen);
     pSessionDescription->sessionAttributesCount++;
 
 CleanUp:
@@ -46,23 +62,12 @@ STATUS parseMediaAttributes(PSessionDescription pSessionDescription, PCHAR pch,
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PCHAR search;
-    UINT16 currentMediaAttributesCount;
+    PSdpMediaDescription pSdpMediaDescription = &pSessionDescription->mediaDescriptions[pSessionDescription->mediaCount - 1];
 
-    currentMediaAttributesCount = pSessionDescription->mediaDescriptions[pSessionDescription->mediaCount - 1].mediaAttributesCount;
+    CHK(pSdpMediaDescription->mediaAttributesCount < MAX_SDP_ATTRIBUTES_COUNT, STATUS_SDP_ATTRIBUTE_MAX_EXCEEDED);
 
-    CHK(currentMediaAttributesCount < MAX_SDP_ATTRIBUTES_COUNT, STATUS_SDP_ATTRIBUTE_MAX_EXCEEDED);
-
-    if ((search = STRNCHR(pch, lineLen, ':')) == NULL) {
-        STRNCPY(pSessionDescription->mediaDescriptions[pSessionDescription->mediaCount - 1].sdpAttributes[currentMediaAttributesCount].attributeName,
-                pch + SDP_ATTRIBUTE_LENGTH, MIN(MAX_SDP_ATTRIBUTE_NAME_LENGTH, lineLen - SDP_ATTRIBUTE_LENGTH));
-    } else {
-        STRNCPY(pSessionDescription->mediaDescriptions[pSessionDescription->mediaCount - 1].sdpAttributes[currentMediaAttributesCount].attributeName,
-                pch + SDP_ATTRIBUTE_LENGTH, (search - (pch + SDP_ATTRIBUTE_LENGTH)));
-        STRNCPY(pSessionDescription->mediaDescriptions[pSessionDescription->mediaCount - 1].sdpAttributes[currentMediaAttributesCount].attributeValue,
-                search + 1, MIN(MAX_SDP_ATTRIBUTE_VALUE_LENGTH, lineLen - (search - pch + 1)));
-    }
-    pSessionDescription->mediaDescriptions[pSessionDescription->mediaCount - 1].mediaAttributesCount++;
+    sdpLineAttribute(&pSdpMediaDescription->sdpAttributes[pSdpMediaDescription->mediaAttributesCount], pch, lineLen);
+    pSdpMediaDescription->mediaAttributesCount++;
 
 CleanUp:
 
@@ -75,11 +80,14 @@ STATUS deserializeSessionDescription(PSessionDescription pSessionDescription, PC
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PCHAR curr, tail, next;
-    UINT32 lineLen;
+    UINT32 lineLen, sdpLen;
     CHK(sdpBytes != NULL, STATUS_SESSION_DESCRIPTION_INVALID_SESSION_DESCRIPTION);
 
-    curr = sdpBytes;
-    tail = sdpBytes + STRLEN(sdpBytes);
+    // The caller's text doesn't outlive the description, so it is copied once and every field points into the copy
+    sdpLen = (UINT32) STRLEN(sdpBytes);
+    CHK_STATUS(sdpArenaAllocate(pSessionDescription, sdpLen + 1, &curr));
+    MEMCPY(curr, sdpBytes, sdpLen + 1);
+    tail = curr + sdpLen;
 
     while ((next = STRNCHR(curr, tail - curr, '\n')) != NULL) {
         lineLen = (UINT32) (next - curr);
@@ -90,46 +98,40 @@ STATUS deserializeSessionDescription(PSessionDescription pSessionDescription, PC
 
         if (0 == STRNCMP(curr, SDP_MEDIA_NAME_MARKER, (ARRAY_SIZE(SDP_MEDIA_NAME_MARKER) - 1))) {
             CHK_STATUS(parseMediaName(pSessionDescription, curr, lineLen));
-        }
-
-        if (pSessionDescription->mediaCount != 0) {
+        } else if (pSessionDescription->mediaCount != 0) {
             if (0 == STRNCMP(curr, SDP_ATTRIBUTE_MARKER, (ARRAY_SIZE(SDP_ATTRIBUTE_MARKER) - 1))) {
                 CHK_STATUS(parseMediaAttributes(pSessionDescription, curr, lineLen));
             }
 
             // Media Title
             if (0 == STRNCMP(curr, SDP_INFORMATION_MARKER, (ARRAY_SIZE(SDP_INFORMATION_MARKER) - 1))) {
-                STRNCPY(pSessionDescription->mediaDescriptions[pSessionDescription->mediaCount - 1].mediaTitle, (curr + SDP_ATTRIBUTE_LENGTH),
-                        MIN(MAX_SDP_MEDIA_NAME_LENGTH, lineLen - SDP_ATTRIBUTE_LENGTH));
+                pSessionDescription->mediaDescriptions[pSessionDescription->mediaCount - 1].mediaTitle =
+                    sdpLineValue(curr, lineLen, MAX_SDP_MEDIA_TITLE_LENGTH);
             }
         } else {
             // SDP Session Name
             if (0 == STRNCMP(curr, SDP_SESSION_NAME_MARKER, (ARRAY_SIZE(SDP_SESSION_NAME_MARKER) - 1))) {
-                STRNCPY(pSessionDescription->sessionName, (curr + SDP_ATTRIBUTE_LENGTH),
-                        MIN(MAX_SDP_MEDIA_NAME_LENGTH, lineLen - SDP_ATTRIBUTE_LENGTH));
+                pSessionDescription->sessionName = sdpLineValue(curr, lineLen, MAX_SDP_SESSION_NAME_LENGTH);
             }
 
             // SDP Session Name
             if (0 == STRNCMP(curr, SDP_INFORMATION_MARKER, (ARRAY_SIZE(SDP_INFORMATION_MARKER) - 1))) {
-                STRNCPY(pSessionDescription->sessionInformation, (curr + SDP_ATTRIBUTE_LENGTH),
-                        MIN(MAX_SDP_MEDIA_NAME_LENGTH, lineLen - SDP_ATTRIBUTE_LENGTH));
+                pSessionDescription->sessionInformation = sdpLineValue(curr, lineLen, MAX_SDP_SESSION_INFORMATION_LENGTH);
             }
 
             // SDP URI
             if (0 == STRNCMP(curr, SDP_URI_MARKER, (ARRAY_SIZE(SDP_URI_MARKER) - 1))) {
-                STRNCPY(pSessionDescription->uri, (curr + SDP_ATTRIBUTE_LENGTH), MIN(MAX_SDP_MEDIA_NAME_LENGTH, lineLen - SDP_ATTRIBUTE_LENGTH));
+                pSessionDescription->uri = sdpLineValue(curr, lineLen, MAX_SDP_SESSION_URI_LENGTH);
             }
 
             // SDP Email Address
             if (0 == STRNCMP(curr, SDP_EMAIL_ADDRESS_MARKER, (ARRAY_SIZE(SDP_EMAIL_ADDRESS_MARKER) - 1))) {
-                STRNCPY(pSessionDescription->emailAddress, (curr + SDP_ATTRIBUTE_LENGTH),
-                        MIN(MAX_SDP_MEDIA_NAME_LENGTH, lineLen - SDP_ATTRIBUTE_LENGTH));
+                pSessionDescription->emailAddress = sdpLineValue(curr, lineLen, MAX_SDP_SESSION_EMAIL_ADDRESS_LENGTH);
             }
 
             // SDP Phone number
             if (0 == STRNCMP(curr, SDP_PHONE_NUMBER_MARKER, (ARRAY_SIZE(SDP_PHONE_NUMBER_MARKER) - 1))) {
-                STRNCPY(pSessionDescription->phoneNumber, (curr + SDP_ATTRIBUTE_LENGTH),
-                        MIN(MAX_SDP_MEDIA_NAME_LENGTH, lineLen - SDP_ATTRIBUTE_LENGTH));
+                pSessionDescription->phoneNumber = sdpLineValue(curr, lineLen, MAX_SDP_SESSION_PHONE_NUMBER_LENGTH);
             }
 
             if (0 == STRNCMP(curr, SDP_VERSION_MARKER, (ARRAY_SIZE(SDP_VERSION_MARKER) - 1))) {
@@ -77,14 +77,31 @@ extern "C" {
 
 #define MAX_SDP_ATTRIBUTES_COUNT 256
 
+// Size of the arena blocks holding the text of a description, larger allocations get a block of their own
+#define SDP_ARENA_BLOCK_SIZE 4096
+
+#define IS_EMPTY_SDP_FIELD(field) ((field) == NULL || (field)[0] == '\0')
+
+/*
+ * Every text field of a SessionDescription is a NULL terminated slice into blocks chained off the description: the copy of
+ * the text it was parsed from, tokenized in place, or the strings written for a description we build.
+ */
+typedef struct __SdpArenaBlock SdpArenaBlock, *PSdpArenaBlock;
+struct __SdpArenaBlock {
+    PSdpArenaBlock pNext;
+    UINT32 size;
+    UINT32 used;
+    // Block data follows
+};
+
 /*
  * c=<nettype> <addrtype> <connection-address>
  * https://tools.ietf.org/html/rfc4566#section-5.7
  */
 typedef struct {
-    CHAR networkType[MAX_SDP_NETWORK_TYPE_LENGTH + 1];
-    CHAR addressType[MAX_SDP_ADDRESS_TYPE_LENGTH + 1];
-    CHAR connectionAddress[MAX_SDP_CONNECTION_ADDRESS_LENGTH + 1];
+    PCHAR networkType;
+    PCHAR addressType;
+    PCHAR connectionAddress;
 } SdpConnectionInformation, *PSdpConnectionInformation;
 
 /*
@@ -92,14 +109,14 @@ typedef struct {
  * https://tools.ietf.org/html/rfc4566#section-5.2
  */
 typedef struct {
-    CHAR userName[MAX_SDP_SESSION_USERNAME_LENGTH + 1];
+    PCHAR userName;
     UINT64 sessionId;
     UINT64 sessionVersion;
     SdpConnectionInformation sdpConnectionInformation;
 } SdpOrigin, *PSdpOrigin;
 
 typedef struct {
-    CHAR sdpBandwidthType[MAX_SDP_BANDWIDTH_LENGTH + 1];
+    PCHAR sdpBandwidthType;
     UINT64 sdpBandwidthValue; // bps
 } SdpBandwidth, *PSdpBandwidth;
 
@@ -118,12 +135,12 @@ typedef struct {
  */
 typedef struct {
     UINT64 adjustmentTime;
-    CHAR offset[MAX_SDP_OFFSET_LENGTH + 1];
+    PCHAR offset;
 } SdpTimeZone, *PSdpTimeZone;
 
 typedef struct {
-    CHAR method[MAX_SDP_ENCRYPTION_KEY_METHOD_LENGTH + 1];
-    CHAR sdpEncryptionKey[MAX_SDP_ENCRYPTION_KEY_LENGTH + 1];
+    PCHAR method;
+    PCHAR sdpEncryptionKey;
 } SdpEncryptionKey, *PSdpEncryptionKey;
 
 /*
@@ -132,18 +149,18 @@ typedef struct {
  * https://tools.ietf.org/html/rfc4566#section-5.13
  */
 typedef struct {
-    CHAR attributeName[MAX_SDP_ATTRIBUTE_NAME_LENGTH + 1];
-    CHAR attributeValue[MAX_SDP_ATTRIBUTE_VALUE_LENGTH + 1];
+    PCHAR attributeName;
+    PCHAR attributeValue;
 } SdpAttributes, *PSdpAttributes;
 
 typedef struct {
     // m=<media> <port>/<number of ports> <proto> <fmt> ...
     // https://tools.ietf.org/html/rfc4566#section-5.14
-    CHAR mediaName[MAX_SDP_MEDIA_NAME_LENGTH + 1];
+    PCHAR mediaName;
 
     // i=<session description>
     // https://tools.ietf.org/html/rfc4566#section-5.4
-    CHAR mediaTitle[MAX_SDP_MEDIA_TITLE_LENGTH + 1];
+    PCHAR mediaTitle;
 
     SdpConnectionInformation sdpConnectionInformation;
 
@@ -153,7 +170,7 @@ typedef struct {
 
     SdpAttributes sdpAttributes[MAX_SDP_ATTRIBUTES_COUNT];
 
-    UINT8 mediaAttributesCount;
+    UINT16 mediaAttributesCount;
 
     UINT8 mediaBandwidthCount;
 } SdpMediaDescription, *PSdpMediaDescription;
@@ -166,23 +183,23 @@ typedef struct {
 
     // s=<session name>
     // https://tools.ietf.org/html/rfc4566#section-5.3
-    CHAR sessionName[MAX_SDP_SESSION_NAME_LENGTH + 1];
+    PCHAR sessionName;
 
     // i=<session description>
     // https://tools.ietf.org/html/rfc4566#section-5.4
-    CHAR sessionInformation[MAX_SDP_SESSION_INFORMATION_LENGTH + 1];
+    PCHAR sessionInformation;
 
     // u=<uri>
     // https://tools.ietf.org/html/rfc4566#section-5.5
-    CHAR uri[MAX_SDP_SESSION_URI_LENGTH + 1];
+    PCHAR uri;
 
     // e=<email-address>
     // https://tools.ietf.org/html/rfc4566#section-5.6
-    CHAR emailAddress[MAX_SDP_SESSION_EMAIL_ADDRESS_LENGTH + 1];
+    PCHAR emailAddress;
 
     // p=<phone-number>
     // https://tools.ietf.org/html/rfc4566#section-5.6
-    CHAR phoneNumber[MAX_SDP_SESSION_PHONE_NUMBER_LENGTH + 1];
+    PCHAR phoneNumber;
 
     SdpConnectionInformation sdpConnectionInformation;
 
@@ -207,6 +224,8 @@ typedef struct {
     UINT8 timeDescriptionCount;
 
     UINT8 bandwidthCount;
+
+    PSdpArenaBlock pArena;
 } SessionDescription, *PSessionDescription;
 
 // Return code maps to an errno just for SDP parsing
@@ -215,10 +234,30 @@ STATUS deserializeSessionDescription(PSessionDescription, PCHAR);
 // Return code maps to a code if we are trying to serialize an invalid session_description
 STATUS serializeSessionDescription(PSessionDescription, PCHAR, PUINT32);
 
+// The lines are tokenized in place, they have to be part of the description's arena
 STATUS parseMediaName(PSessionDescription, PCHAR, UINT32);
 STATUS parseSessionAttributes(PSessionDescription, PCHAR, UINT32);
 STATUS parseMediaAttributes(PSessionDescription, PCHAR, UINT32);
 
+/**
+ * Frees the arena of a SessionDescription and zeroes it so it can be reused
+ */
+STATUS resetSessionDescription(PSessionDescription);
+
+STATUS sdpArenaAllocate(PSessionDescription, UINT32, PCHAR*);
+
+/**
+ * Formats a text field of the description straight into its arena
+ */
+STATUS sdpArenaPrintf(PSessionDescription, PCHAR*, PCHAR, ...);
+
+/**
+ * Append an attribute to the session or to a media section, the value being formatted into the arena. The name is kept as
+ * is and has to live as long as the description, a NULL format leaves the value empty.
+ */
+STATUS sdpAddSessionAttribute(PSessionDescription, PCHAR, PCHAR, ...);
+STATUS sdpAddMediaAttribute(PSessionDescription, PSdpMediaDescription, PCHAR, PCHAR, ...);
+
 #ifdef __cplusplus
 }
 #endif
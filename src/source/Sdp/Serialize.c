@@ -30,8 +30,9 @@ STATUS serializeOrigin(PSdpOrigin pSDPOrigin, PCHAR* ppOutputData, PUINT32 pTota
 
     CHK(pSDPOrigin != NULL, STATUS_NULL_ARG);
 
-    if (pSDPOrigin->userName[0] != '\0' && pSDPOrigin->sdpConnectionInformation.networkType[0] != '\0' &&
-        pSDPOrigin->sdpConnectionInformation.addressType[0] != '\0' && pSDPOrigin->sdpConnectionInformation.connectionAddress[0] != '\0') {
+    if (!IS_EMPTY_SDP_FIELD(pSDPOrigin->userName) && !IS_EMPTY_SDP_FIELD(pSDPOrigin->sdpConnectionInformation.networkType) &&
+        !IS_EMPTY_SDP_FIELD(pSDPOrigin->sdpConnectionInformation.addressType) &&
+        !IS_EMPTY_SDP_FIELD(pSDPOrigin->sdpConnectionInformation.connectionAddress)) {
         currentWriteSize = SNPRINTF(*ppOutputData, (*ppOutputData) == NULL ? 0 : *pBufferSize - *pTotalWritten,
                                     SDP_ORIGIN_MARKER "%s %" PRIu64 " %" PRIu64 " %s %s %s" SDP_LINE_SEPARATOR, pSDPOrigin->userName,
                                     pSDPOrigin->sessionId, pSDPOrigin->sessionVersion, pSDPOrigin->sdpConnectionInformation.networkType,
@@ -56,7 +57,7 @@ STATUS serializeSessionName(PCHAR sessionName, PCHAR* ppOutputData, PUINT32 pTot
     STATUS retStatus = STATUS_SUCCESS;
     UINT32 currentWriteSize = 0;
 
-    if (sessionName[0] != '\0') {
+    if (!IS_EMPTY_SDP_FIELD(sessionName)) {
         currentWriteSize = SNPRINTF(*ppOutputData, (*ppOutputData) == NULL ? 0 : *pBufferSize - *pTotalWritten,
                                     SDP_SESSION_NAME_MARKER "%s" SDP_LINE_SEPARATOR, sessionName);
 
@@ -92,24 +93,38 @@ STATUS serializeTimeDescription(PSdpTimeDescription pSDPTimeDescription, PCHAR*
     return retStatus;
 }
 
+// Copies a slice of the description as is, without the NULL terminator
+static STATUS serializeString(PCHAR pString, PCHAR* ppOutputData, PUINT32 pTotalWritten, PUINT32 pBufferSize)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 currentWriteSize = (UINT32) STRLEN(pString);
+
+    if (*ppOutputData != NULL) {
+        CHK((*pBufferSize - *pTotalWritten) >= currentWriteSize, STATUS_BUFFER_TOO_SMALL);
+        MEMCPY(*ppOutputData, pString, currentWriteSize);
+        *ppOutputData += currentWriteSize;
+    }
+    *pTotalWritten += currentWriteSize;
+
+CleanUp:
+
+    return retStatus;
+}
+
 STATUS serializeAttribute(PSdpAttributes pSDPAttributes, PCHAR* ppOutputData, PUINT32 pTotalWritten, PUINT32 pBufferSize)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 currentWriteSize = 0;
 
-    if (pSDPAttributes->attributeValue[0] == '\0') {
-        currentWriteSize = SNPRINTF(*ppOutputData, (*ppOutputData) == NULL ? 0 : *pBufferSize - *pTotalWritten,
-                                    SDP_ATTRIBUTE_MARKER "%s" SDP_LINE_SEPARATOR, pSDPAttributes->attributeName);
-    } else {
-        currentWriteSize = snprintf(*ppOutputData, (*ppOutputData) == NULL ? 0 : *pBufferSize - *pTotalWritten,
-                                    SDP_ATTRIBUTE_MARKER "%s:%s" SDP_LINE_SEPARATOR, pSDPAttributes->attributeName, pSDPAttributes->attributeValue);
+    CHK_STATUS(serializeString(SDP_ATTRIBUTE_MARKER, ppOutputData, pTotalWritten, pBufferSize));
+    CHK_STATUS(serializeString(pSDPAttributes->attributeName, ppOutputData, pTotalWritten, pBufferSize));
+    if (!IS_EMPTY_SDP_FIELD(pSDPAttributes->attributeValue)) {
+        CHK_STATUS(serializeString(":", ppOutputData, pTotalWritten, pBufferSize));
+        CHK_STATUS(serializeString(pSDPAttributes->attributeValue, ppOutputData, pTotalWritten, pBufferSize));
     }
+    CHK_STATUS(serializeString(SDP_LINE_SEPARATOR, ppOutputData, pTotalWritten, pBufferSize));
 
-    *pTotalWritten += currentWriteSize;
-    if (*ppOutputData != NULL) {
-        *ppOutputData += currentWriteSize;
-    }
+CleanUp:
 
     LEAVES();
     return retStatus;
@@ -119,17 +134,11 @@ STATUS serializeMediaName(PCHAR pMediaName, PCHAR* ppOutputData, PUINT32 pTotalW
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 currentWriteSize = 0;
 
-    if (pMediaName[0] != '\0') {
-        currentWriteSize = snprintf(*ppOutputData, (*ppOutputData) == NULL ? 0 : *pBufferSize - *pTotalWritten,
-                                    SDP_MEDIA_NAME_MARKER "%s" SDP_LINE_SEPARATOR, pMediaName);
-
-        CHK(*ppOutputData == NULL || ((*pBufferSize - *pTotalWritten) >= currentWriteSize), STATUS_BUFFER_TOO_SMALL);
-        *pTotalWritten += currentWriteSize;
-        if (*ppOutputData != NULL) {
-            *ppOutputData += currentWriteSize;
-        }
+    if (!IS_EMPTY_SDP_FIELD(pMediaName)) {
+        CHK_STATUS(serializeString(SDP_MEDIA_NAME_MARKER, ppOutputData, pTotalWritten, pBufferSize));
+        CHK_STATUS(serializeString(pMediaName, ppOutputData, pTotalWritten, pBufferSize));
+        CHK_STATUS(serializeString(SDP_LINE_SEPARATOR, ppOutputData, pTotalWritten, pBufferSize));
     }
 
 CleanUp:
@@ -145,7 +154,8 @@ STATUS serializeMediaConnectionInformation(PSdpConnectionInformation pSdpConnect
     STATUS retStatus = STATUS_SUCCESS;
     UINT32 currentWriteSize = 0;
 
-    if (pSdpConnectionInformation->networkType[0] != '\0') {
+    if (!IS_EMPTY_SDP_FIELD(pSdpConnectionInformation->networkType) && !IS_EMPTY_SDP_FIELD(pSdpConnectionInformation->addressType) &&
+        !IS_EMPTY_SDP_FIELD(pSdpConnectionInformation->connectionAddress)) {
         currentWriteSize = SNPRINTF(*ppOutputData, (*ppOutputData) == NULL ? 0 : *pBufferSize - *pTotalWritten,
                                     SDP_CONNECTION_INFORMATION_MARKER "%s %s %s" SDP_LINE_SEPARATOR, pSdpConnectionInformation->networkType,
                                     pSdpConnectionInformation->addressType, pSdpConnectionInformation->connectionAddress);
@@ -194,6 +204,11 @@ STATUS serializeSessionDescription(PSessionDescription pSessionDescription, PCHA
         }
     }
 
+    // The lines are copied without their terminator
+    if (curr != NULL) {
+        CHK(bufferSize > *sdpBytesLength, STATUS_BUFFER_TOO_SMALL);
+        *curr = '\0';
+    }
     *sdpBytesLength += 1; // NULL terminator
 
 CleanUp:
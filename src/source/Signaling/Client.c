@@ -437,3 +437,21 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS signalingClientGetLatencyMetrics(SIGNALING_CLIENT_HANDLE signalingClientHandle, PLatencyMetrics pLatencyMetrics)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingClient pSignalingClient = FROM_SIGNALING_CLIENT_HANDLE(signalingClientHandle);
+    CHK(pSignalingClient != NULL, STATUS_NULL_ARG);
+    DLOGV("Signaling Client Get Latency Metrics");
+
+    CHK_STATUS(signalingGetLatencyMetrics(pSignalingClient, pLatencyMetrics));
+
+CleanUp:
+    if (pSignalingClient != NULL) {
+        SIGNALING_UPDATE_ERROR_COUNT(pSignalingClient, retStatus);
+    }
+    LEAVES();
+    return retStatus;
+}
@@ -1,29 +1,553 @@
 #define LOG_CLASS "SignalingFileCache"
 #include "../Include_i.h"
 
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 /****************************************************************************************************
- * Content of the caching file will look as follows:
+ * The cache file is a SignalingCacheFileHeader followed by the entries as they are laid out in memory,
+ * the file is mapped and looked up in place. It is never written to once in place, saving writes a new
+ * file next to it and renames that over it.
+ *
+ * Content of the v0 caching file it replaces looks as follows:
  * channelName,role,region,channelARN,httpEndpoint,wssEndpoint,cacheCreationTimestamp\n
  * channelName,role,region,channelARN,httpEndpoint,wssEndpoint,cacheCreationTimestamp\n
  ****************************************************************************************************/
 
-STATUS createFileIfNotExist(PCHAR fileName)
+#define SIGNALING_CACHE_FNV_OFFSET_BASIS 0x811c9dc5U
+#define SIGNALING_CACHE_FNV_PRIME        0x01000193U
+
+// Open addressed slots of the index, twice the entries so that probes stay short
+#define SIGNALING_CACHE_INDEX_SLOT_COUNT (2 * MAX_SIGNALING_CACHE_ENTRY_COUNT)
+
+// Room for the ".<random>.tmp" suffix of the file written before the rename
+#define SIGNALING_CACHE_TEMP_FILE_SUFFIX_LEN 16
+
+typedef struct {
+    BOOL exists;
+    UINT64 fileId;
+    UINT64 size;
+    // Last modification in 100ns
+    UINT64 modificationTime;
+} SignalingCacheFileIdentity, *PSignalingCacheFileIdentity;
+
+/*
+ * Read-only view of a cache file, the entries point into the mapped file. Snapshots are replaced, never changed, when
+ * the file is.
+ */
+typedef struct __SignalingCacheSnapshot {
+    CHAR cacheFilePath[MAX_PATH_LEN + 1];
+    SignalingCacheFileIdentity identity;
+
+    PBYTE pMapping;
+    UINT64 mappingSize;
+
+    UINT32 entryCount;
+    PSignalingFileCacheEntry pEntries;
+
+    // Index of the entry plus one, 0 for an empty slot
+    UINT8 index[SIGNALING_CACHE_INDEX_SLOT_COUNT];
+
+    struct __SignalingCacheSnapshot* pNextRetired;
+} SignalingCacheSnapshot, *PSignalingCacheSnapshot;
+
+typedef struct {
+    // Serializes refreshing and saving, lookups of a file that didn't change don't take it
+    MUTEX lock;
+    // Lookups holding on to a snapshot, replaced snapshots are freed once there are none
+    volatile SIZE_T readerCount;
+    volatile SIZE_T snapshot;
+    PSignalingCacheSnapshot pRetired;
+} SignalingFileCache, *PSignalingFileCache;
+
+// Index shared by all the signaling clients, created on first use
+static volatile SIZE_T gSignalingFileCache = (SIZE_T) NULL;
+
+static STATUS getSignalingFileCache(PSignalingFileCache* ppSignalingFileCache)
 {
-    ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    BOOL fileExist;
+    PSignalingFileCache pSignalingFileCache = (PSignalingFileCache) ATOMIC_LOAD(&gSignalingFileCache);
+    SIZE_T expected = (SIZE_T) NULL;
+
+    if (pSignalingFileCache == NULL) {
+        CHK(NULL != (pSignalingFileCache = (PSignalingFileCache) MEMCALLOC(1, SIZEOF(SignalingFileCache))), STATUS_NOT_ENOUGH_MEMORY);
+        pSignalingFileCache->lock = MUTEX_CREATE(FALSE);
+        // Another client could have raced us to create the index, keep whichever got published first
+        if (!ATOMIC_COMPARE_EXCHANGE(&gSignalingFileCache, &expected, (SIZE_T) pSignalingFileCache)) {
+            MUTEX_FREE(pSignalingFileCache->lock);
+            SAFE_MEMFREE(pSignalingFileCache);
+            pSignalingFileCache = (PSignalingFileCache) expected;
+        }
+    }
+
+    *ppSignalingFileCache = pSignalingFileCache;
+
+CleanUp:
+
+    return retStatus;
+}
+
+static UINT32 signalingCacheEntryHash(PCHAR channelName, PCHAR region, SIGNALING_CHANNEL_ROLE_TYPE role)
+{
+    UINT32 hash = SIGNALING_CACHE_FNV_OFFSET_BASIS;
+    PCHAR pCur;
+
+    // The terminators go into the hash too so that a name and region split differently don't collide
+    for (pCur = channelName;; pCur++) {
+        hash = (hash ^ (UINT8) *pCur) * SIGNALING_CACHE_FNV_PRIME;
+        if (*pCur == '\0') {
+            break;
+        }
+    }
+    for (pCur = region;; pCur++) {
+        hash = (hash ^ (UINT8) *pCur) * SIGNALING_CACHE_FNV_PRIME;
+        if (*pCur == '\0') {
+            break;
+        }
+    }
 
-    CHK_STATUS(fileExists(fileName, &fileExist));
-    if (!fileExist) {
-        CHK_STATUS(createFile(fileName, 0));
+    return (hash ^ (UINT32) role) * SIGNALING_CACHE_FNV_PRIME;
+}
+
+static PSignalingFileCacheEntry signalingCacheSnapshotFind(PSignalingCacheSnapshot pSnapshot, PCHAR channelName, PCHAR region,
+                                                           SIGNALING_CHANNEL_ROLE_TYPE role)
+{
+    UINT32 slot = signalingCacheEntryHash(channelName, region, role) % SIGNALING_CACHE_INDEX_SLOT_COUNT, i;
+    PSignalingFileCacheEntry pEntry;
+
+    // There are always empty slots, the probe ends at one at the latest
+    for (i = 0; i < SIGNALING_CACHE_INDEX_SLOT_COUNT && pSnapshot->index[slot] != 0; i++) {
+        pEntry = &pSnapshot->pEntries[pSnapshot->index[slot] - 1];
+        if (pEntry->role == role && STRCMP(pEntry->channelName, channelName) == 0 && STRCMP(pEntry->region, region) == 0) {
+            return pEntry;
+        }
+        slot = (slot + 1) % SIGNALING_CACHE_INDEX_SLOT_COUNT;
+    }
+
+    return NULL;
+}
+
+static VOID signalingCacheSnapshotBuildIndex(PSignalingCacheSnapshot pSnapshot)
+{
+    PSignalingFileCacheEntry pEntry;
+    UINT32 i, slot;
+
+    for (i = 0; i < pSnapshot->entryCount; i++) {
+        pEntry = &pSnapshot->pEntries[i];
+        // Lookups find the first of duplicate entries like the scan of the file did
+        if (signalingCacheSnapshotFind(pSnapshot, pEntry->channelName, pEntry->region, pEntry->role) != NULL) {
+            continue;
+        }
+        slot = signalingCacheEntryHash(pEntry->channelName, pEntry->region, pEntry->role) % SIGNALING_CACHE_INDEX_SLOT_COUNT;
+        while (pSnapshot->index[slot] != 0) {
+            slot = (slot + 1) % SIGNALING_CACHE_INDEX_SLOT_COUNT;
+        }
+        pSnapshot->index[slot] = (UINT8) (i + 1);
+    }
+}
+
+/*
+ * Saving always puts a new file in place, which is told apart from the mapped one by its inode. The mapping keeps the
+ * inode of its file in use, so a new file can't get the same one. A missing file is an empty cache.
+ */
+static VOID getSignalingCacheFileIdentity(PCHAR cacheFilePath, PSignalingCacheFileIdentity pIdentity)
+{
+#ifndef _WIN32
+    struct stat fileStat;
+#else
+    struct _stat64 fileStat;
+#endif
+
+    MEMSET(pIdentity, 0x00, SIZEOF(SignalingCacheFileIdentity));
+
+#ifndef _WIN32
+    if (stat(cacheFilePath, &fileStat) == 0) {
+        pIdentity->exists = TRUE;
+        pIdentity->fileId = (UINT64) fileStat.st_ino;
+        pIdentity->size = (UINT64) fileStat.st_size;
+#if defined(__APPLE__)
+        pIdentity->modificationTime = (UINT64) fileStat.st_mtimespec.tv_sec * HUNDREDS_OF_NANOS_IN_A_SECOND +
+            (UINT64) fileStat.st_mtimespec.tv_nsec / DEFAULT_TIME_UNIT_IN_NANOS;
+#else
+        pIdentity->modificationTime =
+            (UINT64) fileStat.st_mtim.tv_sec * HUNDREDS_OF_NANOS_IN_A_SECOND + (UINT64) fileStat.st_mtim.tv_nsec / DEFAULT_TIME_UNIT_IN_NANOS;
+#endif
     }
+#else
+    if (_stat64(cacheFilePath, &fileStat) == 0) {
+        pIdentity->exists = TRUE;
+        pIdentity->size = (UINT64) fileStat.st_size;
+        pIdentity->modificationTime = (UINT64) fileStat.st_mtime * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    }
+#endif
+}
+
+static BOOL signalingCacheFileIdentityEquals(PSignalingCacheFileIdentity pFirst, PSignalingCacheFileIdentity pSecond)
+{
+    return pFirst->exists == pSecond->exists && pFirst->fileId == pSecond->fileId && pFirst->size == pSecond->size &&
+        pFirst->modificationTime == pSecond->modificationTime;
+}
+
+static STATUS mapSignalingCacheFile(PCHAR cacheFilePath, PSignalingCacheSnapshot pSnapshot)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+#ifndef _WIN32
+    INT32 fd = -1;
+    struct stat fileStat;
+    PVOID pMapping;
+
+    CHK((fd = open(cacheFilePath, O_RDONLY)) >= 0, STATUS_OPEN_FILE_FAILED);
+    CHK(fstat(fd, &fileStat) == 0, STATUS_READ_FILE_FAILED);
+    // Nothing to map in an empty file
+    CHK(fileStat.st_size > 0, retStatus);
+
+    pMapping = mmap(NULL, (size_t) fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    CHK(pMapping != MAP_FAILED, STATUS_READ_FILE_FAILED);
+    pSnapshot->pMapping = (PBYTE) pMapping;
+    pSnapshot->mappingSize = (UINT64) fileStat.st_size;
+#else
+    UINT64 fileSize = 0;
+
+    // Read into memory instead, once per replacement of the file like the mapping
+    CHK_STATUS(readFile(cacheFilePath, TRUE, NULL, &fileSize));
+    CHK(fileSize > 0, retStatus);
+    CHK(NULL != (pSnapshot->pMapping = (PBYTE) MEMALLOC(fileSize)), STATUS_NOT_ENOUGH_MEMORY);
+    pSnapshot->mappingSize = fileSize;
+    CHK_STATUS(readFile(cacheFilePath, TRUE, pSnapshot->pMapping, &fileSize));
+#endif
 
 CleanUp:
 
-    LEAVES();
+#ifndef _WIN32
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+
     return retStatus;
 }
 
+static VOID unmapSignalingCacheFile(PSignalingCacheSnapshot pSnapshot)
+{
+    if (pSnapshot->pMapping != NULL) {
+#ifndef _WIN32
+        munmap(pSnapshot->pMapping, (size_t) pSnapshot->mappingSize);
+#else
+        MEMFREE(pSnapshot->pMapping);
+#endif
+    }
+
+    pSnapshot->pMapping = NULL;
+    pSnapshot->mappingSize = 0;
+    pSnapshot->pEntries = NULL;
+    pSnapshot->entryCount = 0;
+    MEMSET(pSnapshot->index, 0x00, SIZEOF(pSnapshot->index));
+}
+
+static VOID freeSignalingCacheSnapshot(PSignalingCacheSnapshot* ppSnapshot)
+{
+    if (*ppSnapshot != NULL) {
+        unmapSignalingCacheFile(*ppSnapshot);
+        SAFE_MEMFREE(*ppSnapshot);
+    }
+}
+
+#define SIGNALING_CACHE_FIELD_TERMINATED(field) (MEMCHR((field), '\0', SIZEOF(field)) != NULL)
+
+static BOOL signalingCacheEntryValid(PSignalingFileCacheEntry pEntry)
+{
+    return (pEntry->role == SIGNALING_CHANNEL_ROLE_TYPE_MASTER || pEntry->role == SIGNALING_CHANNEL_ROLE_TYPE_VIEWER) &&
+        SIGNALING_CACHE_FIELD_TERMINATED(pEntry->storageEnabled) && SIGNALING_CACHE_FIELD_TERMINATED(pEntry->channelName) &&
+        SIGNALING_CACHE_FIELD_TERMINATED(pEntry->channelArn) && SIGNALING_CACHE_FIELD_TERMINATED(pEntry->region) &&
+        SIGNALING_CACHE_FIELD_TERMINATED(pEntry->httpsEndpoint) && SIGNALING_CACHE_FIELD_TERMINATED(pEntry->wssEndpoint) &&
+        SIGNALING_CACHE_FIELD_TERMINATED(pEntry->storageStreamArn) && SIGNALING_CACHE_FIELD_TERMINATED(pEntry->webrtcEndpoint);
+}
+
+static BOOL signalingCacheIsBinaryFile(PSignalingCacheSnapshot pSnapshot)
+{
+    SignalingCacheFileHeader header;
+
+    if (pSnapshot->mappingSize < SIZEOF(SignalingCacheFileHeader)) {
+        return FALSE;
+    }
+
+    MEMCPY(&header, pSnapshot->pMapping, SIZEOF(SignalingCacheFileHeader));
+    return header.magic == SIGNALING_CACHE_FILE_MAGIC;
+}
+
+/*
+ * Points the snapshot at the entries of the mapped file. They are only used in place once every string in them is
+ * known to end within its field.
+ */
+static STATUS signalingCacheSnapshotLoadEntries(PSignalingCacheSnapshot pSnapshot)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingCacheFileHeader pHeader = (PSignalingCacheFileHeader) pSnapshot->pMapping;
+    PSignalingFileCacheEntry pEntries;
+    UINT32 i;
+
+    CHK(pSnapshot->mappingSize >= SIZEOF(SignalingCacheFileHeader), STATUS_INVALID_ARG);
+    CHK(pHeader->magic == SIGNALING_CACHE_FILE_MAGIC && pHeader->version == SIGNALING_CACHE_FILE_VERSION &&
+            pHeader->entrySize == SIZEOF(SignalingFileCacheEntry) && pHeader->entryCount <= MAX_SIGNALING_CACHE_ENTRY_COUNT &&
+            pSnapshot->mappingSize == SIZEOF(SignalingCacheFileHeader) + (UINT64) pHeader->entryCount * SIZEOF(SignalingFileCacheEntry),
+        STATUS_INVALID_ARG);
+
+    pEntries = (PSignalingFileCacheEntry) (pSnapshot->pMapping + SIZEOF(SignalingCacheFileHeader));
+    for (i = 0; i < pHeader->entryCount; i++) {
+        CHK(signalingCacheEntryValid(&pEntries[i]), STATUS_INVALID_ARG);
+    }
+
+    pSnapshot->pEntries = pEntries;
+    pSnapshot->entryCount = pHeader->entryCount;
+    signalingCacheSnapshotBuildIndex(pSnapshot);
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Writes the entries next to the cache file and renames the new file over it, readers see either the old file or the
+ * new one in full
+ */
+static STATUS writeSignalingCacheFile(PCHAR cacheFilePath, PSignalingFileCacheEntry pEntries, UINT32 entryCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    CHAR tempFilePath[MAX_PATH_LEN + SIGNALING_CACHE_TEMP_FILE_SUFFIX_LEN + 1];
+    PSignalingCacheFileHeader pHeader;
+    UINT64 fileSize = SIZEOF(SignalingCacheFileHeader) + (UINT64) entryCount * SIZEOF(SignalingFileCacheEntry);
+    PBYTE pFileBuffer = NULL;
+    BOOL tempFileWritten = FALSE;
+
+    CHK(NULL != (pFileBuffer = (PBYTE) MEMALLOC(fileSize)), STATUS_NOT_ENOUGH_MEMORY);
+    pHeader = (PSignalingCacheFileHeader) pFileBuffer;
+    pHeader->magic = SIGNALING_CACHE_FILE_MAGIC;
+    pHeader->version = SIGNALING_CACHE_FILE_VERSION;
+    pHeader->entrySize = SIZEOF(SignalingFileCacheEntry);
+    pHeader->entryCount = entryCount;
+    if (entryCount > 0) {
+        MEMCPY(pFileBuffer + SIZEOF(SignalingCacheFileHeader), pEntries, (UINT64) entryCount * SIZEOF(SignalingFileCacheEntry));
+    }
+
+    // Processes sharing the cache file each write their own file
+    SNPRINTF(tempFilePath, ARRAY_SIZE(tempFilePath), "%s.%08x.tmp", cacheFilePath, (UINT32) RAND());
+    CHK_STATUS(writeFile(tempFilePath, TRUE, FALSE, pFileBuffer, fileSize));
+    tempFileWritten = TRUE;
+
+#ifndef _WIN32
+    CHK(rename(tempFilePath, cacheFilePath) == 0, STATUS_WRITE_TO_FILE_FAILED);
+#else
+    CHK(MoveFileExA(tempFilePath, cacheFilePath, MOVEFILE_REPLACE_EXISTING), STATUS_WRITE_TO_FILE_FAILED);
+#endif
+    tempFileWritten = FALSE;
+
+CleanUp:
+
+    if (tempFileWritten) {
+        FREMOVE(tempFilePath);
+    }
+
+    SAFE_MEMFREE(pFileBuffer);
+
+    return retStatus;
+}
+
+/*
+ * Rewrites a comma separated cache file into a binary one. The source file is removed when it isn't the cache file
+ * itself, or when it can't be parsed like the v0 loading did.
+ */
+static STATUS migrateSignalingCacheFile(PCHAR sourceFilePath, PCHAR cacheFilePath)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 fileSize = 0;
+    PCHAR fileBuffer = NULL;
+    PSignalingFileCacheEntry pEntries = NULL;
+    UINT32 entryCount = MAX_SIGNALING_CACHE_ENTRY_COUNT;
+
+    DLOGI("Migrating signaling cache file %s to %s", sourceFilePath, cacheFilePath);
+
+    CHK(NULL != (pEntries = (PSignalingFileCacheEntry) MEMCALLOC(MAX_SIGNALING_CACHE_ENTRY_COUNT, SIZEOF(SignalingFileCacheEntry))),
+        STATUS_NOT_ENOUGH_MEMORY);
+    CHK_STATUS(readFile(sourceFilePath, FALSE, NULL, &fileSize));
+
+    if (fileSize > 0) {
+        /* +1 for null terminator */
+        CHK(NULL != (fileBuffer = (PCHAR) MEMCALLOC(1, (fileSize + 1) * SIZEOF(CHAR))), STATUS_NOT_ENOUGH_MEMORY);
+        CHK_STATUS(readFile(sourceFilePath, FALSE, (PBYTE) fileBuffer, &fileSize));
+        CHK_STATUS(deserializeSignalingCacheEntries(fileBuffer, fileSize, pEntries, &entryCount, sourceFilePath));
+    } else {
+        entryCount = 0;
+    }
+
+    CHK_STATUS(writeSignalingCacheFile(cacheFilePath, pEntries, entryCount));
+
+    if (STRCMP(sourceFilePath, cacheFilePath) != 0) {
+        FREMOVE(sourceFilePath);
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    SAFE_MEMFREE(fileBuffer);
+    SAFE_MEMFREE(pEntries);
+
+    return retStatus;
+}
+
+static STATUS createSignalingCacheSnapshot(PCHAR cacheFilePath, PSignalingCacheFileIdentity pIdentity, PSignalingCacheSnapshot* ppSnapshot)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingCacheSnapshot pSnapshot = NULL;
+    PCHAR sourceFilePath = cacheFilePath;
+    BOOL migrate = FALSE;
+
+    CHK(NULL != (pSnapshot = (PSignalingCacheSnapshot) MEMCALLOC(1, SIZEOF(SignalingCacheSnapshot))), STATUS_NOT_ENOUGH_MEMORY);
+    STRNCPY(pSnapshot->cacheFilePath, cacheFilePath, MAX_PATH_LEN);
+    pSnapshot->identity = *pIdentity;
+
+    if (pIdentity->exists) {
+        CHK_STATUS(mapSignalingCacheFile(cacheFilePath, pSnapshot));
+        // Anything else is a file written under a custom path by a release before the binary format
+        migrate = pSnapshot->mappingSize > 0 && !signalingCacheIsBinaryFile(pSnapshot);
+    } else if (STRCMP(cacheFilePath, DEFAULT_CACHE_FILE_PATH) == 0) {
+        CHK_STATUS(fileExists(SIGNALING_CACHE_V0_FILE_PATH, &migrate));
+        sourceFilePath = SIGNALING_CACHE_V0_FILE_PATH;
+    }
+
+    if (migrate) {
+        unmapSignalingCacheFile(pSnapshot);
+        // An unreadable v0 file has been removed, which leaves an empty cache
+        if (STATUS_SUCCEEDED(migrateSignalingCacheFile(sourceFilePath, cacheFilePath))) {
+            CHK_STATUS(mapSignalingCacheFile(cacheFilePath, pSnapshot));
+        }
+        getSignalingCacheFileIdentity(cacheFilePath, &pSnapshot->identity);
+    }
+
+    if (pSnapshot->pMapping != NULL && STATUS_FAILED(signalingCacheSnapshotLoadEntries(pSnapshot))) {
+        // Written by a build with another entry layout or damaged, the next save replaces it
+        DLOGW("Ignoring invalid signaling cache file %s", cacheFilePath);
+        unmapSignalingCacheFile(pSnapshot);
+    }
+
+    *ppSnapshot = pSnapshot;
+    pSnapshot = NULL;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    freeSignalingCacheSnapshot(&pSnapshot);
+
+    return retStatus;
+}
+
+/*
+ * Publishes the snapshot for lookups, the ones it replaces are freed once no lookup can be using them. Called with the
+ * lock held.
+ */
+static VOID publishSignalingCacheSnapshot(PSignalingFileCache pSignalingFileCache, PSignalingCacheSnapshot pSnapshot)
+{
+    PSignalingCacheSnapshot pOldSnapshot = (PSignalingCacheSnapshot) ATOMIC_EXCHANGE(&pSignalingFileCache->snapshot, (SIZE_T) pSnapshot);
+    PSignalingCacheSnapshot pRetired;
+
+    if (pOldSnapshot != NULL) {
+        pOldSnapshot->pNextRetired = pSignalingFileCache->pRetired;
+        pSignalingFileCache->pRetired = pOldSnapshot;
+    }
+
+    // Lookups counted after this point load the new snapshot
+    if (ATOMIC_LOAD(&pSignalingFileCache->readerCount) == 0) {
+        while (pSignalingFileCache->pRetired != NULL) {
+            pRetired = pSignalingFileCache->pRetired;
+            pSignalingFileCache->pRetired = pRetired->pNextRetired;
+            freeSignalingCacheSnapshot(&pRetired);
+        }
+    }
+}
+
+/*
+ * Makes the published snapshot the one of the file as it is now. Called with the lock held.
+ */
+static STATUS refreshSignalingCacheSnapshot(PSignalingFileCache pSignalingFileCache, PCHAR cacheFilePath, PSignalingCacheSnapshot* ppSnapshot)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingCacheSnapshot pSnapshot = (PSignalingCacheSnapshot) ATOMIC_LOAD(&pSignalingFileCache->snapshot);
+    SignalingCacheFileIdentity identity;
+
+    getSignalingCacheFileIdentity(cacheFilePath, &identity);
+
+    if (pSnapshot == NULL || STRCMP(pSnapshot->cacheFilePath, cacheFilePath) != 0 ||
+        !signalingCacheFileIdentityEquals(&pSnapshot->identity, &identity)) {
+        CHK_STATUS(createSignalingCacheSnapshot(cacheFilePath, &identity, &pSnapshot));
+        publishSignalingCacheSnapshot(pSignalingFileCache, pSnapshot);
+    }
+
+    *ppSnapshot = pSnapshot;
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Hands out the snapshot of the file without locking when the file hasn't been replaced since it was mapped, the
+ * snapshot stays valid until releaseSignalingCacheSnapshot
+ */
+static STATUS acquireSignalingCacheSnapshot(PSignalingFileCache pSignalingFileCache, PCHAR cacheFilePath, PSignalingCacheSnapshot* ppSnapshot)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingCacheSnapshot pSnapshot;
+    SignalingCacheFileIdentity identity;
+    BOOL locked = FALSE, counted = FALSE, current = FALSE;
+
+    // Counted before loading the snapshot so that it can't be freed from under us
+    ATOMIC_INCREMENT(&pSignalingFileCache->readerCount);
+    counted = TRUE;
+    pSnapshot = (PSignalingCacheSnapshot) ATOMIC_LOAD(&pSignalingFileCache->snapshot);
+
+    if (pSnapshot != NULL && STRCMP(pSnapshot->cacheFilePath, cacheFilePath) == 0) {
+        getSignalingCacheFileIdentity(cacheFilePath, &identity);
+        current = signalingCacheFileIdentityEquals(&pSnapshot->identity, &identity);
+    }
+
+    if (!current) {
+        // Not counted while refreshing so that the snapshots it retires can be freed right away
+        ATOMIC_DECREMENT(&pSignalingFileCache->readerCount);
+        counted = FALSE;
+
+        MUTEX_LOCK(pSignalingFileCache->lock);
+        locked = TRUE;
+        CHK_STATUS(refreshSignalingCacheSnapshot(pSignalingFileCache, cacheFilePath, &pSnapshot));
+        // Replacing the snapshot takes the lock, it stays until we are counted
+        ATOMIC_INCREMENT(&pSignalingFileCache->readerCount);
+        counted = TRUE;
+    }
+
+    *ppSnapshot = pSnapshot;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && counted) {
+        ATOMIC_DECREMENT(&pSignalingFileCache->readerCount);
+    }
+
+    if (locked) {
+        MUTEX_UNLOCK(pSignalingFileCache->lock);
+    }
+
+    return retStatus;
+}
+
+static VOID releaseSignalingCacheSnapshot(PSignalingFileCache pSignalingFileCache)
+{
+    ATOMIC_DECREMENT(&pSignalingFileCache->readerCount);
+}
+
 STATUS deserializeSignalingCacheEntries(PCHAR cachedFileContent, UINT64 fileSize, PSignalingFileCacheEntry pSignalingFileCacheEntryList,
                                         PUINT32 pEntryCount, PCHAR cacheFilePath)
 {
@@ -46,7 +570,6 @@ STATUS deserializeSignalingCacheEntries(PCHAR cachedFileContent, UINT64 fileSize
                     STRNCPY(pSignalingFileCacheEntryList[entryCount].channelName, pCurrent, nextToken - pCurrent);
                     break;
                 case 1:
-                    STRNCPY(pSignalingFileCacheEntryList[entryCount].region, pCurrent, nextToken - pCurrent);
                     if (STRNCMP(pCurrent, SIGNALING_FILE_CACHE_ROLE_TYPE_MASTER_STR, STRLEN(SIGNALING_FILE_CACHE_ROLE_TYPE_MASTER_STR)) == 0) {
                         pSignalingFileCacheEntryList[entryCount].role = SIGNALING_CHANNEL_ROLE_TYPE_MASTER;
                     } else if (STRNCMP(pCurrent, SIGNALING_FILE_CACHE_ROLE_TYPE_VIEWER_STR, STRLEN(SIGNALING_FILE_CACHE_ROLE_TYPE_VIEWER_STR)) == 0) {
@@ -123,48 +646,34 @@ CleanUp:
     return retStatus;
 }
 
+
 STATUS signalingCacheLoadFromFile(PCHAR channelName, PCHAR region, SIGNALING_CHANNEL_ROLE_TYPE role,
                                   PSignalingFileCacheEntry pSignalingFileCacheEntry, PBOOL pCacheFound, PCHAR cacheFilePath)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT64 fileSize = 0;
-    PCHAR fileBuffer = NULL;
-    SignalingFileCacheEntry entries[MAX_SIGNALING_CACHE_ENTRY_COUNT];
-    UINT32 entryCount = ARRAY_SIZE(entries), i;
-    BOOL cacheFound = FALSE;
+    PSignalingFileCache pSignalingFileCache = NULL;
+    PSignalingCacheSnapshot pSnapshot = NULL;
+    PSignalingFileCacheEntry pEntry;
 
     CHK(channelName != NULL && region != NULL && pSignalingFileCacheEntry != NULL && pCacheFound != NULL && cacheFilePath != NULL, STATUS_NULL_ARG);
     CHK(!IS_EMPTY_STRING(channelName) && !IS_EMPTY_STRING(region), STATUS_INVALID_ARG);
 
-    CHK_STATUS(createFileIfNotExist(cacheFilePath));
-
-    MEMSET(entries, 0x00, SIZEOF(entries));
-
-    CHK_STATUS(readFile(cacheFilePath, FALSE, NULL, &fileSize));
-
-    if (fileSize > 0) {
-        /* +1 for null terminator */
-        fileBuffer = MEMCALLOC(1, (fileSize + 1) * SIZEOF(CHAR));
-        CHK(fileBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
-        CHK_STATUS(readFile(cacheFilePath, FALSE, (PBYTE) fileBuffer, &fileSize));
-
-        CHK_STATUS(deserializeSignalingCacheEntries(fileBuffer, fileSize, entries, &entryCount, cacheFilePath));
+    CHK_STATUS(getSignalingFileCache(&pSignalingFileCache));
+    CHK_STATUS(acquireSignalingCacheSnapshot(pSignalingFileCache, cacheFilePath, &pSnapshot));
 
-        for (i = 0; !cacheFound && i < entryCount; ++i) {
-            /* Assume channel name and region has been validated */
-            if (STRCMP(entries[i].channelName, channelName) == 0 && STRCMP(entries[i].region, region) == 0 && entries[i].role == role) {
-                cacheFound = TRUE;
-                MEMCPY(pSignalingFileCacheEntry, &entries[i], SIZEOF(entries[i]));
-            }
-        }
+    pEntry = signalingCacheSnapshotFind(pSnapshot, channelName, region, role);
+    if (pEntry != NULL) {
+        MEMCPY(pSignalingFileCacheEntry, pEntry, SIZEOF(SignalingFileCacheEntry));
     }
 
-    *pCacheFound = cacheFound;
+    *pCacheFound = pEntry != NULL;
 
 CleanUp:
 
-    SAFE_MEMFREE(fileBuffer);
+    if (pSnapshot != NULL) {
+        releaseSignalingCacheSnapshot(pSignalingFileCache);
+    }
 
     CHK_LOG_ERR(retStatus);
 
@@ -177,41 +686,39 @@ STATUS signalingCacheSaveToFile(PSignalingFileCacheEntry pSignalingFileCacheEntr
     ENTERS();
 
     STATUS retStatus = STATUS_SUCCESS;
-    SignalingFileCacheEntry entries[MAX_SIGNALING_CACHE_ENTRY_COUNT];
-    UINT32 entryCount = ARRAY_SIZE(entries), i, serializedCacheEntryLen;
-    UINT64 fileSize = 0;
-    PCHAR fileBuffer = NULL;
-    BOOL newEntry = TRUE;
-    CHAR serializedCacheEntry[MAX_SERIALIZED_SIGNALING_CACHE_ENTRY_LEN];
+    PSignalingFileCache pSignalingFileCache = NULL;
+    PSignalingCacheSnapshot pSnapshot = NULL;
+    PSignalingFileCacheEntry pEntries = NULL;
+    SignalingCacheFileIdentity identity;
+    UINT32 entryCount, i;
+    BOOL newEntry = TRUE, locked = FALSE;
 
     CHK(cacheFilePath != NULL && pSignalingFileCacheEntry != NULL, STATUS_NULL_ARG);
     CHK(!IS_EMPTY_STRING(pSignalingFileCacheEntry->channelArn) && !IS_EMPTY_STRING(pSignalingFileCacheEntry->channelName) &&
             !IS_EMPTY_STRING(pSignalingFileCacheEntry->region) && !IS_EMPTY_STRING(pSignalingFileCacheEntry->httpsEndpoint) &&
             !IS_EMPTY_STRING(pSignalingFileCacheEntry->wssEndpoint),
         STATUS_INVALID_ARG);
+    CHK(signalingCacheEntryValid(pSignalingFileCacheEntry), STATUS_INVALID_ARG);
 
-    MEMSET(entries, 0x00, SIZEOF(entries));
+    CHK(NULL != (pEntries = (PSignalingFileCacheEntry) MEMCALLOC(MAX_SIGNALING_CACHE_ENTRY_COUNT, SIZEOF(SignalingFileCacheEntry))),
+        STATUS_NOT_ENOUGH_MEMORY);
 
-    CHK_STATUS(createFileIfNotExist(cacheFilePath));
+    CHK_STATUS(getSignalingFileCache(&pSignalingFileCache));
 
-    /* read entire file into buffer */
-    CHK_STATUS(readFile(cacheFilePath, FALSE, NULL, &fileSize));
-    /* deserialize if file is not empty */
-    if (fileSize > 0) {
-        /* +1 for null terminator */
-        fileBuffer = MEMCALLOC(1, (fileSize + 1) * SIZEOF(CHAR));
-        CHK(fileBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
-        CHK_STATUS(readFile(cacheFilePath, FALSE, (PBYTE) fileBuffer, &fileSize));
+    // Saves are serialized so that none of them loses the entry of another
+    MUTEX_LOCK(pSignalingFileCache->lock);
+    locked = TRUE;
 
-        CHK_STATUS(deserializeSignalingCacheEntries(fileBuffer, fileSize, entries, &entryCount, cacheFilePath));
-    } else {
-        entryCount = 0;
+    CHK_STATUS(refreshSignalingCacheSnapshot(pSignalingFileCache, cacheFilePath, &pSnapshot));
+    entryCount = pSnapshot->entryCount;
+    if (entryCount > 0) {
+        MEMCPY(pEntries, pSnapshot->pEntries, entryCount * SIZEOF(SignalingFileCacheEntry));
     }
 
     for (i = 0; i < entryCount; ++i) {
         /* Assume channel name and region has been validated */
-        if (STRCMP(entries[i].channelName, pSignalingFileCacheEntry->channelName) == 0 &&
-            STRCMP(entries[i].region, pSignalingFileCacheEntry->region) == 0 && entries[i].role == pSignalingFileCacheEntry->role) {
+        if (STRCMP(pEntries[i].channelName, pSignalingFileCacheEntry->channelName) == 0 &&
+            STRCMP(pEntries[i].region, pSignalingFileCacheEntry->region) == 0 && pEntries[i].role == pSignalingFileCacheEntry->role) {
             newEntry = FALSE;
             break;
         }
@@ -227,24 +734,80 @@ STATUS signalingCacheSaveToFile(PSignalingFileCacheEntry pSignalingFileCacheEntr
         entryCount++;
     }
 
-    entries[i] = *pSignalingFileCacheEntry;
+    pEntries[i] = *pSignalingFileCacheEntry;
 
-    for (i = 0; i < entryCount; ++i) {
-        serializedCacheEntryLen =
-            SNPRINTF(serializedCacheEntry, ARRAY_SIZE(serializedCacheEntry), "%s,%s,%s,%s,%s,%s,%s,%s,%s,%.10" PRIu64 "\n", entries[i].channelName,
-                     entries[i].role == SIGNALING_CHANNEL_ROLE_TYPE_MASTER ? SIGNALING_FILE_CACHE_ROLE_TYPE_MASTER_STR
-                                                                           : SIGNALING_FILE_CACHE_ROLE_TYPE_VIEWER_STR,
-                     entries[i].region, entries[i].channelArn, entries[i].httpsEndpoint, entries[i].wssEndpoint, entries[i].storageEnabled,
-                     entries[i].storageStreamArn, entries[i].webrtcEndpoint, entries[i].creationTsEpochSeconds);
-        CHK_STATUS(writeFile(cacheFilePath, FALSE, i == 0 ? FALSE : TRUE, (PBYTE) serializedCacheEntry, serializedCacheEntryLen));
+    CHK_STATUS(writeSignalingCacheFile(cacheFilePath, pEntries, entryCount));
+
+    // Map the file just written so that lookups don't have to. Its identity can match the one of the replaced file, the
+    // modification time has a one second resolution on Windows, so the snapshot is always rebuilt
+    getSignalingCacheFileIdentity(cacheFilePath, &identity);
+    CHK_STATUS(createSignalingCacheSnapshot(cacheFilePath, &identity, &pSnapshot));
+    publishSignalingCacheSnapshot(pSignalingFileCache, pSnapshot);
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSignalingFileCache->lock);
+    }
+
+    SAFE_MEMFREE(pEntries);
+
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS signalingCacheGetEntries(PCHAR cacheFilePath, PSignalingFileCacheEntry pSignalingFileCacheEntryList, PUINT32 pEntryCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingFileCache pSignalingFileCache = NULL;
+    PSignalingCacheSnapshot pSnapshot = NULL;
+    UINT32 entryCount = 0;
+
+    CHK(cacheFilePath != NULL && pSignalingFileCacheEntryList != NULL && pEntryCount != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(getSignalingFileCache(&pSignalingFileCache));
+    CHK_STATUS(acquireSignalingCacheSnapshot(pSignalingFileCache, cacheFilePath, &pSnapshot));
+
+    entryCount = MIN(*pEntryCount, pSnapshot->entryCount);
+    if (entryCount > 0) {
+        MEMCPY(pSignalingFileCacheEntryList, pSnapshot->pEntries, entryCount * SIZEOF(SignalingFileCacheEntry));
     }
 
 CleanUp:
 
-    SAFE_MEMFREE(fileBuffer);
+    if (pSnapshot != NULL) {
+        releaseSignalingCacheSnapshot(pSignalingFileCache);
+    }
+
+    if (pEntryCount != NULL) {
+        *pEntryCount = entryCount;
+    }
 
     CHK_LOG_ERR(retStatus);
 
     LEAVES();
     return retStatus;
 }
+
+STATUS deinitSignalingFileCache(VOID)
+{
+    PSignalingFileCache pSignalingFileCache = (PSignalingFileCache) ATOMIC_EXCHANGE(&gSignalingFileCache, (SIZE_T) NULL);
+    PSignalingCacheSnapshot pSnapshot;
+
+    if (pSignalingFileCache != NULL) {
+        pSnapshot = (PSignalingCacheSnapshot) ATOMIC_EXCHANGE(&pSignalingFileCache->snapshot, (SIZE_T) NULL);
+        freeSignalingCacheSnapshot(&pSnapshot);
+        while (pSignalingFileCache->pRetired != NULL) {
+            pSnapshot = pSignalingFileCache->pRetired;
+            pSignalingFileCache->pRetired = pSnapshot->pNextRetired;
+            freeSignalingCacheSnapshot(&pSnapshot);
+        }
+        MUTEX_FREE(pSignalingFileCache->lock);
+        SAFE_MEMFREE(pSignalingFileCache);
+    }
+
+    return STATUS_SUCCESS;
+}
@@ -10,9 +10,11 @@ Signaling internal include file
 extern "C" {
 #endif
 
-/* If SignalingFileCacheEntry layout is changed, change the version in cache file name so we wont read from older
- * cache file. */
-#define DEFAULT_CACHE_FILE_PATH                     (PCHAR) "./.SignalingCache_v0"
+/* The cache file holds SignalingFileCacheEntry records as they are laid out in memory, files written with another
+ * layout or version are migrated. */
+#define DEFAULT_CACHE_FILE_PATH                     (PCHAR) "./.SignalingCache_v1"
+/* Comma separated cache file of the earlier releases, read once to migrate its entries */
+#define SIGNALING_CACHE_V0_FILE_PATH                (PCHAR) "./.SignalingCache_v0"
 #define MAX_SIGNALING_CACHE_ENTRY_TIMESTAMP_STR_LEN 10
 /* Max length for a serialized signaling cache entry. 8 accounts for 6 commas and 1 newline
  * char and null terminator */
@@ -35,10 +37,46 @@ typedef struct {
     CHAR webrtcEndpoint[MAX_SIGNALING_ENDPOINT_URI_LEN + 1];
 } SignalingFileCacheEntry, *PSignalingFileCacheEntry;
 
+#define SIGNALING_CACHE_FILE_MAGIC   0x4356534bU // "KSVC"
+#define SIGNALING_CACHE_FILE_VERSION 1
+
+/*
+ * Start of the binary cache file, followed by entryCount SignalingFileCacheEntry records
+ */
+typedef struct {
+    UINT32 magic;
+    UINT32 version;
+    // SIZEOF(SignalingFileCacheEntry) of the writer
+    UINT32 entrySize;
+    UINT32 entryCount;
+} SignalingCacheFileHeader, *PSignalingCacheFileHeader;
+
+/**
+ * Parses the comma separated entries of the v0 cache file
+ */
 STATUS deserializeSignalingCacheEntries(PCHAR, UINT64, PSignalingFileCacheEntry, PUINT32, PCHAR);
+
+/**
+ * Lookups go through a process wide index of the mapped file without locking, the file is only read again when it was
+ * replaced since.
+ */
 STATUS signalingCacheLoadFromFile(PCHAR, PCHAR, SIGNALING_CHANNEL_ROLE_TYPE, PSignalingFileCacheEntry, PBOOL, PCHAR);
+
+/**
+ * Writes the entries with the given one added or updated into a new file which then replaces the cache file
+ */
 STATUS signalingCacheSaveToFile(PSignalingFileCacheEntry, PCHAR);
 
+/**
+ * Copies out all the entries of the cache file, at most the given count
+ */
+STATUS signalingCacheGetEntries(PCHAR, PSignalingFileCacheEntry, PUINT32);
+
+/*
+ * Drops the in-memory index and unmaps the cache file, no lookup can be in progress
+ */
+STATUS deinitSignalingFileCache(VOID);
+
 #ifdef __cplusplus
 }
 #endif
@@ -230,12 +230,18 @@ struct __LwsCallInfo {
     UINT32 receiveBufferSize;
 };
 
-typedef struct {
+typedef struct __SignalingMessageWrapper {
     // The first member is the public signaling message structure
     ReceivedSignalingMessage receivedSignalingMessage;
 
     // The messaging client object
     PSignalingClient pSignalingClient;
+
+    // Next wrapper on the queue of a dispatcher worker or on the free list
+    struct __SignalingMessageWrapper* pNext;
+
+    // When the message was queued for the worker
+    UINT64 enqueueTime;
 } SignalingMessageWrapper, *PSignalingMessageWrapper;
 
 // Signal handler routine
@@ -271,6 +277,12 @@ STATUS freeLwsCallInfo(PLwsCallInfo*);
 
 PVOID receiveLwsMessageWrapper(PVOID);
 
+/**
+ * Message wrappers come from the free list of the client's message dispatcher, released ones go back to it
+ */
+STATUS getSignalingMessageWrapper(PSignalingClient, PSignalingMessageWrapper*);
+STATUS releaseSignalingMessageWrapper(PSignalingClient, PSignalingMessageWrapper*);
+
 STATUS sendLwsMessage(PSignalingClient, SIGNALING_MESSAGE_TYPE, PCHAR, PCHAR, UINT32, PCHAR, UINT32);
 STATUS writeLwsData(PSignalingClient, BOOL);
 STATUS terminateLwsListenerLoop(PSignalingClient);
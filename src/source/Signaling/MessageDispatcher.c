@@ -0,0 +1,347 @@
+/**
+ * Implementation of the signaling message dispatcher
+ */
+#define LOG_CLASS "SignalingDispatcher"
+#include "../Include_i.h"
+
+PVOID signalingDispatcherWorkerRoutine(PVOID);
+
+// FNV-1a of the peer client id. Messages without a sender, the answers and candidates a viewer receives, all hash the same.
+static UINT32 signalingDispatcherWorkerIndex(PSignalingMessageDispatcher pDispatcher, PSignalingMessageWrapper pSignalingMessageWrapper)
+{
+    PCHAR pCur = pSignalingMessageWrapper->receivedSignalingMessage.signalingMessage.peerClientId;
+    UINT32 hash = 2166136261U;
+
+    while (*pCur != '\0') {
+        hash = (hash ^ (UINT8) *pCur++) * 16777619U;
+    }
+
+    return hash % pDispatcher->workerCount;
+}
+
+// Called with the worker lock held
+static STATUS signalingDispatcherStartWorker(PSignalingDispatcherWorker pWorker)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(!IS_VALID_TID_VALUE(pWorker->threadId), retStatus);
+    CHK_STATUS(THREAD_CREATE(&pWorker->threadId, signalingDispatcherWorkerRoutine, (PVOID) pWorker));
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        pWorker->threadId = INVALID_TID_VALUE;
+    }
+
+    return retStatus;
+}
+
+STATUS createSignalingMessageDispatcher(UINT32 minWorkerCount, UINT32 maxWorkerCount, SignalingDispatchFunc dispatchFn,
+                                        PSignalingMessageDispatcher* ppDispatcher)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingMessageDispatcher pDispatcher = NULL;
+    PSignalingDispatcherWorker pWorker;
+    UINT32 i, workerCount, allocationSize;
+
+    CHK(dispatchFn != NULL && ppDispatcher != NULL, STATUS_NULL_ARG);
+
+    workerCount = maxWorkerCount == 0 ? SIGNALING_DISPATCHER_DEFAULT_WORKER_COUNT : MIN(maxWorkerCount, SIGNALING_DISPATCHER_MAX_WORKER_COUNT);
+
+    allocationSize = SIZEOF(SignalingMessageDispatcher) + workerCount * SIZEOF(SignalingDispatcherWorker);
+    CHK(NULL != (pDispatcher = (PSignalingMessageDispatcher) MEMCALLOC(1, allocationSize)), STATUS_NOT_ENOUGH_MEMORY);
+
+    pDispatcher->dispatchFn = dispatchFn;
+    pDispatcher->workerCount = workerCount;
+    pDispatcher->pWorkers = (PSignalingDispatcherWorker) (pDispatcher + 1);
+    pDispatcher->freeListLock = MUTEX_CREATE(FALSE);
+    pDispatcher->statsLock = MUTEX_CREATE(FALSE);
+    ATOMIC_STORE_BOOL(&pDispatcher->shutdown, FALSE);
+
+    for (i = 0; i < workerCount; i++) {
+        pWorker = &pDispatcher->pWorkers[i];
+        pWorker->pDispatcher = pDispatcher;
+        pWorker->threadId = INVALID_TID_VALUE;
+        pWorker->lock = MUTEX_CREATE(FALSE);
+        pWorker->await = CVAR_CREATE();
+        CHK(IS_VALID_MUTEX_VALUE(pWorker->lock) && IS_VALID_CVAR_VALUE(pWorker->await), STATUS_INVALID_OPERATION);
+    }
+
+    CHK(IS_VALID_MUTEX_VALUE(pDispatcher->freeListLock) && IS_VALID_MUTEX_VALUE(pDispatcher->statsLock), STATUS_INVALID_OPERATION);
+
+    for (i = 0; i < MIN(minWorkerCount, workerCount); i++) {
+        CHK_STATUS(signalingDispatcherStartWorker(&pDispatcher->pWorkers[i]));
+    }
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freeSignalingMessageDispatcher(&pDispatcher);
+    }
+
+    if (ppDispatcher != NULL) {
+        *ppDispatcher = pDispatcher;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeSignalingMessageDispatcher(PSignalingMessageDispatcher* ppDispatcher)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingMessageDispatcher pDispatcher;
+    PSignalingDispatcherWorker pWorker;
+    PSignalingMessageWrapper pSignalingMessageWrapper;
+    UINT32 i;
+
+    CHK(ppDispatcher != NULL, STATUS_NULL_ARG);
+    pDispatcher = *ppDispatcher;
+    CHK(pDispatcher != NULL, retStatus);
+
+    ATOMIC_STORE_BOOL(&pDispatcher->shutdown, TRUE);
+
+    for (i = 0; i < pDispatcher->workerCount; i++) {
+        pWorker = &pDispatcher->pWorkers[i];
+        if (IS_VALID_MUTEX_VALUE(pWorker->lock) && IS_VALID_CVAR_VALUE(pWorker->await)) {
+            MUTEX_LOCK(pWorker->lock);
+            CVAR_BROADCAST(pWorker->await);
+            MUTEX_UNLOCK(pWorker->lock);
+        }
+    }
+
+    // The message being handled is let through, the ones behind it are dropped
+    for (i = 0; i < pDispatcher->workerCount; i++) {
+        pWorker = &pDispatcher->pWorkers[i];
+        if (IS_VALID_TID_VALUE(pWorker->threadId)) {
+            THREAD_JOIN(pWorker->threadId, NULL);
+        }
+
+        while (pWorker->pHead != NULL) {
+            pSignalingMessageWrapper = pWorker->pHead;
+            pWorker->pHead = pSignalingMessageWrapper->pNext;
+            SAFE_MEMFREE(pSignalingMessageWrapper);
+        }
+
+        if (IS_VALID_CVAR_VALUE(pWorker->await)) {
+            CVAR_FREE(pWorker->await);
+        }
+
+        if (IS_VALID_MUTEX_VALUE(pWorker->lock)) {
+            MUTEX_FREE(pWorker->lock);
+        }
+    }
+
+    while (pDispatcher->pFreeList != NULL) {
+        pSignalingMessageWrapper = pDispatcher->pFreeList;
+        pDispatcher->pFreeList = pSignalingMessageWrapper->pNext;
+        SAFE_MEMFREE(pSignalingMessageWrapper);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pDispatcher->freeListLock)) {
+        MUTEX_FREE(pDispatcher->freeListLock);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pDispatcher->statsLock)) {
+        MUTEX_FREE(pDispatcher->statsLock);
+    }
+
+    SAFE_MEMFREE(*ppDispatcher);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+PVOID signalingDispatcherWorkerRoutine(PVOID args)
+{
+    PSignalingDispatcherWorker pWorker = (PSignalingDispatcherWorker) args;
+    PSignalingMessageDispatcher pDispatcher;
+    PSignalingMessageWrapper pSignalingMessageWrapper;
+    UINT64 latency;
+
+    if (pWorker == NULL) {
+        return NULL;
+    }
+
+    pDispatcher = pWorker->pDispatcher;
+
+    for (;;) {
+        MUTEX_LOCK(pWorker->lock);
+        while (pWorker->pHead == NULL && !ATOMIC_LOAD_BOOL(&pDispatcher->shutdown)) {
+            CVAR_WAIT(pWorker->await, pWorker->lock, INFINITE_TIME_VALUE);
+        }
+
+        if (ATOMIC_LOAD_BOOL(&pDispatcher->shutdown)) {
+            MUTEX_UNLOCK(pWorker->lock);
+            break;
+        }
+
+        pSignalingMessageWrapper = pWorker->pHead;
+        pWorker->pHead = pSignalingMessageWrapper->pNext;
+        if (pWorker->pHead == NULL) {
+            pWorker->pTail = NULL;
+        }
+        MUTEX_UNLOCK(pWorker->lock);
+
+        ATOMIC_DECREMENT(&pDispatcher->queueDepth);
+        pSignalingMessageWrapper->pNext = NULL;
+
+        latency = GETTIME() - pSignalingMessageWrapper->enqueueTime;
+        latencyHistogramRecord(&pDispatcher->dispatchLatency, latency);
+        MUTEX_LOCK(pDispatcher->statsLock);
+        pDispatcher->dispatchedCount++;
+        pDispatcher->totalDispatchLatency += latency;
+        pDispatcher->maxDispatchLatency = MAX(pDispatcher->maxDispatchLatency, latency);
+        MUTEX_UNLOCK(pDispatcher->statsLock);
+
+        // The messages of this worker's peers wait until the handler returns
+        pDispatcher->dispatchFn((PVOID) pSignalingMessageWrapper);
+    }
+
+    return NULL;
+}
+
+STATUS signalingDispatcherPush(PSignalingMessageDispatcher pDispatcher, PSignalingMessageWrapper pSignalingMessageWrapper)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingDispatcherWorker pWorker = NULL;
+    SIZE_T queueDepth, maxQueueDepth;
+    BOOL locked = FALSE, queued = FALSE;
+
+    CHK(pDispatcher != NULL && pSignalingMessageWrapper != NULL, STATUS_NULL_ARG);
+    CHK(!ATOMIC_LOAD_BOOL(&pDispatcher->shutdown), STATUS_INVALID_OPERATION);
+
+    queueDepth = ATOMIC_INCREMENT(&pDispatcher->queueDepth) + 1;
+    queued = TRUE;
+    CHK(queueDepth <= SIGNALING_DISPATCHER_MAX_QUEUE_DEPTH, STATUS_SIGNALING_MESSAGE_QUEUE_FULL);
+
+    maxQueueDepth = ATOMIC_LOAD(&pDispatcher->maxQueueDepth);
+    while (queueDepth > maxQueueDepth && !ATOMIC_COMPARE_EXCHANGE(&pDispatcher->maxQueueDepth, &maxQueueDepth, queueDepth)) {
+    }
+
+    pWorker = &pDispatcher->pWorkers[signalingDispatcherWorkerIndex(pDispatcher, pSignalingMessageWrapper)];
+    pSignalingMessageWrapper->pNext = NULL;
+    pSignalingMessageWrapper->enqueueTime = GETTIME();
+
+    MUTEX_LOCK(pWorker->lock);
+    locked = TRUE;
+
+    CHK_STATUS(signalingDispatcherStartWorker(pWorker));
+
+    if (pWorker->pTail == NULL) {
+        pWorker->pHead = pSignalingMessageWrapper;
+    } else {
+        pWorker->pTail->pNext = pSignalingMessageWrapper;
+    }
+    pWorker->pTail = pSignalingMessageWrapper;
+    queued = FALSE;
+
+    CVAR_SIGNAL(pWorker->await);
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pWorker->lock);
+    }
+
+    if (queued) {
+        ATOMIC_DECREMENT(&pDispatcher->queueDepth);
+    }
+
+    return retStatus;
+}
+
+STATUS signalingDispatcherGetWrapper(PSignalingMessageDispatcher pDispatcher, PSignalingMessageWrapper* ppSignalingMessageWrapper)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingMessageWrapper pSignalingMessageWrapper = NULL;
+    PReceivedSignalingMessage pReceivedSignalingMessage;
+
+    CHK(ppSignalingMessageWrapper != NULL, STATUS_NULL_ARG);
+
+    if (pDispatcher != NULL) {
+        MUTEX_LOCK(pDispatcher->freeListLock);
+        pSignalingMessageWrapper = pDispatcher->pFreeList;
+        if (pSignalingMessageWrapper != NULL) {
+            pDispatcher->pFreeList = pSignalingMessageWrapper->pNext;
+            pDispatcher->freeCount--;
+        }
+        MUTEX_UNLOCK(pDispatcher->freeListLock);
+    }
+
+    if (pSignalingMessageWrapper == NULL) {
+        CHK(NULL != (pSignalingMessageWrapper = (PSignalingMessageWrapper) MEMCALLOC(1, SIZEOF(SignalingMessageWrapper))),
+            STATUS_NOT_ENOUGH_MEMORY);
+    } else {
+        // The parser terminates every string it fills in, only what it might leave out needs clearing
+        pReceivedSignalingMessage = &pSignalingMessageWrapper->receivedSignalingMessage;
+        pReceivedSignalingMessage->signalingMessage.version = 0;
+        pReceivedSignalingMessage->signalingMessage.messageType = SIGNALING_MESSAGE_TYPE_OFFER;
+        pReceivedSignalingMessage->signalingMessage.correlationId[0] = '\0';
+        pReceivedSignalingMessage->signalingMessage.peerClientId[0] = '\0';
+        pReceivedSignalingMessage->signalingMessage.payloadLen = 0;
+        pReceivedSignalingMessage->signalingMessage.payload[0] = '\0';
+        pReceivedSignalingMessage->statusCode = (SERVICE_CALL_RESULT) 0;
+        pReceivedSignalingMessage->errorType[0] = '\0';
+        pReceivedSignalingMessage->description[0] = '\0';
+        pSignalingMessageWrapper->pSignalingClient = NULL;
+        pSignalingMessageWrapper->pNext = NULL;
+        pSignalingMessageWrapper->enqueueTime = 0;
+    }
+
+    *ppSignalingMessageWrapper = pSignalingMessageWrapper;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS signalingDispatcherReleaseWrapper(PSignalingMessageDispatcher pDispatcher, PSignalingMessageWrapper* ppSignalingMessageWrapper)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(ppSignalingMessageWrapper != NULL, STATUS_NULL_ARG);
+    CHK(*ppSignalingMessageWrapper != NULL, retStatus);
+
+    if (pDispatcher != NULL) {
+        MUTEX_LOCK(pDispatcher->freeListLock);
+        if (pDispatcher->freeCount < SIGNALING_DISPATCHER_MAX_FREE_WRAPPER_COUNT) {
+            (*ppSignalingMessageWrapper)->pNext = pDispatcher->pFreeList;
+            pDispatcher->pFreeList = *ppSignalingMessageWrapper;
+            pDispatcher->freeCount++;
+            *ppSignalingMessageWrapper = NULL;
+        }
+        MUTEX_UNLOCK(pDispatcher->freeListLock);
+    }
+
+    // The free list is full
+    SAFE_MEMFREE(*ppSignalingMessageWrapper);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS signalingDispatcherGetStats(PSignalingMessageDispatcher pDispatcher, PSignalingDispatcherStats pStats)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pDispatcher != NULL && pStats != NULL, STATUS_NULL_ARG);
+
+    pStats->queueDepth = (UINT32) ATOMIC_LOAD(&pDispatcher->queueDepth);
+    pStats->maxQueueDepth = (UINT32) ATOMIC_LOAD(&pDispatcher->maxQueueDepth);
+
+    MUTEX_LOCK(pDispatcher->statsLock);
+    pStats->dispatchedCount = pDispatcher->dispatchedCount;
+    pStats->averageDispatchLatency = pDispatcher->dispatchedCount == 0 ? 0 : pDispatcher->totalDispatchLatency / pDispatcher->dispatchedCount;
+    pStats->maxDispatchLatency = pDispatcher->maxDispatchLatency;
+    MUTEX_UNLOCK(pDispatcher->statsLock);
+
+CleanUp:
+
+    return retStatus;
+}
@@ -0,0 +1,103 @@
+/*******************************************
+Signaling message dispatcher include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_SIGNALING_MESSAGE_DISPATCHER__
+#define __KINESIS_VIDEO_WEBRTC_SIGNALING_MESSAGE_DISPATCHER__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Workers used when the client info doesn't ask for a number of signaling message threads
+#define SIGNALING_DISPATCHER_DEFAULT_WORKER_COUNT 2
+#define SIGNALING_DISPATCHER_MAX_WORKER_COUNT     16
+
+// Received messages waiting for a worker, across all the workers, before new ones are dropped
+#define SIGNALING_DISPATCHER_MAX_QUEUE_DEPTH 512
+
+// Delivered message wrappers kept on the free list for the next messages
+#define SIGNALING_DISPATCHER_MAX_FREE_WRAPPER_COUNT 16
+
+typedef PVOID (*SignalingDispatchFunc)(PVOID);
+
+typedef struct __SignalingMessageDispatcher* PSignalingMessageDispatcher;
+
+/*
+ * Worker handing the messages of its peers to the application in the order they were received
+ */
+typedef struct {
+    PSignalingMessageDispatcher pDispatcher;
+    MUTEX lock;
+    CVAR await;
+    TID threadId;
+    PSignalingMessageWrapper pHead;
+    PSignalingMessageWrapper pTail;
+} SignalingDispatcherWorker, *PSignalingDispatcherWorker;
+
+typedef struct {
+    UINT32 queueDepth;
+    UINT32 maxQueueDepth;
+    UINT64 dispatchedCount;
+    // Time (in 100 ns) from a message being queued to its handler being called
+    UINT64 averageDispatchLatency;
+    UINT64 maxDispatchLatency;
+} SignalingDispatcherStats, *PSignalingDispatcherStats;
+
+/*
+ * Bounded set of workers the received messages are spread over by peer, so that the messages of a peer are handled one
+ * after the other in the order they arrived. The workers are allocated along with the struct.
+ */
+typedef struct __SignalingMessageDispatcher {
+    volatile ATOMIC_BOOL shutdown;
+    SignalingDispatchFunc dispatchFn;
+
+    UINT32 workerCount;
+    PSignalingDispatcherWorker pWorkers;
+
+    volatile SIZE_T queueDepth;
+    volatile SIZE_T maxQueueDepth;
+    LatencyHistogram dispatchLatency;
+
+    MUTEX freeListLock;
+    PSignalingMessageWrapper pFreeList;
+    UINT32 freeCount;
+
+    MUTEX statsLock;
+    UINT64 dispatchedCount;
+    UINT64 totalDispatchLatency;
+    UINT64 maxDispatchLatency;
+} SignalingMessageDispatcher;
+
+/**
+ * Creates the dispatcher with the given number of workers, the minimum are started right away and the others when a
+ * message first comes for them. Zero maximum means the default. The dispatch function is called with each message
+ * wrapper and owns it from then on.
+ */
+STATUS createSignalingMessageDispatcher(UINT32, UINT32, SignalingDispatchFunc, PSignalingMessageDispatcher*);
+
+/**
+ * Stops the workers, waiting for the messages being handled, and frees the messages still queued. Must not be called
+ * from the dispatch function.
+ */
+STATUS freeSignalingMessageDispatcher(PSignalingMessageDispatcher*);
+
+/**
+ * Queues the message for the worker of its peer. Fails with STATUS_SIGNALING_MESSAGE_QUEUE_FULL when too many messages
+ * are waiting already, the message stays with the caller then.
+ */
+STATUS signalingDispatcherPush(PSignalingMessageDispatcher, PSignalingMessageWrapper);
+
+/**
+ * Wrappers come from the free list when there is one on it, released ones go back to it
+ */
+STATUS signalingDispatcherGetWrapper(PSignalingMessageDispatcher, PSignalingMessageWrapper*);
+STATUS signalingDispatcherReleaseWrapper(PSignalingMessageDispatcher, PSignalingMessageWrapper*);
+
+STATUS signalingDispatcherGetStats(PSignalingMessageDispatcher, PSignalingDispatcherStats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_SIGNALING_MESSAGE_DISPATCHER__ */
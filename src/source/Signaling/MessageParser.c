@@ -0,0 +1,361 @@
+#define LOG_CLASS "SignalingMessageParser"
+#include "../Include_i.h"
+
+#define IS_JSON_WHITESPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\r' || (c) == '\n')
+#define IS_JSON_DELIMITER(c)  (IS_JSON_WHITESPACE(c) || (c) == ',' || (c) == ':' || (c) == '}' || (c) == ']' || (c) == '\0')
+#define IS_JSON_SCALAR(pToken)                                                                                                                       \
+    ((pToken)->type == SIGNALING_JSON_TOKEN_STRING || (pToken)->type == SIGNALING_JSON_TOKEN_PRIMITIVE)
+
+STATUS signalingJsonReaderInit(PSignalingJsonReader pReader, PCHAR pJson, UINT32 jsonLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pReader != NULL && pJson != NULL, STATUS_NULL_ARG);
+
+    MEMSET(pReader, 0x00, SIZEOF(SignalingJsonReader));
+    pReader->pCur = pJson;
+    pReader->pEnd = pJson + jsonLen;
+
+CleanUp:
+
+    return retStatus;
+}
+
+// Scans the string starting at the opening quote, the token gets what is between the quotes
+static STATUS readJsonString(PSignalingJsonReader pReader, PSignalingJsonToken pToken)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PCHAR pCur = pReader->pCur + 1;
+
+    while (pCur < pReader->pEnd && *pCur != '"' && *pCur != '\0') {
+        // The escaped character can't close the string
+        pCur += (*pCur == '\\' && pCur + 1 < pReader->pEnd) ? 2 : 1;
+    }
+    CHK(pCur < pReader->pEnd && *pCur == '"', STATUS_INVALID_API_CALL_RETURN_JSON);
+
+    pToken->pStart = pReader->pCur + 1;
+    pToken->length = (UINT32) (pCur - pToken->pStart);
+    pReader->pCur = pCur + 1;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS signalingJsonReaderNext(PSignalingJsonReader pReader, PSignalingJsonToken pToken)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL inObject, commaRead = FALSE;
+    CHAR c;
+
+    CHK(pReader != NULL && pToken != NULL, STATUS_NULL_ARG);
+
+    MEMSET(pToken, 0x00, SIZEOF(SignalingJsonToken));
+
+    for (;;) {
+        while (pReader->pCur < pReader->pEnd && IS_JSON_WHITESPACE(*pReader->pCur)) {
+            pReader->pCur++;
+        }
+
+        // Like jsmn, the text also ends at a NULL terminator
+        if (pReader->pCur == pReader->pEnd || *pReader->pCur == '\0') {
+            CHK(pReader->depth == 0 && pReader->valueRead && !commaRead, STATUS_INVALID_API_CALL_RETURN_JSON);
+            pToken->type = SIGNALING_JSON_TOKEN_END;
+            CHK(FALSE, retStatus);
+        }
+
+        c = *pReader->pCur;
+        inObject = pReader->depth > 0 && (pReader->objectMask & (1ULL << (pReader->depth - 1))) != 0;
+
+        if (c != ',') {
+            break;
+        }
+
+        CHK(pReader->depth > 0 && pReader->valueRead, STATUS_INVALID_API_CALL_RETURN_JSON);
+        pReader->valueRead = FALSE;
+        commaRead = TRUE;
+        pReader->pCur++;
+    }
+
+    pToken->depth = pReader->depth;
+
+    if (c == '}' || c == ']') {
+        CHK(pReader->depth > 0 && inObject == (c == '}') && !pReader->keyRead && !commaRead, STATUS_INVALID_API_CALL_RETURN_JSON);
+        pReader->pCur++;
+        pReader->depth--;
+        // The container is a value of the enclosing one
+        pReader->valueRead = TRUE;
+        pToken->type = (c == '}') ? SIGNALING_JSON_TOKEN_OBJECT_END : SIGNALING_JSON_TOKEN_ARRAY_END;
+        pToken->depth = pReader->depth;
+        CHK(FALSE, retStatus);
+    }
+
+    CHK(!pReader->valueRead, STATUS_INVALID_API_CALL_RETURN_JSON);
+
+    if (inObject && !pReader->keyRead) {
+        CHK(c == '"', STATUS_INVALID_API_CALL_RETURN_JSON);
+        CHK_STATUS(readJsonString(pReader, pToken));
+        while (pReader->pCur < pReader->pEnd && IS_JSON_WHITESPACE(*pReader->pCur)) {
+            pReader->pCur++;
+        }
+        CHK(pReader->pCur < pReader->pEnd && *pReader->pCur == ':', STATUS_INVALID_API_CALL_RETURN_JSON);
+        pReader->pCur++;
+        pReader->keyRead = TRUE;
+        pToken->type = SIGNALING_JSON_TOKEN_KEY;
+        CHK(FALSE, retStatus);
+    }
+
+    pReader->keyRead = FALSE;
+
+    if (c == '{' || c == '[') {
+        CHK(pReader->depth < SIGNALING_JSON_MAX_DEPTH, STATUS_INVALID_API_CALL_RETURN_JSON);
+        if (c == '{') {
+            pReader->objectMask |= 1ULL << pReader->depth;
+        } else {
+            pReader->objectMask &= ~(1ULL << pReader->depth);
+        }
+        pReader->depth++;
+        pReader->pCur++;
+        pReader->valueRead = FALSE;
+        pToken->type = (c == '{') ? SIGNALING_JSON_TOKEN_OBJECT_START : SIGNALING_JSON_TOKEN_ARRAY_START;
+    } else if (c == '"') {
+        CHK_STATUS(readJsonString(pReader, pToken));
+        pReader->valueRead = TRUE;
+        pToken->type = SIGNALING_JSON_TOKEN_STRING;
+    } else {
+        CHK(c != ':', STATUS_INVALID_API_CALL_RETURN_JSON);
+        pToken->pStart = pReader->pCur;
+        while (pReader->pCur < pReader->pEnd && !IS_JSON_DELIMITER(*pReader->pCur)) {
+            pReader->pCur++;
+        }
+        pToken->length = (UINT32) (pReader->pCur - pToken->pStart);
+        pReader->valueRead = TRUE;
+        pToken->type = SIGNALING_JSON_TOKEN_PRIMITIVE;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS signalingJsonReaderSkipValue(PSignalingJsonReader pReader, PSignalingJsonToken pToken)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    SignalingJsonToken token;
+
+    CHK(pReader != NULL && pToken != NULL, STATUS_NULL_ARG);
+
+    if (pToken->type == SIGNALING_JSON_TOKEN_KEY) {
+        CHK_STATUS(signalingJsonReaderNext(pReader, &token));
+        CHK_STATUS(signalingJsonReaderSkipValue(pReader, &token));
+    } else if (pToken->type == SIGNALING_JSON_TOKEN_OBJECT_START || pToken->type == SIGNALING_JSON_TOKEN_ARRAY_START) {
+        // The reader checks the nesting, the container is over once its level is closed
+        do {
+            CHK_STATUS(signalingJsonReaderNext(pReader, &token));
+        } while (!((token.type == SIGNALING_JSON_TOKEN_OBJECT_END || token.type == SIGNALING_JSON_TOKEN_ARRAY_END) && token.depth == pToken->depth));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+static BOOL isJsonKey(PSignalingJsonToken pToken, PCHAR pKey)
+{
+    return pToken->length == (UINT32) STRLEN(pKey) && STRNCMP(pToken->pStart, pKey, pToken->length) == 0;
+}
+
+static STATUS copyJsonString(PSignalingJsonToken pToken, PCHAR pDest, UINT32 maxLen, STATUS tooLongStatus)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(IS_JSON_SCALAR(pToken), STATUS_INVALID_API_CALL_RETURN_JSON);
+    CHK(pToken->length <= maxLen, tooLongStatus);
+
+    MEMCPY(pDest, pToken->pStart, pToken->length);
+    pDest[pToken->length] = '\0';
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS parseStatusResponse(PSignalingJsonReader pReader, PReceivedSignalingMessage pReceivedSignalingMessage)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    SignalingJsonToken key, value;
+
+    for (;;) {
+        CHK_STATUS(signalingJsonReaderNext(pReader, &key));
+        CHK(key.type != SIGNALING_JSON_TOKEN_OBJECT_END, retStatus);
+        CHK_STATUS(signalingJsonReaderNext(pReader, &value));
+
+        if (isJsonKey(&key, (PCHAR) "correlationId")) {
+            CHK_STATUS(copyJsonString(&value, pReceivedSignalingMessage->signalingMessage.correlationId, MAX_CORRELATION_ID_LEN,
+                                      STATUS_INVALID_API_CALL_RETURN_JSON));
+        } else if (isJsonKey(&key, (PCHAR) "errorType")) {
+            CHK_STATUS(
+                copyJsonString(&value, pReceivedSignalingMessage->errorType, MAX_ERROR_TYPE_STRING_LEN, STATUS_INVALID_API_CALL_RETURN_JSON));
+        } else if (isJsonKey(&key, (PCHAR) "statusCode")) {
+            CHK(IS_JSON_SCALAR(&value) && value.length <= MAX_STATUS_CODE_STRING_LEN, STATUS_INVALID_API_CALL_RETURN_JSON);
+            CHK_STATUS(STRTOUI32(value.pStart, value.pStart + value.length, 10, (PUINT32) &pReceivedSignalingMessage->statusCode));
+        } else if (isJsonKey(&key, (PCHAR) "description")) {
+            CHK_STATUS(copyJsonString(&value, pReceivedSignalingMessage->description, MAX_MESSAGE_DESCRIPTION_LEN,
+                                      STATUS_INVALID_API_CALL_RETURN_JSON));
+        } else {
+            CHK_STATUS(signalingJsonReaderSkipValue(pReader, &value));
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS parseIceConfigInfo(PSignalingJsonReader pReader, PIceConfigInfo pIceConfigInfo)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    SignalingJsonToken key, value, uri;
+    UINT64 ttl;
+
+    for (;;) {
+        CHK_STATUS(signalingJsonReaderNext(pReader, &key));
+        CHK(key.type != SIGNALING_JSON_TOKEN_OBJECT_END, retStatus);
+        CHK_STATUS(signalingJsonReaderNext(pReader, &value));
+
+        if (isJsonKey(&key, (PCHAR) "Username")) {
+            CHK_STATUS(copyJsonString(&value, pIceConfigInfo->userName, MAX_ICE_CONFIG_USER_NAME_LEN, STATUS_INVALID_API_CALL_RETURN_JSON));
+        } else if (isJsonKey(&key, (PCHAR) "Password")) {
+            CHK_STATUS(copyJsonString(&value, pIceConfigInfo->password, MAX_ICE_CONFIG_CREDENTIAL_LEN, STATUS_INVALID_API_CALL_RETURN_JSON));
+        } else if (isJsonKey(&key, (PCHAR) "Ttl")) {
+            CHK(IS_JSON_SCALAR(&value), STATUS_INVALID_API_CALL_RETURN_JSON);
+            CHK_STATUS(STRTOUI64(value.pStart, value.pStart + value.length, 10, &ttl));
+
+            // NOTE: Ttl value is in seconds
+            pIceConfigInfo->ttl = ttl * HUNDREDS_OF_NANOS_IN_A_SECOND;
+        } else if (isJsonKey(&key, (PCHAR) "Uris")) {
+            // Expect an array of elements
+            CHK(value.type == SIGNALING_JSON_TOKEN_ARRAY_START, STATUS_INVALID_API_CALL_RETURN_JSON);
+            for (;;) {
+                CHK_STATUS(signalingJsonReaderNext(pReader, &uri));
+                if (uri.type == SIGNALING_JSON_TOKEN_ARRAY_END) {
+                    break;
+                }
+                CHK(pIceConfigInfo->uriCount < MAX_ICE_CONFIG_URI_COUNT, STATUS_SIGNALING_MAX_ICE_URI_COUNT);
+                CHK_STATUS(
+                    copyJsonString(&uri, pIceConfigInfo->uris[pIceConfigInfo->uriCount], MAX_ICE_CONFIG_URI_LEN, STATUS_SIGNALING_MAX_ICE_URI_LEN));
+                pIceConfigInfo->uriCount++;
+            }
+        } else {
+            CHK_STATUS(signalingJsonReaderSkipValue(pReader, &value));
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS parseIceServerList(PSignalingJsonReader pReader, PSignalingClient pSignalingClient)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    SignalingJsonToken element;
+
+    // Zero the ice configs
+    MEMSET(&pSignalingClient->iceConfigs, 0x00, MAX_ICE_CONFIG_COUNT * SIZEOF(IceConfigInfo));
+    pSignalingClient->iceConfigCount = 0;
+
+    for (;;) {
+        CHK_STATUS(signalingJsonReaderNext(pReader, &element));
+        CHK(element.type != SIGNALING_JSON_TOKEN_ARRAY_END, retStatus);
+        CHK(pSignalingClient->iceConfigCount < MAX_ICE_CONFIG_COUNT, STATUS_SIGNALING_MAX_ICE_CONFIG_COUNT);
+
+        if (element.type == SIGNALING_JSON_TOKEN_OBJECT_START) {
+            pSignalingClient->iceConfigCount++;
+            CHK_STATUS(parseIceConfigInfo(pReader, &pSignalingClient->iceConfigs[pSignalingClient->iceConfigCount - 1]));
+        } else {
+            CHK_STATUS(signalingJsonReaderSkipValue(pReader, &element));
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS parseSignalingMessage(PSignalingClient pSignalingClient, PCHAR pMessage, UINT32 messageLen,
+                             PReceivedSignalingMessage pReceivedSignalingMessage, PBOOL pParsedIceServerList)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    SignalingJsonReader reader;
+    SignalingJsonToken key, value;
+    PSignalingMessage pSignalingMessage;
+    BOOL parsedMessageType = FALSE, parsedIceServerList = FALSE;
+    UINT32 memberCount = 0, outLen;
+
+    CHK(pSignalingClient != NULL && pMessage != NULL && pReceivedSignalingMessage != NULL && pParsedIceServerList != NULL, STATUS_NULL_ARG);
+
+    pSignalingMessage = &pReceivedSignalingMessage->signalingMessage;
+    pSignalingMessage->version = SIGNALING_MESSAGE_CURRENT_VERSION;
+
+    CHK_STATUS(signalingJsonReaderInit(&reader, pMessage, messageLen));
+    CHK_STATUS(signalingJsonReaderNext(&reader, &key));
+    CHK(key.type == SIGNALING_JSON_TOKEN_OBJECT_START, STATUS_INVALID_API_CALL_RETURN_JSON);
+
+    for (;;) {
+        CHK_STATUS(signalingJsonReaderNext(&reader, &key));
+        if (key.type == SIGNALING_JSON_TOKEN_OBJECT_END) {
+            break;
+        }
+
+        memberCount++;
+        CHK_STATUS(signalingJsonReaderNext(&reader, &value));
+
+        if (isJsonKey(&key, (PCHAR) "senderClientId")) {
+            CHK_STATUS(copyJsonString(&value, pSignalingMessage->peerClientId, MAX_SIGNALING_CLIENT_ID_LEN, STATUS_INVALID_API_CALL_RETURN_JSON));
+        } else if (isJsonKey(&key, (PCHAR) "messageType")) {
+            CHK(IS_JSON_SCALAR(&value) && value.length <= MAX_SIGNALING_MESSAGE_TYPE_LEN, STATUS_INVALID_API_CALL_RETURN_JSON);
+            // The text isn't NULL terminated, an empty type can't be left for getMessageTypeFromString to measure
+            if (value.length == 0) {
+                pSignalingMessage->messageType = SIGNALING_MESSAGE_TYPE_UNKNOWN;
+            } else {
+                CHK_STATUS(getMessageTypeFromString(value.pStart, value.length, &pSignalingMessage->messageType));
+            }
+            parsedMessageType = TRUE;
+        } else if (isJsonKey(&key, (PCHAR) "messagePayload")) {
+            CHK(IS_JSON_SCALAR(&value) && value.length <= MAX_SIGNALING_MESSAGE_LEN, STATUS_INVALID_API_CALL_RETURN_JSON);
+
+            // Base64 decode the message right out of the received text
+            outLen = MAX_SIGNALING_MESSAGE_LEN;
+            CHK_STATUS(base64Decode(value.pStart, value.length, (PBYTE) pSignalingMessage->payload, &outLen));
+            pSignalingMessage->payload[outLen] = '\0';
+            pSignalingMessage->payloadLen = outLen;
+        } else if (isJsonKey(&key, (PCHAR) "statusResponse") && value.type == SIGNALING_JSON_TOKEN_OBJECT_START) {
+            CHK_STATUS(parseStatusResponse(&reader, pReceivedSignalingMessage));
+        } else if (!parsedIceServerList && pSignalingMessage->messageType == SIGNALING_MESSAGE_TYPE_OFFER &&
+                   isJsonKey(&key, (PCHAR) "IceServerList")) {
+            CHK(value.type == SIGNALING_JSON_TOKEN_ARRAY_START, STATUS_INVALID_API_CALL_RETURN_JSON);
+            parsedIceServerList = TRUE;
+            CHK_STATUS(parseIceServerList(&reader, pSignalingClient));
+        } else {
+            CHK_STATUS(signalingJsonReaderSkipValue(&reader, &value));
+        }
+    }
+
+    CHK(memberCount > 0, STATUS_INVALID_API_CALL_RETURN_JSON);
+    CHK_STATUS(signalingJsonReaderNext(&reader, &key));
+    CHK(key.type == SIGNALING_JSON_TOKEN_END, STATUS_INVALID_API_CALL_RETURN_JSON);
+
+    // Message type is a mandatory field.
+    CHK(parsedMessageType, STATUS_SIGNALING_INVALID_MESSAGE_TYPE);
+
+CleanUp:
+
+    if (pParsedIceServerList != NULL) {
+        *pParsedIceServerList = parsedIceServerList;
+    }
+
+    LEAVES();
+    return retStatus;
+}
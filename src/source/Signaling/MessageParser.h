@@ -0,0 +1,78 @@
+/*******************************************
+Signaling message parser include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_SIGNALING_MESSAGE_PARSER__
+#define __KINESIS_VIDEO_WEBRTC_SIGNALING_MESSAGE_PARSER__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Deepest object/array nesting the reader follows, one bit of the container mask per level
+#define SIGNALING_JSON_MAX_DEPTH 64
+
+typedef enum {
+    SIGNALING_JSON_TOKEN_END,
+    SIGNALING_JSON_TOKEN_OBJECT_START,
+    SIGNALING_JSON_TOKEN_OBJECT_END,
+    SIGNALING_JSON_TOKEN_ARRAY_START,
+    SIGNALING_JSON_TOKEN_ARRAY_END,
+    // Member name, the value is the next token
+    SIGNALING_JSON_TOKEN_KEY,
+    SIGNALING_JSON_TOKEN_STRING,
+    // Number, true, false or null
+    SIGNALING_JSON_TOKEN_PRIMITIVE,
+} SIGNALING_JSON_TOKEN_TYPE;
+
+/*
+ * Points into the parsed text, strings are left escaped and without their quotes, the same spans jsmn gives out
+ */
+typedef struct {
+    SIGNALING_JSON_TOKEN_TYPE type;
+    PCHAR pStart;
+    UINT32 length;
+    // Nesting level the token is in, the top level object's members are at 1
+    UINT32 depth;
+} SignalingJsonToken, *PSignalingJsonToken;
+
+/*
+ * Pull reader handing out one token at a time, nothing is tokenized ahead or copied
+ */
+typedef struct {
+    PCHAR pCur;
+    PCHAR pEnd;
+    UINT32 depth;
+    // Bit set when the container at that level is an object
+    UINT64 objectMask;
+    // Whether a value was read at the current level, a comma has to come before the next one
+    BOOL valueRead;
+    // Whether a member name was read and its value is due
+    BOOL keyRead;
+} SignalingJsonReader, *PSignalingJsonReader;
+
+STATUS signalingJsonReaderInit(PSignalingJsonReader, PCHAR, UINT32);
+
+/**
+ * Reads the next token. Malformed JSON fails with STATUS_INVALID_API_CALL_RETURN_JSON, the end of the text gives an
+ * SIGNALING_JSON_TOKEN_END token.
+ */
+STATUS signalingJsonReaderNext(PSignalingJsonReader, PSignalingJsonToken);
+
+/**
+ * Skips over the rest of the value the given token starts
+ */
+STATUS signalingJsonReaderSkipValue(PSignalingJsonReader, PSignalingJsonToken);
+
+/**
+ * Parses a message received over the signaling web socket in a single pass. Action, sender, correlation and status go
+ * into the ReceivedSignalingMessage and the payload is base64 decoded straight into it. An ICE server list, which offers
+ * can carry, replaces the ICE configurations of the client, the last argument tells whether there was one.
+ */
+STATUS parseSignalingMessage(PSignalingClient, PCHAR, UINT32, PReceivedSignalingMessage, PBOOL);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_SIGNALING_MESSAGE_PARSER__ */
@@ -4,6 +4,183 @@
 extern StateMachineState SIGNALING_STATE_MACHINE_STATES[];
 extern UINT32 SIGNALING_STATE_MACHINE_STATE_COUNT;
 
+typedef struct {
+    MUTEX lock;
+    UINT64 nextId;
+    PDoubleList pSignalingClients;
+} SignalingMetricsRegistry, *PSignalingMetricsRegistry;
+
+// Signaling clients exportOpenMetrics reports on, created when the first one is added
+static volatile SIZE_T gSignalingMetricsRegistry = (SIZE_T) NULL;
+
+static STATUS getSignalingMetricsRegistry(PSignalingMetricsRegistry* ppSignalingMetricsRegistry)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingMetricsRegistry pSignalingMetricsRegistry = (PSignalingMetricsRegistry) ATOMIC_LOAD(&gSignalingMetricsRegistry);
+    SIZE_T expected = (SIZE_T) NULL;
+
+    if (pSignalingMetricsRegistry == NULL) {
+        CHK(NULL != (pSignalingMetricsRegistry = (PSignalingMetricsRegistry) MEMCALLOC(1, SIZEOF(SignalingMetricsRegistry))),
+            STATUS_NOT_ENOUGH_MEMORY);
+        pSignalingMetricsRegistry->lock = MUTEX_CREATE(FALSE);
+        CHK_STATUS(doubleListCreate(&pSignalingMetricsRegistry->pSignalingClients));
+        // Clients can be created on several threads at once, keep whichever registry got published first
+        if (ATOMIC_COMPARE_EXCHANGE(&gSignalingMetricsRegistry, &expected, (SIZE_T) pSignalingMetricsRegistry)) {
+            *ppSignalingMetricsRegistry = pSignalingMetricsRegistry;
+            pSignalingMetricsRegistry = NULL;
+        } else {
+            *ppSignalingMetricsRegistry = (PSignalingMetricsRegistry) expected;
+        }
+    } else {
+        *ppSignalingMetricsRegistry = pSignalingMetricsRegistry;
+        pSignalingMetricsRegistry = NULL;
+    }
+
+CleanUp:
+
+    if (pSignalingMetricsRegistry != NULL) {
+        doubleListFree(pSignalingMetricsRegistry->pSignalingClients);
+        MUTEX_FREE(pSignalingMetricsRegistry->lock);
+        SAFE_MEMFREE(pSignalingMetricsRegistry);
+    }
+
+    return retStatus;
+}
+
+STATUS deinitSignalingMetricsRegistry(VOID)
+{
+    PSignalingMetricsRegistry pSignalingMetricsRegistry = (PSignalingMetricsRegistry) ATOMIC_EXCHANGE(&gSignalingMetricsRegistry, (SIZE_T) NULL);
+
+    if (pSignalingMetricsRegistry != NULL) {
+        // The list only points at the clients, those still alive are not exported anymore
+        doubleListFree(pSignalingMetricsRegistry->pSignalingClients);
+        MUTEX_FREE(pSignalingMetricsRegistry->lock);
+        SAFE_MEMFREE(pSignalingMetricsRegistry);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+static STATUS signalingMetricsRegistryAdd(PSignalingClient pSignalingClient)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingMetricsRegistry pSignalingMetricsRegistry = NULL;
+    BOOL locked = FALSE;
+
+    CHK_STATUS(getSignalingMetricsRegistry(&pSignalingMetricsRegistry));
+
+    MUTEX_LOCK(pSignalingMetricsRegistry->lock);
+    locked = TRUE;
+    pSignalingClient->metricsId = pSignalingMetricsRegistry->nextId++;
+    CHK_STATUS(doubleListInsertItemTail(pSignalingMetricsRegistry->pSignalingClients, (UINT64) pSignalingClient));
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSignalingMetricsRegistry->lock);
+    }
+
+    return retStatus;
+}
+
+static STATUS signalingMetricsRegistryRemove(PSignalingClient pSignalingClient)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingMetricsRegistry pSignalingMetricsRegistry = (PSignalingMetricsRegistry) ATOMIC_LOAD(&gSignalingMetricsRegistry);
+    PDoubleListNode pCurNode = NULL;
+    UINT64 item;
+    BOOL locked = FALSE;
+
+    // Nothing was ever added
+    CHK(pSignalingMetricsRegistry != NULL, retStatus);
+
+    MUTEX_LOCK(pSignalingMetricsRegistry->lock);
+    locked = TRUE;
+
+    CHK_STATUS(doubleListGetHeadNode(pSignalingMetricsRegistry->pSignalingClients, &pCurNode));
+    while (pCurNode != NULL) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+        if ((PSignalingClient) item == pSignalingClient) {
+            CHK_STATUS(doubleListDeleteNode(pSignalingMetricsRegistry->pSignalingClients, pCurNode));
+            break;
+        }
+        pCurNode = pCurNode->pNext;
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSignalingMetricsRegistry->lock);
+    }
+
+    return retStatus;
+}
+
+static STATUS signalingMetricsSnapshot(PSignalingClient pSignalingClient, PSignalingClientMetricsSnapshot pSnapshot)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PChannelInfo pChannelInfo = pSignalingClient->pChannelInfo;
+
+    pSnapshot->id = pSignalingClient->metricsId;
+    STRNCPY(pSnapshot->channel, pChannelInfo->pChannelName != NULL ? pChannelInfo->pChannelName : pChannelInfo->pChannelArn, MAX_ARN_LEN);
+    pSnapshot->role = pChannelInfo->channelRoleType;
+
+    pSnapshot->signalingClientMetrics.version = SIGNALING_CLIENT_METRICS_CURRENT_VERSION;
+    CHK_STATUS(signalingGetMetrics(pSignalingClient, &pSnapshot->signalingClientMetrics));
+    pSnapshot->latencyMetrics.version = LATENCY_METRICS_CURRENT_VERSION;
+    CHK_STATUS(signalingGetLatencyMetrics(pSignalingClient, &pSnapshot->latencyMetrics));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS signalingTakeMetricsSnapshots(PSignalingClientMetricsSnapshot* ppSnapshots, PUINT32 pSnapshotCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingMetricsRegistry pSignalingMetricsRegistry = (PSignalingMetricsRegistry) ATOMIC_LOAD(&gSignalingMetricsRegistry);
+    PSignalingClientMetricsSnapshot pSnapshots = NULL;
+    PDoubleListNode pCurNode = NULL;
+    UINT64 item;
+    UINT32 count = 0, i = 0;
+    BOOL locked = FALSE;
+
+    CHK(ppSnapshots != NULL && pSnapshotCount != NULL, STATUS_NULL_ARG);
+    *ppSnapshots = NULL;
+    *pSnapshotCount = 0;
+
+    // Nothing was ever added
+    CHK(pSignalingMetricsRegistry != NULL, retStatus);
+
+    MUTEX_LOCK(pSignalingMetricsRegistry->lock);
+    locked = TRUE;
+
+    CHK_STATUS(doubleListGetNodeCount(pSignalingMetricsRegistry->pSignalingClients, &count));
+    CHK(count > 0, retStatus);
+    CHK(NULL != (pSnapshots = (PSignalingClientMetricsSnapshot) MEMCALLOC(count, SIZEOF(SignalingClientMetricsSnapshot))), STATUS_NOT_ENOUGH_MEMORY);
+
+    CHK_STATUS(doubleListGetHeadNode(pSignalingMetricsRegistry->pSignalingClients, &pCurNode));
+    while (pCurNode != NULL) {
+        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+        CHK_STATUS(signalingMetricsSnapshot((PSignalingClient) item, &pSnapshots[i++]));
+        pCurNode = pCurNode->pNext;
+    }
+
+    *ppSnapshots = pSnapshots;
+    *pSnapshotCount = count;
+    pSnapshots = NULL;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSignalingMetricsRegistry->lock);
+    }
+
+    SAFE_MEMFREE(pSnapshots);
+
+    return retStatus;
+}
+
 STATUS createSignalingSync(PSignalingClientInfoInternal pClientInfo, PChannelInfo pChannelInfo, PSignalingClientCallbacks pCallbacks,
                            PAwsCredentialProvider pCredentialProvider, PSignalingClient* ppSignalingClient)
 {
@@ -37,10 +214,9 @@ STATUS createSignalingSync(PSignalingClientInfoInternal pClientInfo, PChannelInf
     CHK_STATUS(createValidateChannelInfo(pChannelInfo, &pSignalingClient->pChannelInfo));
     CHK_STATUS(validateSignalingCallbacks(pSignalingClient, pCallbacks));
     CHK_STATUS(validateSignalingClientInfo(pSignalingClient, pClientInfo));
-#ifdef KVS_USE_SIGNALING_CHANNEL_THREADPOOL
-    CHK_STATUS(threadpoolCreate(&pSignalingClient->pThreadpool, pClientInfo->signalingClientInfo.signalingMessagesMinimumThreads,
-                                pClientInfo->signalingClientInfo.signalingMessagesMaximumThreads));
-#endif
+    CHK_STATUS(createSignalingMessageDispatcher(pClientInfo->signalingClientInfo.signalingMessagesMinimumThreads,
+                                                pClientInfo->signalingClientInfo.signalingMessagesMaximumThreads, receiveLwsMessageWrapper,
+                                                &pSignalingClient->pMessageDispatcher));
     pSignalingClient->version = SIGNALING_CLIENT_CURRENT_VERSION;
     // Set invalid call times
     pSignalingClient->describeTime = INVALID_TIMESTAMP_VALUE;
@@ -174,6 +350,8 @@ STATUS createSignalingSync(PSignalingClientInfoInternal pClientInfo, PChannelInf
     CHK_STATUS(hashTableCreateWithParams(SIGNALING_CLOCKSKEW_HASH_TABLE_BUCKET_COUNT, SIGNALING_CLOCKSKEW_HASH_TABLE_BUCKET_LENGTH,
                                          &pSignalingClient->diagnostics.pEndpointToClockSkewHashMap));
 
+    CHK_STATUS(signalingMetricsRegistryAdd(pSignalingClient));
+
     // At this point we have constructed the main object and we can assign to the returned pointer
     *ppSignalingClient = pSignalingClient;
 
@@ -220,6 +398,9 @@ STATUS freeSignaling(PSignalingClient* ppSignalingClient)
     pSignalingClient = *ppSignalingClient;
     CHK(pSignalingClient != NULL, retStatus);
 
+    // An export going on holds the registry until it is done with the client
+    CHK_LOG_ERR(signalingMetricsRegistryRemove(pSignalingClient));
+
     ATOMIC_STORE_BOOL(&pSignalingClient->shutdown, TRUE);
 
     terminateOngoingOperations(pSignalingClient);
@@ -231,6 +412,9 @@ STATUS freeSignaling(PSignalingClient* ppSignalingClient)
         MUTEX_UNLOCK(pSignalingClient->lwsServiceLock);
     }
 
+    // Nothing is received anymore, waits for the messages being handled
+    freeSignalingMessageDispatcher(&pSignalingClient->pMessageDispatcher);
+
     freeStateMachine(pSignalingClient->pStateMachine);
 
     freeClientRetryStrategy(pSignalingClient);
@@ -241,10 +425,6 @@ STATUS freeSignaling(PSignalingClient* ppSignalingClient)
 
     hashTableFree(pSignalingClient->diagnostics.pEndpointToClockSkewHashMap);
 
-#ifdef KVS_USE_SIGNALING_CHANNEL_THREADPOOL
-    threadpoolFree(pSignalingClient->pThreadpool);
-#endif
-
     if (IS_VALID_MUTEX_VALUE(pSignalingClient->connectedLock)) {
         MUTEX_FREE(pSignalingClient->connectedLock);
     }
@@ -1396,6 +1576,7 @@ STATUS signalingGetMetrics(PSignalingClient pSignalingClient, PSignalingClientMe
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     UINT64 curTime;
+    SignalingDispatcherStats dispatcherStats;
 
     curTime = SIGNALING_GET_CURRENT_TIME(pSignalingClient);
 
@@ -1413,6 +1594,13 @@ STATUS signalingGetMetrics(PSignalingClient pSignalingClient, PSignalingClientMe
     MEMSET(&pSignalingClientMetrics->signalingClientStats, 0x00, SIZEOF(pSignalingClientMetrics->signalingClientStats));
 
     switch (pSignalingClientMetrics->version) {
+        case 2:
+            MEMSET(&dispatcherStats, 0x00, SIZEOF(SignalingDispatcherStats));
+            signalingDispatcherGetStats(pSignalingClient->pMessageDispatcher, &dispatcherStats);
+            pSignalingClientMetrics->signalingClientStats.messageQueueDepth = dispatcherStats.queueDepth;
+            pSignalingClientMetrics->signalingClientStats.maxMessageQueueDepth = dispatcherStats.maxQueueDepth;
+            pSignalingClientMetrics->signalingClientStats.messageDispatchLatency = dispatcherStats.averageDispatchLatency;
+            pSignalingClientMetrics->signalingClientStats.maxMessageDispatchLatency = dispatcherStats.maxDispatchLatency;
         case 1:
             pSignalingClientMetrics->signalingClientStats.getTokenCallTime = pSignalingClient->diagnostics.getTokenCallTime;
             pSignalingClientMetrics->signalingClientStats.describeCallTime = pSignalingClient->diagnostics.describeCallTime;
@@ -1452,3 +1640,27 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS signalingGetLatencyMetrics(PSignalingClient pSignalingClient, PLatencyMetrics pLatencyMetrics)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pSignalingClient != NULL && pLatencyMetrics != NULL, STATUS_NULL_ARG);
+
+    if (pLatencyMetrics->version > LATENCY_METRICS_CURRENT_VERSION) {
+        DLOGW("Invalid latency metrics version...setting to highest supported by default version %d", LATENCY_METRICS_CURRENT_VERSION);
+        pLatencyMetrics->version = LATENCY_METRICS_CURRENT_VERSION;
+    }
+
+    MEMSET(pLatencyMetrics->stageLatency, 0x00, SIZEOF(pLatencyMetrics->stageLatency));
+    if (pSignalingClient->pMessageDispatcher != NULL) {
+        CHK_STATUS(latencyHistogramGetStats(&pSignalingClient->pMessageDispatcher->dispatchLatency,
+                                            &pLatencyMetrics->stageLatency[LATENCY_STAGE_SIGNALING_DISPATCH]));
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
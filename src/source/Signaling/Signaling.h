@@ -359,9 +359,9 @@ typedef struct {
     UINT64 connectTime;
     UINT64 describeMediaTime;
 
-#ifdef KVS_USE_SIGNALING_CHANNEL_THREADPOOL
-    PThreadpool pThreadpool;
-#endif
+    // Hands the received messages to the application, in order for each peer
+    struct __SignalingMessageDispatcher* pMessageDispatcher;
+
     UINT64 offerReceivedTime;
     UINT64 offerSentTime;
 
@@ -374,6 +374,9 @@ typedef struct {
     // Conditional variable for join storage session wait state
     CVAR jssWaitCvar;
 
+    // Id the client is exported under by exportOpenMetrics
+    UINT64 metricsId;
+
 } SignalingClient, *PSignalingClient;
 
 // Public handle to and from object converters
@@ -418,6 +421,14 @@ STATUS joinStorageSession(PSignalingClient, UINT64);
 STATUS describeMediaStorageConf(PSignalingClient, UINT64);
 STATUS deleteChannel(PSignalingClient, UINT64);
 STATUS signalingGetMetrics(PSignalingClient, PSignalingClientMetrics);
+STATUS signalingGetLatencyMetrics(PSignalingClient, PLatencyMetrics);
+
+/**
+ * Allocates and fills a snapshot of every live signaling client, taken under the lock of the registry so none of them
+ * can be freed halfway through. The labels are left to the exporter.
+ */
+STATUS signalingTakeMetricsSnapshots(PSignalingClientMetricsSnapshot*, PUINT32);
+STATUS deinitSignalingMetricsRegistry(VOID);
 
 STATUS configureRetryStrategyForSignalingStateMachine(PSignalingClient);
 STATUS setupDefaultRetryStrategyForSignalingStateMachine(PSignalingClient);
@@ -6,7 +6,142 @@ namespace kinesis {
 namespace video {
 namespace webrtcclient {
 
+// One direction of the in-memory transport between two PeerConnections, carrying DTLS records
+struct LoopbackLink {
+    std::mutex lock{};
+    std::queue<std::vector<BYTE>> packets{};
+    UINT32 largestPacketSize = 0;
+};
+
 class DataChannelFunctionalityTest : public WebRtcClientTestBase {
+  public:
+    // Sets up what the offer/answer exchange would have and starts DTLS between the two PeerConnections over an
+    // in-memory transport, the pump thread stands in for the ICE receive thread of both ends
+    VOID startLoopback(PRtcPeerConnection offerPc, PRtcPeerConnection answerPc)
+    {
+        PKvsPeerConnection pOfferKvsPc = (PKvsPeerConnection) offerPc, pAnswerKvsPc = (PKvsPeerConnection) answerPc;
+
+        ATOMIC_STORE_BOOL(&pOfferKvsPc->sctpIsEnabled, TRUE);
+        ATOMIC_STORE_BOOL(&pAnswerKvsPc->sctpIsEnabled, TRUE);
+        pOfferKvsPc->dtlsIsServer = FALSE;
+        pAnswerKvsPc->dtlsIsServer = TRUE;
+        EXPECT_EQ(STATUS_SUCCESS,
+                  dtlsSessionGetLocalCertificateFingerprint(pAnswerKvsPc->pDtlsSession, pOfferKvsPc->remoteCertificateFingerprint,
+                                                            CERTIFICATE_FINGERPRINT_LENGTH));
+        EXPECT_EQ(STATUS_SUCCESS,
+                  dtlsSessionGetLocalCertificateFingerprint(pOfferKvsPc->pDtlsSession, pAnswerKvsPc->remoteCertificateFingerprint,
+                                                            CERTIFICATE_FINGERPRINT_LENGTH));
+
+        auto onOutboundPacket = [](UINT64 customData, PBYTE pData, UINT32 dataLen) {
+            LoopbackLink* pLink = (LoopbackLink*) customData;
+            std::lock_guard<std::mutex> lock(pLink->lock);
+            pLink->packets.push(std::vector<BYTE>(pData, pData + dataLen));
+            pLink->largestPacketSize = MAX(pLink->largestPacketSize, dataLen);
+        };
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionOnOutBoundData(pOfferKvsPc->pDtlsSession, (UINT64) &toAnswer, onOutboundPacket));
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionOnOutBoundData(pAnswerKvsPc->pDtlsSession, (UINT64) &toOffer, onOutboundPacket));
+
+        stopPump = false;
+        pump = std::thread([this, pOfferKvsPc, pAnswerKvsPc]() {
+            std::queue<std::vector<BYTE>> pending;
+            while (!stopPump) {
+                for (auto link : {std::make_pair(&toOffer, pOfferKvsPc), std::make_pair(&toAnswer, pAnswerKvsPc)}) {
+                    {
+                        std::lock_guard<std::mutex> lock(link.first->lock);
+                        link.first->packets.swap(pending);
+                    }
+                    for (; !pending.empty(); pending.pop()) {
+                        processInboundPacket((UINT64) link.second, pending.front().data(), (UINT32) pending.front().size());
+                    }
+                }
+                THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+            }
+        });
+
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionStart(pOfferKvsPc->pDtlsSession, FALSE));
+        EXPECT_EQ(STATUS_SUCCESS, dtlsSessionStart(pAnswerKvsPc->pDtlsSession, TRUE));
+    }
+
+    void TearDown()
+    {
+        // A failed assertion can leave the pump running
+        stopLoopback();
+        WebRtcClientTestBase::TearDown();
+    }
+
+    // Has to be called before the PeerConnections are closed
+    VOID stopLoopback()
+    {
+        stopPump = true;
+        if (pump.joinable()) {
+            pump.join();
+        }
+    }
+
+  protected:
+    LoopbackLink toOffer, toAnswer;
+    std::atomic<bool> stopPump{false};
+    std::thread pump;
+};
+
+#define STRESS_DATA_CHANNEL_COUNT 8
+
+struct ConcurrentSendCheck {
+    std::atomic<UINT32> remoteChannelCount{0};
+    std::atomic<UINT32> messagesReceived[STRESS_DATA_CHANNEL_COUNT]{};
+    std::atomic<UINT32> mismatchCount{0};
+
+    // Each message carries the index of its channel and its sequence number, channels with an even index send binary
+    static VOID onMessage(UINT64 customData, PRtcDataChannel pDataChannel, BOOL isBinary, PBYTE pMsg, UINT32 pMsgLen)
+    {
+        ConcurrentSendCheck* pCheck = (ConcurrentSendCheck*) customData;
+        CHAR expectedName[MAX_DATA_CHANNEL_NAME_LEN + 1];
+        UINT32 index, sequence;
+
+        if (pMsgLen < 1 + SIZEOF(UINT32) || pMsg[0] >= STRESS_DATA_CHANNEL_COUNT) {
+            pCheck->mismatchCount++;
+            return;
+        }
+        index = pMsg[0];
+        sequence = (UINT32) getUnalignedInt32BigEndian(pMsg + 1);
+        SNPRINTF(expectedName, ARRAY_SIZE(expectedName), "Stress%u", index);
+        if (STRCMP(pDataChannel->name, expectedName) != 0 || isBinary != (index % 2 == 0) ||
+            sequence != pCheck->messagesReceived[index].load() || pMsgLen != 1 + SIZEOF(UINT32) + (sequence % 7) * 100) {
+            pCheck->mismatchCount++;
+        }
+        pCheck->messagesReceived[index]++;
+    }
+};
+
+struct LoopbackTransfer {
+    std::atomic<PRtcDataChannel> pRemoteDataChannel{nullptr};
+    std::atomic<UINT64> bytesReceived{0};
+    std::atomic<UINT32> bufferedAmountLowCount{0};
+};
+
+struct OwnedMessages {
+    std::atomic<PRtcDataChannel> pRemoteDataChannel{nullptr};
+    std::atomic<UINT32> copiedCount{0};
+    std::mutex lock{};
+    std::vector<std::pair<PBYTE, UINT32>> messages{};
+};
+
+struct DataChannelLifecycle {
+    std::atomic<PRtcDataChannel> pRemoteDataChannel{nullptr};
+    std::atomic<UINT32> openCount{0};
+    std::atomic<UINT32> closeCount{0};
+
+    static VOID onOpen(UINT64 customData, PRtcDataChannel pDataChannel)
+    {
+        UNUSED_PARAM(pDataChannel);
+        ((DataChannelLifecycle*) customData)->openCount++;
+    }
+
+    static VOID onClose(UINT64 customData, PRtcDataChannel pDataChannel)
+    {
+        UNUSED_PARAM(pDataChannel);
+        ((DataChannelLifecycle*) customData)->closeCount++;
+    }
 };
 
 // Macro so we don't have to deal with scope capture
@@ -17,6 +152,60 @@ struct RemoteOpen {
     std::map<std::string, uint64_t> channels{};
 };
 
+#define SCTP_DATA_CHUNK_FLAG_UNORDERED 0x04
+
+// SCTP packets a PeerConnection handed to DTLS, captured before they are encrypted
+struct SctpCapture {
+    std::mutex lock{};
+    std::vector<std::vector<BYTE>> packets{};
+};
+
+static SctpCapture gSctpCapture;
+
+static VOID captureSctpOutboundPacket(UINT64 customData, PBYTE pPacket, UINT32 packetLen)
+{
+    {
+        std::lock_guard<std::mutex> lock(gSctpCapture.lock);
+        gSctpCapture.packets.emplace_back(pPacket, pPacket + packetLen);
+    }
+    onSctpSessionOutboundPacket(customData, pPacket, packetLen);
+}
+
+// Only the function is swapped, the session keeps passing the PeerConnection as custom data
+static VOID startSctpCapture(PRtcPeerConnection pPeerConnection)
+{
+    {
+        std::lock_guard<std::mutex> lock(gSctpCapture.lock);
+        gSctpCapture.packets.clear();
+    }
+    ((PKvsPeerConnection) pPeerConnection)->pSctpSession->sctpSessionCallbacks.outboundPacketFunc = captureSctpOutboundPacket;
+}
+
+// First captured DATA chunk of the stream with the payload protocol, https://www.rfc-editor.org/rfc/rfc9260#section-3.3.1
+static BOOL findCapturedDataChunk(UINT32 streamId, UINT32 ppid, PBYTE pFlags, std::vector<BYTE>* pUserData)
+{
+    std::lock_guard<std::mutex> lock(gSctpCapture.lock);
+    UINT32 offset, chunkLength;
+
+    for (auto& packet : gSctpCapture.packets) {
+        for (offset = SCTP_COMMON_HEADER_SIZE; offset + 4 <= packet.size(); offset += ROUND_UP(chunkLength, 4)) {
+            chunkLength = (UINT16) getUnalignedInt16BigEndian(packet.data() + offset + 2);
+            if (chunkLength < 4 || offset + chunkLength > packet.size()) {
+                break;
+            }
+            if (packet[offset] == SCTP_CHUNK_TYPE_DATA && chunkLength >= 16 &&
+                (UINT16) getUnalignedInt16BigEndian(packet.data() + offset + 8) == streamId &&
+                (UINT32) getUnalignedInt32BigEndian(packet.data() + offset + 12) == ppid) {
+                *pFlags = packet[offset + 1];
+                pUserData->assign(packet.begin() + offset + 16, packet.begin() + offset + chunkLength);
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
 // Create two PeerConnections and ensure DataChannels that were declared
 // before signaling go to connected
 TEST_F(DataChannelFunctionalityTest, createDataChannel_Disconnected)
@@ -173,8 +362,8 @@ TEST_F(DataChannelFunctionalityTest, createDataChannel_PartialReliabilityUnorder
     PRtcDataChannel pOfferDataChannel = nullptr, pAnswerDataChannel = nullptr;
     SIZE_T datachannelLocalOpenCount = 0, msgCount = 0;
     RtcDataChannelInit rtcDataChannelInit;
-    PSctpSession pSctpSession = NULL;
-    PKvsDataChannel pKvsDataChannel = NULL;
+    std::vector<BYTE> dcepOpen, message;
+    BYTE dcepOpenFlags = 0, messageFlags = 0;
     RemoteOpen remoteOpen{};
 
     MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
@@ -220,32 +409,47 @@ TEST_F(DataChannelFunctionalityTest, createDataChannel_PartialReliabilityUnorder
     EXPECT_EQ(peerConnectionOnDataChannel(offerPc, (UINT64) &remoteOpen, onDataChannel), STATUS_SUCCESS);
     EXPECT_EQ(peerConnectionOnDataChannel(answerPc, (UINT64) &remoteOpen, onDataChannel), STATUS_SUCCESS);
 
-    // Create two DataChannels
-    EXPECT_EQ(createDataChannel(offerPc, (PCHAR) "Offer PeerConnection", &rtcDataChannelInit, &pOfferDataChannel), STATUS_SUCCESS);
+    // The partially reliable channel is created once the association is up, so its DATA_CHANNEL_OPEN can be captured
     EXPECT_EQ(createDataChannel(answerPc, (PCHAR) "Answer PeerConnection", NULL, &pAnswerDataChannel), STATUS_SUCCESS);
-
-    EXPECT_EQ(dataChannelOnOpen(pOfferDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
     EXPECT_EQ(dataChannelOnOpen(pAnswerDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
-
-    EXPECT_EQ(dataChannelOnMessage(pOfferDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
     EXPECT_EQ(dataChannelOnMessage(pAnswerDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
 
     EXPECT_EQ(connectTwoPeers(offerPc, answerPc), TRUE);
 
+    for (auto i = 0; i <= 100 && ATOMIC_LOAD(&datachannelLocalOpenCount) == 0; i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    startSctpCapture(offerPc);
+
+    EXPECT_EQ(createDataChannel(offerPc, (PCHAR) "Offer PeerConnection", &rtcDataChannelInit, &pOfferDataChannel), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelOnOpen(pOfferDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelOnMessage(pOfferDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelSend(pOfferDataChannel, FALSE, (PBYTE) TEST_DATA_CHANNEL_MESSAGE, STRLEN(TEST_DATA_CHANNEL_MESSAGE)), STATUS_SUCCESS);
+
     // Busy wait until DataChannels connect and send a message
     for (auto i = 0; i <= 100 && (ATOMIC_LOAD(&datachannelLocalOpenCount) + ATOMIC_LOAD(&msgCount)) != 4 ; i++) {
         THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_SECOND);
     }
-    // Close the connection to avoid data race while accessing SctpSession
+    for (auto i = 0; i <= 100 &&
+         !(findCapturedDataChunk(pOfferDataChannel->id, SCTP_PPID_DCEP, &dcepOpenFlags, &dcepOpen) &&
+           findCapturedDataChunk(pOfferDataChannel->id, SCTP_PPID_STRING, &messageFlags, &message));
+         i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
     closePeerConnection(offerPc);
     closePeerConnection(answerPc);
 
-    pKvsDataChannel = (PKvsDataChannel) pOfferDataChannel;
-    pSctpSession = ((PKvsPeerConnection) pKvsDataChannel->pRtcPeerConnection)->pSctpSession;
+    // The DATA_CHANNEL_OPEN carries the reliability of the channel to the peer and is itself sent in order
+    ASSERT_LE(SCTP_DCEP_HEADER_LENGTH, dcepOpen.size());
+    EXPECT_EQ(DCEP_DATA_CHANNEL_OPEN, dcepOpen[0]);
+    EXPECT_EQ(DCEP_DATA_CHANNEL_RELIABLE_UNORDERED | DCEP_DATA_CHANNEL_TIMED, dcepOpen[1]);
+    EXPECT_EQ(rtcDataChannelInit.maxPacketLifeTime.value, (UINT32) getUnalignedInt32BigEndian(dcepOpen.data() + SIZEOF(UINT32)));
+    EXPECT_EQ(0, dcepOpenFlags & SCTP_DATA_CHUNK_FLAG_UNORDERED);
 
-    ASSERT_EQ(pSctpSession->spa.sendv_sndinfo.snd_flags, SCTP_UNORDERED);
-    ASSERT_EQ(pSctpSession->spa.sendv_prinfo.pr_policy, SCTP_PR_SCTP_TTL);
-    ASSERT_EQ(pSctpSession->spa.sendv_prinfo.pr_value, rtcDataChannelInit.maxPacketLifeTime.value);
+    // Messages of the channel follow its ordering
+    EXPECT_EQ(STRLEN(TEST_DATA_CHANNEL_MESSAGE), message.size());
+    EXPECT_EQ(SCTP_DATA_CHUNK_FLAG_UNORDERED, messageFlags & SCTP_DATA_CHUNK_FLAG_UNORDERED);
 
     freePeerConnection(&offerPc);
     freePeerConnection(&answerPc);
@@ -258,8 +462,8 @@ TEST_F(DataChannelFunctionalityTest, createDataChannel_PartialReliabilityUnOrder
     PRtcDataChannel pOfferDataChannel = nullptr, pAnswerDataChannel = nullptr;
     SIZE_T datachannelLocalOpenCount = 0, msgCount = 0;
     RtcDataChannelInit rtcDataChannelInit;
-    PSctpSession pSctpSession = NULL;
-    PKvsDataChannel pKvsDataChannel = NULL;
+    std::vector<BYTE> dcepOpen, message;
+    BYTE dcepOpenFlags = 0, messageFlags = 0;
     RemoteOpen remoteOpen{};
 
     MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
@@ -305,33 +509,48 @@ TEST_F(DataChannelFunctionalityTest, createDataChannel_PartialReliabilityUnOrder
     EXPECT_EQ(peerConnectionOnDataChannel(offerPc, (UINT64) &remoteOpen, onDataChannel), STATUS_SUCCESS);
     EXPECT_EQ(peerConnectionOnDataChannel(answerPc, (UINT64) &remoteOpen, onDataChannel), STATUS_SUCCESS);
 
-    // Create two DataChannels
-    EXPECT_EQ(createDataChannel(offerPc, (PCHAR) "Offer PeerConnection", &rtcDataChannelInit, &pOfferDataChannel), STATUS_SUCCESS);
+    // The partially reliable channel is created once the association is up, so its DATA_CHANNEL_OPEN can be captured
     EXPECT_EQ(createDataChannel(answerPc, (PCHAR) "Answer PeerConnection", NULL, &pAnswerDataChannel), STATUS_SUCCESS);
-
-    EXPECT_EQ(dataChannelOnOpen(pOfferDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
     EXPECT_EQ(dataChannelOnOpen(pAnswerDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
-
-    EXPECT_EQ(dataChannelOnMessage(pOfferDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
     EXPECT_EQ(dataChannelOnMessage(pAnswerDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
 
     EXPECT_EQ(connectTwoPeers(offerPc, answerPc), TRUE);
 
+    for (auto i = 0; i <= 100 && ATOMIC_LOAD(&datachannelLocalOpenCount) == 0; i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    startSctpCapture(offerPc);
+
+    EXPECT_EQ(createDataChannel(offerPc, (PCHAR) "Offer PeerConnection", &rtcDataChannelInit, &pOfferDataChannel), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelOnOpen(pOfferDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelOnMessage(pOfferDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelSend(pOfferDataChannel, FALSE, (PBYTE) TEST_DATA_CHANNEL_MESSAGE, STRLEN(TEST_DATA_CHANNEL_MESSAGE)), STATUS_SUCCESS);
+
     // Busy wait until DataChannels connect and send a message
     for (auto i = 0; i <= 100 && (ATOMIC_LOAD(&datachannelLocalOpenCount) + ATOMIC_LOAD(&msgCount)) != 4 ; i++) {
         THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_SECOND);
     }
 
-    // Close the connection to avoid data race while accessing SctpSession
+    for (auto i = 0; i <= 100 &&
+         !(findCapturedDataChunk(pOfferDataChannel->id, SCTP_PPID_DCEP, &dcepOpenFlags, &dcepOpen) &&
+           findCapturedDataChunk(pOfferDataChannel->id, SCTP_PPID_STRING, &messageFlags, &message));
+         i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
     closePeerConnection(offerPc);
     closePeerConnection(answerPc);
 
-    pKvsDataChannel = (PKvsDataChannel) pOfferDataChannel;
-    pSctpSession = ((PKvsPeerConnection) pKvsDataChannel->pRtcPeerConnection)->pSctpSession;
+    // The DATA_CHANNEL_OPEN carries the reliability of the channel to the peer and is itself sent in order
+    ASSERT_LE(SCTP_DCEP_HEADER_LENGTH, dcepOpen.size());
+    EXPECT_EQ(DCEP_DATA_CHANNEL_OPEN, dcepOpen[0]);
+    EXPECT_EQ(DCEP_DATA_CHANNEL_RELIABLE_UNORDERED | DCEP_DATA_CHANNEL_REXMIT, dcepOpen[1]);
+    EXPECT_EQ(rtcDataChannelInit.maxRetransmits.value, (UINT32) getUnalignedInt32BigEndian(dcepOpen.data() + SIZEOF(UINT32)));
+    EXPECT_EQ(0, dcepOpenFlags & SCTP_DATA_CHUNK_FLAG_UNORDERED);
 
-    ASSERT_EQ(pSctpSession->spa.sendv_sndinfo.snd_flags, SCTP_UNORDERED);
-    ASSERT_EQ(pSctpSession->spa.sendv_prinfo.pr_policy, SCTP_PR_SCTP_RTX);
-    ASSERT_EQ(pSctpSession->spa.sendv_prinfo.pr_value, rtcDataChannelInit.maxRetransmits.value);
+    // Messages of the channel follow its ordering
+    EXPECT_EQ(STRLEN(TEST_DATA_CHANNEL_MESSAGE), message.size());
+    EXPECT_EQ(SCTP_DATA_CHUNK_FLAG_UNORDERED, messageFlags & SCTP_DATA_CHUNK_FLAG_UNORDERED);
 
     freePeerConnection(&offerPc);
     freePeerConnection(&answerPc);
@@ -344,8 +563,8 @@ TEST_F(DataChannelFunctionalityTest, createDataChannel_PartialReliabilityOrdered
     PRtcDataChannel pOfferDataChannel = nullptr, pAnswerDataChannel = nullptr;
     SIZE_T datachannelLocalOpenCount = 0, msgCount = 0;
     RtcDataChannelInit rtcDataChannelInit;
-    PSctpSession pSctpSession = NULL;
-    PKvsDataChannel pKvsDataChannel = NULL;
+    std::vector<BYTE> dcepOpen, message;
+    BYTE dcepOpenFlags = 0, messageFlags = 0;
     RemoteOpen remoteOpen{};
 
     MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
@@ -391,33 +610,48 @@ TEST_F(DataChannelFunctionalityTest, createDataChannel_PartialReliabilityOrdered
     EXPECT_EQ(peerConnectionOnDataChannel(offerPc, (UINT64) &remoteOpen, onDataChannel), STATUS_SUCCESS);
     EXPECT_EQ(peerConnectionOnDataChannel(answerPc, (UINT64) &remoteOpen, onDataChannel), STATUS_SUCCESS);
 
-    // Create two DataChannels
-    EXPECT_EQ(createDataChannel(offerPc, (PCHAR) "Offer PeerConnection", &rtcDataChannelInit, &pOfferDataChannel), STATUS_SUCCESS);
+    // The partially reliable channel is created once the association is up, so its DATA_CHANNEL_OPEN can be captured
     EXPECT_EQ(createDataChannel(answerPc, (PCHAR) "Answer PeerConnection", NULL, &pAnswerDataChannel), STATUS_SUCCESS);
-
-    EXPECT_EQ(dataChannelOnOpen(pOfferDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
     EXPECT_EQ(dataChannelOnOpen(pAnswerDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
-
-    EXPECT_EQ(dataChannelOnMessage(pOfferDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
     EXPECT_EQ(dataChannelOnMessage(pAnswerDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
 
     EXPECT_EQ(connectTwoPeers(offerPc, answerPc), TRUE);
 
+    for (auto i = 0; i <= 100 && ATOMIC_LOAD(&datachannelLocalOpenCount) == 0; i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    startSctpCapture(offerPc);
+
+    EXPECT_EQ(createDataChannel(offerPc, (PCHAR) "Offer PeerConnection", &rtcDataChannelInit, &pOfferDataChannel), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelOnOpen(pOfferDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelOnMessage(pOfferDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelSend(pOfferDataChannel, FALSE, (PBYTE) TEST_DATA_CHANNEL_MESSAGE, STRLEN(TEST_DATA_CHANNEL_MESSAGE)), STATUS_SUCCESS);
+
     // Busy wait until DataChannels connect and send a message
     for (auto i = 0; i <= 100 && (ATOMIC_LOAD(&datachannelLocalOpenCount) + ATOMIC_LOAD(&msgCount)) != 4 ; i++) {
         THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_SECOND);
     }
 
-    // Close the connection to avoid data race while accessing SctpSession
+    for (auto i = 0; i <= 100 &&
+         !(findCapturedDataChunk(pOfferDataChannel->id, SCTP_PPID_DCEP, &dcepOpenFlags, &dcepOpen) &&
+           findCapturedDataChunk(pOfferDataChannel->id, SCTP_PPID_STRING, &messageFlags, &message));
+         i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
     closePeerConnection(offerPc);
     closePeerConnection(answerPc);
 
-    pKvsDataChannel = (PKvsDataChannel) pOfferDataChannel;
-    pSctpSession = ((PKvsPeerConnection) pKvsDataChannel->pRtcPeerConnection)->pSctpSession;
+    // The DATA_CHANNEL_OPEN carries the reliability of the channel to the peer and is itself sent in order
+    ASSERT_LE(SCTP_DCEP_HEADER_LENGTH, dcepOpen.size());
+    EXPECT_EQ(DCEP_DATA_CHANNEL_OPEN, dcepOpen[0]);
+    EXPECT_EQ(DCEP_DATA_CHANNEL_TIMED, dcepOpen[1]);
+    EXPECT_EQ(rtcDataChannelInit.maxPacketLifeTime.value, (UINT32) getUnalignedInt32BigEndian(dcepOpen.data() + SIZEOF(UINT32)));
+    EXPECT_EQ(0, dcepOpenFlags & SCTP_DATA_CHUNK_FLAG_UNORDERED);
 
-    ASSERT_NE(pSctpSession->spa.sendv_sndinfo.snd_flags, SCTP_UNORDERED);
-    ASSERT_EQ(pSctpSession->spa.sendv_prinfo.pr_policy, SCTP_PR_SCTP_TTL);
-    ASSERT_EQ(pSctpSession->spa.sendv_prinfo.pr_value, rtcDataChannelInit.maxPacketLifeTime.value);
+    // Messages of the channel follow its ordering
+    EXPECT_EQ(STRLEN(TEST_DATA_CHANNEL_MESSAGE), message.size());
+    EXPECT_EQ(0, messageFlags & SCTP_DATA_CHUNK_FLAG_UNORDERED);
 
     freePeerConnection(&offerPc);
     freePeerConnection(&answerPc);
@@ -430,8 +664,8 @@ TEST_F(DataChannelFunctionalityTest, createDataChannel_PartialReliabilityOrdered
     PRtcDataChannel pOfferDataChannel = nullptr, pAnswerDataChannel = nullptr;
     SIZE_T datachannelLocalOpenCount = 0, msgCount = 0;
     RtcDataChannelInit rtcDataChannelInit;
-    PSctpSession pSctpSession = NULL;
-    PKvsDataChannel pKvsDataChannel = NULL;
+    std::vector<BYTE> dcepOpen, message;
+    BYTE dcepOpenFlags = 0, messageFlags = 0;
     RemoteOpen remoteOpen{};
 
     MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
@@ -477,32 +711,48 @@ TEST_F(DataChannelFunctionalityTest, createDataChannel_PartialReliabilityOrdered
     EXPECT_EQ(peerConnectionOnDataChannel(offerPc, (UINT64) &remoteOpen, onDataChannel), STATUS_SUCCESS);
     EXPECT_EQ(peerConnectionOnDataChannel(answerPc, (UINT64) &remoteOpen, onDataChannel), STATUS_SUCCESS);
 
-    // Create two DataChannels
-    EXPECT_EQ(createDataChannel(offerPc, (PCHAR) "Offer PeerConnection", &rtcDataChannelInit, &pOfferDataChannel), STATUS_SUCCESS);
+    // The partially reliable channel is created once the association is up, so its DATA_CHANNEL_OPEN can be captured
     EXPECT_EQ(createDataChannel(answerPc, (PCHAR) "Answer PeerConnection", NULL, &pAnswerDataChannel), STATUS_SUCCESS);
-
-    EXPECT_EQ(dataChannelOnOpen(pOfferDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
     EXPECT_EQ(dataChannelOnOpen(pAnswerDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
-
-    EXPECT_EQ(dataChannelOnMessage(pOfferDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
     EXPECT_EQ(dataChannelOnMessage(pAnswerDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
 
     EXPECT_EQ(connectTwoPeers(offerPc, answerPc), TRUE);
 
+    for (auto i = 0; i <= 100 && ATOMIC_LOAD(&datachannelLocalOpenCount) == 0; i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    startSctpCapture(offerPc);
+
+    EXPECT_EQ(createDataChannel(offerPc, (PCHAR) "Offer PeerConnection", &rtcDataChannelInit, &pOfferDataChannel), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelOnOpen(pOfferDataChannel, (UINT64) &datachannelLocalOpenCount, dataChannelOnOpenCallback), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelOnMessage(pOfferDataChannel, (UINT64) &msgCount, dataChannelOnMessageCallback), STATUS_SUCCESS);
+    EXPECT_EQ(dataChannelSend(pOfferDataChannel, FALSE, (PBYTE) TEST_DATA_CHANNEL_MESSAGE, STRLEN(TEST_DATA_CHANNEL_MESSAGE)), STATUS_SUCCESS);
+
     // Busy wait until DataChannels connect and send a message
     for (auto i = 0; i <= 100 && (ATOMIC_LOAD(&datachannelLocalOpenCount) + ATOMIC_LOAD(&msgCount)) != 4 ; i++) {
         THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_SECOND);
     }
 
-    // Close the connection to avoid data race while accessing SctpSession
+    for (auto i = 0; i <= 100 &&
+         !(findCapturedDataChunk(pOfferDataChannel->id, SCTP_PPID_DCEP, &dcepOpenFlags, &dcepOpen) &&
+           findCapturedDataChunk(pOfferDataChannel->id, SCTP_PPID_STRING, &messageFlags, &message));
+         i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
     closePeerConnection(offerPc);
     closePeerConnection(answerPc);
-    pKvsDataChannel = (PKvsDataChannel) pOfferDataChannel;
-    pSctpSession = ((PKvsPeerConnection) pKvsDataChannel->pRtcPeerConnection)->pSctpSession;
-    
-    ASSERT_NE(pSctpSession->spa.sendv_sndinfo.snd_flags, SCTP_UNORDERED);
-    ASSERT_EQ(pSctpSession->spa.sendv_prinfo.pr_policy, SCTP_PR_SCTP_RTX);
-    ASSERT_EQ(pSctpSession->spa.sendv_prinfo.pr_value, rtcDataChannelInit.maxRetransmits.value);
+
+    // The DATA_CHANNEL_OPEN carries the reliability of the channel to the peer and is itself sent in order
+    ASSERT_LE(SCTP_DCEP_HEADER_LENGTH, dcepOpen.size());
+    EXPECT_EQ(DCEP_DATA_CHANNEL_OPEN, dcepOpen[0]);
+    EXPECT_EQ(DCEP_DATA_CHANNEL_REXMIT, dcepOpen[1]);
+    EXPECT_EQ(rtcDataChannelInit.maxRetransmits.value, (UINT32) getUnalignedInt32BigEndian(dcepOpen.data() + SIZEOF(UINT32)));
+    EXPECT_EQ(0, dcepOpenFlags & SCTP_DATA_CHUNK_FLAG_UNORDERED);
+
+    // Messages of the channel follow its ordering
+    EXPECT_EQ(STRLEN(TEST_DATA_CHANNEL_MESSAGE), message.size());
+    EXPECT_EQ(0, messageFlags & SCTP_DATA_CHUNK_FLAG_UNORDERED);
 
     freePeerConnection(&offerPc);
     freePeerConnection(&answerPc);
@@ -590,6 +840,441 @@ TEST_F(DataChannelFunctionalityTest, createDataChannel_DataChannelMetricsTest)
     freePeerConnection(&answerPc);
 }
 
+// Two PeerConnections connected over an in-memory DTLS/SCTP loopback, one sends as fast as the
+// non-blocking DataChannel lets it and backs off until bufferedAmount drains
+TEST_F(DataChannelFunctionalityTest, dataChannelNonBlockingSendThroughputOverLoopback)
+{
+    const UINT32 messageSize = 16 * 1024, messageCount = 512;
+    const UINT64 lowThreshold = 64 * 1024;
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+    PRtcDataChannel pOfferDataChannel = nullptr;
+    LoopbackTransfer transfer;
+    std::vector<BYTE> message(messageSize, 0x5a);
+    UINT32 sentCount = 0, wouldBlockCount = 0;
+    UINT64 bufferedAmount = 0, deadline;
+    STATUS sendStatus;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &offerPc));
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &answerPc));
+
+    auto onMessage = [](UINT64 customData, PRtcDataChannel pDataChannel, BOOL isBinary, PBYTE pMsg, UINT32 pMsgLen) {
+        UNUSED_PARAM(pDataChannel);
+        UNUSED_PARAM(isBinary);
+        UNUSED_PARAM(pMsg);
+        ((LoopbackTransfer*) customData)->bytesReceived += pMsgLen;
+    };
+    auto onDataChannel = [](UINT64 customData, PRtcDataChannel pRtcDataChannel) {
+        ((LoopbackTransfer*) customData)->pRemoteDataChannel = pRtcDataChannel;
+    };
+    auto onBufferedAmountLow = [](UINT64 customData, PRtcDataChannel pDataChannel, UINT64 amount) {
+        UNUSED_PARAM(pDataChannel);
+        UNUSED_PARAM(amount);
+        ((LoopbackTransfer*) customData)->bufferedAmountLowCount++;
+    };
+
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionOnDataChannel(answerPc, (UINT64) &transfer, onDataChannel));
+    EXPECT_EQ(STATUS_SUCCESS, createDataChannel(offerPc, (PCHAR) "Loopback", nullptr, &pOfferDataChannel));
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelSetNonBlocking(pOfferDataChannel, TRUE));
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelSetBufferedAmountLowThreshold(pOfferDataChannel, lowThreshold));
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelOnBufferedAmountLow(pOfferDataChannel, (UINT64) &transfer, onBufferedAmountLow));
+
+    startLoopback(offerPc, answerPc);
+
+    deadline = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (transfer.pRemoteDataChannel.load() == nullptr && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_TRUE(transfer.pRemoteDataChannel.load() != nullptr);
+    if (transfer.pRemoteDataChannel.load() != nullptr) {
+        // Nothing is received before the first send
+        EXPECT_EQ(STATUS_SUCCESS, dataChannelOnMessage(transfer.pRemoteDataChannel.load(), (UINT64) &transfer, onMessage));
+    }
+
+    deadline = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (transfer.pRemoteDataChannel.load() != nullptr && sentCount < messageCount && GETTIME() < deadline) {
+        sendStatus = dataChannelSend(pOfferDataChannel, TRUE, message.data(), messageSize);
+        if (sendStatus == STATUS_SCTP_SEND_WOULD_BLOCK) {
+            // Resume once the acknowledgements take the buffered amount to the threshold
+            wouldBlockCount++;
+            do {
+                THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+                EXPECT_EQ(STATUS_SUCCESS, dataChannelGetBufferedAmount(pOfferDataChannel, &bufferedAmount));
+            } while (bufferedAmount > lowThreshold && GETTIME() < deadline);
+            continue;
+        }
+        EXPECT_EQ(STATUS_SUCCESS, sendStatus);
+        if (STATUS_FAILED(sendStatus)) {
+            break;
+        }
+        sentCount++;
+
+        EXPECT_EQ(STATUS_SUCCESS, dataChannelGetBufferedAmount(pOfferDataChannel, &bufferedAmount));
+        EXPECT_LE(bufferedAmount, (UINT64) MAX_DATA_CHANNEL_BUFFERED_AMOUNT + messageSize);
+    }
+
+    while (transfer.bytesReceived.load() < (UINT64) messageCount * messageSize && GETTIME() < deadline) {
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    // The last SACK can be delayed
+    do {
+        EXPECT_EQ(STATUS_SUCCESS, dataChannelGetBufferedAmount(pOfferDataChannel, &bufferedAmount));
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    } while (bufferedAmount != 0 && GETTIME() < deadline);
+
+    stopLoopback();
+
+    closePeerConnection(offerPc);
+    closePeerConnection(answerPc);
+    freePeerConnection(&offerPc);
+    freePeerConnection(&answerPc);
+
+    // Everything goes through within the deadline, and the transfer is far larger than the buffered amount limit so the
+    // sender has to back off along the way
+    EXPECT_EQ(messageCount, sentCount);
+    EXPECT_EQ((UINT64) messageCount * messageSize, transfer.bytesReceived.load());
+    EXPECT_LT(0u, wouldBlockCount);
+    EXPECT_EQ((UINT64) 0, bufferedAmount);
+    EXPECT_LT(0u, transfer.bufferedAmountLowCount.load());
+}
+
+// With an MTU above the default the SCTP packets grow past the default size once probes confirm the larger ones get
+// through, and no datagram ever exceeds the MTU less the IP and UDP headers
+TEST_F(DataChannelFunctionalityTest, dataChannelPathMtuProbingOverLoopback)
+{
+    const UINT16 mtu = 9000;
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+    PRtcDataChannel pOfferDataChannel = nullptr;
+    PSctpSession pSctpSession = NULL;
+    LoopbackTransfer transfer;
+    std::vector<BYTE> message(16 * 1024, 0x5a);
+    UINT64 deadline;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    configuration.kvsRtcConfiguration.maximumTransmissionUnit = mtu;
+
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &offerPc));
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &answerPc));
+
+    auto onDataChannel = [](UINT64 customData, PRtcDataChannel pRtcDataChannel) {
+        ((LoopbackTransfer*) customData)->pRemoteDataChannel = pRtcDataChannel;
+    };
+
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionOnDataChannel(answerPc, (UINT64) &transfer, onDataChannel));
+    EXPECT_EQ(STATUS_SUCCESS, createDataChannel(offerPc, (PCHAR) "Probe", nullptr, &pOfferDataChannel));
+
+    startLoopback(offerPc, answerPc);
+
+    deadline = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (transfer.pRemoteDataChannel.load() == nullptr && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_TRUE(transfer.pRemoteDataChannel.load() != nullptr);
+
+    // Probes go out as packets are received
+    pSctpSession = ((PKvsPeerConnection) offerPc)->pSctpSession;
+    EXPECT_TRUE(pSctpSession != NULL);
+    while (pSctpSession != NULL && pSctpSession->pmtuProbeState == SCTP_PMTU_PROBE_STATE_SEARCHING && GETTIME() < deadline) {
+        EXPECT_EQ(STATUS_SUCCESS, dataChannelSend(pOfferDataChannel, TRUE, message.data(), (UINT32) message.size()));
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    if (pSctpSession != NULL) {
+        EXPECT_EQ(SCTP_PMTU_PROBE_STATE_SEARCH_COMPLETE, pSctpSession->pmtuProbeState);
+        EXPECT_LT(pSctpSession->basePacketSize, pSctpSession->packetSize);
+        EXPECT_EQ(pSctpSession->maxPacketSize, pSctpSession->packetSize);
+    }
+
+    stopLoopback();
+
+    EXPECT_GE((UINT32) mtu - PEER_CONNECTION_IP_UDP_OVERHEAD, toAnswer.largestPacketSize);
+    EXPECT_GE((UINT32) mtu - PEER_CONNECTION_IP_UDP_OVERHEAD, toOffer.largestPacketSize);
+
+    closePeerConnection(offerPc);
+    closePeerConnection(answerPc);
+    freePeerConnection(&offerPc);
+    freePeerConnection(&answerPc);
+}
+
+// Messages taken over through the owned message callback have to stay intact after it returns, until they are freed
+TEST_F(DataChannelFunctionalityTest, dataChannelOwnedMessageOutlivesCallback)
+{
+    const UINT32 messageCount = 50;
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+    PRtcDataChannel pOfferDataChannel = nullptr;
+    OwnedMessages owned;
+    BYTE message[1000];
+    UINT64 deadline;
+    UINT32 i, received = 0;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &offerPc));
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &answerPc));
+
+    auto onMessage = [](UINT64 customData, PRtcDataChannel pDataChannel, BOOL isBinary, PBYTE pMsg, UINT32 pMsgLen) {
+        UNUSED_PARAM(pDataChannel);
+        UNUSED_PARAM(isBinary);
+        UNUSED_PARAM(pMsg);
+        UNUSED_PARAM(pMsgLen);
+        ((OwnedMessages*) customData)->copiedCount++;
+    };
+    auto onOwnedMessage = [](UINT64 customData, PRtcDataChannel pDataChannel, BOOL isBinary, PBYTE pMsg, UINT32 pMsgLen) {
+        OwnedMessages* pOwned = (OwnedMessages*) customData;
+        UNUSED_PARAM(pDataChannel);
+        UNUSED_PARAM(isBinary);
+        std::lock_guard<std::mutex> lock(pOwned->lock);
+        pOwned->messages.push_back(std::make_pair(pMsg, pMsgLen));
+    };
+    auto onDataChannel = [](UINT64 customData, PRtcDataChannel pRtcDataChannel) {
+        ((OwnedMessages*) customData)->pRemoteDataChannel = pRtcDataChannel;
+    };
+
+    EXPECT_EQ(STATUS_NULL_ARG, dataChannelOnOwnedMessage(nullptr, 0, onOwnedMessage));
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionOnDataChannel(answerPc, (UINT64) &owned, onDataChannel));
+    EXPECT_EQ(STATUS_SUCCESS, createDataChannel(offerPc, (PCHAR) "Owned", nullptr, &pOfferDataChannel));
+    EXPECT_EQ(STATUS_NULL_ARG, dataChannelOnOwnedMessage(pOfferDataChannel, 0, nullptr));
+
+    startLoopback(offerPc, answerPc);
+
+    deadline = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (owned.pRemoteDataChannel.load() == nullptr && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    ASSERT_TRUE(owned.pRemoteDataChannel.load() != nullptr);
+
+    // The owned message callback takes precedence
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelOnMessage(owned.pRemoteDataChannel.load(), (UINT64) &owned, onMessage));
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelOnOwnedMessage(owned.pRemoteDataChannel.load(), (UINT64) &owned, onOwnedMessage));
+
+    for (i = 0; i < messageCount; i++) {
+        MEMSET(message, (BYTE) i, SIZEOF(message));
+        EXPECT_EQ(STATUS_SUCCESS, dataChannelSend(pOfferDataChannel, TRUE, message, SIZEOF(message) - i));
+    }
+
+    while (received < messageCount && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        std::lock_guard<std::mutex> lock(owned.lock);
+        received = (UINT32) owned.messages.size();
+    }
+
+    stopLoopback();
+
+    EXPECT_EQ(messageCount, received);
+    EXPECT_EQ(0u, owned.copiedCount.load());
+    for (i = 0; i < owned.messages.size(); i++) {
+        MEMSET(message, (BYTE) i, SIZEOF(message));
+        EXPECT_EQ(SIZEOF(message) - i, owned.messages[i].second);
+        EXPECT_EQ(0, MEMCMP(message, owned.messages[i].first, owned.messages[i].second));
+        dataChannelFreeMessage(owned.messages[i].first);
+    }
+    dataChannelFreeMessage(nullptr);
+
+    closePeerConnection(offerPc);
+    closePeerConnection(answerPc);
+    freePeerConnection(&offerPc);
+    freePeerConnection(&answerPc);
+}
+
+// Messages sent from one thread per DataChannel at the same time have to arrive on the stream and with the PPID they
+// were sent with, in order
+TEST_F(DataChannelFunctionalityTest, dataChannelConcurrentSendFromMultipleThreads)
+{
+    const UINT32 messageCount = 200;
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+    PRtcDataChannel pOfferDataChannels[STRESS_DATA_CHANNEL_COUNT];
+    ConcurrentSendCheck check;
+    std::vector<std::thread> senders;
+    std::atomic<UINT32> sendFailures{0};
+    CHAR name[MAX_DATA_CHANNEL_NAME_LEN + 1];
+    UINT64 deadline, bufferedAmount, totalBufferedAmount;
+    UINT32 i;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &offerPc));
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &answerPc));
+
+    auto onDataChannel = [](UINT64 customData, PRtcDataChannel pRtcDataChannel) {
+        ConcurrentSendCheck* pCheck = (ConcurrentSendCheck*) customData;
+        dataChannelOnMessage(pRtcDataChannel, customData, ConcurrentSendCheck::onMessage);
+        pCheck->remoteChannelCount++;
+    };
+
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionOnDataChannel(answerPc, (UINT64) &check, onDataChannel));
+    for (i = 0; i < STRESS_DATA_CHANNEL_COUNT; i++) {
+        SNPRINTF(name, ARRAY_SIZE(name), "Stress%u", i);
+        EXPECT_EQ(STATUS_SUCCESS, createDataChannel(offerPc, name, nullptr, &pOfferDataChannels[i]));
+    }
+
+    startLoopback(offerPc, answerPc);
+
+    deadline = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (check.remoteChannelCount.load() != STRESS_DATA_CHANNEL_COUNT && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_EQ(STRESS_DATA_CHANNEL_COUNT, check.remoteChannelCount.load());
+
+    for (i = 0; i < STRESS_DATA_CHANNEL_COUNT && check.remoteChannelCount.load() == STRESS_DATA_CHANNEL_COUNT; i++) {
+        senders.emplace_back([&, i]() {
+            BYTE message[1 + SIZEOF(UINT32) + 6 * 100];
+            UINT32 sequence = 0, messageLen;
+            STATUS sendStatus;
+
+            MEMSET(message, 0x00, SIZEOF(message));
+            message[0] = (BYTE) i;
+            while (sequence < messageCount && GETTIME() < deadline) {
+                putUnalignedInt32BigEndian(message + 1, sequence);
+                messageLen = 1 + SIZEOF(UINT32) + (sequence % 7) * 100;
+                sendStatus = dataChannelSend(pOfferDataChannels[i], i % 2 == 0, message, messageLen);
+                if (sendStatus == STATUS_SCTP_SEND_WOULD_BLOCK) {
+                    THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+                } else if (STATUS_FAILED(sendStatus)) {
+                    sendFailures++;
+                    break;
+                } else {
+                    sequence++;
+                }
+            }
+        });
+    }
+    for (auto& sender : senders) {
+        sender.join();
+    }
+
+    // Everything has arrived once nothing is left to acknowledge
+    do {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        totalBufferedAmount = 0;
+        for (i = 0; i < STRESS_DATA_CHANNEL_COUNT; i++) {
+            EXPECT_EQ(STATUS_SUCCESS, dataChannelGetBufferedAmount(pOfferDataChannels[i], &bufferedAmount));
+            totalBufferedAmount += bufferedAmount;
+        }
+    } while (totalBufferedAmount != 0 && GETTIME() < deadline);
+
+    stopLoopback();
+
+    closePeerConnection(offerPc);
+    closePeerConnection(answerPc);
+    freePeerConnection(&offerPc);
+    freePeerConnection(&answerPc);
+
+    EXPECT_EQ(0u, sendFailures.load());
+    EXPECT_EQ(0u, check.mismatchCount.load());
+    EXPECT_EQ((UINT64) 0, totalBufferedAmount);
+    for (i = 0; i < STRESS_DATA_CHANNEL_COUNT; i++) {
+        EXPECT_EQ(messageCount, check.messagesReceived[i].load());
+    }
+}
+
+// A DataChannel created on the established association is announced with DATA_CHANNEL_OPEN on a stream id of the
+// parity of the DTLS role, opens on the acknowledgement and closes on both ends by stream reset
+TEST_F(DataChannelFunctionalityTest, dataChannelOpenAndCloseOnEstablishedAssociation)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+    PRtcDataChannel pInitialDataChannel = nullptr, pLateDataChannel = nullptr;
+    DataChannelLifecycle initial, local, remote;
+    BYTE message[100];
+    UINT64 deadline;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(message, 0x00, SIZEOF(message));
+
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &offerPc));
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &answerPc));
+
+    auto onDataChannel = [](UINT64 customData, PRtcDataChannel pRtcDataChannel) {
+        DataChannelLifecycle* pLifecycle = (DataChannelLifecycle*) customData;
+        dataChannelOnClose(pRtcDataChannel, customData, DataChannelLifecycle::onClose);
+        pLifecycle->pRemoteDataChannel = pRtcDataChannel;
+    };
+
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionOnDataChannel(answerPc, (UINT64) &initial, onDataChannel));
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionOnDataChannel(offerPc, (UINT64) &remote, onDataChannel));
+    EXPECT_EQ(STATUS_SUCCESS, createDataChannel(offerPc, (PCHAR) "Initial", nullptr, &pInitialDataChannel));
+
+    // Needs the association
+    EXPECT_EQ(STATUS_INVALID_OPERATION, dataChannelClose(pInitialDataChannel));
+
+    startLoopback(offerPc, answerPc);
+
+    deadline = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (initial.pRemoteDataChannel.load() == nullptr && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    ASSERT_TRUE(initial.pRemoteDataChannel.load() != nullptr);
+
+    // The answerer is the DTLS server and takes odd stream ids
+    ASSERT_EQ(STATUS_SUCCESS, createDataChannel(answerPc, (PCHAR) "Late", nullptr, &pLateDataChannel));
+    EXPECT_EQ(1u, pLateDataChannel->id % 2);
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelOnOpen(pLateDataChannel, (UINT64) &local, DataChannelLifecycle::onOpen));
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelOnClose(pLateDataChannel, (UINT64) &local, DataChannelLifecycle::onClose));
+
+    while ((remote.pRemoteDataChannel.load() == nullptr || local.openCount.load() == 0) && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    ASSERT_TRUE(remote.pRemoteDataChannel.load() != nullptr);
+    EXPECT_STREQ("Late", remote.pRemoteDataChannel.load()->name);
+    EXPECT_EQ(pLateDataChannel->id, remote.pRemoteDataChannel.load()->id);
+    EXPECT_EQ(1u, local.openCount.load());
+    EXPECT_EQ(RTC_DATA_CHANNEL_STATE_OPEN, ((PKvsDataChannel) pLateDataChannel)->rtcDataChannelDiagnostics.state);
+
+    // Fired right away on an open channel
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelOnOpen(pLateDataChannel, (UINT64) &local, DataChannelLifecycle::onOpen));
+    EXPECT_EQ(2u, local.openCount.load());
+
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelSend(pLateDataChannel, TRUE, message, SIZEOF(message)));
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelClose(pLateDataChannel));
+    EXPECT_EQ(STATUS_SCTP_DATA_CHANNEL_CLOSED, dataChannelSend(pLateDataChannel, TRUE, message, SIZEOF(message)));
+
+    while ((local.closeCount.load() == 0 || remote.closeCount.load() == 0) && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    // Closing again is a no-op, the channel closed earlier stays open
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelClose(pLateDataChannel));
+    EXPECT_EQ(STATUS_SUCCESS, dataChannelSend(pInitialDataChannel, TRUE, message, SIZEOF(message)));
+
+    stopLoopback();
+
+    EXPECT_EQ(1u, local.closeCount.load());
+    EXPECT_EQ(1u, remote.closeCount.load());
+    EXPECT_EQ(0u, initial.closeCount.load());
+    EXPECT_EQ(RTC_DATA_CHANNEL_STATE_CLOSED, ((PKvsDataChannel) pLateDataChannel)->rtcDataChannelDiagnostics.state);
+    EXPECT_EQ(RTC_DATA_CHANNEL_STATE_CLOSED, ((PKvsDataChannel) remote.pRemoteDataChannel.load())->rtcDataChannelDiagnostics.state);
+
+    closePeerConnection(offerPc);
+    closePeerConnection(answerPc);
+    freePeerConnection(&offerPc);
+    freePeerConnection(&answerPc);
+}
+
+TEST_F(DataChannelFunctionalityTest, handleDcepPacket_TruncatedOpenRejected)
+{
+    SctpSession sctpSession;
+    UINT32 openCount = 0;
+    // DATA_CHANNEL_OPEN with a 5 byte label and a 3 byte protocol
+    BYTE packet[] = {DCEP_DATA_CHANNEL_OPEN, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05,
+                     0x00,                   0x03, 'l',  'a',  'b',  'e',  'l',  'p',  'r',  'o'};
+
+    MEMSET(&sctpSession, 0x00, SIZEOF(SctpSession));
+    sctpSession.sctpSessionCallbacks.customData = (UINT64) &openCount;
+    sctpSession.sctpSessionCallbacks.dataChannelOpenFunc = [](UINT64 customData, UINT32, PBYTE, UINT32) { (*(PUINT32) customData)++; };
+
+    // Cut in the protocol, in the label and right after the header
+    EXPECT_EQ(STATUS_SCTP_INVALID_DCEP_PACKET, handleDcepPacket(&sctpSession, 1, packet, SIZEOF(packet) - 1));
+    EXPECT_EQ(STATUS_SCTP_INVALID_DCEP_PACKET, handleDcepPacket(&sctpSession, 1, packet, SCTP_DCEP_HEADER_LENGTH + 2));
+    EXPECT_EQ(STATUS_SCTP_INVALID_DCEP_PACKET, handleDcepPacket(&sctpSession, 1, packet, SCTP_DCEP_HEADER_LENGTH));
+    EXPECT_EQ(0u, openCount);
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
@@ -0,0 +1,347 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define TEST_FLEXFEC_PROTECTED_SSRC 0x11223344
+#define TEST_FLEXFEC_SSRC           0x55667788
+#define TEST_FLEXFEC_PAYLOAD_TYPE   124
+
+class FlexFecFunctionalityTest : public WebRtcClientTestBase {
+  public:
+    static STATUS collectRecoveredPacket(UINT64 customData, PBYTE pRawPacket, UINT32 rawPacketLength)
+    {
+        std::vector<std::vector<BYTE>>* pRecovered = (std::vector<std::vector<BYTE>>*) customData;
+
+        pRecovered->push_back(std::vector<BYTE>(pRawPacket, pRawPacket + rawPacketLength));
+        MEMFREE(pRawPacket);
+        return STATUS_SUCCESS;
+    }
+
+    static std::vector<BYTE> makeMediaPacket(UINT16 sequenceNumber, UINT32 timestamp, BOOL marker, UINT32 payloadLength, BOOL extension)
+    {
+        std::vector<BYTE> packet(MIN_HEADER_LENGTH + (extension ? 8 : 0) + payloadLength);
+        UINT32 i, offset = MIN_HEADER_LENGTH;
+
+        packet[0] = 0x80 | (extension ? 0x10 : 0x00);
+        packet[1] = (marker ? 0x80 : 0x00) | 96;
+        putUnalignedInt16BigEndian(&packet[SEQ_NUMBER_OFFSET], sequenceNumber);
+        putUnalignedInt32BigEndian(&packet[TIMESTAMP_OFFSET], timestamp);
+        putUnalignedInt32BigEndian(&packet[SSRC_OFFSET], TEST_FLEXFEC_PROTECTED_SSRC);
+        if (extension) {
+            putUnalignedInt16BigEndian(&packet[offset], TWCC_EXT_PROFILE);
+            putUnalignedInt16BigEndian(&packet[offset + 2], 1);
+            putUnalignedInt32BigEndian(&packet[offset + 4], 0x12345678);
+            offset += 8;
+        }
+        for (i = 0; i < payloadLength; i++) {
+            packet[offset + i] = (BYTE) (sequenceNumber * 31 + i);
+        }
+
+        return packet;
+    }
+
+    static std::vector<std::vector<BYTE>> protectFrame(PFlexFecEncoder pFlexFecEncoder, std::vector<std::vector<BYTE>>& mediaPackets,
+                                                       UINT32 timestamp)
+    {
+        std::vector<std::vector<BYTE>> repairPackets;
+        PayloadArray payloadArray;
+        UINT32 i, offset = 0;
+
+        MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+        EXPECT_EQ(STATUS_SUCCESS, flexFecEncoderStartFrame(pFlexFecEncoder, (UINT32) mediaPackets.size(), timestamp));
+        for (i = 0; i < mediaPackets.size(); i++) {
+            EXPECT_EQ(STATUS_SUCCESS, flexFecEncoderProtectPacket(pFlexFecEncoder, mediaPackets[i].data(), (UINT32) mediaPackets[i].size()));
+        }
+        EXPECT_EQ(STATUS_SUCCESS, flexFecEncoderFinishFrame(pFlexFecEncoder, &payloadArray));
+        for (i = 0; i < payloadArray.payloadSubLenSize; i++) {
+            repairPackets.push_back(
+                std::vector<BYTE>(payloadArray.payloadBuffer + offset, payloadArray.payloadBuffer + offset + payloadArray.payloadSubLength[i]));
+            offset += payloadArray.payloadSubLength[i];
+        }
+        SAFE_MEMFREE(payloadArray.payloadBuffer);
+        SAFE_MEMFREE(payloadArray.payloadSubLength);
+
+        return repairPackets;
+    }
+};
+
+TEST_F(FlexFecFunctionalityTest, noRepairPacketsWithoutLoss)
+{
+    PFlexFecEncoder pFlexFecEncoder = NULL;
+    std::vector<std::vector<BYTE>> mediaPackets;
+    UINT16 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFlexFecEncoder(TEST_FLEXFEC_PROTECTED_SSRC, TEST_FLEXFEC_SSRC, TEST_FLEXFEC_PAYLOAD_TYPE, &pFlexFecEncoder));
+    for (i = 0; i < 10; i++) {
+        mediaPackets.push_back(makeMediaPacket(i, 1000, i == 9, 100, FALSE));
+    }
+
+    EXPECT_EQ(0, protectFrame(pFlexFecEncoder, mediaPackets, 1000).size());
+    EXPECT_EQ(STATUS_SUCCESS, flexFecEncoderUpdateLoss(pFlexFecEncoder, 0.001));
+    EXPECT_EQ(0, protectFrame(pFlexFecEncoder, mediaPackets, 1000).size());
+    EXPECT_EQ(STATUS_INVALID_ARG, flexFecEncoderUpdateLoss(pFlexFecEncoder, 1.5));
+
+    // Heavy loss is capped at FLEXFEC_MAX_REPAIR_RATE
+    EXPECT_EQ(STATUS_SUCCESS, flexFecEncoderUpdateLoss(pFlexFecEncoder, 1.0));
+    EXPECT_EQ(5, protectFrame(pFlexFecEncoder, mediaPackets, 1000).size());
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFlexFecEncoder(&pFlexFecEncoder));
+    EXPECT_EQ(NULL, pFlexFecEncoder);
+}
+
+TEST_F(FlexFecFunctionalityTest, recoversEveryPacketExactly)
+{
+    PFlexFecEncoder pFlexFecEncoder = NULL;
+    PFlexFecDecoder pFlexFecDecoder = NULL;
+    std::vector<std::vector<BYTE>> mediaPackets, repairPackets, recovered;
+    UINT32 i, j, lost;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFlexFecEncoder(TEST_FLEXFEC_PROTECTED_SSRC, TEST_FLEXFEC_SSRC, TEST_FLEXFEC_PAYLOAD_TYPE, &pFlexFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, flexFecEncoderUpdateLoss(pFlexFecEncoder, 1.0));
+
+    // Lengths differ so the shorter packets are zero padded, one carries a header extension and the last the marker bit
+    for (i = 0; i < 8; i++) {
+        mediaPackets.push_back(makeMediaPacket((UINT16) (65532 + i), 90000, i == 7, 50 + i * 131, i == 3));
+    }
+    repairPackets = protectFrame(pFlexFecEncoder, mediaPackets, 90000);
+    EXPECT_EQ(4, repairPackets.size());
+
+    for (lost = 0; lost < mediaPackets.size(); lost++) {
+        recovered.clear();
+        EXPECT_EQ(STATUS_SUCCESS, createFlexFecDecoder(TEST_FLEXFEC_PROTECTED_SSRC, collectRecoveredPacket, (UINT64) &recovered, &pFlexFecDecoder));
+        for (i = 0; i < mediaPackets.size(); i++) {
+            if (i != lost) {
+                EXPECT_EQ(STATUS_SUCCESS, flexFecDecoderAddMediaPacket(pFlexFecDecoder, mediaPackets[i].data(), (UINT32) mediaPackets[i].size()));
+            }
+        }
+        for (j = 0; j < repairPackets.size(); j++) {
+            EXPECT_EQ(STATUS_SUCCESS, flexFecDecoderAddRepairPacket(pFlexFecDecoder, repairPackets[j].data(), (UINT32) repairPackets[j].size()));
+        }
+
+        EXPECT_EQ(1, recovered.size());
+        if (recovered.size() == 1) {
+            EXPECT_TRUE(recovered[0] == mediaPackets[lost]);
+        }
+        EXPECT_EQ(1, pFlexFecDecoder->packetsRecovered);
+        // Every other repair packet had nothing to recover
+        EXPECT_EQ(repairPackets.size() - 1, pFlexFecDecoder->repairPacketsDiscarded);
+        EXPECT_EQ(STATUS_SUCCESS, freeFlexFecDecoder(&pFlexFecDecoder));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFlexFecEncoder(&pFlexFecEncoder));
+}
+
+TEST_F(FlexFecFunctionalityTest, recoversBurstLossOnceMediaArrives)
+{
+    PFlexFecEncoder pFlexFecEncoder = NULL;
+    PFlexFecDecoder pFlexFecDecoder = NULL;
+    std::vector<std::vector<BYTE>> mediaPackets, repairPackets, recovered;
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFlexFecEncoder(TEST_FLEXFEC_PROTECTED_SSRC, TEST_FLEXFEC_SSRC, TEST_FLEXFEC_PAYLOAD_TYPE, &pFlexFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, createFlexFecDecoder(TEST_FLEXFEC_PROTECTED_SSRC, collectRecoveredPacket, (UINT64) &recovered, &pFlexFecDecoder));
+    EXPECT_EQ(STATUS_SUCCESS, flexFecEncoderUpdateLoss(pFlexFecEncoder, 1.0));
+
+    for (i = 0; i < 12; i++) {
+        mediaPackets.push_back(makeMediaPacket((UINT16) (100 + i), 3000, i == 11, 200, FALSE));
+    }
+    repairPackets = protectFrame(pFlexFecEncoder, mediaPackets, 3000);
+    EXPECT_EQ(6, repairPackets.size());
+
+    // Repair packets overtake the media, they wait until a single protected packet is missing
+    for (i = 0; i < repairPackets.size(); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, flexFecDecoderAddRepairPacket(pFlexFecDecoder, repairPackets[i].data(), (UINT32) repairPackets[i].size()));
+    }
+    EXPECT_EQ(6, pFlexFecDecoder->pendingRepairCount);
+
+    // Packets 3 to 8 are lost in a burst, each of them is protected by a different repair packet
+    for (i = 0; i < mediaPackets.size(); i++) {
+        if (i < 3 || i > 8) {
+            EXPECT_EQ(STATUS_SUCCESS, flexFecDecoderAddMediaPacket(pFlexFecDecoder, mediaPackets[i].data(), (UINT32) mediaPackets[i].size()));
+        }
+    }
+
+    EXPECT_EQ(6, recovered.size());
+    for (i = 0; i < recovered.size(); i++) {
+        EXPECT_TRUE(recovered[i] == mediaPackets[getUnalignedInt16BigEndian(recovered[i].data() + SEQ_NUMBER_OFFSET) - 100]);
+    }
+    EXPECT_EQ(0, pFlexFecDecoder->pendingRepairCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFlexFecDecoder(&pFlexFecDecoder));
+    EXPECT_EQ(STATUS_SUCCESS, freeFlexFecEncoder(&pFlexFecEncoder));
+}
+
+TEST_F(FlexFecFunctionalityTest, largeFramesUseLongMasksAndBlocks)
+{
+    PFlexFecEncoder pFlexFecEncoder = NULL;
+    PFlexFecDecoder pFlexFecDecoder = NULL;
+    std::vector<std::vector<BYTE>> mediaPackets, repairPackets, recovered;
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFlexFecEncoder(TEST_FLEXFEC_PROTECTED_SSRC, TEST_FLEXFEC_SSRC, TEST_FLEXFEC_PAYLOAD_TYPE, &pFlexFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, createFlexFecDecoder(TEST_FLEXFEC_PROTECTED_SSRC, collectRecoveredPacket, (UINT64) &recovered, &pFlexFecDecoder));
+    // 1% repair packets: two for the full block of 110 packets, one for the remaining 20
+    ATOMIC_STORE(&pFlexFecEncoder->repairRate, 10);
+
+    for (i = 0; i < 130; i++) {
+        mediaPackets.push_back(makeMediaPacket((UINT16) i, 6000, i == 129, 60, FALSE));
+    }
+    repairPackets = protectFrame(pFlexFecEncoder, mediaPackets, 6000);
+    ASSERT_EQ(3, repairPackets.size());
+    EXPECT_EQ(FLEXFEC_MAX_REPAIR_HEADER_SIZE + 60, repairPackets[0].size());
+    EXPECT_EQ(FLEXFEC_MAX_REPAIR_HEADER_SIZE - FLEXFEC_MASK_LONG_SIZE + FLEXFEC_MASK_MEDIUM_SIZE + 60, repairPackets[2].size());
+
+    // One loss in each block, and one in each half of the first block
+    for (i = 0; i < mediaPackets.size(); i++) {
+        if (i != 0 && i != 109 && i != 125) {
+            EXPECT_EQ(STATUS_SUCCESS, flexFecDecoderAddMediaPacket(pFlexFecDecoder, mediaPackets[i].data(), (UINT32) mediaPackets[i].size()));
+        }
+    }
+    for (i = 0; i < repairPackets.size(); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, flexFecDecoderAddRepairPacket(pFlexFecDecoder, repairPackets[i].data(), (UINT32) repairPackets[i].size()));
+    }
+
+    EXPECT_EQ(3, recovered.size());
+    for (i = 0; i < recovered.size(); i++) {
+        EXPECT_TRUE(recovered[i] == mediaPackets[getUnalignedInt16BigEndian(recovered[i].data() + SEQ_NUMBER_OFFSET)]);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFlexFecDecoder(&pFlexFecDecoder));
+    EXPECT_EQ(STATUS_SUCCESS, freeFlexFecEncoder(&pFlexFecEncoder));
+}
+
+TEST_F(FlexFecFunctionalityTest, discardsMalformedAndUnsupportedRepairPackets)
+{
+    PFlexFecEncoder pFlexFecEncoder = NULL;
+    PFlexFecDecoder pFlexFecDecoder = NULL;
+    std::vector<std::vector<BYTE>> mediaPackets, repairPackets, recovered;
+    std::vector<BYTE> repairPacket;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFlexFecEncoder(TEST_FLEXFEC_PROTECTED_SSRC, TEST_FLEXFEC_SSRC, TEST_FLEXFEC_PAYLOAD_TYPE, &pFlexFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, createFlexFecDecoder(TEST_FLEXFEC_PROTECTED_SSRC, collectRecoveredPacket, (UINT64) &recovered, &pFlexFecDecoder));
+    EXPECT_EQ(STATUS_SUCCESS, flexFecEncoderUpdateLoss(pFlexFecEncoder, 1.0));
+    mediaPackets.push_back(makeMediaPacket(7, 100, TRUE, 40, FALSE));
+    repairPackets = protectFrame(pFlexFecEncoder, mediaPackets, 100);
+    ASSERT_EQ(1, repairPackets.size());
+
+    EXPECT_EQ(STATUS_NULL_ARG, flexFecDecoderAddRepairPacket(NULL, repairPackets[0].data(), (UINT32) repairPackets[0].size()));
+    EXPECT_EQ(STATUS_RTP_INVALID_FLEXFEC_PACKET, flexFecDecoderAddRepairPacket(pFlexFecDecoder, repairPackets[0].data(), 20));
+
+    // Not RTP version 2
+    repairPacket = repairPackets[0];
+    repairPacket[0] &= 0x3F;
+    EXPECT_EQ(STATUS_RTP_INVALID_FLEXFEC_PACKET, flexFecDecoderAddRepairPacket(pFlexFecDecoder, repairPacket.data(), (UINT32) repairPacket.size()));
+
+    // Medium mask without the k bit ending it, but too short for the long one
+    repairPacket = repairPackets[0];
+    repairPacket[FLEXFEC_RTP_HEADER_SIZE + FLEXFEC_HEADER_FIXED_SIZE + 2] &= ~FLEXFEC_MASK_K;
+    repairPacket[FLEXFEC_RTP_HEADER_SIZE + FLEXFEC_HEADER_FIXED_SIZE + 2 + FLEXFEC_MASK_SHORT_SIZE] &= ~FLEXFEC_MASK_K;
+    repairPacket.resize(FLEXFEC_RTP_HEADER_SIZE + FLEXFEC_HEADER_FIXED_SIZE + 2 + FLEXFEC_MASK_MEDIUM_SIZE);
+    EXPECT_EQ(STATUS_RTP_INVALID_FLEXFEC_PACKET, flexFecDecoderAddRepairPacket(pFlexFecDecoder, repairPacket.data(), (UINT32) repairPacket.size()));
+
+    // Protecting another stream
+    repairPacket = repairPackets[0];
+    putUnalignedInt32BigEndian(&repairPacket[CSRC_OFFSET], 0xdeadbeef);
+    EXPECT_EQ(STATUS_SUCCESS, flexFecDecoderAddRepairPacket(pFlexFecDecoder, repairPacket.data(), (UINT32) repairPacket.size()));
+
+    // Retransmission format
+    repairPacket = repairPackets[0];
+    repairPacket[FLEXFEC_RTP_HEADER_SIZE] |= FLEXFEC_HEADER_R;
+    EXPECT_EQ(STATUS_SUCCESS, flexFecDecoderAddRepairPacket(pFlexFecDecoder, repairPacket.data(), (UINT32) repairPacket.size()));
+
+    EXPECT_EQ(0, pFlexFecDecoder->pendingRepairCount);
+    EXPECT_EQ(5, pFlexFecDecoder->repairPacketsDiscarded);
+
+    // The intact repair packet still recovers the frame
+    EXPECT_EQ(STATUS_SUCCESS, flexFecDecoderAddRepairPacket(pFlexFecDecoder, repairPackets[0].data(), (UINT32) repairPackets[0].size()));
+    ASSERT_EQ(1, recovered.size());
+    EXPECT_TRUE(recovered[0] == mediaPackets[0]);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFlexFecDecoder(&pFlexFecDecoder));
+    EXPECT_EQ(STATUS_SUCCESS, freeFlexFecEncoder(&pFlexFecEncoder));
+}
+
+/*
+ * Sends frames over a link dropping media and repair packets alike, with the loss fed back to the encoder the way receiver
+ * reports do. Compares the share of frames arriving complete with and without recovery against the repair overhead.
+ */
+TEST_F(FlexFecFunctionalityTest, lossSimulationRecoversFrames)
+{
+    const DOUBLE lossRates[] = {0.02, 0.05, 0.10, 0.20};
+    const UINT32 frameCount = 2000, packetsPerFrame = 10;
+    PFlexFecEncoder pFlexFecEncoder = NULL;
+    PFlexFecDecoder pFlexFecDecoder = NULL;
+    std::vector<std::vector<BYTE>> mediaPackets, repairPackets, recovered;
+    std::vector<BOOL> received;
+    UINT32 i, frame, rate, seed = 12345, framesComplete, framesRecovered, mediaPacketsSent, repairPacketsSent;
+    UINT16 sequenceNumber = 0, recoveredSequenceNumber;
+    BOOL complete, repaired;
+
+    for (rate = 0; rate < ARRAY_SIZE(lossRates); rate++) {
+        EXPECT_EQ(STATUS_SUCCESS,
+                  createFlexFecEncoder(TEST_FLEXFEC_PROTECTED_SSRC, TEST_FLEXFEC_SSRC, TEST_FLEXFEC_PAYLOAD_TYPE, &pFlexFecEncoder));
+        EXPECT_EQ(STATUS_SUCCESS, createFlexFecDecoder(TEST_FLEXFEC_PROTECTED_SSRC, collectRecoveredPacket, (UINT64) &recovered, &pFlexFecDecoder));
+        framesComplete = framesRecovered = mediaPacketsSent = repairPacketsSent = 0;
+
+        for (frame = 0; frame < frameCount; frame++) {
+            EXPECT_EQ(STATUS_SUCCESS, flexFecEncoderUpdateLoss(pFlexFecEncoder, lossRates[rate]));
+            mediaPackets.clear();
+            for (i = 0; i < packetsPerFrame; i++) {
+                mediaPackets.push_back(makeMediaPacket(sequenceNumber++, frame * 3000, i == packetsPerFrame - 1, 300, FALSE));
+            }
+            repairPackets = protectFrame(pFlexFecEncoder, mediaPackets, frame * 3000);
+            mediaPacketsSent += packetsPerFrame;
+            repairPacketsSent += (UINT32) repairPackets.size();
+
+            // Deterministic linear congruential generator so the run is reproducible
+            recovered.clear();
+            received.assign(packetsPerFrame, FALSE);
+            complete = TRUE;
+            for (i = 0; i < packetsPerFrame + repairPackets.size(); i++) {
+                seed = seed * 1103515245 + 12345;
+                if ((DOUBLE) ((seed >> 16) & 0x7FFF) / 0x8000 < lossRates[rate]) {
+                    complete = complete && i >= packetsPerFrame;
+                } else if (i < packetsPerFrame) {
+                    received[i] = TRUE;
+                    EXPECT_EQ(STATUS_SUCCESS, flexFecDecoderAddMediaPacket(pFlexFecDecoder, mediaPackets[i].data(), (UINT32) mediaPackets[i].size()));
+                } else {
+                    EXPECT_EQ(STATUS_SUCCESS,
+                              flexFecDecoderAddRepairPacket(pFlexFecDecoder, repairPackets[i - packetsPerFrame].data(),
+                                                            (UINT32) repairPackets[i - packetsPerFrame].size()));
+                }
+            }
+
+            for (i = 0; i < recovered.size(); i++) {
+                recoveredSequenceNumber = (UINT16) getUnalignedInt16BigEndian(recovered[i].data() + SEQ_NUMBER_OFFSET);
+                EXPECT_TRUE(recovered[i] == mediaPackets[(UINT16) (recoveredSequenceNumber - (sequenceNumber - packetsPerFrame))]);
+                received[(UINT16) (recoveredSequenceNumber - (sequenceNumber - packetsPerFrame))] = TRUE;
+            }
+            repaired = TRUE;
+            for (i = 0; i < packetsPerFrame; i++) {
+                repaired = repaired && received[i];
+            }
+            framesComplete += complete ? 1 : 0;
+            framesRecovered += repaired ? 1 : 0;
+        }
+
+        DLOGI("loss %.0f%%: frames complete %.1f%% without FlexFEC, %.1f%% with FlexFEC at %.1f%% overhead", lossRates[rate] * 100,
+              100.0 * framesComplete / frameCount, 100.0 * framesRecovered / frameCount, 100.0 * repairPacketsSent / mediaPacketsSent);
+        EXPECT_GT(framesRecovered, framesComplete);
+        EXPECT_LE(repairPacketsSent, mediaPacketsSent * FLEXFEC_MAX_REPAIR_RATE);
+        // At least a third of the frames lost without recovery are repaired, most of them at low loss rates
+        EXPECT_LT((frameCount - framesRecovered) * 3, (frameCount - framesComplete) * 2);
+
+        EXPECT_EQ(STATUS_SUCCESS, freeFlexFecDecoder(&pFlexFecDecoder));
+        EXPECT_EQ(STATUS_SUCCESS, freeFlexFecEncoder(&pFlexFecEncoder));
+    }
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -1,3 +1,7 @@
+#include <regex>
+#include <set>
+#include <sstream>
+
 #include "WebRTCClientTestFixture.h"
 
 namespace com {
@@ -40,6 +44,295 @@ TEST_F(MetricsApiTest, webRtcGetMetrics)
     EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
 }
 
+// The media path updates RTP stats without statsLock, snapshots have to see either all or none of an update
+TEST_F(MetricsApiTest, webRtcRtpStatsSnapshotIsConsistent)
+{
+    const UINT32 updateCount = 200000;
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection;
+    RtcStats rtcMetrics;
+    RtcMediaStreamTrack videoTrack;
+    PRtcRtpTransceiver videoTransceiver;
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PRtcOutboundRtpStreamStats pOutboundStats = &rtcMetrics.rtcStatsObject.outboundRtpStreamStats;
+    std::atomic<bool> writing{true};
+    UINT32 snapshotCount = 0, tornCount = 0;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    addTrackToPeerConnection(pRtcPeerConnection, &videoTrack, &videoTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) videoTransceiver;
+
+    // Same updates as writeFrame for every packet
+    auto writeStats = [pKvsRtpTransceiver, updateCount]() {
+        for (UINT32 i = 0; i < updateCount; i++) {
+            RTP_STATS_UPDATE_BEGIN(&pKvsRtpTransceiver->outboundStatsSequence);
+            pKvsRtpTransceiver->outboundStats.sent.packetsSent++;
+            pKvsRtpTransceiver->outboundStats.sent.bytesSent += 1000;
+            pKvsRtpTransceiver->outboundStats.headerBytesSent += 12;
+            RTP_STATS_UPDATE_END(&pKvsRtpTransceiver->outboundStatsSequence);
+        }
+    };
+
+    // Holding statsLock doesn't hold up the media path
+    MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
+    std::thread(writeStats).join();
+    MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+
+    std::thread writer([&]() {
+        writeStats();
+        writing = false;
+    });
+
+    rtcMetrics.requestedTypeOfStats = RTC_STATS_TYPE_OUTBOUND_RTP;
+    while (writing) {
+        EXPECT_EQ(STATUS_SUCCESS, rtcPeerConnectionGetMetrics(pRtcPeerConnection, videoTransceiver, &rtcMetrics));
+        if (pOutboundStats->sent.bytesSent != 1000 * pOutboundStats->sent.packetsSent ||
+            pOutboundStats->headerBytesSent != 12 * pOutboundStats->sent.packetsSent) {
+            tornCount++;
+        }
+        snapshotCount++;
+    }
+    writer.join();
+
+    EXPECT_EQ(STATUS_SUCCESS, rtcPeerConnectionGetMetrics(pRtcPeerConnection, videoTransceiver, &rtcMetrics));
+    EXPECT_EQ(2 * updateCount, pOutboundStats->sent.packetsSent);
+    EXPECT_LT(0u, snapshotCount);
+    EXPECT_EQ(0u, tornCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, closePeerConnection(pRtcPeerConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+}
+
+TEST_F(MetricsApiTest, latencyHistogramPercentiles)
+{
+    PLatencyHistogram pLatencyHistogram = (PLatencyHistogram) MEMCALLOC(1, SIZEOF(LatencyHistogram));
+    LatencyHistogramStats stats;
+    UINT64 i;
+
+    EXPECT_EQ(STATUS_NULL_ARG, latencyHistogramGetStats(NULL, &stats));
+    EXPECT_EQ(STATUS_NULL_ARG, latencyHistogramGetStats(pLatencyHistogram, NULL));
+
+    EXPECT_EQ(STATUS_SUCCESS, latencyHistogramGetStats(pLatencyHistogram, &stats));
+    EXPECT_EQ(0, stats.count);
+    EXPECT_EQ(0, stats.p99);
+
+    // Below 32 every value has a bucket of its own
+    for (i = 1; i <= 20; i++) {
+        latencyHistogramRecord(pLatencyHistogram, i);
+    }
+    EXPECT_EQ(STATUS_SUCCESS, latencyHistogramGetStats(pLatencyHistogram, &stats));
+    EXPECT_EQ(20, stats.count);
+    EXPECT_EQ(1, stats.min);
+    EXPECT_EQ(20, stats.max);
+    EXPECT_EQ(10, stats.mean);
+    EXPECT_EQ(10, stats.p50);
+    EXPECT_EQ(18, stats.p90);
+    EXPECT_EQ(20, stats.p99);
+    EXPECT_EQ(20, stats.p999);
+
+    // Above that the buckets are at most ~3% wider than the values in them
+    MEMSET(pLatencyHistogram, 0x00, SIZEOF(LatencyHistogram));
+    for (i = 1; i <= 100000; i++) {
+        latencyHistogramRecord(pLatencyHistogram, i * 10);
+    }
+    EXPECT_EQ(STATUS_SUCCESS, latencyHistogramGetStats(pLatencyHistogram, &stats));
+    EXPECT_EQ(100000, stats.count);
+    EXPECT_EQ(10, stats.min);
+    EXPECT_NEAR(500000, stats.p50, 500000 * 0.032);
+    EXPECT_NEAR(900000, stats.p90, 900000 * 0.032);
+    EXPECT_NEAR(990000, stats.p99, 990000 * 0.032);
+    EXPECT_NEAR(999000, stats.p999, 999000 * 0.032);
+    EXPECT_NEAR(1000000, stats.max, 1000000 * 0.032);
+    EXPECT_NEAR(500005, stats.mean, 500005 * 0.032);
+    EXPECT_LE(stats.p50, stats.p90);
+    EXPECT_LE(stats.p90, stats.p99);
+    EXPECT_LE(stats.p99, stats.p999);
+    EXPECT_LE(stats.p999, stats.max);
+
+    // Latencies beyond 32 bits end up in the last bucket
+    latencyHistogramRecord(pLatencyHistogram, MAX_UINT64);
+    EXPECT_EQ(STATUS_SUCCESS, latencyHistogramGetStats(pLatencyHistogram, &stats));
+    EXPECT_EQ(100001, stats.count);
+    EXPECT_EQ(MAX_UINT32, stats.max);
+
+    MEMFREE(pLatencyHistogram);
+}
+
+TEST_F(MetricsApiTest, webRtcGetLatencyMetrics)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+    RtcMediaStreamTrack offerVideoTrack, answerVideoTrack;
+    PRtcRtpTransceiver offerVideoTransceiver, answerVideoTransceiver;
+    LatencyMetrics offerMetrics, answerMetrics;
+    Frame videoFrame;
+    UINT32 i;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
+    MEMSET(&offerMetrics, 0x00, SIZEOF(LatencyMetrics));
+    MEMSET(&answerMetrics, 0x00, SIZEOF(LatencyMetrics));
+
+    videoFrame.frameData = (PBYTE) MEMALLOC(TEST_VIDEO_FRAME_SIZE);
+    videoFrame.size = TEST_VIDEO_FRAME_SIZE;
+    MEMSET(videoFrame.frameData, 0x11, videoFrame.size);
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &offerPc));
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &answerPc));
+    EXPECT_EQ(STATUS_NULL_ARG, peerConnectionGetLatencyMetrics(NULL, &offerMetrics));
+    EXPECT_EQ(STATUS_NULL_ARG, peerConnectionGetLatencyMetrics(offerPc, NULL));
+
+    addTrackToPeerConnection(offerPc, &offerVideoTrack, &offerVideoTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    addTrackToPeerConnection(answerPc, &answerVideoTrack, &answerVideoTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+
+    EXPECT_EQ(TRUE, connectTwoPeers(offerPc, answerPc));
+
+    for (i = 0; i < 10; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, writeFrame(offerVideoTransceiver, &videoFrame));
+        videoFrame.presentationTs += HUNDREDS_OF_NANOS_IN_A_SECOND / 25;
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    MEMFREE(videoFrame.frameData);
+
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionGetLatencyMetrics(offerPc, &offerMetrics));
+    EXPECT_EQ(1, offerMetrics.stageLatency[LATENCY_STAGE_DTLS_HANDSHAKE].count);
+    EXPECT_LT(0, offerMetrics.stageLatency[LATENCY_STAGE_DTLS_HANDSHAKE].max);
+    EXPECT_LT(0, offerMetrics.stageLatency[LATENCY_STAGE_ICE_CHECK_RTT].count);
+    EXPECT_EQ(10, offerMetrics.stageLatency[LATENCY_STAGE_WRITE_FRAME].count);
+    EXPECT_LE(offerMetrics.stageLatency[LATENCY_STAGE_WRITE_FRAME].p50, offerMetrics.stageLatency[LATENCY_STAGE_WRITE_FRAME].p99);
+    // Every packet of every frame is encrypted
+    EXPECT_LT(10, offerMetrics.stageLatency[LATENCY_STAGE_SRTP].count);
+    EXPECT_EQ(0, offerMetrics.stageLatency[LATENCY_STAGE_SIGNALING_DISPATCH].count);
+
+    // The answerer decrypts and assembles the frames on its own threads, wait until the last ones have arrived
+    for (i = 0; i <= 100; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, peerConnectionGetLatencyMetrics(answerPc, &answerMetrics));
+        if (answerMetrics.stageLatency[LATENCY_STAGE_SRTP].count > 0 && answerMetrics.stageLatency[LATENCY_STAGE_FRAME_ASSEMBLY].count > 0) {
+            break;
+        }
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_EQ(1, answerMetrics.stageLatency[LATENCY_STAGE_DTLS_HANDSHAKE].count);
+    EXPECT_EQ(0, answerMetrics.stageLatency[LATENCY_STAGE_WRITE_FRAME].count);
+    EXPECT_LT(0, answerMetrics.stageLatency[LATENCY_STAGE_SRTP].count);
+    EXPECT_LT(0, answerMetrics.stageLatency[LATENCY_STAGE_FRAME_ASSEMBLY].count);
+
+    closePeerConnection(offerPc);
+    closePeerConnection(answerPc);
+    freePeerConnection(&offerPc);
+    freePeerConnection(&answerPc);
+}
+
+TEST_F(MetricsApiTest, exportOpenMetricsFormat)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    RtcMediaStreamTrack videoTrack;
+    PRtcRtpTransceiver pVideoTransceiver = NULL;
+    UINT32 size = 0, length;
+    std::string label = R"([a-zA-Z_][a-zA-Z0-9_]*="(?:[^"\\]|\\.)*")";
+    std::regex sampleLine("^[a-zA-Z_][a-zA-Z0-9_]*\\{" + label + "(?:," + label + ")*\\} \\S+$");
+    std::set<std::string> families;
+    std::string text, line, family;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&videoTrack, 0x00, SIZEOF(RtcMediaStreamTrack));
+
+    EXPECT_EQ(STATUS_NULL_ARG, exportOpenMetrics(NULL, NULL));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    EXPECT_EQ(STATUS_SUCCESS, addSupportedCodec(pRtcPeerConnection, RTC_CODEC_VP8));
+    videoTrack.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+    videoTrack.codec = RTC_CODEC_VP8;
+    STRCPY(videoTrack.streamId, "stream");
+    // Quotes and backslashes have to be escaped in label values
+    STRCPY(videoTrack.trackId, "my\"video\\track");
+    EXPECT_EQ(STATUS_SUCCESS, addTransceiver(pRtcPeerConnection, &videoTrack, NULL, &pVideoTransceiver));
+
+    EXPECT_EQ(STATUS_SUCCESS, exportOpenMetrics(NULL, &size));
+    std::unique_ptr<CHAR[]> buffer(new CHAR[size]);
+    length = size - 1;
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, exportOpenMetrics(buffer.get(), &length));
+    length = size;
+    EXPECT_EQ(STATUS_SUCCESS, exportOpenMetrics(buffer.get(), &length));
+    EXPECT_EQ(size - 1, length);
+    EXPECT_EQ(length, (UINT32) STRLEN(buffer.get()));
+
+    text = std::string(buffer.get(), length);
+    EXPECT_NE(std::string::npos, text.find(R"(track="my\"video\\track",kind="video")"));
+    EXPECT_NE(std::string::npos, text.find("kvs_webrtc_outbound_rtp_packets_sent_total{"));
+    EXPECT_NE(std::string::npos, text.find("kvs_webrtc_ice_agent_setup_seconds{"));
+    ASSERT_LE(6, text.size());
+    EXPECT_EQ("# EOF\n", text.substr(text.size() - 6));
+
+    // Every family is described once and all of its samples follow its description
+    std::istringstream lines(text);
+    while (std::getline(lines, line)) {
+        if (line.rfind("# TYPE ", 0) == 0) {
+            family = line.substr(7, line.find(' ', 7) - 7);
+            EXPECT_TRUE(families.insert(family).second) << line;
+        } else if (line.rfind("# HELP ", 0) == 0) {
+            EXPECT_EQ(0, line.compare(7, family.size() + 1, family + " ")) << line;
+        } else if (line != "# EOF") {
+            EXPECT_TRUE(std::regex_match(line, sampleLine)) << line;
+            EXPECT_EQ(0, line.compare(0, family.size(), family)) << line;
+        }
+    }
+    EXPECT_TRUE(families.find("kvs_webrtc_outbound_rtp_packets_sent") != families.end());
+
+    freePeerConnection(&pRtcPeerConnection);
+
+    // A freed peer connection is not exported anymore
+    size = 0;
+    EXPECT_EQ(STATUS_SUCCESS, exportOpenMetrics(NULL, &size));
+    std::unique_ptr<CHAR[]> afterFree(new CHAR[size]);
+    length = size;
+    EXPECT_EQ(STATUS_SUCCESS, exportOpenMetrics(afterFree.get(), &length));
+    EXPECT_EQ(std::string::npos, std::string(afterFree.get(), length).find("my\\\"video"));
+}
+
+TEST_F(MetricsApiTest, dumpTraceEventsChromeJson)
+{
+    UINT32 size = 0, length, i;
+    CHAR tooSmall[8];
+    std::string json;
+
+    EXPECT_EQ(STATUS_NULL_ARG, dumpTraceEvents(NULL, NULL));
+    length = ARRAY_SIZE(tooSmall);
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, dumpTraceEvents(tooSmall, &length));
+
+    // More events than a ring holds, the oldest are overwritten
+    for (i = 0; i < TRACER_RING_EVENT_COUNT + 10; i++) {
+        TRACE_COMPLETE(TRACE_POINT_WRITE_FRAME, GETTIME(), GETTIME() + HUNDREDS_OF_NANOS_IN_A_MILLISECOND, i);
+    }
+    TRACE_INSTANT(TRACE_POINT_SOCKET_SEND, 1200);
+
+    EXPECT_EQ(STATUS_SUCCESS, dumpTraceEvents(NULL, &size));
+    std::unique_ptr<CHAR[]> buffer(new CHAR[size]);
+    length = size;
+    EXPECT_EQ(STATUS_SUCCESS, dumpTraceEvents(buffer.get(), &length));
+    EXPECT_EQ(size - 1, length);
+
+    json = std::string(buffer.get(), length);
+    EXPECT_EQ(0, json.rfind("{\"traceEvents\":[", 0));
+    EXPECT_EQ("],\"displayTimeUnit\":\"ms\"}\n", json.substr(json.size() - 26));
+#ifdef ENABLE_TRACING
+    EXPECT_NE(std::string::npos, json.find("{\"name\":\"write_frame\",\"cat\":\"kvs\",\"ph\":\"X\""));
+    EXPECT_NE(std::string::npos, json.find("\"args\":{\"bytes\":1200}"));
+    EXPECT_NE(std::string::npos, json.find("\"args\":{\"bytes\":11}}"));
+
+    // Events which don't fit are left out, what is written is still a whole document
+    length = size / 2;
+    EXPECT_EQ(STATUS_SUCCESS, dumpTraceEvents(buffer.get(), &length));
+    EXPECT_GT(size / 2, length);
+    EXPECT_EQ("],\"displayTimeUnit\":\"ms\"}\n", std::string(buffer.get(), length).substr(length - 26));
+#else
+    EXPECT_EQ("{\"traceEvents\":[],\"displayTimeUnit\":\"ms\"}\n", json);
+#endif
+}
+
 TEST_F(MetricsApiTest, webRtcIceServerGetMetrics)
 {
     RtcConfiguration configuration;
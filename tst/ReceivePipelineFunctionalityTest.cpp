@@ -0,0 +1,263 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define RECEIVE_PIPELINE_TEST_PACKET_COUNT      2000
+#define RECEIVE_PIPELINE_TEST_QUEUE_DEPTH       32
+#define RECEIVE_PIPELINE_TEST_CONSUMER_DELAY    (1 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define RECEIVE_PIPELINE_TEST_PRODUCER_DELAY    (100 * HUNDREDS_OF_NANOS_IN_A_MICROSECOND)
+#define RECEIVE_PIPELINE_TEST_CONTROL_FREQUENCY 50
+#define RECEIVE_PIPELINE_TEST_RTCP_PACKET_TYPE  200
+
+class ReceivePipelineFunctionalityTest : public WebRtcClientTestBase {
+  public:
+    std::vector<UINT16> processedSequenceNumbers;
+    UINT32 processedControlPackets = 0;
+    UINT64 consumerDelay = 0;
+
+    static VOID onPacket(UINT64 customData, PBYTE pBuffer, UINT32 bufferLen)
+    {
+        ReceivePipelineFunctionalityTest* pTest = (ReceivePipelineFunctionalityTest*) customData;
+
+        ASSERT_GE(bufferLen, 4);
+        if (pBuffer[1] == RECEIVE_PIPELINE_TEST_RTCP_PACKET_TYPE) {
+            pTest->processedControlPackets++;
+        } else {
+            pTest->processedSequenceNumbers.push_back((UINT16) getUnalignedInt16BigEndian(pBuffer + 2));
+        }
+
+        if (pTest->consumerDelay != 0) {
+            THREAD_SLEEP(pTest->consumerDelay);
+        }
+    }
+
+    // Build a minimal RTP (or RTCP) looking packet, only the first bytes matter for the pipeline demux
+    static VOID buildPacket(PBYTE pBuffer, UINT16 seqNum, BOOL isControl)
+    {
+        pBuffer[0] = 0x80;
+        pBuffer[1] = isControl ? RECEIVE_PIPELINE_TEST_RTCP_PACKET_TYPE : 96;
+        putUnalignedInt16BigEndian(pBuffer + 2, (INT16) seqNum);
+    }
+
+    // Wait until the workers drained everything that was accepted
+    static VOID waitForDrain(PReceivePipeline pReceivePipeline, PReceivePipelineStats pStats)
+    {
+        UINT64 deadline = GETTIME() + 30 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+
+        do {
+            EXPECT_EQ(STATUS_SUCCESS, receivePipelineGetStats(pReceivePipeline, pStats));
+            if (pStats->packetsProcessed + pStats->packetsDroppedOldest == pStats->packetsEnqueued) {
+                break;
+            }
+            THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        } while (GETTIME() < deadline);
+    }
+};
+
+TEST_F(ReceivePipelineFunctionalityTest, createReceivePipelineInvalidArgs)
+{
+    PReceivePipeline pReceivePipeline = NULL;
+
+    EXPECT_EQ(STATUS_NULL_ARG, createReceivePipeline(0, RTC_RECEIVE_PIPELINE_DROP_NEWEST, NULL, 0, &pReceivePipeline));
+    EXPECT_EQ(STATUS_NULL_ARG, createReceivePipeline(0, RTC_RECEIVE_PIPELINE_DROP_NEWEST, onPacket, 0, NULL));
+    EXPECT_EQ(STATUS_INVALID_ARG,
+              createReceivePipeline(MAX_RECEIVE_PIPELINE_QUEUE_DEPTH + 1, RTC_RECEIVE_PIPELINE_DROP_NEWEST, onPacket, 0, &pReceivePipeline));
+    EXPECT_EQ(STATUS_INVALID_ARG, createReceivePipeline(0, (RTC_RECEIVE_PIPELINE_DROP_POLICY) 5, onPacket, 0, &pReceivePipeline));
+    EXPECT_EQ(NULL, pReceivePipeline);
+
+    EXPECT_EQ(STATUS_SUCCESS, createReceivePipeline(0, RTC_RECEIVE_PIPELINE_DROP_NEWEST, onPacket, (UINT64) this, &pReceivePipeline));
+    EXPECT_EQ(DEFAULT_RECEIVE_PIPELINE_QUEUE_DEPTH, pReceivePipeline->capacity);
+    EXPECT_EQ(STATUS_SUCCESS, freeReceivePipeline(&pReceivePipeline));
+    EXPECT_EQ(NULL, pReceivePipeline);
+    EXPECT_EQ(STATUS_SUCCESS, freeReceivePipeline(&pReceivePipeline));
+
+    // Depth is rounded up to a power of two and drop oldest gets twice the room
+    EXPECT_EQ(STATUS_SUCCESS, createReceivePipeline(100, RTC_RECEIVE_PIPELINE_DROP_OLDEST, onPacket, (UINT64) this, &pReceivePipeline));
+    EXPECT_EQ(128, pReceivePipeline->queueDepth);
+    EXPECT_EQ(256, pReceivePipeline->capacity);
+    EXPECT_EQ(255, pReceivePipeline->mask);
+    EXPECT_EQ(STATUS_SUCCESS, freeReceivePipeline(&pReceivePipeline));
+}
+
+TEST_F(ReceivePipelineFunctionalityTest, packetsDeliveredInOrder)
+{
+    PReceivePipeline pReceivePipeline = NULL;
+    ReceivePipelineStats stats;
+    BYTE packet[RECEIVE_PIPELINE_SLOT_SIZE * 2];
+    UINT16 i;
+
+    MEMSET(packet, 0x00, SIZEOF(packet));
+    EXPECT_EQ(STATUS_SUCCESS, createReceivePipeline(0, RTC_RECEIVE_PIPELINE_DROP_NEWEST, onPacket, (UINT64) this, &pReceivePipeline));
+
+    for (i = 0; i < 256; i++) {
+        buildPacket(packet, i, FALSE);
+        // Mix in packets larger than the preallocated slot size
+        EXPECT_EQ(STATUS_SUCCESS, receivePipelineEnqueue(pReceivePipeline, packet, i % 16 == 0 ? SIZEOF(packet) : 100));
+    }
+
+    waitForDrain(pReceivePipeline, &stats);
+    EXPECT_EQ(256, stats.packetsEnqueued);
+    EXPECT_EQ(256, stats.packetsProcessed);
+    EXPECT_EQ(0, stats.packetsDroppedNewest + stats.packetsDroppedOldest);
+
+    ASSERT_EQ(256, processedSequenceNumbers.size());
+    for (i = 0; i < 256; i++) {
+        EXPECT_EQ(i, processedSequenceNumbers[i]);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeReceivePipeline(&pReceivePipeline));
+}
+
+TEST_F(ReceivePipelineFunctionalityTest, slowConsumerDropNewest)
+{
+    PReceivePipeline pReceivePipeline = NULL;
+    ReceivePipelineStats stats;
+    BYTE packet[200];
+    UINT16 i;
+    UINT32 accepted = 0;
+    UINT64 startTime, producerTime;
+    STATUS status;
+
+    MEMSET(packet, 0x00, SIZEOF(packet));
+    consumerDelay = RECEIVE_PIPELINE_TEST_CONSUMER_DELAY;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createReceivePipeline(RECEIVE_PIPELINE_TEST_QUEUE_DEPTH, RTC_RECEIVE_PIPELINE_DROP_NEWEST, onPacket, (UINT64) this, &pReceivePipeline));
+
+    startTime = GETTIME();
+    for (i = 0; i < RECEIVE_PIPELINE_TEST_PACKET_COUNT; i++) {
+        buildPacket(packet, i, FALSE);
+        status = receivePipelineEnqueue(pReceivePipeline, packet, SIZEOF(packet));
+        EXPECT_TRUE(status == STATUS_SUCCESS || status == STATUS_PEERCONNECTION_RECEIVE_QUEUE_FULL);
+        if (status == STATUS_SUCCESS) {
+            accepted++;
+        }
+    }
+    producerTime = GETTIME() - startTime;
+
+    // The network thread never waits on the consumer, it would need at least a second to process everything
+    EXPECT_LT(producerTime, RECEIVE_PIPELINE_TEST_PACKET_COUNT * RECEIVE_PIPELINE_TEST_CONSUMER_DELAY / 2);
+
+    waitForDrain(pReceivePipeline, &stats);
+    EXPECT_EQ(accepted, stats.packetsEnqueued);
+    EXPECT_EQ(accepted, stats.packetsProcessed);
+    EXPECT_EQ(RECEIVE_PIPELINE_TEST_PACKET_COUNT, stats.packetsEnqueued + stats.packetsDroppedNewest);
+    EXPECT_LT(0, stats.packetsDroppedNewest);
+    EXPECT_EQ(0, stats.packetsDroppedOldest);
+    EXPECT_EQ(RECEIVE_PIPELINE_TEST_QUEUE_DEPTH, stats.highWaterMark);
+
+    // Loss shows up as gaps, never as reordering, and the earliest packets are the ones that survive
+    ASSERT_EQ(accepted, processedSequenceNumbers.size());
+    EXPECT_EQ(0, processedSequenceNumbers[0]);
+    for (i = 1; i < processedSequenceNumbers.size(); i++) {
+        EXPECT_LT(processedSequenceNumbers[i - 1], processedSequenceNumbers[i]);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeReceivePipeline(&pReceivePipeline));
+}
+
+TEST_F(ReceivePipelineFunctionalityTest, slowConsumerDropOldest)
+{
+    PReceivePipeline pReceivePipeline = NULL;
+    ReceivePipelineStats stats;
+    BYTE packet[200];
+    UINT16 i;
+    UINT32 acceptedControl = 0;
+    BOOL isControl;
+    STATUS status;
+
+    MEMSET(packet, 0x00, SIZEOF(packet));
+    consumerDelay = RECEIVE_PIPELINE_TEST_CONSUMER_DELAY;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createReceivePipeline(RECEIVE_PIPELINE_TEST_QUEUE_DEPTH, RTC_RECEIVE_PIPELINE_DROP_OLDEST, onPacket, (UINT64) this, &pReceivePipeline));
+
+    for (i = 0; i < RECEIVE_PIPELINE_TEST_PACKET_COUNT; i++) {
+        isControl = (i % RECEIVE_PIPELINE_TEST_CONTROL_FREQUENCY) == 0;
+        buildPacket(packet, i, isControl);
+        status = receivePipelineEnqueue(pReceivePipeline, packet, SIZEOF(packet));
+        EXPECT_TRUE(status == STATUS_SUCCESS || status == STATUS_PEERCONNECTION_RECEIVE_QUEUE_FULL);
+        if (status == STATUS_SUCCESS && isControl) {
+            acceptedControl++;
+        }
+        // Still an order of magnitude faster than the consumer, but paced so the headroom absorbs bursts
+        THREAD_SLEEP(RECEIVE_PIPELINE_TEST_PRODUCER_DELAY);
+    }
+
+    waitForDrain(pReceivePipeline, &stats);
+    EXPECT_EQ(RECEIVE_PIPELINE_TEST_PACKET_COUNT, stats.packetsEnqueued + stats.packetsDroppedNewest);
+    EXPECT_EQ(stats.packetsEnqueued, stats.packetsProcessed + stats.packetsDroppedOldest);
+    EXPECT_LT(0, stats.packetsDroppedOldest);
+
+    // Control packets that made it into the queue are never sacrificed for media
+    EXPECT_EQ(acceptedControl, processedControlPackets);
+
+    // The freshest media is always delivered and order is preserved
+    ASSERT_LT(0, processedSequenceNumbers.size());
+    EXPECT_EQ(RECEIVE_PIPELINE_TEST_PACKET_COUNT - 1, processedSequenceNumbers.back());
+    for (i = 1; i < processedSequenceNumbers.size(); i++) {
+        EXPECT_LT(processedSequenceNumbers[i - 1], processedSequenceNumbers[i]);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeReceivePipeline(&pReceivePipeline));
+}
+
+TEST_F(ReceivePipelineFunctionalityTest, freeWithPendingPackets)
+{
+    PReceivePipeline pReceivePipeline = NULL;
+    ReceivePipelineStats stats;
+    BYTE packet[200];
+    UINT16 i;
+
+    MEMSET(packet, 0x00, SIZEOF(packet));
+    consumerDelay = RECEIVE_PIPELINE_TEST_CONSUMER_DELAY;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createReceivePipeline(RECEIVE_PIPELINE_TEST_QUEUE_DEPTH, RTC_RECEIVE_PIPELINE_DROP_NEWEST, onPacket, (UINT64) this, &pReceivePipeline));
+
+    for (i = 0; i < RECEIVE_PIPELINE_TEST_QUEUE_DEPTH; i++) {
+        buildPacket(packet, i, FALSE);
+        EXPECT_EQ(STATUS_SUCCESS, receivePipelineEnqueue(pReceivePipeline, packet, SIZEOF(packet)));
+    }
+
+    // Shutdown returns without draining the backlog and later packets are silently ignored
+    EXPECT_EQ(STATUS_SUCCESS, receivePipelineShutdown(pReceivePipeline));
+    EXPECT_EQ(STATUS_SUCCESS, receivePipelineGetStats(pReceivePipeline, &stats));
+    EXPECT_GT(RECEIVE_PIPELINE_TEST_QUEUE_DEPTH, stats.packetsProcessed);
+    EXPECT_EQ(STATUS_SUCCESS, receivePipelineEnqueue(pReceivePipeline, packet, SIZEOF(packet)));
+    EXPECT_EQ(STATUS_SUCCESS, receivePipelineGetStats(pReceivePipeline, &stats));
+    EXPECT_EQ(RECEIVE_PIPELINE_TEST_QUEUE_DEPTH, stats.packetsEnqueued);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeReceivePipeline(&pReceivePipeline));
+}
+
+TEST_F(ReceivePipelineFunctionalityTest, peerConnectionWithReceivePipeline)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PKvsPeerConnection pKvsPeerConnection;
+    BYTE packet[200];
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(packet, 0x00, SIZEOF(packet));
+    configuration.kvsRtcConfiguration.enableReceivePipeline = TRUE;
+    configuration.kvsRtcConfiguration.receivePipelineQueueDepth = RECEIVE_PIPELINE_TEST_QUEUE_DEPTH;
+    configuration.kvsRtcConfiguration.receivePipelineDropPolicy = RTC_RECEIVE_PIPELINE_DROP_OLDEST;
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    ASSERT_TRUE(pKvsPeerConnection->pReceivePipeline != NULL);
+
+    // RTP before DTLS completes is enqueued and then ignored by the worker since SRTP is not set up yet
+    buildPacket(packet, 1, FALSE);
+    onInboundPacket((UINT64) pKvsPeerConnection, packet, SIZEOF(packet));
+
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -13,6 +13,18 @@ STATUS RollingBufferFunctionalityTestFreeBufferFunc(PUINT64 data) {
     return STATUS_SUCCESS;
 }
 
+static std::atomic<UINT64> gRollingBufferFreedCount(0);
+
+STATUS RollingBufferFunctionalityTestFreeAllocatedFunc(PUINT64 data)
+{
+    if (data == NULL) {
+        return STATUS_NULL_ARG;
+    }
+    SAFE_MEMFREE(*((PUINT64*) data));
+    gRollingBufferFreedCount++;
+    return STATUS_SUCCESS;
+}
+
 TEST_F(RollingBufferFunctionalityTest, appendDataToBufferAndVerify)
 {
     PRollingBuffer pRollingBuffer;
@@ -89,11 +101,13 @@ TEST_F(RollingBufferFunctionalityTest, extractDataFromBufferAndInsertBack)
     EXPECT_EQ(STATUS_SUCCESS, rollingBufferAppendData(pRollingBuffer, third, &index));
     EXPECT_EQ(STATUS_SUCCESS, rollingBufferAppendData(pRollingBuffer, fourth, &index));
 
+    // Capacity 3 gets 4 slots, the first one is emptied when first rolls out
     EXPECT_EQ(4, pRollingBuffer->headIndex);
     EXPECT_EQ(1, pRollingBuffer->tailIndex);
-    EXPECT_EQ(fourth, pRollingBuffer->dataBuffer[0]);
+    EXPECT_EQ(NULL, pRollingBuffer->dataBuffer[0]);
     EXPECT_EQ(second, pRollingBuffer->dataBuffer[1]);
     EXPECT_EQ(third, pRollingBuffer->dataBuffer[2]);
+    EXPECT_EQ(fourth, pRollingBuffer->dataBuffer[3]);
 
     EXPECT_EQ(STATUS_SUCCESS, rollingBufferExtractData(pRollingBuffer, 2, &data));
     EXPECT_EQ(third, data);
@@ -102,9 +116,73 @@ TEST_F(RollingBufferFunctionalityTest, extractDataFromBufferAndInsertBack)
     EXPECT_EQ(STATUS_SUCCESS, rollingBufferInsertData(pRollingBuffer, 2, third));
     EXPECT_EQ(third, pRollingBuffer->dataBuffer[2]);
     EXPECT_EQ(STATUS_SUCCESS, rollingBufferInsertData(pRollingBuffer, 3, third));
-    EXPECT_EQ(third, pRollingBuffer->dataBuffer[0]);
+    EXPECT_EQ(third, pRollingBuffer->dataBuffer[3]);
+    EXPECT_EQ(STATUS_ROLLING_BUFFER_NOT_IN_RANGE, rollingBufferInsertData(pRollingBuffer, 0, first));
+    EXPECT_EQ(NULL, pRollingBuffer->dataBuffer[0]);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRollingBuffer(&pRollingBuffer));
+}
+
+TEST_F(RollingBufferFunctionalityTest, concurrentExtractAndInsertWhileAppending)
+{
+    PRollingBuffer pRollingBuffer;
+    const UINT64 appendCount = 200000;
+    const UINT32 readerCount = 4;
+    std::atomic<BOOL> done(FALSE);
+    std::atomic<UINT64> mismatchCount(0), extractCount(0);
+    std::vector<std::thread> readers;
+    PUINT64 pItem;
+    UINT64 i, index;
+
+    gRollingBufferFreedCount = 0;
+    EXPECT_EQ(STATUS_SUCCESS, createRollingBuffer(100, RollingBufferFunctionalityTestFreeAllocatedFunc, &pRollingBuffer));
+
+    // Readers keep taking recent entries out and putting them back, like NACKs do, while the writer rolls over them
+    for (i = 0; i < readerCount; i++) {
+        readers.push_back(std::thread([&, i]() {
+            UINT64 data, target, head, round = i;
+            STATUS status;
+            while (!done) {
+                head = ATOMIC_LOAD(&pRollingBuffer->headIndex);
+                target = head - 1 - (round++ % 120);
+                if (head == 0 || target >= head) {
+                    continue;
+                }
+                EXPECT_EQ(STATUS_SUCCESS, rollingBufferExtractData(pRollingBuffer, target, &data));
+                if (data == (UINT64) NULL) {
+                    continue;
+                }
+                extractCount++;
+                // Entries never move between slots
+                if (((*((PUINT64) data) - target) & pRollingBuffer->indexMask) != 0) {
+                    mismatchCount++;
+                }
+                status = rollingBufferInsertData(pRollingBuffer, target, data);
+                EXPECT_TRUE(status == STATUS_SUCCESS || status == STATUS_ROLLING_BUFFER_NOT_IN_RANGE);
+                if (status == STATUS_ROLLING_BUFFER_NOT_IN_RANGE) {
+                    RollingBufferFunctionalityTestFreeAllocatedFunc(&data);
+                }
+            }
+        }));
+    }
+
+    for (i = 0; i < appendCount; i++) {
+        pItem = (PUINT64) MEMALLOC(SIZEOF(UINT64));
+        *pItem = i;
+        EXPECT_EQ(STATUS_SUCCESS, rollingBufferAppendData(pRollingBuffer, (UINT64) pItem, &index));
+        EXPECT_EQ(i, index);
+    }
+
+    done = TRUE;
+    for (auto& reader : readers) {
+        reader.join();
+    }
 
+    EXPECT_LT(0, extractCount.load());
+    EXPECT_EQ(0, mismatchCount.load());
     EXPECT_EQ(STATUS_SUCCESS, freeRollingBuffer(&pRollingBuffer));
+    // Every entry is freed exactly once whoever ends up holding it
+    EXPECT_EQ(appendCount, gRollingBufferFreedCount.load());
 }
 }
 }
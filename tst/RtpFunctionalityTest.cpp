@@ -486,6 +486,941 @@ TEST_F(RtpFunctionalityTest, trailingZerosWouldBeReturned)
     EXPECT_EQ(7, naluLength);
 }
 
+TEST_F(RtpFunctionalityTest, startCodeScannersMatchScalar)
+{
+    BYTE buffer[1024];
+    UINT32 i, iter, length, expected;
+
+    srand(12345);
+    for (iter = 0; iter < 2000; iter++) {
+        // Mostly zeros and ones so start codes and near misses land on every vector lane and block boundary
+        length = (UINT32) (RAND() % SIZEOF(buffer));
+        for (i = 0; i < length; i++) {
+            buffer[i] = (RAND() % 4 == 0) ? (BYTE) (RAND() % 256) : (BYTE) (RAND() % 2);
+        }
+
+        expected = findAnnexBStartCodeScalar(buffer, length);
+        EXPECT_EQ(expected, findAnnexBStartCode(buffer, length));
+#ifdef KVS_START_CODE_SCANNER_SSE2
+        EXPECT_EQ(expected, findAnnexBStartCodeSse2(buffer, length));
+#endif
+#ifdef KVS_START_CODE_SCANNER_AVX2
+        if (isAvx2StartCodeScannerSupported()) {
+            EXPECT_EQ(expected, findAnnexBStartCodeAvx2(buffer, length));
+        }
+#endif
+#ifdef KVS_START_CODE_SCANNER_NEON
+        EXPECT_EQ(expected, findAnnexBStartCodeNeon(buffer, length));
+#endif
+    }
+}
+
+TEST_F(RtpFunctionalityTest, startCodeScannerFindsCodeAtEveryOffset)
+{
+    BYTE buffer[100];
+    UINT32 i;
+
+    MEMSET(buffer, 0xff, SIZEOF(buffer));
+    EXPECT_EQ(SIZEOF(buffer), findAnnexBStartCode(buffer, SIZEOF(buffer)));
+
+    for (i = 0; i + 3 <= SIZEOF(buffer); i++) {
+        MEMSET(buffer, 0xff, SIZEOF(buffer));
+        buffer[i] = 0x00;
+        buffer[i + 1] = 0x00;
+        buffer[i + 2] = 0x01;
+        EXPECT_EQ(i, findAnnexBStartCode(buffer, SIZEOF(buffer)));
+        // Truncated start code is not a match
+        EXPECT_EQ(i + 2, findAnnexBStartCode(buffer, i + 2));
+    }
+}
+
+TEST_F(RtpFunctionalityTest, singlePassPayloadersMatchTwoPassPayloaders)
+{
+    BYTE frame[4096];
+    BYTE payload[8192];
+    UINT32 subLength[512];
+    UINT32 payloadLength, subLenSize, i, codec;
+    PayloadArray payloadArray;
+    RtpPayloadArrayFunc singlePassFns[] = {createPayloadArrayForH264, createPayloadArrayForVP8, createPayloadArrayForOpus, createPayloadArrayForG711};
+    STATUS (*twoPassFns[])(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32) = {createPayloadForH264, createPayloadForVP8, createPayloadForOpus,
+                                                                                         createPayloadForG711};
+
+    for (i = 0; i < SIZEOF(frame); i++) {
+        frame[i] = (BYTE) (i % 251 + 2);
+    }
+    // Two NALUs for H264, the other codecs don't care about the content
+    frame[0] = 0x00;
+    frame[1] = 0x00;
+    frame[2] = 0x01;
+    frame[1000] = 0x00;
+    frame[1001] = 0x00;
+    frame[1002] = 0x00;
+    frame[1003] = 0x01;
+
+    // The same array is reused for every codec and frame size, its buffers only grow
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    for (codec = 0; codec < ARRAY_SIZE(singlePassFns); codec++) {
+        for (i = 16; i <= SIZEOF(frame); i *= 2) {
+            payloadLength = SIZEOF(payload);
+            subLenSize = ARRAY_SIZE(subLength);
+            EXPECT_EQ(STATUS_SUCCESS, twoPassFns[codec](200, frame, i, payload, &payloadLength, subLength, &subLenSize));
+
+            EXPECT_EQ(STATUS_SUCCESS, singlePassFns[codec](200, frame, i, &payloadArray));
+            EXPECT_EQ(payloadLength, payloadArray.payloadLength);
+            EXPECT_EQ(subLenSize, payloadArray.payloadSubLenSize);
+            EXPECT_LE(payloadArray.payloadLength, payloadArray.maxPayloadLength);
+            EXPECT_LE(payloadArray.payloadSubLenSize, payloadArray.maxPayloadSubLenSize);
+            EXPECT_EQ(0, MEMCMP(payload, payloadArray.payloadBuffer, payloadLength));
+            EXPECT_EQ(0, MEMCMP(subLength, payloadArray.payloadSubLength, subLenSize * SIZEOF(UINT32)));
+        }
+    }
+
+    // G711 splits the frame in MTU sized packets
+    EXPECT_EQ(STATUS_RTP_INPUT_MTU_TOO_SMALL, createPayloadArrayForG711(0, frame, SIZEOF(frame), &payloadArray));
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, twoPassPayloaderRejectsSmallBuffer)
+{
+    BYTE frame[100] = {0};
+    BYTE payload[100];
+    UINT32 subLength[4];
+    UINT32 payloadLength = SIZEOF(payload), subLenSize = ARRAY_SIZE(subLength);
+
+    // 100 bytes need 4 packets with a 1 byte VP8 payload descriptor each
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, createPayloadForVP8(26, frame, SIZEOF(frame), payload, &payloadLength, subLength, &subLenSize));
+
+    payloadLength = SIZEOF(payload) - 1;
+    subLenSize = ARRAY_SIZE(subLength);
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, createPayloadForOpus(1200, frame, SIZEOF(frame), payload, &payloadLength, subLength, &subLenSize));
+}
+
+TEST_F(RtpFunctionalityTest, depayStapAInSinglePass)
+{
+    BYTE stapA[] = {0x18, 0x00, 0x03, 0x67, 0x42, 0x1f, 0x00, 0x02, 0x68, 0xce};
+    BYTE expected[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x1f, 0x00, 0x00, 0x00, 0x01, 0x68, 0xce};
+    BYTE depayload[32];
+    UINT32 depayloadLength = 0;
+    BOOL isStart = FALSE;
+
+    EXPECT_EQ(STATUS_SUCCESS, depayH264FromRtpPayload(stapA, SIZEOF(stapA), NULL, &depayloadLength, &isStart));
+    EXPECT_EQ(SIZEOF(expected), depayloadLength);
+    EXPECT_TRUE(isStart);
+
+    depayloadLength = SIZEOF(expected) - 1;
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, depayH264FromRtpPayload(stapA, SIZEOF(stapA), depayload, &depayloadLength, NULL));
+
+    depayloadLength = SIZEOF(depayload);
+    EXPECT_EQ(STATUS_SUCCESS, depayH264FromRtpPayload(stapA, SIZEOF(stapA), depayload, &depayloadLength, NULL));
+    EXPECT_EQ(SIZEOF(expected), depayloadLength);
+    EXPECT_EQ(0, MEMCMP(expected, depayload, depayloadLength));
+}
+
+TEST_F(RtpFunctionalityTest, depayTruncatedStapAFails)
+{
+    // The second unit announces 2 bytes but only 1 made it
+    BYTE stapA[] = {0x18, 0x00, 0x03, 0x67, 0x42, 0x1f, 0x00, 0x02, 0x68};
+    BYTE hugeUnit[] = {0x18, 0xff, 0xff, 0x67};
+    BYTE depayload[32];
+    UINT32 depayloadLength = 0;
+
+    EXPECT_EQ(STATUS_RTP_INVALID_NALU, depayH264FromRtpPayload(stapA, SIZEOF(stapA), NULL, &depayloadLength, NULL));
+    depayloadLength = SIZEOF(depayload);
+    EXPECT_EQ(STATUS_RTP_INVALID_NALU, depayH264FromRtpPayload(stapA, SIZEOF(stapA), depayload, &depayloadLength, NULL));
+
+    depayloadLength = 0;
+    EXPECT_EQ(STATUS_RTP_INVALID_NALU, depayH264FromRtpPayload(hugeUnit, SIZEOF(hugeUnit), NULL, &depayloadLength, NULL));
+    depayloadLength = SIZEOF(depayload);
+    EXPECT_EQ(STATUS_RTP_INVALID_NALU, depayH264FromRtpPayload(hugeUnit, SIZEOF(hugeUnit), depayload, &depayloadLength, NULL));
+}
+
+// Canned HEVC access unit: VPS, SPS, PPS and a short IDR_W_RADL slice, each behind a 4 byte start code
+static BYTE h265Vps[] = {0x40, 0x01, 0x0c, 0x01, 0xff, 0xff, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00,
+                         0xb0, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x5d, 0xac, 0x09};
+static BYTE h265Sps[] = {0x42, 0x01, 0x01, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00, 0xb0, 0x00, 0x00, 0x03, 0x00,
+                         0x00, 0x03, 0x00, 0x5d, 0xa0, 0x02, 0x80, 0x80, 0x2d, 0x16, 0x59, 0x59, 0xa4, 0x93,
+                         0x2b, 0xc0, 0x40, 0x40, 0x00, 0x00, 0xfa, 0x40, 0x00, 0x17, 0x70, 0x02};
+static BYTE h265Pps[] = {0x44, 0x01, 0xc1, 0x72, 0xb4, 0x62, 0x40};
+static BYTE h265IdrSlice[] = {0x26, 0x01, 0xaf, 0x0a, 0x3b, 0x5c};
+
+static std::vector<BYTE> createH265AccessUnit(std::vector<std::vector<BYTE>> nalus)
+{
+    std::vector<BYTE> frame;
+
+    for (auto& nalu : nalus) {
+        frame.insert(frame.end(), start4ByteCode, start4ByteCode + SIZEOF(start4ByteCode));
+        frame.insert(frame.end(), nalu.begin(), nalu.end());
+    }
+
+    return frame;
+}
+
+static std::vector<BYTE> depayH265Packets(PPayloadArray pPayloadArray)
+{
+    std::vector<BYTE> frame;
+    BYTE depayload[1500];
+    UINT32 i, offset = 0, depayloadLength;
+
+    for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
+        depayloadLength = SIZEOF(depayload);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  depayH265FromRtpPayload(pPayloadArray->payloadBuffer + offset, pPayloadArray->payloadSubLength[i], depayload, &depayloadLength, NULL));
+        frame.insert(frame.end(), depayload, depayload + depayloadLength);
+        offset += pPayloadArray->payloadSubLength[i];
+    }
+
+    return frame;
+}
+
+TEST_F(RtpFunctionalityTest, h265AggregatesParameterSets)
+{
+    std::vector<BYTE> frame = createH265AccessUnit({std::vector<BYTE>(h265Vps, h265Vps + SIZEOF(h265Vps)),
+                                                    std::vector<BYTE>(h265Sps, h265Sps + SIZEOF(h265Sps)),
+                                                    std::vector<BYTE>(h265Pps, h265Pps + SIZEOF(h265Pps)),
+                                                    std::vector<BYTE>(h265IdrSlice, h265IdrSlice + SIZEOF(h265IdrSlice))});
+    std::vector<BYTE> expected = {0x60, 0x01};
+    PayloadArray payloadArray;
+    BOOL isStart = FALSE;
+    UINT32 depayloadLength = 0;
+
+    for (auto& nalu : std::vector<std::pair<PBYTE, UINT32>>{
+             {h265Vps, SIZEOF(h265Vps)}, {h265Sps, SIZEOF(h265Sps)}, {h265Pps, SIZEOF(h265Pps)}, {h265IdrSlice, SIZEOF(h265IdrSlice)}}) {
+        expected.push_back((BYTE) (nalu.second >> 8));
+        expected.push_back((BYTE) nalu.second);
+        expected.insert(expected.end(), nalu.first, nalu.first + nalu.second);
+    }
+
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+
+    // Everything fits a single AP at the default mtu
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForH265(DEFAULT_MTU_SIZE, frame.data(), (UINT32) frame.size(), &payloadArray));
+    EXPECT_EQ(1, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(expected.size(), payloadArray.payloadLength);
+    EXPECT_EQ(0, MEMCMP(expected.data(), payloadArray.payloadBuffer, expected.size()));
+
+    EXPECT_EQ(STATUS_SUCCESS, depayH265FromRtpPayload(payloadArray.payloadBuffer, payloadArray.payloadLength, NULL, &depayloadLength, &isStart));
+    EXPECT_TRUE(isStart);
+    EXPECT_EQ(frame.size(), depayloadLength);
+    EXPECT_EQ(frame, depayH265Packets(&payloadArray));
+
+    // VPS and SPS only fit alone, PPS and the slice share an AP
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForH265(SIZEOF(h265Sps), frame.data(), (UINT32) frame.size(), &payloadArray));
+    EXPECT_EQ(3, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(SIZEOF(h265Vps), payloadArray.payloadSubLength[0]);
+    EXPECT_EQ(SIZEOF(h265Sps), payloadArray.payloadSubLength[1]);
+    EXPECT_EQ(H265_NALU_HEADER_SIZE + 2 * H265_AP_NALU_LENGTH_SIZE + SIZEOF(h265Pps) + SIZEOF(h265IdrSlice), payloadArray.payloadSubLength[2]);
+    EXPECT_EQ(0, MEMCMP(h265Vps, payloadArray.payloadBuffer, SIZEOF(h265Vps)));
+    EXPECT_EQ(H265_AP_INDICATOR, H265_NALU_TYPE(payloadArray.payloadBuffer[SIZEOF(h265Vps) + SIZEOF(h265Sps)]));
+    EXPECT_EQ(frame, depayH265Packets(&payloadArray));
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, h265FragmentsLargeNalu)
+{
+    std::vector<BYTE> slice(3000);
+    std::vector<BYTE> frame;
+    PayloadArray payloadArray;
+    UINT32 i, offset = 0;
+    BYTE expectedFuHeaders[] = {0x80 | 19, 19, 0x40 | 19};
+
+    // IDR_W_RADL with TID 1, payload bytes never form a start code
+    slice[0] = 0x26;
+    slice[1] = 0x01;
+    for (i = 2; i < slice.size(); i++) {
+        slice[i] = (BYTE) (i % 250 + 2);
+    }
+    frame = createH265AccessUnit({std::vector<BYTE>(h265Pps, h265Pps + SIZEOF(h265Pps)), slice});
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForH265(1200, frame.data(), (UINT32) frame.size(), &payloadArray));
+
+    // PPS alone, then the slice split into 1197 + 1197 + 604 bytes behind the payload and FU headers
+    EXPECT_EQ(4, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(SIZEOF(h265Pps), payloadArray.payloadSubLength[0]);
+    offset = payloadArray.payloadSubLength[0];
+    for (i = 1; i < payloadArray.payloadSubLenSize; i++) {
+        EXPECT_GE(1200, payloadArray.payloadSubLength[i]);
+        EXPECT_EQ(0x62, payloadArray.payloadBuffer[offset]);
+        EXPECT_EQ(0x01, payloadArray.payloadBuffer[offset + 1]);
+        EXPECT_EQ(expectedFuHeaders[i - 1], payloadArray.payloadBuffer[offset + 2]);
+        offset += payloadArray.payloadSubLength[i];
+    }
+    EXPECT_EQ(H265_FU_HEADER_SIZE + 604, payloadArray.payloadSubLength[3]);
+    EXPECT_EQ(frame, depayH265Packets(&payloadArray));
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, depayH265RejectsMalformedPackets)
+{
+    BYTE truncatedAp[] = {0x60, 0x01, 0x00, 0x07, 0x44, 0x01, 0xc1};
+    BYTE shortFu[] = {0x62, 0x01, 0x93};
+    BYTE paci[] = {0x64, 0x01, 0x00, 0x00};
+    BYTE depayload[32];
+    UINT32 depayloadLength = 0;
+    BOOL isStart = TRUE;
+
+    EXPECT_EQ(STATUS_RTP_INVALID_NALU, depayH265FromRtpPayload(truncatedAp, SIZEOF(truncatedAp), NULL, &depayloadLength, NULL));
+    EXPECT_EQ(0, depayloadLength);
+    EXPECT_EQ(STATUS_RTP_INPUT_PACKET_TOO_SMALL, depayH265FromRtpPayload(shortFu, SIZEOF(shortFu), NULL, &depayloadLength, NULL));
+    EXPECT_EQ(STATUS_RTP_INPUT_PACKET_TOO_SMALL, depayH265FromRtpPayload(shortFu, 1, NULL, &depayloadLength, NULL));
+
+    // PACI packets are skipped without failing the frame
+    depayloadLength = SIZEOF(depayload);
+    EXPECT_EQ(STATUS_SUCCESS, depayH265FromRtpPayload(paci, SIZEOF(paci), depayload, &depayloadLength, &isStart));
+    EXPECT_EQ(0, depayloadLength);
+    EXPECT_FALSE(isStart);
+}
+
+// Sequence header and frame OBUs with obu_size fields, as an encoder emits them after a temporal delimiter
+static BYTE av1TemporalDelimiter[] = {0x12, 0x00};
+static BYTE av1SequenceHeader[] = {0x0a, 0x0b, 0x00, 0x00, 0x00, 0x24, 0xcf, 0x7f, 0x0d, 0xbf, 0xff, 0x30, 0x08};
+
+static std::vector<BYTE> createAV1FrameObu(UINT32 payloadSize)
+{
+    std::vector<BYTE> obu(AV1_MAX_LEB128_SIZE + 1);
+    UINT32 i;
+
+    obu[0] = 0x32;
+    obu.resize(1 + av1WriteLeb128(payloadSize, obu.data() + 1));
+    for (i = 0; i < payloadSize; i++) {
+        obu.push_back((BYTE) (i % 251));
+    }
+
+    return obu;
+}
+
+// Depayloads every packet into one frame like the jitter buffer does and converts it back to OBUs
+static std::vector<BYTE> depayAV1Packets(PPayloadArray pPayloadArray)
+{
+    std::vector<BYTE> frame;
+    UINT32 i, offset = 0, depayloadLength, frameLength = 0;
+
+    for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
+        EXPECT_EQ(STATUS_SUCCESS,
+                  depayAV1FromRtpPayload(pPayloadArray->payloadBuffer + offset, pPayloadArray->payloadSubLength[i], NULL, &depayloadLength, NULL));
+        frame.resize(frameLength + depayloadLength);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  depayAV1FromRtpPayload(pPayloadArray->payloadBuffer + offset, pPayloadArray->payloadSubLength[i], frame.data() + frameLength,
+                                         &depayloadLength, NULL));
+        frameLength += depayloadLength;
+        offset += pPayloadArray->payloadSubLength[i];
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, av1ObuElementsToTemporalUnit(frame.data(), frameLength, &frameLength));
+    frame.resize(frameLength);
+
+    return frame;
+}
+
+TEST_F(RtpFunctionalityTest, av1AggregatesObus)
+{
+    std::vector<BYTE> frameObu = createAV1FrameObu(100);
+    std::vector<BYTE> temporalUnit(av1TemporalDelimiter, av1TemporalDelimiter + SIZEOF(av1TemporalDelimiter));
+    std::vector<BYTE> expected = {AV1_AGGREGATION_HEADER_N | (2 << AV1_AGGREGATION_HEADER_W_SHIFT), SIZEOF(av1SequenceHeader) - 1, 0x08};
+    PayloadArray payloadArray;
+    BOOL isStart = FALSE;
+    UINT32 depayloadLength = 0;
+
+    temporalUnit.insert(temporalUnit.end(), av1SequenceHeader, av1SequenceHeader + SIZEOF(av1SequenceHeader));
+    temporalUnit.insert(temporalUnit.end(), frameObu.begin(), frameObu.end());
+
+    // The temporal delimiter is dropped, obu_size is stripped and only the first element carries a length
+    expected.insert(expected.end(), av1SequenceHeader + 2, av1SequenceHeader + SIZEOF(av1SequenceHeader));
+    expected.push_back(0x30);
+    expected.insert(expected.end(), frameObu.begin() + 2, frameObu.end());
+
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForAV1(DEFAULT_MTU_SIZE, temporalUnit.data(), (UINT32) temporalUnit.size(), &payloadArray));
+    EXPECT_EQ(1, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(expected.size(), payloadArray.payloadLength);
+    EXPECT_EQ(0, MEMCMP(expected.data(), payloadArray.payloadBuffer, expected.size()));
+
+    EXPECT_EQ(STATUS_SUCCESS, depayAV1FromRtpPayload(payloadArray.payloadBuffer, payloadArray.payloadLength, NULL, &depayloadLength, &isStart));
+    EXPECT_TRUE(isStart);
+    EXPECT_EQ(2 * AV1_ELEMENT_PREFIX_SIZE + SIZEOF(av1SequenceHeader) - 1 + frameObu.size() - 1, depayloadLength);
+    EXPECT_EQ(std::vector<BYTE>(temporalUnit.begin() + SIZEOF(av1TemporalDelimiter), temporalUnit.end()), depayAV1Packets(&payloadArray));
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, av1FragmentsLargeObu)
+{
+    std::vector<BYTE> frameObu = createAV1FrameObu(3000);
+    std::vector<BYTE> temporalUnit(av1SequenceHeader, av1SequenceHeader + SIZEOF(av1SequenceHeader));
+    BYTE expectedHeaders[] = {AV1_AGGREGATION_HEADER_Y | (2 << AV1_AGGREGATION_HEADER_W_SHIFT) | AV1_AGGREGATION_HEADER_N,
+                              AV1_AGGREGATION_HEADER_Z | AV1_AGGREGATION_HEADER_Y | (1 << AV1_AGGREGATION_HEADER_W_SHIFT),
+                              AV1_AGGREGATION_HEADER_Z | (1 << AV1_AGGREGATION_HEADER_W_SHIFT)};
+    PayloadArray payloadArray;
+    UINT32 i, offset = 0, depayloadLength;
+    BOOL isStart;
+
+    temporalUnit.insert(temporalUnit.end(), frameObu.begin(), frameObu.end());
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+
+    // The sequence header shares the first packet with the start of the frame OBU, whose 3001 byte element is split 1186 + 1199 + 616
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForAV1(1200, temporalUnit.data(), (UINT32) temporalUnit.size(), &payloadArray));
+    EXPECT_EQ(3, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(1200, payloadArray.payloadSubLength[0]);
+    EXPECT_EQ(1200, payloadArray.payloadSubLength[1]);
+    EXPECT_EQ(AV1_AGGREGATION_HEADER_SIZE + 616, payloadArray.payloadSubLength[2]);
+    for (i = 0; i < payloadArray.payloadSubLenSize; i++) {
+        EXPECT_EQ(expectedHeaders[i], payloadArray.payloadBuffer[offset]);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  depayAV1FromRtpPayload(payloadArray.payloadBuffer + offset, payloadArray.payloadSubLength[i], NULL, &depayloadLength, &isStart));
+        EXPECT_EQ(i == 0, isStart);
+        offset += payloadArray.payloadSubLength[i];
+    }
+    EXPECT_EQ(temporalUnit, depayAV1Packets(&payloadArray));
+
+    // An OBU without obu_size runs to the end of the temporal unit
+    temporalUnit.resize(temporalUnit.size() - frameObu.size());
+    temporalUnit.push_back(0x30);
+    temporalUnit.insert(temporalUnit.end(), frameObu.begin() + 3, frameObu.end());
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForAV1(1200, temporalUnit.data(), (UINT32) temporalUnit.size(), &payloadArray));
+    EXPECT_EQ(3, payloadArray.payloadSubLenSize);
+    temporalUnit.resize(temporalUnit.size() - 3000);
+    temporalUnit.insert(temporalUnit.end(), frameObu.begin() + 1, frameObu.end());
+    temporalUnit[SIZEOF(av1SequenceHeader)] = 0x32;
+    EXPECT_EQ(temporalUnit, depayAV1Packets(&payloadArray));
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, av1RejectsMalformedObus)
+{
+    BYTE forbiddenBit[] = {0x92, 0x00};
+    BYTE truncatedSize[] = {0x32, 0x05, 0x01};
+    BYTE truncatedElement[] = {0x00, 0x05, 0x30, 0x01};
+    BYTE continuation[] = {AV1_AGGREGATION_HEADER_Z | (1 << AV1_AGGREGATION_HEADER_W_SHIFT), 0x01, 0x02};
+    BYTE depayload[32];
+    UINT32 depayloadLength = 0, temporalUnitLength = 0;
+    PayloadArray payloadArray;
+    BOOL isStart = TRUE;
+
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    EXPECT_EQ(STATUS_RTP_INVALID_AV1_OBU, createPayloadArrayForAV1(DEFAULT_MTU_SIZE, forbiddenBit, SIZEOF(forbiddenBit), &payloadArray));
+    EXPECT_EQ(STATUS_RTP_INVALID_AV1_OBU, createPayloadArrayForAV1(DEFAULT_MTU_SIZE, truncatedSize, SIZEOF(truncatedSize), &payloadArray));
+    EXPECT_EQ(0, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(STATUS_RTP_INPUT_MTU_TOO_SMALL, createPayloadArrayForAV1(1, truncatedSize, SIZEOF(truncatedSize), &payloadArray));
+
+    EXPECT_EQ(STATUS_RTP_INVALID_AV1_OBU, depayAV1FromRtpPayload(truncatedElement, SIZEOF(truncatedElement), NULL, &depayloadLength, NULL));
+    EXPECT_EQ(0, depayloadLength);
+    EXPECT_EQ(STATUS_RTP_INPUT_PACKET_TOO_SMALL, depayAV1FromRtpPayload(truncatedElement, 1, NULL, &depayloadLength, NULL));
+
+    // A frame can not start with the continuation of an OBU
+    depayloadLength = SIZEOF(depayload);
+    EXPECT_EQ(STATUS_SUCCESS, depayAV1FromRtpPayload(continuation, SIZEOF(continuation), depayload, &depayloadLength, &isStart));
+    EXPECT_FALSE(isStart);
+    EXPECT_EQ(AV1_ELEMENT_CONTINUES_PREVIOUS, depayload[0]);
+    EXPECT_EQ(STATUS_RTP_INVALID_AV1_OBU, av1ObuElementsToTemporalUnit(depayload, depayloadLength, &temporalUnitLength));
+    EXPECT_EQ(0, temporalUnitLength);
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+// L1T2 structure: a key frame template, a base layer template and an enhancement layer template protected by one chain
+static VOID createL1T2DependencyStructure(PAv1DependencyStructure pStructure)
+{
+    MEMSET(pStructure, 0x00, SIZEOF(Av1DependencyStructure));
+    pStructure->templateIdOffset = 62;
+    pStructure->decodeTargetCount = 2;
+    pStructure->chainCount = 1;
+    pStructure->templateCount = 3;
+    pStructure->resolutionsPresent = TRUE;
+    pStructure->renderWidths[0] = 1280;
+    pStructure->renderHeights[0] = 720;
+
+    pStructure->templates[0].decodeTargetIndications[0] = AV1_DTI_SWITCH;
+    pStructure->templates[0].decodeTargetIndications[1] = AV1_DTI_SWITCH;
+
+    pStructure->templates[1].decodeTargetIndications[0] = AV1_DTI_SWITCH;
+    pStructure->templates[1].decodeTargetIndications[1] = AV1_DTI_SWITCH;
+    pStructure->templates[1].frameDiffCount = 1;
+    pStructure->templates[1].frameDiffs[0] = 2;
+    pStructure->templates[1].chainDiffs[0] = 2;
+
+    pStructure->templates[2].temporalId = 1;
+    pStructure->templates[2].decodeTargetIndications[0] = AV1_DTI_NOT_PRESENT;
+    pStructure->templates[2].decodeTargetIndications[1] = AV1_DTI_DISCARDABLE;
+    pStructure->templates[2].frameDiffCount = 1;
+    pStructure->templates[2].frameDiffs[0] = 1;
+    pStructure->templates[2].chainDiffs[0] = 1;
+}
+
+TEST_F(RtpFunctionalityTest, av1DependencyDescriptorRoundTrip)
+{
+    Av1DependencyStructure structure, receivedStructure;
+    Av1DependencyDescriptor descriptor, parsed;
+    BYTE buffer[64];
+    UINT32 length;
+
+    createL1T2DependencyStructure(&structure);
+    MEMSET(&receivedStructure, 0x00, SIZEOF(Av1DependencyStructure));
+    MEMSET(&descriptor, 0x00, SIZEOF(Av1DependencyDescriptor));
+
+    // Key frame with the structure attached, template ids wrap around from the offset
+    descriptor.startOfFrame = TRUE;
+    descriptor.endOfFrame = TRUE;
+    descriptor.frameDependencyTemplateId = 62;
+    descriptor.frameNumber = 1234;
+    descriptor.structurePresent = TRUE;
+    length = SIZEOF(buffer);
+    EXPECT_EQ(STATUS_SUCCESS, writeAv1DependencyDescriptor(&descriptor, &structure, buffer, &length));
+    EXPECT_EQ(STATUS_SUCCESS, parseAv1DependencyDescriptor(buffer, length, &receivedStructure, &parsed));
+    EXPECT_TRUE(parsed.startOfFrame && parsed.endOfFrame && parsed.structurePresent);
+    EXPECT_EQ(1234, parsed.frameNumber);
+    EXPECT_EQ(0x03, parsed.activeDecodeTargetsBitmask);
+    EXPECT_EQ(0, MEMCMP(&structure, &receivedStructure, SIZEOF(Av1DependencyStructure)));
+    EXPECT_EQ(0, MEMCMP(&structure.templates[0], &parsed.frameDependencies, SIZEOF(Av1FrameDependencies)));
+
+    // Enhancement layer frame resolved against the stored structure, with custom frame diffs of every size
+    MEMSET(&descriptor, 0x00, SIZEOF(Av1DependencyDescriptor));
+    descriptor.frameDependencyTemplateId = 0;
+    descriptor.frameNumber = 1235;
+    descriptor.customFrameDiffs = TRUE;
+    descriptor.frameDependencies.frameDiffCount = 3;
+    descriptor.frameDependencies.frameDiffs[0] = 1;
+    descriptor.frameDependencies.frameDiffs[1] = 200;
+    descriptor.frameDependencies.frameDiffs[2] = 4096;
+    EXPECT_EQ(STATUS_SUCCESS, writeAv1DependencyDescriptor(&descriptor, &structure, NULL, &length));
+    EXPECT_EQ(STATUS_SUCCESS, writeAv1DependencyDescriptor(&descriptor, &structure, buffer, &length));
+    EXPECT_EQ(STATUS_SUCCESS, parseAv1DependencyDescriptor(buffer, length, &receivedStructure, &parsed));
+    EXPECT_FALSE(parsed.startOfFrame || parsed.structurePresent);
+    EXPECT_EQ(1, parsed.frameDependencies.temporalId);
+    EXPECT_EQ(AV1_DTI_DISCARDABLE, parsed.frameDependencies.decodeTargetIndications[1]);
+    EXPECT_EQ(3, parsed.frameDependencies.frameDiffCount);
+    EXPECT_EQ(200, parsed.frameDependencies.frameDiffs[1]);
+    EXPECT_EQ(4096, parsed.frameDependencies.frameDiffs[2]);
+    EXPECT_EQ(1, parsed.frameDependencies.chainDiffs[0]);
+
+    // Only the mandatory fields are needed to follow a template
+    descriptor.customFrameDiffs = FALSE;
+    descriptor.frameDependencyTemplateId = 63;
+    EXPECT_EQ(STATUS_SUCCESS, writeAv1DependencyDescriptor(&descriptor, &structure, buffer, &length));
+    EXPECT_EQ(AV1_DEPENDENCY_DESCRIPTOR_MANDATORY_SIZE, length);
+    EXPECT_EQ(STATUS_SUCCESS, parseAv1DependencyDescriptor(buffer, length, &receivedStructure, &parsed));
+    EXPECT_EQ(0, MEMCMP(&structure.templates[1], &parsed.frameDependencies, SIZEOF(Av1FrameDependencies)));
+
+    length = 2;
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, writeAv1DependencyDescriptor(&descriptor, &structure, buffer, &length));
+    EXPECT_EQ(AV1_DEPENDENCY_DESCRIPTOR_MANDATORY_SIZE, length);
+
+    // Template 1 past the last one and a descriptor before any structure
+    descriptor.frameDependencyTemplateId = 1;
+    EXPECT_EQ(STATUS_SUCCESS, writeAv1DependencyDescriptor(&descriptor, NULL, buffer, &length));
+    EXPECT_EQ(STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR, parseAv1DependencyDescriptor(buffer, length, &receivedStructure, &parsed));
+    MEMSET(&receivedStructure, 0x00, SIZEOF(Av1DependencyStructure));
+    EXPECT_EQ(STATUS_RTP_MISSING_DEPENDENCY_STRUCTURE, parseAv1DependencyDescriptor(buffer, length, &receivedStructure, &parsed));
+    EXPECT_EQ(STATUS_RTP_INVALID_DEPENDENCY_DESCRIPTOR, parseAv1DependencyDescriptor(buffer, 2, &receivedStructure, &parsed));
+}
+
+// Starts of profile 0 uncompressed headers: a key frame, a shown inter frame and a hidden intra-only frame
+static BYTE vp9KeyFrameHeader[] = {0x82, 0x49, 0x83, 0x42, 0x00};
+static BYTE vp9InterFrameHeader[] = {0x86, 0x00, 0x40};
+static BYTE vp9IntraOnlyFrameHeader[] = {0x84, 0x80, 0x00};
+
+static std::vector<BYTE> createVP9LayerFrame(PBYTE pHeader, UINT32 headerSize, UINT32 frameSize)
+{
+    std::vector<BYTE> frame(pHeader, pHeader + headerSize);
+    UINT32 i;
+
+    for (i = headerSize; i < frameSize; i++) {
+        frame.push_back((BYTE) (i % 251));
+    }
+
+    return frame;
+}
+
+// Depayloads every packet into one frame like the jitter buffer does and joins the layer frames
+static std::vector<BYTE> depayVP9Packets(PPayloadArray pPayloadArray)
+{
+    std::vector<BYTE> frame;
+    UINT32 i, offset = 0, depayloadLength, frameLength = 0;
+
+    for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
+        EXPECT_EQ(STATUS_SUCCESS,
+                  depayVP9FromRtpPayload(pPayloadArray->payloadBuffer + offset, pPayloadArray->payloadSubLength[i], NULL, &depayloadLength, NULL));
+        frame.resize(frameLength + depayloadLength);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  depayVP9FromRtpPayload(pPayloadArray->payloadBuffer + offset, pPayloadArray->payloadSubLength[i], frame.data() + frameLength,
+                                         &depayloadLength, NULL));
+        frameLength += depayloadLength;
+        offset += pPayloadArray->payloadSubLength[i];
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, vp9LayerFramesToSuperframe(frame.data(), frameLength, &frameLength));
+    frame.resize(frameLength);
+
+    return frame;
+}
+
+TEST_F(RtpFunctionalityTest, vp9PayloadsSingleLayerFrames)
+{
+    std::vector<BYTE> frame = createVP9LayerFrame(vp9KeyFrameHeader, SIZEOF(vp9KeyFrameHeader), 3000);
+    BYTE expectedDescriptors[] = {VP9_PAYLOAD_DESCRIPTOR_B, 0, VP9_PAYLOAD_DESCRIPTOR_E};
+    PayloadArray payloadArray;
+    UINT32 i, offset = 0, depayloadLength;
+    BOOL isStart;
+
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+
+    // A key frame is not inter-picture predicted, every packet carries a one byte descriptor
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForVP9(1200, frame.data(), (UINT32) frame.size(), &payloadArray));
+    EXPECT_EQ(3, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(1200, payloadArray.payloadSubLength[0]);
+    EXPECT_EQ(1200, payloadArray.payloadSubLength[1]);
+    EXPECT_EQ(1 + 3000 - 2 * 1199, payloadArray.payloadSubLength[2]);
+    for (i = 0; i < payloadArray.payloadSubLenSize; i++) {
+        EXPECT_EQ(expectedDescriptors[i], payloadArray.payloadBuffer[offset]);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  depayVP9FromRtpPayload(payloadArray.payloadBuffer + offset, payloadArray.payloadSubLength[i], NULL, &depayloadLength, &isStart));
+        EXPECT_EQ(i == 0, isStart);
+        EXPECT_EQ(VP9_LAYER_FRAME_PREFIX_SIZE + payloadArray.payloadSubLength[i] - 1, depayloadLength);
+        offset += payloadArray.payloadSubLength[i];
+    }
+    EXPECT_EQ(frame, depayVP9Packets(&payloadArray));
+
+    frame = createVP9LayerFrame(vp9InterFrameHeader, SIZEOF(vp9InterFrameHeader), 100);
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForVP9(1200, frame.data(), (UINT32) frame.size(), &payloadArray));
+    EXPECT_EQ(1, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(VP9_PAYLOAD_DESCRIPTOR_P | VP9_PAYLOAD_DESCRIPTOR_B | VP9_PAYLOAD_DESCRIPTOR_E, payloadArray.payloadBuffer[0]);
+    EXPECT_EQ(frame, depayVP9Packets(&payloadArray));
+
+    frame = createVP9LayerFrame(vp9IntraOnlyFrameHeader, SIZEOF(vp9IntraOnlyFrameHeader), 100);
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForVP9(1200, frame.data(), (UINT32) frame.size(), &payloadArray));
+    EXPECT_EQ(VP9_PAYLOAD_DESCRIPTOR_B | VP9_PAYLOAD_DESCRIPTOR_E, payloadArray.payloadBuffer[0]);
+
+    EXPECT_EQ(STATUS_RTP_INPUT_MTU_TOO_SMALL, createPayloadArrayForVP9(1, frame.data(), (UINT32) frame.size(), &payloadArray));
+    EXPECT_EQ(0, payloadArray.payloadSubLenSize);
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, vp9PayloadDescriptorRoundTrip)
+{
+    std::vector<BYTE> frame = createVP9LayerFrame(vp9InterFrameHeader, SIZEOF(vp9InterFrameHeader), 50);
+    BYTE expectedFlexible[] = {0xfe, 0x92, 0x34, 0x35, 0x03, 0x06, 0x58, 0x01, 0x40, 0x00, 0xb4, 0x02, 0x80,
+                               0x01, 0x68, 0x05, 0x00, 0x02, 0xd0, 0x02, 0x04, 0x02, 0x34, 0x01};
+    BYTE expectedNonFlexible[] = {0xac, 0x80, 0x05, 0x00, 0x07};
+    BYTE shortPictureId[] = {0x88, 0x05, 0xaa};
+    Vp9ScalabilityStructure structure, parsedStructure;
+    Vp9PayloadDescriptor descriptor, parsed;
+    PayloadArray payloadArray;
+    UINT32 descriptorLength = 0;
+
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    MEMSET(&structure, 0x00, SIZEOF(Vp9ScalabilityStructure));
+    structure.spatialLayerCount = 3;
+    structure.resolutionsPresent = TRUE;
+    structure.widths[0] = 320;
+    structure.heights[0] = 180;
+    structure.widths[1] = 640;
+    structure.heights[1] = 360;
+    structure.widths[2] = 1280;
+    structure.heights[2] = 720;
+    structure.pictureGroupPresent = TRUE;
+    structure.pictureGroupSize = 2;
+    structure.pictureGroup[0].referenceCount = 1;
+    structure.pictureGroup[0].pDiffs[0] = 2;
+    structure.pictureGroup[1].temporalId = 1;
+    structure.pictureGroup[1].switchingUpPoint = TRUE;
+    structure.pictureGroup[1].referenceCount = 1;
+    structure.pictureGroup[1].pDiffs[0] = 1;
+
+    // Flexible mode with every optional field
+    MEMSET(&descriptor, 0x00, SIZEOF(Vp9PayloadDescriptor));
+    descriptor.pictureIdPresent = TRUE;
+    descriptor.pictureId = 0x1234;
+    descriptor.interPicturePredicted = TRUE;
+    descriptor.flexibleMode = TRUE;
+    descriptor.layerIndicesPresent = TRUE;
+    descriptor.temporalId = 1;
+    descriptor.switchingUpPoint = TRUE;
+    descriptor.spatialId = 2;
+    descriptor.interLayerDependency = TRUE;
+    descriptor.referenceCount = 2;
+    descriptor.pDiffs[0] = 1;
+    descriptor.pDiffs[1] = 3;
+    descriptor.scalabilityStructurePresent = TRUE;
+    descriptor.pScalabilityStructure = &structure;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createPayloadArrayForVP9WithDescriptor(DEFAULT_MTU_SIZE, frame.data(), (UINT32) frame.size(), &descriptor, &payloadArray));
+    EXPECT_EQ(1, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(SIZEOF(expectedFlexible) + frame.size(), payloadArray.payloadLength);
+    EXPECT_EQ(0, MEMCMP(expectedFlexible, payloadArray.payloadBuffer, SIZEOF(expectedFlexible)));
+
+    parsed.pScalabilityStructure = &parsedStructure;
+    EXPECT_EQ(STATUS_SUCCESS, parseVp9PayloadDescriptor(payloadArray.payloadBuffer, payloadArray.payloadLength, &parsed, &descriptorLength));
+    EXPECT_EQ(SIZEOF(expectedFlexible), descriptorLength);
+    EXPECT_TRUE(parsed.startOfLayerFrame && parsed.endOfLayerFrame && parsed.pictureIdPresent && parsed.interPicturePredicted);
+    EXPECT_TRUE(parsed.flexibleMode && parsed.layerIndicesPresent && parsed.switchingUpPoint && parsed.interLayerDependency);
+    EXPECT_EQ(0x1234, parsed.pictureId);
+    EXPECT_EQ(1, parsed.temporalId);
+    EXPECT_EQ(2, parsed.spatialId);
+    EXPECT_EQ(2, parsed.referenceCount);
+    EXPECT_EQ(1, parsed.pDiffs[0]);
+    EXPECT_EQ(3, parsed.pDiffs[1]);
+    EXPECT_TRUE(parsed.scalabilityStructurePresent);
+    EXPECT_EQ(&parsedStructure, parsed.pScalabilityStructure);
+    EXPECT_EQ(0, MEMCMP(&structure, &parsedStructure, SIZEOF(Vp9ScalabilityStructure)));
+
+    // The scalability structure only goes into the first packet
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForVP9WithDescriptor(SIZEOF(expectedFlexible) + 30, frame.data(), (UINT32) frame.size(), &descriptor,
+                                                                     &payloadArray));
+    EXPECT_EQ(2, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(SIZEOF(expectedFlexible) + 30, payloadArray.payloadSubLength[0]);
+    EXPECT_EQ(6 + 20, payloadArray.payloadSubLength[1]);
+    EXPECT_EQ(0xf4, payloadArray.payloadBuffer[payloadArray.payloadSubLength[0]]);
+    EXPECT_EQ(0, MEMCMP(expectedFlexible + 1, payloadArray.payloadBuffer + payloadArray.payloadSubLength[0] + 1, 5));
+    EXPECT_EQ(frame, depayVP9Packets(&payloadArray));
+
+    // Non-flexible mode carries TL0PICIDX instead of reference indices
+    MEMSET(&descriptor, 0x00, SIZEOF(Vp9PayloadDescriptor));
+    descriptor.pictureIdPresent = TRUE;
+    descriptor.pictureId = 5;
+    descriptor.layerIndicesPresent = TRUE;
+    descriptor.tl0PicIdx = 7;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createPayloadArrayForVP9WithDescriptor(DEFAULT_MTU_SIZE, frame.data(), (UINT32) frame.size(), &descriptor, &payloadArray));
+    EXPECT_EQ(0, MEMCMP(expectedNonFlexible, payloadArray.payloadBuffer, SIZEOF(expectedNonFlexible)));
+    parsed.pScalabilityStructure = NULL;
+    EXPECT_EQ(STATUS_SUCCESS, parseVp9PayloadDescriptor(payloadArray.payloadBuffer, payloadArray.payloadLength, &parsed, &descriptorLength));
+    EXPECT_EQ(SIZEOF(expectedNonFlexible), descriptorLength);
+    EXPECT_EQ(7, parsed.tl0PicIdx);
+
+    // Receivers accept 7 bit picture IDs
+    EXPECT_EQ(STATUS_SUCCESS, parseVp9PayloadDescriptor(shortPictureId, SIZEOF(shortPictureId), &parsed, &descriptorLength));
+    EXPECT_EQ(2, descriptorLength);
+    EXPECT_EQ(5, parsed.pictureId);
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, vp9RejectsMalformedDescriptors)
+{
+    BYTE missingPictureId[] = {0x80};
+    BYTE truncatedPictureId[] = {0x80, 0x81};
+    BYTE missingTl0PicIdx[] = {0x20, 0x00};
+    BYTE tooManyReferences[] = {0x50, 0x03, 0x03, 0x03, 0x02};
+    BYTE truncatedResolutions[] = {0x02, 0x10, 0x01, 0x40};
+    BYTE truncatedPictureGroup[] = {0x02, 0x08, 0x01, 0x04};
+    BYTE truncatedPrefix[] = {VP9_LAYER_FRAME_START, 0x00, 0x00, 0x00, 0x05, 0xaa};
+    PBYTE malformed[] = {missingPictureId, truncatedPictureId, missingTl0PicIdx, tooManyReferences, truncatedResolutions, truncatedPictureGroup};
+    UINT32 malformedSizes[] = {SIZEOF(missingPictureId),  SIZEOF(truncatedPictureId),   SIZEOF(missingTl0PicIdx),
+                               SIZEOF(tooManyReferences), SIZEOF(truncatedResolutions), SIZEOF(truncatedPictureGroup)};
+    BYTE frame[10] = {0};
+    Vp9PayloadDescriptor descriptor;
+    PayloadArray payloadArray;
+    UINT32 i, length;
+
+    for (i = 0; i < ARRAY_SIZE(malformed); i++) {
+        descriptor.pScalabilityStructure = NULL;
+        EXPECT_EQ(STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR, parseVp9PayloadDescriptor(malformed[i], malformedSizes[i], &descriptor, &length));
+        EXPECT_EQ(0, length);
+        EXPECT_EQ(STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR, depayVP9FromRtpPayload(malformed[i], malformedSizes[i], NULL, &length, NULL));
+        EXPECT_EQ(0, length);
+        length = malformedSizes[i];
+        EXPECT_EQ(STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR, vp9FilterLayers(malformed[i], &length, 0, 0));
+    }
+
+    EXPECT_EQ(STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR, vp9LayerFramesToSuperframe(truncatedPrefix, SIZEOF(truncatedPrefix), &length));
+    EXPECT_EQ(STATUS_RTP_INVALID_VP9_PAYLOAD_DESCRIPTOR, vp9LayerFramesToSuperframe(truncatedPrefix, 3, &length));
+
+    // Descriptors which can not be written
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    MEMSET(&descriptor, 0x00, SIZEOF(Vp9PayloadDescriptor));
+    descriptor.flexibleMode = TRUE;
+    descriptor.interPicturePredicted = TRUE;
+    EXPECT_EQ(STATUS_INVALID_ARG, createPayloadArrayForVP9WithDescriptor(DEFAULT_MTU_SIZE, frame, SIZEOF(frame), &descriptor, &payloadArray));
+    descriptor.referenceCount = 1;
+    descriptor.pDiffs[0] = VP9_MAX_P_DIFF + 1;
+    EXPECT_EQ(STATUS_INVALID_ARG, createPayloadArrayForVP9WithDescriptor(DEFAULT_MTU_SIZE, frame, SIZEOF(frame), &descriptor, &payloadArray));
+    descriptor.pDiffs[0] = 1;
+    descriptor.pictureIdPresent = TRUE;
+    descriptor.pictureId = VP9_MAX_PICTURE_ID + 1;
+    EXPECT_EQ(STATUS_INVALID_ARG, createPayloadArrayForVP9WithDescriptor(DEFAULT_MTU_SIZE, frame, SIZEOF(frame), &descriptor, &payloadArray));
+    descriptor.pictureId = 0;
+    descriptor.scalabilityStructurePresent = TRUE;
+    EXPECT_EQ(STATUS_NULL_ARG, createPayloadArrayForVP9WithDescriptor(DEFAULT_MTU_SIZE, frame, SIZEOF(frame), &descriptor, &payloadArray));
+    EXPECT_EQ(0, payloadArray.payloadSubLenSize);
+}
+
+#define VP9_SVC_TEST_PICTURE_COUNT 5
+#define VP9_SVC_TEST_SPATIAL_LAYERS 3
+
+struct Vp9SvcReceiver {
+    PJitterBuffer pJitterBuffer;
+    std::vector<std::vector<BYTE>> frames;
+    UINT32 droppedFrames;
+};
+
+static STATUS vp9SvcFrameReady(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 frameSize)
+{
+    Vp9SvcReceiver* pReceiver = (Vp9SvcReceiver*) customData;
+    std::vector<BYTE> frame(frameSize);
+    UINT32 filledSize = 0;
+    STATUS retStatus;
+
+    // The frame size is the payload size, the layer frame prefixes can take more than the descriptors they replace
+    while ((retStatus = jitterBufferFillFrameData(pReceiver->pJitterBuffer, frame.data(), (UINT32) frame.size(), &filledSize, startIndex,
+                                                  endIndex)) == STATUS_BUFFER_TOO_SMALL) {
+        frame.resize(frame.size() * 2);
+    }
+    EXPECT_EQ(STATUS_SUCCESS, retStatus);
+    EXPECT_EQ(STATUS_SUCCESS, vp9LayerFramesToSuperframe(frame.data(), filledSize, &frameSize));
+    frame.resize(frameSize);
+    pReceiver->frames.push_back(frame);
+
+    return STATUS_SUCCESS;
+}
+
+static STATUS vp9SvcFrameDropped(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 timestamp)
+{
+    UNUSED_PARAM(startIndex);
+    UNUSED_PARAM(endIndex);
+    UNUSED_PARAM(timestamp);
+    ((Vp9SvcReceiver*) customData)->droppedFrames++;
+    return STATUS_SUCCESS;
+}
+
+TEST_F(RtpFunctionalityTest, vp9SvcLayerDropInJitterBuffer)
+{
+    // Every picture has three spatial layers, odd pictures are on temporal layer 1. Receivers pick the layers they decode.
+    UINT8 maxLayers[][2] = {{2, 1}, {1, 0}, {0, 1}};
+    std::vector<BYTE> layerFrames[VP9_SVC_TEST_SPATIAL_LAYERS], expected;
+    Vp9PayloadDescriptor descriptor;
+    Vp9ScalabilityStructure structure;
+    Vp9SvcReceiver receiver;
+    PayloadArray payloadArray;
+    RtpPacket packetList[8];
+    PRtpPacket pRtpPacket;
+    PBYTE pRawPacket;
+    UINT32 i, j, picture, spatialId, packetLength, layerCount, expectedLayerCount;
+    UINT16 sequenceNumber;
+
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    MEMSET(&structure, 0x00, SIZEOF(Vp9ScalabilityStructure));
+    structure.spatialLayerCount = VP9_SVC_TEST_SPATIAL_LAYERS;
+    for (spatialId = 0; spatialId < VP9_SVC_TEST_SPATIAL_LAYERS; spatialId++) {
+        layerFrames[spatialId] = createVP9LayerFrame(vp9InterFrameHeader, SIZEOF(vp9InterFrameHeader), 400 * (spatialId + 1));
+    }
+
+    for (i = 0; i < ARRAY_SIZE(maxLayers); i++) {
+        receiver.frames.clear();
+        receiver.droppedFrames = 0;
+        EXPECT_EQ(STATUS_SUCCESS,
+                  createJitterBuffer(vp9SvcFrameReady, vp9SvcFrameDropped, depayVP9FromRtpPayload, DEFAULT_JITTER_BUFFER_MAX_LATENCY,
+                                     VIDEO_CLOCKRATE, (UINT64) &receiver, &receiver.pJitterBuffer));
+        sequenceNumber = 65000;
+
+        for (picture = 0; picture < VP9_SVC_TEST_PICTURE_COUNT; picture++) {
+            for (spatialId = 0; spatialId < VP9_SVC_TEST_SPATIAL_LAYERS; spatialId++) {
+                MEMSET(&descriptor, 0x00, SIZEOF(Vp9PayloadDescriptor));
+                descriptor.pictureIdPresent = TRUE;
+                descriptor.pictureId = (UINT16) picture;
+                descriptor.interPicturePredicted = picture != 0;
+                descriptor.layerIndicesPresent = TRUE;
+                descriptor.temporalId = (UINT8) (picture % 2);
+                descriptor.spatialId = (UINT8) spatialId;
+                descriptor.interLayerDependency = spatialId != 0;
+                descriptor.tl0PicIdx = (UINT8) (picture / 2);
+                descriptor.scalabilityStructurePresent = picture == 0 && spatialId == 0;
+                descriptor.pScalabilityStructure = &structure;
+                EXPECT_EQ(STATUS_SUCCESS,
+                          createPayloadArrayForVP9WithDescriptor(500, layerFrames[spatialId].data(), (UINT32) layerFrames[spatialId].size(),
+                                                                 &descriptor, &payloadArray));
+                ASSERT_GE(ARRAY_SIZE(packetList), payloadArray.payloadSubLenSize);
+                EXPECT_EQ(STATUS_SUCCESS,
+                          constructRtpPackets(&payloadArray, DEFAULT_PAYLOAD_VP9, sequenceNumber, 3000 * (picture + 1), 0x1234, packetList,
+                                              payloadArray.payloadSubLenSize));
+                sequenceNumber += (UINT16) payloadArray.payloadSubLenSize;
+
+                // Same path as sendPacketToRtpReceiver: the raw packet is parsed, filtered and handed to the jitter buffer
+                for (j = 0; j < payloadArray.payloadSubLenSize; j++) {
+                    packetLength = RTP_GET_RAW_PACKET_SIZE(&packetList[j]);
+                    pRawPacket = (PBYTE) MEMALLOC(packetLength);
+                    EXPECT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(&packetList[j], pRawPacket, &packetLength));
+                    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketFromBytes(pRawPacket, packetLength, &pRtpPacket));
+                    EXPECT_EQ(STATUS_SUCCESS, vp9FilterLayers(pRtpPacket->payload, &pRtpPacket->payloadLength, maxLayers[i][0], maxLayers[i][1]));
+                    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(receiver.pJitterBuffer, pRtpPacket, NULL));
+                }
+            }
+        }
+        EXPECT_EQ(STATUS_SUCCESS, freeJitterBuffer(&receiver.pJitterBuffer));
+
+        // Pictures above the temporal layer come out empty, the others as a superframe of the kept spatial layers
+        EXPECT_EQ(0, receiver.droppedFrames);
+        ASSERT_EQ(VP9_SVC_TEST_PICTURE_COUNT, receiver.frames.size());
+        expectedLayerCount = maxLayers[i][0] + 1;
+        for (picture = 0; picture < VP9_SVC_TEST_PICTURE_COUNT; picture++) {
+            expected.clear();
+            layerCount = picture % 2 > maxLayers[i][1] ? 0 : expectedLayerCount;
+            for (spatialId = 0; spatialId < layerCount; spatialId++) {
+                expected.insert(expected.end(), layerFrames[spatialId].begin(), layerFrames[spatialId].end());
+            }
+            if (layerCount > 1) {
+                expected.push_back(VP9_SUPERFRAME_MARKER | ((VP9_SUPERFRAME_SIZE_BYTES - 1) << 3) | (layerCount - 1));
+                for (spatialId = 0; spatialId < layerCount; spatialId++) {
+                    expected.resize(expected.size() + VP9_SUPERFRAME_SIZE_BYTES);
+                    putUnalignedInt32LittleEndian(expected.data() + expected.size() - VP9_SUPERFRAME_SIZE_BYTES,
+                                                  (INT32) layerFrames[spatialId].size());
+                }
+                expected.push_back(expected[expected.size() - VP9_SUPERFRAME_INDEX_SIZE(layerCount) + 1]);
+            }
+            EXPECT_EQ(expected, receiver.frames[picture]);
+        }
+    }
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, getRtpHeaderExtensionElement)
+{
+    // TWCC with id 3, a padding byte and a 3 byte element with id 4
+    BYTE oneByteExtension[] = {0x31, 0x01, 0x02, 0x00, 0x42, 0xaa, 0xbb, 0xcc};
+    BYTE twoByteExtension[] = {0x03, 0x02, 0x01, 0x02, 0x04, 0x03, 0xaa, 0xbb, 0xcc, 0x00, 0x00, 0x00};
+    RtpPacket rtpPacket;
+    PBYTE pElement = NULL;
+    UINT32 elementLength = 0;
+
+    MEMSET(&rtpPacket, 0x00, SIZEOF(RtpPacket));
+    EXPECT_EQ(STATUS_RTP_HEADER_EXTENSION_NOT_FOUND, getRtpHeaderExtensionElement(&rtpPacket, 4, &pElement, &elementLength));
+
+    rtpPacket.header.extension = TRUE;
+    rtpPacket.header.extensionProfile = RTP_ONE_BYTE_EXT_PROFILE;
+    rtpPacket.header.extensionPayload = oneByteExtension;
+    rtpPacket.header.extensionLength = SIZEOF(oneByteExtension);
+    EXPECT_EQ(STATUS_SUCCESS, getRtpHeaderExtensionElement(&rtpPacket, 4, &pElement, &elementLength));
+    EXPECT_EQ(oneByteExtension + 5, pElement);
+    EXPECT_EQ(3, elementLength);
+    EXPECT_EQ(STATUS_SUCCESS, getRtpHeaderExtensionElement(&rtpPacket, 3, &pElement, &elementLength));
+    EXPECT_EQ(2, elementLength);
+    EXPECT_EQ(STATUS_RTP_HEADER_EXTENSION_NOT_FOUND, getRtpHeaderExtensionElement(&rtpPacket, 5, &pElement, &elementLength));
+
+    rtpPacket.header.extensionProfile = RTP_TWO_BYTE_EXT_PROFILE;
+    rtpPacket.header.extensionPayload = twoByteExtension;
+    rtpPacket.header.extensionLength = SIZEOF(twoByteExtension);
+    EXPECT_EQ(STATUS_SUCCESS, getRtpHeaderExtensionElement(&rtpPacket, 4, &pElement, &elementLength));
+    EXPECT_EQ(twoByteExtension + 6, pElement);
+    EXPECT_EQ(3, elementLength);
+
+    // Element length past the end of the block
+    twoByteExtension[5] = 0x10;
+    EXPECT_EQ(STATUS_RTP_INVALID_EXTENSION_LEN, getRtpHeaderExtensionElement(&rtpPacket, 4, &pElement, &elementLength));
+}
+
 // https://tools.ietf.org/html/rfc3550#section-5.3.1
 TEST_F(RtpFunctionalityTest, createPacketWithExtension)
 {
@@ -522,6 +1457,357 @@ TEST_F(RtpFunctionalityTest, twccPayload)
     EXPECT_EQ(0, ptr[3]);
 }
 
+TEST_F(RtpFunctionalityTest, retransmitBytesMatchRetransmitPacket)
+{
+    BYTE payload[10] = {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19};
+    BYTE extpayload[4] = {0x42, 0x43, 0x44, 0x45};
+    BYTE rawbytes[128] = {0}, rtxBytes[128] = {0};
+    PRtpPacket pRtpPacket = NULL, pStoredPacket = NULL, pRtxPacket = NULL;
+    UINT32 len, rtxLen;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createRtpPacket(2, FALSE, TRUE, 0, TRUE, 96, 4242, 100, 0x1234ABCD, NULL, TWCC_EXT_PROFILE, 4, extpayload, payload, 10, &pRtpPacket));
+    len = SIZEOF(rawbytes);
+    EXPECT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(pRtpPacket, rawbytes, &len));
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketFromBytes(rawbytes, len, &pStoredPacket));
+
+    EXPECT_EQ(STATUS_SUCCESS, createRetransmitBytesFromRtpPacket(pStoredPacket, 7, 97, 0xCAFEBABE, NULL, &rtxLen));
+    EXPECT_EQ(len + RTX_OSN_SIZE, rtxLen);
+    rtxLen--;
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, createRetransmitBytesFromRtpPacket(pStoredPacket, 7, 97, 0xCAFEBABE, rtxBytes, &rtxLen));
+    rtxLen = SIZEOF(rtxBytes);
+    EXPECT_EQ(STATUS_SUCCESS, createRetransmitBytesFromRtpPacket(pStoredPacket, 7, 97, 0xCAFEBABE, rtxBytes, &rtxLen));
+
+    // Same bytes as the packet built the allocating way
+    EXPECT_EQ(STATUS_SUCCESS, constructRetransmitRtpPacketFromBytes(rawbytes, len, 7, 97, 0xCAFEBABE, &pRtxPacket));
+    EXPECT_EQ(pRtxPacket->rawPacketLength, rtxLen);
+    EXPECT_EQ(0, MEMCMP(pRtxPacket->pRawPacket, rtxBytes, rtxLen));
+    EXPECT_EQ(4242, getInt16(*(PUINT16) (rtxBytes + RTP_HEADER_LEN(pStoredPacket))));
+    EXPECT_TRUE(((rtxBytes[1] >> MARKER_SHIFT) & MARKER_MASK) != 0);
+
+    // rawbytes is on the stack
+    pStoredPacket->pRawPacket = NULL;
+    freeRtpPacket(&pStoredPacket);
+    freeRtpPacket(&pRtxPacket);
+    freeRtpPacket(&pRtpPacket);
+}
+
+static std::vector<BYTE> createRedTestOpusFrame(UINT32 index)
+{
+    std::vector<BYTE> frame(40 + (index * 37) % 80);
+    UINT32 i;
+
+    for (i = 0; i < frame.size(); i++) {
+        frame[i] = (BYTE) (index * 13 + i);
+    }
+
+    return frame;
+}
+
+TEST_F(RtpFunctionalityTest, redWrapAndParseRoundTrip)
+{
+    PRedEncoder pRedEncoder = NULL;
+    PayloadArray payloadArray;
+    RedBlock blocks[RED_MAX_BLOCKS];
+    std::vector<BYTE> frames[6];
+    UINT32 i, j, blockCount, redundantCount;
+
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    EXPECT_EQ(STATUS_INVALID_ARG, createRedEncoder(0, &pRedEncoder));
+    EXPECT_EQ(STATUS_INVALID_ARG, createRedEncoder(RED_MAX_REDUNDANCY_DEPTH + 1, &pRedEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, createRedEncoder(2, &pRedEncoder));
+
+    for (i = 0; i < ARRAY_SIZE(frames); i++) {
+        frames[i] = createRedTestOpusFrame(i);
+        EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForOpus(DEFAULT_MTU_SIZE, frames[i].data(), (UINT32) frames[i].size(), &payloadArray));
+        EXPECT_EQ(STATUS_SUCCESS, redEncoderWrapPayloadArray(pRedEncoder, DEFAULT_PAYLOAD_OPUS, 960 * (i + 1), DEFAULT_MTU_SIZE, &payloadArray));
+        EXPECT_EQ(1, payloadArray.payloadSubLenSize);
+        EXPECT_EQ(payloadArray.payloadLength, payloadArray.payloadSubLength[0]);
+
+        // The newest encodings are repeated oldest first, followed by the primary one
+        redundantCount = MIN(i, 2);
+        blockCount = ARRAY_SIZE(blocks);
+        EXPECT_EQ(STATUS_SUCCESS, parseRedPayload(payloadArray.payloadBuffer, payloadArray.payloadLength, blocks, &blockCount));
+        ASSERT_EQ(redundantCount + 1, blockCount);
+        for (j = 0; j < blockCount; j++) {
+            EXPECT_EQ(DEFAULT_PAYLOAD_OPUS, blocks[j].payloadType);
+            EXPECT_EQ(960 * (redundantCount - j), blocks[j].timestampOffset);
+            EXPECT_TRUE(std::vector<BYTE>(blocks[j].pData, blocks[j].pData + blocks[j].length) == frames[i - redundantCount + j]);
+        }
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRedEncoder(&pRedEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, freeRedEncoder(&pRedEncoder));
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, redOnlyRepeatsContiguousEncodingsThatFit)
+{
+    PRedEncoder pRedEncoder = NULL;
+    PayloadArray payloadArray;
+    RedBlock blocks[RED_MAX_BLOCKS];
+    std::vector<BYTE> frame(100, 0x42), largeFrame(RED_BLOCK_LENGTH_MAX + 1, 0x24);
+    UINT32 i, blockCount;
+
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    EXPECT_EQ(STATUS_SUCCESS, createRedEncoder(3, &pRedEncoder));
+
+    for (i = 0; i < 3; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForOpus(DEFAULT_MTU_SIZE, frame.data(), (UINT32) frame.size(), &payloadArray));
+        EXPECT_EQ(STATUS_SUCCESS, redEncoderWrapPayloadArray(pRedEncoder, DEFAULT_PAYLOAD_OPUS, 960 * (i + 1), DEFAULT_MTU_SIZE, &payloadArray));
+    }
+
+    // Room for the primary encoding and a single redundant one
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForOpus(DEFAULT_MTU_SIZE, frame.data(), (UINT32) frame.size(), &payloadArray));
+    EXPECT_EQ(STATUS_SUCCESS,
+              redEncoderWrapPayloadArray(pRedEncoder, DEFAULT_PAYLOAD_OPUS, 960 * 4,
+                                         RED_PRIMARY_HEADER_SIZE + RED_BLOCK_HEADER_SIZE + 2 * (UINT32) frame.size(), &payloadArray));
+    blockCount = ARRAY_SIZE(blocks);
+    EXPECT_EQ(STATUS_SUCCESS, parseRedPayload(payloadArray.payloadBuffer, payloadArray.payloadLength, blocks, &blockCount));
+    ASSERT_EQ(2, blockCount);
+    EXPECT_EQ(960, blocks[0].timestampOffset);
+
+    // Encodings too far back for the 14 bit timestamp offset are left out
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForOpus(DEFAULT_MTU_SIZE, frame.data(), (UINT32) frame.size(), &payloadArray));
+    EXPECT_EQ(STATUS_SUCCESS,
+              redEncoderWrapPayloadArray(pRedEncoder, DEFAULT_PAYLOAD_OPUS, 960 * 4 + RED_TIMESTAMP_OFFSET_MAX + 1, DEFAULT_MTU_SIZE, &payloadArray));
+    blockCount = ARRAY_SIZE(blocks);
+    EXPECT_EQ(STATUS_SUCCESS, parseRedPayload(payloadArray.payloadBuffer, payloadArray.payloadLength, blocks, &blockCount));
+    EXPECT_EQ(1, blockCount);
+
+    // An encoding too large for the 10 bit block length also hides the ones before it, the receiver relies on them being contiguous
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForOpus(DEFAULT_MTU_SIZE, largeFrame.data(), (UINT32) largeFrame.size(), &payloadArray));
+    EXPECT_EQ(STATUS_SUCCESS, redEncoderWrapPayloadArray(pRedEncoder, DEFAULT_PAYLOAD_OPUS, 30000, 2 * DEFAULT_MTU_SIZE, &payloadArray));
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForOpus(DEFAULT_MTU_SIZE, frame.data(), (UINT32) frame.size(), &payloadArray));
+    EXPECT_EQ(STATUS_SUCCESS, redEncoderWrapPayloadArray(pRedEncoder, DEFAULT_PAYLOAD_OPUS, 30960, DEFAULT_MTU_SIZE, &payloadArray));
+    blockCount = ARRAY_SIZE(blocks);
+    EXPECT_EQ(STATUS_SUCCESS, parseRedPayload(payloadArray.payloadBuffer, payloadArray.payloadLength, blocks, &blockCount));
+    EXPECT_EQ(1, blockCount);
+    EXPECT_EQ(frame.size(), blocks[0].length);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRedEncoder(&pRedEncoder));
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, parseRedPayloadRejectsMalformedPayloads)
+{
+    // Primary encoding only
+    BYTE primaryOnly[] = {0x6f, 0x01, 0x02, 0x03};
+    // Redundant block of 2 bytes at offset 960 and a primary block of 1 byte
+    BYTE valid[] = {0xef, 0x0f, 0x00, 0x02, 0x6f, 0xaa, 0xbb, 0xcc};
+    // Block header cut short
+    BYTE truncatedHeader[] = {0xef, 0x0f, 0x00};
+    // Block length past the end of the payload
+    BYTE truncatedBlock[] = {0xef, 0x0f, 0x00, 0x08, 0x6f, 0xaa, 0xbb};
+    // No primary block header
+    BYTE missingPrimary[] = {0xef, 0x0f, 0x00, 0x00, 0xef, 0x0f, 0x00, 0x00};
+    RedBlock blocks[RED_MAX_BLOCKS];
+    UINT32 blockCount;
+
+    blockCount = ARRAY_SIZE(blocks);
+    EXPECT_EQ(STATUS_SUCCESS, parseRedPayload(primaryOnly, SIZEOF(primaryOnly), blocks, &blockCount));
+    ASSERT_EQ(1, blockCount);
+    EXPECT_EQ(111, blocks[0].payloadType);
+    EXPECT_EQ(3, blocks[0].length);
+    EXPECT_EQ(primaryOnly + 1, blocks[0].pData);
+
+    blockCount = ARRAY_SIZE(blocks);
+    EXPECT_EQ(STATUS_SUCCESS, parseRedPayload(valid, SIZEOF(valid), blocks, &blockCount));
+    ASSERT_EQ(2, blockCount);
+    EXPECT_EQ(960, blocks[0].timestampOffset);
+    EXPECT_EQ(2, blocks[0].length);
+    EXPECT_EQ(valid + 5, blocks[0].pData);
+    EXPECT_EQ(1, blocks[1].length);
+    EXPECT_EQ(valid + 7, blocks[1].pData);
+
+    // More blocks than the caller has room for
+    blockCount = 1;
+    EXPECT_EQ(STATUS_RTP_INVALID_RED_PAYLOAD, parseRedPayload(valid, SIZEOF(valid), blocks, &blockCount));
+
+    blockCount = ARRAY_SIZE(blocks);
+    EXPECT_EQ(STATUS_RTP_INVALID_RED_PAYLOAD, parseRedPayload(valid, 0, blocks, &blockCount));
+    EXPECT_EQ(STATUS_RTP_INVALID_RED_PAYLOAD, parseRedPayload(truncatedHeader, SIZEOF(truncatedHeader), blocks, &blockCount));
+    EXPECT_EQ(STATUS_RTP_INVALID_RED_PAYLOAD, parseRedPayload(truncatedBlock, SIZEOF(truncatedBlock), blocks, &blockCount));
+    EXPECT_EQ(STATUS_RTP_INVALID_RED_PAYLOAD, parseRedPayload(missingPrimary, SIZEOF(missingPrimary), blocks, &blockCount));
+    EXPECT_EQ(STATUS_NULL_ARG, parseRedPayload(NULL, 0, blocks, &blockCount));
+}
+
+TEST_F(RtpFunctionalityTest, redDecoderPlacesBlocksByTimestampOffset)
+{
+    RedDecoder redDecoder;
+    RedBlock block;
+    UINT16 sequenceNumber = 0;
+    BOOL placed = TRUE;
+
+    MEMSET(&redDecoder, 0x00, SIZEOF(RedDecoder));
+    MEMSET(&block, 0x00, SIZEOF(RedBlock));
+    block.timestampOffset = 960;
+
+    // No step before two consecutive packets came in, a gap doesn't give one either
+    EXPECT_EQ(STATUS_SUCCESS, redDecoderUpdate(&redDecoder, 65534, 960));
+    EXPECT_EQ(STATUS_SUCCESS, redDecoderGetBlockSequenceNumber(&redDecoder, 65534, &block, &sequenceNumber, &placed));
+    EXPECT_FALSE(placed);
+    EXPECT_EQ(STATUS_SUCCESS, redDecoderUpdate(&redDecoder, 0, 3840));
+    EXPECT_EQ(0, redDecoder.timestampStep);
+
+    // Consecutive packets across the sequence number wrap, an older reordered packet leaves the step alone
+    EXPECT_EQ(STATUS_SUCCESS, redDecoderUpdate(&redDecoder, 1, 4800));
+    EXPECT_EQ(960, redDecoder.timestampStep);
+    EXPECT_EQ(STATUS_SUCCESS, redDecoderUpdate(&redDecoder, 65535, 1920));
+    EXPECT_EQ(960, redDecoder.timestampStep);
+
+    // Blocks a few packets back, the sender may skip some of them
+    EXPECT_EQ(STATUS_SUCCESS, redDecoderGetBlockSequenceNumber(&redDecoder, 1, &block, &sequenceNumber, &placed));
+    EXPECT_TRUE(placed);
+    EXPECT_EQ(0, sequenceNumber);
+    block.timestampOffset = 2880;
+    EXPECT_EQ(STATUS_SUCCESS, redDecoderGetBlockSequenceNumber(&redDecoder, 1, &block, &sequenceNumber, &placed));
+    EXPECT_TRUE(placed);
+    EXPECT_EQ(65534, sequenceNumber);
+
+    // Offsets that aren't whole packets and the primary encoding's own offset have no position
+    block.timestampOffset = 1440;
+    EXPECT_EQ(STATUS_SUCCESS, redDecoderGetBlockSequenceNumber(&redDecoder, 1, &block, &sequenceNumber, &placed));
+    EXPECT_FALSE(placed);
+    block.timestampOffset = 0;
+    EXPECT_EQ(STATUS_SUCCESS, redDecoderGetBlockSequenceNumber(&redDecoder, 1, &block, &sequenceNumber, &placed));
+    EXPECT_FALSE(placed);
+
+    EXPECT_EQ(STATUS_NULL_ARG, redDecoderUpdate(NULL, 0, 0));
+    EXPECT_EQ(STATUS_NULL_ARG, redDecoderGetBlockSequenceNumber(&redDecoder, 1, NULL, &sequenceNumber, &placed));
+}
+
+struct RedReceiver {
+    PJitterBuffer pJitterBuffer;
+    RedDecoder redDecoder;
+    UINT32 deliveredFrames;
+    UINT32 corruptFrames;
+};
+
+static STATUS redFrameReady(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 frameSize)
+{
+    RedReceiver* pReceiver = (RedReceiver*) customData;
+    std::vector<BYTE> frame(frameSize);
+    UINT32 filledSize = 0;
+    UINT64 hashValue = 0;
+
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGet(pReceiver->pJitterBuffer->pPkgBufferHashTable, startIndex, &hashValue));
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferFillFrameData(pReceiver->pJitterBuffer, frame.data(), frameSize, &filledSize, startIndex, endIndex));
+    // Frames are numbered by their timestamp, recovered ones have to match what was sent
+    if (frame != createRedTestOpusFrame(((PRtpPacket) hashValue)->header.timestamp / 960 - 1)) {
+        pReceiver->corruptFrames++;
+    }
+    pReceiver->deliveredFrames++;
+
+    return STATUS_SUCCESS;
+}
+
+static STATUS redFrameDropped(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 timestamp)
+{
+    UNUSED_PARAM(customData);
+    UNUSED_PARAM(startIndex);
+    UNUSED_PARAM(endIndex);
+    UNUSED_PARAM(timestamp);
+    return STATUS_SUCCESS;
+}
+
+TEST_F(RtpFunctionalityTest, redRecoversRandomAndBurstyLoss)
+{
+    // Random loss, and Gilbert-Elliott loss where every packet in the bad state is lost: 5% chance to enter it, 40% to leave
+    // it, for a similar loss rate in bursts of 2.5 packets on average
+    const UINT32 frameCount = 2000, patternCount = 2, depths[] = {0, 1, 2};
+    PRedEncoder pRedEncoder = NULL;
+    PayloadArray payloadArray;
+    RtpPacket rtpPacket;
+    PRtpPacket pRtpPacket;
+    PBYTE pRawPacket;
+    RedReceiver receiver;
+    std::vector<BYTE> frame;
+    std::vector<BOOL> lost;
+    UINT32 i, pattern, depth, seed, packetLength, lostCount, delivered[ARRAY_SIZE(depths)];
+    UINT64 packetsRecovered;
+    BOOL badState;
+
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    for (pattern = 0; pattern < patternCount; pattern++) {
+        // Deterministic linear congruential generator so the run is reproducible. The first packet starts the jitter buffer
+        seed = 12345;
+        badState = FALSE;
+        lost.assign(frameCount, FALSE);
+        lostCount = 0;
+        for (i = 1; i < frameCount; i++) {
+            seed = seed * 1103515245 + 12345;
+            if (pattern == 0) {
+                lost[i] = (DOUBLE) ((seed >> 16) & 0x7FFF) / 0x8000 < 0.1;
+            } else {
+                badState = (DOUBLE) ((seed >> 16) & 0x7FFF) / 0x8000 < (badState ? 0.6 : 0.05);
+                lost[i] = badState;
+            }
+            lostCount += lost[i] ? 1 : 0;
+        }
+
+        for (depth = 0; depth < ARRAY_SIZE(depths); depth++) {
+            receiver.deliveredFrames = receiver.corruptFrames = 0;
+            MEMSET(&receiver.redDecoder, 0x00, SIZEOF(RedDecoder));
+            packetsRecovered = 0;
+            EXPECT_EQ(STATUS_SUCCESS,
+                      createJitterBuffer(redFrameReady, redFrameDropped, depayOpusFromRtpPayload, DEFAULT_JITTER_BUFFER_MAX_LATENCY, OPUS_CLOCKRATE,
+                                         (UINT64) &receiver, &receiver.pJitterBuffer));
+            if (depths[depth] > 0) {
+                EXPECT_EQ(STATUS_SUCCESS, createRedEncoder(depths[depth], &pRedEncoder));
+            }
+
+            for (i = 0; i < frameCount; i++) {
+                frame = createRedTestOpusFrame(i);
+                EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForOpus(DEFAULT_MTU_SIZE, frame.data(), (UINT32) frame.size(), &payloadArray));
+                if (pRedEncoder != NULL) {
+                    EXPECT_EQ(STATUS_SUCCESS,
+                              redEncoderWrapPayloadArray(pRedEncoder, DEFAULT_PAYLOAD_OPUS, 960 * (i + 1), DEFAULT_MTU_SIZE, &payloadArray));
+                }
+                EXPECT_EQ(STATUS_SUCCESS,
+                          constructRtpPackets(&payloadArray, pRedEncoder != NULL ? DEFAULT_PAYLOAD_RED : DEFAULT_PAYLOAD_OPUS, (UINT16) (65000 + i),
+                                              960 * (i + 1), 0x1234, &rtpPacket, 1));
+                if (lost[i]) {
+                    continue;
+                }
+
+                // Same path as sendPacketToRtpReceiver: the raw packet is parsed, unwrapped and handed to the jitter buffer
+                packetLength = RTP_GET_RAW_PACKET_SIZE(&rtpPacket);
+                pRawPacket = (PBYTE) MEMALLOC(packetLength);
+                EXPECT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(&rtpPacket, pRawPacket, &packetLength));
+                EXPECT_EQ(STATUS_SUCCESS, createRtpPacketFromBytes(pRawPacket, packetLength, &pRtpPacket));
+                if (pRtpPacket->header.payloadType == DEFAULT_PAYLOAD_RED) {
+                    EXPECT_EQ(STATUS_SUCCESS, unwrapRedPacket(receiver.pJitterBuffer, &receiver.redDecoder, pRtpPacket, &packetsRecovered));
+                }
+                EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(receiver.pJitterBuffer, pRtpPacket, NULL));
+            }
+            EXPECT_EQ(STATUS_SUCCESS, freeJitterBuffer(&receiver.pJitterBuffer));
+            EXPECT_EQ(STATUS_SUCCESS, freeRedEncoder(&pRedEncoder));
+
+            EXPECT_EQ(0, receiver.corruptFrames);
+            EXPECT_LE(packetsRecovered, lostCount);
+            delivered[depth] = receiver.deliveredFrames;
+        }
+
+        // Without RED every lost packet is a lost frame. A single level of redundancy recovers nearly all random losses, bursts
+        // need a deeper history
+        EXPECT_LE(delivered[0], frameCount - lostCount);
+        EXPECT_GT(delivered[1], delivered[0]);
+        EXPECT_GT(delivered[2], delivered[1]);
+        if (pattern == 0) {
+            EXPECT_GE(delivered[1] * 100, frameCount * 97);
+            EXPECT_GE(delivered[2] * 100, frameCount * 99);
+        } else {
+            EXPECT_GE(delivered[2] * 100, frameCount * 94);
+        }
+    }
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
@@ -84,6 +84,8 @@ a=msid-semantic: WMS f327e13b-3518-47fc-8b53-9cf74d22d03e
 
         EXPECT_STREQ(sessionDescription.sdpAttributes[2].attributeName, "msid-semantic");
         EXPECT_STREQ(sessionDescription.sdpAttributes[2].attributeValue, " WMS f327e13b-3518-47fc-8b53-9cf74d22d03e");
+
+        EXPECT_EQ(resetSessionDescription(&sessionDescription), STATUS_SUCCESS);
     });
 }
 
@@ -120,6 +122,8 @@ a=candidate:842163049 1 udp 1677729535 54.240.196.188 15632 typ srflx raddr 10.1
         EXPECT_EQ(sessionDescription.mediaDescriptions[1].mediaAttributesCount, 2);
         EXPECT_STREQ(sessionDescription.mediaDescriptions[1].sdpAttributes[0].attributeName, "ssrc");
         EXPECT_STREQ(sessionDescription.mediaDescriptions[1].sdpAttributes[0].attributeValue, "45567500 cname:AZdzrek14WN2tYrw");
+
+        EXPECT_EQ(resetSessionDescription(&sessionDescription), STATUS_SUCCESS);
     });
 }
 
@@ -128,25 +132,22 @@ auto populate_session_description = [](PSessionDescription pSessionDescription)
 
     pSessionDescription->version = 2;
 
-    STRCPY(pSessionDescription->sdpOrigin.userName, "-");
+    pSessionDescription->sdpOrigin.userName = (PCHAR) "-";
     pSessionDescription->sdpOrigin.sessionId = 1904080082932320671;
     pSessionDescription->sdpOrigin.sessionVersion = 2;
-    STRCPY(pSessionDescription->sdpOrigin.sdpConnectionInformation.networkType, "IN");
-    STRCPY(pSessionDescription->sdpOrigin.sdpConnectionInformation.addressType, "IP4");
-    STRCPY(pSessionDescription->sdpOrigin.sdpConnectionInformation.connectionAddress, "127.0.0.1");
+    pSessionDescription->sdpOrigin.sdpConnectionInformation.networkType = (PCHAR) "IN";
+    pSessionDescription->sdpOrigin.sdpConnectionInformation.addressType = (PCHAR) "IP4";
+    pSessionDescription->sdpOrigin.sdpConnectionInformation.connectionAddress = (PCHAR) "127.0.0.1";
 
-    STRCPY(pSessionDescription->sessionName, "-");
+    pSessionDescription->sessionName = (PCHAR) "-";
 
     pSessionDescription->timeDescriptionCount = 1;
     pSessionDescription->sdpTimeDescription[0].startTime = 0;
     pSessionDescription->sdpTimeDescription[0].stopTime = 0;
 
-    pSessionDescription->sessionAttributesCount = 2;
-    STRCPY(pSessionDescription->sdpAttributes[0].attributeName, "group");
-    STRCPY(pSessionDescription->sdpAttributes[0].attributeValue, "BUNDLE 0 1");
-
-    STRCPY(pSessionDescription->sdpAttributes[1].attributeName, "msid-semantic");
-    STRCPY(pSessionDescription->sdpAttributes[1].attributeValue, " WMS f327e13b-3518-47fc-8b53-9cf74d22d03e");
+    EXPECT_EQ(sdpAddSessionAttribute(pSessionDescription, (PCHAR) "group", (PCHAR) "BUNDLE 0 1"), STATUS_SUCCESS);
+    EXPECT_EQ(sdpAddSessionAttribute(pSessionDescription, (PCHAR) "msid-semantic", (PCHAR) " WMS f327e13b-3518-47fc-8b53-9cf74d22d03e"),
+              STATUS_SUCCESS);
 };
 
 TEST_F(SdpApiTest, serializeSessionDescription_NoMedia)
@@ -175,6 +176,8 @@ a=msid-semantic: WMS f327e13b-3518-47fc-8b53-9cf74d22d03e
 
     EXPECT_EQ(serializeSessionDescription(&sessionDescription, buff.get(), &buff_len), STATUS_SUCCESS);
     EXPECT_STREQ(buff.get(), (PCHAR)(lfToCRLF(sessionDescriptionNoMedia, ARRAY_SIZE(sessionDescriptionNoMedia) - 1).c_str()));
+
+    EXPECT_EQ(resetSessionDescription(&sessionDescription), STATUS_SUCCESS);
 }
 
 TEST_F(SdpApiTest, serializeSessionDescription_Media)
@@ -200,18 +203,15 @@ a=ssrc:45567500 cname:AZdzrek14WN2tYrw
 
     sessionDescription.mediaCount = 2;
 
-    STRCPY(sessionDescription.mediaDescriptions[0].mediaName, "audio 3554 UDP/TLS/RTP/SAVPF 111 103 9 102 0 8 105 13 110 113 126");
-    sessionDescription.mediaDescriptions[0].mediaAttributesCount = 1;
-
-    STRCPY(sessionDescription.mediaDescriptions[0].sdpAttributes[0].attributeName, "candidate");
-    STRCPY(sessionDescription.mediaDescriptions[0].sdpAttributes[0].attributeValue,
-           "1682923840 1 udp 2113937151 10.111.144.78 63135 typ host generation 0 network-cost 999");
-
-    STRCPY(sessionDescription.mediaDescriptions[1].mediaName, "video 15632 UDP/TLS/RTP/SAVPF 96 97 98 99 100 101 127 125 104");
-    sessionDescription.mediaDescriptions[1].mediaAttributesCount = 1;
+    sessionDescription.mediaDescriptions[0].mediaName = (PCHAR) "audio 3554 UDP/TLS/RTP/SAVPF 111 103 9 102 0 8 105 13 110 113 126";
+    EXPECT_EQ(sdpAddMediaAttribute(&sessionDescription, &sessionDescription.mediaDescriptions[0], (PCHAR) "candidate", (PCHAR) "%u %s", 1682923840,
+                                   "1 udp 2113937151 10.111.144.78 63135 typ host generation 0 network-cost 999"),
+              STATUS_SUCCESS);
 
-    STRCPY(sessionDescription.mediaDescriptions[1].sdpAttributes[0].attributeName, "ssrc");
-    STRCPY(sessionDescription.mediaDescriptions[1].sdpAttributes[0].attributeValue, "45567500 cname:AZdzrek14WN2tYrw");
+    sessionDescription.mediaDescriptions[1].mediaName = (PCHAR) "video 15632 UDP/TLS/RTP/SAVPF 96 97 98 99 100 101 127 125 104";
+    EXPECT_EQ(sdpAddMediaAttribute(&sessionDescription, &sessionDescription.mediaDescriptions[1], (PCHAR) "ssrc", (PCHAR) "45567500 cname:%s",
+                                   "AZdzrek14WN2tYrw"),
+              STATUS_SUCCESS);
 
     EXPECT_EQ(serializeSessionDescription(&sessionDescription, NULL, &buff_len), STATUS_SUCCESS);
     EXPECT_EQ(buff_len, expectedLen);
@@ -222,6 +222,8 @@ a=ssrc:45567500 cname:AZdzrek14WN2tYrw
 
     EXPECT_EQ(serializeSessionDescription(&sessionDescription, buff.get(), &buff_len), STATUS_SUCCESS);
     EXPECT_STREQ(buff.get(), (PCHAR) lfToCRLF(sessionDescriptionNoMedia, ARRAY_SIZE(sessionDescriptionNoMedia) - 1).c_str());
+
+    EXPECT_EQ(resetSessionDescription(&sessionDescription), STATUS_SUCCESS);
 }
 
 TEST_F(SdpApiTest, serializeSessionDescription_AttributeOverflow)
@@ -240,6 +242,94 @@ t=0 0
     MEMSET(&sessionDescription, 0x00, SIZEOF(SessionDescription));
     auto converted = lfToCRLF((PCHAR) sessionDescriptionNoMedia.c_str(), sessionDescriptionNoMedia.size());
     EXPECT_EQ(deserializeSessionDescription(&sessionDescription, (PCHAR) converted.c_str()), STATUS_SDP_ATTRIBUTE_MAX_EXCEEDED);
+    EXPECT_EQ(resetSessionDescription(&sessionDescription), STATUS_SUCCESS);
+}
+
+TEST_F(SdpApiTest, deserializeSessionDescription_RoundTrip)
+{
+    CHAR sessionDescriptionText[] = R"(v=0
+s=-
+a=group:BUNDLE 0 1
+a=msid-semantic: WMS f327e13b-3518-47fc-8b53-9cf74d22d03e
+m=audio 3554 UDP/TLS/RTP/SAVPF 111 103 9 102 0 8 105 13 110 113 126
+a=rtcp-mux
+a=candidate:1682923840 1 udp 2113937151 10.111.144.78 63135 typ host generation 0 network-cost 999
+m=video 15632 UDP/TLS/RTP/SAVPF 96 97 98 99 100 101 127 125 104
+a=ssrc:45567500 cname:AZdzrek14WN2tYrw
+)";
+
+    SessionDescription sessionDescription;
+    UINT32 buffLen = 0;
+    auto converted = lfToCRLF(sessionDescriptionText, ARRAY_SIZE(sessionDescriptionText) - 1);
+
+    MEMSET(&sessionDescription, 0x00, SIZEOF(SessionDescription));
+    EXPECT_EQ(deserializeSessionDescription(&sessionDescription, (PCHAR) converted.c_str()), STATUS_SUCCESS);
+
+    // Fields are slices of the copy kept by the description, the caller's text can go away
+    std::fill(converted.begin(), converted.end(), 'x');
+    EXPECT_STREQ(sessionDescription.sdpAttributes[0].attributeValue, "BUNDLE 0 1");
+    EXPECT_STREQ(sessionDescription.mediaDescriptions[0].sdpAttributes[0].attributeName, "rtcp-mux");
+    EXPECT_STREQ(sessionDescription.mediaDescriptions[0].sdpAttributes[0].attributeValue, "");
+    EXPECT_STREQ(sessionDescription.mediaDescriptions[1].mediaName, "video 15632 UDP/TLS/RTP/SAVPF 96 97 98 99 100 101 127 125 104");
+
+    EXPECT_EQ(serializeSessionDescription(&sessionDescription, NULL, &buffLen), STATUS_SUCCESS);
+    std::unique_ptr<CHAR[]> buff(new CHAR[buffLen]);
+    EXPECT_EQ(serializeSessionDescription(&sessionDescription, buff.get(), &buffLen), STATUS_SUCCESS);
+    EXPECT_STREQ(buff.get(), lfToCRLF(sessionDescriptionText, ARRAY_SIZE(sessionDescriptionText) - 1).c_str());
+
+    EXPECT_EQ(resetSessionDescription(&sessionDescription), STATUS_SUCCESS);
+    EXPECT_EQ(sessionDescription.pArena, (PSdpArenaBlock) NULL);
+    EXPECT_EQ(sessionDescription.mediaCount, 0);
+}
+
+TEST_F(SdpApiTest, deserializeSessionDescription_LongAttributeValueTruncated)
+{
+    std::string sessionDescriptionText = "v=0\r\no=- 1 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=fingerprint:";
+    SessionDescription sessionDescription;
+
+    sessionDescriptionText += std::string(MAX_SDP_ATTRIBUTE_VALUE_LENGTH * 2, 'A') + "\r\n";
+
+    MEMSET(&sessionDescription, 0x00, SIZEOF(SessionDescription));
+    EXPECT_EQ(deserializeSessionDescription(&sessionDescription, (PCHAR) sessionDescriptionText.c_str()), STATUS_SUCCESS);
+    EXPECT_EQ(sessionDescription.sessionAttributesCount, 1);
+    EXPECT_STREQ(sessionDescription.sdpAttributes[0].attributeName, "fingerprint");
+    EXPECT_EQ(STRLEN(sessionDescription.sdpAttributes[0].attributeValue), MAX_SDP_ATTRIBUTE_VALUE_LENGTH);
+
+    EXPECT_EQ(resetSessionDescription(&sessionDescription), STATUS_SUCCESS);
+}
+
+TEST_F(SdpApiTest, sdpAddMediaAttribute_FormatsIntoArena)
+{
+    SessionDescription sessionDescription;
+    PSdpMediaDescription pSdpMediaDescription = &sessionDescription.mediaDescriptions[0];
+    std::string longValue(SDP_ARENA_BLOCK_SIZE * 2, 'B');
+    UINT32 i;
+
+    MEMSET(&sessionDescription, 0x00, SIZEOF(SessionDescription));
+    EXPECT_EQ(sdpAddMediaAttribute(NULL, pSdpMediaDescription, (PCHAR) "mid", (PCHAR) "%d", 0), STATUS_NULL_ARG);
+    EXPECT_EQ(sdpAddMediaAttribute(&sessionDescription, NULL, (PCHAR) "mid", (PCHAR) "%d", 0), STATUS_NULL_ARG);
+
+    EXPECT_EQ(sdpAddMediaAttribute(&sessionDescription, pSdpMediaDescription, (PCHAR) "rtpmap", (PCHAR) "%u opus/48000/2", 111), STATUS_SUCCESS);
+    EXPECT_EQ(sdpAddMediaAttribute(&sessionDescription, pSdpMediaDescription, (PCHAR) "rtcp-mux", NULL), STATUS_SUCCESS);
+    // Bigger than a block, gets a block of its own without retiring the current one
+    EXPECT_EQ(sdpAddMediaAttribute(&sessionDescription, pSdpMediaDescription, (PCHAR) "long", (PCHAR) "%s", longValue.c_str()), STATUS_SUCCESS);
+    EXPECT_EQ(sdpAddMediaAttribute(&sessionDescription, pSdpMediaDescription, (PCHAR) "mid", (PCHAR) "%d", 1), STATUS_SUCCESS);
+
+    EXPECT_EQ(pSdpMediaDescription->mediaAttributesCount, 4);
+    EXPECT_STREQ(pSdpMediaDescription->sdpAttributes[0].attributeValue, "111 opus/48000/2");
+    EXPECT_STREQ(pSdpMediaDescription->sdpAttributes[1].attributeValue, "");
+    EXPECT_STREQ(pSdpMediaDescription->sdpAttributes[2].attributeValue, longValue.c_str());
+    EXPECT_STREQ(pSdpMediaDescription->sdpAttributes[3].attributeValue, "1");
+    EXPECT_EQ(pSdpMediaDescription->sdpAttributes[3].attributeValue,
+              pSdpMediaDescription->sdpAttributes[0].attributeValue + STRLEN("111 opus/48000/2") + 1);
+
+    for (i = pSdpMediaDescription->mediaAttributesCount; i < MAX_SDP_ATTRIBUTES_COUNT; i++) {
+        EXPECT_EQ(sdpAddMediaAttribute(&sessionDescription, pSdpMediaDescription, (PCHAR) "b", NULL), STATUS_SUCCESS);
+    }
+    EXPECT_EQ(sdpAddMediaAttribute(&sessionDescription, pSdpMediaDescription, (PCHAR) "b", NULL), STATUS_SDP_ATTRIBUTE_MAX_EXCEEDED);
+    EXPECT_EQ(pSdpMediaDescription->mediaAttributesCount, MAX_SDP_ATTRIBUTES_COUNT);
+
+    EXPECT_EQ(resetSessionDescription(&sessionDescription), STATUS_SUCCESS);
 }
 
 TEST_F(SdpApiTest, setTransceiverPayloadTypes_NoRtxType)
@@ -589,6 +679,7 @@ a=group:BUNDLE 0 1 2 3
         MEMSET(&sessionDescription, 0x00, SIZEOF(SessionDescription));
         // as log as Sdp.h  MAX_SDP_SESSION_MEDIA_COUNT 5 this should fail instead of overwriting memory
         EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, deserializeSessionDescription(&sessionDescription, (PCHAR) sdp));
+        EXPECT_EQ(resetSessionDescription(&sessionDescription), STATUS_SUCCESS);
     });
 }
 
@@ -937,6 +1028,7 @@ TEST_F(SdpApiTest, twccExtension)
         }
     }
     EXPECT_EQ(4, extid);
+    EXPECT_EQ(STATUS_SUCCESS, resetSessionDescription(&sd));
 }
 
 TEST_F(SdpApiTest, populateSingleMediaSection_TestPayloadFmtp)
@@ -1029,6 +1121,453 @@ TEST_F(SdpApiTest, getH264FmtpScore)
     EXPECT_EQ(1, getScore("packetization-mode=1;profile-level-id=640032"));
 }
 
+TEST_F(SdpApiTest, getH265FmtpScore)
+{
+    auto getScore = [](const CHAR* fmtp) { return getH265FmtpScore(const_cast<PCHAR>(fmtp)); };
+    // Absent parameters take the RFC 7798 defaults, which are a perfect match.
+    EXPECT_EQ(3, getScore(NULL));
+    EXPECT_EQ(3, getScore("level-id=93;profile-id=1;tier-flag=0;tx-mode=SRST"));
+    EXPECT_EQ(3, getScore("profile-id=1"));
+
+    // Higher levels are fine, a lower level or max-recv-level-id alone doesn't change the level-id match.
+    EXPECT_EQ(3, getScore("level-id=153;profile-id=1"));
+    EXPECT_EQ(2, getScore("level-id=90;profile-id=1"));
+    EXPECT_EQ(2, getScore("max-recv-level-id=153;level-id=60"));
+
+    // Main 10 profile or high tier.
+    EXPECT_EQ(2, getScore("level-id=93;profile-id=2;tier-flag=0"));
+    EXPECT_EQ(2, getScore("level-id=93;profile-id=1;tier-flag=1"));
+
+    // Multi stream transmission and DONL fields are not supported.
+    EXPECT_EQ(0, getScore("level-id=93;profile-id=1;tx-mode=MSST"));
+    EXPECT_EQ(0, getScore("profile-id=1;sprop-max-don-diff=2"));
+    EXPECT_EQ(3, getScore("profile-id=1;sprop-max-don-diff=0"));
+}
+
+TEST_F(SdpApiTest, populateSingleMediaSection_TestH265PayloadFmtp)
+{
+    CHAR remoteSessionDescription[] = R"(v=0
+o=- 7732334361409071710 2 IN IP4 127.0.0.1
+s=-
+t=0 0
+a=group:BUNDLE 0
+a=msid-semantic: WMS
+m=video 16485 UDP/TLS/RTP/SAVPF 96 100 98
+c=IN IP4 205.251.233.176
+a=rtcp:9 IN IP4 0.0.0.0
+a=ice-ufrag:9YRc
+a=ice-pwd:/ELMEiczRSsx2OEi2ynq+TbZ
+a=ice-options:trickle
+a=fingerprint:sha-256 51:04:F9:20:45:5C:9D:85:AF:D7:AF:FB:2B:F8:DB:24:66:7B:6A:E3:E3:EF:EC:72:93:6E:01:B8:C9:53:A6:31
+a=setup:actpass
+a=mid:1
+a=recvonly
+a=rtcp-mux
+a=rtcp-rsize
+a=rtpmap:96 VP8/90000
+a=rtpmap:100 H265/90000
+a=fmtp:100 level-id=120;profile-id=1;tier-flag=0;tx-mode=SRST
+a=rtpmap:98 H265/90000
+a=fmtp:98 level-id=120;profile-id=1;tier-flag=0;tx-mode=MSST
+)";
+
+    assertLFAndCRLF(remoteSessionDescription, ARRAY_SIZE(remoteSessionDescription) - 1, [](PCHAR sdp) {
+        PRtcPeerConnection pRtcPeerConnection = NULL;
+        PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+        RtcConfiguration rtcConfiguration;
+        RtcMediaStreamTrack rtcMediaStreamTrack;
+        RtcRtpTransceiverInit rtcRtpTransceiverInit;
+        RtcSessionDescriptionInit rtcSessionDescriptionInit;
+
+        MEMSET(&rtcConfiguration, 0x00, SIZEOF(RtcConfiguration));
+        MEMSET(&rtcMediaStreamTrack, 0x00, SIZEOF(RtcMediaStreamTrack));
+        MEMSET(&rtcSessionDescriptionInit, 0x00, SIZEOF(RtcSessionDescriptionInit));
+
+        EXPECT_EQ(createPeerConnection(&rtcConfiguration, &pRtcPeerConnection), STATUS_SUCCESS);
+        EXPECT_EQ(addSupportedCodec(pRtcPeerConnection, RTC_CODEC_H265), STATUS_SUCCESS);
+
+        rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY;
+        rtcMediaStreamTrack.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+        rtcMediaStreamTrack.codec = RTC_CODEC_H265;
+        STRCPY(rtcMediaStreamTrack.streamId, "myKvsVideoStream");
+        STRCPY(rtcMediaStreamTrack.trackId, "myTrack");
+        EXPECT_EQ(addTransceiver(pRtcPeerConnection, &rtcMediaStreamTrack, &rtcRtpTransceiverInit, &pRtcRtpTransceiver), STATUS_SUCCESS);
+
+        STRCPY(rtcSessionDescriptionInit.sdp, (PCHAR) sdp);
+        rtcSessionDescriptionInit.type = SDP_TYPE_OFFER;
+        EXPECT_EQ(setRemoteDescription(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+        EXPECT_EQ(createAnswer(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+        EXPECT_PRED_FORMAT2(testing::IsSubstring, "rtpmap:100 H265/90000", rtcSessionDescriptionInit.sdp);
+        EXPECT_PRED_FORMAT2(testing::IsSubstring, "fmtp:100 level-id=120;profile-id=1;tier-flag=0;tx-mode=SRST", rtcSessionDescriptionInit.sdp);
+        EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "rtpmap:98 H265/90000", rtcSessionDescriptionInit.sdp);
+        closePeerConnection(pRtcPeerConnection);
+        freePeerConnection(&pRtcPeerConnection);
+    });
+}
+
+TEST_F(SdpApiTest, populateSingleMediaSection_TestH265IncompatibleFmtpNotSelected)
+{
+    CHAR remoteSessionDescription[] = R"(v=0
+o=- 7732334361409071710 2 IN IP4 127.0.0.1
+s=-
+t=0 0
+a=group:BUNDLE 0
+a=msid-semantic: WMS
+m=video 16485 UDP/TLS/RTP/SAVPF 98 99
+c=IN IP4 205.251.233.176
+a=rtcp:9 IN IP4 0.0.0.0
+a=ice-ufrag:9YRc
+a=ice-pwd:/ELMEiczRSsx2OEi2ynq+TbZ
+a=ice-options:trickle
+a=fingerprint:sha-256 51:04:F9:20:45:5C:9D:85:AF:D7:AF:FB:2B:F8:DB:24:66:7B:6A:E3:E3:EF:EC:72:93:6E:01:B8:C9:53:A6:31
+a=setup:actpass
+a=mid:1
+a=recvonly
+a=rtcp-mux
+a=rtcp-rsize
+a=rtpmap:98 H265/90000
+a=fmtp:98 level-id=120;profile-id=1;tier-flag=0;tx-mode=MSST
+a=rtpmap:99 H265/90000
+a=fmtp:99 level-id=120;profile-id=1;tier-flag=0;sprop-max-don-diff=2
+)";
+
+    assertLFAndCRLF(remoteSessionDescription, ARRAY_SIZE(remoteSessionDescription) - 1, [](PCHAR sdp) {
+        PRtcPeerConnection pRtcPeerConnection = NULL;
+        PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+        RtcConfiguration rtcConfiguration;
+        RtcMediaStreamTrack rtcMediaStreamTrack;
+        RtcRtpTransceiverInit rtcRtpTransceiverInit;
+        RtcSessionDescriptionInit rtcSessionDescriptionInit;
+
+        MEMSET(&rtcConfiguration, 0x00, SIZEOF(RtcConfiguration));
+        MEMSET(&rtcMediaStreamTrack, 0x00, SIZEOF(RtcMediaStreamTrack));
+        MEMSET(&rtcSessionDescriptionInit, 0x00, SIZEOF(RtcSessionDescriptionInit));
+
+        EXPECT_EQ(createPeerConnection(&rtcConfiguration, &pRtcPeerConnection), STATUS_SUCCESS);
+        EXPECT_EQ(addSupportedCodec(pRtcPeerConnection, RTC_CODEC_H265), STATUS_SUCCESS);
+
+        rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY;
+        rtcMediaStreamTrack.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+        rtcMediaStreamTrack.codec = RTC_CODEC_H265;
+        STRCPY(rtcMediaStreamTrack.streamId, "myKvsVideoStream");
+        STRCPY(rtcMediaStreamTrack.trackId, "myTrack");
+        EXPECT_EQ(addTransceiver(pRtcPeerConnection, &rtcMediaStreamTrack, &rtcRtpTransceiverInit, &pRtcRtpTransceiver), STATUS_SUCCESS);
+
+        // Neither multi stream transmission nor DONL can be depayloaded, so neither payload type is answered
+        STRCPY(rtcSessionDescriptionInit.sdp, (PCHAR) sdp);
+        rtcSessionDescriptionInit.type = SDP_TYPE_OFFER;
+        EXPECT_EQ(setRemoteDescription(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+        EXPECT_EQ(createAnswer(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+        EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "rtpmap:98 H265/90000", rtcSessionDescriptionInit.sdp);
+        EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "rtpmap:99 H265/90000", rtcSessionDescriptionInit.sdp);
+        EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "tx-mode=MSST", rtcSessionDescriptionInit.sdp);
+        EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "sprop-max-don-diff=2", rtcSessionDescriptionInit.sdp);
+        closePeerConnection(pRtcPeerConnection);
+        freePeerConnection(&pRtcPeerConnection);
+    });
+}
+
+TEST_F(SdpApiTest, populateSingleMediaSection_TestAV1PayloadFmtp)
+{
+    CHAR remoteSessionDescription[] = R"(v=0
+o=- 7732334361409071710 2 IN IP4 127.0.0.1
+s=-
+t=0 0
+a=group:BUNDLE 0
+a=msid-semantic: WMS
+m=video 16485 UDP/TLS/RTP/SAVPF 96 97 45 46
+c=IN IP4 205.251.233.176
+a=rtcp:9 IN IP4 0.0.0.0
+a=ice-ufrag:9YRc
+a=ice-pwd:/ELMEiczRSsx2OEi2ynq+TbZ
+a=ice-options:trickle
+a=fingerprint:sha-256 51:04:F9:20:45:5C:9D:85:AF:D7:AF:FB:2B:F8:DB:24:66:7B:6A:E3:E3:EF:EC:72:93:6E:01:B8:C9:53:A6:31
+a=setup:actpass
+a=mid:1
+a=recvonly
+a=rtcp-mux
+a=rtcp-rsize
+a=rtpmap:96 VP8/90000
+a=rtpmap:97 rtx/90000
+a=fmtp:97 apt=96
+a=rtpmap:45 AV1/90000
+a=rtcp-fb:45 nack
+a=fmtp:45 level-idx=5;profile=0;tier=0
+a=rtpmap:46 rtx/90000
+a=fmtp:46 apt=45
+)";
+
+    assertLFAndCRLF(remoteSessionDescription, ARRAY_SIZE(remoteSessionDescription) - 1, [](PCHAR sdp) {
+        PRtcPeerConnection pRtcPeerConnection = NULL;
+        PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+        RtcConfiguration rtcConfiguration;
+        RtcMediaStreamTrack rtcMediaStreamTrack;
+        RtcRtpTransceiverInit rtcRtpTransceiverInit;
+        RtcSessionDescriptionInit rtcSessionDescriptionInit;
+
+        MEMSET(&rtcConfiguration, 0x00, SIZEOF(RtcConfiguration));
+        MEMSET(&rtcMediaStreamTrack, 0x00, SIZEOF(RtcMediaStreamTrack));
+        MEMSET(&rtcSessionDescriptionInit, 0x00, SIZEOF(RtcSessionDescriptionInit));
+
+        EXPECT_EQ(createPeerConnection(&rtcConfiguration, &pRtcPeerConnection), STATUS_SUCCESS);
+        EXPECT_EQ(addSupportedCodec(pRtcPeerConnection, RTC_CODEC_AV1), STATUS_SUCCESS);
+
+        rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY;
+        rtcMediaStreamTrack.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+        rtcMediaStreamTrack.codec = RTC_CODEC_AV1;
+        STRCPY(rtcMediaStreamTrack.streamId, "myKvsVideoStream");
+        STRCPY(rtcMediaStreamTrack.trackId, "myTrack");
+        EXPECT_EQ(addTransceiver(pRtcPeerConnection, &rtcMediaStreamTrack, &rtcRtpTransceiverInit, &pRtcRtpTransceiver), STATUS_SUCCESS);
+
+        STRCPY(rtcSessionDescriptionInit.sdp, (PCHAR) sdp);
+        rtcSessionDescriptionInit.type = SDP_TYPE_OFFER;
+        EXPECT_EQ(setRemoteDescription(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+        EXPECT_EQ(createAnswer(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+        EXPECT_PRED_FORMAT2(testing::IsSubstring, "rtpmap:45 AV1/90000", rtcSessionDescriptionInit.sdp);
+        EXPECT_PRED_FORMAT2(testing::IsSubstring, "fmtp:45 level-idx=5;profile=0;tier=0", rtcSessionDescriptionInit.sdp);
+        EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "VP8/90000", rtcSessionDescriptionInit.sdp);
+        closePeerConnection(pRtcPeerConnection);
+        freePeerConnection(&pRtcPeerConnection);
+    });
+}
+
+TEST_F(SdpApiTest, getVP9FmtpScore)
+{
+    auto getScore = [](const CHAR* fmtp) { return getVP9FmtpScore(const_cast<PCHAR>(fmtp)); };
+    // Profile 0 is the RFC 9628 default and the only one the payloader is negotiated for.
+    EXPECT_EQ(1, getScore(NULL));
+    EXPECT_EQ(1, getScore("profile-id=0"));
+    EXPECT_EQ(0, getScore("profile-id=1"));
+    EXPECT_EQ(0, getScore("profile-id=2"));
+}
+
+TEST_F(SdpApiTest, populateSingleMediaSection_TestVP9PayloadFmtp)
+{
+    CHAR remoteSessionDescription[] = R"(v=0
+o=- 7732334361409071710 2 IN IP4 127.0.0.1
+s=-
+t=0 0
+a=group:BUNDLE 0
+a=msid-semantic: WMS
+m=video 16485 UDP/TLS/RTP/SAVPF 96 98 100 101
+c=IN IP4 205.251.233.176
+a=rtcp:9 IN IP4 0.0.0.0
+a=ice-ufrag:9YRc
+a=ice-pwd:/ELMEiczRSsx2OEi2ynq+TbZ
+a=ice-options:trickle
+a=fingerprint:sha-256 51:04:F9:20:45:5C:9D:85:AF:D7:AF:FB:2B:F8:DB:24:66:7B:6A:E3:E3:EF:EC:72:93:6E:01:B8:C9:53:A6:31
+a=setup:actpass
+a=mid:1
+a=recvonly
+a=rtcp-mux
+a=rtcp-rsize
+a=rtpmap:96 VP8/90000
+a=rtpmap:97 rtx/90000
+a=fmtp:97 apt=96
+a=rtpmap:98 VP9/90000
+a=rtcp-fb:98 nack
+a=fmtp:98 profile-id=0
+a=rtpmap:100 VP9/90000
+a=rtcp-fb:100 nack
+a=fmtp:100 profile-id=2
+a=rtpmap:101 rtx/90000
+a=fmtp:101 apt=100
+)";
+
+    assertLFAndCRLF(remoteSessionDescription, ARRAY_SIZE(remoteSessionDescription) - 1, [](PCHAR sdp) {
+        PRtcPeerConnection pRtcPeerConnection = NULL;
+        PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+        RtcConfiguration rtcConfiguration;
+        RtcMediaStreamTrack rtcMediaStreamTrack;
+        RtcRtpTransceiverInit rtcRtpTransceiverInit;
+        RtcSessionDescriptionInit rtcSessionDescriptionInit;
+
+        MEMSET(&rtcConfiguration, 0x00, SIZEOF(RtcConfiguration));
+        MEMSET(&rtcMediaStreamTrack, 0x00, SIZEOF(RtcMediaStreamTrack));
+        MEMSET(&rtcSessionDescriptionInit, 0x00, SIZEOF(RtcSessionDescriptionInit));
+
+        EXPECT_EQ(createPeerConnection(&rtcConfiguration, &pRtcPeerConnection), STATUS_SUCCESS);
+        EXPECT_EQ(addSupportedCodec(pRtcPeerConnection, RTC_CODEC_VP9), STATUS_SUCCESS);
+
+        rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY;
+        rtcMediaStreamTrack.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+        rtcMediaStreamTrack.codec = RTC_CODEC_VP9;
+        STRCPY(rtcMediaStreamTrack.streamId, "myKvsVideoStream");
+        STRCPY(rtcMediaStreamTrack.trackId, "myTrack");
+        EXPECT_EQ(addTransceiver(pRtcPeerConnection, &rtcMediaStreamTrack, &rtcRtpTransceiverInit, &pRtcRtpTransceiver), STATUS_SUCCESS);
+
+        STRCPY(rtcSessionDescriptionInit.sdp, (PCHAR) sdp);
+        rtcSessionDescriptionInit.type = SDP_TYPE_OFFER;
+        EXPECT_EQ(setRemoteDescription(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+        EXPECT_EQ(createAnswer(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+        EXPECT_PRED_FORMAT2(testing::IsSubstring, "rtpmap:98 VP9/90000", rtcSessionDescriptionInit.sdp);
+        EXPECT_PRED_FORMAT2(testing::IsSubstring, "fmtp:98 profile-id=0", rtcSessionDescriptionInit.sdp);
+        EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "rtpmap:100 VP9/90000", rtcSessionDescriptionInit.sdp);
+        EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "VP8/90000", rtcSessionDescriptionInit.sdp);
+        closePeerConnection(pRtcPeerConnection);
+        freePeerConnection(&pRtcPeerConnection);
+    });
+}
+
+TEST_F(SdpApiTest, populateSingleMediaSection_TestFlexFecNegotiation)
+{
+    CHAR remoteSessionDescription[] = R"(v=0
+o=- 7732334361409071710 2 IN IP4 127.0.0.1
+s=-
+t=0 0
+a=group:BUNDLE 0
+a=msid-semantic: WMS myKvsVideoStream
+m=video 16485 UDP/TLS/RTP/SAVPF 125 35
+c=IN IP4 205.251.233.176
+a=rtcp:9 IN IP4 0.0.0.0
+a=ice-ufrag:9YRc
+a=ice-pwd:/ELMEiczRSsx2OEi2ynq+TbZ
+a=ice-options:trickle
+a=fingerprint:sha-256 51:04:F9:20:45:5C:9D:85:AF:D7:AF:FB:2B:F8:DB:24:66:7B:6A:E3:E3:EF:EC:72:93:6E:01:B8:C9:53:A6:31
+a=setup:actpass
+a=mid:0
+a=sendrecv
+a=rtcp-mux
+a=rtcp-rsize
+a=rtpmap:125 H264/90000
+a=fmtp:125 level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f
+a=rtpmap:35 flexfec/90000
+a=fmtp:35 repair-window=200000
+a=ssrc-group:FEC-FR 1234 5678
+a=ssrc:1234 cname:remote
+a=ssrc:5678 cname:remote
+)";
+
+    assertLFAndCRLF(remoteSessionDescription, ARRAY_SIZE(remoteSessionDescription) - 1, [](PCHAR sdp) {
+        PRtcPeerConnection pRtcPeerConnection = NULL;
+        PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+        PKvsRtpTransceiver pKvsRtpTransceiver;
+        RtcConfiguration rtcConfiguration;
+        RtcMediaStreamTrack rtcMediaStreamTrack;
+        RtcRtpTransceiverInit rtcRtpTransceiverInit;
+        RtcSessionDescriptionInit rtcSessionDescriptionInit;
+        BOOL enableFlexFec;
+
+        // The offer's payload type is used in the answer, and FlexFEC stays out of it unless enabled locally
+        for (enableFlexFec = FALSE; enableFlexFec <= TRUE; enableFlexFec++) {
+            MEMSET(&rtcConfiguration, 0x00, SIZEOF(RtcConfiguration));
+            MEMSET(&rtcMediaStreamTrack, 0x00, SIZEOF(RtcMediaStreamTrack));
+            MEMSET(&rtcSessionDescriptionInit, 0x00, SIZEOF(RtcSessionDescriptionInit));
+            rtcConfiguration.kvsRtcConfiguration.enableFlexFec = enableFlexFec;
+
+            EXPECT_EQ(createPeerConnection(&rtcConfiguration, &pRtcPeerConnection), STATUS_SUCCESS);
+            EXPECT_EQ(addSupportedCodec(pRtcPeerConnection, RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE),
+                      STATUS_SUCCESS);
+
+            rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV;
+            rtcMediaStreamTrack.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+            rtcMediaStreamTrack.codec = RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE;
+            STRCPY(rtcMediaStreamTrack.streamId, "myKvsVideoStream");
+            STRCPY(rtcMediaStreamTrack.trackId, "myTrack");
+            EXPECT_EQ(addTransceiver(pRtcPeerConnection, &rtcMediaStreamTrack, &rtcRtpTransceiverInit, &pRtcRtpTransceiver), STATUS_SUCCESS);
+            pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+
+            STRCPY(rtcSessionDescriptionInit.sdp, (PCHAR) sdp);
+            rtcSessionDescriptionInit.type = SDP_TYPE_OFFER;
+            EXPECT_EQ(setRemoteDescription(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+            EXPECT_EQ(createAnswer(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+
+            if (enableFlexFec) {
+                EXPECT_PRED_FORMAT2(testing::IsSubstring, "rtpmap:35 flexfec/90000", rtcSessionDescriptionInit.sdp);
+                EXPECT_PRED_FORMAT2(testing::IsSubstring, "fmtp:35 repair-window=200000", rtcSessionDescriptionInit.sdp);
+                EXPECT_PRED_FORMAT2(testing::IsSubstring, "SAVPF 125 35", rtcSessionDescriptionInit.sdp);
+                EXPECT_PRED_FORMAT2(testing::IsSubstring, "ssrc-group:FEC-FR", rtcSessionDescriptionInit.sdp);
+                EXPECT_NE((PFlexFecEncoder) NULL, pKvsRtpTransceiver->sender.pFlexFecEncoder);
+                EXPECT_NE((PFlexFecDecoder) NULL, pKvsRtpTransceiver->pFlexFecDecoder);
+                EXPECT_EQ(5678, pKvsRtpTransceiver->flexFecSsrc);
+            } else {
+                EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "flexfec", rtcSessionDescriptionInit.sdp);
+                EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "FEC-FR", rtcSessionDescriptionInit.sdp);
+                EXPECT_EQ((PFlexFecEncoder) NULL, pKvsRtpTransceiver->sender.pFlexFecEncoder);
+                EXPECT_EQ((PFlexFecDecoder) NULL, pKvsRtpTransceiver->pFlexFecDecoder);
+            }
+
+            closePeerConnection(pRtcPeerConnection);
+            freePeerConnection(&pRtcPeerConnection);
+        }
+    });
+}
+
+TEST_F(SdpApiTest, populateSingleMediaSection_TestRedNegotiation)
+{
+    CHAR remoteSessionDescription[] = R"(v=0
+o=- 7732334361409071710 2 IN IP4 127.0.0.1
+s=-
+t=0 0
+a=group:BUNDLE 0
+a=msid-semantic: WMS myKvsAudioStream
+m=audio 9 UDP/TLS/RTP/SAVPF 109 62
+c=IN IP4 127.0.0.1
+a=rtcp:9 IN IP4 0.0.0.0
+a=ice-ufrag:9YRc
+a=ice-pwd:/ELMEiczRSsx2OEi2ynq+TbZ
+a=ice-options:trickle
+a=fingerprint:sha-256 51:04:F9:20:45:5C:9D:85:AF:D7:AF:FB:2B:F8:DB:24:66:7B:6A:E3:E3:EF:EC:72:93:6E:01:B8:C9:53:A6:31
+a=setup:actpass
+a=mid:0
+a=sendrecv
+a=rtcp-mux
+a=rtpmap:109 opus/48000/2
+a=fmtp:109 minptime=10;useinbandfec=1
+a=rtpmap:62 red/48000/2
+a=fmtp:62 109/109
+a=ssrc:1234 cname:remote
+)";
+
+    assertLFAndCRLF(remoteSessionDescription, ARRAY_SIZE(remoteSessionDescription) - 1, [](PCHAR sdp) {
+        PRtcPeerConnection pRtcPeerConnection = NULL;
+        PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+        PKvsRtpTransceiver pKvsRtpTransceiver;
+        RtcConfiguration rtcConfiguration;
+        RtcMediaStreamTrack rtcMediaStreamTrack;
+        RtcRtpTransceiverInit rtcRtpTransceiverInit;
+        RtcSessionDescriptionInit rtcSessionDescriptionInit;
+        UINT32 opusRedDepth;
+
+        // The offer's payload type is used in the answer, and RED stays out of it unless enabled locally
+        for (opusRedDepth = 0; opusRedDepth <= 1; opusRedDepth++) {
+            MEMSET(&rtcConfiguration, 0x00, SIZEOF(RtcConfiguration));
+            MEMSET(&rtcMediaStreamTrack, 0x00, SIZEOF(RtcMediaStreamTrack));
+            MEMSET(&rtcSessionDescriptionInit, 0x00, SIZEOF(RtcSessionDescriptionInit));
+            rtcConfiguration.kvsRtcConfiguration.opusRedDepth = opusRedDepth;
+
+            EXPECT_EQ(createPeerConnection(&rtcConfiguration, &pRtcPeerConnection), STATUS_SUCCESS);
+            EXPECT_EQ(addSupportedCodec(pRtcPeerConnection, RTC_CODEC_OPUS), STATUS_SUCCESS);
+
+            rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV;
+            rtcMediaStreamTrack.kind = MEDIA_STREAM_TRACK_KIND_AUDIO;
+            rtcMediaStreamTrack.codec = RTC_CODEC_OPUS;
+            STRCPY(rtcMediaStreamTrack.streamId, "myKvsAudioStream");
+            STRCPY(rtcMediaStreamTrack.trackId, "myTrack");
+            EXPECT_EQ(addTransceiver(pRtcPeerConnection, &rtcMediaStreamTrack, &rtcRtpTransceiverInit, &pRtcRtpTransceiver), STATUS_SUCCESS);
+            pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+
+            STRCPY(rtcSessionDescriptionInit.sdp, (PCHAR) sdp);
+            rtcSessionDescriptionInit.type = SDP_TYPE_OFFER;
+            EXPECT_EQ(setRemoteDescription(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+            EXPECT_EQ(createAnswer(pRtcPeerConnection, &rtcSessionDescriptionInit), STATUS_SUCCESS);
+
+            if (opusRedDepth > 0) {
+                EXPECT_PRED_FORMAT2(testing::IsSubstring, "rtpmap:62 red/48000/2", rtcSessionDescriptionInit.sdp);
+                EXPECT_PRED_FORMAT2(testing::IsSubstring, "fmtp:62 109/109", rtcSessionDescriptionInit.sdp);
+                EXPECT_PRED_FORMAT2(testing::IsSubstring, "SAVPF 109 62", rtcSessionDescriptionInit.sdp);
+                EXPECT_NE((PRedEncoder) NULL, pKvsRtpTransceiver->sender.pRedEncoder);
+            } else {
+                EXPECT_PRED_FORMAT2(testing::IsNotSubstring, "red/48000", rtcSessionDescriptionInit.sdp);
+                EXPECT_EQ((PRedEncoder) NULL, pKvsRtpTransceiver->sender.pRedEncoder);
+            }
+
+            closePeerConnection(pRtcPeerConnection);
+            freePeerConnection(&pRtcPeerConnection);
+        }
+    });
+}
+
 TEST_F(SdpApiTest, populateSingleMediaSection_TestMultipleIceOptions)
 {
     CHAR remoteSessionDescription[] = R"(v=0
@@ -1380,6 +1919,185 @@ a=ssrc:1644235696 cname:{36a6a74c-73a4-594b-9bb0-023b4d357280})";
     });
 }
 
+TEST_F(SdpApiTest, createOffer_RenderedFromTemplateMatchesPopulated)
+{
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PRtcRtpTransceiver pVideoTransceiver = NULL, pAudioTransceiver = NULL;
+    PKvsPeerConnection pKvsPeerConnection;
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PSessionDescription pSessionDescription = NULL;
+    RtcConfiguration rtcConfiguration;
+    RtcMediaStreamTrack track;
+    RtcRtpTransceiverInit rtcRtpTransceiverInit;
+    RtcSessionDescriptionInit offer, populated;
+    SdpTemplateCacheStats before, after;
+    UINT32 serializeLen;
+
+    MEMSET(&rtcConfiguration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&track, 0x00, SIZEOF(RtcMediaStreamTrack));
+    MEMSET(&offer, 0x00, SIZEOF(RtcSessionDescriptionInit));
+    MEMSET(&populated, 0x00, SIZEOF(RtcSessionDescriptionInit));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&rtcConfiguration, &pRtcPeerConnection));
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+
+    rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV;
+    track.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+    track.codec = RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE;
+    STRCPY(track.streamId, "myKvsVideoStream");
+    STRCPY(track.trackId, "myVideoTrack");
+    EXPECT_EQ(STATUS_SUCCESS, addTransceiver(pRtcPeerConnection, &track, &rtcRtpTransceiverInit, &pVideoTransceiver));
+    track.kind = MEDIA_STREAM_TRACK_KIND_AUDIO;
+    track.codec = RTC_CODEC_OPUS;
+    STRCPY(track.trackId, "myAudioTrack");
+    EXPECT_EQ(STATUS_SUCCESS, addTransceiver(pRtcPeerConnection, &track, &rtcRtpTransceiverInit, &pAudioTransceiver));
+
+    // The first offer of the configuration compiles the template, the next one is rendered from it
+    EXPECT_EQ(STATUS_SUCCESS, sdpTemplateCacheGetStats(&before));
+    EXPECT_EQ(STATUS_SUCCESS, createOffer(pRtcPeerConnection, &offer));
+    EXPECT_EQ(STATUS_SUCCESS, sdpTemplateCacheGetStats(&after));
+    EXPECT_EQ(before.misses + 1, after.misses);
+    EXPECT_EQ(before.templateCount + 1, after.templateCount);
+
+    // Values of another session of the same configuration
+    STRCPY(pKvsPeerConnection->localIceUfrag, "zyxw");
+    STRCPY(pKvsPeerConnection->localIcePwd, "abcdefghijklmnopqrstuvwx");
+    STRCPY(pKvsPeerConnection->localCNAME, "0123456789abcdef");
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) pVideoTransceiver;
+    pKvsRtpTransceiver->sender.ssrc = 1;
+    pKvsRtpTransceiver->sender.rtxSsrc = 4294967295U;
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) pAudioTransceiver;
+    pKvsRtpTransceiver->sender.ssrc = 123456;
+
+    SRAND(42);
+    EXPECT_EQ(STATUS_SUCCESS, createOffer(pRtcPeerConnection, &offer));
+    EXPECT_EQ(STATUS_SUCCESS, sdpTemplateCacheGetStats(&before));
+    EXPECT_EQ(after.hits + 1, before.hits);
+
+    SRAND(42);
+    pSessionDescription = (PSessionDescription) MEMCALLOC(1, SIZEOF(SessionDescription));
+    EXPECT_EQ(STATUS_SUCCESS, populateSessionDescription(pKvsPeerConnection, &pKvsPeerConnection->remoteSessionDescription, pSessionDescription));
+    serializeLen = MAX_SESSION_DESCRIPTION_INIT_SDP_LEN;
+    EXPECT_EQ(STATUS_SUCCESS, serializeSessionDescription(pSessionDescription, populated.sdp, &serializeLen));
+    EXPECT_STREQ(populated.sdp, offer.sdp);
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, "a=ssrc:4294967295 cname:0123456789abcdef", offer.sdp);
+
+    resetSessionDescription(pSessionDescription);
+    SAFE_MEMFREE(pSessionDescription);
+    closePeerConnection(pRtcPeerConnection);
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+}
+
+TEST_F(SdpApiTest, answer_RenderedFromTemplateMatchesPopulated)
+{
+    CHAR remoteSessionDescription[] = R"(v=0
+o=- 7732334361409071710 2 IN IP4 127.0.0.1
+s=-
+t=0 0
+a=group:BUNDLE 0 1
+a=msid-semantic: WMS myKvsVideoStream
+m=audio 9 UDP/TLS/RTP/SAVPF 111
+c=IN IP4 127.0.0.1
+a=rtcp:9 IN IP4 0.0.0.0
+a=ice-ufrag:9YRc
+a=ice-pwd:/ELMEiczRSsx2OEi2ynq+TbZ
+a=fingerprint:sha-256 51:04:F9:20:45:5C:9D:85:AF:D7:AF:FB:2B:F8:DB:24:66:7B:6A:E3:E3:EF:EC:72:93:6E:01:B8:C9:53:A6:31
+a=setup:actpass
+a=mid:0
+a=sendrecv
+a=rtcp-mux
+a=rtpmap:111 opus/48000/2
+a=fmtp:111 minptime=10;useinbandfec=1
+m=video 9 UDP/TLS/RTP/SAVPF 125 126
+c=IN IP4 127.0.0.1
+a=rtcp:9 IN IP4 0.0.0.0
+a=ice-ufrag:9YRc
+a=ice-pwd:/ELMEiczRSsx2OEi2ynq+TbZ
+a=fingerprint:sha-256 51:04:F9:20:45:5C:9D:85:AF:D7:AF:FB:2B:F8:DB:24:66:7B:6A:E3:E3:EF:EC:72:93:6E:01:B8:C9:53:A6:31
+a=setup:actpass
+a=mid:1
+a=recvonly
+a=rtcp-mux
+a=rtpmap:125 H264/90000
+a=fmtp:125 level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f
+a=rtpmap:126 rtx/90000
+a=fmtp:126 apt=125
+)";
+
+    assertLFAndCRLF(remoteSessionDescription, ARRAY_SIZE(remoteSessionDescription) - 1, [](PCHAR sdp) {
+        PRtcPeerConnection pRtcPeerConnection = NULL;
+        PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+        PKvsPeerConnection pKvsPeerConnection;
+        PSessionDescription pSessionDescription = NULL;
+        RtcConfiguration rtcConfiguration;
+        RtcMediaStreamTrack track;
+        RtcRtpTransceiverInit rtcRtpTransceiverInit;
+        RtcSessionDescriptionInit rendered, populated;
+        LocalMediaSections localMediaSections;
+        SdpTemplateCacheStats before, after;
+        UINT32 serializeLen;
+
+        MEMSET(&rtcConfiguration, 0x00, SIZEOF(RtcConfiguration));
+        MEMSET(&track, 0x00, SIZEOF(RtcMediaStreamTrack));
+        MEMSET(&rendered, 0x00, SIZEOF(RtcSessionDescriptionInit));
+        MEMSET(&populated, 0x00, SIZEOF(RtcSessionDescriptionInit));
+
+        EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&rtcConfiguration, &pRtcPeerConnection));
+        pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+
+        rtcRtpTransceiverInit.direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV;
+        track.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+        track.codec = RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE;
+        STRCPY(track.streamId, "myKvsVideoStream");
+        STRCPY(track.trackId, "myVideoTrack");
+        EXPECT_EQ(STATUS_SUCCESS, addTransceiver(pRtcPeerConnection, &track, &rtcRtpTransceiverInit, &pRtcRtpTransceiver));
+        track.kind = MEDIA_STREAM_TRACK_KIND_AUDIO;
+        track.codec = RTC_CODEC_OPUS;
+        STRCPY(track.trackId, "myAudioTrack");
+        EXPECT_EQ(STATUS_SUCCESS, addTransceiver(pRtcPeerConnection, &track, &rtcRtpTransceiverInit, &pRtcRtpTransceiver));
+
+        STRCPY(rendered.sdp, sdp);
+        rendered.type = SDP_TYPE_OFFER;
+        EXPECT_EQ(STATUS_SUCCESS, setRemoteDescription(pRtcPeerConnection, &rendered));
+
+        EXPECT_EQ(STATUS_SUCCESS, collectLocalMediaSections(pKvsPeerConnection, &pKvsPeerConnection->remoteSessionDescription, &localMediaSections));
+
+        EXPECT_EQ(STATUS_SUCCESS, sdpTemplateCacheGetStats(&before));
+        serializeLen = MAX_SESSION_DESCRIPTION_INIT_SDP_LEN;
+        EXPECT_EQ(STATUS_SUCCESS, serializeLocalSessionDescriptionForSections(pKvsPeerConnection, &localMediaSections, rendered.sdp, &serializeLen));
+        EXPECT_EQ(STRLEN(rendered.sdp) + 1, serializeLen);
+
+        STRCPY(pKvsPeerConnection->localIceUfrag, "zyxw");
+        STRCPY(pKvsPeerConnection->localCNAME, "0123456789abcdef");
+
+        SRAND(7);
+        serializeLen = MAX_SESSION_DESCRIPTION_INIT_SDP_LEN;
+        EXPECT_EQ(STATUS_SUCCESS, serializeLocalSessionDescriptionForSections(pKvsPeerConnection, &localMediaSections, rendered.sdp, &serializeLen));
+        EXPECT_EQ(STATUS_SUCCESS, sdpTemplateCacheGetStats(&after));
+        EXPECT_EQ(before.hits + 1, after.hits);
+
+        SRAND(7);
+        pSessionDescription = (PSessionDescription) MEMCALLOC(1, SIZEOF(SessionDescription));
+        EXPECT_EQ(STATUS_SUCCESS,
+                  populateSessionDescriptionForSections(pKvsPeerConnection, &pKvsPeerConnection->remoteSessionDescription, &localMediaSections,
+                                                        pSessionDescription));
+        serializeLen = MAX_SESSION_DESCRIPTION_INIT_SDP_LEN;
+        EXPECT_EQ(STATUS_SUCCESS, serializeSessionDescription(pSessionDescription, populated.sdp, &serializeLen));
+        EXPECT_STREQ(populated.sdp, rendered.sdp);
+
+        // A description that doesn't fit is turned down the same way either way
+        serializeLen = 16;
+        EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY,
+                  serializeLocalSessionDescriptionForSections(pKvsPeerConnection, &localMediaSections, rendered.sdp, &serializeLen));
+
+        resetSessionDescription(pSessionDescription);
+        SAFE_MEMFREE(pSessionDescription);
+        freeLocalMediaSections(&localMediaSections);
+        closePeerConnection(pRtcPeerConnection);
+        EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+    });
+}
+
 TEST_P(SdpApiTest_SdpMatch, populateSingleMediaSection_TestH264Fmtp)
 {
     PRtcPeerConnection pRtcPeerConnection = NULL;
@@ -3387,9 +3387,7 @@ TEST_F(SignalingApiFunctionalityTest, fileCachingUpdateMultiChannelCache)
     int time = GETTIME() / HUNDREDS_OF_NANOS_IN_A_SECOND;
     int append = 0;
     int i = 0;
-    char * fileBuffer;
-    UINT64 fileSize;
-    UINT32 entryCount;
+    UINT32 entryCount = MAX_SIGNALING_CACHE_ENTRY_COUNT;
     SignalingFileCacheEntry entries[MAX_SIGNALING_CACHE_ENTRY_COUNT];
     MEMSET(entries, 0x00, SIZEOF(entries));
 
@@ -3429,18 +3427,11 @@ TEST_F(SignalingApiFunctionalityTest, fileCachingUpdateMultiChannelCache)
     EXPECT_EQ(0, STRCMP(testEntry.channelArn, testChannelArn));
     EXPECT_EQ(0, STRCMP(testEntry.channelName, testChannel));
 
-    //Check size to ensure entries are properly overwriting each other
-    EXPECT_EQ(STATUS_SUCCESS, readFile(DEFAULT_CACHE_FILE_PATH, FALSE, NULL, &fileSize));
-
-    EXPECT_LT(0, fileSize);
-    /* +1 for null terminator */
-    fileBuffer = (char*)MEMCALLOC(1, (fileSize + 1) * SIZEOF(CHAR));
-    EXPECT_TRUE((fileBuffer != NULL));
-    EXPECT_EQ(STATUS_SUCCESS, readFile(DEFAULT_CACHE_FILE_PATH, FALSE, (PBYTE) fileBuffer, &fileSize));
-    EXPECT_EQ(STATUS_SUCCESS, deserializeSignalingCacheEntries(fileBuffer, fileSize, entries, &entryCount, DEFAULT_CACHE_FILE_PATH));
+    //Check count to ensure entries are properly overwriting each other
+    EXPECT_EQ(STATUS_SUCCESS, signalingCacheGetEntries(DEFAULT_CACHE_FILE_PATH, entries, &entryCount));
+    EXPECT_LT(0, entryCount);
     EXPECT_LT(entryCount, TEST_CHANNEL_COUNT+1);
 
-    MEMFREE(fileBuffer);
     FREMOVE(DEFAULT_CACHE_FILE_PATH);
 }
 
@@ -3499,6 +3490,116 @@ TEST_F(SignalingApiFunctionalityTest, fileCachingUpdateFullMultiChannelCache)
     FREMOVE(DEFAULT_CACHE_FILE_PATH);
 }
 
+TEST_F(SignalingApiFunctionalityTest, fileCachingBinaryFileFormat)
+{
+    SignalingFileCacheEntry testEntry, loadedEntry;
+    SignalingCacheFileHeader header;
+    UINT64 fileSize = 0;
+    PBYTE fileBuffer;
+    BOOL cacheFound = FALSE;
+
+    FREMOVE(TEST_CACHE_FILE_PATH);
+
+    MEMSET(&testEntry, 0x00, SIZEOF(testEntry));
+    testEntry.role = SIGNALING_CHANNEL_ROLE_TYPE_MASTER;
+    STRCPY(testEntry.wssEndpoint, "testWssEndpoint");
+    STRCPY(testEntry.httpsEndpoint, "testHttpsEndpoint");
+    STRCPY(testEntry.region, "testRegion");
+    STRCPY(testEntry.channelArn, "testChannelArn");
+    STRCPY(testEntry.channelName, "testChannel");
+    testEntry.creationTsEpochSeconds = GETTIME() / HUNDREDS_OF_NANOS_IN_A_SECOND;
+
+    // Nothing is found and no file created before the first save
+    EXPECT_EQ(STATUS_SUCCESS,
+              signalingCacheLoadFromFile(testEntry.channelName, testEntry.region, testEntry.role, &loadedEntry, &cacheFound, TEST_CACHE_FILE_PATH));
+    EXPECT_FALSE(cacheFound);
+    EXPECT_EQ(STATUS_SUCCESS, fileExists(TEST_CACHE_FILE_PATH, &cacheFound));
+    EXPECT_FALSE(cacheFound);
+
+    EXPECT_EQ(STATUS_SUCCESS, signalingCacheSaveToFile(&testEntry, TEST_CACHE_FILE_PATH));
+
+    EXPECT_EQ(STATUS_SUCCESS, readFile(TEST_CACHE_FILE_PATH, TRUE, NULL, &fileSize));
+    EXPECT_EQ(SIZEOF(SignalingCacheFileHeader) + SIZEOF(SignalingFileCacheEntry), fileSize);
+    fileBuffer = (PBYTE) MEMALLOC(fileSize);
+    EXPECT_EQ(STATUS_SUCCESS, readFile(TEST_CACHE_FILE_PATH, TRUE, fileBuffer, &fileSize));
+    MEMCPY(&header, fileBuffer, SIZEOF(header));
+    EXPECT_EQ(SIGNALING_CACHE_FILE_MAGIC, header.magic);
+    EXPECT_EQ(SIGNALING_CACHE_FILE_VERSION, header.version);
+    EXPECT_EQ(SIZEOF(SignalingFileCacheEntry), header.entrySize);
+    EXPECT_EQ(1, header.entryCount);
+    EXPECT_EQ(0, MEMCMP(&testEntry, fileBuffer + SIZEOF(header), SIZEOF(testEntry)));
+
+    // Roles are indexed apart
+    EXPECT_EQ(STATUS_SUCCESS,
+              signalingCacheLoadFromFile(testEntry.channelName, testEntry.region, SIGNALING_CHANNEL_ROLE_TYPE_VIEWER, &loadedEntry, &cacheFound,
+                                         TEST_CACHE_FILE_PATH));
+    EXPECT_FALSE(cacheFound);
+    EXPECT_EQ(STATUS_SUCCESS,
+              signalingCacheLoadFromFile(testEntry.channelName, testEntry.region, testEntry.role, &loadedEntry, &cacheFound, TEST_CACHE_FILE_PATH));
+    EXPECT_TRUE(cacheFound);
+    EXPECT_EQ(0, MEMCMP(&testEntry, &loadedEntry, SIZEOF(testEntry)));
+
+    // A file written with another entry layout is an empty cache until the next save replaces it
+    ((PSignalingCacheFileHeader) fileBuffer)->entrySize = SIZEOF(SignalingFileCacheEntry) + 8;
+    EXPECT_EQ(STATUS_SUCCESS, writeFile(TEST_CACHE_FILE_PATH, TRUE, FALSE, fileBuffer, fileSize));
+    EXPECT_EQ(STATUS_SUCCESS,
+              signalingCacheLoadFromFile(testEntry.channelName, testEntry.region, testEntry.role, &loadedEntry, &cacheFound, TEST_CACHE_FILE_PATH));
+    EXPECT_FALSE(cacheFound);
+
+    EXPECT_EQ(STATUS_SUCCESS, signalingCacheSaveToFile(&testEntry, TEST_CACHE_FILE_PATH));
+    EXPECT_EQ(STATUS_SUCCESS,
+              signalingCacheLoadFromFile(testEntry.channelName, testEntry.region, testEntry.role, &loadedEntry, &cacheFound, TEST_CACHE_FILE_PATH));
+    EXPECT_TRUE(cacheFound);
+
+    MEMFREE(fileBuffer);
+    FREMOVE(TEST_CACHE_FILE_PATH);
+}
+
+TEST_F(SignalingApiFunctionalityTest, fileCachingMigratesV0File)
+{
+    SignalingFileCacheEntry loadedEntry;
+    BOOL cacheFound = FALSE;
+    UINT32 entryCount = MAX_SIGNALING_CACHE_ENTRY_COUNT;
+    SignalingFileCacheEntry entries[MAX_SIGNALING_CACHE_ENTRY_COUNT];
+    CHAR v0Content[] = "testChannel,Master,testRegion,testChannelArn,testHttpsEndpoint,testWssEndpoint,0,,testWebrtcEndpoint,1690000000\n"
+                       "testChannel,Viewer,testRegion,testChannelArn,testHttpsEndpoint2,testWssEndpoint2,0,,,1690000001\n";
+
+    FREMOVE(DEFAULT_CACHE_FILE_PATH);
+    EXPECT_EQ(STATUS_SUCCESS, writeFile(SIGNALING_CACHE_V0_FILE_PATH, FALSE, FALSE, (PBYTE) v0Content, STRLEN(v0Content)));
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              signalingCacheLoadFromFile((PCHAR) "testChannel", (PCHAR) "testRegion", SIGNALING_CHANNEL_ROLE_TYPE_VIEWER, &loadedEntry, &cacheFound,
+                                         DEFAULT_CACHE_FILE_PATH));
+    EXPECT_TRUE(cacheFound);
+    EXPECT_EQ(SIGNALING_CHANNEL_ROLE_TYPE_VIEWER, loadedEntry.role);
+    EXPECT_EQ(1690000001, loadedEntry.creationTsEpochSeconds);
+    EXPECT_STREQ("testChannelArn", loadedEntry.channelArn);
+    EXPECT_STREQ("testHttpsEndpoint2", loadedEntry.httpsEndpoint);
+    EXPECT_STREQ("testWssEndpoint2", loadedEntry.wssEndpoint);
+
+    // The v0 file is gone once its entries are in the binary one
+    EXPECT_EQ(STATUS_SUCCESS, fileExists(SIGNALING_CACHE_V0_FILE_PATH, &cacheFound));
+    EXPECT_FALSE(cacheFound);
+    EXPECT_EQ(STATUS_SUCCESS, signalingCacheGetEntries(DEFAULT_CACHE_FILE_PATH, entries, &entryCount));
+    EXPECT_EQ(2, entryCount);
+    EXPECT_EQ(SIGNALING_CHANNEL_ROLE_TYPE_MASTER, entries[0].role);
+    EXPECT_STREQ("testWebrtcEndpoint", entries[0].webrtcEndpoint);
+
+    // A v0 file under a custom path is rewritten in place
+    EXPECT_EQ(STATUS_SUCCESS, writeFile(TEST_CACHE_FILE_PATH, FALSE, FALSE, (PBYTE) v0Content, STRLEN(v0Content)));
+    EXPECT_EQ(STATUS_SUCCESS,
+              signalingCacheLoadFromFile((PCHAR) "testChannel", (PCHAR) "testRegion", SIGNALING_CHANNEL_ROLE_TYPE_MASTER, &loadedEntry, &cacheFound,
+                                         TEST_CACHE_FILE_PATH));
+    EXPECT_TRUE(cacheFound);
+    EXPECT_EQ(1690000000, loadedEntry.creationTsEpochSeconds);
+    entryCount = MAX_SIGNALING_CACHE_ENTRY_COUNT;
+    EXPECT_EQ(STATUS_SUCCESS, signalingCacheGetEntries(TEST_CACHE_FILE_PATH, entries, &entryCount));
+    EXPECT_EQ(2, entryCount);
+
+    FREMOVE(DEFAULT_CACHE_FILE_PATH);
+    FREMOVE(TEST_CACHE_FILE_PATH);
+}
+
 
 TEST_F(SignalingApiFunctionalityTest, receivingIceConfigOffer)
 {
@@ -655,6 +655,244 @@ TEST_F(SignalingApiTest, signalingClientCreateWithClientInfoVariations)
     mClientInfo.cacheFilePath = NULL;
 }
 
+TEST_F(SignalingApiTest, parseSignalingMessageValid)
+{
+    PSignalingClient pSignalingClient;
+    PReceivedSignalingMessage pReceivedSignalingMessage;
+    BOOL parsedIceServerList = TRUE;
+    CHAR message[] = "{\"senderClientId\": \"TestPeer\", \"messageType\": \"ICE_CANDIDATE\", \"messagePayload\": \"aGVsbG8=\", "
+                     "\"unknownMember\": {\"nested\": [1, true, null, {\"a\": \"b\\\"c\"}]}, "
+                     "\"statusResponse\": {\"correlationId\": \"abc\", \"errorType\": \"InvalidArgumentException\", \"statusCode\": \"400\", "
+                     "\"description\": \"Some description\"}}";
+
+    pSignalingClient = (PSignalingClient) MEMCALLOC(1, SIZEOF(SignalingClient));
+    pReceivedSignalingMessage = (PReceivedSignalingMessage) MEMCALLOC(1, SIZEOF(ReceivedSignalingMessage));
+    ASSERT_TRUE(pSignalingClient != NULL && pReceivedSignalingMessage != NULL);
+
+    // The text doesn't need to be NULL terminated
+    EXPECT_EQ(STATUS_SUCCESS,
+              parseSignalingMessage(pSignalingClient, message, STRLEN(message), pReceivedSignalingMessage, &parsedIceServerList));
+    EXPECT_FALSE(parsedIceServerList);
+    EXPECT_EQ(SIGNALING_MESSAGE_CURRENT_VERSION, pReceivedSignalingMessage->signalingMessage.version);
+    EXPECT_EQ(SIGNALING_MESSAGE_TYPE_ICE_CANDIDATE, pReceivedSignalingMessage->signalingMessage.messageType);
+    EXPECT_STREQ("TestPeer", pReceivedSignalingMessage->signalingMessage.peerClientId);
+    EXPECT_EQ(5, pReceivedSignalingMessage->signalingMessage.payloadLen);
+    EXPECT_STREQ("hello", pReceivedSignalingMessage->signalingMessage.payload);
+    EXPECT_STREQ("abc", pReceivedSignalingMessage->signalingMessage.correlationId);
+    EXPECT_STREQ("InvalidArgumentException", pReceivedSignalingMessage->errorType);
+    EXPECT_EQ(400, (UINT32) pReceivedSignalingMessage->statusCode);
+    EXPECT_STREQ("Some description", pReceivedSignalingMessage->description);
+
+    SAFE_MEMFREE(pReceivedSignalingMessage);
+    SAFE_MEMFREE(pSignalingClient);
+}
+
+TEST_F(SignalingApiTest, parseSignalingMessageIceServerList)
+{
+    PSignalingClient pSignalingClient;
+    PReceivedSignalingMessage pReceivedSignalingMessage;
+    BOOL parsedIceServerList = FALSE;
+    CHAR message[] = "{\"messageType\": \"OFFER\", \"senderClientId\": \"TestPeer\", \"messagePayload\": \"aGVsbG8=\", \"IceServerList\": ["
+                     "{\"Password\": \"pass1\", \"Ttl\": 298, \"Uris\": [\"turn:a:443?transport=udp\", \"turns:a:443?transport=tcp\"], "
+                     "\"Username\": \"user1\"}, {\"Password\": \"pass2\", \"Ttl\": 10, \"Uris\": [], \"Username\": \"user2\"}]}";
+
+    pSignalingClient = (PSignalingClient) MEMCALLOC(1, SIZEOF(SignalingClient));
+    pReceivedSignalingMessage = (PReceivedSignalingMessage) MEMCALLOC(1, SIZEOF(ReceivedSignalingMessage));
+    ASSERT_TRUE(pSignalingClient != NULL && pReceivedSignalingMessage != NULL);
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              parseSignalingMessage(pSignalingClient, message, ARRAY_SIZE(message), pReceivedSignalingMessage, &parsedIceServerList));
+    EXPECT_TRUE(parsedIceServerList);
+    EXPECT_EQ(SIGNALING_MESSAGE_TYPE_OFFER, pReceivedSignalingMessage->signalingMessage.messageType);
+    EXPECT_EQ(2, pSignalingClient->iceConfigCount);
+    EXPECT_STREQ("user1", pSignalingClient->iceConfigs[0].userName);
+    EXPECT_STREQ("pass1", pSignalingClient->iceConfigs[0].password);
+    EXPECT_EQ(298 * HUNDREDS_OF_NANOS_IN_A_SECOND, pSignalingClient->iceConfigs[0].ttl);
+    EXPECT_EQ(2, pSignalingClient->iceConfigs[0].uriCount);
+    EXPECT_STREQ("turns:a:443?transport=tcp", pSignalingClient->iceConfigs[0].uris[1]);
+    EXPECT_STREQ("user2", pSignalingClient->iceConfigs[1].userName);
+    EXPECT_EQ(0, pSignalingClient->iceConfigs[1].uriCount);
+
+    SAFE_MEMFREE(pReceivedSignalingMessage);
+    SAFE_MEMFREE(pSignalingClient);
+}
+
+TEST_F(SignalingApiTest, parseSignalingMessageInvalid)
+{
+    PSignalingClient pSignalingClient;
+    PReceivedSignalingMessage pReceivedSignalingMessage;
+    BOOL parsedIceServerList;
+    UINT32 i;
+    CHAR deepMessage[SIGNALING_JSON_MAX_DEPTH + 32];
+    PCHAR malformed[] = {(PCHAR) "",
+                         (PCHAR) "{}",
+                         (PCHAR) "[]",
+                         (PCHAR) "\"messageType\"",
+                         (PCHAR) "{\"messageType\": \"OFFER\"",
+                         (PCHAR) "{\"messageType\": \"OFFER\",}",
+                         (PCHAR) "{\"messageType\" \"OFFER\"}",
+                         (PCHAR) "{\"messageType\": \"OFFER\" \"senderClientId\": \"a\"}",
+                         (PCHAR) "{\"messageType\": \"OFFER\"}}",
+                         (PCHAR) "{\"messageType\": \"OFFER\", \"a\": [1, 2}",
+                         (PCHAR) "{\"messageType\": \"OFFER\\"};
+
+    pSignalingClient = (PSignalingClient) MEMCALLOC(1, SIZEOF(SignalingClient));
+    pReceivedSignalingMessage = (PReceivedSignalingMessage) MEMCALLOC(1, SIZEOF(ReceivedSignalingMessage));
+    ASSERT_TRUE(pSignalingClient != NULL && pReceivedSignalingMessage != NULL);
+
+    EXPECT_EQ(STATUS_NULL_ARG, parseSignalingMessage(pSignalingClient, NULL, 10, pReceivedSignalingMessage, &parsedIceServerList));
+
+    for (i = 0; i < ARRAY_SIZE(malformed); i++) {
+        EXPECT_EQ(STATUS_INVALID_API_CALL_RETURN_JSON,
+                  parseSignalingMessage(pSignalingClient, malformed[i], STRLEN(malformed[i]), pReceivedSignalingMessage, &parsedIceServerList))
+            << malformed[i];
+    }
+
+    // Message type is mandatory
+    CHAR noType[] = "{\"senderClientId\": \"TestPeer\", \"messagePayload\": \"aGVsbG8=\"}";
+    EXPECT_EQ(STATUS_SIGNALING_INVALID_MESSAGE_TYPE,
+              parseSignalingMessage(pSignalingClient, noType, STRLEN(noType), pReceivedSignalingMessage, &parsedIceServerList));
+
+    // Too long sender id
+    CHAR longSender[MAX_SIGNALING_CLIENT_ID_LEN + 64];
+    SNPRINTF(longSender, SIZEOF(longSender), "{\"messageType\": \"OFFER\", \"senderClientId\": \"%0*d\"}", MAX_SIGNALING_CLIENT_ID_LEN + 1, 0);
+    EXPECT_EQ(STATUS_INVALID_API_CALL_RETURN_JSON,
+              parseSignalingMessage(pSignalingClient, longSender, STRLEN(longSender), pReceivedSignalingMessage, &parsedIceServerList));
+
+    // Nested deeper than the reader follows
+    STRCPY(deepMessage, "{\"a\": ");
+    for (i = STRLEN(deepMessage); i < SIGNALING_JSON_MAX_DEPTH + 8; i++) {
+        deepMessage[i] = '[';
+    }
+    deepMessage[i] = '\0';
+    EXPECT_EQ(STATUS_INVALID_API_CALL_RETURN_JSON,
+              parseSignalingMessage(pSignalingClient, deepMessage, STRLEN(deepMessage), pReceivedSignalingMessage, &parsedIceServerList));
+
+    SAFE_MEMFREE(pReceivedSignalingMessage);
+    SAFE_MEMFREE(pSignalingClient);
+}
+
+// Sequence expected next from each dispatcher test peer and whether one came out of order
+static volatile SIZE_T gDispatchedSequence[8];
+static volatile SIZE_T gDispatchedTotal;
+static volatile ATOMIC_BOOL gDispatchedOutOfOrder;
+static volatile ATOMIC_BOOL gDispatchBlocked;
+static PSignalingMessageDispatcher gTestDispatcher;
+
+static PVOID testSignalingDispatchFn(PVOID args)
+{
+    PSignalingMessageWrapper pSignalingMessageWrapper = (PSignalingMessageWrapper) args;
+    UINT32 peer = 0, sequence = pSignalingMessageWrapper->receivedSignalingMessage.signalingMessage.payloadLen;
+
+    STRTOUI32(pSignalingMessageWrapper->receivedSignalingMessage.signalingMessage.peerClientId + 4, NULL, 10, &peer);
+
+    while (ATOMIC_LOAD_BOOL(&gDispatchBlocked)) {
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    if (ATOMIC_LOAD(&gDispatchedSequence[peer]) != sequence) {
+        ATOMIC_STORE_BOOL(&gDispatchedOutOfOrder, TRUE);
+    }
+    ATOMIC_STORE(&gDispatchedSequence[peer], sequence + 1);
+    ATOMIC_INCREMENT(&gDispatchedTotal);
+
+    signalingDispatcherReleaseWrapper(gTestDispatcher, &pSignalingMessageWrapper);
+    return NULL;
+}
+
+static STATUS testSignalingDispatcherPush(UINT32 peer, UINT32 sequence)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSignalingMessageWrapper pSignalingMessageWrapper = NULL;
+
+    CHK_STATUS(signalingDispatcherGetWrapper(gTestDispatcher, &pSignalingMessageWrapper));
+    SNPRINTF(pSignalingMessageWrapper->receivedSignalingMessage.signalingMessage.peerClientId, MAX_SIGNALING_CLIENT_ID_LEN + 1, "peer%u", peer);
+    pSignalingMessageWrapper->receivedSignalingMessage.signalingMessage.payloadLen = sequence;
+    CHK_STATUS(signalingDispatcherPush(gTestDispatcher, pSignalingMessageWrapper));
+    pSignalingMessageWrapper = NULL;
+
+CleanUp:
+
+    signalingDispatcherReleaseWrapper(gTestDispatcher, &pSignalingMessageWrapper);
+    return retStatus;
+}
+
+TEST_F(SignalingApiTest, signalingMessageDispatcherKeepsPeerOrder)
+{
+    SignalingDispatcherStats stats;
+    UINT32 i, peer, waited = 0;
+
+    MEMSET((PVOID) gDispatchedSequence, 0x00, SIZEOF(gDispatchedSequence));
+    gDispatchedTotal = 0;
+    ATOMIC_STORE_BOOL(&gDispatchedOutOfOrder, FALSE);
+    ATOMIC_STORE_BOOL(&gDispatchBlocked, FALSE);
+
+    EXPECT_EQ(STATUS_NULL_ARG, createSignalingMessageDispatcher(1, 3, NULL, &gTestDispatcher));
+    EXPECT_EQ(STATUS_SUCCESS, createSignalingMessageDispatcher(1, 3, testSignalingDispatchFn, &gTestDispatcher));
+    EXPECT_EQ(3, gTestDispatcher->workerCount);
+
+    // Interleaved messages of more peers than workers
+    for (i = 0; i < 200; i++) {
+        for (peer = 0; peer < ARRAY_SIZE(gDispatchedSequence); peer++) {
+            EXPECT_EQ(STATUS_SUCCESS, testSignalingDispatcherPush(peer, i));
+        }
+    }
+
+    while (ATOMIC_LOAD(&gDispatchedTotal) < 200 * ARRAY_SIZE(gDispatchedSequence) && waited++ < 5000) {
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(200 * ARRAY_SIZE(gDispatchedSequence), ATOMIC_LOAD(&gDispatchedTotal));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&gDispatchedOutOfOrder));
+
+    EXPECT_EQ(STATUS_SUCCESS, signalingDispatcherGetStats(gTestDispatcher, &stats));
+    EXPECT_EQ(0, stats.queueDepth);
+    EXPECT_LT(0, stats.maxQueueDepth);
+    EXPECT_EQ(200 * ARRAY_SIZE(gDispatchedSequence), stats.dispatchedCount);
+    EXPECT_LE(stats.averageDispatchLatency, stats.maxDispatchLatency);
+
+    // The delivered wrappers went back on the free list
+    EXPECT_LT(0, gTestDispatcher->freeCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeSignalingMessageDispatcher(&gTestDispatcher));
+    EXPECT_TRUE(gTestDispatcher == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, freeSignalingMessageDispatcher(&gTestDispatcher));
+}
+
+TEST_F(SignalingApiTest, signalingMessageDispatcherBoundsQueue)
+{
+    SignalingDispatcherStats stats;
+    UINT32 i;
+
+    MEMSET((PVOID) gDispatchedSequence, 0x00, SIZEOF(gDispatchedSequence));
+    gDispatchedTotal = 0;
+    ATOMIC_STORE_BOOL(&gDispatchedOutOfOrder, FALSE);
+    ATOMIC_STORE_BOOL(&gDispatchBlocked, TRUE);
+
+    EXPECT_EQ(STATUS_SUCCESS, createSignalingMessageDispatcher(0, 0, testSignalingDispatchFn, &gTestDispatcher));
+    EXPECT_EQ(SIGNALING_DISPATCHER_DEFAULT_WORKER_COUNT, gTestDispatcher->workerCount);
+
+    // The message the worker took is blocked in the handler, the rest fill the queue
+    for (i = 0; i <= SIGNALING_DISPATCHER_MAX_QUEUE_DEPTH; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, testSignalingDispatcherPush(0, i));
+        if (i == 0) {
+            while (ATOMIC_LOAD(&gTestDispatcher->queueDepth) != 0) {
+                THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+            }
+        }
+    }
+
+    EXPECT_EQ(STATUS_SIGNALING_MESSAGE_QUEUE_FULL, testSignalingDispatcherPush(0, i));
+    EXPECT_EQ(STATUS_SUCCESS, signalingDispatcherGetStats(gTestDispatcher, &stats));
+    EXPECT_EQ(SIGNALING_DISPATCHER_MAX_QUEUE_DEPTH, stats.queueDepth);
+    EXPECT_EQ(SIGNALING_DISPATCHER_MAX_QUEUE_DEPTH, stats.maxQueueDepth);
+
+    // Freeing waits for the message being handled and drops the queued ones
+    ATOMIC_STORE_BOOL(&gDispatchBlocked, FALSE);
+    EXPECT_EQ(STATUS_SUCCESS, freeSignalingMessageDispatcher(&gTestDispatcher));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&gDispatchedOutOfOrder));
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
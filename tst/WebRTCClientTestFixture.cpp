@@ -113,6 +113,7 @@ void WebRtcClientTestBase::TearDown()
     DLOGI("\nTearing down test: %s\n", GetTestName());
 
     deinitKvsWebRtc();
+    deinitSignalingFileCache();
 
     freeStaticCredentialProvider(&mTestCredentialProvider);
 
@@ -186,7 +186,7 @@ class WebRtcClientTestBase : public ::testing::Test {
         BOOL sizeCalculationOnly = (outBuffer == NULL);
 
         UNUSED_PARAM(pIsStart);
-        CHK(payload != NULL && pBufferSize != NULL, STATUS_NULL_ARG);
+        CHK(payload != NULL && (pBufferSize != NULL || sizeCalculationOnly), STATUS_NULL_ARG);
         CHK(payloadLength > 0, retStatus);
 
         bufferSize = payloadLength;